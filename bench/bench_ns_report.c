@@ -0,0 +1,175 @@
+/**
+ * bench_ns_report.c - Agregação namespace -> PIDs do relatório do sistema
+ *
+ * Monta uma entrada sintética (padrão 100k PIDs em 10k namespaces, 8 tipos
+ * por processo, contêineres sorteados) e mede a agregação com as listas
+ * encadeadas usadas antes (busca linear por namespace, um malloc por PID)
+ * e com o NsReport (hash por tipo + inode, PIDs em arena). A versão antiga
+ * é quadrática: roda só sobre os primeiros 10k PIDs.
+ *
+ * Uso: ./bin/bench/bench_ns_report [pids] [namespaces]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/namespace.h"
+#include "../include/timing.h"
+
+#define DEFAULT_PIDS       100000
+#define DEFAULT_NAMESPACES 10000
+#define LEGACY_MAX_PIDS    10000
+#define NS_TYPES           8
+
+static const char *ns_types[NS_TYPES] = {
+    "cgroup", "ipc", "mnt", "net", "pid", "pid_for_children", "user", "uts"
+};
+
+// ---------- Implementação anterior (listas encadeadas) ----------
+
+typedef struct LegacyPid {
+    int pid;
+    struct LegacyPid *next;
+} LegacyPid;
+
+typedef struct LegacyNode {
+    NamespaceInfo ns;
+    LegacyPid *pids;
+    LegacyPid *pids_tail;
+    struct LegacyNode *next;
+} LegacyNode;
+
+static size_t legacy_allocs = 0;
+
+static double run_legacy(const NamespaceInfo *table, const uint16_t *members, int pids) {
+    LegacyNode *head = NULL, *tail = NULL;
+    uint64_t start = monotonic_ns();
+    for (int p = 0; p < pids; p++) {
+        for (int t = 0; t < NS_TYPES; t++) {
+            const NamespaceInfo *ns = &table[members[p * NS_TYPES + t]];
+            LegacyNode *node = head;
+            while (node && !(node->ns.inode == ns->inode && strcmp(node->ns.type, ns->type) == 0)) {
+                node = node->next;
+            }
+            if (!node) {
+                node = calloc(1, sizeof(LegacyNode));
+                node->ns = *ns;
+                if (tail) tail->next = node; else head = node;
+                tail = node;
+                legacy_allocs++;
+            }
+            LegacyPid *entry = malloc(sizeof(LegacyPid));
+            entry->pid = p + 1;
+            entry->next = NULL;
+            if (node->pids_tail) node->pids_tail->next = entry; else node->pids = entry;
+            node->pids_tail = entry;
+            legacy_allocs++;
+        }
+    }
+    while (head) {
+        LegacyNode *next = head->next;
+        for (LegacyPid *e = head->pids; e;) {
+            LegacyPid *n = e->next;
+            free(e);
+            e = n;
+        }
+        free(head);
+        head = next;
+    }
+    return (monotonic_ns() - start) / 1e6;
+}
+
+// ---------- NsReport ----------
+
+static double run_report(const NamespaceInfo *table, const uint16_t *members, int pids,
+                         int *entries, size_t *arena_bytes) {
+    NsReport r;
+    uint64_t start = monotonic_ns();
+    if (!ns_report_init(&r)) return -1;
+    for (int p = 0; p < pids; p++) {
+        for (int t = 0; t < NS_TYPES; t++) {
+            if (!ns_report_add(&r, &table[members[p * NS_TYPES + t]], p + 1)) {
+                ns_report_free(&r);
+                return -1;
+            }
+        }
+    }
+    *entries = r.count;
+    *arena_bytes = r.arena_bytes;
+    ns_report_free(&r);
+    return (monotonic_ns() - start) / 1e6;
+}
+
+static uint64_t xorshift(uint64_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+int main(int argc, char *argv[]) {
+    int pids = argc > 1 ? atoi(argv[1]) : DEFAULT_PIDS;
+    int namespaces = argc > 2 ? atoi(argv[2]) : DEFAULT_NAMESPACES;
+    if (pids <= 0 || namespaces < NS_TYPES || namespaces > 65535) {
+        fprintf(stderr, "Uso: %s [pids] [namespaces (%d a 65535)]\n", argv[0], NS_TYPES);
+        return 1;
+    }
+
+    // Namespaces divididos entre os tipos; cada PID cai num "contêiner"
+    // por tipo, com os primeiros mais povoados (como o namespace raiz)
+    int per_type = namespaces / NS_TYPES;
+    NamespaceInfo *table = calloc((size_t)per_type * NS_TYPES, sizeof(NamespaceInfo));
+    uint16_t *members = malloc((size_t)pids * NS_TYPES * sizeof(uint16_t));
+    if (!table || !members) {
+        fprintf(stderr, "Erro: Sem memória para a entrada sintética\n");
+        return 1;
+    }
+    for (int t = 0; t < NS_TYPES; t++) {
+        for (int i = 0; i < per_type; i++) {
+            NamespaceInfo *ns = &table[t * per_type + i];
+            strcpy(ns->type, ns_types[t]);
+            ns->inode = 4026531835UL + (unsigned long)t * 100000 + (unsigned long)i;
+            snprintf(ns->path, sizeof(ns->path), "%s:[%lu]", ns->type, ns->inode);
+        }
+    }
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (int p = 0; p < pids; p++) {
+        for (int t = 0; t < NS_TYPES; t++) {
+            uint64_t a = xorshift(&seed) % (uint64_t)per_type;
+            uint64_t b = xorshift(&seed) % (uint64_t)per_type;
+            members[p * NS_TYPES + t] = (uint16_t)(t * per_type + (a < b ? a : b));
+        }
+    }
+
+    int legacy_pids = pids < LEGACY_MAX_PIDS ? pids : LEGACY_MAX_PIDS;
+    int entries = 0;
+    size_t arena_bytes = 0;
+    printf("\n=== Benchmark: relatório de namespaces (%d PIDs, %d namespaces) ===\n\n",
+           pids, per_type * NS_TYPES);
+    printf("%-14s | %8s | %10s | %12s | %12s\n", "Agregacao", "PIDs", "Tempo(ms)", "ns/par", "Alocacoes");
+    printf("---------------|----------|------------|--------------|-------------\n");
+
+    double legacy_ms = run_legacy(table, members, legacy_pids);
+    printf("%-14s | %8d | %10.1f | %12.1f | %12zu\n", "listas", legacy_pids, legacy_ms,
+           legacy_ms * 1e6 / ((double)legacy_pids * NS_TYPES), legacy_allocs);
+
+    double small_ms = run_report(table, members, legacy_pids, &entries, &arena_bytes);
+    printf("%-14s | %8d | %10.1f | %12.1f | %12s\n", "hash + arena", legacy_pids, small_ms,
+           small_ms * 1e6 / ((double)legacy_pids * NS_TYPES), "-");
+
+    double full_ms = run_report(table, members, pids, &entries, &arena_bytes);
+    if (small_ms < 0 || full_ms < 0) {
+        fprintf(stderr, "Erro: Sem memória no NsReport\n");
+        return 1;
+    }
+    printf("%-14s | %8d | %10.1f | %12.1f | %12s\n", "hash + arena", pids, full_ms,
+           full_ms * 1e6 / ((double)pids * NS_TYPES), "-");
+
+    printf("\nNamespaces distintos: %d | arena: %.1f MB\n", entries, arena_bytes / (1024.0 * 1024.0));
+    printf("Speedup (%d PIDs): %.1fx\n\n", legacy_pids, legacy_ms / small_ms);
+
+    free(table);
+    free(members);
+    return 0;
+}
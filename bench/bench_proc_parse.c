@@ -0,0 +1,143 @@
+/**
+ * bench_proc_parse.c - Microbenchmark do tokenizador de /proc
+ *
+ * Compara, sobre o mesmo conteúdo já lido de /proc/self, o custo de
+ * interpretação dos arquivos stat/status/io com a implementação antiga
+ * (sscanf por linha) e com proc_parse_*.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/proc_parse.h"
+#include "../include/proc_reader.h"
+
+#define ITERATIONS 200000
+
+static volatile unsigned long long sink;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Implementação anterior: um sscanf com 25 conversões para stat
+static void legacy_stat(const char *buf) {
+    char comm[256], state;
+    int pid, ppid, pgrp, session, tty_nr, tpgid, num_threads;
+    unsigned long flags, minflt, cminflt, majflt, cmajflt, utime, stime, cutime, cstime;
+    long priority, nice, zero, rss;
+    unsigned long itrealvalue, starttime, vsize;
+    sscanf(buf, "%d %255s %c %d %d %d %d %d %lu %lu %lu %lu %lu %lu %lu %lu %lu %ld %ld %ld %d %ld %lu %lu %ld",
+           &pid, comm, &state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
+           &flags, &minflt, &cminflt, &majflt, &cmajflt, &utime, &stime, &cutime, &cstime,
+           &priority, &nice, &zero, &num_threads, &itrealvalue, &starttime, &vsize, &rss);
+    sink += utime + stime;
+}
+
+// Implementação anterior: cadeia de sscanf por linha de status
+static void legacy_status(const char *buf) {
+    long vol = 0, nonvol = 0, swap = 0;
+    const char *line = buf;
+    while (line && *line) {
+        if (sscanf(line, "voluntary_ctxt_switches: %ld", &vol) != 1 &&
+            sscanf(line, "nonvoluntary_ctxt_switches: %ld", &nonvol) != 1 &&
+            strncmp(line, "VmSwap:", 7) == 0) {
+            sscanf(line, "VmSwap: %ld", &swap);
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    sink += vol + nonvol + swap;
+}
+
+// Implementação anterior: cadeia de sscanf por linha de io
+static void legacy_io(const char *buf) {
+    unsigned long long rchar = 0, wchar = 0, rb = 0, wb = 0, cwb = 0;
+    const char *line = buf;
+    while (line && *line) {
+        if (sscanf(line, "rchar: %llu", &rchar) != 1 &&
+            sscanf(line, "wchar: %llu", &wchar) != 1 &&
+            sscanf(line, "read_bytes: %llu", &rb) != 1 &&
+            sscanf(line, "write_bytes: %llu", &wb) != 1) {
+            sscanf(line, "cancelled_write_bytes: %llu", &cwb);
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    sink += rchar + wchar + rb + wb + cwb;
+}
+
+static void report(const char *name, double legacy, double fast) {
+    printf("%-8s | %12.1f | %12.1f | %7.1fx\n", name,
+           legacy * 1e9 / ITERATIONS, fast * 1e9 / ITERATIONS, legacy / fast);
+}
+
+int main() {
+    ProcHandle h = {0};
+    if (!proc_handle_open(&h, getpid())) {
+        fprintf(stderr, "Erro ao abrir /proc/self\n");
+        return 1;
+    }
+    proc_handle_begin_sample(&h);
+
+    // Copia os buffers: o handle os reutiliza a cada leitura
+    size_t stat_len, status_len, io_len;
+    char *stat_buf = strdup(proc_handle_read(&h, PROC_FILE_STAT, &stat_len));
+    char *status_buf = strdup(proc_handle_read(&h, PROC_FILE_STATUS, &status_len));
+    const char *io_src = proc_handle_read(&h, PROC_FILE_IO, &io_len);
+    char *io_buf = strdup(io_src ? io_src : "");
+    if (!io_src) io_len = 0;
+    proc_handle_close(&h);
+
+    printf("\n=== Benchmark: tokenizador /proc (%d iterações) ===\n\n", ITERATIONS);
+    printf("%-8s | %12s | %12s | %8s\n", "Arquivo", "sscanf(ns)", "parser(ns)", "Speedup");
+    printf("---------|--------------|--------------|---------\n");
+
+    double t0, legacy, fast;
+    ProcStat st;
+    ProcStatus status;
+    ProcIo io;
+
+    t0 = now_sec();
+    for (int i = 0; i < ITERATIONS; i++) legacy_stat(stat_buf);
+    legacy = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < ITERATIONS; i++) {
+        proc_parse_stat(stat_buf, stat_len, &st);
+        sink += st.utime + st.stime;
+    }
+    fast = now_sec() - t0;
+    report("stat", legacy, fast);
+
+    t0 = now_sec();
+    for (int i = 0; i < ITERATIONS; i++) legacy_status(status_buf);
+    legacy = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < ITERATIONS; i++) {
+        proc_parse_status(status_buf, status_len, &status);
+        sink += status.voluntary_ctxt_switches;
+    }
+    fast = now_sec() - t0;
+    report("status", legacy, fast);
+
+    t0 = now_sec();
+    for (int i = 0; i < ITERATIONS; i++) legacy_io(io_buf);
+    legacy = now_sec() - t0;
+    t0 = now_sec();
+    for (int i = 0; i < ITERATIONS; i++) {
+        proc_parse_io(io_buf, io_len, &io);
+        sink += io.rchar;
+    }
+    fast = now_sec() - t0;
+    report("io", legacy, fast);
+
+    printf("\n");
+    free(stat_buf);
+    free(status_buf);
+    free(io_buf);
+    return 0;
+}
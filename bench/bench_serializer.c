@@ -0,0 +1,195 @@
+/**
+ * bench_serializer.c - Microbenchmark da exportação JSON/CSV
+ *
+ * Grava as mesmas amostras sintéticas com a implementação antiga (um
+ * fprintf por campo) e com o serializador (serializer.h) e compara
+ * amostras/s. Em /dev/null mede só a formatação; no arquivo temporário
+ * inclui a cópia para o page cache (~760 MB de JSON para 1M amostras).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../include/process_monitor.h"
+#include "../include/utils.h"
+#include "../include/serializer.h"
+
+#define SAMPLES   1000000
+#define BENCH_FILE "/tmp/bench_serializer.out"
+#define NULL_FILE  "/dev/null"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void make_metrics(ProcessMetrics *m, int i) {
+    memset(m, 0, sizeof(ProcessMetrics));
+    m->pid = 4242;
+    strcpy(m->process_name, "postgres");
+    m->real_ns = 1700000000ULL * 1000000000ULL + (uint64_t)i * 100000000ULL;
+    m->timestamp = (time_t)(m->real_ns / 1000000000ULL);
+    m->interval_ns = 100000000ULL;
+    m->cpu_user_time = 100000 + (unsigned long)i;
+    m->cpu_system_time = 20000 + (unsigned long)i / 3;
+    m->cpu_usage_percent = (double)(i % 1000) / 7.0;
+    m->num_threads = 16;
+    m->voluntary_ctx_switches = 50L * i;
+    m->nonvoluntary_ctx_switches = i / 3;
+    m->mem_vsize = 4L << 30;
+    m->mem_rss = (512L << 20) + 4096L * (i % 1000);
+    m->mem_shared = 64L << 20;
+    m->page_faults_minor = 100000 + 17L * i;
+    m->io_read_bytes = 4096ULL * (unsigned long long)i;
+    m->io_write_bytes = 8192ULL * (unsigned long long)i;
+    m->io_read_rate_kbs = (double)(i % 333) * 1.25;
+    m->io_write_rate_kbs = (double)(i % 97) / 3.0;
+    m->io_read_syscalls = (unsigned long long)i * 2;
+    m->io_write_syscalls = (unsigned long long)i;
+    m->net_connections = 12;
+    m->net_rx_queue = (unsigned long long)(i % 7) * 1448;
+}
+
+// Implementação anterior de write_metrics_json_sample
+static void legacy_json_sample(FILE *fp, const ProcessMetrics *m) {
+    fprintf(fp, "    {\n");
+    fprintf(fp, "      \"timestamp\": %ld,\n", m->timestamp);
+    fprintf(fp, "      \"timestamp_ns\": %llu,\n", (unsigned long long)m->real_ns);
+    fprintf(fp, "      \"interval_ns\": %llu,\n", (unsigned long long)m->interval_ns);
+    fprintf(fp, "      \"cpu\": {\n");
+    fprintf(fp, "        \"user_time\": %lu,\n", m->cpu_user_time);
+    fprintf(fp, "        \"system_time\": %lu,\n", m->cpu_system_time);
+    fprintf(fp, "        \"usage_percent\": %.2f,\n", m->cpu_usage_percent);
+    fprintf(fp, "        \"threads\": %ld,\n", m->num_threads);
+    fprintf(fp, "        \"voluntary_ctx_switches\": %ld,\n", m->voluntary_ctx_switches);
+    fprintf(fp, "        \"nonvoluntary_ctx_switches\": %ld\n", m->nonvoluntary_ctx_switches);
+    fprintf(fp, "      },\n");
+    fprintf(fp, "      \"memory\": {\n");
+    fprintf(fp, "        \"vsize_bytes\": %ld,\n", m->mem_vsize);
+    fprintf(fp, "        \"rss_bytes\": %ld,\n", m->mem_rss);
+    fprintf(fp, "        \"shared_bytes\": %ld,\n", m->mem_shared);
+    fprintf(fp, "        \"page_faults_minor\": %ld,\n", m->page_faults_minor);
+    fprintf(fp, "        \"page_faults_major\": %ld,\n", m->page_faults_major);
+    fprintf(fp, "        \"swap_kb\": %ld\n", m->mem_swap);
+    fprintf(fp, "      },\n");
+    fprintf(fp, "      \"io\": {\n");
+    fprintf(fp, "        \"read_bytes\": %llu,\n", m->io_read_bytes);
+    fprintf(fp, "        \"write_bytes\": %llu,\n", m->io_write_bytes);
+    fprintf(fp, "        \"read_rate_kbs\": %.2f,\n", m->io_read_rate_kbs);
+    fprintf(fp, "        \"write_rate_kbs\": %.2f,\n", m->io_write_rate_kbs);
+    fprintf(fp, "        \"read_syscalls\": %llu,\n", m->io_read_syscalls);
+    fprintf(fp, "        \"write_syscalls\": %llu\n", m->io_write_syscalls);
+    fprintf(fp, "      },\n");
+    fprintf(fp, "      \"network\": {\n");
+    fprintf(fp, "        \"rx_bytes\": %llu,\n", m->net_rx_bytes);
+    fprintf(fp, "        \"tx_bytes\": %llu,\n", m->net_tx_bytes);
+    fprintf(fp, "        \"rx_packets\": %llu,\n", m->net_rx_packets);
+    fprintf(fp, "        \"tx_packets\": %llu,\n", m->net_tx_packets);
+    fprintf(fp, "        \"connections\": %d,\n", m->net_connections);
+    fprintf(fp, "        \"rx_queue\": %llu,\n", m->net_rx_queue);
+    fprintf(fp, "        \"tx_queue\": %llu\n", m->net_tx_queue);
+    fprintf(fp, "      }\n");
+    fprintf(fp, "    }");
+}
+
+// Implementação anterior de write_metrics_csv_row
+static void legacy_csv_row(FILE *fp, const ProcessMetrics *m) {
+    fprintf(fp, "%ld,%llu,%d,%s,", m->timestamp, (unsigned long long)m->real_ns, m->pid, m->process_name);
+    fprintf(fp, "%lu,%lu,%.2f,%ld,%ld,%ld,",
+            m->cpu_user_time, m->cpu_system_time, m->cpu_usage_percent,
+            m->num_threads, m->voluntary_ctx_switches, m->nonvoluntary_ctx_switches);
+    fprintf(fp, "%ld,%ld,%ld,%ld,%ld,%ld,",
+            m->mem_vsize, m->mem_rss, m->mem_shared,
+            m->page_faults_minor, m->page_faults_major, m->mem_swap);
+    fprintf(fp, "%llu,%llu,%.2f,%.2f,%llu,%llu,",
+            m->io_read_bytes, m->io_write_bytes,
+            m->io_read_rate_kbs, m->io_write_rate_kbs,
+            m->io_read_syscalls, m->io_write_syscalls);
+    fprintf(fp, "%llu,%llu,%llu,%llu,%d,%llu,%llu,%llu\n",
+            m->net_rx_bytes, m->net_tx_bytes,
+            m->net_rx_packets, m->net_tx_packets, m->net_connections,
+            m->net_rx_queue, m->net_tx_queue, (unsigned long long)m->interval_ns);
+}
+
+static double run_legacy(const char *path, bool json) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return 0;
+    ProcessMetrics m;
+    double t0 = now_sec();
+    for (int i = 0; i < SAMPLES; i++) {
+        make_metrics(&m, i);
+        if (json) {
+            if (i > 0) fprintf(fp, ",\n");
+            legacy_json_sample(fp, &m);
+        } else {
+            legacy_csv_row(fp, &m);
+        }
+    }
+    fclose(fp);
+    return now_sec() - t0;
+}
+
+static double run_serializer(const char *path, bool json) {
+    OutBuf o;
+    if (!out_open(&o, path)) return 0;
+    ProcessMetrics m;
+    double t0 = now_sec();
+    for (int i = 0; i < SAMPLES; i++) {
+        make_metrics(&m, i);
+        if (json) {
+            if (i > 0) out_lit(&o, ",\n");
+            write_metrics_json_sample(&o, &m, false);
+        } else {
+            write_metrics_csv_row(&o, &m);
+        }
+    }
+    out_close(&o);
+    return now_sec() - t0;
+}
+
+// Mesma saída nas duas implementações (o formato não mudou)
+static bool same_output(bool json) {
+    char legacy[4096], fast[4096];
+    ProcessMetrics m;
+    make_metrics(&m, 12345);
+
+    FILE *fp = fmemopen(legacy, sizeof(legacy), "w");
+    if (!fp) return false;
+    if (json) legacy_json_sample(fp, &m); else legacy_csv_row(fp, &m);
+    fclose(fp);
+
+    OutBuf o;
+    out_init(&o, -1, fast, sizeof(fast) - 1);
+    if (json) write_metrics_json_sample(&o, &m, false); else write_metrics_csv_row(&o, &m);
+    fast[o.len] = '\0';
+    return strcmp(legacy, fast) == 0;
+}
+
+static void report(const char *name, const char *path, bool json) {
+    double legacy = run_legacy(path, json);
+    double fast = run_serializer(path, json);
+    printf("%-7s | %-10s | %14.0f | %14.0f | %9.3f | %7.1fx\n", name,
+           strcmp(path, NULL_FILE) == 0 ? "/dev/null" : "arquivo",
+           SAMPLES / legacy, SAMPLES / fast, fast, legacy / fast);
+}
+
+int main() {
+    printf("\n=== Benchmark: exportação de %d amostras ===\n\n", SAMPLES);
+    printf("Saída idêntica: JSON %s, CSV %s\n\n",
+           same_output(true) ? "sim" : "NÃO", same_output(false) ? "sim" : "NÃO");
+    printf("%-7s | %-10s | %14s | %14s | %9s | %8s\n",
+           "Formato", "Destino", "fprintf(am/s)", "serial.(am/s)", "serial.(s)", "Speedup");
+    printf("--------|------------|----------------|----------------|-----------|---------\n");
+
+    report("JSON", NULL_FILE, true);
+    report("JSON", BENCH_FILE, true);
+    report("CSV", NULL_FILE, false);
+    report("CSV", BENCH_FILE, false);
+
+    unlink(BENCH_FILE);
+    printf("\n");
+    return 0;
+}
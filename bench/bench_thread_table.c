@@ -0,0 +1,144 @@
+/**
+ * bench_thread_table.c - Custo por amostra da coleta por thread
+ *
+ * Cria N threads ociosas (padrão 2000) no próprio processo e mede o tempo
+ * de CPU de cada amostra de todas elas com a coleta ingênua (readdir de
+ * task/ e open/read/close de stat e status de cada TID a cada amostra) e
+ * com a ThreadTable (listagem em cache e descritores persistentes).
+ *
+ * Uso: ./bin/bench/bench_thread_table [threads]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include "../include/thread_table.h"
+#include "../include/proc_parse.h"
+#include "../include/timing.h"
+
+#define DEFAULT_THREADS 2000
+#define SAMPLES 20
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t done = PTHREAD_COND_INITIALIZER;
+static bool finished = false;
+
+static void *idle_main(void *arg) {
+    pthread_mutex_lock(&lock);
+    while (!finished) pthread_cond_wait(&done, &lock);
+    pthread_mutex_unlock(&lock);
+    return arg;
+}
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static bool read_file(int dir_fd, const char *path, char *buf, size_t size, ssize_t *len) {
+    int fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    *len = read(fd, buf, size);
+    close(fd);
+    return *len > 0;
+}
+
+// Coleta ingênua: lista task/ e abre os arquivos de cada thread a cada amostra
+static double run_naive(size_t *count) {
+    char path[300], buf[8192];
+    snprintf(path, sizeof(path), "/proc/%d/task", getpid());
+    DIR *dir = opendir(path);
+    if (!dir) return 0;
+
+    uint64_t total = 0;
+    for (int sample = 0; sample < SAMPLES; sample++) {
+        uint64_t t0 = thread_cpu_ns();
+        size_t n = 0;
+        rewinddir(dir);
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] < '1' || entry->d_name[0] > '9') continue;
+            ProcStat st;
+            ProcStatus status;
+            ssize_t len;
+            snprintf(path, sizeof(path), "%s/stat", entry->d_name);
+            if (!read_file(dirfd(dir), path, buf, sizeof(buf), &len) ||
+                !proc_parse_stat(buf, (size_t)len, &st)) continue;
+            snprintf(path, sizeof(path), "%s/status", entry->d_name);
+            if (!read_file(dirfd(dir), path, buf, sizeof(buf), &len) ||
+                !proc_parse_status(buf, (size_t)len, &status)) continue;
+            n++;
+        }
+        total += thread_cpu_ns() - t0;
+        *count = n;
+    }
+    closedir(dir);
+    return total / 1e6 / SAMPLES;
+}
+
+static double run_table(size_t *count, size_t *relists) {
+    ThreadTable t;
+    if (!thread_table_open(&t, getpid())) return 0;
+
+    // Primeira amostra abre os descritores e não entra na média
+    long threads = 0;
+    thread_table_sample(&t, threads);
+    threads = t.listed_threads;
+
+    uint64_t total = 0;
+    *relists = 0;
+    for (int sample = 0; sample < SAMPLES; sample++) {
+        uint64_t t0 = thread_cpu_ns();
+        thread_table_sample(&t, threads);
+        total += thread_cpu_ns() - t0;
+        if (t.relisted) (*relists)++;
+    }
+    *count = t.count;
+    thread_table_close(&t);
+    return total / 1e6 / SAMPLES;
+}
+
+int main(int argc, char *argv[]) {
+    int nthreads = (argc > 1) ? atoi(argv[1]) : DEFAULT_THREADS;
+    if (nthreads < 0) nthreads = 0;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 64 * 1024);
+    pthread_t *threads = malloc((size_t)(nthreads ? nthreads : 1) * sizeof(pthread_t));
+    int spawned = 0;
+    for (int i = 0; i < nthreads; i++) {
+        if (pthread_create(&threads[spawned], &attr, idle_main, NULL) != 0) break;
+        spawned++;
+    }
+    pthread_attr_destroy(&attr);
+
+    printf("\n=== Benchmark: coleta por thread (%d threads criadas, %d amostras) ===\n\n",
+           spawned, SAMPLES);
+
+    size_t naive_count = 0, table_count = 0, relists = 0;
+    double naive = run_naive(&naive_count);
+    double table = run_table(&table_count, &relists);
+
+    printf("%-13s | %10s | %12s | %16s\n", "Coleta", "Threads", "CPU/amostra(ms)", "% núcleo (1s)");
+    printf("--------------|------------|-----------------|-----------------\n");
+    printf("%-13s | %10zu | %15.2f | %15.2f%%\n", "reabertura", naive_count, naive, naive / 10.0);
+    printf("%-13s | %10zu | %15.2f | %15.2f%%\n", "ThreadTable", table_count, table, table / 10.0);
+    printf("\nThreadTable: %zu releitura(s) de task/ em %d amostras\n", relists, SAMPLES);
+    printf("Speedup: %.1fx\n\n", table > 0 ? naive / table : 0.0);
+
+    pthread_mutex_lock(&lock);
+    finished = true;
+    pthread_cond_broadcast(&done);
+    pthread_mutex_unlock(&lock);
+    for (int i = 0; i < spawned; i++) pthread_join(threads[i], NULL);
+    free(threads);
+    return 0;
+}
@@ -0,0 +1,246 @@
+#ifndef AGENT_H
+#define AGENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "stats.h"
+#include "cgroup_events.h"
+
+// Agente residente: mantém coletores, históricos (ring) e resumos dos
+// processos observados entre consultas e os serve por um socket Unix
+// (SOCK_STREAM) com um protocolo binário de mensagens de tamanho fixo.
+// Cliente e agente rodam na mesma máquina: inteiros e doubles seguem a
+// ordem de bytes nativa e os tempos são do CLOCK_MONOTONIC comum.
+//
+// Cgroups observados (WATCH_CGROUP) ficam num CgroupWatcher dentro do
+// epoll do agente: os eventos de cgroup.events/memory.events/pids.events
+// vão para um histórico por cgroup e para os assinantes, sem releituras.
+
+#define AGENT_DEFAULT_SOCKET    "/tmp/resource-monitor.sock"
+#define AGENT_SOCKET_ENV        "RESOURCE_MONITOR_SOCKET"   // sobrepõe o caminho padrão
+#define AGENT_DEFAULT_RETENTION 3600    // amostras retidas por processo
+#define AGENT_MAX_TARGETS       64
+#define AGENT_MAX_CLIENTS       64
+#define AGENT_MAX_PAYLOAD       (4 * 1024)      // maior requisição aceita
+#define AGENT_MAX_BACKLOG       (1024 * 1024)   // saída pendente antes de descartar amostras
+#define AGENT_MAX_CGROUPS       16              // cgroups expostos no endpoint HTTP
+#define AGENT_MAX_CGROUP_WATCHES 64             // cgroups com eventos observados
+#define AGENT_CGROUP_RETENTION  256             // eventos retidos por cgroup
+#define AGENT_CGROUP_PATH_LEN   128
+
+#define AGENT_MAGIC   0x314d4152u   // "RAM1" em little-endian
+#define AGENT_VERSION 1
+
+// ---------- Protocolo ----------
+
+// Cabeçalho de toda mensagem; length bytes de payload vêm em seguida.
+// A resposta repete o seq da requisição (mensagens de assinatura: seq 0).
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;              // AgentMsgType
+    uint32_t seq;
+    uint32_t length;
+} AgentHeader;
+
+typedef enum {
+    // Requisições (cliente -> agente)
+    AGENT_REQ_WATCH = 1,        // AgentWatchRequest -> OK
+    AGENT_REQ_UNWATCH,          // AgentPidRequest -> OK
+    AGENT_REQ_LIST,             // vazio -> TARGETS
+    AGENT_REQ_QUERY,            // AgentQueryRequest -> SAMPLES
+    AGENT_REQ_SUMMARY,          // AgentPidRequest -> SUMMARY
+    AGENT_REQ_SUBSCRIBE,        // AgentPidRequest -> OK, depois MSG_SAMPLE a cada coleta
+    AGENT_REQ_UNSUBSCRIBE,      // AgentPidRequest -> OK
+    AGENT_REQ_SHUTDOWN,         // vazio -> OK, e o agente termina
+    AGENT_REQ_WATCH_CGROUP,     // AgentCgroupRequest -> OK
+    AGENT_REQ_UNWATCH_CGROUP,   // AgentCgroupRequest -> OK
+    AGENT_REQ_LIST_CGROUPS,     // vazio -> CGROUPS
+    AGENT_REQ_QUERY_CGROUP,     // AgentCgroupRequest -> CGROUP_EVENTS (retidos)
+    AGENT_REQ_SUBSCRIBE_CGROUP, // AgentCgroupRequest -> OK, depois MSG_CGROUP_EVENT
+    AGENT_REQ_UNSUBSCRIBE_CGROUP,   // AgentCgroupRequest -> OK
+
+    // Respostas e mensagens (agente -> cliente)
+    AGENT_RESP_OK = 64,         // vazio
+    AGENT_RESP_ERROR,           // AgentError
+    AGENT_RESP_TARGETS,         // AgentTargetInfo[]
+    AGENT_RESP_SAMPLES,         // AgentSamplesHeader + AgentSample[]
+    AGENT_RESP_SUMMARY,         // AgentSummary
+    AGENT_MSG_SAMPLE,           // AgentSample (assinatura)
+    AGENT_MSG_ENDED,            // AgentPidRequest: processo terminou, fim da assinatura
+    AGENT_RESP_CGROUPS,         // AgentCgroupInfo[]
+    AGENT_RESP_CGROUP_EVENTS,   // AgentCgroupEvent[]
+    AGENT_MSG_CGROUP_EVENT,     // AgentCgroupEvent (assinatura; "removed" a encerra)
+} AgentMsgType;
+
+typedef struct {
+    int32_t pid;
+    uint32_t reserved;
+} AgentPidRequest;
+
+typedef struct {
+    int32_t pid;
+    uint32_t reserved;
+    uint64_t interval_ns;       // 0 = 1s
+} AgentWatchRequest;
+
+typedef struct {
+    int32_t pid;
+    uint32_t max_samples;       // 0 = todas; senão as mais recentes
+    uint64_t window_ns;         // 0 = todo o histórico retido
+} AgentQueryRequest;
+
+// Caminho relativo a /sys/fs/cgroup (sem "..")
+typedef struct {
+    char path[AGENT_CGROUP_PATH_LEN];
+} AgentCgroupRequest;
+
+typedef struct {
+    int32_t code;               // errno (ENOENT, ESRCH, ENOSPC, EINVAL, ...)
+    char message[60];
+} AgentError;
+
+// Amostra com taxas já calculadas
+typedef struct {
+    uint64_t mono_ns;
+    uint64_t real_ns;
+    uint64_t interval_ns;       // desde a amostra anterior (0 = primeira)
+    double cpu_percent;
+    double io_read_bps;
+    double io_write_bps;
+    uint64_t rss_bytes;
+    uint64_t vsz_bytes;
+    uint64_t swap_bytes;
+    uint64_t io_read_bytes;
+    uint64_t io_write_bytes;
+    uint64_t net_rx_bytes;
+    uint64_t net_tx_bytes;
+    uint64_t ctx_voluntary;
+    uint64_t ctx_involuntary;
+    uint64_t page_faults_minor;
+    uint64_t page_faults_major;
+    int32_t pid;
+    uint32_t threads;
+    uint32_t net_connections;
+    uint32_t reserved;
+} AgentSample;
+
+typedef struct {
+    int32_t pid;
+    uint32_t count;
+} AgentSamplesHeader;
+
+typedef struct {
+    int32_t pid;
+    uint8_t ended;              // processo terminou (histórico continua consultável)
+    uint8_t reserved[3];
+    uint64_t interval_ns;
+    uint64_t samples;           // coletadas desde o WATCH
+    uint32_t retained;          // no histórico
+    uint32_t subscribers;
+    uint64_t last_mono_ns;
+} AgentTargetInfo;
+
+typedef struct {
+    int32_t pid;
+    uint32_t reserved;
+    SummaryStats metrics[SUMMARY_COUNT];    // indexado por SummaryMetric
+} AgentSummary;
+
+// Evento de um cgroup observado (ver CgroupEvent)
+typedef struct {
+    uint64_t mono_ns;
+    uint64_t real_ns;
+    uint64_t value;
+    int64_t delta;
+    uint32_t file;              // CgroupEventFile
+    uint32_t reserved;
+    char key[CG_EVENTS_KEY_LEN];            // "populated", "oom_kill"; "removed" no rmdir
+    char path[AGENT_CGROUP_PATH_LEN];
+} AgentCgroupEvent;
+
+typedef struct {
+    char path[AGENT_CGROUP_PATH_LEN];
+    uint8_t removed;            // rmdir (histórico continua consultável)
+    uint8_t reserved[3];
+    uint32_t subscribers;
+    uint64_t events;            // entregues desde o WATCH_CGROUP
+    uint32_t retained;          // no histórico
+    uint32_t reserved2;
+    uint64_t last_mono_ns;
+} AgentCgroupInfo;
+
+_Static_assert(sizeof(AgentHeader) == 16, "AgentHeader: layout do protocolo");
+_Static_assert(sizeof(AgentSample) == 152, "AgentSample: layout do protocolo");
+_Static_assert(sizeof(AgentTargetInfo) == 40, "AgentTargetInfo: layout do protocolo");
+_Static_assert(sizeof(AgentCgroupEvent) == 192, "AgentCgroupEvent: layout do protocolo");
+_Static_assert(sizeof(AgentCgroupInfo) == 160, "AgentCgroupInfo: layout do protocolo");
+
+// ---------- Agente ----------
+
+// Caminho do socket: AGENT_SOCKET_ENV ou AGENT_DEFAULT_SOCKET
+const char *agent_socket_path(void);
+
+typedef struct {
+    const char *socket_path;
+    size_t retention;               // 0 = AGENT_DEFAULT_RETENTION
+    // Endpoint Prometheus (opcional): endereço de http_exporter_open. A
+    // exposição é renderizada a cada refresh_ns (0 = 1s) a partir das
+    // últimas amostras e das estatísticas dos cgroups listados.
+    const char *http_address;       // NULL = sem endpoint
+    uint64_t refresh_ns;
+    const char *cgroups[AGENT_MAX_CGROUPS];     // relativos a /sys/fs/cgroup
+    int num_cgroups;
+} AgentConfig;
+
+// Roda o agente em primeiro plano até SIGINT/SIGTERM ou AGENT_REQ_SHUTDOWN.
+// Os processos são coletados com o backend global (--backend). Retorna
+// false se o socket (ou o endpoint HTTP) não pôde ser criado (ex.: outro
+// agente já escuta nele).
+bool agent_run(const AgentConfig *cfg);
+
+// ---------- Cliente ----------
+
+typedef struct {
+    int fd;
+    uint32_t seq;
+    unsigned char *buf;         // payload da última mensagem recebida
+    size_t cap;
+} AgentClient;
+
+bool agent_client_connect(AgentClient *c, const char *socket_path);
+void agent_client_close(AgentClient *c);
+
+// Envia uma requisição e espera a resposta de mesmo seq (amostras de
+// assinatura recebidas no caminho são descartadas). *payload aponta para
+// o buffer do cliente, válido até a próxima chamada.
+bool agent_client_call(AgentClient *c, AgentMsgType type, const void *req, uint32_t len,
+                       AgentHeader *resp, const void **payload);
+
+// Atalhos: retornam false (com a mensagem do agente no stderr) se a
+// resposta for um erro. Os ponteiros de saída apontam para o buffer.
+bool agent_client_watch(AgentClient *c, int pid, uint64_t interval_ns);
+bool agent_client_unwatch(AgentClient *c, int pid);
+bool agent_client_list(AgentClient *c, const AgentTargetInfo **targets, uint32_t *count);
+bool agent_client_query(AgentClient *c, int pid, uint64_t window_ns, uint32_t max_samples,
+                        const AgentSample **samples, uint32_t *count);
+bool agent_client_summary(AgentClient *c, int pid, AgentSummary *out);
+bool agent_client_subscribe(AgentClient *c, int pid);
+bool agent_client_shutdown(AgentClient *c);
+bool agent_client_watch_cgroup(AgentClient *c, const char *cgroup);
+bool agent_client_unwatch_cgroup(AgentClient *c, const char *cgroup);
+bool agent_client_list_cgroups(AgentClient *c, const AgentCgroupInfo **cgroups, uint32_t *count);
+bool agent_client_query_cgroup(AgentClient *c, const char *cgroup, const AgentCgroupEvent **events,
+                               uint32_t *count);
+bool agent_client_subscribe_cgroup(AgentClient *c, const char *cgroup);
+
+// Próxima amostra de uma assinatura. Retorna false quando o processo
+// terminou (AGENT_MSG_ENDED) ou a conexão foi fechada.
+bool agent_client_next_sample(AgentClient *c, AgentSample *out);
+
+// Próximo evento de uma assinatura de cgroup. O evento "removed" é o
+// último; false se a conexão foi fechada.
+bool agent_client_next_cgroup_event(AgentClient *c, AgentCgroupEvent *out);
+
+#endif // AGENT_H
@@ -0,0 +1,103 @@
+#ifndef CGROUP_EVENTS_H
+#define CGROUP_EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Observador de eventos de cgroups v2 (cgroup.events, memory.events e
+// pids.events) sem releituras periódicas. O kernel notifica esses arquivos
+// (kernfs_notify) a cada mudança: o descritor aberto fica com POLLPRI até
+// ser relido. Todos os arquivos de todos os cgroups entram num único epoll;
+// ocioso, o observador não faz nenhuma chamada. A cada despertar só os
+// arquivos notificados são relidos e cada contador alterado vira um evento
+// com o delta em relação à leitura anterior.
+//
+// O kernel limita as notificações de um mesmo arquivo a uma a cada 10 ms:
+// rajadas chegam agrupadas num só evento com o delta acumulado.
+//
+// O rmdir não notifica os arquivos do cgroup: a remoção vem do inotify
+// (IN_DELETE) no diretório pai, também dentro do mesmo epoll.
+//
+// Caminhos são relativos a CGROUP_ROOT, como em cgroup_stats.h.
+
+#define CG_EVENTS_MAX_KEYS 8            // chaves por arquivo (memory.events tem 6)
+#define CG_EVENTS_KEY_LEN  24
+
+typedef enum {
+    CG_EVENTS_CGROUP,                   // cgroup.events: populated, frozen
+    CG_EVENTS_MEMORY,                   // memory.events: low, high, max, oom, oom_kill...
+    CG_EVENTS_PIDS,                     // pids.events: max
+    CG_EVENTS_FILES
+} CgroupEventFile;
+
+typedef struct {
+    uint64_t mono_ns;           // despertar que trouxe o evento
+    uint64_t real_ns;
+    int cgroup;                 // índice retornado por cgroup_watcher_add
+    const char *path;
+    CgroupEventFile file;
+    const char *key;            // "oom_kill", "populated"; "removed" no rmdir
+    uint64_t value;             // valor atual
+    int64_t delta;              // em relação à leitura anterior (estados: +1/-1)
+} CgroupEvent;
+
+typedef void (*CgroupEventFn)(const CgroupEvent *ev, void *ctx);
+
+typedef struct {
+    int fd;                     // -1 = arquivo ausente (controlador desabilitado)
+    int nkeys;
+    char keys[CG_EVENTS_MAX_KEYS][CG_EVENTS_KEY_LEN];
+    uint64_t values[CG_EVENTS_MAX_KEYS];
+} CgroupEventSource;
+
+typedef struct {
+    char path[256];
+    int name_offset;            // último componente de path (nome no diretório pai)
+    int parent_wd;              // watch do inotify no pai (-1 = raiz)
+    bool active;                // false após cgroup_watcher_remove ou rmdir
+    CgroupEventSource files[CG_EVENTS_FILES];
+} CgroupWatch;
+
+typedef struct {
+    int epoll_fd;
+    int inotify_fd;             // IN_DELETE dos diretórios pais
+    CgroupWatch *cgroups;
+    int count;
+    int capacity;
+    CgroupEventFn fn;
+    void *ctx;
+    uint64_t wakeups;           // epoll_wait com arquivos prontos
+    uint64_t reads;             // arquivos relidos
+    uint64_t events;            // eventos entregues
+} CgroupWatcher;
+
+const char *cgroup_event_file_name(CgroupEventFile file);
+
+// Cria o epoll. fn recebe cada evento (NULL = só atualiza os valores).
+bool cgroup_watcher_init(CgroupWatcher *w, CgroupEventFn fn, void *ctx);
+
+// Registra os arquivos de eventos do cgroup; os ausentes são ignorados.
+// Os valores atuais viram a base (sem eventos). Retorna o índice do cgroup
+// ou -1 (com a mensagem no stderr) se nenhum arquivo pôde ser aberto.
+int cgroup_watcher_add(CgroupWatcher *w, const char *cgroup_path);
+
+// Deixa de observar o cgroup (o índice não é reaproveitado)
+void cgroup_watcher_remove(CgroupWatcher *w, int cgroup);
+
+// Valor mais recente de uma chave. false se o arquivo ou a chave não existem.
+bool cgroup_watcher_value(const CgroupWatcher *w, int cgroup, CgroupEventFile file, const char *key,
+                          uint64_t *value);
+
+// Descritor para o poll/epoll do chamador: legível quando há eventos
+static inline int cgroup_watcher_fd(const CgroupWatcher *w) { return w->epoll_fd; }
+
+// Espera até timeout_ms (0 = não bloqueia, -1 = indefinidamente), relê os
+// arquivos notificados e entrega os eventos. Retorna quantos foram
+// entregues ou -1 em erro (EINTR conta como 0).
+int cgroup_watcher_wait(CgroupWatcher *w, int timeout_ms);
+
+static inline int cgroup_watcher_dispatch(CgroupWatcher *w) { return cgroup_watcher_wait(w, 0); }
+
+void cgroup_watcher_close(CgroupWatcher *w);
+
+#endif // CGROUP_EVENTS_H
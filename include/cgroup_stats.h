@@ -0,0 +1,46 @@
+#ifndef CGROUP_STATS_H
+#define CGROUP_STATS_H
+
+#include <stddef.h>
+
+// Leitura das estatísticas de um cgroup v2 (cpu.stat, memory.*, io.stat),
+// compartilhada pelo cgroup_manager e pelo exportador do agente.
+// cgroup_name é relativo a CGROUP_ROOT ("" ou "/" = raiz).
+
+#define CGROUP_ROOT "/sys/fs/cgroup"
+#define MAX_LINE 1024
+
+// Estrutura para armazenar métricas
+typedef struct {
+    unsigned long cpu_usage_usec;
+    unsigned long cpu_user_usec;
+    unsigned long cpu_system_usec;
+    unsigned long nr_periods;
+    unsigned long nr_throttled;
+    unsigned long throttled_usec;
+} CPUStat;
+
+typedef struct {
+    unsigned long current;
+    unsigned long max;          // 0 = sem limite
+    unsigned long peak;
+    unsigned long anon;
+    unsigned long file;
+} MemoryStat;
+
+typedef struct {
+    unsigned long rbytes;
+    unsigned long wbytes;
+    unsigned long rios;
+    unsigned long wios;
+} IOStat;
+
+// Lê CGROUP_ROOT/cgroup_path/file inteiro em buffer (terminado em '\0')
+int read_cgroup_file(const char *cgroup_path, const char *file, char *buffer, size_t size);
+
+// Retornam 0 em sucesso e -1 se o arquivo principal não pôde ser lido
+int read_cpu_metrics(const char *cgroup_name, CPUStat *stat);
+int read_memory_metrics(const char *cgroup_name, MemoryStat *stat);
+int read_io_metrics(const char *cgroup_name, IOStat *stat);
+
+#endif // CGROUP_STATS_H
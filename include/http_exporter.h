@@ -0,0 +1,77 @@
+#ifndef HTTP_EXPORTER_H
+#define HTTP_EXPORTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "serializer.h"
+
+// Endpoint HTTP/1.1 de exposição no formato texto do Prometheus.
+// O corpo é renderizado uma vez por ciclo de coleta num memfd e servido
+// com sendfile a qualquer número de clientes: uma raspagem só copia
+// páginas já prontas do kernel para o socket, sem ler o /proc nem
+// reformatar nada. Cada resposta segura uma referência ao corpo com que
+// começou; um novo commit não afeta as transferências em andamento.
+//
+// Endereços aceitos: "/caminho/socket" (Unix), "host:porta" ou ":porta"
+// (127.0.0.1). Sem TLS nem autenticação: escute só em localhost.
+
+#define HTTP_DEFAULT_ADDRESS ":9464"     // porta sugerida (exemplos e ajuda)
+#define HTTP_MAX_CLIENTS     128
+#define HTTP_MAX_REQUEST     8192        // cabeçalhos de uma requisição
+#define HTTP_CONTENT_TYPE    "text/plain; version=0.0.4; charset=utf-8"
+
+typedef struct Exposition Exposition;  // corpo renderizado (memfd + referências)
+typedef struct HttpConn HttpConn;
+
+typedef struct {
+    int listen_fd;
+    int epoll_fd;               // conexões e escuta; o chamador espera nele
+    char address[108];
+    bool unix_socket;           // address é um caminho (removido no close)
+    HttpConn *conns[HTTP_MAX_CLIENTS];
+    Exposition *current;        // servido nas novas requisições (NULL = 503)
+    Exposition *pending;        // em renderização (entre begin e commit)
+    OutBuf render;              // buffer de renderização reaproveitado
+    uint64_t renders;
+    uint64_t scrapes;           // GET /metrics respondidos
+    uint64_t render_start_ns;
+    uint64_t last_render_ns;    // duração da última renderização
+} HttpExporter;
+
+// Abre o socket de escuta. Retorna false (com a mensagem no stderr) se o
+// endereço é inválido ou está em uso.
+bool http_exporter_open(HttpExporter *h, const char *address);
+
+// Descritor para o poll/epoll do chamador: legível quando há trabalho
+static inline int http_exporter_fd(const HttpExporter *h) { return h->epoll_fd; }
+
+// Atende o que estiver pronto (aceita, lê requisições, envia respostas)
+// sem bloquear
+void http_exporter_dispatch(HttpExporter *h);
+
+// Começa um novo corpo: o texto escrito no OutBuf retornado só passa a ser
+// servido em http_exporter_commit. NULL se o memfd não pôde ser criado.
+OutBuf *http_exporter_begin(HttpExporter *h);
+
+// Publica o corpo em renderização. Retorna false (mantendo o anterior) se
+// a escrita falhou.
+bool http_exporter_commit(HttpExporter *h);
+
+void http_exporter_close(HttpExporter *h);
+
+// ---------- Formato de exposição ----------
+
+// # HELP e # TYPE de uma família
+void expo_family(OutBuf *o, const char *name, const char *type, const char *help);
+
+// name{labels,extra} valor. labels e extra são pares já escapados
+// (k="v",...) e podem ser NULL ou "". Infinito sai como +Inf/-Inf.
+void expo_value(OutBuf *o, const char *name, const char *labels, const char *extra, double v, int decimals);
+void expo_value_u64(OutBuf *o, const char *name, const char *labels, const char *extra, uint64_t v);
+
+// Acrescenta key="value" (com \, " e \n escapados) à lista de rótulos em
+// buf, separado por vírgula. Retorna false se não coube.
+bool expo_label(char *buf, size_t size, const char *key, const char *value);
+
+#endif // HTTP_EXPORTER_H
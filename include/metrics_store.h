@@ -0,0 +1,148 @@
+#ifndef METRICS_STORE_H
+#define METRICS_STORE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "ring_buffer.h"
+
+// Dicionário de entidades (PID + nome) internadas: cada amostra guarda só
+// um índice de 32 bits. Entradas são imutáveis depois de publicadas e vivem
+// em blocos que nunca são realocados, então leitores concorrentes podem
+// consultá-las sem locks. O bloco k tem ENTITY_CHUNK_SIZE << k entradas:
+// com ENTITY_MAX_CHUNKS blocos o dicionário cobre todos os ids de 32 bits,
+// e capturas longas com muitas threads (um TID por entrada) não esgotam.
+#define ENTITY_NAME_LEN     64
+#define ENTITY_CHUNK_SIZE   256
+#define ENTITY_MAX_CHUNKS   24
+#define ENTITY_INVALID      UINT32_MAX
+
+typedef struct {
+    int pid;
+    char name[ENTITY_NAME_LEN];
+} EntityName;
+
+typedef struct {
+    EntityName *chunks[ENTITY_MAX_CHUNKS];
+    _Atomic uint32_t count;     // entradas publicadas
+    uint32_t *index;            // hash -> id + 1 (uso exclusivo do produtor)
+    size_t index_cap;
+    uint32_t last_id;           // atalho: amostras seguidas da mesma entidade
+    uint64_t dropped;           // internações falhas (linhas com ENTITY_INVALID)
+} EntityDict;
+
+// Retorna o id da entidade (criando-a se necessário) ou ENTITY_INVALID,
+// contado em dropped (sem memória)
+uint32_t entity_intern(EntityDict *d, int pid, const char *name);
+const EntityName *entity_get(const EntityDict *d, uint32_t id);
+
+// Store colunar (struct-of-arrays) com retenção fixa: uma coluna contígua
+// por métrica, indexada pelo slot do ring de seqlocks. Um produtor, vários
+// leitores sem locks (ver ring_buffer.h).
+typedef struct {
+    RingBuffer seq;             // apenas seqlocks (elem_size == 0)
+    EntityDict entities;
+    void *block;                // alocação única de todas as colunas
+
+    // Tempo e identidade
+    uint64_t *mono_ns;
+    uint64_t *real_ns;
+    uint64_t *interval_ns;      // intervalo agendado (varia no modo adaptativo)
+    uint32_t *entity;
+
+    // CPU
+    uint64_t *cpu_user;         // jiffies
+    uint64_t *cpu_system;       // jiffies
+    float *cpu_percent;
+    uint32_t *threads;
+    uint64_t *ctx_voluntary;
+    uint64_t *ctx_nonvoluntary;
+
+    // Memória
+    uint64_t *mem_vsize;        // bytes
+    uint64_t *mem_rss;          // bytes
+    uint64_t *mem_shared;       // bytes
+    uint64_t *faults_minor;
+    uint64_t *faults_major;
+    uint64_t *mem_swap_kb;
+
+    // I/O
+    uint64_t *io_read_bytes;
+    uint64_t *io_write_bytes;
+    uint64_t *io_cancelled_bytes;
+    uint64_t *io_read_syscalls;
+    uint64_t *io_write_syscalls;
+    float *io_read_kbs;
+    float *io_write_kbs;
+
+    // Rede
+    uint64_t *net_rx_bytes;
+    uint64_t *net_tx_bytes;
+    uint64_t *net_rx_packets;
+    uint64_t *net_tx_packets;
+    uint64_t *net_rx_queue;
+    uint64_t *net_tx_queue;
+    uint32_t *net_connections;
+} MetricsStore;
+
+// Store colunar por thread: mesma organização do MetricsStore, com a
+// thread como entidade (TID + comm no dicionário) e o processo dono numa
+// coluna própria. Cada amostra de um processo gera uma linha por thread.
+typedef struct {
+    RingBuffer seq;
+    EntityDict entities;        // pid do EntityName = TID
+    void *block;
+
+    uint64_t *mono_ns;
+    uint32_t *entity;
+    uint32_t *pid;              // processo dono (TGID)
+
+    uint64_t *cpu_user;         // jiffies
+    uint64_t *cpu_system;       // jiffies
+    float *cpu_percent;
+    uint64_t *ctx_voluntary;
+    uint64_t *ctx_nonvoluntary;
+    float *ctx_rate;            // trocas por segundo
+    int32_t *processor;         // última CPU
+    uint8_t *state;
+} ThreadStore;
+
+// Métricas com agregação disponível
+typedef enum {
+    METRIC_CPU_PERCENT = 0,
+    METRIC_MEM_RSS,
+    METRIC_MEM_VSIZE,
+    METRIC_THREADS,
+    METRIC_IO_READ_KBS,
+    METRIC_IO_WRITE_KBS,
+    METRIC_COUNT
+} MetricId;
+
+typedef struct {
+    size_t count;
+    double min;
+    double max;
+    double avg;
+    double p50;
+    double p95;
+    double p99;
+} MetricStats;
+
+bool metrics_store_init(MetricsStore *s, size_t retention);
+void metrics_store_free(MetricsStore *s);
+
+// Bytes ocupados por amostra (soma das larguras das colunas + seqlock)
+size_t metrics_store_row_bytes(void);
+
+bool thread_store_init(ThreadStore *s, size_t retention);
+void thread_store_free(ThreadStore *s);
+
+// Nome legível da métrica (ex.: "cpu_percent")
+const char *metric_name(MetricId id);
+
+// Agregados sobre a janela retida. Tolerante a um produtor concorrente:
+// linhas sobrescritas durante o cálculo são descartadas.
+bool metrics_store_stats(const MetricsStore *s, MetricId id, MetricStats *out);
+
+#endif // METRICS_STORE_H
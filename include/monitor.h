@@ -3,11 +3,16 @@
 
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "proc_reader.h"
 
 // Estrutura para armazenar os dados de monitoramento de recursos
 typedef struct {
     // Timestamp
     time_t timestamp;
+    uint64_t mono_ns;  // CLOCK_MONOTONIC (base dos cálculos de taxa)
+    uint64_t real_ns;  // CLOCK_REALTIME (ns desde a época Unix)
+    uint64_t interval_ns; // intervalo agendado até esta amostra (0 = primeira)
     int pid;
 
     // CPU
@@ -38,6 +43,15 @@ typedef struct {
     long long net_tx_bytes;
     long long net_rx_packets;
     long long net_tx_packets;
+    int net_connections;          // sockets TCP do processo
+    long long net_rx_queue;       // bytes recebidos e não lidos nos sockets
+    long long net_tx_queue;       // bytes na fila de envio
+
+    // Delay accounting (ns acumulados): só no backend taskstats
+    long long cpu_delay_ns;       // esperando na fila de execução
+    long long blkio_delay_ns;     // esperando I/O de bloco síncrono
+    long long swapin_delay_ns;
+    long long freepages_delay_ns; // reclaim de memória
 
 } ResourceData;
 
@@ -46,4 +60,10 @@ bool get_cpu_data(int pid, ResourceData *data);
 bool get_memory_data(int pid, ResourceData *data);
 bool get_io_data(int pid, ResourceData *data);
 
+// Variantes que reutilizam um ProcHandle aberto (sem open/close por amostra).
+// Chame proc_handle_begin_sample() antes de cada rodada de coleta.
+bool get_cpu_data_handle(ProcHandle *h, ResourceData *data);
+bool get_memory_data_handle(ProcHandle *h, ResourceData *data);
+bool get_io_data_handle(ProcHandle *h, ResourceData *data);
+
 #endif // MONITOR_H
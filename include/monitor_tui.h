@@ -5,12 +5,21 @@
 #ifndef MONITOR_TUI_H
 #define MONITOR_TUI_H
 
+#include <stdint.h>
 #include <sys/types.h>
+#include "proc_scanner.h"
 
 // Executa a interface TUI para monitorar um processo
-// Se interval e duration forem 0, executa em modo interativo (infinito)
-// Se duration > 0, executa por tempo determinado e gera output JSON
+// interval_ns e duration_ns em nanossegundos (0 = padrão de 1s / sem limite)
+// Se duration_ns for 0, executa em modo interativo (infinito)
+// Se duration_ns > 0, executa por tempo determinado e gera output JSON
 // Retorna 0 em sucesso, -1 em erro
-int run_tui(pid_t pid, int interval, int duration);
+int run_tui(pid_t pid, uint64_t interval_ns, uint64_t duration_ns);
+
+// Tela "top" com todos os processos (ou os que passam em filter, ver
+// proc_scanner.h), colunas ordenáveis e busca incremental. filter_desc
+// descreve o filtro no cabeçalho (NULL = todos). Executa até 'q'.
+// Retorna 0 em sucesso, -1 em erro
+int run_top_tui(ProcFilterFn filter, void *filter_arg, const char *filter_desc, uint64_t interval_ns);
 
 #endif // MONITOR_TUI_H
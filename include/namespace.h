@@ -1,6 +1,10 @@
 #ifndef NAMESPACE_H
 #define NAMESPACE_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 // Estrutura para representar informações de um namespace
 typedef struct {
     char type[20];
@@ -8,22 +12,87 @@ typedef struct {
     unsigned long inode;
 } NamespaceInfo;
 
+#define NS_REPORT_MAX_WORKERS 16
+
+// ---------- Agregação do relatório: namespace -> PIDs ----------
+
+// Tabela hash de endereçamento aberto com chave (tipo, inode). Caminhos e
+// listas de PIDs ficam numa arena de blocos, liberada de uma vez em
+// ns_report_free; as listas crescem dobrando (no lugar, se forem a última
+// alocação do bloco).
+typedef struct NsArenaBlock NsArenaBlock;
+
+typedef struct {
+    unsigned long inode;
+    char type[20];
+    const char *path;           // na arena
+    int *pids;                  // na arena, na ordem de inserção
+    int pid_count;
+    int pid_cap;
+} NsReportEntry;
+
+typedef struct {
+    NsReportEntry *entries;     // na ordem em que os namespaces apareceram
+    int count;
+    int cap;
+    int32_t *slots;             // índice em entries; -1 = vazio
+    size_t slot_mask;           // capacidade - 1 (potência de 2)
+    NsArenaBlock *arena;        // bloco atual (encadeado aos anteriores)
+    size_t arena_bytes;         // reservado pela arena
+} NsReport;
+
+bool ns_report_init(NsReport *r);
+
+// Registra o pid no namespace (tipo + inode); false se faltou memória
+bool ns_report_add(NsReport *r, const NamespaceInfo *ns, int pid);
+
+// Acrescenta os PIDs de part aos de into (namespaces novos vão para o fim)
+bool ns_report_merge(NsReport *into, const NsReport *part);
+
+// Entrada do namespace ou NULL
+const NsReportEntry *ns_report_find(const NsReport *r, const char *type, unsigned long inode);
+
+// Relatório em JSON: [{type, inode, path, pids}, ...]
+bool ns_report_write_json(const NsReport *r, const char *filename);
+
+void ns_report_free(NsReport *r);
+
 // Obtém os namespaces de um processo
 int get_process_namespaces(int pid, NamespaceInfo *ns_info, int max_ns);
 
+// Igual, com /proc já aberto (proc_fd): openat de "<pid>/ns" e
+// fstatat/readlinkat relativos a ele
+int get_process_namespaces_at(int proc_fd, int pid, NamespaceInfo *ns_info, int max_ns);
+
 // Lista os namespaces de um processo
 void list_process_namespaces(int pid);
 
+// Índice persistente namespace -> PIDs (ns_index.h). As versões *_indexed
+// abaixo respondem da memória; PIDs fora do índice caem na leitura do /proc.
+typedef struct NsIndex NsIndex;
+
 // Compara os namespaces de dois processos
 void compare_process_namespaces(int pid1, int pid2);
+void compare_process_namespaces_indexed(const NsIndex *idx, int pid1, int pid2);
 
 // Encontra processos em um determinado namespace
 void find_processes_in_namespace(const char *ns_path);
+void find_processes_in_namespace_indexed(const NsIndex *idx, const char *ns_path);
 
-// Gera um relatório de namespaces do sistema para um arquivo JSON
+// Gera um relatório de namespaces do sistema para um arquivo JSON. Os PIDs
+// são divididos em faixas entre até NS_REPORT_MAX_WORKERS threads (uma por
+// CPU); o resultado não depende do número de threads.
 void generate_system_namespace_report(const char *filename);
 
-// Mede o overhead de criação de um novo namespace
+// Igual, com um número fixo de threads (0 = automático)
+void generate_system_namespace_report_workers(const char *filename, int workers);
+
+// Relatório a partir do índice, sem varrer o /proc
+void generate_system_namespace_report_indexed(const NsIndex *idx, const char *filename);
+
+// Latência de criação (unshare e clone3 sem o custo do fork) de cada tipo
+// e das combinações de contêiner e de destruição do netns (ns_latency.h),
+// com os parâmetros padrão; resultados em output/namespace_latency.json
 void measure_namespace_creation_overhead();
 
 #endif // NAMESPACE_H
@@ -2,7 +2,13 @@
 #define NETWORK_H
 
 #include "monitor.h"
+#include "sock_diag.h"
 
 bool get_network_data(int pid, ResourceData *data);
 
+// Rede do processo a partir dos seus sockets (sock_diag). sockets guarda a
+// lista de sockets entre amostras. Sem acesso a eles (outro usuário, outro
+// namespace sem privilégio) usa os totais de /proc/<pid>/net/dev.
+bool get_network_data_handle(ProcHandle *h, ProcSockets *sockets, ResourceData *data);
+
 #endif // NETWORK_H
@@ -0,0 +1,110 @@
+#ifndef NS_INDEX_H
+#define NS_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "namespace.h"
+
+// Índice persistente namespace -> PIDs. Montado por uma varredura do /proc
+// e mantido pelos eventos do proc connector (NETLINK_CONNECTOR): FORK lê
+// os namespaces do filho, EXEC relê os do processo (unshare seguido de
+// exec, como em `unshare -n cmd`) e EXIT o remove. setns/unshare sem exec
+// não geram evento: varreduras periódicas de reconciliação corrigem esses
+// casos e as perdas de eventos (buffer do socket cheio). O connector
+// requer CAP_NET_ADMIN; sem ele cada ns_index_poll refaz a varredura.
+
+#define NS_INDEX_TYPES        10
+#define NS_INDEX_RESCAN_NS    (60ULL * 1000000000ULL)   // reconciliação com o connector
+
+// Processo indexado: entrada do índice por tipo (-1 = sem namespace) e
+// posição do PID na lista dessa entrada
+typedef struct {
+    int pid;                    // 0 = slot livre
+    uint32_t scan;              // última varredura em que foi visto
+    int32_t entry[NS_INDEX_TYPES];
+    int32_t pos[NS_INDEX_TYPES];
+} NsIndexProc;
+
+typedef struct {
+    unsigned long inode;
+    int type;                   // índice em ns_index_type_name
+    int *pids;                  // sem ordem (remoção por troca com o último)
+    int count;
+    int cap;
+    int32_t next_free;          // lista de entradas livres (count == 0)
+} NsIndexEntry;
+
+struct NsIndex {
+    // PID -> processo (endereçamento aberto, remoção por deslocamento reverso)
+    NsIndexProc *procs;
+    size_t proc_cap;            // potência de 2
+    size_t proc_count;
+
+    // (tipo, inode) -> entrada
+    NsIndexEntry *entries;
+    int32_t entry_cap;
+    int32_t entry_used;         // entradas já alocadas (livres ou não)
+    int32_t free_entry;         // -1 = nenhuma livre
+    int32_t *slots;             // índice em entries; -1 = vazio
+    size_t slot_mask;
+    size_t ns_count;            // namespaces com ao menos um processo
+
+    int proc_fd;                // /proc aberto
+    int nl_fd;                  // proc connector, -1 se indisponível
+    uint32_t scan;
+    bool stale;                 // eventos perdidos: reconciliar no próximo poll
+    uint64_t rescan_ns;         // intervalo da reconciliação periódica
+    uint64_t last_scan_ns;
+    uint64_t last_scan_cost_ns;
+
+    // Contadores
+    uint64_t scans;
+    uint64_t forks;
+    uint64_t execs;
+    uint64_t exits;
+    uint64_t lost;              // recv com ENOBUFS
+    uint64_t fixed;             // processos corrigidos por reconciliação
+};
+
+// Nome do tipo (como em /proc/<pid>/ns); NULL fora do intervalo
+const char *ns_index_type_name(int type);
+
+// Índice do tipo ou -1
+int ns_index_type(const char *name);
+
+// Abre /proc e faz a varredura inicial. rescan_ns = 0 usa NS_INDEX_RESCAN_NS.
+bool ns_index_init(NsIndex *idx, uint64_t rescan_ns);
+
+// Inscreve no proc connector. Retorna false (com aviso) se indisponível:
+// o índice continua válido, atualizado só por varreduras.
+bool ns_index_listen(NsIndex *idx);
+
+// Descritor do connector para o poll/epoll do chamador (-1 se não há)
+static inline int ns_index_fd(const NsIndex *idx) { return idx->nl_fd; }
+
+// Aplica os eventos pendentes sem bloquear. Retorna quantos foram lidos.
+int ns_index_dispatch(NsIndex *idx);
+
+// Varredura completa de reconciliação
+bool ns_index_rescan(NsIndex *idx);
+
+// Antes de uma consulta: aplica os eventos e reconcilia se houve perda, se
+// o intervalo venceu ou se não há connector
+bool ns_index_poll(NsIndex *idx);
+
+void ns_index_close(NsIndex *idx);
+
+// ---------- Consultas (da memória) ----------
+
+// Namespaces do processo, no formato de get_process_namespaces; -1 se o
+// PID não está no índice
+int ns_index_get(const NsIndex *idx, int pid, NamespaceInfo *ns_info, int max_ns);
+
+// PIDs do namespace (sem ordem) ou NULL se não há processo nele
+const int *ns_index_members(const NsIndex *idx, int type, unsigned long inode, int *count);
+
+// Relatório do sistema (mesma ordem da varredura: PIDs crescentes)
+bool ns_index_report(const NsIndex *idx, NsReport *out);
+
+#endif // NS_INDEX_H
@@ -0,0 +1,71 @@
+#ifndef NS_LATENCY_H
+#define NS_LATENCY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Latência de criação e destruição de namespaces, sem processos externos.
+// Para cada conjunto de tipos (ex.: "net", "pid+net+mnt"):
+// - unshare: um filho por repetição mede só a chamada unshare(flags)
+// - clone3: o pai mede clone3(flags) + exit + wait do filho e subtrai a
+//   mediana do mesmo ciclo sem flags (o custo do fork)
+// A destruição do netns é assíncrona (workqueue cleanup_net): mede-se do
+// término do último processo até o RTM_DELLINK do veth que tinha uma
+// ponta dentro dele. As primeiras `warmup` repetições são descartadas.
+
+#define NS_LATENCY_MAX_SETS       24
+#define NS_LATENCY_BUCKETS        24      // log2 de microssegundos: <2us, 2-4us, ... >=8s
+#define NS_LATENCY_DEFAULT_REPS   100
+#define NS_LATENCY_DEFAULT_WARMUP 10
+
+typedef struct {
+    int count;
+    uint64_t min_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    double mean_ns;
+    uint32_t buckets[NS_LATENCY_BUCKETS];
+} NsLatencyHist;
+
+typedef struct {
+    char name[96];              // tipos separados por '+'
+    int flags;                  // CLONE_NEW*
+    int error;                  // errno da primeira falha (0 = medido)
+    NsLatencyHist unshare;
+    NsLatencyHist clone3;       // já sem o custo do fork
+} NsLatencyResult;
+
+typedef struct {
+    int repetitions;
+    int warmup;
+    NsLatencyHist fork_baseline;    // clone3 sem flags + exit + wait
+    NsLatencyHist netns_teardown;
+    int teardown_error;             // errno (0 = medido)
+    NsLatencyResult results[NS_LATENCY_MAX_SETS];
+    int count;
+} NsLatencyReport;
+
+// "pid+net+mnt" -> CLONE_NEWPID | CLONE_NEWNET | CLONE_NEWNS. "all" =
+// todos os oito tipos. Retorna false se algum nome é desconhecido.
+bool ns_latency_parse_set(const char *spec, int *flags);
+
+// Conjuntos padrão: cada tipo isolado e as combinações de contêineres
+int ns_latency_default_sets(const char **sets, int max);
+
+// Ordena as amostras e preenche o histograma
+void ns_latency_hist(NsLatencyHist *h, uint64_t *samples, int count);
+
+// Mede os conjuntos (NULL/0 = padrão). Requer root para a maioria dos
+// tipos; conjuntos que falham ficam com error preenchido.
+bool ns_latency_run(NsLatencyReport *r, const char **sets, int nsets, int repetitions, int warmup);
+
+void ns_latency_print(const NsLatencyReport *r);
+bool ns_latency_write_json(const NsLatencyReport *r, const char *filename);
+
+// Mede, imprime a tabela e grava o JSON em output_file
+bool run_namespace_latency_benchmark(const char **sets, int nsets, int repetitions, int warmup,
+                                     const char *output_file);
+
+#endif // NS_LATENCY_H
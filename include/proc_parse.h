@@ -0,0 +1,75 @@
+#ifndef PROC_PARSE_H
+#define PROC_PARSE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Tokenizador compartilhado para /proc/<pid>/{stat,statm,status,io}.
+// Nenhuma função aloca memória: tudo é escrito nas estruturas do chamador.
+
+// Campos de /proc/<pid>/stat (numeração conforme proc(5))
+typedef struct {
+    int pid;                        // 1
+    char comm[64];                  // 2  (pode conter espaços e parênteses)
+    char state;                     // 3
+    int ppid;                       // 4
+    unsigned long minflt;           // 10
+    unsigned long majflt;           // 12
+    unsigned long utime;            // 14 (jiffies)
+    unsigned long stime;            // 15 (jiffies)
+    long priority;                  // 18
+    long nice;                      // 19
+    long num_threads;               // 20
+    unsigned long long starttime;   // 22 (jiffies desde o boot)
+    unsigned long vsize;            // 23 (bytes)
+    long rss;                       // 24 (páginas)
+    int processor;                  // 39 (última CPU em que executou)
+} ProcStat;
+
+// Campos de /proc/<pid>/statm (em páginas)
+typedef struct {
+    unsigned long size;
+    unsigned long resident;
+    unsigned long shared;
+    unsigned long text;
+    unsigned long lib;
+    unsigned long data;
+    unsigned long dt;
+} ProcStatm;
+
+// Campos de /proc/<pid>/status usados pelo monitor (valores Vm*/Rss* em KB)
+typedef struct {
+    unsigned long long threads;
+    unsigned long long vm_peak_kb;
+    unsigned long long vm_size_kb;
+    unsigned long long vm_hwm_kb;
+    unsigned long long vm_rss_kb;
+    unsigned long long rss_anon_kb;
+    unsigned long long rss_file_kb;
+    unsigned long long rss_shmem_kb;
+    unsigned long long vm_swap_kb;
+    unsigned long long voluntary_ctxt_switches;
+    unsigned long long nonvoluntary_ctxt_switches;
+} ProcStatus;
+
+// Campos de /proc/<pid>/io
+typedef struct {
+    unsigned long long rchar;
+    unsigned long long wchar;
+    unsigned long long syscr;
+    unsigned long long syscw;
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    unsigned long long cancelled_write_bytes;
+} ProcIo;
+
+// Cada parser recebe o conteúdo bruto do arquivo (não precisa ser terminado em '\0').
+// stat: localiza o último ')' para delimitar comm. Retorna false se malformado.
+bool proc_parse_stat(const char *buf, size_t len, ProcStat *out);
+bool proc_parse_statm(const char *buf, size_t len, ProcStatm *out);
+
+// status/io: campos ausentes ficam zerados. Chaves são resolvidas por hash perfeito.
+bool proc_parse_status(const char *buf, size_t len, ProcStatus *out);
+bool proc_parse_io(const char *buf, size_t len, ProcIo *out);
+
+#endif // PROC_PARSE_H
@@ -0,0 +1,72 @@
+#ifndef PROC_READER_H
+#define PROC_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Arquivos de /proc/<pid> mantidos abertos por um ProcHandle
+typedef enum {
+    PROC_FILE_STAT = 0,
+    PROC_FILE_STATM,
+    PROC_FILE_STATUS,
+    PROC_FILE_IO,
+    PROC_FILE_NET_DEV,
+    PROC_FILE_NET_TCP,
+    PROC_FILE_NET_TCP6,
+    PROC_FILE_COUNT
+} ProcFileId;
+
+// Descritor persistente + buffer reutilizável de um arquivo
+typedef struct {
+    int fd;                     // -1 = ainda não aberto, -2 = indisponível (ENOENT/EACCES)
+    char *buf;
+    size_t cap;
+    size_t len;
+    unsigned long generation;   // geração da amostra em que buf foi preenchido
+} ProcFile;
+
+// Handle de coleta para um PID: abre cada arquivo uma única vez e
+// relê o conteúdo com pread a partir do deslocamento 0 a cada amostra
+// (os arquivos de net/ exigem vários pread, um por página).
+typedef struct {
+    int pid;
+    int dir_fd;                 // O_PATH de /proc/<pid>, base para openat()
+    bool valid;                 // false após o processo terminar
+    unsigned long generation;   // incrementado por proc_handle_begin_sample
+    ProcFile files[PROC_FILE_COUNT];
+} ProcHandle;
+
+// Abre o handle. Somente /proc/<pid>/stat é aberto imediatamente (valida o PID);
+// os demais arquivos são abertos sob demanda na primeira leitura.
+// O handle deve estar zerado antes do primeiro uso (ProcHandle h = {0});
+// reabrir um handle já usado reaproveita seus buffers.
+// Retorna false se o processo não existe.
+bool proc_handle_open(ProcHandle *h, int pid);
+
+// Fecha todos os descritores e libera os buffers
+void proc_handle_close(ProcHandle *h);
+
+// Fecha os descritores e marca o handle como inválido (processo terminou).
+// Os buffers são mantidos para reaproveitamento por um novo proc_handle_open.
+void proc_handle_invalidate(ProcHandle *h);
+
+// Fecha os descritores de todos os arquivos exceto stat (e o diretório),
+// mantendo os buffers: reabertos sob demanda na próxima leitura. Reduz os
+// descritores de processos que ficam muito tempo sem ser lidos por completo.
+void proc_handle_trim(ProcHandle *h);
+
+// Inicia uma nova amostra: leituras seguintes relêem os arquivos do kernel.
+// Dentro da mesma amostra, ler o mesmo arquivo duas vezes devolve o buffer já lido.
+void proc_handle_begin_sample(ProcHandle *h);
+
+// Lê (ou devolve do cache da amostra atual) o conteúdo de um arquivo.
+// O buffer retornado é terminado em '\0' e pertence ao handle.
+// Retorna NULL se o arquivo não está disponível ou se o processo terminou
+// (neste caso o handle é invalidado).
+const char *proc_handle_read(ProcHandle *h, ProcFileId id, size_t *len);
+
+static inline bool proc_handle_valid(const ProcHandle *h) {
+    return h && h->valid;
+}
+
+#endif // PROC_READER_H
@@ -0,0 +1,68 @@
+#ifndef PROC_SCANNER_H
+#define PROC_SCANNER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include "process_table.h"
+
+// Filtro de processos, avaliado uma vez quando o PID aparece
+typedef bool (*ProcFilterFn)(int pid, void *arg);
+
+// Varredura incremental de /proc para telas com milhares de processos.
+// A cada tick:
+// - /proc só é relido (readdir) se /proc/loadavg indica que processos ou
+//   threads foram criados ou encerrados desde o último tick; caso
+//   contrário a lista de PIDs anterior é reaproveitada
+// - cada PID é atualizado com process_table_refresh, que relê stat e só
+//   relê status, statm e io de processos cujo stat mudou
+// O estado por PID (handles abertos, amostra anterior) persiste na tabela.
+typedef struct {
+    ProcessTable table;
+    DIR *proc_dir;
+    int loadavg_fd;
+    unsigned long last_pid;         // último PID criado (campo 5 de loadavg)
+    unsigned long nr_threads;       // total de threads (campo 4 de loadavg)
+    int *pids;                      // PIDs da última leitura de /proc
+    size_t npids;
+    size_t pids_cap;
+    ProcFilterFn filter;            // NULL = todos os processos
+    void *filter_arg;
+
+    // Estatísticas do último tick
+    bool rescanned;                 // /proc foi relido
+    size_t visible;                 // processos que passam no filtro
+    size_t exited;                  // removidos pelo sweep
+    uint64_t cpu_ns;                // tempo de CPU da thread gasto no tick
+} ProcScanner;
+
+// Seletor de namespace para proc_filter_namespace
+typedef struct {
+    char type[16];                  // "net", "pid", "mnt", "uts", "ipc", "user", "cgroup"
+    ino_t inode;
+} ProcNamespaceFilter;
+
+// filter pode ser NULL. Retorna false se /proc não pôde ser aberto.
+bool proc_scanner_init(ProcScanner *s, ProcFilterFn filter, void *filter_arg);
+void proc_scanner_free(ProcScanner *s);
+
+// Executa um tick de coleta. Retorna false em erro de leitura de /proc.
+bool proc_scanner_tick(ProcScanner *s);
+
+// Força a releitura de /proc no próximo tick
+void proc_scanner_invalidate(ProcScanner *s);
+
+// arg: caminho do cgroup v2 relativo à raiz da hierarquia ("/system.slice").
+// Aceita também o caminho absoluto em /sys/fs/cgroup. Inclui descendentes.
+bool proc_filter_cgroup(int pid, void *arg);
+
+// arg: ProcNamespaceFilter. Processos no mesmo namespace do tipo indicado.
+bool proc_filter_namespace(int pid, void *arg);
+
+// Preenche f com o namespace `type` do processo pid. Retorna false se o
+// tipo é inválido ou o processo não existe.
+bool proc_namespace_filter_init(ProcNamespaceFilter *f, const char *type, int pid);
+
+#endif // PROC_SCANNER_H
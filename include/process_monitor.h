@@ -1,14 +1,27 @@
 #ifndef PROCESS_MONITOR_H
 #define PROCESS_MONITOR_H
 
+#include <stdio.h>
 #include <time.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "proc_reader.h"
+#include "metrics_store.h"
+#include "thread_table.h"
+#include "sock_diag.h"
+#include "stats.h"
+#include "serializer.h"
+#include "ring_buffer.h"
+#include "psi.h"
 
 // Estrutura detalhada de métricas de processo
 typedef struct {
     time_t timestamp;
+    uint64_t mono_ns;                  // CLOCK_MONOTONIC (base dos cálculos de taxa)
+    uint64_t real_ns;                  // CLOCK_REALTIME (ns desde a época Unix)
+    uint64_t interval_ns;              // intervalo agendado até esta amostra (0 = primeira)
     int pid;
-    char process_name[256];
+    char process_name[64];             // comm (mesmo limite de ProcStat)
     
     // CPU
     unsigned long cpu_user_time;       // User mode time (jiffies)
@@ -41,16 +54,34 @@ typedef struct {
     unsigned long long net_tx_bytes;
     unsigned long long net_rx_packets;
     unsigned long long net_tx_packets;
-    int net_connections;
+    int net_connections;               // sockets TCP do processo
+    unsigned long long net_rx_queue;   // bytes recebidos e não lidos (sock_diag)
+    unsigned long long net_tx_queue;   // bytes na fila de envio (sock_diag)
     
 } ProcessMetrics;
 
-// Histórico de métricas para cálculo de taxas
+// Retenção padrão do histórico (amostras); acima disso as mais antigas são descartadas
+#define DEFAULT_HISTORY_RETENTION 16384
+
+// Retenção padrão do histórico por thread (linhas: uma por thread por amostra)
+#define DEFAULT_THREAD_HISTORY_RETENTION 65536
+
+// Retenção padrão dos eventos de pressão (PSI)
+#define DEFAULT_STALL_HISTORY_RETENTION 1024
+
+// Histórico de métricas com retenção fixa, em layout colunar (metrics_store.h):
+// cada métrica numa coluna própria e o nome do processo internado num
+// dicionário, em vez de um ProcessMetrics completo por amostra.
+// Um único produtor chama add_metrics_sample; TUI, exportadores e análises
+// leem concorrentemente com metrics_history_read, sem locks.
 typedef struct {
-    ProcessMetrics *samples;
-    int count;
-    int capacity;
+    MetricsStore store;
+    ProcessMetrics last;        // última amostra (uso exclusivo do produtor, para deltas)
+    bool has_last;
     time_t start_time;
+    ThreadStore *threads;       // dimensão por TID (NULL = desativada)
+    RingBuffer *stalls;         // PsiEvent dos gatilhos PSI (NULL = desativado)
+    MetricsSummary summary;     // toda a captura, independente da retenção (produtor)
 } MetricsHistory;
 
 // Funções de coleta
@@ -60,23 +91,91 @@ bool collect_memory_metrics(int pid, ProcessMetrics *metrics);
 bool collect_io_metrics(int pid, ProcessMetrics *metrics);
 bool collect_network_metrics(int pid, ProcessMetrics *metrics);
 
+// Coleta completa reutilizando os descritores persistentes do handle.
+// sockets guarda a lista de sockets do processo entre amostras (NULL =
+// coleta avulsa). Retorna false quando o processo terminou (o handle fica
+// inválido).
+bool collect_process_metrics_handle(ProcHandle *h, ProcSockets *sockets, ProcessMetrics *metrics);
+
+// Grupos de métricas para collect_process_metrics_groups
+#define PROC_METRICS_CPU      0x1   // stat + status (sempre coletado)
+#define PROC_METRICS_MEMORY   0x2   // statm
+#define PROC_METRICS_IO       0x4   // io (requer permissão sobre o processo)
+#define PROC_METRICS_NETWORK  0x8   // sockets do processo (sock_diag) ou visão do netns
+#define PROC_METRICS_LOCAL    (PROC_METRICS_CPU | PROC_METRICS_MEMORY | PROC_METRICS_IO)
+#define PROC_METRICS_ALL      (PROC_METRICS_LOCAL | PROC_METRICS_NETWORK)
+
+// Coleta apenas os grupos pedidos. Grupos ilegíveis (ex.: io de outro
+// usuário) ficam zerados; retorna false somente se o processo terminou.
+bool collect_process_metrics_groups(ProcHandle *h, ProcessMetrics *metrics, unsigned groups);
+
+// Como collect_process_metrics_groups, mas dentro da amostra já iniciada
+// pelo chamador com proc_handle_begin_sample (arquivos já lidos nela não
+// são relidos do kernel)
+bool collect_process_metrics_sampled(ProcHandle *h, ProcessMetrics *metrics, unsigned groups);
+
 // Funções de cálculo
 void calculate_cpu_percent(ProcessMetrics *current, ProcessMetrics *previous);
 void calculate_io_rates(ProcessMetrics *current, ProcessMetrics *previous);
 
 // Funções de monitoramento contínuo
-void monitor_process_continuous(int pid, int interval_sec, int duration_sec, const char *export_format);
+// Intervalo e duração em nanossegundos (ver parse_duration_ns em timing.h).
+// retention limita o histórico exportado (0 = DEFAULT_HISTORY_RETENTION).
+// adaptive_max_ns > interval_ns ativa o intervalo adaptativo com esse teto
+// (0 = intervalo fixo).
+void monitor_process_continuous(int pid, uint64_t interval_ns, uint64_t duration_ns,
+                                const char *export_format, size_t retention, uint64_t adaptive_max_ns);
 void monitor_process_interactive(void);
 
+// Monitoramento multi-processo ("top"): pids == NULL amostra todo o /proc,
+// caso contrário apenas os npids PIDs informados
+void monitor_processes_continuous(const int *pids, int npids, uint64_t interval_ns, uint64_t duration_ns);
+
+// Eleva o limite flexível de descritores abertos até o limite rígido
+// (o modo multi-processo mantém arquivos de /proc abertos por processo)
+void raise_fd_limit(void);
+
 // Funções de exportação
 bool export_metrics_json(const char *filename, MetricsHistory *history);
 bool export_metrics_csv(const char *filename, MetricsHistory *history);
+void write_metrics_csv_header(OutBuf *o);
+void write_metrics_csv_row(OutBuf *o, const ProcessMetrics *m);
+void write_metrics_json_sample(OutBuf *o, const ProcessMetrics *m, bool with_process);
+void write_metrics_ndjson_row(OutBuf *o, const ProcessMetrics *m);
 
-// Gerenciamento de histórico
-MetricsHistory* create_metrics_history(int initial_capacity);
+// Gerenciamento de histórico (retention = máximo de amostras mantidas)
+MetricsHistory* create_metrics_history(size_t retention);
 void add_metrics_sample(MetricsHistory *history, ProcessMetrics *metrics);
 void free_metrics_history(MetricsHistory *history);
 
+// Leitura concorrente: posições em [metrics_history_oldest, metrics_history_head).
+// metrics_history_read retorna false se a posição já foi sobrescrita.
+uint64_t metrics_history_head(const MetricsHistory *history);
+uint64_t metrics_history_oldest(const MetricsHistory *history);
+bool metrics_history_read(const MetricsHistory *history, uint64_t pos, ProcessMetrics *out);
+
+// Agregados (mín/máx/média/p50/p95/p99) de uma métrica sobre a janela retida
+bool metrics_history_stats(const MetricsHistory *history, MetricId metric, MetricStats *out);
+
+// Histórico por thread: ativado uma vez antes da primeira amostra
+// (retention = linhas mantidas, 0 = DEFAULT_THREAD_HISTORY_RETENTION).
+// add_thread_samples grava uma linha por thread da última amostra da
+// tabela; a leitura segue as mesmas regras de metrics_history_read.
+bool metrics_history_enable_threads(MetricsHistory *history, size_t retention);
+void add_thread_samples(MetricsHistory *history, const ThreadTable *threads);
+uint64_t metrics_history_thread_head(const MetricsHistory *history);
+uint64_t metrics_history_thread_oldest(const MetricsHistory *history);
+bool metrics_history_read_thread(const MetricsHistory *history, uint64_t pos, ThreadMetrics *out);
+
+// Eventos de pressão: ativado uma vez (retention = eventos mantidos, 0 =
+// DEFAULT_STALL_HISTORY_RETENTION). add_stall_event pode ser passado como
+// callback (PsiEventFn) com o histórico como contexto.
+bool metrics_history_enable_stalls(MetricsHistory *history, size_t retention);
+void add_stall_event(const PsiEvent *ev, void *history);
+uint64_t metrics_history_stall_head(const MetricsHistory *history);
+uint64_t metrics_history_stall_oldest(const MetricsHistory *history);
+bool metrics_history_read_stall(const MetricsHistory *history, uint64_t pos, PsiEvent *out);
+
 // Função auxiliar para obter nome do processo
 bool get_process_name(int pid, char *name, size_t size);
 
@@ -0,0 +1,75 @@
+#ifndef PROCESS_TABLE_H
+#define PROCESS_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "process_monitor.h"
+
+// Estado por processo no modo multi-processo ("top")
+typedef struct {
+    int pid;                    // 0 = slot livre
+    unsigned long seen_tick;    // último tick em que o processo foi amostrado
+    bool has_prev;              // prev contém uma amostra válida para deltas
+    bool excluded;              // fora do filtro do chamador: não é amostrado
+    ProcHandle handle;          // descritores de /proc/<pid> mantidos abertos
+    ProcessMetrics prev;
+    ProcessMetrics cur;
+    
+    // Taxas entre as duas últimas leituras (por segundo)
+    double ctx_switch_rate;     // trocas de contexto voluntárias + involuntárias
+    double fault_rate;          // page faults minor + major
+    
+    // Coleta incremental (process_table_refresh)
+    uint64_t stat_hash;         // hash do conteúdo de stat na última leitura
+    unsigned idle_streak;       // leituras seguidas com stat inalterado
+} ProcessSlot;
+
+// Tabela PID -> slot com endereçamento aberto (sondagem linear e remoção
+// por deslocamento reverso, sem lápides). A capacidade é sempre potência
+// de 2 e a tabela dobra ao passar de 50% de ocupação.
+// Atenção: ponteiros para slots são invalidados por insert/remove.
+typedef struct {
+    ProcessSlot *slots;
+    size_t capacity;
+    size_t count;
+    unsigned long tick;
+    
+    // Contadores do tick atual (process_table_refresh)
+    size_t full_reads;          // stat mudou: status/statm/io relidos
+    size_t stat_reads;          // stat relido e inalterado
+} ProcessTable;
+
+bool process_table_init(ProcessTable *t, size_t initial_capacity);
+void process_table_free(ProcessTable *t);
+
+// Busca O(1) esperado. Retorna NULL se o PID não está na tabela.
+ProcessSlot *process_table_find(ProcessTable *t, int pid);
+
+// Retorna o slot do PID, criando-o (zerado) se necessário. NULL se sem memória.
+ProcessSlot *process_table_insert(ProcessTable *t, int pid);
+
+// Remove o PID e fecha seu handle
+void process_table_remove(ProcessTable *t, int pid);
+
+// Inicia um novo tick de coleta
+void process_table_begin_tick(ProcessTable *t);
+
+// Coleta o PID no tick atual (inserindo-o se necessário) e calcula CPU% e
+// taxas de I/O contra a amostra anterior do mesmo slot. Se o PID foi
+// reutilizado por outro processo, o handle é reaberto e os deltas reiniciam.
+// Retorna o slot amostrado ou NULL se o processo não existe mais.
+ProcessSlot *process_table_sample(ProcessTable *t, int pid);
+
+// Versão incremental de process_table_sample para varrer muitos processos:
+// relê apenas stat e, se o conteúdo é idêntico ao da leitura anterior (o
+// processo não rodou, não mudou de memória nem gerou faults), mantém as
+// métricas sem reler status/statm/io. stat é lido a cada tick mesmo nos
+// ociosos: um processo que volta a rodar aparece com o CPU% certo já no
+// tick seguinte. Slots marcados como excluded só são marcados como vistos.
+// Retorna o slot ou NULL se o processo não existe mais.
+ProcessSlot *process_table_refresh(ProcessTable *t, int pid);
+
+// Remove os processos não amostrados no tick atual. Retorna quantos saíram.
+size_t process_table_sweep(ProcessTable *t);
+
+#endif // PROCESS_TABLE_H
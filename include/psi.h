@@ -0,0 +1,119 @@
+#ifndef PSI_H
+#define PSI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Pressure Stall Information: tempo em que tarefas ficaram paradas à
+// espera de CPU, memória ou I/O, do host (/proc/pressure/<recurso>) ou de
+// um cgroup v2 (<cgroup>/<recurso>.pressure).
+//
+// Leitura: linhas "some" (ao menos uma tarefa parada) e "full" (todas),
+// com médias móveis de 10/60/300 s em % e o total acumulado em us.
+//
+// Gatilhos: "some 150000 1000000" escrito no arquivo pede ao kernel um
+// POLLPRI sempre que a espera passar de 150 ms numa janela de 1 s. O
+// kernel confere a janela a cada 1/10 dela (100 ms para 1 s) e avisa no
+// máximo uma vez por janela; ocioso, nada é lido. Todos os gatilhos ficam
+// num único epoll, como em cgroup_events.h, mas o descritor não é exposto:
+// o poll de um gatilho consome o evento, então um poll/epoll externo sobre
+// o epoll o descartaria antes de psi_monitor_wait. Quem também espera um
+// temporizador usa o prazo dele como timeout.
+//
+// Sem CAP_SYS_RESOURCE o kernel só aceita janelas múltiplas de 2 s: o
+// gatilho é refeito com a janela arredondada e o limiar na mesma proporção.
+
+#define PSI_DEFAULT_TRIGGER  "some 150000 1000000"
+#define PSI_MIN_WINDOW_US    500000ULL
+#define PSI_MAX_WINDOW_US    10000000ULL
+#define PSI_UNPRIV_WINDOW_US 2000000ULL
+#define PSI_SOURCE_LEN       64
+
+typedef enum {
+    PSI_CPU,
+    PSI_MEMORY,
+    PSI_IO,
+    PSI_RESOURCES
+} PsiResource;
+
+typedef struct {
+    double avg10;               // %
+    double avg60;
+    double avg300;
+    uint64_t total_us;
+} PsiLine;
+
+typedef struct {
+    PsiLine some;
+    PsiLine full;
+    bool has_full;              // cpu do host só tem "full" em kernels recentes
+} PsiStat;
+
+// Evento de um gatilho (autocontido: pode ser copiado para um ring)
+typedef struct {
+    uint64_t mono_ns;           // despertar que trouxe o evento
+    uint64_t real_ns;
+    int trigger;                // índice retornado por psi_monitor_add
+    PsiResource resource;
+    bool full;
+    uint64_t threshold_us;
+    uint64_t window_us;
+    uint64_t stall_us;          // aumento do total desde a leitura anterior do gatilho
+    double avg10;
+    char source[PSI_SOURCE_LEN];    // "host" ou caminho do cgroup
+} PsiEvent;
+
+typedef void (*PsiEventFn)(const PsiEvent *ev, void *ctx);
+
+typedef struct {
+    char source[PSI_SOURCE_LEN];
+    PsiResource resource;
+    bool full;
+    uint64_t threshold_us;      // efetivos (após o ajuste sem privilégio)
+    uint64_t window_us;
+    int fd;                     // -1 = removido
+    uint64_t last_total_us;
+    uint64_t events;
+} PsiTrigger;
+
+typedef struct {
+    int epoll_fd;
+    PsiTrigger *triggers;
+    int count;
+    int capacity;
+    PsiEventFn fn;
+    void *ctx;
+    uint64_t wakeups;
+    uint64_t events;
+} PsiMonitor;
+
+const char *psi_resource_name(PsiResource r);      // "cpu", "memory", "io"
+bool psi_resource_parse(const char *name, PsiResource *r);
+
+// Conteúdo de um arquivo de pressão. false se não há linha "some".
+bool psi_parse(const char *text, PsiStat *out);
+
+// /proc/pressure/<recurso>. false se o kernel não tem PSI.
+bool psi_read_host(PsiResource r, PsiStat *out);
+
+// CGROUP_ROOT/<cgroup>/<recurso>.pressure
+bool psi_read_cgroup(const char *cgroup, PsiResource r, PsiStat *out);
+
+// "some|full <limiar_us> <janela_us>" com os limites do kernel
+bool psi_parse_trigger(const char *spec, bool *full, uint64_t *threshold_us, uint64_t *window_us);
+
+bool psi_monitor_init(PsiMonitor *m, PsiEventFn fn, void *ctx);
+
+// Registra um gatilho no host (cgroup NULL) ou num cgroup. Retorna o
+// índice ou -1 (com a mensagem no stderr).
+int psi_monitor_add(PsiMonitor *m, const char *cgroup, PsiResource r, const char *spec);
+
+// Espera até timeout_ms (0 = não bloqueia, -1 = indefinidamente) e entrega
+// os eventos. Retorna quantos foram entregues ou -1 em erro (EINTR = 0).
+int psi_monitor_wait(PsiMonitor *m, int timeout_ms);
+
+static inline int psi_monitor_dispatch(PsiMonitor *m) { return psi_monitor_wait(m, 0); }
+
+void psi_monitor_close(PsiMonitor *m);
+
+#endif // PSI_H
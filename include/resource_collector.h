@@ -0,0 +1,54 @@
+#ifndef RESOURCE_COLLECTOR_H
+#define RESOURCE_COLLECTOR_H
+
+#include <stdbool.h>
+#include "monitor.h"
+#include "taskstats.h"
+#include "sock_diag.h"
+
+// Backend de coleta de um processo, escolhido em tempo de execução
+typedef enum {
+    COLLECT_BACKEND_PROC = 0,       // texto de /proc/<pid> (padrão)
+    COLLECT_BACKEND_TASKSTATS,      // struct taskstats via genetlink
+} CollectBackend;
+
+// Backend usado por monitor/tui (opção global --backend)
+void collect_backend_set(CollectBackend backend);
+CollectBackend collect_backend_get(void);
+bool collect_backend_parse(const char *name, CollectBackend *out);
+const char *collect_backend_name(CollectBackend backend);
+
+// Coletor de um processo. No backend taskstats:
+// - CPU, trocas de contexto e delays vêm da consulta por TGID (soma das
+//   threads, o kernel não agrega I/O nem faltas de página nesse escopo);
+// - I/O e faltas de página vêm da consulta por PID (só a thread líder):
+//   exato para processos de uma thread; com várias threads, /proc;
+// - memória continua em /proc e rede vem dos sockets do processo
+//   (sock_diag), como no backend /proc (o taskstats não as tem).
+// As duas consultas seguem num único lote pelo mesmo socket.
+typedef struct {
+    CollectBackend backend;
+    ProcHandle handle;
+    ProcSockets sockets;            // sockets do processo entre amostras
+    TaskstatsClient client;         // consultas
+    TaskstatsClient exits;          // notificações de término
+    bool exits_open;
+    bool exited;                    // estatísticas finais recebidas
+    TaskStats final;
+    long ticks_per_second;
+} ResourceCollector;
+
+// Abre o coletor. Sem a interface TASKSTATS (sem privilégio, kernel sem
+// suporte) volta para /proc com um aviso. Retorna false se o PID não existe.
+bool resource_collector_open(ResourceCollector *rc, int pid, CollectBackend backend);
+void resource_collector_close(ResourceCollector *rc);
+
+// Uma amostra completa (contadores brutos, sem taxas). Retorna false se o
+// processo terminou.
+bool resource_collector_sample(ResourceCollector *rc, ResourceData *data);
+
+// Estatísticas finais do processo, da notificação de término (somente no
+// backend taskstats). Retorna false se ainda não chegou.
+bool resource_collector_final(ResourceCollector *rc, TaskStats *out);
+
+#endif // RESOURCE_COLLECTOR_H
@@ -0,0 +1,61 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Buffer circular de capacidade fixa, um produtor e vários consumidores,
+// sem locks. Cada slot é protegido por um seqlock próprio: o produtor nunca
+// espera por leitores (sobrescreve o mais antigo quando cheio) e um leitor
+// detecta, sem bloquear, quando o slot foi sobrescrito durante a cópia.
+//
+// Posições são números de sequência de 64 bits crescentes: a posição p fica
+// no slot p & (capacity - 1). Estão disponíveis as posições no intervalo
+// [ring_oldest(), ring_head()).
+typedef struct {
+    _Atomic uint64_t head;      // próxima posição a ser escrita
+    size_t capacity;            // potência de 2
+    size_t elem_size;
+    _Atomic uint64_t *seqs;     // seqlock de cada slot
+    unsigned char *data;        // capacity * elem_size bytes (NULL se elem_size == 0)
+} RingBuffer;
+
+// Aloca o ring. retention é arredondada para a próxima potência de 2.
+// Com elem_size == 0 só os seqlocks são alocados: o chamador guarda os
+// dados em arrays próprios indexados pelo slot (ex.: layout colunar) e usa
+// as primitivas ring_write_begin/end e ring_read_begin/validate abaixo.
+bool ring_init(RingBuffer *r, size_t retention, size_t elem_size);
+void ring_free(RingBuffer *r);
+
+// Produtor (uma única thread): publica uma cópia de elem
+void ring_push(RingBuffer *r, const void *elem);
+
+// Consumidores: posições publicadas e ainda retidas
+uint64_t ring_head(const RingBuffer *r);
+uint64_t ring_oldest(const RingBuffer *r);
+
+// Copia a posição pos para out. Retorna false se pos ainda não foi
+// publicada ou já foi sobrescrita (inclusive durante a própria leitura).
+bool ring_read(const RingBuffer *r, uint64_t pos, void *out);
+
+// Copia o elemento mais recente. Retorna false se o ring está vazio.
+bool ring_read_latest(const RingBuffer *r, void *out);
+
+// Primitivas do seqlock para dados externos ao ring.
+// Produtor: slot = ring_write_begin(r); escreve no slot; ring_write_end(r).
+size_t ring_write_begin(RingBuffer *r);
+void ring_write_end(RingBuffer *r);
+
+// Leitor: se ring_read_begin retornar true, copia os dados do *slot e
+// confirma com ring_read_validate(r, pos, *slot); se esta falhar, a cópia
+// pode estar inconsistente e deve ser descartada.
+bool ring_read_begin(const RingBuffer *r, uint64_t pos, size_t *slot);
+bool ring_read_validate(const RingBuffer *r, uint64_t pos, size_t slot);
+
+static inline size_t ring_slot(const RingBuffer *r, uint64_t pos) {
+    return pos & (r->capacity - 1);
+}
+
+#endif // RING_BUFFER_H
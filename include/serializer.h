@@ -0,0 +1,71 @@
+#ifndef SERIALIZER_H
+#define SERIALIZER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Serialização de texto (JSON/CSV) sem printf: inteiros e números com casas
+// decimais fixas são formatados direto num buffer grande, que é entregue ao
+// kernel com write/writev só quando enche (ou em out_flush). A saída é
+// idêntica à de "%d"/"%llu"/"%.Nf".
+#define OUT_BUF_SIZE (1 << 20)
+
+typedef struct {
+    int fd;
+    char *data;
+    size_t len;
+    size_t cap;
+    bool owns_fd;               // out_close fecha o descritor
+    bool owns_data;             // out_close libera o buffer
+    bool failed;                // erro de escrita: o restante é descartado
+    uint64_t written;           // bytes entregues ao kernel
+} OutBuf;
+
+// Usa um descritor do chamador (não é fechado em out_close). buf NULL aloca
+// cap bytes; caso contrário o buffer é do chamador.
+bool out_init(OutBuf *o, int fd, char *buf, size_t cap);
+
+// Cria (ou trunca) o arquivo com um buffer de OUT_BUF_SIZE
+bool out_open(OutBuf *o, const char *path);
+
+// Entrega o conteúdo do buffer ao kernel. Retorna false se alguma escrita
+// falhou desde a abertura.
+bool out_flush(OutBuf *o);
+
+// out_flush, fecha o descritor (se próprio) e libera o buffer (se próprio)
+bool out_close(OutBuf *o);
+
+// Caminho lento de out_write: buffer cheio ou bloco grande
+void out_write_slow(OutBuf *o, const void *p, size_t n);
+
+// Bytes arbitrários. Blocos grandes vão direto ao kernel junto com o
+// buffer pendente (writev), sem cópia.
+static inline void out_write(OutBuf *o, const void *p, size_t n) {
+    if (n <= o->cap - o->len) {
+        memcpy(o->data + o->len, p, n);
+        o->len += n;
+    } else {
+        out_write_slow(o, p, n);
+    }
+}
+
+void out_u64(OutBuf *o, uint64_t v);
+void out_i64(OutBuf *o, int64_t v);
+
+// Igual a printf("%.*f", decimals, v) para decimals <= 9
+void out_fixed(OutBuf *o, double v, int decimals);
+
+// String JSON entre aspas, com escape de ", \ e caracteres de controle
+void out_json_str(OutBuf *o, const char *s);
+
+static inline void out_char(OutBuf *o, char c) {
+    if (o->len == o->cap) out_flush(o);
+    o->data[o->len++] = c;
+}
+
+// Literal de string (tamanho calculado em tempo de compilação)
+#define out_lit(o, s) out_write((o), (s), sizeof(s) - 1)
+
+#endif // SERIALIZER_H
@@ -0,0 +1,89 @@
+#ifndef SOCK_DIAG_H
+#define SOCK_DIAG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "proc_reader.h"
+
+// Rede por processo: os sockets do processo (inodes de /proc/<pid>/fd)
+// são casados com o dump binário de inet_diag (netlink NETLINK_SOCK_DIAG)
+// feito dentro do namespace de rede do processo, com filas e os contadores
+// de bytes/segmentos do TCP_INFO. Um socket compartilhado entre processos
+// (fork, SCM_RIGHTS) conta para todos eles.
+//
+// Bytes e segmentos são acumulados: cada socket guarda os contadores da
+// última amostra em que apareceu e, quando some (fechado ou em outro
+// namespace), esses valores passam para um total "aposentado". Só o TCP
+// tem contadores; sockets UDP entram apenas nas filas.
+
+// Tipo de um socket do processo, descoberto no primeiro dump que o contém
+typedef enum {
+    SOCK_KIND_UNKNOWN = 0,      // listado e ainda não classificado
+    SOCK_KIND_OTHER,            // não é inet (unix, netlink, ...)
+    SOCK_KIND_TCP4,
+    SOCK_KIND_TCP6,
+    SOCK_KIND_UDP4,
+    SOCK_KIND_UDP6,
+    SOCK_KIND_COUNT
+} SockKind;
+
+typedef struct {
+    uint32_t inode;
+    uint8_t kind;               // SockKind
+    bool seen;                  // encontrado no dump da amostra atual
+    uint64_t bytes_received;    // TCP_INFO da última amostra em que apareceu
+    uint64_t bytes_sent;
+    uint64_t segs_in;
+    uint64_t segs_out;
+} ProcSocketEntry;
+
+// Uso de rede agregado dos sockets do processo
+typedef struct {
+    int tcp_sockets;
+    int udp_sockets;
+    uint64_t rx_queue;          // bytes recebidos e não lidos (exceto LISTEN)
+    uint64_t tx_queue;          // bytes ainda não confirmados/enviados
+    uint64_t bytes_received;    // TCP_INFO, acumulado (inclui sockets já fechados)
+    uint64_t bytes_sent;        // TCP_INFO (bytes_acked em kernels < 4.19), acumulado
+    uint64_t segs_in;           // TCP, acumulado
+    uint64_t segs_out;
+} NetUsage;
+
+// Estado por processo. A lista de inodes é mantida entre amostras e só
+// é refeita quando o número de fds abertos muda (st_size de
+// /proc/<pid>/fd, Linux >= 6.2; em kernels antigos relista sempre) ou
+// quando um socket conhecido sumiu dos dumps. Depois de classificados os
+// sockets, só as combinações família/protocolo presentes são consultadas.
+// O namespace de rede é conferido a cada amostra: se o processo trocou de
+// namespace, o socket de diag é reaberto no novo (sockets criados antes da
+// troca ficam no namespace antigo e deixam de ser contados).
+typedef struct {
+    ProcSocketEntry *entries;   // ordenado por inode
+    size_t count;
+    size_t cap;
+    long fd_count;              // fds na última listagem (-1 = nunca listado)
+    bool count_supported;       // kernel informa a contagem de fds
+    bool stale;                 // socket conhecido sumiu: relistar
+    NetUsage retired;           // bytes/segmentos dos sockets que sumiram
+
+    uint64_t netns;             // inode do namespace de rede do processo
+    int diag_fd;                // NETLINK_SOCK_DIAG dentro desse namespace
+    uint32_t seq;
+    char *buf;                  // buffer de recepção dos dumps
+
+    // Estatísticas da última amostra
+    bool relisted;              // /proc/<pid>/fd foi relido
+    int dumps;                  // dumps de inet_diag feitos
+} ProcSockets;
+
+// Inicializa o estado (sem alocar nada até a primeira amostra)
+void proc_sockets_init(ProcSockets *ps);
+void proc_sockets_free(ProcSockets *ps);
+
+// Coleta o uso de rede do processo do handle. Retorna false se não foi
+// possível atribuir sockets ao processo (sem permissão sobre /proc/<pid>/fd
+// ou sobre o namespace de rede dele, ou sem suporte a sock_diag).
+bool proc_sockets_collect(ProcSockets *ps, ProcHandle *h, NetUsage *out);
+
+#endif // SOCK_DIAG_H
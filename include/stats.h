@@ -0,0 +1,134 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Estatísticas incrementais em memória constante: cada amostra é
+// incorporada ao chegar, sem guardar o histórico. Todas as estruturas
+// podem ser combinadas (merge) entre coletores ou capturas.
+
+// Média e variância pelo algoritmo de Welford, mais mínimo e máximo
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2;                  // soma dos quadrados dos desvios
+    double min;
+    double max;
+} RunningStats;
+
+void running_stats_init(RunningStats *s);
+void running_stats_add(RunningStats *s, double x);
+void running_stats_merge(RunningStats *dst, const RunningStats *src);
+double running_stats_variance(const RunningStats *s);   // amostral (n - 1)
+double running_stats_stddev(const RunningStats *s);
+
+// Média com decaimento exponencial no tempo: o peso de uma amostra cai
+// à metade a cada half_life_ns, qualquer que seja o intervalo de coleta
+typedef struct {
+    double value;
+    uint64_t half_life_ns;
+    bool primed;
+} Ewma;
+
+void ewma_init(Ewma *e, uint64_t half_life_ns);
+void ewma_add(Ewma *e, double x, uint64_t dt_ns);
+
+// Máximo das últimas width amostras (janela deslizante) por uma deque
+// monotônica de candidatos: O(1) amortizado por amostra, sem varrer a
+// janela. width de 1 a WINDOW_MAX_LEN.
+#define WINDOW_MAX_LEN 128
+
+typedef struct {
+    int width;
+    uint64_t pushed;            // total de amostras recebidas
+    uint64_t pos[WINDOW_MAX_LEN];
+    double val[WINDOW_MAX_LEN]; // decrescente a partir de head
+    int head;
+    int count;
+} WindowMax;
+
+void window_max_init(WindowMax *w, int width);
+void window_max_add(WindowMax *w, double x);
+double window_max_get(const WindowMax *w);     // 0 sem amostras
+
+// DDSketch: quantis com erro relativo de até DDSKETCH_ALPHA. Os valores
+// são contados em baldes logarítmicos de razão gamma = (1+a)/(1-a); os
+// menores que DDSKETCH_MIN_VALUE (e os negativos) vão para o balde zero e
+// os acima da faixa para o último balde. Memória fixa (DDSKETCH_BINS
+// contadores), faixa de DDSKETCH_MIN_VALUE a ~6e14.
+#define DDSKETCH_ALPHA      0.01
+#define DDSKETCH_MIN_VALUE  1e-3
+#define DDSKETCH_BINS       2048
+
+typedef struct {
+    uint64_t count;
+    uint64_t zero_count;
+    uint32_t bins[DDSKETCH_BINS];
+} DDSketch;
+
+void ddsketch_init(DDSketch *d);
+void ddsketch_add(DDSketch *d, double x);
+void ddsketch_merge(DDSketch *dst, const DDSketch *src);
+double ddsketch_quantile(const DDSketch *d, double q);   // q em [0, 1]
+
+// Resumo completo de uma métrica
+typedef struct {
+    RunningStats stats;
+    Ewma ewma;
+    DDSketch sketch;
+} MetricSummary;
+
+// Valores prontos para exibir ou exportar
+typedef struct {
+    uint64_t count;
+    double min;
+    double max;
+    double mean;
+    double stddev;
+    double ewma;
+    double p50;
+    double p95;
+    double p99;
+} SummaryStats;
+
+void metric_summary_init(MetricSummary *m, uint64_t half_life_ns);
+void metric_summary_add(MetricSummary *m, double x, uint64_t dt_ns);
+void metric_summary_merge(MetricSummary *dst, const MetricSummary *src);
+void metric_summary_get(const MetricSummary *m, SummaryStats *out);
+
+// Métricas resumidas por coletor
+typedef enum {
+    SUMMARY_CPU_PERCENT = 0,
+    SUMMARY_RSS_BYTES,
+    SUMMARY_IO_READ_BPS,
+    SUMMARY_IO_WRITE_BPS,
+    SUMMARY_COUNT
+} SummaryMetric;
+
+// Meia-vida padrão das médias exponenciais
+#define SUMMARY_EWMA_HALF_LIFE_NS (30ULL * 1000000000ULL)
+
+typedef struct {
+    MetricSummary metrics[SUMMARY_COUNT];
+} MetricsSummary;
+
+void metrics_summary_init(MetricsSummary *s);
+
+// Incorpora uma amostra (taxas já calculadas); dt_ns = intervalo desde a
+// anterior. A primeira amostra de uma captura, sem taxas, não deve entrar.
+void metrics_summary_add(MetricsSummary *s, double cpu_percent, double rss_bytes,
+                         double io_read_bps, double io_write_bps, uint64_t dt_ns);
+
+// Nome da métrica na exportação (ex.: "cpu_percent")
+const char *summary_metric_name(SummaryMetric id);
+
+// Tabela do resumo no terminal (CPU%, RSS em MB, I/O em KB/s); a
+// variante com SummaryStats recebe SUMMARY_COUNT valores já extraídos
+void metrics_summary_print(const MetricsSummary *s);
+void summary_stats_print(const SummaryStats *stats);
+
+// Grava o resumo em JSON (um objeto por métrica)
+bool metrics_summary_export_json(const MetricsSummary *s, int pid, const char *path);
+
+#endif // STATS_H
@@ -0,0 +1,88 @@
+#ifndef STREAM_EXPORT_H
+#define STREAM_EXPORT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "tsdb.h"
+#include "serializer.h"
+
+// Exportação incremental: as amostras são gravadas durante a coleta, não
+// só no fim. O produtor (thread de amostragem) apenas copia a amostra para
+// o buffer da frente; uma thread escritora troca os buffers (double
+// buffering) e grava o lote em disco. Assim a amostragem nunca espera por
+// I/O e uma captura interrompida (crash, SIGKILL, OOM) mantém tudo que já
+// foi gravado.
+//
+// Um lote é gravado ao juntar STREAM_BATCH_SAMPLES amostras ou a cada
+// STREAM_FLUSH_NS, o que vier primeiro.
+#define STREAM_BATCH_SAMPLES    64
+#define STREAM_FLUSH_NS         (1000ULL * 1000 * 1000)
+// Blocos .rmts abertos são fechados a cada STREAM_BLOCK_FLUSH_NS: limita o
+// que se perde numa queda sem encurtar demais os blocos (compressão)
+#define STREAM_BLOCK_FLUSH_NS   (30ULL * 1000 * 1000 * 1000)
+// Se o disco não acompanhar, o buffer da frente cresce até este limite;
+// acima disso as amostras são descartadas (e contadas) em vez de bloquear
+#define STREAM_MAX_PENDING      (1 << 20)
+
+typedef enum {
+    EXPORT_JSON,                // documento JSON (fechado em stream_export_close)
+    EXPORT_NDJSON,              // um objeto JSON por linha
+    EXPORT_CSV,
+    EXPORT_BIN                  // formato .rmts (tsdb.h), só para ProcessMetrics
+} ExportFormat;
+
+// Tipo das amostras recebidas pelo exportador
+typedef enum {
+    STREAM_PROCESS_METRICS,     // ProcessMetrics (process_monitor.h)
+    STREAM_RESOURCE_DATA        // ResourceData (monitor.h)
+} StreamRecord;
+
+typedef struct {
+    StreamRecord record;
+    ExportFormat format;
+    size_t elem_size;
+    OutBuf out;                 // JSON/NDJSON/CSV
+    TsdbWriter tsdb;            // BIN
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+
+    // Buffers trocados pela thread escritora (protegidos por lock)
+    unsigned char *front;
+    size_t front_count;
+    size_t front_cap;
+    unsigned char *back;
+    size_t back_cap;
+    bool stop;
+
+    // Estado da thread escritora
+    bool failed;                // erro de escrita (as próximas amostras são descartadas)
+    uint64_t last_block_flush_ns;
+
+    // Estatísticas (confiáveis após stream_export_close)
+    uint64_t appended;          // amostras aceitas pelo produtor
+    uint64_t written;           // amostras gravadas (thread escritora)
+    uint64_t dropped;           // descartadas: buffer cheio ou erro de escrita
+    uint64_t batches;           // lotes gravados (thread escritora)
+} StreamExporter;
+
+// "json", "ndjson", "csv" ou "bin"
+bool export_format_parse(const char *name, ExportFormat *format);
+// Extensão do arquivo (".json", ".ndjson", ".csv", ".rmts")
+const char *export_format_extension(ExportFormat format);
+
+// Cria o arquivo e inicia a thread escritora
+bool stream_export_open(StreamExporter *e, const char *path, StreamRecord record, ExportFormat format);
+
+// Enfileira uma cópia da amostra. Não faz I/O. Retorna false se a amostra
+// foi descartada.
+bool stream_export_append(StreamExporter *e, const void *sample);
+
+// Grava o que estiver pendente, fecha o documento/arquivo e encerra a thread
+bool stream_export_close(StreamExporter *e);
+
+#endif // STREAM_EXPORT_H
@@ -0,0 +1,100 @@
+#ifndef TASKSTATS_H
+#define TASKSTATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Cliente da interface genetlink TASKSTATS: struct taskstats binária do
+// kernel, sem formatação nem parsing de texto. Requer CAP_NET_ADMIN e o
+// namespace de rede inicial. O delay de CPU vem do escalonador; os demais
+// delays só são medidos com kernel.task_delayacct = 1.
+
+// Estatísticas de uma tarefa (thread) ou de um processo inteiro
+typedef struct {
+    int pid;                            // PID/TID consultado, ou o TGID
+    bool tgid_scope;                    // soma das threads do processo
+    char comm[32];
+    uint32_t exitcode;                  // status no formato de wait(), só no término
+
+    // CPU
+    uint64_t cpu_user_us;
+    uint64_t cpu_system_us;
+    uint64_t cpu_run_real_ns;           // tempo de CPU medido pelo escalonador
+    uint64_t voluntary_ctx_switches;
+    uint64_t nonvoluntary_ctx_switches;
+
+    // Memória (apenas escopo de tarefa)
+    uint64_t minor_faults;
+    uint64_t major_faults;
+    uint64_t hiwater_rss_kb;
+
+    // I/O (apenas escopo de tarefa; o kernel arredonda para múltiplos de 1024)
+    uint64_t read_chars;
+    uint64_t write_chars;
+    uint64_t read_syscalls;
+    uint64_t write_syscalls;
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t cancelled_write_bytes;
+
+    // Delay accounting: número de esperas e tempo total (ns)
+    uint64_t cpu_delay_count;           // fila de execução
+    uint64_t cpu_delay_ns;
+    uint64_t blkio_delay_count;         // I/O de bloco síncrono
+    uint64_t blkio_delay_ns;
+    uint64_t swapin_delay_count;
+    uint64_t swapin_delay_ns;
+    uint64_t freepages_delay_count;     // reclaim de memória
+    uint64_t freepages_delay_ns;
+    uint64_t thrashing_delay_count;
+    uint64_t thrashing_delay_ns;
+} TaskStats;
+
+typedef struct {
+    int fd;
+    uint16_t family_id;
+    uint32_t seq;
+    bool listening;                     // inscrito em notificações de término
+    char cpumask[32];                   // máscara usada na inscrição ("0-N")
+    unsigned long long dropped;         // notificações perdidas (buffer cheio)
+    char *buf;                          // buffers de recepção do lote
+} TaskstatsClient;
+
+// Uma entrada de consulta em lote
+typedef struct {
+    int pid;
+    bool tgid;                          // true: soma de todas as threads do processo
+    bool ok;                            // resposta recebida
+    TaskStats stats;
+} TaskstatsQuery;
+
+// Abre o socket e resolve a família TASKSTATS. Retorna false (com
+// mensagem) se a interface não está disponível.
+bool taskstats_open(TaskstatsClient *c);
+void taskstats_close(TaskstatsClient *c);
+
+// Consulta uma tarefa (tgid = false) ou um processo (tgid = true).
+// Retorna false se o processo não existe.
+bool taskstats_query(TaskstatsClient *c, int pid, bool tgid, TaskStats *out);
+
+// Consulta vários PIDs sobre o mesmo socket: as requisições são enviadas
+// em janelas com um único send e as respostas recebidas com recvmmsg,
+// casadas pelo número de sequência. Retorna quantas consultas tiveram
+// resposta (q[i].ok) ou -1 em erro do socket.
+int taskstats_query_batch(TaskstatsClient *c, TaskstatsQuery *q, size_t n);
+
+// Inscreve o cliente nas notificações de término de todas as CPUs. O
+// cliente passa a receber só notificações: use outro para consultas.
+bool taskstats_subscribe_exits(TaskstatsClient *c);
+
+// Lê uma notificação pendente sem bloquear (c->fd pode ir num poll).
+// Processos com várias threads geram uma notificação por thread; a da
+// última thread traz o total do processo (tgid_scope). Retorna 1 se leu,
+// 0 se não há notificação pendente e -1 em erro.
+int taskstats_read_exit(TaskstatsClient *c, TaskStats *out);
+
+// Verdadeiro se kernel.task_delayacct está ativo
+bool taskstats_delayacct_enabled(void);
+
+#endif // TASKSTATS_H
@@ -0,0 +1,65 @@
+#ifndef THREAD_TABLE_H
+#define THREAD_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <dirent.h>
+
+// Métricas de uma thread (/proc/<pid>/task/<tid>/{stat,status})
+typedef struct {
+    uint64_t mono_ns;                   // instante da amostra (CLOCK_MONOTONIC)
+    int pid;                            // processo dono (TGID)
+    int tid;
+    char name[64];                      // comm da thread
+    char state;                         // campo 3 de stat (R, S, D, ...)
+    int processor;                      // campo 39 de stat: última CPU em que executou
+    unsigned long cpu_user_time;        // jiffies
+    unsigned long cpu_system_time;      // jiffies
+    long voluntary_ctx_switches;
+    long nonvoluntary_ctx_switches;
+    double cpu_usage_percent;           // em relação a um núcleo
+    double ctx_switch_rate;             // trocas voluntárias + involuntárias por segundo
+} ThreadMetrics;
+
+// Estado de uma thread: stat e status abertos uma vez e relidos com pread
+typedef struct {
+    int stat_fd;                // -1 = ainda não aberto
+    int status_fd;
+    bool has_prev;              // cur contém uma leitura anterior válida para deltas
+    ThreadMetrics cur;
+} ThreadSlot;
+
+// Threads de um processo. A listagem de task/ (readdir) é mantida entre
+// amostras e só é refeita quando num_threads do processo muda ou uma
+// thread listada deixou de existir; nas demais amostras cada thread custa
+// dois pread nos descritores já abertos.
+typedef struct {
+    int pid;
+    DIR *task_dir;              // /proc/<pid>/task, base para openat()
+    ThreadSlot *threads;        // ordenado por TID
+    size_t count;
+    long listed_threads;        // threads encontradas na última listagem
+    bool stale;                 // uma thread sumiu: relistar na próxima amostra
+    uint64_t mono_ns;           // instante da última amostra
+    long ticks_per_second;
+
+    // Estatísticas da última amostra
+    bool relisted;              // task/ foi relido
+    size_t unavailable;         // threads sem descritor (limite de arquivos abertos)
+} ThreadTable;
+
+// Abre /proc/<pid>/task. Retorna false se o processo não existe.
+bool thread_table_open(ThreadTable *t, int pid);
+void thread_table_close(ThreadTable *t);
+
+// Amostra todas as threads. num_threads é o campo 20 de /proc/<pid>/stat
+// na amostra corrente do processo (0 = desconhecido: relista sempre).
+// CPU% e trocas de contexto por segundo são calculados contra a amostra
+// anterior de cada thread. Retorna false se o processo terminou.
+bool thread_table_sample(ThreadTable *t, long num_threads);
+
+// Busca por TID (busca binária). NULL se a thread não está na tabela.
+ThreadSlot *thread_table_find(ThreadTable *t, int tid);
+
+#endif // THREAD_TABLE_H
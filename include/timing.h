@@ -0,0 +1,82 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#define NSEC_PER_USEC 1000ULL
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_SEC  1000000000ULL
+
+// Relógio monotônico (deltas e agendamento) em nanossegundos
+static inline uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// Relógio de parede (carimbo exportado) em nanossegundos desde a época Unix
+static inline uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// Preenche mono_ns, real_ns e timestamp (segundos) de uma amostra
+// (ResourceData ou ProcessMetrics) a partir do mesmo instante
+#define TIMING_STAMP(sample) do {                                   \
+        (sample)->mono_ns = monotonic_ns();                         \
+        (sample)->real_ns = realtime_ns();                          \
+        (sample)->timestamp = (time_t)((sample)->real_ns / NSEC_PER_SEC); \
+    } while (0)
+
+// Converte "100ms", "500us", "250000ns", "2s", "1.5s" ou "2" (segundos)
+// em nanossegundos. Retorna false se a string é inválida ou resulta em 0.
+bool parse_duration_ns(const char *str, uint64_t *out_ns);
+
+// Formata uma duração com a maior unidade exata ("100ms", "2s", "1500us")
+void format_duration_ns(uint64_t ns, char *buf, size_t size);
+
+// Temporizador periódico baseado em timerfd com prazos absolutos em
+// CLOCK_MONOTONIC: a fase do agendamento é fixada no início, então o tempo
+// gasto na coleta não se acumula como deriva entre as amostras.
+typedef struct {
+    int fd;
+    uint64_t interval_ns;
+    uint64_t deadline_ns;   // próxima expiração (absoluta)
+} SampleTimer;
+
+// Arma o temporizador; a primeira expiração ocorre em now + interval_ns
+bool sample_timer_start(SampleTimer *t, uint64_t interval_ns);
+
+// Bloqueia até a próxima expiração. Retorna o número de períodos vencidos
+// desde a última chamada (> 1 indica amostras perdidas) ou 0 em erro.
+uint64_t sample_timer_wait(SampleTimer *t);
+
+// Troca o período. O próximo prazo passa a ser a última expiração +
+// interval_ns (ou now + interval_ns, se esse instante já passou).
+bool sample_timer_set_interval(SampleTimer *t, uint64_t interval_ns);
+
+void sample_timer_close(SampleTimer *t);
+
+// Intervalo adaptativo: amostra no intervalo mínimo enquanto CPU%, RSS ou
+// taxa de I/O mudam e dobra o intervalo a cada amostra estável até o teto.
+// Qualquer mudança volta ao mínimo na amostra seguinte.
+typedef struct {
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t interval_ns;   // intervalo até a próxima amostra
+    bool primed;            // já há valores de referência
+    double cpu_percent;
+    double rss_bytes;
+    double io_rate;         // bytes/s (leitura + escrita)
+} AdaptiveInterval;
+
+void adaptive_interval_init(AdaptiveInterval *a, uint64_t min_ns, uint64_t max_ns);
+
+// Registra os sinais da amostra atual e devolve o intervalo até a próxima
+uint64_t adaptive_interval_update(AdaptiveInterval *a, double cpu_percent, double rss_bytes,
+                                  double io_rate);
+
+#endif // TIMING_H
@@ -0,0 +1,96 @@
+#ifndef TSDB_H
+#define TSDB_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "process_monitor.h"
+
+// Formato binário compacto para históricos de métricas (.rmts), no estilo
+// Gorilla: cada série (PID) é gravada em blocos autodelimitados de até
+// TSDB_BLOCK_SAMPLES amostras. Dentro do bloco as amostras são codificadas
+// em sequência, campo a campo:
+//   - relógios e contadores monotônicos: delta-of-delta
+//   - gauges inteiros (RSS, threads, ...): delta
+//   - gauges de ponto flutuante (CPU%, KB/s): XOR com a amostra anterior
+// Todos os valores são preservados sem perdas.
+//
+// Layout do arquivo (inteiros little-endian):
+//   cabeçalho | bloco | bloco | ... | índice | rodapé
+// O índice (offset, PID, intervalo de tempo de cada bloco) e o rodapé só são
+// escritos em tsdb_writer_close. Se a captura for interrompida, o leitor
+// recupera os blocos completos varrendo o arquivo.
+#define TSDB_EXTENSION      ".rmts"
+#define TSDB_BLOCK_SAMPLES  240
+
+// Série em escrita: um bloco aberto por PID
+typedef struct TsdbSeries TsdbSeries;
+
+typedef struct {
+    uint64_t offset;            // posição do cabeçalho do bloco no arquivo
+    int32_t pid;
+    uint16_t count;             // amostras no bloco
+    uint64_t first_mono_ns;
+    uint64_t last_mono_ns;
+} TsdbIndexEntry;
+
+typedef struct {
+    FILE *fp;
+    uint64_t offset;            // bytes escritos até agora
+    unsigned long tick;         // geração atual (ver tsdb_writer_end_tick)
+
+    TsdbSeries **series;        // séries abertas (densas)
+    size_t series_count;
+    size_t series_cap;
+    int32_t *lookup;            // PID -> índice em series (endereçamento aberto, -1 = livre)
+    size_t lookup_cap;
+
+    TsdbIndexEntry *index;      // blocos já gravados
+    size_t index_count;
+    size_t index_cap;
+
+    uint64_t samples;           // total de amostras recebidas
+} TsdbWriter;
+
+bool tsdb_writer_open(TsdbWriter *w, const char *path);
+
+// Acrescenta uma amostra à série do PID. Blocos cheios vão para o disco.
+bool tsdb_writer_append(TsdbWriter *w, const ProcessMetrics *m);
+
+// Fecha (grava) os blocos das séries que não receberam amostras desde a
+// chamada anterior: processos encerrados não retêm memória no modo "top"
+bool tsdb_writer_end_tick(TsdbWriter *w);
+
+// Grava os blocos abertos de todas as séries (blocos menores, mas nada
+// fica só em memória). O arquivo continua aberto para novas amostras.
+bool tsdb_writer_flush(TsdbWriter *w);
+
+// Grava os blocos pendentes, o índice e o rodapé e fecha o arquivo.
+// Depois de fechar, offset (tamanho final) e samples continuam legíveis.
+bool tsdb_writer_close(TsdbWriter *w);
+
+typedef struct {
+    unsigned char *data;        // arquivo inteiro em memória
+    size_t size;
+    TsdbIndexEntry *index;
+    size_t block_count;
+    bool recovered;             // índice reconstruído por varredura (sem rodapé)
+} TsdbReader;
+
+bool tsdb_reader_open(TsdbReader *r, const char *path);
+void tsdb_reader_close(TsdbReader *r);
+
+// Decodifica o bloco i (ordem do índice) em out, que deve ter espaço para
+// TSDB_BLOCK_SAMPLES amostras. Retorna o número de amostras ou -1 se o
+// bloco está corrompido.
+int tsdb_reader_block(const TsdbReader *r, size_t i, ProcessMetrics *out);
+
+// Converte um arquivo .rmts para "json" ou "csv" (ordenado por PID e tempo).
+// out_path NULL ou "-" escreve na saída padrão.
+bool tsdb_dump(const char *path, const char *format, const char *out_path);
+
+// Exporta um histórico completo para .rmts
+bool export_metrics_tsdb(const char *filename, MetricsHistory *history);
+
+#endif // TSDB_H
@@ -1,9 +1,16 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdbool.h>
 #include "monitor.h"
+#include "serializer.h"
 
 void export_to_json(const ResourceData *data, int count, const char *filename);
 void export_to_csv(const ResourceData *data, int count, const char *filename);
 
+// Escritores de uma amostra (usados também pela exportação incremental)
+void write_resource_json(OutBuf *o, const ResourceData *d, bool compact);
+void write_resource_csv_header(OutBuf *o);
+void write_resource_csv_row(OutBuf *o, const ResourceData *d);
+
 #endif // UTILS_H
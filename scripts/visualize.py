@@ -25,17 +25,58 @@ except ImportError:
 
 
 def load_monitor_data(filename):
-    """Carrega dados do arquivo JSON de monitoramento"""
+    """Carrega dados do arquivo JSON de monitoramento.
+
+    Aceita também NDJSON (um objeto por linha) e arrays JSON truncados de
+    capturas interrompidas: as amostras já gravadas são aproveitadas.
+    """
     try:
         with open(filename, 'r') as f:
-            data = json.load(f)
-        return data
+            text = f.read()
     except FileNotFoundError:
         print(f"Erro: Arquivo '{filename}' não encontrado.")
         sys.exit(1)
+
+    try:
+        return json.loads(text)
     except json.JSONDecodeError:
-        print(f"Erro: Arquivo '{filename}' não é um JSON válido.")
-        sys.exit(1)
+        pass
+
+    # Array sem o "]" final: descarta o objeto incompleto, se houver
+    body = text.rstrip()
+    if body.startswith('['):
+        end = body.rfind('}')
+        if end >= 0:
+            try:
+                data = json.loads(body[:end + 1] + '\n]')
+                print(f"Aviso: '{filename}' está incompleto; usando {len(data)} amostras.")
+                return data
+            except json.JSONDecodeError:
+                pass
+
+    # NDJSON: ignora apenas uma última linha incompleta
+    try:
+        lines = [line for line in text.splitlines() if line.strip()]
+        data = [json.loads(line) for line in lines[:-1]]
+        if lines:
+            try:
+                data.append(json.loads(lines[-1]))
+            except json.JSONDecodeError:
+                pass
+        if data:
+            return data
+    except json.JSONDecodeError:
+        pass
+
+    print(f"Erro: Arquivo '{filename}' não é um JSON válido.")
+    sys.exit(1)
+
+
+def sample_time(sample):
+    """Instante da amostra (usa timestamp_ns quando disponível, para intervalos < 1s)"""
+    if 'timestamp_ns' in sample:
+        return datetime.fromtimestamp(sample['timestamp_ns'] / 1e9)
+    return datetime.fromtimestamp(sample['timestamp'])
 
 
 def plot_cpu_usage(data, output_dir):
@@ -44,7 +85,7 @@ def plot_cpu_usage(data, output_dir):
         print("Aviso: Nenhum dado para plotar CPU.")
         return
     
-    timestamps = [datetime.fromtimestamp(d['timestamp']) for d in data]
+    timestamps = [sample_time(d) for d in data]
     cpu_percent = [d['cpu_usage_percent'] for d in data]
     
     plt.figure(figsize=(12, 6))
@@ -68,7 +109,7 @@ def plot_memory_usage(data, output_dir):
         print("Aviso: Nenhum dado para plotar memória.")
         return
     
-    timestamps = [datetime.fromtimestamp(d['timestamp']) for d in data]
+    timestamps = [sample_time(d) for d in data]
     vsz_mb = [d['memory_vsz_kb'] / 1024 for d in data]  # Convert KB to MB
     rss_mb = [d['memory_rss_pages'] * 4 / 1024 for d in data]  # Assume 4KB pages, convert to MB
     
@@ -105,7 +146,7 @@ def plot_io_rates(data, output_dir):
         print("Aviso: Nenhum dado para plotar I/O.")
         return
     
-    timestamps = [datetime.fromtimestamp(d['timestamp']) for d in data]
+    timestamps = [sample_time(d) for d in data]
     read_rate_mbps = [d['io_read_rate_bps'] / (1024 * 1024) for d in data]  # Convert to MB/s
     write_rate_mbps = [d['io_write_rate_bps'] / (1024 * 1024) for d in data]
     
@@ -134,7 +175,7 @@ def plot_network_traffic(data, output_dir):
         print("Aviso: Nenhum dado para plotar rede.")
         return
     
-    timestamps = [datetime.fromtimestamp(d['timestamp']) for d in data]
+    timestamps = [sample_time(d) for d in data]
     rx_mb = [d['net_rx_bytes'] / (1024 * 1024) for d in data]  # Convert to MB
     tx_mb = [d['net_tx_bytes'] / (1024 * 1024) for d in data]
     
@@ -173,7 +214,7 @@ def plot_all_metrics(data, output_dir):
         print("Aviso: Nenhum dado para plotar dashboard.")
         return
     
-    timestamps = [datetime.fromtimestamp(d['timestamp']) for d in data]
+    timestamps = [sample_time(d) for d in data]
     
     fig, axes = plt.subplots(2, 2, figsize=(16, 12))
     fig.suptitle('Dashboard de Monitoramento de Recursos', fontsize=18, fontweight='bold')
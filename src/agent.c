@@ -0,0 +1,1186 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include "../include/agent.h"
+#include "../include/cgroup_stats.h"
+#include "../include/http_exporter.h"
+#include "../include/resource_collector.h"
+#include "../include/ring_buffer.h"
+#include "../include/timing.h"
+
+// Origem de cada evento do epoll: tipo nos 32 bits altos, slot nos baixos
+enum { EV_LISTEN = 1, EV_SIGNAL, EV_TIMER, EV_CLIENT, EV_HTTP, EV_EXPO, EV_CGROUP };
+#define EV_DATA(kind, slot) (((uint64_t)(kind) << 32) | (uint32_t)(slot))
+
+#define AGENT_MAX_EVENTS 64
+#define AGENT_DEFAULT_INTERVAL_NS NSEC_PER_SEC
+#define AGENT_LABELS_MAX 128
+
+// Processo observado: coletor aberto, temporizador próprio e histórico
+typedef struct {
+    int pid;
+    ResourceCollector collector;
+    SampleTimer timer;
+    bool timer_armed;
+    RingBuffer history;             // AgentSample (só esta thread escreve)
+    MetricsSummary summary;         // captura inteira, desde o WATCH
+    ResourceData prev;
+    bool has_prev;
+    bool ended;
+    uint64_t samples;
+    char labels[AGENT_LABELS_MAX];  // pid="..",comm=".." da exposição
+} AgentTarget;
+
+// Cgroup observado: índice no CgroupWatcher e histórico de eventos
+typedef struct {
+    char path[AGENT_CGROUP_PATH_LEN];
+    int index;                      // retornado por cgroup_watcher_add
+    RingBuffer events;              // AgentCgroupEvent
+    uint64_t count;
+    uint64_t last_mono_ns;
+    bool removed;
+} AgentCgroupTarget;
+
+// Conexão de cliente: entrada até um quadro completo, saída pendente
+typedef struct {
+    int fd;
+    int slot;
+    unsigned char in[sizeof(AgentHeader) + AGENT_MAX_PAYLOAD];
+    size_t in_len;
+    unsigned char *out;
+    size_t out_len;
+    size_t out_off;                 // já enviado
+    size_t out_cap;
+    bool want_write;                // EPOLLOUT registrado
+    uint64_t subscriptions;         // bit i = alvo no slot i
+    uint64_t cgroup_subscriptions;  // bit i = cgroup no slot i
+    uint64_t dropped;               // amostras descartadas (cliente lento)
+} AgentConn;
+
+typedef struct {
+    const char *path;
+    size_t retention;
+    int listen_fd;
+    int signal_fd;
+    int epoll_fd;
+    bool stop;
+    AgentTarget *targets[AGENT_MAX_TARGETS];
+    AgentConn *conns[AGENT_MAX_CLIENTS];
+
+    // Eventos de cgroups: um único observador, criado no primeiro WATCH_CGROUP
+    bool watcher_open;
+    CgroupWatcher watcher;
+    AgentCgroupTarget *cgroup_targets[AGENT_MAX_CGROUP_WATCHES];
+
+    long page_size;
+    long ticks_per_second;
+
+    // Endpoint Prometheus: corpo renderizado a cada expo_timer
+    bool http_enabled;
+    HttpExporter http;
+    SampleTimer expo_timer;
+    const char *cgroups[AGENT_MAX_CGROUPS];
+    char cgroup_labels[AGENT_MAX_CGROUPS][AGENT_LABELS_MAX];
+    int num_cgroups;
+} AgentServer;
+
+const char *agent_socket_path(void) {
+    const char *env = getenv(AGENT_SOCKET_ENV);
+    return (env && *env) ? env : AGENT_DEFAULT_SOCKET;
+}
+
+// ---------- Saída ----------
+
+static bool conn_flush(AgentServer *srv, AgentConn *c);
+
+static bool conn_reserve(AgentConn *c, size_t extra) {
+    // Compacta o que já foi enviado antes de crescer
+    if (c->out_off > 0) {
+        memmove(c->out, c->out + c->out_off, c->out_len - c->out_off);
+        c->out_len -= c->out_off;
+        c->out_off = 0;
+    }
+    if (c->out_len + extra <= c->out_cap) return true;
+    size_t cap = c->out_cap ? c->out_cap : 4096;
+    while (cap < c->out_len + extra) cap *= 2;
+    unsigned char *grown = realloc(c->out, cap);
+    if (!grown) return false;
+    c->out = grown;
+    c->out_cap = cap;
+    return true;
+}
+
+// Enfileira uma mensagem (cabeçalho + até dois trechos de payload)
+static bool conn_send(AgentServer *srv, AgentConn *c, AgentMsgType type, uint32_t seq,
+                      const void *a, size_t a_len, const void *b, size_t b_len) {
+    AgentHeader h = {
+        .magic = AGENT_MAGIC,
+        .version = AGENT_VERSION,
+        .type = (uint16_t)type,
+        .seq = seq,
+        .length = (uint32_t)(a_len + b_len),
+    };
+    if (!conn_reserve(c, sizeof(h) + a_len + b_len)) return false;
+    memcpy(c->out + c->out_len, &h, sizeof(h));
+    c->out_len += sizeof(h);
+    if (a_len) memcpy(c->out + c->out_len, a, a_len);
+    c->out_len += a_len;
+    if (b_len) memcpy(c->out + c->out_len, b, b_len);
+    c->out_len += b_len;
+    return conn_flush(srv, c);
+}
+
+static bool conn_error(AgentServer *srv, AgentConn *c, uint32_t seq, int code, const char *message) {
+    AgentError e = { .code = code };
+    snprintf(e.message, sizeof(e.message), "%s", message);
+    return conn_send(srv, c, AGENT_RESP_ERROR, seq, &e, sizeof(e), NULL, 0);
+}
+
+// Envia o que o socket aceitar; o resto espera o EPOLLOUT
+static bool conn_flush(AgentServer *srv, AgentConn *c) {
+    while (c->out_off < c->out_len) {
+        ssize_t n = send(c->fd, c->out + c->out_off, c->out_len - c->out_off, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        c->out_off += (size_t)n;
+    }
+    if (c->out_off == c->out_len) c->out_off = c->out_len = 0;
+
+    bool want = c->out_len > 0;
+    if (want != c->want_write) {
+        struct epoll_event ev = {
+            .events = EPOLLIN | (want ? EPOLLOUT : 0),
+            .data.u64 = EV_DATA(EV_CLIENT, c->slot),
+        };
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->want_write = want;
+    }
+    return true;
+}
+
+// ---------- Alvos ----------
+
+static int target_slot(const AgentServer *srv, int pid) {
+    for (int i = 0; i < AGENT_MAX_TARGETS; i++) {
+        if (srv->targets[i] && srv->targets[i]->pid == pid) return i;
+    }
+    return -1;
+}
+
+static void target_stop_timer(AgentServer *srv, AgentTarget *t) {
+    if (!t->timer_armed) return;
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, t->timer.fd, NULL);
+    sample_timer_close(&t->timer);
+    t->timer_armed = false;
+}
+
+static void target_free(AgentServer *srv, int slot) {
+    AgentTarget *t = srv->targets[slot];
+    target_stop_timer(srv, t);
+    if (!t->ended) resource_collector_close(&t->collector);
+    ring_free(&t->history);
+    free(t);
+    srv->targets[slot] = NULL;
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        if (srv->conns[i]) srv->conns[i]->subscriptions &= ~(1ULL << slot);
+    }
+}
+
+static void to_agent_sample(const AgentServer *srv, const ResourceData *d, AgentSample *s) {
+    *s = (AgentSample){
+        .mono_ns = d->mono_ns,
+        .real_ns = d->real_ns,
+        .interval_ns = d->interval_ns,
+        .cpu_percent = d->cpu_usage_percent,
+        .io_read_bps = d->io_read_rate,
+        .io_write_bps = d->io_write_rate,
+        .rss_bytes = (uint64_t)d->memory_rss * (uint64_t)srv->page_size,
+        .vsz_bytes = (uint64_t)d->memory_vsz * 1024,
+        .swap_bytes = (uint64_t)d->memory_swap * 1024,
+        .io_read_bytes = (uint64_t)d->io_read_bytes,
+        .io_write_bytes = (uint64_t)d->io_write_bytes,
+        .net_rx_bytes = (uint64_t)d->net_rx_bytes,
+        .net_tx_bytes = (uint64_t)d->net_tx_bytes,
+        .ctx_voluntary = (uint64_t)d->voluntary_context_switches,
+        .ctx_involuntary = (uint64_t)d->nonvoluntary_context_switches,
+        .page_faults_minor = (uint64_t)d->page_faults_minor,
+        .page_faults_major = (uint64_t)d->page_faults_major,
+        .pid = d->pid,
+        .threads = (uint32_t)d->num_threads,
+        .net_connections = (uint32_t)d->net_connections,
+    };
+}
+
+// Processo terminou: para a coleta, mantém o histórico e avisa os assinantes
+static void target_end(AgentServer *srv, int slot) {
+    AgentTarget *t = srv->targets[slot];
+    target_stop_timer(srv, t);
+    resource_collector_close(&t->collector);
+    t->ended = true;
+    printf("[agente] PID %d terminou (%llu amostras)\n", t->pid, (unsigned long long)t->samples);
+
+    AgentPidRequest msg = { .pid = t->pid };
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        AgentConn *c = srv->conns[i];
+        if (!c || !(c->subscriptions & (1ULL << slot))) continue;
+        c->subscriptions &= ~(1ULL << slot);
+        conn_send(srv, c, AGENT_MSG_ENDED, 0, &msg, sizeof(msg), NULL, 0);
+    }
+}
+
+// Uma coleta: taxas contra a amostra anterior, histórico, resumo e assinantes
+static void target_sample(AgentServer *srv, int slot) {
+    AgentTarget *t = srv->targets[slot];
+    ResourceData cur;
+    if (!resource_collector_sample(&t->collector, &cur)) {
+        target_end(srv, slot);
+        return;
+    }
+
+    cur.interval_ns = 0;
+    cur.cpu_usage_percent = 0.0;
+    cur.io_read_rate = cur.io_write_rate = 0.0;
+    if (t->has_prev && cur.mono_ns > t->prev.mono_ns) {
+        uint64_t dt_ns = cur.mono_ns - t->prev.mono_ns;
+        double dt = (double)dt_ns / NSEC_PER_SEC;
+        long cpu_diff = (cur.cpu_user + cur.cpu_system) - (t->prev.cpu_user + t->prev.cpu_system);
+        cur.interval_ns = dt_ns;
+        cur.cpu_usage_percent = 100.0 * (cpu_diff / (double)srv->ticks_per_second) / dt;
+        cur.io_read_rate = (cur.io_read_bytes - t->prev.io_read_bytes) / dt;
+        cur.io_write_rate = (cur.io_write_bytes - t->prev.io_write_bytes) / dt;
+        metrics_summary_add(&t->summary, cur.cpu_usage_percent, (double)cur.memory_rss * srv->page_size,
+                            cur.io_read_rate, cur.io_write_rate, dt_ns);
+    }
+    t->prev = cur;
+    t->has_prev = true;
+    t->samples++;
+
+    AgentSample s;
+    to_agent_sample(srv, &cur, &s);
+    ring_push(&t->history, &s);
+
+    // Assinante lento: a amostra é descartada em vez de crescer a fila
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        AgentConn *c = srv->conns[i];
+        if (!c || !(c->subscriptions & (1ULL << slot))) continue;
+        if (c->out_len - c->out_off > AGENT_MAX_BACKLOG) {
+            c->dropped++;
+            continue;
+        }
+        conn_send(srv, c, AGENT_MSG_SAMPLE, 0, &s, sizeof(s), NULL, 0);
+    }
+}
+
+// Rótulos do processo na exposição; o comm é lido uma vez, no WATCH
+static void target_labels(AgentTarget *t) {
+    char path[64], comm[32] = "", pid_str[16];
+    snprintf(path, sizeof(path), "/proc/%d/comm", t->pid);
+    FILE *f = fopen(path, "r");
+    if (f) {
+        if (fgets(comm, sizeof(comm), f)) comm[strcspn(comm, "\n")] = '\0';
+        fclose(f);
+    }
+    snprintf(pid_str, sizeof(pid_str), "%d", t->pid);
+    t->labels[0] = '\0';
+    expo_label(t->labels, sizeof(t->labels), "pid", pid_str);
+    expo_label(t->labels, sizeof(t->labels), "comm", comm);
+}
+
+// Começa a observar um processo (ou troca o intervalo, se já observado)
+static int target_watch(AgentServer *srv, int pid, uint64_t interval_ns, const char **why) {
+    int slot = target_slot(srv, pid);
+    if (slot >= 0 && !srv->targets[slot]->ended) {
+        if (!sample_timer_set_interval(&srv->targets[slot]->timer, interval_ns)) {
+            *why = "falha ao rearmar o temporizador";
+            return EIO;
+        }
+        return 0;
+    }
+    if (slot >= 0) target_free(srv, slot);     // terminado: recomeça
+
+    for (slot = 0; slot < AGENT_MAX_TARGETS && srv->targets[slot]; slot++) {}
+    if (slot == AGENT_MAX_TARGETS) {
+        *why = "limite de processos observados";
+        return ENOSPC;
+    }
+
+    AgentTarget *t = calloc(1, sizeof(AgentTarget));
+    if (!t) {
+        *why = "sem memória";
+        return ENOMEM;
+    }
+    t->pid = pid;
+    target_labels(t);
+    metrics_summary_init(&t->summary);
+    if (!resource_collector_open(&t->collector, pid, collect_backend_get())) {
+        free(t);
+        *why = "processo não encontrado";
+        return ESRCH;
+    }
+    if (!ring_init(&t->history, srv->retention, sizeof(AgentSample))) {
+        resource_collector_close(&t->collector);
+        free(t);
+        *why = "sem memória para o histórico";
+        return ENOMEM;
+    }
+    // Não bloqueante: um evento velho do lote (slot reutilizado) só lê EAGAIN
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EV_DATA(EV_TIMER, slot) };
+    if (!sample_timer_start(&t->timer, interval_ns) ||
+        fcntl(t->timer.fd, F_SETFL, O_NONBLOCK) < 0 ||
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, t->timer.fd, &ev) < 0) {
+        resource_collector_close(&t->collector);
+        ring_free(&t->history);
+        free(t);
+        *why = "falha ao armar o temporizador";
+        return EIO;
+    }
+    t->timer_armed = true;
+    srv->targets[slot] = t;
+
+    char interval_str[32];
+    format_duration_ns(interval_ns, interval_str, sizeof(interval_str));
+    printf("[agente] Observando PID %d a cada %s (backend %s)\n", pid, interval_str,
+           collect_backend_name(t->collector.backend));
+    target_sample(srv, slot);       // primeira amostra imediata
+    return 0;
+}
+
+// ---------- Cgroups ----------
+
+static int cgroup_target_slot(const AgentServer *srv, const char *path) {
+    for (int i = 0; i < AGENT_MAX_CGROUP_WATCHES; i++) {
+        if (srv->cgroup_targets[i] && strcmp(srv->cgroup_targets[i]->path, path) == 0) return i;
+    }
+    return -1;
+}
+
+static void cgroup_target_free(AgentServer *srv, int slot) {
+    AgentCgroupTarget *t = srv->cgroup_targets[slot];
+    if (!t->removed) cgroup_watcher_remove(&srv->watcher, t->index);
+    ring_free(&t->events);
+    free(t);
+    srv->cgroup_targets[slot] = NULL;
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        if (srv->conns[i]) srv->conns[i]->cgroup_subscriptions &= ~(1ULL << slot);
+    }
+}
+
+// Callback do CgroupWatcher: histórico do cgroup e assinantes
+static void cgroup_event(const CgroupEvent *ev, void *ctx) {
+    AgentServer *srv = ctx;
+    int slot = 0;
+    while (slot < AGENT_MAX_CGROUP_WATCHES &&
+           !(srv->cgroup_targets[slot] && srv->cgroup_targets[slot]->index == ev->cgroup)) {
+        slot++;
+    }
+    if (slot == AGENT_MAX_CGROUP_WATCHES) return;
+    AgentCgroupTarget *t = srv->cgroup_targets[slot];
+
+    AgentCgroupEvent e = {
+        .mono_ns = ev->mono_ns,
+        .real_ns = ev->real_ns,
+        .value = ev->value,
+        .delta = ev->delta,
+        .file = (uint32_t)ev->file,
+    };
+    snprintf(e.key, sizeof(e.key), "%s", ev->key);
+    snprintf(e.path, sizeof(e.path), "%s", t->path);
+    ring_push(&t->events, &e);
+    t->count++;
+    t->last_mono_ns = ev->mono_ns;
+
+    bool removed = strcmp(ev->key, "removed") == 0;
+    if (removed) {
+        t->removed = true;
+        printf("[agente] Cgroup %s removido (%llu eventos)\n", t->path, (unsigned long long)t->count);
+    }
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        AgentConn *c = srv->conns[i];
+        if (!c || !(c->cgroup_subscriptions & (1ULL << slot))) continue;
+        // O "removed" encerra a assinatura: entregue mesmo com fila cheia
+        if (!removed && c->out_len - c->out_off > AGENT_MAX_BACKLOG) {
+            c->dropped++;
+            continue;
+        }
+        conn_send(srv, c, AGENT_MSG_CGROUP_EVENT, 0, &e, sizeof(e), NULL, 0);
+        if (removed) c->cgroup_subscriptions &= ~(1ULL << slot);
+    }
+}
+
+// Começa a observar os eventos de um cgroup (sem efeito se já observado)
+static int cgroup_watch(AgentServer *srv, const char *path, const char **why) {
+    int slot = cgroup_target_slot(srv, path);
+    if (slot >= 0 && !srv->cgroup_targets[slot]->removed) return 0;
+    if (slot >= 0) cgroup_target_free(srv, slot);      // removido: recomeça
+
+    if (!srv->watcher_open) {
+        struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EV_DATA(EV_CGROUP, 0) };
+        if (!cgroup_watcher_init(&srv->watcher, cgroup_event, srv)) {
+            *why = "falha ao criar o observador";
+            return EIO;
+        }
+        if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, cgroup_watcher_fd(&srv->watcher), &ev) < 0) {
+            cgroup_watcher_close(&srv->watcher);
+            *why = "falha ao registrar o observador";
+            return EIO;
+        }
+        srv->watcher_open = true;
+    }
+
+    for (slot = 0; slot < AGENT_MAX_CGROUP_WATCHES && srv->cgroup_targets[slot]; slot++) {}
+    if (slot == AGENT_MAX_CGROUP_WATCHES) {
+        *why = "limite de cgroups observados";
+        return ENOSPC;
+    }
+    AgentCgroupTarget *t = calloc(1, sizeof(AgentCgroupTarget));
+    if (!t || !ring_init(&t->events, AGENT_CGROUP_RETENTION, sizeof(AgentCgroupEvent))) {
+        free(t);
+        *why = "sem memória";
+        return ENOMEM;
+    }
+    snprintf(t->path, sizeof(t->path), "%s", path);
+    t->index = cgroup_watcher_add(&srv->watcher, path);
+    if (t->index < 0) {
+        ring_free(&t->events);
+        free(t);
+        *why = "cgroup sem arquivos de eventos";
+        return ENOENT;
+    }
+    srv->cgroup_targets[slot] = t;
+    printf("[agente] Observando eventos do cgroup %s\n", path);
+    return 0;
+}
+
+// Caminho da requisição: terminado em '\0', sem "..", sem barras nas pontas
+static bool cgroup_request_path(const AgentCgroupRequest *r, char *out) {
+    if (!memchr(r->path, '\0', sizeof(r->path))) return false;
+    const char *p = r->path;
+    while (*p == '/') p++;
+    snprintf(out, AGENT_CGROUP_PATH_LEN, "%s", p);
+    size_t len = strlen(out);
+    while (len > 0 && out[len - 1] == '/') out[--len] = '\0';
+    for (const char *c = out; (c = strstr(c, "..")); c += 2) {
+        if ((c == out || c[-1] == '/') && (c[2] == '\0' || c[2] == '/')) return false;
+    }
+    return len > 0;
+}
+
+static void handle_list_cgroups(AgentServer *srv, AgentConn *c, uint32_t seq) {
+    AgentCgroupInfo infos[AGENT_MAX_CGROUP_WATCHES];
+    uint32_t n = 0;
+    for (int i = 0; i < AGENT_MAX_CGROUP_WATCHES; i++) {
+        AgentCgroupTarget *t = srv->cgroup_targets[i];
+        if (!t) continue;
+        uint32_t subscribers = 0;
+        for (int k = 0; k < AGENT_MAX_CLIENTS; k++) {
+            if (srv->conns[k] && (srv->conns[k]->cgroup_subscriptions & (1ULL << i))) subscribers++;
+        }
+        infos[n] = (AgentCgroupInfo){
+            .removed = t->removed,
+            .subscribers = subscribers,
+            .events = t->count,
+            .retained = (uint32_t)(ring_head(&t->events) - ring_oldest(&t->events)),
+            .last_mono_ns = t->last_mono_ns,
+        };
+        memcpy(infos[n].path, t->path, sizeof(infos[n].path));
+        n++;
+    }
+    conn_send(srv, c, AGENT_RESP_CGROUPS, seq, infos, n * sizeof(AgentCgroupInfo), NULL, 0);
+}
+
+static void handle_query_cgroup(AgentServer *srv, AgentConn *c, uint32_t seq, int slot) {
+    AgentCgroupTarget *t = srv->cgroup_targets[slot];
+    uint64_t head = ring_head(&t->events);
+    uint64_t pos = ring_oldest(&t->events);
+    uint32_t count = (uint32_t)(head - pos);
+    AgentCgroupEvent *events = malloc((count ? count : 1) * sizeof(AgentCgroupEvent));
+    if (!events) {
+        conn_error(srv, c, seq, ENOMEM, "sem memória");
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++) ring_read(&t->events, pos + i, &events[i]);
+    conn_send(srv, c, AGENT_RESP_CGROUP_EVENTS, seq, events, count * sizeof(AgentCgroupEvent), NULL, 0);
+    free(events);
+}
+
+static void handle_cgroup_request(AgentServer *srv, AgentConn *c, const AgentHeader *h,
+                                  const AgentCgroupRequest *r) {
+    char path[AGENT_CGROUP_PATH_LEN];
+    if (!cgroup_request_path(r, path)) {
+        conn_error(srv, c, h->seq, EINVAL, "caminho de cgroup inválido");
+        return;
+    }
+    if (h->type == AGENT_REQ_WATCH_CGROUP) {
+        const char *why = "";
+        int err = cgroup_watch(srv, path, &why);
+        if (err == 0) conn_send(srv, c, AGENT_RESP_OK, h->seq, NULL, 0, NULL, 0);
+        else conn_error(srv, c, h->seq, err, why);
+        return;
+    }
+
+    int slot = cgroup_target_slot(srv, path);
+    if (slot < 0) {
+        conn_error(srv, c, h->seq, ENOENT, "cgroup não observado");
+        return;
+    }
+    switch (h->type) {
+        case AGENT_REQ_UNWATCH_CGROUP:
+            cgroup_target_free(srv, slot);
+            printf("[agente] Cgroup %s removido da observação\n", path);
+            break;
+        case AGENT_REQ_QUERY_CGROUP:
+            handle_query_cgroup(srv, c, h->seq, slot);
+            return;
+        case AGENT_REQ_SUBSCRIBE_CGROUP:
+            if (srv->cgroup_targets[slot]->removed) {
+                conn_error(srv, c, h->seq, ENOENT, "cgroup removido");
+                return;
+            }
+            c->cgroup_subscriptions |= 1ULL << slot;
+            break;
+        default:    // AGENT_REQ_UNSUBSCRIBE_CGROUP
+            c->cgroup_subscriptions &= ~(1ULL << slot);
+            break;
+    }
+    conn_send(srv, c, AGENT_RESP_OK, h->seq, NULL, 0, NULL, 0);
+}
+
+// ---------- Requisições ----------
+
+static void handle_query(AgentServer *srv, AgentConn *c, uint32_t seq, const AgentQueryRequest *q) {
+    int slot = target_slot(srv, q->pid);
+    if (slot < 0) {
+        conn_error(srv, c, seq, ENOENT, "processo não observado");
+        return;
+    }
+    AgentTarget *t = srv->targets[slot];
+    uint64_t head = ring_head(&t->history);
+    uint64_t pos = ring_oldest(&t->history);
+
+    // Janela relativa à última amostra (o processo pode ter terminado)
+    if (q->window_ns > 0 && head > 0) {
+        AgentSample last;
+        ring_read_latest(&t->history, &last);
+        uint64_t since = (last.mono_ns > q->window_ns) ? last.mono_ns - q->window_ns : 0;
+        AgentSample s;
+        while (pos < head && ring_read(&t->history, pos, &s) && s.mono_ns < since) pos++;
+    }
+    if (q->max_samples > 0 && head - pos > q->max_samples) pos = head - q->max_samples;
+
+    AgentSamplesHeader hdr = { .pid = q->pid, .count = (uint32_t)(head - pos) };
+    AgentSample *samples = malloc((hdr.count ? hdr.count : 1) * sizeof(AgentSample));
+    if (!samples) {
+        conn_error(srv, c, seq, ENOMEM, "sem memória");
+        return;
+    }
+    for (uint32_t i = 0; i < hdr.count; i++) ring_read(&t->history, pos + i, &samples[i]);
+    conn_send(srv, c, AGENT_RESP_SAMPLES, seq, &hdr, sizeof(hdr), samples, hdr.count * sizeof(AgentSample));
+    free(samples);
+}
+
+static void handle_list(AgentServer *srv, AgentConn *c, uint32_t seq) {
+    AgentTargetInfo infos[AGENT_MAX_TARGETS];
+    uint32_t n = 0;
+    for (int i = 0; i < AGENT_MAX_TARGETS; i++) {
+        AgentTarget *t = srv->targets[i];
+        if (!t) continue;
+        uint32_t subscribers = 0;
+        for (int k = 0; k < AGENT_MAX_CLIENTS; k++) {
+            if (srv->conns[k] && (srv->conns[k]->subscriptions & (1ULL << i))) subscribers++;
+        }
+        infos[n++] = (AgentTargetInfo){
+            .pid = t->pid,
+            .ended = t->ended,
+            .interval_ns = t->timer.interval_ns,
+            .samples = t->samples,
+            .retained = (uint32_t)(ring_head(&t->history) - ring_oldest(&t->history)),
+            .subscribers = subscribers,
+            .last_mono_ns = t->prev.mono_ns,
+        };
+    }
+    conn_send(srv, c, AGENT_RESP_TARGETS, seq, infos, n * sizeof(AgentTargetInfo), NULL, 0);
+}
+
+static void handle_request(AgentServer *srv, int conn_slot, const AgentHeader *h, const void *payload) {
+    AgentConn *c = srv->conns[conn_slot];
+    const AgentPidRequest *pr = payload;
+    int slot;
+
+    // Tamanho mínimo do payload por tipo
+    size_t need = 0;
+    switch (h->type) {
+        case AGENT_REQ_WATCH: need = sizeof(AgentWatchRequest); break;
+        case AGENT_REQ_QUERY: need = sizeof(AgentQueryRequest); break;
+        case AGENT_REQ_UNWATCH:
+        case AGENT_REQ_SUMMARY:
+        case AGENT_REQ_SUBSCRIBE:
+        case AGENT_REQ_UNSUBSCRIBE: need = sizeof(AgentPidRequest); break;
+        case AGENT_REQ_WATCH_CGROUP:
+        case AGENT_REQ_UNWATCH_CGROUP:
+        case AGENT_REQ_QUERY_CGROUP:
+        case AGENT_REQ_SUBSCRIBE_CGROUP:
+        case AGENT_REQ_UNSUBSCRIBE_CGROUP: need = sizeof(AgentCgroupRequest); break;
+        default: break;
+    }
+    if (h->length < need) {
+        conn_error(srv, c, h->seq, EINVAL, "requisição truncada");
+        return;
+    }
+
+    switch (h->type) {
+        case AGENT_REQ_WATCH: {
+            const AgentWatchRequest *w = payload;
+            const char *why = "";
+            uint64_t interval = w->interval_ns ? w->interval_ns : AGENT_DEFAULT_INTERVAL_NS;
+            int err = (w->pid > 0) ? target_watch(srv, w->pid, interval, &why) : EINVAL;
+            if (err == 0) conn_send(srv, c, AGENT_RESP_OK, h->seq, NULL, 0, NULL, 0);
+            else conn_error(srv, c, h->seq, err, (w->pid > 0) ? why : "PID inválido");
+            break;
+        }
+        case AGENT_REQ_UNWATCH:
+            if ((slot = target_slot(srv, pr->pid)) < 0) {
+                conn_error(srv, c, h->seq, ENOENT, "processo não observado");
+                break;
+            }
+            target_free(srv, slot);
+            printf("[agente] PID %d removido\n", pr->pid);
+            conn_send(srv, c, AGENT_RESP_OK, h->seq, NULL, 0, NULL, 0);
+            break;
+        case AGENT_REQ_LIST:
+            handle_list(srv, c, h->seq);
+            break;
+        case AGENT_REQ_QUERY:
+            handle_query(srv, c, h->seq, payload);
+            break;
+        case AGENT_REQ_SUMMARY: {
+            if ((slot = target_slot(srv, pr->pid)) < 0) {
+                conn_error(srv, c, h->seq, ENOENT, "processo não observado");
+                break;
+            }
+            AgentSummary sum = { .pid = pr->pid };
+            for (int i = 0; i < SUMMARY_COUNT; i++) {
+                metric_summary_get(&srv->targets[slot]->summary.metrics[i], &sum.metrics[i]);
+            }
+            conn_send(srv, c, AGENT_RESP_SUMMARY, h->seq, &sum, sizeof(sum), NULL, 0);
+            break;
+        }
+        case AGENT_REQ_SUBSCRIBE:
+        case AGENT_REQ_UNSUBSCRIBE:
+            if ((slot = target_slot(srv, pr->pid)) < 0) {
+                conn_error(srv, c, h->seq, ENOENT, "processo não observado");
+                break;
+            }
+            if (h->type == AGENT_REQ_UNSUBSCRIBE) {
+                c->subscriptions &= ~(1ULL << slot);
+            } else if (srv->targets[slot]->ended) {
+                conn_error(srv, c, h->seq, ESRCH, "processo terminou");
+                break;
+            } else {
+                c->subscriptions |= 1ULL << slot;
+            }
+            conn_send(srv, c, AGENT_RESP_OK, h->seq, NULL, 0, NULL, 0);
+            break;
+        case AGENT_REQ_SHUTDOWN:
+            conn_send(srv, c, AGENT_RESP_OK, h->seq, NULL, 0, NULL, 0);
+            srv->stop = true;
+            break;
+        case AGENT_REQ_WATCH_CGROUP:
+        case AGENT_REQ_UNWATCH_CGROUP:
+        case AGENT_REQ_QUERY_CGROUP:
+        case AGENT_REQ_SUBSCRIBE_CGROUP:
+        case AGENT_REQ_UNSUBSCRIBE_CGROUP:
+            handle_cgroup_request(srv, c, h, payload);
+            break;
+        case AGENT_REQ_LIST_CGROUPS:
+            handle_list_cgroups(srv, c, h->seq);
+            break;
+        default:
+            conn_error(srv, c, h->seq, EINVAL, "tipo de requisição desconhecido");
+            break;
+    }
+}
+
+// ---------- Conexões ----------
+
+static void conn_close(AgentServer *srv, int slot) {
+    AgentConn *c = srv->conns[slot];
+    if (c->dropped > 0) {
+        printf("[agente] Cliente %d: %llu amostra(s) descartada(s) por atraso na leitura\n",
+               slot, (unsigned long long)c->dropped);
+    }
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c->out);
+    free(c);
+    srv->conns[slot] = NULL;
+}
+
+static void accept_clients(AgentServer *srv) {
+    for (;;) {
+        int fd = accept4(srv->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;     // EAGAIN: fila vazia
+        }
+        int slot = 0;
+        while (slot < AGENT_MAX_CLIENTS && srv->conns[slot]) slot++;
+        AgentConn *c = (slot < AGENT_MAX_CLIENTS) ? calloc(1, sizeof(AgentConn)) : NULL;
+        struct epoll_event ev = { .events = EPOLLIN, .data.u64 = EV_DATA(EV_CLIENT, slot) };
+        if (!c || epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            fprintf(stderr, "[agente] Conexão recusada: limite de clientes\n");
+            free(c);
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->slot = slot;
+        srv->conns[slot] = c;
+    }
+}
+
+// Lê o que chegou e atende cada quadro completo. Retorna false se a
+// conexão deve ser fechada (EOF, erro ou quadro inválido).
+static bool conn_read(AgentServer *srv, int slot) {
+    AgentConn *c = srv->conns[slot];
+    for (;;) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len, 0);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        c->in_len += (size_t)n;
+
+        size_t off = 0;
+        while (c->in_len - off >= sizeof(AgentHeader)) {
+            AgentHeader h;
+            memcpy(&h, c->in + off, sizeof(h));
+            if (h.magic != AGENT_MAGIC || h.version != AGENT_VERSION || h.length > AGENT_MAX_PAYLOAD) {
+                return false;
+            }
+            if (c->in_len - off < sizeof(h) + h.length) break;
+            handle_request(srv, slot, &h, c->in + off + sizeof(h));
+            off += sizeof(h) + h.length;
+            if (srv->stop) return true;
+        }
+        memmove(c->in, c->in + off, c->in_len - off);
+        c->in_len -= off;
+    }
+}
+
+// ---------- Exposição (Prometheus) ----------
+
+// Série por processo a partir da última AgentSample
+typedef struct {
+    const char *name;
+    const char *type;           // NULL: mesma família da entrada anterior
+    const char *help;
+    const char *extra;
+    size_t field;               // offsetof(AgentSample, ...)
+    char kind;                  // 'u' uint64_t, 'w' uint32_t, 'd' double
+} ProcessSeries;
+
+static const ProcessSeries process_series[] = {
+    { "resmon_process_cpu_percent", "gauge", "Uso de CPU no último intervalo (100 = um núcleo).",
+      NULL, offsetof(AgentSample, cpu_percent), 'd' },
+    { "resmon_process_resident_memory_bytes", "gauge", "Memória residente (RSS).",
+      NULL, offsetof(AgentSample, rss_bytes), 'u' },
+    { "resmon_process_virtual_memory_bytes", "gauge", "Memória virtual (VSZ).",
+      NULL, offsetof(AgentSample, vsz_bytes), 'u' },
+    { "resmon_process_swap_bytes", "gauge", "Memória em swap.",
+      NULL, offsetof(AgentSample, swap_bytes), 'u' },
+    { "resmon_process_threads", "gauge", "Threads do processo.",
+      NULL, offsetof(AgentSample, threads), 'w' },
+    { "resmon_process_context_switches_total", "counter", "Trocas de contexto.",
+      "type=\"voluntary\"", offsetof(AgentSample, ctx_voluntary), 'u' },
+    { "resmon_process_context_switches_total", NULL, NULL,
+      "type=\"involuntary\"", offsetof(AgentSample, ctx_involuntary), 'u' },
+    { "resmon_process_page_faults_total", "counter", "Faltas de página.",
+      "type=\"minor\"", offsetof(AgentSample, page_faults_minor), 'u' },
+    { "resmon_process_page_faults_total", NULL, NULL,
+      "type=\"major\"", offsetof(AgentSample, page_faults_major), 'u' },
+    { "resmon_process_io_bytes_total", "counter", "Bytes lidos/escritos em armazenamento.",
+      "direction=\"read\"", offsetof(AgentSample, io_read_bytes), 'u' },
+    { "resmon_process_io_bytes_total", NULL, NULL,
+      "direction=\"write\"", offsetof(AgentSample, io_write_bytes), 'u' },
+    // Contador: sock_diag acumula os bytes dos sockets já fechados
+    { "resmon_process_network_bytes_total", "counter",
+      "Bytes TCP recebidos/enviados pelos sockets do processo, incluindo os já fechados.",
+      "direction=\"receive\"", offsetof(AgentSample, net_rx_bytes), 'u' },
+    { "resmon_process_network_bytes_total", NULL, NULL,
+      "direction=\"transmit\"", offsetof(AgentSample, net_tx_bytes), 'u' },
+    { "resmon_process_network_connections", "gauge", "Conexões de rede abertas.",
+      NULL, offsetof(AgentSample, net_connections), 'w' },
+};
+
+// Séries por cgroup, na ordem de cgroup_series
+enum {
+    CG_CPU_USAGE, CG_CPU_USER, CG_CPU_SYSTEM, CG_CPU_PERIODS, CG_CPU_THROTTLED, CG_CPU_THROTTLED_TIME,
+    CG_MEM_CURRENT, CG_MEM_MAX, CG_MEM_PEAK, CG_MEM_ANON, CG_MEM_FILE,
+    CG_IO_READ_BYTES, CG_IO_WRITE_BYTES, CG_IO_READ_OPS, CG_IO_WRITE_OPS,
+    CG_SERIES_COUNT
+};
+
+typedef struct {
+    const char *name;
+    const char *type;           // NULL: mesma família da entrada anterior
+    const char *help;
+    const char *extra;
+    int decimals;
+} CgroupSeries;
+
+static const CgroupSeries cgroup_series[CG_SERIES_COUNT] = {
+    [CG_CPU_USAGE] = { "resmon_cgroup_cpu_usage_seconds_total", "counter",
+                       "Tempo de CPU do cgroup (cpu.stat usage_usec).", NULL, 6 },
+    [CG_CPU_USER] = { "resmon_cgroup_cpu_seconds_total", "counter",
+                      "Tempo de CPU do cgroup por modo.", "mode=\"user\"", 6 },
+    [CG_CPU_SYSTEM] = { "resmon_cgroup_cpu_seconds_total", NULL, NULL, "mode=\"system\"", 6 },
+    [CG_CPU_PERIODS] = { "resmon_cgroup_cpu_periods_total", "counter",
+                         "Períodos de enforcement do cpu.max.", NULL, 0 },
+    [CG_CPU_THROTTLED] = { "resmon_cgroup_cpu_throttled_periods_total", "counter",
+                           "Períodos em que o cgroup foi limitado.", NULL, 0 },
+    [CG_CPU_THROTTLED_TIME] = { "resmon_cgroup_cpu_throttled_seconds_total", "counter",
+                                "Tempo total limitado pelo cpu.max.", NULL, 6 },
+    [CG_MEM_CURRENT] = { "resmon_cgroup_memory_current_bytes", "gauge", "Memória em uso (memory.current).", NULL, 0 },
+    [CG_MEM_MAX] = { "resmon_cgroup_memory_max_bytes", "gauge",
+                     "Limite de memória (memory.max; +Inf sem limite).", NULL, 0 },
+    [CG_MEM_PEAK] = { "resmon_cgroup_memory_peak_bytes", "gauge", "Pico de memória (memory.peak).", NULL, 0 },
+    [CG_MEM_ANON] = { "resmon_cgroup_memory_anon_bytes", "gauge", "Memória anônima (memory.stat anon).", NULL, 0 },
+    [CG_MEM_FILE] = { "resmon_cgroup_memory_file_bytes", "gauge", "Cache de arquivos (memory.stat file).", NULL, 0 },
+    [CG_IO_READ_BYTES] = { "resmon_cgroup_io_bytes_total", "counter",
+                           "Bytes de I/O de bloco (io.stat, todos os dispositivos).", "direction=\"read\"", 0 },
+    [CG_IO_WRITE_BYTES] = { "resmon_cgroup_io_bytes_total", NULL, NULL, "direction=\"write\"", 0 },
+    [CG_IO_READ_OPS] = { "resmon_cgroup_io_operations_total", "counter",
+                         "Operações de I/O de bloco (io.stat).", "direction=\"read\"", 0 },
+    [CG_IO_WRITE_OPS] = { "resmon_cgroup_io_operations_total", NULL, NULL, "direction=\"write\"", 0 },
+};
+
+// Estatísticas de um cgroup lidas no ciclo atual
+typedef struct {
+    bool up;
+    double v[CG_SERIES_COUNT];
+} CgroupSnapshot;
+
+// Uma leitura por ciclo; cgroup ausente (ou hierarquia v1) só vira up 0
+static void cgroup_snapshot(const char *cgroup, CgroupSnapshot *snap) {
+    char path[512];
+    CPUStat cpu;
+    MemoryStat mem;
+    IOStat io;
+    memset(snap, 0, sizeof(*snap));
+    snprintf(path, sizeof(path), "%s/%s/cpu.stat", CGROUP_ROOT, cgroup);
+    if (access(path, R_OK) != 0 || read_cpu_metrics(cgroup, &cpu) != 0) return;
+    read_memory_metrics(cgroup, &mem);
+    read_io_metrics(cgroup, &io);
+    snap->up = true;
+
+    snap->v[CG_CPU_USAGE] = cpu.cpu_usage_usec / 1e6;
+    snap->v[CG_CPU_USER] = cpu.cpu_user_usec / 1e6;
+    snap->v[CG_CPU_SYSTEM] = cpu.cpu_system_usec / 1e6;
+    snap->v[CG_CPU_PERIODS] = (double)cpu.nr_periods;
+    snap->v[CG_CPU_THROTTLED] = (double)cpu.nr_throttled;
+    snap->v[CG_CPU_THROTTLED_TIME] = cpu.throttled_usec / 1e6;
+    snap->v[CG_MEM_CURRENT] = (double)mem.current;
+    snap->v[CG_MEM_MAX] = mem.max ? (double)mem.max : INFINITY;
+    snap->v[CG_MEM_PEAK] = (double)mem.peak;
+    snap->v[CG_MEM_ANON] = (double)mem.anon;
+    snap->v[CG_MEM_FILE] = (double)mem.file;
+    snap->v[CG_IO_READ_BYTES] = (double)io.rbytes;
+    snap->v[CG_IO_WRITE_BYTES] = (double)io.wbytes;
+    snap->v[CG_IO_READ_OPS] = (double)io.rios;
+    snap->v[CG_IO_WRITE_OPS] = (double)io.wios;
+}
+
+static void render_processes(AgentServer *srv, OutBuf *o) {
+    AgentSample latest[AGENT_MAX_TARGETS];
+    bool has[AGENT_MAX_TARGETS] = { false };
+    int observed = 0, sampled = 0;
+    for (int i = 0; i < AGENT_MAX_TARGETS; i++) {
+        AgentTarget *t = srv->targets[i];
+        if (t) observed++;
+        if (t && t->has_prev) has[i] = ring_read_latest(&t->history, &latest[i]);
+        if (has[i]) sampled++;
+    }
+    if (observed == 0) return;
+
+    expo_family(o, "resmon_process_up", "gauge", "1 enquanto o processo observado existe.");
+    for (int i = 0; i < AGENT_MAX_TARGETS; i++) {
+        const AgentTarget *t = srv->targets[i];
+        if (t) expo_value_u64(o, "resmon_process_up", t->labels, NULL, !t->ended);
+    }
+    if (sampled == 0) return;
+    expo_family(o, "resmon_process_cpu_seconds_total", "counter", "Tempo de CPU consumido.");
+    for (int i = 0; i < AGENT_MAX_TARGETS; i++) {
+        if (!has[i]) continue;
+        const AgentTarget *t = srv->targets[i];
+        double tps = (double)srv->ticks_per_second;
+        expo_value(o, "resmon_process_cpu_seconds_total", t->labels, "mode=\"user\"", t->prev.cpu_user / tps, 2);
+        expo_value(o, "resmon_process_cpu_seconds_total", t->labels, "mode=\"system\"", t->prev.cpu_system / tps, 2);
+    }
+
+    for (size_t k = 0; k < sizeof(process_series) / sizeof(process_series[0]); k++) {
+        const ProcessSeries *ps = &process_series[k];
+        if (ps->type) expo_family(o, ps->name, ps->type, ps->help);
+        for (int i = 0; i < AGENT_MAX_TARGETS; i++) {
+            if (!has[i]) continue;
+            const unsigned char *field = (const unsigned char *)&latest[i] + ps->field;
+            const char *labels = srv->targets[i]->labels;
+            if (ps->kind == 'd') {
+                double v;
+                memcpy(&v, field, sizeof(v));
+                expo_value(o, ps->name, labels, ps->extra, v, 2);
+            } else if (ps->kind == 'w') {
+                uint32_t v;
+                memcpy(&v, field, sizeof(v));
+                expo_value_u64(o, ps->name, labels, ps->extra, v);
+            } else {
+                uint64_t v;
+                memcpy(&v, field, sizeof(v));
+                expo_value_u64(o, ps->name, labels, ps->extra, v);
+            }
+        }
+    }
+}
+
+static void render_cgroups(AgentServer *srv, OutBuf *o) {
+    if (srv->num_cgroups == 0) return;
+    CgroupSnapshot snap[AGENT_MAX_CGROUPS];
+    int up = 0;
+    for (int i = 0; i < srv->num_cgroups; i++) {
+        cgroup_snapshot(srv->cgroups[i], &snap[i]);
+        up += snap[i].up;
+    }
+
+    expo_family(o, "resmon_cgroup_up", "gauge", "1 se as estatísticas do cgroup puderam ser lidas.");
+    for (int i = 0; i < srv->num_cgroups; i++) {
+        expo_value_u64(o, "resmon_cgroup_up", srv->cgroup_labels[i], NULL, snap[i].up);
+    }
+    if (up == 0) return;
+    for (int k = 0; k < CG_SERIES_COUNT; k++) {
+        const CgroupSeries *cs = &cgroup_series[k];
+        if (cs->type) expo_family(o, cs->name, cs->type, cs->help);
+        for (int i = 0; i < srv->num_cgroups; i++) {
+            if (snap[i].up) expo_value(o, cs->name, srv->cgroup_labels[i], cs->extra, snap[i].v[k], cs->decimals);
+        }
+    }
+}
+
+// Reconstrói o corpo servido no /metrics: as raspagens só enviam o memfd
+static void render_exposition(AgentServer *srv) {
+    OutBuf *o = http_exporter_begin(&srv->http);
+    if (!o) {
+        fprintf(stderr, "[agente] Falha ao criar o corpo da exposição: %s\n", strerror(errno));
+        return;
+    }
+    render_processes(srv, o);
+    render_cgroups(srv, o);
+
+    const HttpExporter *h = &srv->http;
+    expo_family(o, "resmon_exporter_renders_total", "counter", "Renderizações da exposição.");
+    expo_value_u64(o, "resmon_exporter_renders_total", NULL, NULL, h->renders + 1);
+    expo_family(o, "resmon_exporter_render_duration_seconds", "gauge", "Duração da renderização anterior.");
+    expo_value(o, "resmon_exporter_render_duration_seconds", NULL, NULL, (double)h->last_render_ns / NSEC_PER_SEC, 6);
+    expo_family(o, "resmon_exporter_scrapes_total", "counter", "Respostas a GET/HEAD /metrics.");
+    expo_value_u64(o, "resmon_exporter_scrapes_total", NULL, NULL, h->scrapes);
+
+    if (!http_exporter_commit(&srv->http)) {
+        fprintf(stderr, "[agente] Falha ao escrever o corpo da exposição\n");
+    }
+}
+
+// Endpoint HTTP e temporizador de renderização
+static bool expo_open(AgentServer *srv, const AgentConfig *cfg) {
+    for (int i = 0; i < cfg->num_cgroups && i < AGENT_MAX_CGROUPS; i++) {
+        const char *cg = cfg->cgroups[i];
+        if (strncmp(cg, CGROUP_ROOT, strlen(CGROUP_ROOT)) == 0) cg += strlen(CGROUP_ROOT);
+        while (*cg == '/') cg++;
+        srv->cgroups[i] = cg;
+        srv->cgroup_labels[i][0] = '\0';
+        expo_label(srv->cgroup_labels[i], sizeof(srv->cgroup_labels[i]), "cgroup", *cg ? cg : "/");
+        srv->num_cgroups++;
+    }
+
+    uint64_t refresh = cfg->refresh_ns ? cfg->refresh_ns : NSEC_PER_SEC;
+    struct epoll_event hev = { .events = EPOLLIN, .data.u64 = EV_DATA(EV_HTTP, 0) };
+    struct epoll_event tev = { .events = EPOLLIN, .data.u64 = EV_DATA(EV_EXPO, 0) };
+    srv->expo_timer.fd = -1;
+    if (!http_exporter_open(&srv->http, cfg->http_address)) return false;
+    srv->http_enabled = true;
+    if (!sample_timer_start(&srv->expo_timer, refresh) ||
+        fcntl(srv->expo_timer.fd, F_SETFL, O_NONBLOCK) < 0 ||
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, http_exporter_fd(&srv->http), &hev) < 0 ||
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->expo_timer.fd, &tev) < 0) {
+        perror("Erro ao preparar o endpoint HTTP");
+        return false;
+    }
+
+    char refresh_str[32];
+    format_duration_ns(refresh, refresh_str, sizeof(refresh_str));
+    printf("[agente] Métricas em %s%s%s/metrics (atualizadas a cada %s, %d cgroup(s))\n",
+           srv->http.unix_socket ? "unix:" : "http://", cfg->http_address[0] == ':' ? "127.0.0.1" : "",
+           cfg->http_address, refresh_str, srv->num_cgroups);
+    render_exposition(srv);
+    return true;
+}
+
+// ---------- Laço principal ----------
+
+// Socket de escuta. Um arquivo antigo no caminho só é removido se nenhum
+// agente responde nele.
+static int open_listener(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Erro: Caminho do socket muito longo: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "Erro: Já existe um agente escutando em %s\n", path);
+        close(probe);
+        return -1;
+    }
+    if (probe >= 0) close(probe);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("Erro ao criar o socket do agente");
+        return -1;
+    }
+    mode_t old = umask(0077);       // só o dono conecta
+    int rc = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old);
+    if (rc < 0 || listen(fd, 16) < 0) {
+        fprintf(stderr, "Erro ao escutar em %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool agent_run(const AgentConfig *cfg) {
+    const char *socket_path = cfg->socket_path;
+    AgentServer srv = {
+        .path = socket_path,
+        .retention = cfg->retention ? cfg->retention : AGENT_DEFAULT_RETENTION,
+        .listen_fd = -1,
+        .signal_fd = -1,
+        .epoll_fd = -1,
+        .page_size = sysconf(_SC_PAGESIZE),
+        .ticks_per_second = sysconf(_SC_CLK_TCK),
+    };
+
+    // SIGINT/SIGTERM chegam pelo epoll, como os demais eventos
+    sigset_t mask, old_mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, &old_mask);
+
+    srv.listen_fd = open_listener(socket_path);
+    srv.signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    srv.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event lev = { .events = EPOLLIN, .data.u64 = EV_DATA(EV_LISTEN, 0) };
+    struct epoll_event sev = { .events = EPOLLIN, .data.u64 = EV_DATA(EV_SIGNAL, 0) };
+    bool ok = srv.listen_fd >= 0 && srv.signal_fd >= 0 && srv.epoll_fd >= 0 &&
+              epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.listen_fd, &lev) == 0 &&
+              epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.signal_fd, &sev) == 0;
+    srv.http.listen_fd = srv.http.epoll_fd = -1;
+
+    if (ok) printf("[agente] Escutando em %s (retenção de %zu amostras por processo)\n", socket_path, srv.retention);
+    if (ok && cfg->http_address) ok = expo_open(&srv, cfg);
+    fflush(stdout);
+
+    struct epoll_event events[AGENT_MAX_EVENTS];
+    while (ok && !srv.stop) {
+        int n = epoll_wait(srv.epoll_fd, events, AGENT_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < n && !srv.stop; i++) {
+            uint32_t kind = (uint32_t)(events[i].data.u64 >> 32);
+            int slot = (int)(uint32_t)events[i].data.u64;
+            switch (kind) {
+                case EV_LISTEN:
+                    accept_clients(&srv);
+                    break;
+                case EV_SIGNAL: {
+                    struct signalfd_siginfo info;
+                    if (read(srv.signal_fd, &info, sizeof(info)) == sizeof(info)) srv.stop = true;
+                    break;
+                }
+                case EV_TIMER:
+                    // O alvo pode ter sido removido por um evento anterior do lote
+                    if (!srv.targets[slot] || !srv.targets[slot]->timer_armed) break;
+                    if (sample_timer_wait(&srv.targets[slot]->timer) > 0) target_sample(&srv, slot);
+                    break;
+                case EV_HTTP:
+                    http_exporter_dispatch(&srv.http);
+                    break;
+                case EV_EXPO:
+                    if (sample_timer_wait(&srv.expo_timer) > 0) render_exposition(&srv);
+                    break;
+                case EV_CGROUP:
+                    cgroup_watcher_dispatch(&srv.watcher);
+                    break;
+                case EV_CLIENT: {
+                    AgentConn *c = srv.conns[slot];
+                    if (!c) break;
+                    // Com EPOLLHUP ainda pode haver requisições no buffer:
+                    // conn_read as atende e devolve false no fim do fluxo
+                    bool keep = !(events[i].events & EPOLLERR);
+                    if (keep && (events[i].events & (EPOLLIN | EPOLLHUP))) keep = conn_read(&srv, slot);
+                    if (keep && (events[i].events & EPOLLOUT)) keep = conn_flush(&srv, c);
+                    if (!keep) conn_close(&srv, slot);
+                    break;
+                }
+            }
+        }
+        fflush(stdout);
+    }
+
+    // Encerramento: última tentativa de entregar as respostas pendentes
+    for (int i = 0; i < AGENT_MAX_CLIENTS; i++) {
+        if (!srv.conns[i]) continue;
+        conn_flush(&srv, srv.conns[i]);
+        conn_close(&srv, i);
+    }
+    for (int i = 0; i < AGENT_MAX_TARGETS; i++) {
+        if (srv.targets[i]) target_free(&srv, i);
+    }
+    for (int i = 0; i < AGENT_MAX_CGROUP_WATCHES; i++) {
+        if (srv.cgroup_targets[i]) cgroup_target_free(&srv, i);
+    }
+    if (srv.watcher_open) cgroup_watcher_close(&srv.watcher);
+    if (srv.http_enabled) {
+        sample_timer_close(&srv.expo_timer);
+        http_exporter_close(&srv.http);
+    }
+    if (srv.epoll_fd >= 0) close(srv.epoll_fd);
+    if (srv.signal_fd >= 0) close(srv.signal_fd);
+    if (srv.listen_fd >= 0) {
+        close(srv.listen_fd);
+        unlink(socket_path);
+        printf("[agente] Encerrado\n");
+    }
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    return ok;
+}
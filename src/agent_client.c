@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/agent.h"
+
+bool agent_client_connect(AgentClient *c, const char *socket_path) {
+    memset(c, 0, sizeof(AgentClient));
+    c->fd = -1;
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Erro: Caminho do socket muito longo: %s\n", socket_path);
+        return false;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    c->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (c->fd < 0 || connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "Erro ao conectar ao agente em %s: %s\n", socket_path, strerror(errno));
+        agent_client_close(c);
+        return false;
+    }
+    return true;
+}
+
+void agent_client_close(AgentClient *c) {
+    if (c->fd >= 0) close(c->fd);
+    free(c->buf);
+    c->fd = -1;
+    c->buf = NULL;
+    c->cap = 0;
+}
+
+static bool write_all(int fd, const void *data, size_t len) {
+    const unsigned char *p = data;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *data, size_t len) {
+    unsigned char *p = data;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Próxima mensagem do agente; o payload fica em c->buf
+static bool recv_message(AgentClient *c, AgentHeader *h) {
+    if (!read_all(c->fd, h, sizeof(*h))) return false;
+    if (h->magic != AGENT_MAGIC || h->version != AGENT_VERSION) {
+        fprintf(stderr, "Erro: Resposta inválida do agente (versão do protocolo?)\n");
+        return false;
+    }
+    if (h->length > c->cap) {
+        unsigned char *grown = realloc(c->buf, h->length);
+        if (!grown) return false;
+        c->buf = grown;
+        c->cap = h->length;
+    }
+    return read_all(c->fd, c->buf, h->length);
+}
+
+bool agent_client_call(AgentClient *c, AgentMsgType type, const void *req, uint32_t len,
+                       AgentHeader *resp, const void **payload) {
+    AgentHeader h = {
+        .magic = AGENT_MAGIC,
+        .version = AGENT_VERSION,
+        .type = (uint16_t)type,
+        .seq = ++c->seq,
+        .length = len,
+    };
+    if (!write_all(c->fd, &h, sizeof(h)) || (len > 0 && !write_all(c->fd, req, len))) {
+        fprintf(stderr, "Erro ao enviar requisição ao agente: %s\n", strerror(errno));
+        return false;
+    }
+    do {
+        if (!recv_message(c, resp)) {
+            fprintf(stderr, "Erro: Conexão com o agente encerrada\n");
+            return false;
+        }
+    } while (resp->seq != h.seq);
+    *payload = c->buf;
+    return true;
+}
+
+// Chamada com a resposta esperada; erros do agente vão para o stderr
+static bool call_expect(AgentClient *c, AgentMsgType type, const void *req, uint32_t len,
+                        AgentMsgType expected, size_t min_len, const void **payload, uint32_t *payload_len) {
+    AgentHeader resp;
+    const void *p;
+    if (!agent_client_call(c, type, req, len, &resp, &p)) return false;
+    if (resp.type == AGENT_RESP_ERROR && resp.length >= sizeof(AgentError)) {
+        AgentError e;
+        memcpy(&e, p, sizeof(e));
+        e.message[sizeof(e.message) - 1] = '\0';
+        fprintf(stderr, "Erro do agente: %s (%s)\n", e.message, strerror(e.code));
+        errno = e.code;
+        return false;
+    }
+    if (resp.type != expected || resp.length < min_len) {
+        fprintf(stderr, "Erro: Resposta inesperada do agente (tipo %u)\n", resp.type);
+        return false;
+    }
+    if (payload) *payload = p;
+    if (payload_len) *payload_len = resp.length;
+    return true;
+}
+
+bool agent_client_watch(AgentClient *c, int pid, uint64_t interval_ns) {
+    AgentWatchRequest req = { .pid = pid, .interval_ns = interval_ns };
+    return call_expect(c, AGENT_REQ_WATCH, &req, sizeof(req), AGENT_RESP_OK, 0, NULL, NULL);
+}
+
+bool agent_client_unwatch(AgentClient *c, int pid) {
+    AgentPidRequest req = { .pid = pid };
+    return call_expect(c, AGENT_REQ_UNWATCH, &req, sizeof(req), AGENT_RESP_OK, 0, NULL, NULL);
+}
+
+bool agent_client_list(AgentClient *c, const AgentTargetInfo **targets, uint32_t *count) {
+    const void *p;
+    uint32_t len;
+    if (!call_expect(c, AGENT_REQ_LIST, NULL, 0, AGENT_RESP_TARGETS, 0, &p, &len)) return false;
+    *targets = p;
+    *count = len / sizeof(AgentTargetInfo);
+    return true;
+}
+
+bool agent_client_query(AgentClient *c, int pid, uint64_t window_ns, uint32_t max_samples,
+                        const AgentSample **samples, uint32_t *count) {
+    AgentQueryRequest req = { .pid = pid, .max_samples = max_samples, .window_ns = window_ns };
+    const void *p;
+    uint32_t len;
+    if (!call_expect(c, AGENT_REQ_QUERY, &req, sizeof(req), AGENT_RESP_SAMPLES,
+                     sizeof(AgentSamplesHeader), &p, &len)) {
+        return false;
+    }
+    AgentSamplesHeader hdr;
+    memcpy(&hdr, p, sizeof(hdr));
+    if (len < sizeof(hdr) + (size_t)hdr.count * sizeof(AgentSample)) return false;
+    *samples = (const AgentSample *)((const unsigned char *)p + sizeof(hdr));
+    *count = hdr.count;
+    return true;
+}
+
+bool agent_client_summary(AgentClient *c, int pid, AgentSummary *out) {
+    AgentPidRequest req = { .pid = pid };
+    const void *p;
+    if (!call_expect(c, AGENT_REQ_SUMMARY, &req, sizeof(req), AGENT_RESP_SUMMARY, sizeof(AgentSummary), &p, NULL)) {
+        return false;
+    }
+    memcpy(out, p, sizeof(AgentSummary));
+    return true;
+}
+
+bool agent_client_subscribe(AgentClient *c, int pid) {
+    AgentPidRequest req = { .pid = pid };
+    return call_expect(c, AGENT_REQ_SUBSCRIBE, &req, sizeof(req), AGENT_RESP_OK, 0, NULL, NULL);
+}
+
+bool agent_client_shutdown(AgentClient *c) {
+    return call_expect(c, AGENT_REQ_SHUTDOWN, NULL, 0, AGENT_RESP_OK, 0, NULL, NULL);
+}
+
+// Requisição de cgroup: caminho copiado para o quadro de tamanho fixo
+static bool cgroup_request(AgentCgroupRequest *req, const char *cgroup) {
+    memset(req, 0, sizeof(*req));
+    if (strlen(cgroup) >= sizeof(req->path)) {
+        fprintf(stderr, "Erro: Caminho do cgroup muito longo: %s\n", cgroup);
+        return false;
+    }
+    strcpy(req->path, cgroup);
+    return true;
+}
+
+bool agent_client_watch_cgroup(AgentClient *c, const char *cgroup) {
+    AgentCgroupRequest req;
+    return cgroup_request(&req, cgroup) &&
+           call_expect(c, AGENT_REQ_WATCH_CGROUP, &req, sizeof(req), AGENT_RESP_OK, 0, NULL, NULL);
+}
+
+bool agent_client_unwatch_cgroup(AgentClient *c, const char *cgroup) {
+    AgentCgroupRequest req;
+    return cgroup_request(&req, cgroup) &&
+           call_expect(c, AGENT_REQ_UNWATCH_CGROUP, &req, sizeof(req), AGENT_RESP_OK, 0, NULL, NULL);
+}
+
+bool agent_client_list_cgroups(AgentClient *c, const AgentCgroupInfo **cgroups, uint32_t *count) {
+    const void *p;
+    uint32_t len;
+    if (!call_expect(c, AGENT_REQ_LIST_CGROUPS, NULL, 0, AGENT_RESP_CGROUPS, 0, &p, &len)) return false;
+    *cgroups = p;
+    *count = len / sizeof(AgentCgroupInfo);
+    return true;
+}
+
+bool agent_client_query_cgroup(AgentClient *c, const char *cgroup, const AgentCgroupEvent **events,
+                               uint32_t *count) {
+    AgentCgroupRequest req;
+    const void *p;
+    uint32_t len;
+    if (!cgroup_request(&req, cgroup) ||
+        !call_expect(c, AGENT_REQ_QUERY_CGROUP, &req, sizeof(req), AGENT_RESP_CGROUP_EVENTS, 0, &p, &len)) {
+        return false;
+    }
+    *events = p;
+    *count = len / sizeof(AgentCgroupEvent);
+    return true;
+}
+
+bool agent_client_subscribe_cgroup(AgentClient *c, const char *cgroup) {
+    AgentCgroupRequest req;
+    return cgroup_request(&req, cgroup) &&
+           call_expect(c, AGENT_REQ_SUBSCRIBE_CGROUP, &req, sizeof(req), AGENT_RESP_OK, 0, NULL, NULL);
+}
+
+bool agent_client_next_cgroup_event(AgentClient *c, AgentCgroupEvent *out) {
+    AgentHeader h;
+    while (recv_message(c, &h)) {
+        if (h.type == AGENT_MSG_CGROUP_EVENT && h.length >= sizeof(AgentCgroupEvent)) {
+            memcpy(out, c->buf, sizeof(AgentCgroupEvent));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool agent_client_next_sample(AgentClient *c, AgentSample *out) {
+    AgentHeader h;
+    while (recv_message(c, &h)) {
+        if (h.type == AGENT_MSG_ENDED) return false;
+        if (h.type == AGENT_MSG_SAMPLE && h.length >= sizeof(AgentSample)) {
+            memcpy(out, c->buf, sizeof(AgentSample));
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,244 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include "../include/cgroup_events.h"
+#include "../include/cgroup_stats.h"
+#include "../include/timing.h"
+
+#define EVENTS_BUF   1024
+#define EPOLL_BATCH  64
+#define INOTIFY_TAG  UINT64_MAX     // no epoll, o inotify dos diretórios pais
+
+static const char *const file_names[CG_EVENTS_FILES] = {
+    "cgroup.events", "memory.events", "pids.events"
+};
+
+const char *cgroup_event_file_name(CgroupEventFile file) {
+    return file >= 0 && file < CG_EVENTS_FILES ? file_names[file] : "?";
+}
+
+// O epoll identifica o arquivo por (cgroup, tipo)
+static inline uint64_t source_tag(int cgroup, CgroupEventFile file) {
+    return ((uint64_t)cgroup << 8) | (uint64_t)file;
+}
+
+static int find_key(const CgroupEventSource *src, const char *key) {
+    for (int i = 0; i < src->nkeys; i++) {
+        if (strcmp(src->keys[i], key) == 0) return i;
+    }
+    return -1;
+}
+
+static void emit(CgroupWatcher *w, CgroupEvent *ev) {
+    w->events++;
+    if (w->fn) w->fn(ev, w->ctx);
+}
+
+// Relê o arquivo e compara cada "chave valor" com a leitura anterior.
+// ev == NULL: só grava a base. Retorna false se o cgroup foi removido.
+static bool read_source(CgroupWatcher *w, CgroupEventSource *src, CgroupEvent *ev, int *emitted) {
+    char buf[EVENTS_BUF];
+    ssize_t n = pread(src->fd, buf, sizeof(buf) - 1, 0);
+    if (n < 0) return errno != ENODEV;
+    buf[n] = '\0';
+    w->reads++;
+
+    char *save = NULL;
+    for (char *line = strtok_r(buf, "\n", &save); line; line = strtok_r(NULL, "\n", &save)) {
+        char *sp = strchr(line, ' ');
+        if (!sp || sp - line >= CG_EVENTS_KEY_LEN) continue;
+        *sp = '\0';
+        uint64_t value = strtoull(sp + 1, NULL, 10);
+
+        int k = find_key(src, line);
+        uint64_t old = 0;
+        if (k < 0) {
+            if (src->nkeys == CG_EVENTS_MAX_KEYS) continue;
+            k = src->nkeys++;
+            snprintf(src->keys[k], CG_EVENTS_KEY_LEN, "%s", line);
+        } else {
+            old = src->values[k];
+        }
+        src->values[k] = value;
+        if (!ev || value == old) continue;
+
+        ev->key = src->keys[k];
+        ev->value = value;
+        ev->delta = (int64_t)(value - old);
+        emit(w, ev);
+        (*emitted)++;
+    }
+    return true;
+}
+
+static void close_watch(CgroupWatch *cg) {
+    for (int f = 0; f < CG_EVENTS_FILES; f++) {
+        if (cg->files[f].fd >= 0) close(cg->files[f].fd);
+        cg->files[f].fd = -1;
+    }
+    cg->active = false;
+}
+
+static void emit_removed(CgroupWatcher *w, CgroupWatch *cg, CgroupEvent *ev, int *emitted) {
+    ev->cgroup = (int)(cg - w->cgroups);
+    ev->path = cg->path;
+    ev->file = CG_EVENTS_CGROUP;
+    ev->key = "removed";
+    ev->value = 1;
+    ev->delta = 1;
+    close_watch(cg);
+    emit(w, ev);
+    (*emitted)++;
+}
+
+// IN_DELETE de um diretório: remove os cgroups observados com esse nome
+static void read_inotify(CgroupWatcher *w, CgroupEvent *ev, int *emitted) {
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while ((n = read(w->inotify_fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n;) {
+            const struct inotify_event *ie = (const struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + ie->len;
+            if (!(ie->mask & IN_DELETE) || ie->len == 0) continue;
+            for (int i = 0; i < w->count; i++) {
+                CgroupWatch *cg = &w->cgroups[i];
+                if (cg->active && cg->parent_wd == ie->wd && strcmp(cg->path + cg->name_offset, ie->name) == 0) {
+                    emit_removed(w, cg, ev, emitted);
+                }
+            }
+        }
+    }
+}
+
+bool cgroup_watcher_init(CgroupWatcher *w, CgroupEventFn fn, void *ctx) {
+    memset(w, 0, sizeof(*w));
+    w->fn = fn;
+    w->ctx = ctx;
+    w->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    w->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = INOTIFY_TAG };
+    if (w->epoll_fd < 0 || w->inotify_fd < 0 || epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->inotify_fd, &ev) != 0) {
+        fprintf(stderr, "Erro ao criar epoll/inotify dos eventos de cgroup: %s\n", strerror(errno));
+        if (w->epoll_fd >= 0) close(w->epoll_fd);
+        if (w->inotify_fd >= 0) close(w->inotify_fd);
+        w->epoll_fd = w->inotify_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+int cgroup_watcher_add(CgroupWatcher *w, const char *cgroup_path) {
+    if (w->count == w->capacity) {
+        int capacity = w->capacity ? w->capacity * 2 : 8;
+        CgroupWatch *grown = realloc(w->cgroups, (size_t)capacity * sizeof(CgroupWatch));
+        if (!grown) {
+            fprintf(stderr, "Erro: memória insuficiente para observar o cgroup '%s'\n", cgroup_path);
+            return -1;
+        }
+        w->cgroups = grown;
+        w->capacity = capacity;
+    }
+    int index = w->count;
+    CgroupWatch *cg = &w->cgroups[index];
+    memset(cg, 0, sizeof(*cg));
+    snprintf(cg->path, sizeof(cg->path), "%s", cgroup_path);
+    size_t len = strlen(cg->path);
+    while (len > 0 && cg->path[len - 1] == '/') cg->path[--len] = '\0';
+    const char *slash = strrchr(cg->path, '/');
+    cg->name_offset = slash ? (int)(slash - cg->path) + 1 : 0;
+    cg->parent_wd = -1;
+
+    int opened = 0;
+    for (int f = 0; f < CG_EVENTS_FILES; f++) {
+        CgroupEventSource *src = &cg->files[f];
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s/%s", CGROUP_ROOT, cg->path, file_names[f]);
+        src->fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (src->fd < 0) continue;
+
+        // A leitura da base também zera a notificação pendente do descritor
+        int unused = 0;
+        struct epoll_event ev = { .events = EPOLLPRI, .data.u64 = source_tag(index, f) };
+        if (!read_source(w, src, NULL, &unused) || epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, src->fd, &ev) != 0) {
+            close(src->fd);
+            src->fd = -1;
+            continue;
+        }
+        opened++;
+    }
+    if (opened == 0) {
+        fprintf(stderr, "Erro: cgroup '%s' sem arquivos de eventos (%s/%s não é cgroup v2?)\n",
+                cgroup_path, CGROUP_ROOT, cgroup_path);
+        return -1;
+    }
+    // A raiz não pode ser removida; o watch do pai é compartilhado entre irmãos
+    if (len > 0) {
+        char parent[512];
+        snprintf(parent, sizeof(parent), "%s/%.*s", CGROUP_ROOT, cg->name_offset, cg->path);
+        cg->parent_wd = inotify_add_watch(w->inotify_fd, parent, IN_DELETE | IN_ONLYDIR);
+    }
+    cg->active = true;
+    w->count++;
+    return index;
+}
+
+void cgroup_watcher_remove(CgroupWatcher *w, int cgroup) {
+    if (cgroup >= 0 && cgroup < w->count) close_watch(&w->cgroups[cgroup]);
+}
+
+bool cgroup_watcher_value(const CgroupWatcher *w, int cgroup, CgroupEventFile file, const char *key,
+                          uint64_t *value) {
+    if (cgroup < 0 || cgroup >= w->count || file < 0 || file >= CG_EVENTS_FILES) return false;
+    const CgroupEventSource *src = &w->cgroups[cgroup].files[file];
+    int k = src->fd >= 0 ? find_key(src, key) : -1;
+    if (k < 0) return false;
+    *value = src->values[k];
+    return true;
+}
+
+int cgroup_watcher_wait(CgroupWatcher *w, int timeout_ms) {
+    struct epoll_event ready[EPOLL_BATCH];
+    int n = epoll_wait(w->epoll_fd, ready, EPOLL_BATCH, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+    if (n == 0) return 0;
+    w->wakeups++;
+
+    // Um carimbo por despertar: é o instante mais próximo da notificação
+    CgroupEvent ev = { .mono_ns = monotonic_ns(), .real_ns = realtime_ns() };
+    int emitted = 0;
+    for (int i = 0; i < n; i++) {
+        if (ready[i].data.u64 == INOTIFY_TAG) {
+            read_inotify(w, &ev, &emitted);
+            continue;
+        }
+        int cgroup = (int)(ready[i].data.u64 >> 8);
+        CgroupEventFile file = (CgroupEventFile)(ready[i].data.u64 & 0xff);
+        CgroupWatch *cg = &w->cgroups[cgroup];
+        if (!cg->active) continue;      // removido por um evento anterior do lote
+
+        ev.cgroup = cgroup;
+        ev.path = cg->path;
+        ev.file = file;
+        // ENODEV: removido antes de o IN_DELETE ser lido
+        if (!read_source(w, &cg->files[file], &ev, &emitted)) emit_removed(w, cg, &ev, &emitted);
+    }
+    return emitted;
+}
+
+void cgroup_watcher_close(CgroupWatcher *w) {
+    for (int i = 0; i < w->count; i++) {
+        if (w->cgroups[i].active) close_watch(&w->cgroups[i]);
+    }
+    free(w->cgroups);
+    w->cgroups = NULL;
+    w->count = w->capacity = 0;
+    if (w->epoll_fd >= 0) close(w->epoll_fd);
+    if (w->inotify_fd >= 0) close(w->inotify_fd);
+    w->epoll_fd = w->inotify_fd = -1;
+}
@@ -7,51 +7,13 @@
 #include <errno.h>
 #include <time.h>
 #include <dirent.h>
+#include <signal.h>
+#include "../include/cgroup_stats.h"
+#include "../include/cgroup_events.h"
+#include "../include/psi.h"
+#include "../include/timing.h"
 
-#define CGROUP_ROOT "/sys/fs/cgroup"
 #define MAX_PATH 512
-#define MAX_LINE 1024
-
-// Estrutura para armazenar métricas
-typedef struct {
-    unsigned long cpu_usage_usec;
-    unsigned long cpu_user_usec;
-    unsigned long cpu_system_usec;
-    unsigned long nr_periods;
-    unsigned long nr_throttled;
-    unsigned long throttled_usec;
-} CPUStat;
-
-typedef struct {
-    unsigned long current;
-    unsigned long max;
-    unsigned long peak;
-    unsigned long anon;
-    unsigned long file;
-} MemoryStat;
-
-typedef struct {
-    unsigned long rbytes;
-    unsigned long wbytes;
-    unsigned long rios;
-    unsigned long wios;
-} IOStat;
-
-// Função para ler arquivo cgroup
-int read_cgroup_file(const char *cgroup_path, const char *file, char *buffer, size_t size) {
-    char path[MAX_PATH];
-    snprintf(path, sizeof(path), "%s/%s/%s", CGROUP_ROOT, cgroup_path, file);
-    
-    FILE *f = fopen(path, "r");
-    if (!f) {
-        return -1;
-    }
-    
-    size_t bytes = fread(buffer, 1, size - 1, f);
-    buffer[bytes] = '\0';
-    fclose(f);
-    return 0;
-}
 
 // Função para escrever em arquivo cgroup
 int write_cgroup_file(const char *cgroup_path, const char *file, const char *value) {
@@ -69,96 +31,6 @@ int write_cgroup_file(const char *cgroup_path, const char *file, const char *val
     return 0;
 }
 
-// Ler métricas de CPU
-int read_cpu_metrics(const char *cgroup_name, CPUStat *stat) {
-    char buffer[MAX_LINE * 10];
-    
-    if (read_cgroup_file(cgroup_name, "cpu.stat", buffer, sizeof(buffer)) != 0) {
-        fprintf(stderr, "Erro ao ler cpu.stat do cgroup '%s'\n", cgroup_name);
-        return -1;
-    }
-    
-    memset(stat, 0, sizeof(CPUStat));
-    
-    char *line = strtok(buffer, "\n");
-    while (line) {
-        if (sscanf(line, "usage_usec %lu", &stat->cpu_usage_usec) == 1) {}
-        else if (sscanf(line, "user_usec %lu", &stat->cpu_user_usec) == 1) {}
-        else if (sscanf(line, "system_usec %lu", &stat->cpu_system_usec) == 1) {}
-        else if (sscanf(line, "nr_periods %lu", &stat->nr_periods) == 1) {}
-        else if (sscanf(line, "nr_throttled %lu", &stat->nr_throttled) == 1) {}
-        else if (sscanf(line, "throttled_usec %lu", &stat->throttled_usec) == 1) {}
-        
-        line = strtok(NULL, "\n");
-    }
-    
-    return 0;
-}
-
-// Ler métricas de memória
-int read_memory_metrics(const char *cgroup_name, MemoryStat *stat) {
-    char buffer[MAX_LINE];
-    
-    memset(stat, 0, sizeof(MemoryStat));
-    
-    // Ler memory.current
-    if (read_cgroup_file(cgroup_name, "memory.current", buffer, sizeof(buffer)) == 0) {
-        sscanf(buffer, "%lu", &stat->current);
-    }
-    
-    // Ler memory.max
-    if (read_cgroup_file(cgroup_name, "memory.max", buffer, sizeof(buffer)) == 0) {
-        if (strcmp(buffer, "max\n") == 0) {
-            stat->max = 0; // Sem limite
-        } else {
-            sscanf(buffer, "%lu", &stat->max);
-        }
-    }
-    
-    // Ler memory.peak
-    if (read_cgroup_file(cgroup_name, "memory.peak", buffer, sizeof(buffer)) == 0) {
-        sscanf(buffer, "%lu", &stat->peak);
-    }
-    
-    // Ler memory.stat para anon e file
-    if (read_cgroup_file(cgroup_name, "memory.stat", buffer, sizeof(buffer)) == 0) {
-        char *line = strtok(buffer, "\n");
-        while (line) {
-            if (sscanf(line, "anon %lu", &stat->anon) == 1) {}
-            else if (sscanf(line, "file %lu", &stat->file) == 1) {}
-            line = strtok(NULL, "\n");
-        }
-    }
-    
-    return 0;
-}
-
-// Ler métricas de I/O
-int read_io_metrics(const char *cgroup_name, IOStat *stat) {
-    char buffer[MAX_LINE * 20];
-    
-    memset(stat, 0, sizeof(IOStat));
-    
-    if (read_cgroup_file(cgroup_name, "io.stat", buffer, sizeof(buffer)) != 0) {
-        return -1;
-    }
-    
-    char *line = strtok(buffer, "\n");
-    while (line) {
-        unsigned long rbytes, wbytes, rios, wios;
-        if (sscanf(line, "%*s rbytes=%lu wbytes=%lu rios=%lu wios=%lu", 
-                   &rbytes, &wbytes, &rios, &wios) == 4) {
-            stat->rbytes += rbytes;
-            stat->wbytes += wbytes;
-            stat->rios += rios;
-            stat->wios += wios;
-        }
-        line = strtok(NULL, "\n");
-    }
-    
-    return 0;
-}
-
 // Criar cgroup experimental
 int create_cgroup(const char *cgroup_name) {
     char path[MAX_PATH];
@@ -416,6 +288,167 @@ int list_all_cgroups() {
     return 0;
 }
 
+static volatile sig_atomic_t watch_running = 1;
+
+static void watch_signal(int sig) {
+    (void)sig;
+    watch_running = 0;
+}
+
+// Uma linha por evento: instante relativo ao início, cgroup, arquivo e delta
+static void print_cgroup_event(const CgroupEvent *ev, void *ctx) {
+    uint64_t start = *(const uint64_t *)ctx;
+    printf("[%10.6f s] %-30s %-14s %-16s %10lu (%+ld)\n", (double)(ev->mono_ns - start) / NSEC_PER_SEC,
+           ev->path, cgroup_event_file_name(ev->file), ev->key, (unsigned long)ev->value, (long)ev->delta);
+    fflush(stdout);
+}
+
+// Observar cgroup.events, memory.events e pids.events até Ctrl+C
+int watch_cgroup_events(char **cgroups, int count) {
+    uint64_t start = monotonic_ns();
+    CgroupWatcher w;
+    if (!cgroup_watcher_init(&w, print_cgroup_event, &start)) {
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        int id = cgroup_watcher_add(&w, cgroups[i]);
+        if (id < 0) continue;
+        printf("Observando %s:", cgroups[i]);
+        for (int f = 0; f < CG_EVENTS_FILES; f++) {
+            if (w.cgroups[id].files[f].fd >= 0) printf(" %s", cgroup_event_file_name(f));
+        }
+        printf("\n");
+    }
+    if (w.count == 0) {
+        cgroup_watcher_close(&w);
+        return 1;
+    }
+    printf("Pressione Ctrl+C para encerrar\n\n");
+    fflush(stdout);
+
+    struct sigaction sa = { .sa_handler = watch_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    int active = w.count;
+    while (watch_running && active > 0) {
+        if (cgroup_watcher_wait(&w, -1) < 0) {
+            fprintf(stderr, "Erro ao esperar eventos: %s\n", strerror(errno));
+            break;
+        }
+        active = 0;
+        for (int i = 0; i < w.count; i++) active += w.cgroups[i].active;
+    }
+
+    printf("\n%lu evento(s), %lu despertar(es), %lu leitura(s)\n", (unsigned long)w.events,
+           (unsigned long)w.wakeups, (unsigned long)w.reads);
+    cgroup_watcher_close(&w);
+    return 0;
+}
+
+// Linhas some/full de cada recurso de uma origem (host ou cgroup).
+// Retorna false se a origem não tem arquivos de pressão.
+static bool print_pressure_source(const char *source, const char *cgroup) {
+    bool any = false;
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        PsiStat st;
+        bool ok = cgroup ? psi_read_cgroup(cgroup, (PsiResource)r, &st) : psi_read_host((PsiResource)r, &st);
+        if (!ok) continue;
+        any = true;
+        printf("%-28.28s %-7s %-5s %7.2f %7.2f %7.2f %16llu\n", source, psi_resource_name(r), "some",
+               st.some.avg10, st.some.avg60, st.some.avg300, (unsigned long long)st.some.total_us);
+        if (st.has_full) {
+            printf("%-28s %-7s %-5s %7.2f %7.2f %7.2f %16llu\n", "", "", "full",
+                   st.full.avg10, st.full.avg60, st.full.avg300, (unsigned long long)st.full.total_us);
+        }
+    }
+    return any;
+}
+
+// Pressão (PSI) do host e dos cgroups pedidos; sem argumentos, de todos os
+// sub-cgroups listados por list_all_cgroups
+int show_pressure(char **cgroups, int count) {
+    printf("\n%-28s %-7s %-5s %7s %7s %7s %16s\n", "Origem", "Recurso", "Tipo",
+           "avg10", "avg60", "avg300", "total (us)");
+    printf("----------------------------------------------------------------------------------\n");
+    if (!print_pressure_source("host", NULL)) {
+        fprintf(stderr, "Kernel sem PSI (/proc/pressure ausente; veja o parametro psi=1)\n");
+    }
+    
+    if (count > 0) {
+        for (int i = 0; i < count; i++) {
+            if (!print_pressure_source(cgroups[i], cgroups[i])) {
+                fprintf(stderr, "Cgroup '%s' sem arquivos *.pressure\n", cgroups[i]);
+            }
+        }
+        return 0;
+    }
+    
+    DIR *dir = opendir(CGROUP_ROOT);
+    if (!dir) {
+        fprintf(stderr, "Erro ao abrir %s: %s\n", CGROUP_ROOT, strerror(errno));
+        return 1;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        char path[MAX_PATH];
+        snprintf(path, sizeof(path), "%s/%s", CGROUP_ROOT, entry->d_name);
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+            print_pressure_source(entry->d_name, entry->d_name);
+        }
+    }
+    closedir(dir);
+    return 0;
+}
+
+static void print_stall_event(const PsiEvent *ev, void *ctx) {
+    uint64_t start = *(const uint64_t *)ctx;
+    printf("[%10.6f s] %-30s %-7s %-5s %10.1f ms parado (avg10 %6.2f%%)\n",
+           (double)(ev->mono_ns - start) / NSEC_PER_SEC, ev->source, psi_resource_name(ev->resource),
+           ev->full ? "full" : "some", ev->stall_us / 1000.0, ev->avg10);
+    fflush(stdout);
+}
+
+// Gatilhos PSI de cpu, memória e I/O no host e nos cgroups até Ctrl+C
+int watch_pressure(const char *trigger, char **cgroups, int count) {
+    uint64_t start = monotonic_ns();
+    PsiMonitor m;
+    if (!psi_monitor_init(&m, print_stall_event, &start)) {
+        return 1;
+    }
+    for (int i = -1; i < count; i++) {
+        for (int r = 0; r < PSI_RESOURCES; r++) {
+            psi_monitor_add(&m, i < 0 ? NULL : cgroups[i], (PsiResource)r, trigger);
+        }
+    }
+    if (m.count == 0) {
+        psi_monitor_close(&m);
+        return 1;
+    }
+    const PsiTrigger *t = &m.triggers[0];
+    printf("%d gatilho(s): %s %.0f ms em %.0f ms\n", m.count, t->full ? "full" : "some",
+           t->threshold_us / 1000.0, t->window_us / 1000.0);
+    printf("Pressione Ctrl+C para encerrar\n\n");
+    fflush(stdout);
+    
+    struct sigaction sa = { .sa_handler = watch_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    
+    while (watch_running) {
+        if (psi_monitor_wait(&m, -1) < 0) {
+            fprintf(stderr, "Erro ao esperar eventos PSI: %s\n", strerror(errno));
+            break;
+        }
+    }
+    
+    printf("\n%lu evento(s), %lu despertar(es)\n", (unsigned long)m.events, (unsigned long)m.wakeups);
+    psi_monitor_close(&m);
+    return 0;
+}
+
 void print_usage(const char *prog_name) {
     printf("Uso: %s <comando> [opcoes]\n\n", prog_name);
     printf("Comandos:\n");
@@ -426,6 +459,10 @@ void print_usage(const char *prog_name) {
     printf("  set-cpu-limit <cgroup_name> <quota> <period>  - Aplicar limite de CPU (em microsegundos)\n");
     printf("  set-mem-limit <cgroup_name> <bytes>           - Aplicar limite de memoria\n");
     printf("  report <cgroup_name> [output.json]            - Gerar relatorio de utilizacao\n");
+    printf("  watch-events <cgroup_name>...                 - Observar eventos (oom, max, populated...)\n");
+    printf("  pressure [cgroup_name...]                     - Pressao PSI (cpu, memory, io) do host e cgroups\n");
+    printf("  watch-pressure [gatilho] [cgroup_name...]     - Eventos de gatilhos PSI (padrao: \"%s\")\n",
+           PSI_DEFAULT_TRIGGER);
     printf("\n");
     printf("Exemplos:\n");
     printf("  %s list\n", prog_name);
@@ -434,6 +471,8 @@ void print_usage(const char *prog_name) {
     printf("  %s set-mem-limit my_cgroup 104857600     # 100 MB\n", prog_name);
     printf("  %s move-process my_cgroup 1234\n", prog_name);
     printf("  %s report my_cgroup output/report.json\n", prog_name);
+    printf("  %s watch-events my_cgroup system.slice\n", prog_name);
+    printf("  %s watch-pressure \"some 100000 1000000\" my_cgroup\n", prog_name);
     printf("\n");
 }
 
@@ -496,6 +535,26 @@ int main(int argc, char *argv[]) {
         const char *output = (argc >= 4) ? argv[3] : NULL;
         return generate_report(argv[2], output);
         
+    } else if (strcmp(command, "watch-events") == 0) {
+        if (argc < 3) {
+            fprintf(stderr, "Uso: %s watch-events <cgroup_name>...\n", argv[0]);
+            return 1;
+        }
+        return watch_cgroup_events(argv + 2, argc - 2);
+        
+    } else if (strcmp(command, "pressure") == 0) {
+        return show_pressure(argv + 2, argc - 2);
+        
+    } else if (strcmp(command, "watch-pressure") == 0) {
+        // O primeiro argumento é o gatilho se começar por some/full
+        const char *trigger = PSI_DEFAULT_TRIGGER;
+        int first = 2;
+        if (argc > 2 && (strncmp(argv[2], "some ", 5) == 0 || strncmp(argv[2], "full ", 5) == 0)) {
+            trigger = argv[2];
+            first = 3;
+        }
+        return watch_pressure(trigger, argv + first, argc - first);
+        
     } else {
         fprintf(stderr, "Comando desconhecido: %s\n", command);
         print_usage(argv[0]);
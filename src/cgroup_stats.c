@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/cgroup_stats.h"
+
+#define MAX_PATH 512
+
+// Função para ler arquivo cgroup
+int read_cgroup_file(const char *cgroup_path, const char *file, char *buffer, size_t size) {
+    char path[MAX_PATH];
+    snprintf(path, sizeof(path), "%s/%s/%s", CGROUP_ROOT, cgroup_path, file);
+    
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    
+    size_t bytes = fread(buffer, 1, size - 1, f);
+    buffer[bytes] = '\0';
+    fclose(f);
+    return 0;
+}
+
+// Ler métricas de CPU
+int read_cpu_metrics(const char *cgroup_name, CPUStat *stat) {
+    char buffer[MAX_LINE * 10];
+    
+    if (read_cgroup_file(cgroup_name, "cpu.stat", buffer, sizeof(buffer)) != 0) {
+        fprintf(stderr, "Erro ao ler cpu.stat do cgroup '%s'\n", cgroup_name);
+        return -1;
+    }
+    
+    memset(stat, 0, sizeof(CPUStat));
+    
+    char *line = strtok(buffer, "\n");
+    while (line) {
+        if (sscanf(line, "usage_usec %lu", &stat->cpu_usage_usec) == 1) {}
+        else if (sscanf(line, "user_usec %lu", &stat->cpu_user_usec) == 1) {}
+        else if (sscanf(line, "system_usec %lu", &stat->cpu_system_usec) == 1) {}
+        else if (sscanf(line, "nr_periods %lu", &stat->nr_periods) == 1) {}
+        else if (sscanf(line, "nr_throttled %lu", &stat->nr_throttled) == 1) {}
+        else if (sscanf(line, "throttled_usec %lu", &stat->throttled_usec) == 1) {}
+        
+        line = strtok(NULL, "\n");
+    }
+    
+    return 0;
+}
+
+// Ler métricas de memória
+int read_memory_metrics(const char *cgroup_name, MemoryStat *stat) {
+    char buffer[MAX_LINE];
+    
+    memset(stat, 0, sizeof(MemoryStat));
+    
+    // Ler memory.current
+    if (read_cgroup_file(cgroup_name, "memory.current", buffer, sizeof(buffer)) == 0) {
+        sscanf(buffer, "%lu", &stat->current);
+    }
+    
+    // Ler memory.max
+    if (read_cgroup_file(cgroup_name, "memory.max", buffer, sizeof(buffer)) == 0) {
+        if (strcmp(buffer, "max\n") == 0) {
+            stat->max = 0; // Sem limite
+        } else {
+            sscanf(buffer, "%lu", &stat->max);
+        }
+    }
+    
+    // Ler memory.peak
+    if (read_cgroup_file(cgroup_name, "memory.peak", buffer, sizeof(buffer)) == 0) {
+        sscanf(buffer, "%lu", &stat->peak);
+    }
+    
+    // Ler memory.stat para anon e file
+    if (read_cgroup_file(cgroup_name, "memory.stat", buffer, sizeof(buffer)) == 0) {
+        char *line = strtok(buffer, "\n");
+        while (line) {
+            if (sscanf(line, "anon %lu", &stat->anon) == 1) {}
+            else if (sscanf(line, "file %lu", &stat->file) == 1) {}
+            line = strtok(NULL, "\n");
+        }
+    }
+    
+    return 0;
+}
+
+// Ler métricas de I/O
+int read_io_metrics(const char *cgroup_name, IOStat *stat) {
+    char buffer[MAX_LINE * 20];
+    
+    memset(stat, 0, sizeof(IOStat));
+    
+    if (read_cgroup_file(cgroup_name, "io.stat", buffer, sizeof(buffer)) != 0) {
+        return -1;
+    }
+    
+    char *line = strtok(buffer, "\n");
+    while (line) {
+        unsigned long rbytes, wbytes, rios, wios;
+        if (sscanf(line, "%*s rbytes=%lu wbytes=%lu rios=%lu wios=%lu", 
+                   &rbytes, &wbytes, &rios, &wios) == 4) {
+            stat->rbytes += rbytes;
+            stat->wbytes += wbytes;
+            stat->rios += rios;
+            stat->wios += wios;
+        }
+        line = strtok(NULL, "\n");
+    }
+    
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <errno.h>
 #include <time.h>
 #include "../include/cgroup.h"
+#include "../include/serializer.h"
 
 #define CGROUP_V2_ROOT "/sys/fs/cgroup"
 
@@ -200,37 +201,53 @@ int add_process_to_cgroup(int pid, const char *controller, const char *group_nam
     return 0;
 }
 
+// Copia os pares "chave valor" de um arquivo de estatísticas como objeto JSON
+static void write_stat_object(OutBuf *o, const char *name, FILE *in, bool last) {
+    out_lit(o, "  ");
+    out_json_str(o, name);
+    out_lit(o, ": {\n");
+    char line[256];
+    int first = 1;
+    while (fgets(line, sizeof(line), in)) {
+        char key[64];
+        unsigned long long value;
+        if (sscanf(line, "%63s %llu", key, &value) == 2) {
+            if (!first) out_lit(o, ",\n");
+            out_lit(o, "    ");
+            out_json_str(o, key);
+            out_lit(o, ": ");
+            out_u64(o, value);
+            first = 0;
+        }
+    }
+    if (last) {
+        out_lit(o, "\n  }\n");
+    } else {
+        out_lit(o, "\n  },\n");
+    }
+}
+
 void export_cgroup_info_to_json(const char *controller, const char *group_name, const char *filename) {
     (void)controller; // Unused in v2
     
-    FILE *fp = fopen(filename, "w");
-    if (!fp) {
+    OutBuf o;
+    if (!out_open(&o, filename)) {
         fprintf(stderr, "Erro ao criar arquivo %s: %s\n", filename, strerror(errno));
         return;
     }
     
-    fprintf(fp, "{\n");
-    fprintf(fp, "  \"cgroup\": \"%s\",\n", group_name);
-    fprintf(fp, "  \"timestamp\": %ld,\n", time(NULL));
+    out_lit(&o, "{\n  \"cgroup\": ");
+    out_json_str(&o, group_name);
+    out_lit(&o, ",\n  \"timestamp\": ");
+    out_i64(&o, time(NULL));
+    out_lit(&o, ",\n");
     
     // CPU stats
     char path[512];
     snprintf(path, sizeof(path), "%s/%s/cpu.stat", CGROUP_V2_ROOT, group_name);
     FILE *cpu = fopen(path, "r");
     if (cpu) {
-        fprintf(fp, "  \"cpu\": {\n");
-        char line[256];
-        int first = 1;
-        while (fgets(line, sizeof(line), cpu)) {
-            char key[64];
-            unsigned long long value;
-            if (sscanf(line, "%s %llu", key, &value) == 2) {
-                if (!first) fprintf(fp, ",\n");
-                fprintf(fp, "    \"%s\": %llu", key, value);
-                first = 0;
-            }
-        }
-        fprintf(fp, "\n  },\n");
+        write_stat_object(&o, "cpu", cpu, false);
         fclose(cpu);
     }
     
@@ -238,22 +255,12 @@ void export_cgroup_info_to_json(const char *controller, const char *group_name,
     snprintf(path, sizeof(path), "%s/%s/memory.stat", CGROUP_V2_ROOT, group_name);
     FILE *mem = fopen(path, "r");
     if (mem) {
-        fprintf(fp, "  \"memory\": {\n");
-        char line[256];
-        int first = 1;
-        while (fgets(line, sizeof(line), mem)) {
-            char key[64];
-            unsigned long long value;
-            if (sscanf(line, "%s %llu", key, &value) == 2) {
-                if (!first) fprintf(fp, ",\n");
-                fprintf(fp, "    \"%s\": %llu", key, value);
-                first = 0;
-            }
-        }
-        fprintf(fp, "\n  }\n");
+        write_stat_object(&o, "memory", mem, true);
         fclose(mem);
     }
     
-    fprintf(fp, "}\n");
-    fclose(fp);
+    out_lit(&o, "}\n");
+    if (!out_close(&o)) {
+        fprintf(stderr, "Erro ao gravar arquivo %s\n", filename);
+    }
 }
@@ -1,4 +1,6 @@
 #include "../include/monitor.h"
+#include "../include/proc_parse.h"
+#include "../include/timing.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,66 +8,60 @@
 #include <time.h>
 
 // Lê métricas do /proc/[pid]/stat
-static bool read_stat_metrics(int pid, ResourceData *data) {
-    char filepath[256];
-    snprintf(filepath, sizeof(filepath), "/proc/%d/stat", pid);
-
-    FILE *fp = fopen(filepath, "r");
-    if (fp == NULL) {
+static bool read_stat_metrics(ProcHandle *h, ResourceData *data) {
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_STAT, &len);
+    ProcStat st;
+    if (buf == NULL || !proc_parse_stat(buf, len, &st)) {
         return false;
     }
 
-    // Campos de interesse:
-    // 10: minflt  (page_faults_minor)
-    // 12: majflt  (page_faults_major)
-    // 14: utime   (cpu_user)
-    // 15: stime   (cpu_system)
-    // 20: num_threads
-    fscanf(fp, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %lu %*u %lu %*u %lu %lu %*d %*d %*d %*d %ld",
-           &data->page_faults_minor,
-           &data->page_faults_major,
-           &data->cpu_user,
-           &data->cpu_system,
-           &data->num_threads);
-    
-    fclose(fp);
+    data->page_faults_minor = st.minflt;
+    data->page_faults_major = st.majflt;
+    data->cpu_user = st.utime;
+    data->cpu_system = st.stime;
+    data->num_threads = st.num_threads;
+
     return true;
 }
 
 // Lê métricas do /proc/[pid]/status
-static bool read_status_metrics(int pid, ResourceData *data) {
-    char filepath[256];
-    snprintf(filepath, sizeof(filepath), "/proc/%d/status", pid);
-
-    FILE *fp = fopen(filepath, "r");
-    if (fp == NULL) {
+static bool read_status_metrics(ProcHandle *h, ResourceData *data) {
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_STATUS, &len);
+    ProcStatus st;
+    if (buf == NULL || !proc_parse_status(buf, len, &st)) {
         return false;
     }
 
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        if (strncmp(line, "voluntary_ctxt_switches:", 24) == 0) {
-            sscanf(line + 25, "%ld", &data->voluntary_context_switches);
-        } else if (strncmp(line, "nonvoluntary_ctxt_switches:", 27) == 0) {
-            sscanf(line + 28, "%ld", &data->nonvoluntary_context_switches);
-        }
-    }
+    data->voluntary_context_switches = st.voluntary_ctxt_switches;
+    data->nonvoluntary_context_switches = st.nonvoluntary_ctxt_switches;
 
-    fclose(fp);
     return true;
 }
 
-bool get_cpu_data(int pid, ResourceData *data) {
-    data->pid = pid;
-    data->timestamp = time(NULL);
+bool get_cpu_data_handle(ProcHandle *h, ResourceData *data) {
+    data->pid = h->pid;
+    TIMING_STAMP(data);
 
-    if (!read_stat_metrics(pid, data)) {
+    if (!read_stat_metrics(h, data)) {
         return false;
     }
-    if (!read_status_metrics(pid, data)) {
+    if (!read_status_metrics(h, data)) {
         // This might fail if the process dies between reads, but we can live with it
         // We'll still have the data from /stat
     }
 
     return true;
 }
+
+bool get_cpu_data(int pid, ResourceData *data) {
+    ProcHandle h = {0};
+    if (!proc_handle_open(&h, pid)) {
+        proc_handle_close(&h);
+        return false;
+    }
+    bool ok = get_cpu_data_handle(&h, data);
+    proc_handle_close(&h);
+    return ok;
+}
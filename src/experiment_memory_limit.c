@@ -7,7 +7,10 @@
 #include <sys/stat.h>
 #include <signal.h>
 #include <errno.h>
+#include <limits.h>
 #include "../include/utils.h"
+#include "../include/cgroup_events.h"
+#include "../include/timing.h"
 
 #define MEMORY_LIMIT_MB 100
 #define ALLOCATION_STEP_MB 10
@@ -33,7 +36,7 @@ typedef struct {
 
 // Ler contador de falhas de memória
 static long read_memory_failcnt(const char *cgroup_path) {
-    char path[512];
+    char path[PATH_MAX];
     snprintf(path, sizeof(path), "%s/memory.events", cgroup_path);
     
     FILE *f = fopen(path, "r");
@@ -60,9 +63,31 @@ static long read_memory_failcnt(const char *cgroup_path) {
     return oom_count + max_count;
 }
 
+// Eventos de memory.events entregues pelo observador durante as alocações
+typedef struct {
+    uint64_t step_start_ns;
+    long oom, oom_kill, max, high;
+    double first_oom_kill_ms;   // desde o início do passo (-1 = nenhum)
+} MemoryEventLog;
+
+static void on_memory_event(const CgroupEvent *ev, void *ctx) {
+    MemoryEventLog *log = ctx;
+    if (ev->file != CG_EVENTS_MEMORY || ev->delta <= 0) return;
+    if (strcmp(ev->key, "oom") == 0) {
+        log->oom += ev->delta;
+    } else if (strcmp(ev->key, "oom_kill") == 0) {
+        if (log->oom_kill == 0) log->first_oom_kill_ms = (double)(ev->mono_ns - log->step_start_ns) / NSEC_PER_MSEC;
+        log->oom_kill += ev->delta;
+    } else if (strcmp(ev->key, "max") == 0) {
+        log->max += ev->delta;
+    } else if (strcmp(ev->key, "high") == 0) {
+        log->high += ev->delta;
+    }
+}
+
 // Ler uso atual de memória
 static long read_memory_current(const char *cgroup_path) {
-    char path[512];
+    char path[PATH_MAX];
     snprintf(path, sizeof(path), "%s/memory.current", cgroup_path);
     
     FILE *f = fopen(path, "r");
@@ -79,7 +104,7 @@ static long read_memory_current(const char *cgroup_path) {
 
 // Ler pico de memória
 static long read_memory_peak(const char *cgroup_path) {
-    char path[512];
+    char path[PATH_MAX];
     snprintf(path, sizeof(path), "%s/memory.peak", cgroup_path);
     
     FILE *f = fopen(path, "r");
@@ -167,6 +192,14 @@ void run_experiment_memory_limit_new() {
     printf("FASE 2: Alocação incremental de memória\n");
     printf("═══════════════════════════════════════════════════════════════════════\n\n");
     
+    // Eventos do cgroup entregues pelo kernel: transições entre as leituras
+    // de memory.events não se perdem
+    MemoryEventLog events = { .first_oom_kill_ms = -1 };
+    CgroupWatcher watcher;
+    bool watching = cgroup_watcher_init(&watcher, on_memory_event, &events) &&
+                    cgroup_watcher_add(&watcher, cgroup_name) >= 0 &&
+                    watcher.cgroups[0].files[CG_EVENTS_MEMORY].fd >= 0;
+    
     AllocationStep steps[MAX_ALLOCATIONS];
     int num_steps = 0;
     int oom_killed = 0;
@@ -179,6 +212,7 @@ void run_experiment_memory_limit_new() {
     
     for (int i = 0; i < MAX_ALLOCATIONS; i++) {
         long target_mb = (i + 1) * ALLOCATION_STEP_MB;
+        events.step_start_ns = monotonic_ns();
         
         // Fork para tentar alocação em processo separado
         pid_t pid = fork();
@@ -217,8 +251,17 @@ void run_experiment_memory_limit_new() {
             // Nunca chega aqui, mas garante que não continua loop
             _exit(1);
         } else if (pid > 0) {
-            // Processo pai - monitorar
-            sleep(2); // Esperar alocação e leitura de memória
+            // Processo pai - monitorar: esperar alocação e leitura de memória
+            // recebendo os eventos do cgroup enquanto isso
+            if (watching) {
+                uint64_t deadline = events.step_start_ns + 2 * NSEC_PER_SEC;
+                uint64_t now;
+                while ((now = monotonic_ns()) < deadline) {
+                    cgroup_watcher_wait(&watcher, (int)((deadline - now) / NSEC_PER_MSEC) + 1);
+                }
+            } else {
+                sleep(2);
+            }
             
             int status;
             pid_t result = waitpid(pid, &status, WNOHANG);
@@ -288,11 +331,24 @@ void run_experiment_memory_limit_new() {
     printf("FASE 3: Análise de eventos de memória\n");
     printf("═══════════════════════════════════════════════════════════════════════\n\n");
     
-    long failcnt = read_memory_failcnt(cgroup_path);
+    long failcnt;
+    if (watching) {
+        cgroup_watcher_dispatch(&watcher);
+        failcnt = events.oom + events.max;
+    } else {
+        failcnt = read_memory_failcnt(cgroup_path);
+    }
     long final_peak = read_memory_peak(cgroup_path);
     
     printf("Eventos de pressão de memória:\n");
     printf("  • Eventos OOM/MAX: %ld\n", failcnt);
+    if (watching) {
+        printf("  • Entregues pelo kernel: max %ld, high %ld, oom %ld, oom_kill %ld\n",
+               events.max, events.high, events.oom, events.oom_kill);
+        if (events.first_oom_kill_ms >= 0) {
+            printf("  • Primeiro oom_kill: %.3f ms após o início do passo\n", events.first_oom_kill_ms);
+        }
+    }
     printf("  • Pico de memória: %ld MB\n", final_peak / (1024 * 1024));
     printf("  • Quantidade máxima alocada: %ld MB\n", max_allocated);
     printf("  • OOM Killer ativado: %s\n", oom_killed ? "SIM" : "NÃO");
@@ -393,6 +449,7 @@ void run_experiment_memory_limit_new() {
     }
     
     // Limpar
+    cgroup_watcher_close(&watcher);
     rmdir(cgroup_path);
     
     printf("\n");
@@ -8,6 +8,8 @@
 #include <sys/resource.h>
 #include <signal.h>
 #include "../include/utils.h"
+#include "../include/resource_collector.h"
+#include "../include/timing.h"
 
 #define WORKLOAD_ITERATIONS 50000000
 #define NUM_INTERVALS 4
@@ -21,6 +23,18 @@ typedef struct {
     long memory_peak_kb;
 } BenchmarkResult;
 
+// Fase 3: custo do coletor completo em cada backend
+typedef struct {
+    CollectBackend backend;
+    int interval_ms;
+    int samples;
+    double execution_time_sec;
+    double monitor_cpu_us;          // CPU do monitor por amostra
+    bool have_final;                // estatísticas finais do workload (taskstats)
+    double workload_cpu_delay_ms;   // espera do workload na fila de execução
+    unsigned long long workload_ctx_switches;
+} BackendResult;
+
 static volatile int keep_monitoring = 1;
 
 void signal_handler(int sig) {
@@ -28,6 +42,9 @@ void signal_handler(int sig) {
     keep_monitoring = 0;
 }
 
+// Destino do resultado: impede o compilador de eliminar o workload
+static volatile double workload_sink;
+
 // Função de workload intensivo de CPU
 static double cpu_workload(int iterations) {
     double result = 0.0;
@@ -37,6 +54,7 @@ static double cpu_workload(int iterations) {
             result = result / 2.0; // Evitar overflow
         }
     }
+    workload_sink = result;
     return result;
 }
 
@@ -145,6 +163,132 @@ static BenchmarkResult run_monitored_workload(int sampling_interval_ms) {
     return result;
 }
 
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// Executa o workload monitorado pelo ResourceCollector no backend pedido,
+// medindo a CPU gasta pelo monitor em cada amostra. exits (se aberto)
+// recebe a notificação de término com as estatísticas finais do workload.
+static BackendResult run_backend_workload(CollectBackend backend, int sampling_interval_ms,
+                                          TaskstatsClient *exits) {
+    BackendResult result = { .backend = backend, .interval_ms = sampling_interval_ms };
+    
+    pid_t workload_pid = fork();
+    if (workload_pid == 0) {
+        cpu_workload(WORKLOAD_ITERATIONS);
+        exit(0);
+    } else if (workload_pid < 0) {
+        return result;
+    }
+    
+    uint64_t start = monotonic_ns();
+    int status;
+    bool reaped = false;
+    
+    ResourceCollector collector;
+    uint64_t monitor_ns = 0;
+    if (resource_collector_open(&collector, workload_pid, backend)) {
+        // Zumbis continuam legíveis: o fim é detectado pelo waitpid
+        while (!(reaped = (waitpid(workload_pid, &status, WNOHANG) == workload_pid))) {
+            ResourceData data;
+            uint64_t t0 = thread_cpu_ns();
+            bool ok = resource_collector_sample(&collector, &data);
+            monitor_ns += thread_cpu_ns() - t0;
+            if (!ok) break;
+            result.samples++;
+            usleep(sampling_interval_ms * 1000);
+        }
+        resource_collector_close(&collector);
+    }
+    
+    if (!reaped) waitpid(workload_pid, &status, 0);
+    result.execution_time_sec = (double)(monotonic_ns() - start) / NSEC_PER_SEC;
+    if (result.samples > 0) {
+        result.monitor_cpu_us = monitor_ns / 1e3 / result.samples;
+    }
+    
+    // O workload tem uma thread: a notificação traz o PID
+    TaskStats final;
+    while (exits && taskstats_read_exit(exits, &final) == 1) {
+        if (final.pid != workload_pid) continue;
+        result.have_final = true;
+        result.workload_cpu_delay_ms = final.cpu_delay_ns / 1e6;
+        result.workload_ctx_switches = final.voluntary_ctx_switches + final.nonvoluntary_ctx_switches;
+    }
+    return result;
+}
+
+// Fase 3: /proc x taskstats em cada intervalo de sampling
+static void run_backend_comparison(const int *intervals) {
+    printf("═══════════════════════════════════════════════════════════════════════\n");
+    printf("FASE 3: Backends de coleta (/proc x netlink TASKSTATS)\n");
+    printf("═══════════════════════════════════════════════════════════════════════\n\n");
+    
+    // Um cliente de término para as duas execuções: o delay de CPU do
+    // workload é medido igualmente nos dois backends
+    TaskstatsClient exits;
+    bool taskstats_ok = taskstats_open(&exits);
+    if (taskstats_ok && !taskstats_subscribe_exits(&exits)) {
+        taskstats_close(&exits);
+        taskstats_ok = false;
+    }
+    if (!taskstats_ok) {
+        printf("Interface TASKSTATS indisponível (requer root): apenas /proc será medido.\n\n");
+    }
+    
+    BackendResult results[2 * NUM_INTERVALS];
+    int count = 0;
+    for (int b = 0; b < 2; b++) {
+        CollectBackend backend = (b == 0) ? COLLECT_BACKEND_PROC : COLLECT_BACKEND_TASKSTATS;
+        if (backend == COLLECT_BACKEND_TASKSTATS && !taskstats_ok) break;
+        for (int i = 0; i < NUM_INTERVALS; i++) {
+            printf("Backend %s, intervalo %d ms... ", collect_backend_name(backend), intervals[i]);
+            fflush(stdout);
+            results[count] = run_backend_workload(backend, intervals[i], taskstats_ok ? &exits : NULL);
+            printf("✓ %d amostras\n", results[count].samples);
+            count++;
+        }
+    }
+    if (taskstats_ok) taskstats_close(&exits);
+    
+    printf("\n%-10s | %13s | %8s | %12s | %18s | %16s\n",
+           "Backend", "Sampling (ms)", "Amostras", "Exec Time(s)", "Monitor us/amostra", "Delay CPU wl(ms)");
+    printf("-----------|---------------|----------|--------------|--------------------|-----------------\n");
+    for (int i = 0; i < count; i++) {
+        char delay[32] = "-";
+        if (results[i].have_final) {
+            snprintf(delay, sizeof(delay), "%.3f", results[i].workload_cpu_delay_ms);
+        }
+        printf("%-10s | %13d | %8d | %12.3f | %18.2f | %16s\n",
+               collect_backend_name(results[i].backend), results[i].interval_ms, results[i].samples,
+               results[i].execution_time_sec, results[i].monitor_cpu_us, delay);
+    }
+    printf("\n");
+    
+    FILE *output = fopen("output/experiment1_backends.csv", "w");
+    if (output) {
+        fprintf(output, "backend,sampling_interval_ms,samples,execution_time_sec,");
+        fprintf(output, "monitor_cpu_us_per_sample,workload_cpu_delay_ms,workload_context_switches\n");
+        for (int i = 0; i < count; i++) {
+            fprintf(output, "%s,%d,%d,%.3f,%.2f,",
+                    collect_backend_name(results[i].backend), results[i].interval_ms,
+                    results[i].samples, results[i].execution_time_sec, results[i].monitor_cpu_us);
+            if (results[i].have_final) {
+                fprintf(output, "%.3f,%llu\n", results[i].workload_cpu_delay_ms, results[i].workload_ctx_switches);
+            } else {
+                fprintf(output, ",\n");
+            }
+        }
+        fclose(output);
+        printf("✓ Comparação de backends salva em: output/experiment1_backends.csv\n\n");
+    } else {
+        printf("✗ Erro ao criar output/experiment1_backends.csv\n\n");
+    }
+}
+
 void run_experiment_overhead() {
     printf("\n╔═══════════════════════════════════════════════════════════════════════╗\n");
     printf("║           Experimento 1: Overhead de Monitoramento                    ║\n");
@@ -154,7 +298,8 @@ void run_experiment_overhead() {
     printf("Configuração:\n");
     printf("  • Workload: Cálculo intensivo de CPU (%d iterações)\n", WORKLOAD_ITERATIONS);
     printf("  • Intervalos de sampling: 1ms, 10ms, 100ms, 1000ms\n");
-    printf("  • Métricas: Tempo de execução, CPU overhead, context switches\n\n");
+    printf("  • Métricas: Tempo de execução, CPU overhead, context switches\n");
+    printf("  • Backends de coleta: /proc e netlink TASKSTATS (fase 3)\n\n");
     
     // Array de intervalos de sampling (em ms)
     int intervals[NUM_INTERVALS] = {1, 10, 100, 1000};
@@ -191,6 +336,8 @@ void run_experiment_overhead() {
         printf("  Context switches: %ld\n\n", results[i + 1].context_switches);
     }
     
+    run_backend_comparison(intervals);
+    
     printf("═══════════════════════════════════════════════════════════════════════\n");
     printf("RESULTADOS: Análise de Overhead\n");
     printf("═══════════════════════════════════════════════════════════════════════\n\n");
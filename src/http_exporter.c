@@ -0,0 +1,490 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <netinet/in.h>
+#include "../include/http_exporter.h"
+#include "../include/timing.h"
+
+#define HTTP_RENDER_BUF (64 * 1024)
+#define HTTP_MAX_EVENTS 64
+#define HTTP_LISTEN_TAG UINT64_MAX
+
+// Corpo publicado: só lido depois do commit (o memfd é selado)
+struct Exposition {
+    int fd;
+    size_t len;
+    int refs;                   // exportador + respostas em andamento
+};
+
+// Conexão: lê uma requisição inteira, depois envia a resposta (cabeçalho
+// do buffer, corpo do memfd) antes de ler a próxima
+struct HttpConn {
+    int fd;
+    int slot;
+    char req[HTTP_MAX_REQUEST];
+    size_t req_len;
+    size_t req_used;            // bytes da requisição em atendimento
+    char head[512];
+    size_t head_len;
+    size_t head_off;
+    Exposition *body;           // NULL: a resposta cabe em head
+    off_t body_off;
+    size_t body_len;
+    bool writing;
+    bool close_after;
+};
+
+static void expo_release(Exposition *e) {
+    if (e && --e->refs == 0) {
+        close(e->fd);
+        free(e);
+    }
+}
+
+// ---------- Escuta ----------
+
+static int listen_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Erro: Caminho do socket muito longo: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    // Arquivo antigo só é removido se ninguém responde nele
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "Erro: Endereço HTTP em uso: %s\n", path);
+        close(probe);
+        return -1;
+    }
+    if (probe >= 0) close(probe);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 64) < 0) {
+        fprintf(stderr, "Erro ao escutar em %s: %s\n", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int listen_tcp(const char *address) {
+    const char *colon = strrchr(address, ':');
+    if (!colon || colon[1] == '\0') {
+        fprintf(stderr, "Erro: Endereço HTTP inválido: %s (use host:porta, :porta ou /caminho)\n", address);
+        return -1;
+    }
+    char host[64] = "127.0.0.1";
+    size_t host_len = (size_t)(colon - address);
+    if (host_len >= sizeof(host)) {
+        fprintf(stderr, "Erro: Endereço HTTP inválido: %s\n", address);
+        return -1;
+    }
+    if (host_len > 0) {
+        memcpy(host, address, host_len);
+        host[host_len] = '\0';
+    }
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM, .ai_flags = AI_NUMERICSERV };
+    struct addrinfo *res;
+    int rc = getaddrinfo(host, colon + 1, &hints, &res);
+    if (rc != 0) {
+        fprintf(stderr, "Erro: Endereço HTTP inválido: %s (%s)\n", address, gai_strerror(rc));
+        return -1;
+    }
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, ai->ai_addr, ai->ai_addrlen) < 0 || listen(fd, 64) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd < 0) fprintf(stderr, "Erro ao escutar em %s: %s\n", address, strerror(errno));
+    freeaddrinfo(res);
+    return fd;
+}
+
+bool http_exporter_open(HttpExporter *h, const char *address) {
+    memset(h, 0, sizeof(HttpExporter));
+    h->listen_fd = h->epoll_fd = -1;
+    snprintf(h->address, sizeof(h->address), "%s", address);
+    h->unix_socket = address[0] == '/';
+
+    h->listen_fd = h->unix_socket ? listen_unix(address) : listen_tcp(address);
+    if (h->listen_fd < 0) return false;
+    h->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = { .events = EPOLLIN, .data.u64 = HTTP_LISTEN_TAG };
+    if (h->epoll_fd < 0 || epoll_ctl(h->epoll_fd, EPOLL_CTL_ADD, h->listen_fd, &ev) < 0) {
+        perror("Erro ao preparar o epoll do exportador");
+        http_exporter_close(h);
+        return false;
+    }
+    return true;
+}
+
+// ---------- Conexões ----------
+
+static void conn_close(HttpExporter *h, HttpConn *c) {
+    epoll_ctl(h->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    expo_release(c->body);
+    h->conns[c->slot] = NULL;
+    free(c);
+}
+
+static void conn_watch(HttpExporter *h, HttpConn *c, bool writing) {
+    if (writing == c->writing) return;
+    struct epoll_event ev = { .events = writing ? EPOLLOUT : EPOLLIN, .data.u64 = (uint64_t)c->slot };
+    epoll_ctl(h->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->writing = writing;
+}
+
+static void accept_conns(HttpExporter *h) {
+    for (;;) {
+        int fd = accept4(h->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;     // EAGAIN: fila vazia
+        }
+        int slot = 0;
+        while (slot < HTTP_MAX_CLIENTS && h->conns[slot]) slot++;
+        HttpConn *c = (slot < HTTP_MAX_CLIENTS) ? calloc(1, sizeof(HttpConn)) : NULL;
+        struct epoll_event ev = { .events = EPOLLIN, .data.u64 = (uint64_t)slot };
+        if (!c || epoll_ctl(h->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            free(c);
+            close(fd);  // limite de clientes: o cliente vê a conexão fechada
+            continue;
+        }
+        c->fd = fd;
+        c->slot = slot;
+        h->conns[slot] = c;
+    }
+}
+
+// Monta a resposta: corpo do memfd (body) ou texto curto (text)
+static void conn_respond(HttpExporter *h, HttpConn *c, const char *status, const char *extra_headers,
+                         Exposition *body, const char *text, bool head_only) {
+    size_t len = body ? body->len : strlen(text);
+    int n = snprintf(c->head, sizeof(c->head),
+                     "HTTP/1.1 %s\r\n"
+                     "Content-Type: %s\r\n"
+                     "Content-Length: %zu\r\n"
+                     "%s"
+                     "Connection: %s\r\n"
+                     "\r\n",
+                     status, body ? HTTP_CONTENT_TYPE : "text/plain; charset=utf-8", len,
+                     extra_headers ? extra_headers : "", c->close_after ? "close" : "keep-alive");
+    c->head_len = (n > 0 && (size_t)n < sizeof(c->head)) ? (size_t)n : 0;
+    c->head_off = 0;
+    if (!head_only && !body) {
+        size_t room = sizeof(c->head) - c->head_len;
+        size_t copy = len < room ? len : room;
+        memcpy(c->head + c->head_len, text, copy);
+        c->head_len += copy;
+    }
+    if (body && !head_only) {
+        body->refs++;
+        c->body = body;
+        c->body_off = 0;
+        c->body_len = body->len;
+    }
+    conn_watch(h, c, true);
+}
+
+// Cabeçalho "Connection" da requisição
+static bool header_has(const char *headers, const char *name, const char *token) {
+    size_t name_len = strlen(name);
+    for (const char *line = headers; line && *line; ) {
+        const char *eol = strstr(line, "\r\n");
+        if (!eol || eol == line) break;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            char value[128];
+            size_t vlen = (size_t)(eol - line) - name_len - 1;
+            if (vlen >= sizeof(value)) vlen = sizeof(value) - 1;
+            memcpy(value, line + name_len + 1, vlen);
+            value[vlen] = '\0';
+            if (strcasestr(value, token)) return true;
+        }
+        line = eol + 2;
+    }
+    return false;
+}
+
+// Atende a requisição completa no início de c->req (len bytes até o \r\n\r\n)
+static void handle_request(HttpExporter *h, HttpConn *c, size_t len) {
+    char *req = c->req;
+    c->req_used = len;
+    req[len - 2] = '\0';    // termina antes da linha em branco
+
+    char method[16], target[1024], version[16];
+    char *eol = strstr(req, "\r\n");
+    if (eol) *eol = '\0';
+    if (sscanf(req, "%15s %1023s %15s", method, target, version) != 3 || strncmp(version, "HTTP/1.", 7) != 0) {
+        c->close_after = true;
+        conn_respond(h, c, "400 Bad Request", NULL, NULL, "requisição inválida\n", false);
+        return;
+    }
+    const char *headers = eol ? eol + 2 : "";
+
+    // HTTP/1.1 mantém a conexão por padrão; HTTP/1.0 só se pedir
+    if (strcmp(version, "HTTP/1.0") == 0) c->close_after = !header_has(headers, "Connection", "keep-alive");
+    else c->close_after = header_has(headers, "Connection", "close");
+
+    char *query = strchr(target, '?');
+    if (query) *query = '\0';
+    bool head_only = strcmp(method, "HEAD") == 0;
+    if (!head_only && strcmp(method, "GET") != 0) {
+        c->close_after = true;  // um eventual corpo não é lido
+        conn_respond(h, c, "405 Method Not Allowed", "Allow: GET, HEAD\r\n", NULL, "método não permitido\n", false);
+    } else if (strcmp(target, "/metrics") == 0) {
+        if (h->current) {
+            h->scrapes++;
+            conn_respond(h, c, "200 OK", NULL, h->current, NULL, head_only);
+        } else {
+            conn_respond(h, c, "503 Service Unavailable", "Retry-After: 1\r\n", NULL,
+                         "métricas ainda não coletadas\n", head_only);
+        }
+    } else if (strcmp(target, "/") == 0) {
+        conn_respond(h, c, "200 OK", NULL, NULL, "resource-monitor: métricas em /metrics\n", head_only);
+    } else {
+        conn_respond(h, c, "404 Not Found", NULL, NULL, "não encontrado\n", head_only);
+    }
+}
+
+// Atende a requisição no buffer, se já estiver completa
+static void conn_parse(HttpExporter *h, HttpConn *c) {
+    c->req[c->req_len] = '\0';
+    char *end = (c->req_len > 0) ? strstr(c->req, "\r\n\r\n") : NULL;
+    if (end) {
+        handle_request(h, c, (size_t)(end - c->req) + 4);
+    } else if (c->req_len >= sizeof(c->req) - 1) {
+        c->close_after = true;
+        c->req_used = c->req_len;
+        conn_respond(h, c, "431 Request Header Fields Too Large", NULL, NULL, "requisição grande demais\n", false);
+    }
+}
+
+static bool conn_read(HttpExporter *h, HttpConn *c) {
+    while (!c->writing) {
+        ssize_t n = recv(c->fd, c->req + c->req_len, sizeof(c->req) - 1 - c->req_len, 0);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        c->req_len += (size_t)n;
+        conn_parse(h, c);
+    }
+    return true;
+}
+
+// Envia o que o socket aceitar. Ao terminar, volta a ler (ou fecha).
+static bool conn_write(HttpExporter *h, HttpConn *c) {
+    while (c->head_off < c->head_len) {
+        int flags = MSG_NOSIGNAL | MSG_DONTWAIT | (c->body ? MSG_MORE : 0);
+        ssize_t n = send(c->fd, c->head + c->head_off, c->head_len - c->head_off, flags);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        c->head_off += (size_t)n;
+    }
+    // Corpo: páginas do memfd direto para o socket
+    while (c->body && (size_t)c->body_off < c->body_len) {
+        ssize_t n = sendfile(c->fd, c->body->fd, &c->body_off, c->body_len - (size_t)c->body_off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        if (n == 0) return false;
+    }
+    expo_release(c->body);
+    c->body = NULL;
+    if (c->close_after) return false;
+
+    // Requisição seguinte (pipelining) pode já estar no buffer
+    memmove(c->req, c->req + c->req_used, c->req_len - c->req_used);
+    c->req_len -= c->req_used;
+    c->req_used = 0;
+    conn_watch(h, c, false);
+    conn_parse(h, c);
+    return true;
+}
+
+void http_exporter_dispatch(HttpExporter *h) {
+    struct epoll_event events[HTTP_MAX_EVENTS];
+    int n;
+    while ((n = epoll_wait(h->epoll_fd, events, HTTP_MAX_EVENTS, 0)) > 0) {
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.u64 == HTTP_LISTEN_TAG) {
+                accept_conns(h);
+                continue;
+            }
+            HttpConn *c = h->conns[events[i].data.u64];
+            if (!c) continue;
+            bool keep = !(events[i].events & EPOLLERR);
+            if (keep && c->writing) keep = conn_write(h, c);
+            else if (keep) keep = conn_read(h, c);
+            if (keep && c->writing && c->head_off == 0) keep = conn_write(h, c);   // resposta nova
+            if (!keep) conn_close(h, c);
+        }
+        if (n < HTTP_MAX_EVENTS) break;
+    }
+}
+
+// ---------- Corpo ----------
+
+OutBuf *http_exporter_begin(HttpExporter *h) {
+    if (h->pending) expo_release(h->pending);
+    h->pending = calloc(1, sizeof(Exposition));
+    int fd = memfd_create("resmon-metrics", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (!h->pending || fd < 0) {
+        if (fd >= 0) close(fd);
+        free(h->pending);
+        h->pending = NULL;
+        return NULL;
+    }
+    h->pending->fd = fd;
+    h->pending->refs = 1;
+    h->render_start_ns = monotonic_ns();
+
+    // O buffer de renderização é alocado uma vez e reaproveitado
+    char *buf = h->render.data;
+    size_t cap = h->render.cap ? h->render.cap : HTTP_RENDER_BUF;
+    if (!out_init(&h->render, fd, buf, cap)) {
+        expo_release(h->pending);
+        h->pending = NULL;
+        return NULL;
+    }
+    return &h->render;
+}
+
+bool http_exporter_commit(HttpExporter *h) {
+    Exposition *e = h->pending;
+    if (!e) return false;
+    h->pending = NULL;
+    if (!out_flush(&h->render)) {
+        expo_release(e);
+        return false;
+    }
+    e->len = (size_t)h->render.written;
+    // Imutável daqui em diante: respostas em andamento leem o que foi publicado
+    fcntl(e->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+
+    expo_release(h->current);
+    h->current = e;
+    h->renders++;
+    h->last_render_ns = monotonic_ns() - h->render_start_ns;
+    return true;
+}
+
+void http_exporter_close(HttpExporter *h) {
+    for (int i = 0; i < HTTP_MAX_CLIENTS; i++) {
+        if (h->conns[i]) conn_close(h, h->conns[i]);
+    }
+    expo_release(h->current);
+    expo_release(h->pending);
+    h->current = h->pending = NULL;
+    free(h->render.data);
+    h->render.data = NULL;
+    h->render.cap = 0;
+    if (h->epoll_fd >= 0) close(h->epoll_fd);
+    if (h->listen_fd >= 0) {
+        close(h->listen_fd);
+        if (h->unix_socket) unlink(h->address);
+    }
+    h->epoll_fd = h->listen_fd = -1;
+}
+
+// ---------- Formato de exposição ----------
+
+static void out_str(OutBuf *o, const char *s) {
+    out_write(o, s, strlen(s));
+}
+
+void expo_family(OutBuf *o, const char *name, const char *type, const char *help) {
+    out_lit(o, "# HELP ");
+    out_str(o, name);
+    out_char(o, ' ');
+    out_str(o, help);
+    out_lit(o, "\n# TYPE ");
+    out_str(o, name);
+    out_char(o, ' ');
+    out_str(o, type);
+    out_char(o, '\n');
+}
+
+static void series_name(OutBuf *o, const char *name, const char *labels, const char *extra) {
+    bool has_labels = labels && *labels;
+    bool has_extra = extra && *extra;
+    out_str(o, name);
+    if (has_labels || has_extra) {
+        out_char(o, '{');
+        if (has_labels) out_str(o, labels);
+        if (has_labels && has_extra) out_char(o, ',');
+        if (has_extra) out_str(o, extra);
+        out_char(o, '}');
+    }
+    out_char(o, ' ');
+}
+
+void expo_value(OutBuf *o, const char *name, const char *labels, const char *extra, double v, int decimals) {
+    series_name(o, name, labels, extra);
+    if (isnan(v)) out_lit(o, "NaN");
+    else if (isinf(v)) out_str(o, v > 0 ? "+Inf" : "-Inf");
+    else out_fixed(o, v, decimals);
+    out_char(o, '\n');
+}
+
+void expo_value_u64(OutBuf *o, const char *name, const char *labels, const char *extra, uint64_t v) {
+    series_name(o, name, labels, extra);
+    out_u64(o, v);
+    out_char(o, '\n');
+}
+
+bool expo_label(char *buf, size_t size, const char *key, const char *value) {
+    size_t len = strnlen(buf, size);
+    if (len >= size) return false;
+    char *p = buf + len;
+    char *end = buf + size - 1;
+
+    if (len > 0 && p < end) *p++ = ',';
+    for (const char *k = key; *k && p < end; k++) *p++ = *k;
+    if (p < end) *p++ = '=';
+    if (p < end) *p++ = '"';
+    for (const char *v = value; *v && p < end; v++) {
+        char ch = *v;
+        if (ch == '\\' || ch == '"' || ch == '\n') {
+            *p++ = '\\';
+            if (p >= end) break;
+            ch = (ch == '\n') ? 'n' : ch;
+        }
+        *p++ = ch;
+    }
+    if (p >= end) {
+        buf[len] = '\0';    // não coube: a lista fica como estava
+        return false;
+    }
+    *p++ = '"';
+    *p = '\0';
+    return true;
+}
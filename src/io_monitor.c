@@ -1,15 +1,15 @@
 #include "../include/monitor.h"
+#include "../include/proc_parse.h"
+#include "../include/timing.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-static bool read_io_stats(int pid, ResourceData *data) {
-    char filepath[256];
-    snprintf(filepath, sizeof(filepath), "/proc/%d/io", pid);
-
-    FILE *fp = fopen(filepath, "r");
-    if (fp == NULL) {
+static bool read_io_stats(ProcHandle *h, ResourceData *data) {
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_IO, &len);
+    if (buf == NULL) {
         // This file is only readable by root or the process owner
         // We'll return true but with 0 values if we can't open it.
         data->io_read_bytes = 0;
@@ -19,25 +19,34 @@ static bool read_io_stats(int pid, ResourceData *data) {
         return true; 
     }
 
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        if (strncmp(line, "read_bytes:", 11) == 0) {
-            sscanf(line + 12, "%lld", &data->io_read_bytes);
-        } else if (strncmp(line, "write_bytes:", 12) == 0) {
-            sscanf(line + 13, "%lld", &data->io_write_bytes);
-        } else if (strncmp(line, "syscr:", 6) == 0) {
-            sscanf(line + 7, "%lld", &data->io_read_syscalls);
-        } else if (strncmp(line, "syscw:", 6) == 0) {
-            sscanf(line + 7, "%lld", &data->io_write_syscalls);
-        }
-    }
+    ProcIo io;
+    proc_parse_io(buf, len, &io);
+    data->io_read_bytes = io.read_bytes;
+    data->io_write_bytes = io.write_bytes;
+    data->io_read_syscalls = io.syscr;
+    data->io_write_syscalls = io.syscw;
 
-    fclose(fp);
     return true;
 }
 
+bool get_io_data_handle(ProcHandle *h, ResourceData *data) {
+    data->pid = h->pid;
+    TIMING_STAMP(data);
+    return read_io_stats(h, data);
+}
+
 bool get_io_data(int pid, ResourceData *data) {
-    data->pid = pid;
-    data->timestamp = time(NULL);
-    return read_io_stats(pid, data);
+    ProcHandle h = {0};
+    if (!proc_handle_open(&h, pid)) {
+        // PID inválido: mantém o contrato anterior (sucesso com contadores zerados)
+        proc_handle_close(&h);
+        data->pid = pid;
+        TIMING_STAMP(data);
+        data->io_read_bytes = 0;
+        data->io_write_bytes = 0;
+        return true;
+    }
+    bool ok = get_io_data_handle(&h, data);
+    proc_handle_close(&h);
+    return ok;
 }
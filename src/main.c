@@ -7,6 +7,8 @@
 #include <sys/stat.h>
 #include "../include/monitor.h"
 #include "../include/namespace.h"
+#include "../include/ns_index.h"
+#include "../include/ns_latency.h"
 #include "../include/utils.h"
 #include "../include/network.h"
 #include "../include/monitor_tui.h"
@@ -16,27 +18,62 @@
 #include "../include/experiment_memory_limit.h"
 #include "../include/experiment_io_limit.h"
 #include "../include/cgroup.h"
+#include "../include/cgroup_stats.h"
 #include "../include/process_monitor.h"
+#include "../include/timing.h"
+#include "../include/tsdb.h"
+#include "../include/stream_export.h"
+#include "../include/resource_collector.h"
+#include "../include/stats.h"
+#include "../include/agent.h"
+#include "../include/http_exporter.h"
 
 void print_usage(const char *prog_name) {
-    printf("Uso: %s <comando> [opções]\n\n", prog_name);
+    printf("Uso: %s [--backend proc|taskstats] [--adaptive <teto>] <comando> [opções]\n\n", prog_name);
     printf("Comandos:\n");
     printf("  menu                                        - Menu interativo principal\n");
-    printf("  monitor <pid> <intervalo_s> <duracao_s>     - Monitora um processo\n");
-    printf("  process <pid> <intervalo_s> <duracao_s> <formato> - Monitora processo com exportação (json/csv)\n");
-    printf("  tui <pid> [intervalo_s] [duracao_s]         - Interface TUI (modo interativo ou tempo determinado)\n");
+    printf("  monitor <pid> <intervalo> <duracao>         - Monitora um processo\n");
+    printf("  monitor all <intervalo> <duracao>           - Monitora todos os processos (modo top)\n");
+    printf("  monitor --pids <a,b,c> <intervalo> <duracao> - Monitora um conjunto de PIDs\n");
+    printf("  process <pid> <intervalo> <duracao> <formato> [retencao] - Monitora processo com exportação (json/ndjson/csv/bin)\n");
+    printf("  dump <arquivo.rmts> <json|csv> [saida]      - Converte uma captura binária para JSON/CSV\n");
+    printf("  tui <pid> [intervalo] [duracao]             - Interface TUI (modo interativo ou tempo determinado)\n");
+    printf("  top [cgroup <caminho> | ns <tipo> <pid>] [intervalo] - TUI com todos os processos (ordenável, com busca)\n");
+    printf("  daemon [--http <end>] [--refresh <int>] [--cgroup <caminho>]... [socket] [retencao]\n");
+    printf("                                              - Agente residente com API em socket Unix e,\n");
+    printf("                                                com --http, endpoint Prometheus em /metrics\n");
+    printf("  client <watch|unwatch|list|query|summary|stream|shutdown> [args] - Consulta o agente\n");
     printf("  namespace list <pid>                        - Lista os namespaces de um processo\n");
     printf("  namespace compare <pid1> <pid2>             - Compara namespaces de dois processos\n");
     printf("  namespace find <caminho_ns>                 - Encontra processos em um namespace\n");
     printf("  namespace report                            - Gera relatório de namespaces em JSON\n");
-    printf("  namespace overhead                          - Mede overhead de criação de namespace\n");
+    printf("  namespace overhead [reps] [aquec] [tipos]...  - Latência de criação/destruição de namespaces\n");
+    printf("                                                (tipos: pid net mnt uts ipc user cgroup time,\n");
+    printf("                                                 combinados com '+', ou all)\n");
     printf("  experiment <1-5>                            - Executa experimento específico\n");
     printf("                                                1=Overhead, 2=Namespaces, 3=CPU,\n");
     printf("                                                4=Memory, 5=IO\n");
     printf("\n");
+    printf("Intervalos e durações aceitam sufixos: 2s, 100ms, 500us (sem sufixo = segundos)\n");
+    printf("\n");
+    printf("Opções globais:\n");
+    printf("  --backend proc|taskstats  - Coleta de monitor/tui: texto de /proc (padrão) ou netlink\n");
+    printf("                              TASKSTATS (root; inclui delays de CPU, I/O de bloco,\n");
+    printf("                              swap-in e reclaim e as estatísticas finais no término)\n");
+    printf("  --adaptive <teto>         - monitor/process com intervalo adaptativo: o intervalo\n");
+    printf("                              pedido vale enquanto CPU%%, RSS ou I/O mudam e dobra a\n");
+    printf("                              cada amostra estável até o teto (interval_ns na exportação)\n");
+    printf("\n");
     printf("Exemplos:\n");
     printf("  %s process 1234 5 60 json     - Monitora PID 1234, coleta a cada 5s por 60s, exporta JSON\n", prog_name);
     printf("  %s process 1234 2 30 csv      - Monitora PID 1234, coleta a cada 2s por 30s, exporta CSV\n", prog_name);
+    printf("  %s monitor all 2 30           - Todos os processos a cada 2s por 30s (output/monitor_all.csv)\n", prog_name);
+    printf("  %s dump output/monitor_all.rmts csv saida.csv - Converte a captura binária para CSV\n", prog_name);
+    printf("  %s monitor 1234 100ms 10s     - Amostra o PID 1234 a cada 100ms por 10s\n", prog_name);
+    printf("  %s top cgroup /system.slice   - Processos do cgroup (e descendentes) em tempo real\n", prog_name);
+    printf("  %s top ns net 1234            - Processos no mesmo netns do PID 1234\n", prog_name);
+    printf("  %s --backend taskstats monitor 1234 1 10 - Coleta via netlink TASKSTATS\n", prog_name);
+    printf("  %s --adaptive 10s process 1234 50ms 1h ndjson - 50ms em rajadas, até 10s em repouso\n", prog_name);
     printf("\n");
     printf("Nota: Para gerenciar cgroups, use o programa 'cgroup_manager'\n");
     printf("\n");
@@ -148,6 +185,21 @@ void list_cgroup_pids(const char *cgroup_name) {
     printf("\nTotal: %d processo(s)\n", count);
 }
 
+// Índice de namespaces do menu: montado na primeira consulta e mantido pelo
+// proc connector enquanto o menu está aberto
+static bool namespace_index_poll(NsIndex *idx, bool *ready) {
+    if (!*ready) {
+        printf("Montando índice de namespaces...\n");
+        if (!ns_index_init(idx, 0)) return false;
+        ns_index_listen(idx);
+        *ready = true;
+        printf("%zu processos em %zu namespaces (%.1f ms)%s\n\n", idx->proc_count, idx->ns_count,
+               (double)idx->last_scan_cost_ns / NSEC_PER_MSEC,
+               ns_index_fd(idx) >= 0 ? "" : " - sem proc connector: varredura a cada consulta");
+    }
+    return ns_index_poll(idx);
+}
+
 void run_interactive_menu() {
     int choice = 0;
     
@@ -171,6 +223,7 @@ void run_interactive_menu() {
                     printf("Escolha o modo de monitoramento:\n\n");
                     printf("  1) TUI - Interface em Tempo Real\n");
                     printf("  2) Coleta Detalhada com Exportação (CSV/JSON)\n");
+                    printf("  3) TUI - Todos os Processos (top)\n");
                     printf("  0) Voltar ao menu principal\n");
                     printf("\nOpção: ");
                     
@@ -200,7 +253,7 @@ void run_interactive_menu() {
                             printf("\nIniciando TUI para PID %d...\n", pid);
                             printf("Pressione 'q' para sair, 'h' para ajuda\n\n");
                             sleep(1);
-                            run_tui(pid, 1, 0);
+                            run_tui(pid, NSEC_PER_SEC, 0);
                             break;
                         }
                         
@@ -209,6 +262,14 @@ void run_interactive_menu() {
                             break;
                         }
                         
+                        case 3: {
+                            printf("\nIniciando TUI com todos os processos...\n");
+                            printf("Pressione 'q' para sair, 'h' para ajuda\n\n");
+                            sleep(1);
+                            run_top_tui(NULL, NULL, NULL, NSEC_PER_SEC);
+                            break;
+                        }
+                        
                         default:
                             printf("\nOpção inválida!\n");
                             break;
@@ -219,6 +280,8 @@ void run_interactive_menu() {
             
             case 2: {
                 int ns_choice = 0;
+                NsIndex ns_idx;
+                bool ns_idx_ready = false;
                 while (1) {
                     printf("\n===============================================================\n");
                     printf("              Namespace Analyzer                               \n");
@@ -240,6 +303,7 @@ void run_interactive_menu() {
                     while (getchar() != '\n');
                     
                     if (ns_choice == 0) {
+                        if (ns_idx_ready) ns_index_close(&ns_idx);
                         break;
                     }
                     
@@ -282,7 +346,11 @@ void run_interactive_menu() {
                             }
                             while (getchar() != '\n');
                             
-                            compare_process_namespaces(pid1, pid2);
+                            if (namespace_index_poll(&ns_idx, &ns_idx_ready)) {
+                                compare_process_namespaces_indexed(&ns_idx, pid1, pid2);
+                            } else {
+                                compare_process_namespaces(pid1, pid2);
+                            }
                             printf("\nPressione ENTER para continuar...");
                             getchar();
                             break;
@@ -299,7 +367,11 @@ void run_interactive_menu() {
                             ns_path[strcspn(ns_path, "\n")] = 0; // Remove newline
                             
                             printf("\n");
-                            find_processes_in_namespace(ns_path);
+                            if (namespace_index_poll(&ns_idx, &ns_idx_ready)) {
+                                find_processes_in_namespace_indexed(&ns_idx, ns_path);
+                            } else {
+                                find_processes_in_namespace(ns_path);
+                            }
                             printf("\nPressione ENTER para continuar...");
                             getchar();
                             break;
@@ -308,7 +380,11 @@ void run_interactive_menu() {
                         case 4: {
                             printf("\n--- Gerar Relatório do Sistema ---\n");
                             printf("Gerando relatório de todos os namespaces do sistema...\n\n");
-                            generate_system_namespace_report("output/namespace_report.json");
+                            if (namespace_index_poll(&ns_idx, &ns_idx_ready)) {
+                                generate_system_namespace_report_indexed(&ns_idx, "output/namespace_report.json");
+                            } else {
+                                generate_system_namespace_report("output/namespace_report.json");
+                            }
                             printf("\nPressione ENTER para continuar...");
                             getchar();
                             break;
@@ -779,46 +855,134 @@ void run_interactive_menu() {
 }
 
 
-void run_monitor(int pid, int interval, int duration) {
-    int num_samples = duration / interval;
-    if (num_samples <= 0) {
+// Converte "a,b,c" em um vetor de PIDs. Retorna a quantidade ou -1 se inválido.
+static int parse_pid_list(const char *list, int **out) {
+    int count = 1;
+    for (const char *p = list; *p; p++) {
+        if (*p == ',') count++;
+    }
+
+    int *pids = malloc(count * sizeof(int));
+    if (!pids) return -1;
+
+    const char *p = list;
+    for (int i = 0; i < count; i++) {
+        char *end;
+        long pid = strtol(p, &end, 10);
+        if (end == p || pid <= 0 || (*end != ',' && *end != '\0')) {
+            free(pids);
+            return -1;
+        }
+        pids[i] = (int)pid;
+        p = end + 1;
+    }
+
+    *out = pids;
+    return count;
+}
+
+// Estatísticas finais entregues pelo kernel no término do processo
+static void print_exit_stats(const TaskStats *s) {
+    printf("\nEstatísticas finais de %d (%s), via notificação de término:\n", s->pid, s->comm);
+    printf("  Código de saída: %u\n", s->exitcode);
+    printf("  CPU: user %.3f s, system %.3f s | trocas de contexto: %llu vol., %llu invol.\n",
+           s->cpu_user_us / 1e6, s->cpu_system_us / 1e6,
+           (unsigned long long)s->voluntary_ctx_switches, (unsigned long long)s->nonvoluntary_ctx_switches);
+    printf("  Delays: CPU %.3f ms (%llu), bloco %.3f ms (%llu), swap-in %.3f ms, reclaim %.3f ms\n",
+           s->cpu_delay_ns / 1e6, (unsigned long long)s->cpu_delay_count,
+           s->blkio_delay_ns / 1e6, (unsigned long long)s->blkio_delay_count,
+           s->swapin_delay_ns / 1e6, s->freepages_delay_ns / 1e6);
+    if (!s->tgid_scope) {
+        // Total do processo só vem quando ele tinha mais de uma thread
+        printf("  I/O: %llu bytes lidos, %llu escritos | RSS máximo: %llu KB\n",
+               (unsigned long long)s->read_bytes, (unsigned long long)s->write_bytes,
+               (unsigned long long)s->hiwater_rss_kb);
+    }
+}
+
+// adaptive_max_ns > interval_ns: intervalo adaptativo com esse teto
+void run_monitor(int pid, uint64_t interval_ns, uint64_t duration_ns, uint64_t adaptive_max_ns) {
+    uint64_t total_samples = duration_ns / interval_ns;
+    if (total_samples == 0 || total_samples > INT32_MAX) {
         fprintf(stderr, "Erro: Duração deve ser maior que o intervalo.\n");
         return;
     }
+    int num_samples = (int)total_samples;
 
-    ResourceData *history = malloc(num_samples * sizeof(ResourceData));
-    if (history == NULL) {
-        perror("Falha ao alocar memória para o histórico");
-        return;
+    // Modo adaptativo: o intervalo pedido é o mínimo e a duração limita o laço
+    AdaptiveInterval adaptive;
+    bool adaptive_mode = adaptive_max_ns > interval_ns;
+    if (adaptive_mode) {
+        adaptive_interval_init(&adaptive, interval_ns, adaptive_max_ns);
+        num_samples = INT32_MAX;
     }
 
     ResourceData prev_data = {0};
     bool first_sample = true;
     long ticks_per_second = sysconf(_SC_CLK_TCK);
+    MetricsSummary summary;         // estatísticas da captura inteira
+    metrics_summary_init(&summary);
+
+    ResourceCollector collector;
+    if (!resource_collector_open(&collector, pid, collect_backend_get())) {
+        fprintf(stderr, "Erro: Processo com PID %d não encontrado.\n", pid);
+        return;
+    }
+
+    // Amostras gravadas durante a coleta (sem histórico em memória)
+    const char *output_path = "output/monitor_output.json";
+    StreamExporter exporter;
+    if (!stream_export_open(&exporter, output_path, STREAM_RESOURCE_DATA, EXPORT_JSON)) {
+        resource_collector_close(&collector);
+        return;
+    }
+
+    SampleTimer timer;
+    if (!sample_timer_start(&timer, interval_ns)) {
+        stream_export_close(&exporter);
+        resource_collector_close(&collector);
+        return;
+    }
 
-    printf("Monitorando PID %d a cada %d segundos por %d segundos...\n", pid, interval, duration);
-    printf("%-8s | %-7s | %-10s | %-10s | %-12s | %-12s | %-8s\n",
-           "TEMPO", "CPU%", "MEM(VSZ)", "MEM(RSS)", "IO_R_RATE", "IO_W_RATE", "USER");
+    char interval_str[32], duration_str[32], ceiling_str[32];
+    format_duration_ns(interval_ns, interval_str, sizeof(interval_str));
+    format_duration_ns(duration_ns, duration_str, sizeof(duration_str));
+    if (adaptive_mode) {
+        format_duration_ns(adaptive.max_ns, ceiling_str, sizeof(ceiling_str));
+        printf("Monitorando PID %d a cada %s-%s (adaptativo) por %s (backend %s)...\n", pid, interval_str,
+               ceiling_str, duration_str, collect_backend_name(collector.backend));
+    } else {
+        printf("Monitorando PID %d a cada %s por %s (backend %s)...\n", pid, interval_str, duration_str,
+               collect_backend_name(collector.backend));
+    }
+    printf("%-10s | %-7s | %-10s | %-10s | %-12s | %-12s | %-8s\n",
+           "TEMPO(s)", "CPU%", "MEM(VSZ)", "MEM(RSS)", "IO_R_RATE", "IO_W_RATE", "USER");
+
+    uint64_t start_ns = monotonic_ns();
+    uint64_t missed = 0;
+    uint64_t scheduled_ns = 0;      // intervalo que levou à amostra atual
+    bool ended = false;
 
     for (int i = 0; i < num_samples; i++) {
         ResourceData current_data;
 
-        // Coleta de dados
-        if (!get_cpu_data(pid, &current_data) || !get_memory_data(pid, &current_data) || !get_io_data(pid, &current_data) || !get_network_data(pid, &current_data)) {
+        // Coleta de dados (descritores e sockets mantidos abertos entre amostras)
+        if (!resource_collector_sample(&collector, &current_data)) {
             fprintf(stderr, "\nErro: Não foi possível ler os dados do processo %d. Ele pode ter sido encerrado.\n", pid);
-            free(history);
-            return;
+            ended = true;
+            break;
         }
 
+        current_data.interval_ns = scheduled_ns;
         if (first_sample) {
             first_sample = false;
             current_data.cpu_usage_percent = 0.0;
             current_data.io_read_rate = 0.0;
             current_data.io_write_rate = 0.0;
         } else {
-            // Calcular deltas
-            double time_delta_sec = difftime(current_data.timestamp, prev_data.timestamp);
-            if (time_delta_sec <= 0) time_delta_sec = interval; // Fallback
+            // Calcular deltas sobre o relógio monotônico (resolução de ns)
+            double time_delta_sec = (double)(current_data.mono_ns - prev_data.mono_ns) / NSEC_PER_SEC;
+            if (time_delta_sec <= 0) time_delta_sec = (double)interval_ns / NSEC_PER_SEC; // Fallback
 
             // CPU %
             long total_cpu_time_diff = (current_data.cpu_user + current_data.cpu_system) - (prev_data.cpu_user + prev_data.cpu_system);
@@ -827,14 +991,19 @@ void run_monitor(int pid, int interval, int duration) {
             // I/O Rates
             current_data.io_read_rate = (current_data.io_read_bytes - prev_data.io_read_bytes) / time_delta_sec;
             current_data.io_write_rate = (current_data.io_write_bytes - prev_data.io_write_bytes) / time_delta_sec;
+
+            metrics_summary_add(&summary, current_data.cpu_usage_percent,
+                                (double)current_data.memory_rss * sysconf(_SC_PAGESIZE),
+                                current_data.io_read_rate, current_data.io_write_rate,
+                                current_data.mono_ns - prev_data.mono_ns);
         }
 
-        // Armazenar e imprimir
-        history[i] = current_data;
+        // Exportar e imprimir
+        stream_export_append(&exporter, &current_data);
         prev_data = current_data;
 
-        printf("%-8ld | %-6.2f%% | %-10ld | %-10ld | %-12.2f | %-12.2f | %-8ld\n",
-               current_data.timestamp,
+        printf("%-10.3f | %-6.2f%% | %-10ld | %-10ld | %-12.2f | %-12.2f | %-8ld\n",
+               (double)(current_data.mono_ns - start_ns) / NSEC_PER_SEC,
                current_data.cpu_usage_percent,
                current_data.memory_vsz,
                current_data.memory_rss * (sysconf(_SC_PAGESIZE) / 1024),
@@ -842,18 +1011,265 @@ void run_monitor(int pid, int interval, int duration) {
                current_data.io_write_rate,
                current_data.cpu_user);
 
+        scheduled_ns = interval_ns;
+        if (adaptive_mode) {
+            scheduled_ns = adaptive_interval_update(&adaptive, current_data.cpu_usage_percent,
+                                                    (double)current_data.memory_rss * sysconf(_SC_PAGESIZE),
+                                                    current_data.io_read_rate + current_data.io_write_rate);
+            if (monotonic_ns() - start_ns + scheduled_ns > duration_ns) break;
+            if (!sample_timer_set_interval(&timer, scheduled_ns)) break;
+        }
+
         if (i < num_samples - 1) {
-            sleep(interval);
+            uint64_t ticks = sample_timer_wait(&timer);
+            if (ticks == 0) break;
+            missed += ticks - 1;
+        }
+    }
+
+    sample_timer_close(&timer);
+
+    // Processo encerrado: estatísticas finais da notificação de término
+    TaskStats final;
+    if (ended && resource_collector_final(&collector, &final)) {
+        print_exit_stats(&final);
+    }
+    resource_collector_close(&collector);
+
+    if (missed > 0) {
+        printf("Aviso: %llu amostra(s) atrasada(s) (coleta mais lenta que o intervalo)\n",
+               (unsigned long long)missed);
+    }
+
+    metrics_summary_print(&summary);
+
+    if (stream_export_close(&exporter)) {
+        printf("Dados de monitoramento exportados para '%s' (%llu amostras).\n",
+               output_path, (unsigned long long)exporter.written);
+    } else {
+        fprintf(stderr, "Erro ao exportar dados para '%s'\n", output_path);
+    }
+
+    const char *summary_path = "output/monitor_summary.json";
+    if (summary.metrics[SUMMARY_CPU_PERCENT].stats.count > 0 &&
+        metrics_summary_export_json(&summary, pid, summary_path)) {
+        printf("Resumo estatístico exportado para '%s'.\n", summary_path);
+    }
+}
+
+// Lê intervalo e duração ("100ms", "2s", "5") da linha de comando
+static bool parse_interval_args(const char *interval_str, const char *duration_str,
+                                uint64_t *interval_ns, uint64_t *duration_ns) {
+    if (!parse_duration_ns(interval_str, interval_ns)) {
+        fprintf(stderr, "Erro: Intervalo inválido '%s'. Use, por exemplo, 2s, 100ms ou 500us.\n", interval_str);
+        return false;
+    }
+    if (!parse_duration_ns(duration_str, duration_ns)) {
+        fprintf(stderr, "Erro: Duração inválida '%s'. Use, por exemplo, 60s ou 1500ms.\n", duration_str);
+        return false;
+    }
+    return true;
+}
+
+static void print_client_usage(const char *prog_name) {
+    fprintf(stderr, "Uso: %s client <comando> [args]  (socket: $%s ou %s)\n", prog_name,
+            AGENT_SOCKET_ENV, AGENT_DEFAULT_SOCKET);
+    fprintf(stderr, "  watch <pid> [intervalo]      - Passa a observar o processo (padrão 1s)\n");
+    fprintf(stderr, "  unwatch <pid>                - Deixa de observar e descarta o histórico\n");
+    fprintf(stderr, "  list                         - Processos observados\n");
+    fprintf(stderr, "  query <pid> [janela] [max]   - Amostras do histórico (janela: ex. 30s)\n");
+    fprintf(stderr, "  summary <pid>                - Resumo estatístico desde o watch\n");
+    fprintf(stderr, "  stream <pid> [amostras]      - Amostras ao vivo até o fim do processo\n");
+    fprintf(stderr, "  watch-cgroup <cgroup>        - Observa os eventos do cgroup (relativo a %s)\n", CGROUP_ROOT);
+    fprintf(stderr, "  unwatch-cgroup <cgroup>      - Deixa de observar e descarta os eventos\n");
+    fprintf(stderr, "  cgroups                      - Cgroups observados\n");
+    fprintf(stderr, "  events <cgroup>              - Eventos retidos do cgroup\n");
+    fprintf(stderr, "  stream-cgroup <cgroup> [n]   - Eventos ao vivo até o rmdir do cgroup\n");
+    fprintf(stderr, "  shutdown                     - Encerra o agente\n");
+}
+
+static void print_agent_sample(const AgentSample *s, uint64_t base_ns) {
+    printf("%-10.3f | %-6.2f%% | %-10llu | %-12.2f | %-12.2f | %-7u\n",
+           (double)(s->mono_ns - base_ns) / NSEC_PER_SEC, s->cpu_percent,
+           (unsigned long long)(s->rss_bytes / 1024), s->io_read_bps, s->io_write_bps, s->threads);
+}
+
+static void print_agent_cgroup_event(const AgentCgroupEvent *e, uint64_t base_ns) {
+    printf("%-10.3f | %-14s | %-12s | %-12llu | %+lld\n", (double)(e->mono_ns - base_ns) / NSEC_PER_SEC,
+           cgroup_event_file_name((CgroupEventFile)e->file), e->key, (unsigned long long)e->value,
+           (long long)e->delta);
+}
+
+static void print_agent_cgroup_event_header(void) {
+    printf("%-10s | %-14s | %-12s | %-12s | %s\n", "TEMPO(s)", "ARQUIVO", "CHAVE", "VALOR", "DELTA");
+}
+
+static void print_agent_sample_header(void) {
+    printf("%-10s | %-7s | %-10s | %-12s | %-12s | %-7s\n",
+           "TEMPO(s)", "CPU%", "RSS(KB)", "IO_R_RATE", "IO_W_RATE", "THREADS");
+}
+
+// Cliente do agente (daemon): uma requisição por execução
+static int run_client(int argc, char *argv[]) {
+    if (argc < 3) {
+        print_client_usage(argv[0]);
+        return 1;
+    }
+    const char *cmd = argv[2];
+    int pid = (argc >= 4) ? atoi(argv[3]) : 0;
+    const char *cgroup = (argc >= 4) ? argv[3] : NULL;
+    bool cgroup_cmd = strstr(cmd, "cgroup") != NULL || strcmp(cmd, "events") == 0;
+    bool needs_pid = strcmp(cmd, "list") != 0 && strcmp(cmd, "shutdown") != 0 && !cgroup_cmd;
+    if (cgroup_cmd && strcmp(cmd, "cgroups") != 0 && !cgroup) {
+        fprintf(stderr, "Erro: '%s' requer um cgroup.\n", cmd);
+        print_client_usage(argv[0]);
+        return 1;
+    }
+    if (needs_pid && pid <= 0) {
+        fprintf(stderr, "Erro: '%s' requer um PID.\n", cmd);
+        print_client_usage(argv[0]);
+        return 1;
+    }
+
+    AgentClient client;
+    if (!agent_client_connect(&client, agent_socket_path())) return 1;
+    bool ok = false;
+
+    if (strcmp(cmd, "watch") == 0) {
+        uint64_t interval = NSEC_PER_SEC;
+        if (argc >= 5 && !parse_duration_ns(argv[4], &interval)) {
+            fprintf(stderr, "Erro: Intervalo inválido '%s'.\n", argv[4]);
+        } else if ((ok = agent_client_watch(&client, pid, interval))) {
+            printf("PID %d observado pelo agente.\n", pid);
         }
+    } else if (strcmp(cmd, "unwatch") == 0) {
+        ok = agent_client_unwatch(&client, pid);
+    } else if (strcmp(cmd, "list") == 0) {
+        const AgentTargetInfo *targets;
+        uint32_t count;
+        if ((ok = agent_client_list(&client, &targets, &count))) {
+            printf("%-8s | %-10s | %-10s | %-10s | %-8s | %-10s\n",
+                   "PID", "ESTADO", "INTERVALO", "AMOSTRAS", "RETIDAS", "ASSINANTES");
+            for (uint32_t i = 0; i < count; i++) {
+                char interval_str[32];
+                format_duration_ns(targets[i].interval_ns, interval_str, sizeof(interval_str));
+                printf("%-8d | %-10s | %-10s | %-10llu | %-8u | %-10u\n", targets[i].pid,
+                       targets[i].ended ? "terminado" : "ativo", interval_str,
+                       (unsigned long long)targets[i].samples, targets[i].retained, targets[i].subscribers);
+            }
+        }
+    } else if (strcmp(cmd, "query") == 0) {
+        uint64_t window = 0;
+        uint32_t max = (argc >= 6) ? (uint32_t)strtoul(argv[5], NULL, 10) : 0;
+        const AgentSample *samples;
+        uint32_t count;
+        if (argc >= 5 && !parse_duration_ns(argv[4], &window)) {
+            fprintf(stderr, "Erro: Janela inválida '%s'.\n", argv[4]);
+        } else if ((ok = agent_client_query(&client, pid, window, max, &samples, &count))) {
+            print_agent_sample_header();
+            for (uint32_t i = 0; i < count; i++) print_agent_sample(&samples[i], samples[0].mono_ns);
+            printf("%u amostra(s).\n", count);
+        }
+    } else if (strcmp(cmd, "summary") == 0) {
+        AgentSummary summary;
+        if ((ok = agent_client_summary(&client, pid, &summary))) {
+            if (summary.metrics[SUMMARY_CPU_PERCENT].count == 0) printf("Ainda sem amostras com taxas.\n");
+            summary_stats_print(summary.metrics);
+        }
+    } else if (strcmp(cmd, "stream") == 0) {
+        long limit = (argc >= 5) ? atol(argv[4]) : 0;
+        if ((ok = agent_client_subscribe(&client, pid))) {
+            AgentSample s;
+            uint64_t base_ns = 0;
+            print_agent_sample_header();
+            for (long n = 0; (limit <= 0 || n < limit) && agent_client_next_sample(&client, &s); n++) {
+                if (n == 0) base_ns = s.mono_ns;
+                print_agent_sample(&s, base_ns);
+                fflush(stdout);
+            }
+        }
+    } else if (strcmp(cmd, "watch-cgroup") == 0) {
+        if ((ok = agent_client_watch_cgroup(&client, cgroup))) printf("Cgroup %s observado pelo agente.\n", cgroup);
+    } else if (strcmp(cmd, "unwatch-cgroup") == 0) {
+        ok = agent_client_unwatch_cgroup(&client, cgroup);
+    } else if (strcmp(cmd, "cgroups") == 0) {
+        const AgentCgroupInfo *cgroups;
+        uint32_t count;
+        if ((ok = agent_client_list_cgroups(&client, &cgroups, &count))) {
+            printf("%-32s | %-10s | %-10s | %-8s | %-10s\n", "CGROUP", "ESTADO", "EVENTOS", "RETIDOS", "ASSINANTES");
+            for (uint32_t i = 0; i < count; i++) {
+                printf("%-32.32s | %-10s | %-10llu | %-8u | %-10u\n", cgroups[i].path,
+                       cgroups[i].removed ? "removido" : "ativo", (unsigned long long)cgroups[i].events,
+                       cgroups[i].retained, cgroups[i].subscribers);
+            }
+        }
+    } else if (strcmp(cmd, "events") == 0) {
+        const AgentCgroupEvent *events;
+        uint32_t count;
+        if ((ok = agent_client_query_cgroup(&client, cgroup, &events, &count))) {
+            print_agent_cgroup_event_header();
+            for (uint32_t i = 0; i < count; i++) print_agent_cgroup_event(&events[i], events[0].mono_ns);
+            printf("%u evento(s).\n", count);
+        }
+    } else if (strcmp(cmd, "stream-cgroup") == 0) {
+        long limit = (argc >= 5) ? atol(argv[4]) : 0;
+        if ((ok = agent_client_subscribe_cgroup(&client, cgroup))) {
+            AgentCgroupEvent e;
+            uint64_t base_ns = monotonic_ns();
+            print_agent_cgroup_event_header();
+            for (long n = 0; (limit <= 0 || n < limit) && agent_client_next_cgroup_event(&client, &e); n++) {
+                print_agent_cgroup_event(&e, base_ns);
+                fflush(stdout);
+                if (strcmp(e.key, "removed") == 0) break;
+            }
+        }
+    } else if (strcmp(cmd, "shutdown") == 0) {
+        ok = agent_client_shutdown(&client);
+    } else {
+        fprintf(stderr, "Erro: Comando do cliente desconhecido '%s'.\n", cmd);
+        print_client_usage(argv[0]);
     }
 
-    // Exportar dados
-    export_to_json(history, num_samples, "output/monitor_output.json");
+    agent_client_close(&client);
+    return ok ? 0 : 1;
+}
 
-    free(history);
+// O teto do --adaptive precisa ficar acima do intervalo pedido (o mínimo)
+static bool check_adaptive_ceiling(uint64_t ceiling_ns, uint64_t interval_ns) {
+    if (ceiling_ns == 0 || ceiling_ns > interval_ns) return true;
+    char ceiling_str[32], interval_str[32];
+    format_duration_ns(ceiling_ns, ceiling_str, sizeof(ceiling_str));
+    format_duration_ns(interval_ns, interval_str, sizeof(interval_str));
+    fprintf(stderr, "Erro: Teto do --adaptive (%s) deve ser maior que o intervalo (%s).\n", ceiling_str,
+            interval_str);
+    return false;
 }
 
 int main(int argc, char *argv[]) {
+    uint64_t adaptive_ceiling = 0;  // --adaptive; 0 = intervalo fixo
+
+    // Opções globais antes do comando: --backend proc|taskstats, --adaptive <teto>
+    while (argc >= 2 && strncmp(argv[1], "--", 2) == 0) {
+        if (strcmp(argv[1], "--backend") == 0) {
+            CollectBackend backend;
+            if (argc < 3 || !collect_backend_parse(argv[2], &backend)) {
+                fprintf(stderr, "Erro: Backend inválido '%s'. Use proc ou taskstats.\n", (argc >= 3) ? argv[2] : "");
+                return 1;
+            }
+            collect_backend_set(backend);
+        } else if (strcmp(argv[1], "--adaptive") == 0) {
+            if (argc < 3 || !parse_duration_ns(argv[2], &adaptive_ceiling) || adaptive_ceiling == 0) {
+                fprintf(stderr, "Erro: Teto inválido '%s'. Use, por exemplo, 10s ou 500ms.\n", (argc >= 3) ? argv[2] : "");
+                return 1;
+            }
+        } else {
+            break;
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+
     if (argc < 2) {
         print_usage(argv[0]);
         return 1;
@@ -866,46 +1282,145 @@ int main(int argc, char *argv[]) {
         return 0;
 
     } else if (strcmp(command, "monitor") == 0) {
+        // Modo multi-processo: "all" ou "--pids a,b,c" antes de intervalo e duração
+        bool all = (argc == 5 && strcmp(argv[2], "all") == 0);
+        bool pid_list = (argc == 6 && strcmp(argv[2], "--pids") == 0);
+        if (all || pid_list) {
+            uint64_t interval, duration;
+            if (!parse_interval_args(argv[argc - 2], argv[argc - 1], &interval, &duration)) {
+                return 1;
+            }
+            if (all) {
+                monitor_processes_continuous(NULL, 0, interval, duration);
+            } else {
+                int *pids = NULL;
+                int npids = parse_pid_list(argv[3], &pids);
+                if (npids <= 0) {
+                    fprintf(stderr, "Erro: Lista de PIDs inválida '%s'. Use --pids a,b,c\n", argv[3]);
+                    return 1;
+                }
+                monitor_processes_continuous(pids, npids, interval, duration);
+                free(pids);
+            }
+            return 0;
+        }
         if (argc != 5) {
             fprintf(stderr, "Erro: 'monitor' requer PID, intervalo (s) e duração (s).\n");
             print_usage(argv[0]);
             return 1;
         }
         int pid = atoi(argv[2]);
-        int interval = atoi(argv[3]);
-        int duration = atoi(argv[4]);
-        run_monitor(pid, interval, duration);
+        uint64_t interval, duration;
+        if (!parse_interval_args(argv[3], argv[4], &interval, &duration) ||
+            !check_adaptive_ceiling(adaptive_ceiling, interval)) {
+            return 1;
+        }
+        run_monitor(pid, interval, duration, adaptive_ceiling);
 
     } else if (strcmp(command, "process") == 0) {
-        if (argc != 6) {
-            fprintf(stderr, "Erro: 'process' requer PID, intervalo (s), duração (s) e formato (json/csv).\n");
-            fprintf(stderr, "Uso: %s process <pid> <intervalo_s> <duracao_s> <json|csv>\n", argv[0]);
+        if (argc != 6 && argc != 7) {
+            fprintf(stderr, "Erro: 'process' requer PID, intervalo (s), duração (s) e formato (json/ndjson/csv/bin).\n");
+            fprintf(stderr, "Uso: %s process <pid> <intervalo> <duracao> <json|ndjson|csv|bin> [retencao]\n", argv[0]);
             fprintf(stderr, "Exemplo: %s process 1234 5 60 json\n", argv[0]);
             return 1;
         }
         int pid = atoi(argv[2]);
-        int interval = atoi(argv[3]);
-        int duration = atoi(argv[4]);
+        uint64_t interval, duration;
+        if (!parse_interval_args(argv[3], argv[4], &interval, &duration)) {
+            return 1;
+        }
         const char *format = argv[5];
         
-        if (strcmp(format, "json") != 0 && strcmp(format, "csv") != 0) {
-            fprintf(stderr, "Erro: Formato inválido '%s'. Use 'json' ou 'csv'.\n", format);
+        ExportFormat parsed_format;
+        if (!export_format_parse(format, &parsed_format)) {
+            fprintf(stderr, "Erro: Formato inválido '%s'. Use 'json', 'ndjson', 'csv' ou 'bin'.\n", format);
             return 1;
         }
         
-        monitor_process_continuous(pid, interval, duration, format);
+        // Retenção opcional: máximo de amostras mantidas em memória para o resumo
+        size_t retention = 0;
+        if (argc == 7) {
+            long value = atol(argv[6]);
+            if (value <= 0) {
+                fprintf(stderr, "Erro: Retenção inválida '%s'.\n", argv[6]);
+                return 1;
+            }
+            retention = (size_t)value;
+        }
+        
+        if (!check_adaptive_ceiling(adaptive_ceiling, interval)) {
+            return 1;
+        }
+        monitor_process_continuous(pid, interval, duration, format, retention, adaptive_ceiling);
+
+    } else if (strcmp(command, "dump") == 0) {
+        if (argc != 4 && argc != 5) {
+            fprintf(stderr, "Erro: 'dump' requer o arquivo .rmts e o formato (json/csv).\n");
+            fprintf(stderr, "Uso: %s dump <arquivo.rmts> <json|csv> [saida]\n", argv[0]);
+            return 1;
+        }
+        return tsdb_dump(argv[2], argv[3], (argc == 5) ? argv[4] : NULL) ? 0 : 1;
 
     } else if (strcmp(command, "tui") == 0) {
         if (argc < 3 || argc > 5) {
             fprintf(stderr, "Erro: 'tui' requer PID e opcionalmente intervalo e duração.\n");
-            fprintf(stderr, "Uso: %s tui <pid> [intervalo_s] [duracao_s]\n", argv[0]);
+            fprintf(stderr, "Uso: %s tui <pid> [intervalo] [duracao]\n", argv[0]);
             return 1;
         }
         int pid = atoi(argv[2]);
-        int interval = (argc >= 4) ? atoi(argv[3]) : 0;
-        int duration = (argc >= 5) ? atoi(argv[4]) : 0;
+        uint64_t interval = 0, duration = 0;
+        if (argc >= 4 && !parse_duration_ns(argv[3], &interval)) {
+            fprintf(stderr, "Erro: Intervalo inválido '%s'.\n", argv[3]);
+            return 1;
+        }
+        if (argc >= 5 && !parse_duration_ns(argv[4], &duration)) {
+            fprintf(stderr, "Erro: Duração inválida '%s'.\n", argv[4]);
+            return 1;
+        }
         return run_tui(pid, interval, duration);
 
+    } else if (strcmp(command, "top") == 0) {
+        // top [cgroup <caminho> | ns <tipo> <pid>] [intervalo]
+        int arg = 2;
+        ProcFilterFn filter = NULL;
+        void *filter_arg = NULL;
+        ProcNamespaceFilter ns_filter;
+        char filter_desc[300];
+        if (arg < argc && strcmp(argv[arg], "cgroup") == 0) {
+            if (arg + 1 >= argc) {
+                fprintf(stderr, "Uso: %s top cgroup <caminho> [intervalo]\n", argv[0]);
+                return 1;
+            }
+            filter = proc_filter_cgroup;
+            filter_arg = argv[arg + 1];
+            snprintf(filter_desc, sizeof(filter_desc), "cgroup %s", argv[arg + 1]);
+            arg += 2;
+        } else if (arg < argc && strcmp(argv[arg], "ns") == 0) {
+            if (arg + 2 >= argc) {
+                fprintf(stderr, "Uso: %s top ns <net|pid|mnt|uts|ipc|user|cgroup> <pid> [intervalo]\n", argv[0]);
+                return 1;
+            }
+            if (!proc_namespace_filter_init(&ns_filter, argv[arg + 1], atoi(argv[arg + 2]))) {
+                fprintf(stderr, "Erro: Namespace '%s' do PID %s inválido.\n", argv[arg + 1], argv[arg + 2]);
+                return 1;
+            }
+            filter = proc_filter_namespace;
+            filter_arg = &ns_filter;
+            snprintf(filter_desc, sizeof(filter_desc), "%s namespace of PID %s (inode %lu)",
+                     argv[arg + 1], argv[arg + 2], (unsigned long)ns_filter.inode);
+            arg += 3;
+        }
+        uint64_t interval = 0;
+        if (arg < argc && !parse_duration_ns(argv[arg++], &interval)) {
+            fprintf(stderr, "Erro: Intervalo inválido '%s'.\n", argv[arg - 1]);
+            return 1;
+        }
+        if (arg < argc) {
+            fprintf(stderr, "Uso: %s top [cgroup <caminho> | ns <tipo> <pid>] [intervalo]\n", argv[0]);
+            return 1;
+        }
+        return run_top_tui(filter, filter_arg, filter ? filter_desc : NULL, interval) == 0 ? 0 : 1;
+
     } else if (strcmp(command, "namespace") == 0) {
         if (argc < 3) {
             fprintf(stderr, "Erro: O comando 'namespace' requer um subcomando.\n");
@@ -934,13 +1449,70 @@ int main(int argc, char *argv[]) {
         } else if (strcmp(subcommand, "report") == 0) {
             generate_system_namespace_report("output/namespace_report.json");
         } else if (strcmp(subcommand, "overhead") == 0) {
-            measure_namespace_creation_overhead();
+            int reps = argc > 3 ? atoi(argv[3]) : NS_LATENCY_DEFAULT_REPS;
+            int warmup = argc > 4 ? atoi(argv[4]) : NS_LATENCY_DEFAULT_WARMUP;
+            int flags;
+            for (int arg = 5; arg < argc; arg++) {
+                if (!ns_latency_parse_set(argv[arg], &flags)) {
+                    fprintf(stderr, "Erro: Conjunto de namespaces inválido: %s\n", argv[arg]);
+                    return 1;
+                }
+            }
+            if (reps <= 0 || warmup < 0) {
+                fprintf(stderr, "Uso: %s namespace overhead [repeticoes] [aquecimento] [tipo[+tipo...]]...\n", argv[0]);
+                return 1;
+            }
+            if (!run_namespace_latency_benchmark((const char **)argv + 5, argc > 5 ? argc - 5 : 0, reps, warmup,
+                                                 "output/namespace_latency.json")) {
+                return 1;
+            }
         } else {
             fprintf(stderr, "Subcomando de namespace desconhecido: %s\n", subcommand);
             print_usage(argv[0]);
             return 1;
         }
 
+    } else if (strcmp(command, "daemon") == 0) {
+        AgentConfig cfg = { .socket_path = agent_socket_path(), .retention = AGENT_DEFAULT_RETENTION };
+        int positional = 0;
+        for (int arg = 2; arg < argc; arg++) {
+            bool has_value = arg + 1 < argc;
+            if (strcmp(argv[arg], "--http") == 0 && has_value) {
+                cfg.http_address = argv[++arg];
+            } else if (strcmp(argv[arg], "--refresh") == 0 && has_value) {
+                if (!parse_duration_ns(argv[++arg], &cfg.refresh_ns) || cfg.refresh_ns == 0) {
+                    fprintf(stderr, "Erro: Intervalo inválido '%s'.\n", argv[arg]);
+                    return 1;
+                }
+            } else if (strcmp(argv[arg], "--cgroup") == 0 && has_value) {
+                if (cfg.num_cgroups == AGENT_MAX_CGROUPS) {
+                    fprintf(stderr, "Erro: No máximo %d cgroups.\n", AGENT_MAX_CGROUPS);
+                    return 1;
+                }
+                cfg.cgroups[cfg.num_cgroups++] = argv[++arg];
+            } else if (argv[arg][0] != '-' && positional == 0) {
+                cfg.socket_path = argv[arg];
+                positional++;
+            } else if (argv[arg][0] != '-' && positional == 1) {
+                cfg.retention = (size_t)strtoul(argv[arg], NULL, 10);
+                positional++;
+            } else {
+                fprintf(stderr, "Uso: %s daemon [--http <endereco>] [--refresh <intervalo>] "
+                        "[--cgroup <caminho>]... [socket] [retencao]\n", argv[0]);
+                fprintf(stderr, "  endereco: host:porta, :porta (127.0.0.1) ou /caminho/socket (ex.: %s)\n",
+                        HTTP_DEFAULT_ADDRESS);
+                return 1;
+            }
+        }
+        if ((cfg.num_cgroups > 0 || cfg.refresh_ns > 0) && !cfg.http_address) {
+            fprintf(stderr, "Erro: --refresh e --cgroup exigem --http.\n");
+            return 1;
+        }
+        return agent_run(&cfg) ? 0 : 1;
+
+    } else if (strcmp(command, "client") == 0) {
+        return run_client(argc, argv);
+
     } else if (strcmp(command, "experiment") == 0) {
         if (argc != 3) {
             fprintf(stderr, "Erro: O comando 'experiment' requer um número (1-5).\n");
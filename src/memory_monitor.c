@@ -1,4 +1,6 @@
 #include "../include/monitor.h"
+#include "../include/proc_parse.h"
+#include "../include/timing.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,60 +8,63 @@
 #include <unistd.h>
 
 // Lê métricas do /proc/[pid]/statm
-static bool read_statm_metrics(int pid, ResourceData *data) {
-    char filepath[256];
-    snprintf(filepath, sizeof(filepath), "/proc/%d/statm", pid);
-
-    FILE *fp = fopen(filepath, "r");
-    if (fp == NULL) {
+static bool read_statm_metrics(ProcHandle *h, ResourceData *data) {
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_STATM, &len);
+    ProcStatm st;
+    if (buf == NULL || !proc_parse_statm(buf, len, &st)) {
         return false;
     }
 
     // Campos: size (VSZ), resident (RSS)
     // Valores em páginas.
-    long vsz_pages;
-    fscanf(fp, "%ld %ld", &vsz_pages, &data->memory_rss);
-    fclose(fp);
+    data->memory_rss = st.resident;
 
     // Converte VSZ de páginas para KB
     long page_size_kb = sysconf(_SC_PAGESIZE) / 1024;
-    data->memory_vsz = vsz_pages * page_size_kb;
+    data->memory_vsz = st.size * page_size_kb;
 
     return true;
 }
 
 // Lê métricas do /proc/[pid]/status
-static bool read_status_metrics(int pid, ResourceData *data) {
-    char filepath[256];
-    snprintf(filepath, sizeof(filepath), "/proc/%d/status", pid);
+static bool read_status_metrics(ProcHandle *h, ResourceData *data) {
+    data->memory_swap = 0; // Inicializa caso não encontre
 
-    FILE *fp = fopen(filepath, "r");
-    if (fp == NULL) {
+    // Mesmo buffer já lido por get_cpu_data_handle na amostra atual
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_STATUS, &len);
+    ProcStatus st;
+    if (buf == NULL || !proc_parse_status(buf, len, &st)) {
         return false;
     }
 
-    char line[256];
-    data->memory_swap = 0; // Inicializa caso não encontre
-    while (fgets(line, sizeof(line), fp)) {
-        if (strncmp(line, "VmSwap:", 7) == 0) {
-            sscanf(line + 8, "%ld", &data->memory_swap);
-        }
-    }
-
-    fclose(fp);
+    data->memory_swap = st.vm_swap_kb;
+    data->num_threads = (long)st.threads;
     return true;
 }
 
-bool get_memory_data(int pid, ResourceData *data) {
-    data->pid = pid;
-    data->timestamp = time(NULL);
+bool get_memory_data_handle(ProcHandle *h, ResourceData *data) {
+    data->pid = h->pid;
+    TIMING_STAMP(data);
 
-    if (!read_statm_metrics(pid, data)) {
+    if (!read_statm_metrics(h, data)) {
         return false;
     }
-    if (!read_status_metrics(pid, data)) {
+    if (!read_status_metrics(h, data)) {
         // Process might have died, but we have statm data
     }
 
     return true;
 }
+
+bool get_memory_data(int pid, ResourceData *data) {
+    ProcHandle h = {0};
+    if (!proc_handle_open(&h, pid)) {
+        proc_handle_close(&h);
+        return false;
+    }
+    bool ok = get_memory_data_handle(&h, data);
+    proc_handle_close(&h);
+    return ok;
+}
@@ -0,0 +1,330 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/metrics_store.h"
+
+// ---------- Dicionário de entidades ----------
+
+static uint32_t entity_hash(int pid, const char *name) {
+    // FNV-1a sobre o nome, misturado com o PID
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return (h ^ (uint32_t)pid) * 2654435761u;
+}
+
+// Bloco k começa no id ENTITY_CHUNK_SIZE * (2^k - 1)
+static inline uint32_t entity_chunk(uint32_t id) {
+    return 31 - (uint32_t)__builtin_clz(id / ENTITY_CHUNK_SIZE + 1);
+}
+
+static inline uint32_t entity_chunk_start(uint32_t chunk) {
+    return ENTITY_CHUNK_SIZE * ((1u << chunk) - 1);
+}
+
+static EntityName *entity_slot(const EntityDict *d, uint32_t id) {
+    uint32_t chunk = entity_chunk(id);
+    return &d->chunks[chunk][id - entity_chunk_start(chunk)];
+}
+
+static bool entity_matches(const EntityName *e, int pid, const char *name) {
+    return e->pid == pid && strncmp(e->name, name, ENTITY_NAME_LEN) == 0;
+}
+
+static bool entity_index_grow(EntityDict *d) {
+    size_t cap = d->index_cap ? d->index_cap * 2 : 64;
+    uint32_t *index = calloc(cap, sizeof(uint32_t));
+    if (!index) return false;
+
+    uint32_t count = atomic_load_explicit(&d->count, memory_order_relaxed);
+    for (uint32_t id = 0; id < count; id++) {
+        EntityName *e = entity_slot(d, id);
+        size_t i = entity_hash(e->pid, e->name) & (cap - 1);
+        while (index[i]) i = (i + 1) & (cap - 1);
+        index[i] = id + 1;
+    }
+
+    free(d->index);
+    d->index = index;
+    d->index_cap = cap;
+    return true;
+}
+
+uint32_t entity_intern(EntityDict *d, int pid, const char *name) {
+    uint32_t count = atomic_load_explicit(&d->count, memory_order_relaxed);
+
+    // Caso comum: histórico de um único processo
+    if (d->last_id < count && entity_matches(entity_slot(d, d->last_id), pid, name)) {
+        return d->last_id;
+    }
+
+    if (d->index_cap) {
+        size_t i = entity_hash(pid, name) & (d->index_cap - 1);
+        while (d->index[i]) {
+            uint32_t id = d->index[i] - 1;
+            if (entity_matches(entity_slot(d, id), pid, name)) {
+                d->last_id = id;
+                return id;
+            }
+            i = (i + 1) & (d->index_cap - 1);
+        }
+    }
+
+    if (count >= entity_chunk_start(ENTITY_MAX_CHUNKS) ||
+        (((size_t)count + 1) * 2 > d->index_cap && !entity_index_grow(d))) {
+        d->dropped++;
+        return ENTITY_INVALID;
+    }
+
+    uint32_t chunk = entity_chunk(count);
+    if (!d->chunks[chunk]) {
+        d->chunks[chunk] = calloc((size_t)ENTITY_CHUNK_SIZE << chunk, sizeof(EntityName));
+        if (!d->chunks[chunk]) {
+            d->dropped++;
+            return ENTITY_INVALID;
+        }
+    }
+
+    EntityName *e = entity_slot(d, count);
+    e->pid = pid;
+    strncpy(e->name, name, ENTITY_NAME_LEN - 1);
+    e->name[ENTITY_NAME_LEN - 1] = '\0';
+
+    size_t i = entity_hash(pid, e->name) & (d->index_cap - 1);
+    while (d->index[i]) i = (i + 1) & (d->index_cap - 1);
+    d->index[i] = count + 1;
+
+    // Publica a entrada só depois de preenchida
+    atomic_store_explicit(&d->count, count + 1, memory_order_release);
+    d->last_id = count;
+    return count;
+}
+
+const EntityName *entity_get(const EntityDict *d, uint32_t id) {
+    uint32_t count = atomic_load_explicit(&((EntityDict *)d)->count, memory_order_acquire);
+    if (id >= count) return NULL;
+    return entity_slot(d, id);
+}
+
+static void entity_dict_free(EntityDict *d) {
+    for (int i = 0; i < ENTITY_MAX_CHUNKS; i++) free(d->chunks[i]);
+    free(d->index);
+    memset(d, 0, sizeof(EntityDict));
+}
+
+// ---------- Colunas ----------
+
+// Descrição de cada coluna: onde fica o ponteiro no store e a
+// largura do elemento. Todas as colunas saem de um único bloco.
+typedef struct {
+    size_t offset;
+    size_t width;
+} ColumnDesc;
+
+#define COLUMN(field) { offsetof(MetricsStore, field), sizeof(*((MetricsStore *)0)->field) }
+
+static const ColumnDesc columns[] = {
+    // 8 bytes
+    COLUMN(mono_ns), COLUMN(real_ns), COLUMN(interval_ns),
+    COLUMN(cpu_user), COLUMN(cpu_system),
+    COLUMN(ctx_voluntary), COLUMN(ctx_nonvoluntary),
+    COLUMN(mem_vsize), COLUMN(mem_rss), COLUMN(mem_shared),
+    COLUMN(faults_minor), COLUMN(faults_major), COLUMN(mem_swap_kb),
+    COLUMN(io_read_bytes), COLUMN(io_write_bytes), COLUMN(io_cancelled_bytes),
+    COLUMN(io_read_syscalls), COLUMN(io_write_syscalls),
+    COLUMN(net_rx_bytes), COLUMN(net_tx_bytes),
+    COLUMN(net_rx_packets), COLUMN(net_tx_packets),
+    COLUMN(net_rx_queue), COLUMN(net_tx_queue),
+    // 4 bytes
+    COLUMN(entity), COLUMN(cpu_percent), COLUMN(threads),
+    COLUMN(io_read_kbs), COLUMN(io_write_kbs), COLUMN(net_connections),
+};
+
+#define NUM_COLUMNS (sizeof(columns) / sizeof(columns[0]))
+
+#define THREAD_COLUMN(field) { offsetof(ThreadStore, field), sizeof(*((ThreadStore *)0)->field) }
+
+static const ColumnDesc thread_columns[] = {
+    // 8 bytes
+    THREAD_COLUMN(mono_ns), THREAD_COLUMN(cpu_user), THREAD_COLUMN(cpu_system),
+    THREAD_COLUMN(ctx_voluntary), THREAD_COLUMN(ctx_nonvoluntary),
+    // 4 bytes
+    THREAD_COLUMN(entity), THREAD_COLUMN(pid), THREAD_COLUMN(cpu_percent),
+    THREAD_COLUMN(ctx_rate), THREAD_COLUMN(processor),
+    // 1 byte
+    THREAD_COLUMN(state),
+};
+
+#define NUM_THREAD_COLUMNS (sizeof(thread_columns) / sizeof(thread_columns[0]))
+
+size_t metrics_store_row_bytes(void) {
+    size_t bytes = sizeof(uint64_t);  // seqlock do slot
+    for (size_t c = 0; c < NUM_COLUMNS; c++) bytes += columns[c].width;
+    return bytes;
+}
+
+// Aloca o ring e todas as colunas de store num único bloco. As colunas
+// vêm em ordem decrescente de largura na tabela, então todas ficam alinhadas.
+static bool columns_init(void *store, RingBuffer *seq, void **block,
+                         const ColumnDesc *cols, size_t ncols, size_t retention) {
+    if (!ring_init(seq, retention, 0)) return false;
+
+    size_t cap = seq->capacity;
+    size_t total = 0;
+    for (size_t c = 0; c < ncols; c++) total += cap * cols[c].width;
+
+    *block = calloc(1, total);
+    if (!*block) {
+        ring_free(seq);
+        return false;
+    }
+
+    unsigned char *p = *block;
+    for (size_t c = 0; c < ncols; c++) {
+        *(void **)((unsigned char *)store + cols[c].offset) = p;
+        p += cap * cols[c].width;
+    }
+    return true;
+}
+
+bool metrics_store_init(MetricsStore *s, size_t retention) {
+    memset(s, 0, sizeof(MetricsStore));
+    if (!columns_init(s, &s->seq, &s->block, columns, NUM_COLUMNS, retention)) return false;
+    atomic_init(&s->entities.count, 0);
+    return true;
+}
+
+void metrics_store_free(MetricsStore *s) {
+    if (!s) return;
+    ring_free(&s->seq);
+    free(s->block);
+    entity_dict_free(&s->entities);
+    s->block = NULL;
+}
+
+bool thread_store_init(ThreadStore *s, size_t retention) {
+    memset(s, 0, sizeof(ThreadStore));
+    if (!columns_init(s, &s->seq, &s->block, thread_columns, NUM_THREAD_COLUMNS, retention)) return false;
+    atomic_init(&s->entities.count, 0);
+    return true;
+}
+
+void thread_store_free(ThreadStore *s) {
+    if (!s) return;
+    ring_free(&s->seq);
+    free(s->block);
+    entity_dict_free(&s->entities);
+    s->block = NULL;
+}
+
+// ---------- Agregados ----------
+
+const char *metric_name(MetricId id) {
+    switch (id) {
+        case METRIC_CPU_PERCENT:  return "cpu_percent";
+        case METRIC_MEM_RSS:      return "memory_rss";
+        case METRIC_MEM_VSIZE:    return "memory_vsize";
+        case METRIC_THREADS:      return "threads";
+        case METRIC_IO_READ_KBS:  return "io_read_kbs";
+        case METRIC_IO_WRITE_KBS: return "io_write_kbs";
+        default:                  return "?";
+    }
+}
+
+// Converte slots [from, from + n) da coluna para double. Loops separados
+// por tipo para o compilador vetorizar a conversão.
+static void gather_column(const MetricsStore *s, MetricId id, size_t from, size_t n, double *out) {
+    switch (id) {
+        case METRIC_CPU_PERCENT:
+            for (size_t i = 0; i < n; i++) out[i] = s->cpu_percent[from + i];
+            break;
+        case METRIC_MEM_RSS:
+            for (size_t i = 0; i < n; i++) out[i] = (double)s->mem_rss[from + i];
+            break;
+        case METRIC_MEM_VSIZE:
+            for (size_t i = 0; i < n; i++) out[i] = (double)s->mem_vsize[from + i];
+            break;
+        case METRIC_THREADS:
+            for (size_t i = 0; i < n; i++) out[i] = s->threads[from + i];
+            break;
+        case METRIC_IO_READ_KBS:
+            for (size_t i = 0; i < n; i++) out[i] = s->io_read_kbs[from + i];
+            break;
+        case METRIC_IO_WRITE_KBS:
+            for (size_t i = 0; i < n; i++) out[i] = s->io_write_kbs[from + i];
+            break;
+        default:
+            break;
+    }
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Percentil por ranking mais próximo sobre valores já ordenados
+static double percentile(const double *sorted, size_t n, double p) {
+    size_t rank = (size_t)(p * (double)n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+bool metrics_store_stats(const MetricsStore *s, MetricId id, MetricStats *out) {
+    memset(out, 0, sizeof(MetricStats));
+    if (id < 0 || id >= METRIC_COUNT || !s->block) return false;
+
+    uint64_t head = ring_head(&s->seq);
+    uint64_t oldest = ring_oldest(&s->seq);
+    size_t n = (size_t)(head - oldest);
+    if (n == 0) return false;
+
+    double *values = malloc(n * sizeof(double));
+    if (!values) return false;
+
+    // A janela ocupa no máximo dois trechos contíguos de cada coluna
+    size_t first = ring_slot(&s->seq, oldest);
+    size_t run = s->seq.capacity - first;
+    if (run > n) run = n;
+    gather_column(s, id, first, run, values);
+    gather_column(s, id, 0, n - run, values + run);
+
+    // Descarta linhas que o produtor reutilizou durante a cópia. Além das
+    // posições já sobrescritas, o slot mais antigo restante pode estar em
+    // escrita agora (é o slot da posição head2): confirma pelo seqlock.
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t head2 = ring_head(&s->seq);
+    uint64_t safe = (head2 > s->seq.capacity) ? head2 - s->seq.capacity : 0;
+    if (safe < oldest) safe = oldest;
+    if (safe < head && !ring_read_validate(&s->seq, safe, ring_slot(&s->seq, safe))) safe++;
+    size_t skip = (safe - oldest > n) ? n : (size_t)(safe - oldest);
+    double *v = values + skip;
+    n -= skip;
+    if (n == 0) {
+        free(values);
+        return false;
+    }
+
+    double sum = 0.0, min = v[0], max = v[0];
+    for (size_t i = 0; i < n; i++) {
+        sum += v[i];
+        if (v[i] < min) min = v[i];
+        if (v[i] > max) max = v[i];
+    }
+
+    qsort(v, n, sizeof(double), compare_double);
+
+    out->count = n;
+    out->min = min;
+    out->max = max;
+    out->avg = sum / (double)n;
+    out->p50 = percentile(v, n, 0.50);
+    out->p95 = percentile(v, n, 0.95);
+    out->p99 = percentile(v, n, 0.99);
+
+    free(values);
+    return true;
+}
@@ -4,30 +4,36 @@
  * Data: 14 de novembro de 2025
  */
 
+#define _GNU_SOURCE
 #include <ncurses.h>
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
 #include "monitor.h"
 #include "network.h"
 #include "namespace.h"
 #include "cgroup.h"
 #include "utils.h"
+#include "timing.h"
+#include "ring_buffer.h"
+#include "stream_export.h"
+#include "stats.h"
+#include "proc_scanner.h"
+#include "thread_table.h"
+#include "resource_collector.h"
+#include "monitor_tui.h"
 
-#define REFRESH_INTERVAL 1 // segundos
+#define REFRESH_INTERVAL_NS NSEC_PER_SEC // intervalo padrão: 1s
 #define MAX_HISTORY 60     // manter 60 amostras de histórico
 
-// Estrutura para histórico de métricas
-typedef struct {
-    double cpu_history[MAX_HISTORY];
-    double mem_history[MAX_HISTORY];
-    double io_read_history[MAX_HISTORY];
-    double io_write_history[MAX_HISTORY];
-    int history_index;
-    int history_count;
-} MetricsHistory;
-
 // Cores
 enum {
     COLOR_PAIR_TITLE = 1,
@@ -61,56 +67,183 @@ void draw_window_border(WINDOW *win, const char *title) {
     }
 }
 
-// Desenhar barra de progresso
-void draw_progress_bar(WINDOW *win, int y, int x, int width, double percent) {
-    int filled = (int)(width * percent / 100.0);
-    if (filled > width) filled = width;
+// ---------- Widgets com renderização diferencial ----------
+//
+// Cada widget guarda o que está na tela. A cada quadro só as células cujo
+// conteúdo mudou são reescritas; moldura e rótulos fixos só são desenhados
+// em um redesenho completo (primeiro quadro, após ajuda/erro, resize).
+
+#define TEXT_WIDGET_MAX 160
+#define TUI_SUMMARY_WIDTH 58        // colunas do bloco de resumo estatístico
+#define SPARK_MAX_WIDTH MAX_HISTORY
+#define SPARK_HEIGHT 4
+
+// Texto de largura variável numa posição fixa
+typedef struct {
+    int y, x;
+    int len;                        // caracteres na tela
+    char text[TEXT_WIDGET_MAX];
+} TextWidget;
+
+// Barra de progresso: só as células entre o preenchimento antigo e o novo mudam
+typedef struct {
+    int y, x, width;
+    int filled;                     // -1 = nada desenhado
+} BarWidget;
+
+// Sparkline que rola uma coluna por amostra. O máximo da janela (escala) é
+// mantido por um WindowMax: O(1) amortizado por amostra, sem varrer o
+// histórico.
+typedef struct {
+    int y, x, width;
+    double values[SPARK_MAX_WIDTH]; // janela circular (últimas width amostras)
+    uint64_t pushed;                // total de amostras recebidas
+    WindowMax max;
+    int heights[SPARK_MAX_WIDTH];   // altura desenhada em cada coluna (-1 = nada)
+} Sparkline;
+
+_Static_assert(SPARK_MAX_WIDTH <= WINDOW_MAX_LEN, "Sparkline: janela maior que o WindowMax");
+
+enum {
+    FIELD_PID, FIELD_THREADS, FIELD_TIME,
+    FIELD_CPU_PERCENT, FIELD_CPU_USER, FIELD_CPU_SYSTEM, FIELD_CTX_VOL, FIELD_CTX_INVOL,
+    FIELD_VSZ, FIELD_RSS, FIELD_SWAP, FIELD_PF_MINOR, FIELD_PF_MAJOR,
+    FIELD_IO_READ, FIELD_IO_WRITE, FIELD_SYSCALLS_READ, FIELD_SYSCALLS_WRITE,
+    FIELD_NET_RX, FIELD_NET_TX,
+    FIELD_DELAY_CPU, FIELD_DELAY_BLKIO, FIELD_DELAY_SWAPIN, FIELD_DELAY_FREEPAGES,
+    FIELD_CPU_SCALE, FIELD_RSS_SCALE,
+    FIELD_SUM_COUNT, FIELD_SUM_CPU, FIELD_SUM_RSS, FIELD_SUM_IO_READ, FIELD_SUM_IO_WRITE,
+    FIELD_DEBUG,
+    FIELD_COUNT
+};
+
+typedef struct {
+    WINDOW *win;
+    bool full_redraw;
+    bool show_sparklines;           // terminal largo o bastante
+    bool delays;                    // backend taskstats: delay accounting disponível
+    bool show_delays;               // ... e cabe à direita de I/O e rede
+    bool show_summary;              // resumo estatístico cabe na coluna da direita
+    TextWidget fields[FIELD_COUNT];
+    BarWidget cpu_bar;
+    Sparkline cpu_spark;
+    Sparkline rss_spark;
+    uint64_t next_pos;              // próxima posição do ring a consumir
     
-    wmove(win, y, x);
-    wattron(win, COLOR_PAIR(COLOR_PAIR_GRAPH));
-    for (int i = 0; i < filled; i++) {
-        waddch(win, ACS_CKBOARD);
-    }
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_GRAPH));
+    // Overlay de depuração ('d')
+    bool debug;
+    int cells;                      // células escritas no quadro atual
+    uint64_t frames;
+    uint64_t last_render_ns;
+    uint64_t total_render_ns;
+    uint64_t max_render_ns;
+} TuiView;
+
+static void text_widget_set(TuiView *v, int id, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+// Escreve só a partir do primeiro caractere diferente do que está na tela
+// (apagando sobras do texto anterior). Retorna quantas células escreveu.
+static int text_widget_draw(WINDOW *win, TextWidget *w, const char *text) {
+    int len = (int)strnlen(text, TEXT_WIDGET_MAX - 1);
+    int first = 0;
+    while (first < len && first < w->len && text[first] == w->text[first]) first++;
+    int end = (len > w->len) ? len : w->len;
+    if (first == end) return 0;
     
-    wattron(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    for (int i = filled; i < width; i++) {
-        waddch(win, '-');
+    wmove(win, w->y, w->x + first);
+    for (int i = first; i < end; i++) {
+        waddch(win, (i < len) ? (chtype)(unsigned char)text[i] : ' ');
     }
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    
-    // Mostrar porcentagem
-    mvwprintw(win, y, x + width + 1, "%6.2f%%", percent);
+    memcpy(w->text, text, (size_t)len);
+    w->text[len] = '\0';
+    w->len = len;
+    return end - first;
 }
 
-// Desenhar gráfico ASCII simples
-void draw_mini_graph(WINDOW *win, int y, int x, int width, int height, 
-                     double *data, int data_count, const char *label) {
-    if (data_count == 0) return;
+static void text_widget_set(TuiView *v, int id, const char *fmt, ...) {
+    char text[TEXT_WIDGET_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(text, sizeof(text), fmt, ap);
+    va_end(ap);
+    v->cells += text_widget_draw(v->win, &v->fields[id], text);
+}
+
+static void bar_widget_set(TuiView *v, BarWidget *b, double percent) {
+    int filled = (int)(b->width * percent / 100.0);
+    if (filled > b->width) filled = b->width;
+    if (filled < 0) filled = 0;
+    if (filled == b->filled) return;
     
-    // Encontrar máximo
-    double max_val = 0.0;
-    for (int i = 0; i < data_count; i++) {
-        if (data[i] > max_val) max_val = data[i];
+    int from = (b->filled < 0) ? 0 : (filled < b->filled ? filled : b->filled);
+    int to = (b->filled < 0) ? b->width : (filled > b->filled ? filled : b->filled);
+    wmove(v->win, b->y, b->x + from);
+    for (int i = from; i < to; i++) {
+        if (i < filled) {
+            waddch(v->win, ACS_CKBOARD | COLOR_PAIR(COLOR_PAIR_GRAPH));
+        } else {
+            waddch(v->win, '-' | COLOR_PAIR(COLOR_PAIR_DATA));
+        }
     }
-    if (max_val == 0.0) max_val = 1.0;
-    
-    // Desenhar label
-    wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER));
-    mvwprintw(win, y, x, "%s", label);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER));
+    v->cells += to - from;
+    b->filled = filled;
+}
+
+static void sparkline_reset(Sparkline *sp, int y, int x, int width) {
+    memset(sp, 0, sizeof(Sparkline));
+    sp->y = y;
+    sp->x = x;
+    sp->width = (width > SPARK_MAX_WIDTH) ? SPARK_MAX_WIDTH : width;
+    window_max_init(&sp->max, sp->width);
+    for (int i = 0; i < SPARK_MAX_WIDTH; i++) sp->heights[i] = -1;
+}
+
+// Invalida o que está na tela, mantendo os valores
+static void sparkline_invalidate(Sparkline *sp) {
+    for (int i = 0; i < SPARK_MAX_WIDTH; i++) sp->heights[i] = -1;
+}
+
+static void sparkline_push(Sparkline *sp, double value) {
+    if (sp->width <= 0) return;
+    uint64_t pos = sp->pushed++;
+    sp->values[pos % (uint64_t)sp->width] = value;
+    window_max_add(&sp->max, value);
+}
+
+static double sparkline_max(const Sparkline *sp) {
+    return window_max_get(&sp->max);
+}
+
+// Desenha só as células das colunas cuja altura mudou. A coluna mais à
+// direita é a amostra mais recente.
+static void sparkline_render(TuiView *v, Sparkline *sp) {
+    if (sp->width <= 0) return;
+    double scale = sparkline_max(sp);
+    if (scale <= 0.0) scale = 1.0;
     
-    // Desenhar gráfico
-    wattron(win, COLOR_PAIR(COLOR_PAIR_GRAPH));
-    for (int i = 0; i < width && i < data_count; i++) {
-        int bar_height = (int)(height * data[i] / max_val);
-        if (bar_height > height) bar_height = height;
+    uint64_t count = (sp->pushed < (uint64_t)sp->width) ? sp->pushed : (uint64_t)sp->width;
+    for (int col = 0; col < sp->width; col++) {
+        int h = 0;
+        uint64_t age = (uint64_t)(sp->width - 1 - col);   // 0 = mais recente
+        if (age < count) {
+            double val = sp->values[(sp->pushed - 1 - age) % (uint64_t)sp->width];
+            h = (int)(SPARK_HEIGHT * val / scale + 0.5);
+            if (h > SPARK_HEIGHT) h = SPARK_HEIGHT;
+            if (h < 0) h = 0;
+        }
+        int old = sp->heights[col];
+        if (h == old) continue;
         
-        for (int h = 0; h < bar_height; h++) {
-            mvwaddch(win, y + height - h, x + i, ACS_CKBOARD);
+        // Linhas entre a altura antiga e a nova (todas, se nada desenhado)
+        int lo = (old < 0) ? 0 : (h < old ? h : old);
+        int hi = (old < 0) ? SPARK_HEIGHT : (h > old ? h : old);
+        for (int r = lo; r < hi; r++) {
+            chtype ch = (r < h) ? (ACS_CKBOARD | COLOR_PAIR(COLOR_PAIR_GRAPH)) : ' ';
+            mvwaddch(v->win, sp->y + SPARK_HEIGHT - 1 - r, sp->x + col, ch);
         }
+        v->cells += hi - lo;
+        sp->heights[col] = h;
     }
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_GRAPH));
 }
 
 // Formatar bytes para legibilidade
@@ -126,126 +259,234 @@ void format_bytes(char *buf, size_t buf_size, unsigned long long bytes) {
     }
 }
 
-// Tela principal - Overview
-void draw_overview_screen(WINDOW *win, ResourceData *snapshot, MetricsHistory *history) {
-    int max_y, max_x __attribute__((unused));
+static void draw_label(WINDOW *win, int y, int x, const char *text, bool header) {
+    int attr = header ? (COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD) : COLOR_PAIR(COLOR_PAIR_DATA);
+    wattron(win, attr);
+    mvwprintw(win, y, x, "%s", text);
+    wattroff(win, attr);
+}
+
+static void place_field(TuiView *v, int id, int y, int x) {
+    v->fields[id].y = y;
+    v->fields[id].x = x;
+    v->fields[id].len = 0;
+    v->fields[id].text[0] = '\0';
+}
+
+// Moldura, rótulos fixos e posição de cada widget
+static void view_layout(TuiView *v) {
+    WINDOW *win = v->win;
+    int max_y, max_x;
     getmaxyx(win, max_y, max_x);
     
     werase(win);
     draw_window_border(win, "Resource Monitor - Overview");
     
-    int row = 2;
+    // Rótulos: (linha, coluna, texto, cabeçalho?, campo de valor ou -1)
+    static const struct { int y, x; const char *text; bool header; int field; } labels[] = {
+        {  2, 2, "Process Information:", true, -1 },
+        {  3, 4, "PID: ", false, FIELD_PID },
+        {  4, 4, "Threads: ", false, FIELD_THREADS },
+        {  5, 4, "Time: ", false, FIELD_TIME },
+        {  7, 2, "CPU Usage:", true, -1 },
+        {  8, 4, "Total: ", false, -1 },
+        {  9, 4, "User: ", false, FIELD_CPU_USER },
+        { 10, 4, "System: ", false, FIELD_CPU_SYSTEM },
+        { 11, 4, "Context Switches (vol): ", false, FIELD_CTX_VOL },
+        { 12, 4, "Context Switches (invol): ", false, FIELD_CTX_INVOL },
+        { 14, 2, "Memory Usage:", true, -1 },
+        { 15, 4, "VSZ: ", false, FIELD_VSZ },
+        { 16, 4, "RSS: ", false, FIELD_RSS },
+        { 17, 4, "Swap: ", false, FIELD_SWAP },
+        { 18, 4, "Page Faults (minor): ", false, FIELD_PF_MINOR },
+        { 19, 4, "Page Faults (major): ", false, FIELD_PF_MAJOR },
+        { 21, 2, "I/O Statistics:", true, -1 },
+        { 22, 4, "Read: ", false, FIELD_IO_READ },
+        { 23, 4, "Write: ", false, FIELD_IO_WRITE },
+        { 24, 4, "Syscalls (read): ", false, FIELD_SYSCALLS_READ },
+        { 25, 4, "Syscalls (write): ", false, FIELD_SYSCALLS_WRITE },
+        { 27, 2, "Network Statistics:", true, -1 },
+        { 28, 4, "RX: ", false, FIELD_NET_RX },
+        { 29, 4, "TX: ", false, FIELD_NET_TX },
+    };
+    for (size_t i = 0; i < sizeof(labels) / sizeof(labels[0]); i++) {
+        draw_label(win, labels[i].y, labels[i].x, labels[i].text, labels[i].header);
+        if (labels[i].field >= 0) {
+            place_field(v, labels[i].field, labels[i].y, labels[i].x + (int)strlen(labels[i].text));
+        }
+    }
     
-    // Informações do processo
-    wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
-    mvwprintw(win, row++, 2, "Process Information:");
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    v->cpu_bar = (BarWidget){ .y = 8, .x = 12, .width = 40, .filled = -1 };
+    place_field(v, FIELD_CPU_PERCENT, 8, 12 + 40 + 1);
     
-    wattron(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    mvwprintw(win, row++, 4, "PID: %d", snapshot->pid);
-    mvwprintw(win, row++, 4, "Threads: %ld", snapshot->num_threads);
+    // Sparklines à direita, se couberem
+    int spark_x = 70;
+    int spark_width = max_x - spark_x - 2;
+    if (spark_width > SPARK_MAX_WIDTH) spark_width = SPARK_MAX_WIDTH;
+    v->show_sparklines = spark_width >= 10;
+    if (v->show_sparklines) {
+        draw_label(win, 7, spark_x, "CPU % (max ", true);
+        place_field(v, FIELD_CPU_SCALE, 7, spark_x + 11);
+        draw_label(win, 14, spark_x, "RSS (max ", true);
+        place_field(v, FIELD_RSS_SCALE, 14, spark_x + 9);
+        
+        // Largura mudou (resize): recomeça a janela; senão só redesenha
+        if (v->cpu_spark.width != spark_width) {
+            sparkline_reset(&v->cpu_spark, 9, spark_x, spark_width);
+            sparkline_reset(&v->rss_spark, 16, spark_x, spark_width);
+        } else {
+            sparkline_invalidate(&v->cpu_spark);
+            sparkline_invalidate(&v->rss_spark);
+        }
+    }
     
-    // Formatar timestamp em hora legível
-    char time_str[64];
-    struct tm *tm_info = localtime(&snapshot->timestamp);
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", tm_info);
-    mvwprintw(win, row++, 4, "Time: %s (unix: %ld)", time_str, snapshot->timestamp);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
+    // Delays acumulados (taskstats), na coluna das sparklines
+    v->show_delays = v->delays && max_x - spark_x >= 40;
+    if (v->show_delays) {
+        static const struct { const char *text; int field; } delays[] = {
+            { "Run queue: ", FIELD_DELAY_CPU },
+            { "Block I/O: ", FIELD_DELAY_BLKIO },
+            { "Swap-in: ", FIELD_DELAY_SWAPIN },
+            { "Reclaim: ", FIELD_DELAY_FREEPAGES },
+        };
+        draw_label(win, 21, spark_x, "Delays (taskstats):", true);
+        for (int i = 0; i < 4; i++) {
+            draw_label(win, 22 + i, spark_x + 2, delays[i].text, false);
+            place_field(v, delays[i].field, 22 + i, spark_x + 2 + (int)strlen(delays[i].text));
+        }
+    }
     
-    row++;
+    // Resumo da captura (estatísticas incrementais), abaixo dos delays se couber
+    int sum_y = v->show_delays ? 27 : 21;
+    v->show_summary = max_x - spark_x >= TUI_SUMMARY_WIDTH && sum_y + 5 < max_y - 3;
+    if (v->show_summary) {
+        static const struct { const char *text; int field; } rows[] = {
+            { "CPU %", FIELD_SUM_CPU },
+            { "RSS MB", FIELD_SUM_RSS },
+            { "Rd KB/s", FIELD_SUM_IO_READ },
+            { "Wr KB/s", FIELD_SUM_IO_WRITE },
+        };
+        draw_label(win, sum_y, spark_x, "Summary (samples: ", true);
+        place_field(v, FIELD_SUM_COUNT, sum_y, spark_x + 18);
+        draw_label(win, sum_y + 1, spark_x + 2, "           mean    ewma     p50     p95     p99     max", false);
+        for (int i = 0; i < 4; i++) {
+            draw_label(win, sum_y + 2 + i, spark_x + 2, rows[i].text, false);
+            place_field(v, rows[i].field, sum_y + 2 + i, spark_x + 9);
+        }
+    }
     
-    // CPU
-    wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
-    mvwprintw(win, row++, 2, "CPU Usage:");
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    // Rodapé com instruções
+    wattron(win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    mvwprintw(win, max_y - 2, 2, "[q] Quit  [r] Refresh  [h] Help  [d] Debug");
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    place_field(v, FIELD_DEBUG, max_y - 3, 2);
     
-    mvwprintw(win, row++, 4, "Total: ");
-    draw_progress_bar(win, row - 1, 12, 40, snapshot->cpu_usage_percent);
+    v->full_redraw = false;
+}
+
+// Atualiza os widgets com o snapshot; só células alteradas são escritas
+static void view_update(TuiView *v, const ResourceData *snapshot) {
+    char buf[64];
     
-    wattron(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    mvwprintw(win, row++, 4, "User: %ld jiffies", snapshot->cpu_user);
-    mvwprintw(win, row++, 4, "System: %ld jiffies", snapshot->cpu_system);
-    mvwprintw(win, row++, 4, "Context Switches (vol): %ld", snapshot->voluntary_context_switches);
-    mvwprintw(win, row++, 4, "Context Switches (invol): %ld", snapshot->nonvoluntary_context_switches);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    text_widget_set(v, FIELD_PID, "%d", snapshot->pid);
+    text_widget_set(v, FIELD_THREADS, "%ld", snapshot->num_threads);
     
-    row++;
+    // Formatar timestamp em hora legível
+    char time_str[64];
+    struct tm *tm_info = localtime(&snapshot->timestamp);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", tm_info);
+    text_widget_set(v, FIELD_TIME, "%s (unix: %ld)", time_str, snapshot->timestamp);
     
-    // Memória
-    wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
-    mvwprintw(win, row++, 2, "Memory Usage:");
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    text_widget_set(v, FIELD_CPU_PERCENT, "%6.2f%%", snapshot->cpu_usage_percent);
+    text_widget_set(v, FIELD_CPU_USER, "%ld jiffies", snapshot->cpu_user);
+    text_widget_set(v, FIELD_CPU_SYSTEM, "%ld jiffies", snapshot->cpu_system);
+    text_widget_set(v, FIELD_CTX_VOL, "%ld", snapshot->voluntary_context_switches);
+    text_widget_set(v, FIELD_CTX_INVOL, "%ld", snapshot->nonvoluntary_context_switches);
     
-    char mem_buf[64];
     unsigned long long vsz_bytes = snapshot->memory_vsz * 1024ULL;
     unsigned long long rss_bytes = snapshot->memory_rss * 4096ULL; // Assumindo 4KB pages
+    format_bytes(buf, sizeof(buf), vsz_bytes);
+    text_widget_set(v, FIELD_VSZ, "%s", buf);
+    format_bytes(buf, sizeof(buf), rss_bytes);
+    text_widget_set(v, FIELD_RSS, "%s", buf);
+    format_bytes(buf, sizeof(buf), snapshot->memory_swap * 1024ULL);
+    text_widget_set(v, FIELD_SWAP, "%s", buf);
+    text_widget_set(v, FIELD_PF_MINOR, "%ld", snapshot->page_faults_minor);
+    text_widget_set(v, FIELD_PF_MAJOR, "%ld", snapshot->page_faults_major);
     
-    format_bytes(mem_buf, sizeof(mem_buf), vsz_bytes);
-    wattron(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    mvwprintw(win, row++, 4, "VSZ: %s", mem_buf);
-    
-    format_bytes(mem_buf, sizeof(mem_buf), rss_bytes);
-    mvwprintw(win, row++, 4, "RSS: %s", mem_buf);
-    
-    format_bytes(mem_buf, sizeof(mem_buf), snapshot->memory_swap * 1024ULL);
-    mvwprintw(win, row++, 4, "Swap: %s", mem_buf);
-    
-    mvwprintw(win, row++, 4, "Page Faults (minor): %ld", snapshot->page_faults_minor);
-    mvwprintw(win, row++, 4, "Page Faults (major): %ld", snapshot->page_faults_major);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    
-    row++;
-    
-    // I/O
-    wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
-    mvwprintw(win, row++, 2, "I/O Statistics:");
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
-    
-    format_bytes(mem_buf, sizeof(mem_buf), snapshot->io_read_bytes);
-    wattron(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    mvwprintw(win, row++, 4, "Read: %s (%.2f MB/s)", mem_buf, snapshot->io_read_rate / (1024.0 * 1024.0));
-    
-    format_bytes(mem_buf, sizeof(mem_buf), snapshot->io_write_bytes);
-    mvwprintw(win, row++, 4, "Write: %s (%.2f MB/s)", mem_buf, snapshot->io_write_rate / (1024.0 * 1024.0));
-    
-    mvwprintw(win, row++, 4, "Syscalls (read): %lld", snapshot->io_read_syscalls);
-    mvwprintw(win, row++, 4, "Syscalls (write): %lld", snapshot->io_write_syscalls);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    
-    row++;
-    
-    // Network
-    wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
-    mvwprintw(win, row++, 2, "Network Statistics:");
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
-    
-    format_bytes(mem_buf, sizeof(mem_buf), snapshot->net_rx_bytes);
-    wattron(win, COLOR_PAIR(COLOR_PAIR_DATA));
-    mvwprintw(win, row++, 4, "RX: %s (%lld packets)", mem_buf, snapshot->net_rx_packets);
-    
-    format_bytes(mem_buf, sizeof(mem_buf), snapshot->net_tx_bytes);
-    mvwprintw(win, row++, 4, "TX: %s (%lld packets)", mem_buf, snapshot->net_tx_packets);
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
+    format_bytes(buf, sizeof(buf), snapshot->io_read_bytes);
+    text_widget_set(v, FIELD_IO_READ, "%s (%.2f MB/s)", buf, snapshot->io_read_rate / (1024.0 * 1024.0));
+    format_bytes(buf, sizeof(buf), snapshot->io_write_bytes);
+    text_widget_set(v, FIELD_IO_WRITE, "%s (%.2f MB/s)", buf, snapshot->io_write_rate / (1024.0 * 1024.0));
+    text_widget_set(v, FIELD_SYSCALLS_READ, "%lld", snapshot->io_read_syscalls);
+    text_widget_set(v, FIELD_SYSCALLS_WRITE, "%lld", snapshot->io_write_syscalls);
     
-    // Atualizar histórico
-    if (history) {
-        history->cpu_history[history->history_index] = snapshot->cpu_usage_percent;
-        history->mem_history[history->history_index] = (double)rss_bytes / (1024.0 * 1024.0); // MB
-        history->io_read_history[history->history_index] = snapshot->io_read_rate / (1024.0 * 1024.0); // MB/s
-        history->io_write_history[history->history_index] = snapshot->io_write_rate / (1024.0 * 1024.0); // MB/s
-        
-        history->history_index = (history->history_index + 1) % MAX_HISTORY;
-        if (history->history_count < MAX_HISTORY) {
-            history->history_count++;
-        }
+    char queue[32];
+    format_bytes(buf, sizeof(buf), snapshot->net_rx_bytes);
+    format_bytes(queue, sizeof(queue), snapshot->net_rx_queue);
+    text_widget_set(v, FIELD_NET_RX, "%s (%lld packets, queue %s)", buf, snapshot->net_rx_packets, queue);
+    format_bytes(buf, sizeof(buf), snapshot->net_tx_bytes);
+    format_bytes(queue, sizeof(queue), snapshot->net_tx_queue);
+    text_widget_set(v, FIELD_NET_TX, "%s (%lld packets, queue %s)", buf, snapshot->net_tx_packets, queue);
+    if (v->show_delays) {
+        text_widget_set(v, FIELD_DELAY_CPU, "%.3f ms", snapshot->cpu_delay_ns / 1e6);
+        text_widget_set(v, FIELD_DELAY_BLKIO, "%.3f ms", snapshot->blkio_delay_ns / 1e6);
+        text_widget_set(v, FIELD_DELAY_SWAPIN, "%.3f ms", snapshot->swapin_delay_ns / 1e6);
+        text_widget_set(v, FIELD_DELAY_FREEPAGES, "%.3f ms", snapshot->freepages_delay_ns / 1e6);
     }
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
     
-    // Rodapé com instruções
-    wattron(win, COLOR_PAIR(COLOR_PAIR_WARNING));
-    mvwprintw(win, max_y - 2, 2, "[q] Quit  [r] Refresh  [h] Help");
-    wattroff(win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    bar_widget_set(v, &v->cpu_bar, snapshot->cpu_usage_percent);
     
-    wrefresh(win);
+    if (v->show_sparklines) {
+        wattron(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+        text_widget_set(v, FIELD_CPU_SCALE, "%.1f%%)", sparkline_max(&v->cpu_spark));
+        format_bytes(buf, sizeof(buf), (unsigned long long)sparkline_max(&v->rss_spark));
+        text_widget_set(v, FIELD_RSS_SCALE, "%s)", buf);
+        wattroff(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+        sparkline_render(v, &v->cpu_spark);
+        sparkline_render(v, &v->rss_spark);
+    }
+}
+
+// Resumo publicado pela coletora: uma cópia pronta das métricas
+typedef struct {
+    SummaryStats metrics[SUMMARY_COUNT];
+} SummarySnapshot;
+
+static void view_update_summary(TuiView *v, const SummarySnapshot *s) {
+    static const struct { int field; double scale; } rows[SUMMARY_COUNT] = {
+        [SUMMARY_CPU_PERCENT]  = { FIELD_SUM_CPU, 1.0 },
+        [SUMMARY_RSS_BYTES]    = { FIELD_SUM_RSS, 1024.0 * 1024.0 },
+        [SUMMARY_IO_READ_BPS]  = { FIELD_SUM_IO_READ, 1024.0 },
+        [SUMMARY_IO_WRITE_BPS] = { FIELD_SUM_IO_WRITE, 1024.0 },
+    };
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    text_widget_set(v, FIELD_SUM_COUNT, "%llu)", (unsigned long long)s->metrics[0].count);
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    for (int i = 0; i < SUMMARY_COUNT; i++) {
+        const SummaryStats *st = &s->metrics[i];
+        double k = rows[i].scale;
+        text_widget_set(v, rows[i].field, "%8.1f%8.1f%8.1f%8.1f%8.1f%8.1f", st->mean / k, st->ewma / k,
+                        st->p50 / k, st->p95 / k, st->p99 / k, st->max / k);
+    }
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+}
+
+// Overlay de depuração: tempo de renderização do último quadro
+static void view_debug_overlay(TuiView *v) {
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    if (v->debug) {
+        text_widget_set(v, FIELD_DEBUG, "render: %.1f us (media %.1f, max %.1f) | celulas: %d | quadros: %llu",
+                        v->last_render_ns / 1e3,
+                        v->frames ? v->total_render_ns / 1e3 / (double)v->frames : 0.0,
+                        v->max_render_ns / 1e3, v->cells, (unsigned long long)v->frames);
+    } else {
+        text_widget_set(v, FIELD_DEBUG, "%s", "");
+    }
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
 }
 
 // Tela de ajuda
@@ -263,11 +504,27 @@ void draw_help_screen(WINDOW *win) {
     mvwprintw(win, row++, 4, "q - Quit application");
     mvwprintw(win, row++, 4, "r - Force refresh");
     mvwprintw(win, row++, 4, "h - Show this help");
+    mvwprintw(win, row++, 4, "d - Toggle render debug overlay");
     mvwprintw(win, row++, 4, "ESC - Return to overview");
     wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
     
     row++;
     
+    wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    mvwprintw(win, row++, 2, "Top (all processes):");
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    
+    wattron(win, COLOR_PAIR(COLOR_PAIR_DATA));
+    mvwprintw(win, row++, 4, "c/m/i/x/f - Sort by CPU, RSS, I/O, context switches, page faults");
+    mvwprintw(win, row++, 4, "p/n - Sort by PID, name (same key again reverses)");
+    mvwprintw(win, row++, 4, "o - Reverse order");
+    mvwprintw(win, row++, 4, "/ - Incremental search by name or PID (Enter keeps, ESC clears)");
+    mvwprintw(win, row++, 4, "Up/Down/PgUp/PgDn/Home - Move selection");
+    mvwprintw(win, row++, 4, "Enter/t - Threads of the selected process (ESC returns)");
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_DATA));
+    
+    row++;
+    
     wattron(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
     mvwprintw(win, row++, 2, "About:");
     wattroff(win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
@@ -285,37 +542,309 @@ void draw_help_screen(WINDOW *win) {
     wattroff(win, COLOR_PAIR(COLOR_PAIR_WARNING));
     
     wrefresh(win);
+    
+    // A janela principal é não-bloqueante; aqui espera a tecla
+    wtimeout(win, -1);
     wgetch(win);
+    wtimeout(win, 0);
 }
 
-// Loop principal da TUI
-int run_tui(pid_t pid, int interval, int duration) {
+// Coleta uma amostra e calcula CPU% e taxas de I/O contra a anterior.
+// Retorna false se o processo não pôde ser lido.
+static bool collect_snapshot(ResourceCollector *collector, ResourceData *snapshot, ResourceData *prev_snapshot,
+                             bool *first_sample, long ticks_per_second) {
+    if (!resource_collector_sample(collector, snapshot)) {
+        return false;
+    }
+    
+    if (*first_sample) {
+        snapshot->cpu_usage_percent = 0.0;
+        snapshot->io_read_rate = 0.0;
+        snapshot->io_write_rate = 0.0;
+        *first_sample = false;
+    } else {
+        // Delta de tempo no relógio monotônico (válido para intervalos < 1s)
+        double time_delta_sec = (double)(snapshot->mono_ns - prev_snapshot->mono_ns) / NSEC_PER_SEC;
+        if (time_delta_sec <= 0) {
+            // Duas leituras no mesmo instante (ex.: refresh manual): mantém as taxas
+            snapshot->cpu_usage_percent = prev_snapshot->cpu_usage_percent;
+            snapshot->io_read_rate = prev_snapshot->io_read_rate;
+            snapshot->io_write_rate = prev_snapshot->io_write_rate;
+        } else {
+            // Calcular CPU%
+            long total_cpu_time_diff = (snapshot->cpu_user + snapshot->cpu_system) - 
+                                      (prev_snapshot->cpu_user + prev_snapshot->cpu_system);
+            snapshot->cpu_usage_percent = 100.0 * (total_cpu_time_diff / (double)ticks_per_second) / time_delta_sec;
+            
+            // Calcular taxas de I/O
+            snapshot->io_read_rate = (snapshot->io_read_bytes - prev_snapshot->io_read_bytes) / time_delta_sec;
+            snapshot->io_write_rate = (snapshot->io_write_bytes - prev_snapshot->io_write_bytes) / time_delta_sec;
+        }
+    }
+    
+    // Armazenar dados anteriores para próximo cálculo
+    *prev_snapshot = *snapshot;
+    return true;
+}
+
+// Tela de erro quando o processo não pode mais ser lido
+static void draw_error_screen(WINDOW *win, pid_t pid) {
+    werase(win);
+    draw_window_border(win, "Error");
+    
+    wattron(win, COLOR_PAIR(COLOR_PAIR_ERROR) | A_BOLD);
+    mvwprintw(win, 2, 2, "Failed to read process statistics!");
+    mvwprintw(win, 3, 2, "Process PID %d may have terminated.", pid);
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_ERROR) | A_BOLD);
+    
+    wattron(win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    mvwprintw(win, 5, 2, "Press 'q' to quit...");
+    wattroff(win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    
+    wrefresh(win);
+}
+
+// Thread de coleta: amostra no ritmo do temporizador e publica cada
+// snapshot no ring (seqlock por slot), sem depender do terminal. A
+// interface só é avisada pelo eventfd notify_fd.
+typedef struct {
+    pid_t pid;
+    uint64_t interval_ns;
+    ResourceCollector *collector; // aberto antes do ncurses (avisos no stderr)
+    RingBuffer *history;        // escrito só pela coletora
+    MetricsSummary summary;     // da coletora; lido pela interface só após a parada
+    RingBuffer *summaries;      // SummarySnapshot após cada amostra com taxas
+    StreamExporter *exporter;   // NULL fora do modo temporizado
+    uint64_t max_export;        // amostras exportadas no modo temporizado
+    int notify_fd;              // coletora -> interface: nova amostra
+    int wake_fd;                // interface -> coletora: refresh ou parada
+    atomic_bool stop;
+    atomic_bool failed;         // última coleta falhou (processo encerrado?)
+    bool started;
+    pthread_t thread;
+} TuiSampler;
+
+static void eventfd_signal(int fd) {
+    uint64_t one = 1;
+    ssize_t n = write(fd, &one, sizeof(one));
+    (void)n; // contador cheio: já há aviso pendente
+}
+
+static void eventfd_drain(int fd) {
+    uint64_t count;
+    ssize_t n = read(fd, &count, sizeof(count));
+    (void)n;
+}
+
+static void *sampler_main(void *arg) {
+    TuiSampler *s = arg;
     ResourceData snapshot = {0};
     ResourceData prev_snapshot = {0};
-    MetricsHistory history = {0};
     bool first_sample = true;
     long ticks_per_second = sysconf(_SC_CLK_TCK);
     
+    // Prazos absolutos em CLOCK_MONOTONIC: nem a coleta nem o desenho atrasam o agendamento
+    SampleTimer timer;
+    if (!sample_timer_start(&timer, s->interval_ns)) {
+        atomic_store(&s->failed, true);
+        eventfd_signal(s->notify_fd);
+        return NULL;
+    }
+    
+    struct pollfd fds[2] = {
+        { .fd = timer.fd,   .events = POLLIN },
+        { .fd = s->wake_fd, .events = POLLIN },
+    };
+    
+    bool sample_now = true; // primeira amostra imediata
+    while (!atomic_load(&s->stop)) {
+        if (sample_now) {
+            sample_now = false;
+            bool has_rates = !first_sample;
+            uint64_t prev_ns = prev_snapshot.mono_ns;
+            if (collect_snapshot(s->collector, &snapshot, &prev_snapshot, &first_sample, ticks_per_second)) {
+                ring_push(s->history, &snapshot);
+                // Refresh no mesmo instante repete as taxas: não entra no resumo
+                if (has_rates && snapshot.mono_ns > prev_ns) {
+                    metrics_summary_add(&s->summary, snapshot.cpu_usage_percent,
+                                        snapshot.memory_rss * 4096.0, snapshot.io_read_rate,
+                                        snapshot.io_write_rate, snapshot.mono_ns - prev_ns);
+                    SummarySnapshot published;
+                    for (int i = 0; i < SUMMARY_COUNT; i++) {
+                        metric_summary_get(&s->summary.metrics[i], &published.metrics[i]);
+                    }
+                    ring_push(s->summaries, &published);
+                }
+                // Exportar (no modo temporizado, até max_export)
+                if (s->exporter && s->exporter->appended < s->max_export) {
+                    stream_export_append(s->exporter, &snapshot);
+                }
+                atomic_store(&s->failed, false);
+            } else {
+                atomic_store(&s->failed, true);
+            }
+            eventfd_signal(s->notify_fd);
+        }
+        
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            if (sample_timer_wait(&timer) > 0) sample_now = true;
+        }
+        if (fds[1].revents & POLLIN) {
+            // Refresh manual ('r') ou pedido de parada
+            eventfd_drain(s->wake_fd);
+            sample_now = true;
+        }
+    }
+    
+    sample_timer_close(&timer);
+    return NULL;
+}
+
+static bool sampler_start(TuiSampler *s) {
+    s->notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    s->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    atomic_init(&s->stop, false);
+    atomic_init(&s->failed, false);
+    s->started = false;
+    // SIGWINCH só na thread da interface: é ela que precisa sair do poll
+    // com EINTR para ler o KEY_RESIZE (a máscara é herdada pela thread)
+    sigset_t winch, old;
+    sigemptyset(&winch);
+    sigaddset(&winch, SIGWINCH);
+    pthread_sigmask(SIG_BLOCK, &winch, &old);
+    int err = (s->notify_fd < 0 || s->wake_fd < 0) ? -1 : pthread_create(&s->thread, NULL, sampler_main, s);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (err != 0) {
+        perror("Falha ao iniciar a thread de coleta");
+        if (s->notify_fd >= 0) close(s->notify_fd);
+        if (s->wake_fd >= 0) close(s->wake_fd);
+        return false;
+    }
+    s->started = true;
+    return true;
+}
+
+static void sampler_stop(TuiSampler *s) {
+    if (!s->started) return;
+    atomic_store(&s->stop, true);
+    eventfd_signal(s->wake_fd);
+    pthread_join(s->thread, NULL);
+    close(s->notify_fd);
+    close(s->wake_fd);
+    s->started = false;
+}
+
+// Desenha um quadro: consome as amostras novas do ring nas sparklines e
+// atualiza os widgets com a mais recente, escrevendo só o que mudou
+static void draw_latest(TuiView *v, TuiSampler *s) {
+    if (atomic_load(&s->failed)) {
+        // Processo pode ter terminado
+        draw_error_screen(v->win, s->pid);
+        v->full_redraw = true;
+        return;
+    }
+    
+    uint64_t head = ring_head(s->history);
+    if (head == 0) return;
+    
+    uint64_t t0 = monotonic_ns();
+    v->cells = 0;
+    if (v->full_redraw) view_layout(v);
+    
+    // Amostras publicadas desde o último quadro (as já sobrescritas são puladas)
+    uint64_t oldest = ring_oldest(s->history);
+    uint64_t pos = (v->next_pos > oldest) ? v->next_pos : oldest;
+    ResourceData snapshot;
+    bool have = false;
+    for (; pos < head; pos++) {
+        if (!ring_read(s->history, pos, &snapshot)) continue;
+        have = true;
+        sparkline_push(&v->cpu_spark, snapshot.cpu_usage_percent);
+        sparkline_push(&v->rss_spark, snapshot.memory_rss * 4096.0);
+    }
+    v->next_pos = head;
+    
+    if (!have && !ring_read_latest(s->history, &snapshot)) return;
+    view_update(v, &snapshot);
+    SummarySnapshot summary;
+    if (v->show_summary && ring_read_latest(s->summaries, &summary)) {
+        view_update_summary(v, &summary);
+    }
+    
+    v->last_render_ns = monotonic_ns() - t0;
+    v->total_render_ns += v->last_render_ns;
+    if (v->last_render_ns > v->max_render_ns) v->max_render_ns = v->last_render_ns;
+    v->frames++;
+    view_debug_overlay(v);
+    wrefresh(v->win);
+}
+
+// Loop principal da TUI: só desenha quando chega amostra nova ou tecla
+int run_tui(pid_t pid, uint64_t interval_ns, uint64_t duration_ns) {
     // Determinar modo de operação
-    bool timed_mode = (duration > 0);
-    int refresh_interval = (interval > 0) ? interval : REFRESH_INTERVAL;
+    bool timed_mode = (duration_ns > 0);
+    uint64_t refresh_ns = (interval_ns > 0) ? interval_ns : REFRESH_INTERVAL_NS;
     
-    // Alocar histórico para modo com tempo determinado
-    ResourceData *data_history = NULL;
-    int num_samples = 0;
-    int current_sample = 0;
+    // Histórico de snapshots em ring de retenção fixa: as últimas MAX_HISTORY
+    // amostras. No modo temporizado as amostras (até num_samples) são
+    // exportadas durante a coleta, sem depender do histórico.
+    uint64_t num_samples = 0;
     
     if (timed_mode) {
-        num_samples = duration / refresh_interval;
-        if (num_samples <= 0) {
+        num_samples = duration_ns / refresh_ns;
+        if (num_samples == 0) {
             fprintf(stderr, "Erro: Duração deve ser maior que o intervalo.\n");
             return -1;
         }
-        data_history = malloc(num_samples * sizeof(ResourceData));
-        if (data_history == NULL) {
-            perror("Falha ao alocar memória para o histórico");
-            return -1;
-        }
+    }
+    
+    RingBuffer history;
+    if (!ring_init(&history, MAX_HISTORY, sizeof(ResourceData))) {
+        perror("Falha ao alocar memória para o histórico");
+        return -1;
+    }
+    
+    // Só o resumo mais recente interessa; a folga evita disputa no seqlock
+    RingBuffer summaries;
+    if (!ring_init(&summaries, 4, sizeof(SummarySnapshot))) {
+        perror("Falha ao alocar memória para o resumo");
+        ring_free(&history);
+        return -1;
+    }
+    
+    const char *output_path = "output/monitor_output.json";
+    StreamExporter exporter;
+    if (timed_mode && !stream_export_open(&exporter, output_path, STREAM_RESOURCE_DATA, EXPORT_JSON)) {
+        ring_free(&summaries);
+        ring_free(&history);
+        return -1;
+    }
+    
+    // Aberto antes do ncurses: avisos de fallback para /proc vão ao terminal.
+    // PID inexistente não é erro aqui: a tela de erro informa.
+    ResourceCollector collector;
+    resource_collector_open(&collector, pid, collect_backend_get());
+    
+    TuiSampler sampler = {
+        .pid = pid,
+        .interval_ns = refresh_ns,
+        .collector = &collector,
+        .history = &history,
+        .summaries = &summaries,
+        .exporter = timed_mode ? &exporter : NULL,
+        .max_export = num_samples,
+    };
+    metrics_summary_init(&sampler.summary);
+    if (!sampler_start(&sampler)) {
+        resource_collector_close(&collector);
+        if (timed_mode) stream_export_close(&exporter);
+        ring_free(&summaries);
+        ring_free(&history);
+        return -1;
     }
     
     // Inicializar ncurses
@@ -336,121 +865,621 @@ int run_tui(pid_t pid, int interval, int duration) {
     getmaxyx(stdscr, max_y, max_x);
     WINDOW *main_win = newwin(max_y, max_x, 0, 0);
     keypad(main_win, TRUE);
-    wtimeout(main_win, 100); // 100ms timeout para wgetch
+    wtimeout(main_win, 0); // poll() decide quando há entrada
+    
+    TuiView view = { .win = main_win, .full_redraw = true,
+                     .delays = (collector.backend == COLLECT_BACKEND_TASKSTATS) };
+    
+    // Espera simultânea por teclado e por amostras novas (sem busy-wait)
+    struct pollfd fds[2] = {
+        { .fd = STDIN_FILENO,       .events = POLLIN },
+        { .fd = sampler.notify_fd,  .events = POLLIN },
+    };
     
     // Loop principal
     int running = 1;
-    time_t last_refresh = 0;
-    time_t start_time = time(NULL);
+    uint64_t start_ns = monotonic_ns();
     
     while (running) {
-        time_t now = time(NULL);
+        uint64_t elapsed_ns = monotonic_ns() - start_ns;
         
         // Verificar se alcançou duração máxima no modo temporizado
-        if (timed_mode && (now - start_time) >= duration) {
+        if (timed_mode && elapsed_ns >= duration_ns) {
             running = 0;
             break;
         }
         
-        // Atualizar dados se passou tempo suficiente
-        if (now - last_refresh >= refresh_interval) {
-            // Coletar dados do processo
-            snapshot.pid = pid;
-            snapshot.timestamp = now;
-            
-            if (get_cpu_data(pid, &snapshot) &&
-                get_memory_data(pid, &snapshot) &&
-                get_io_data(pid, &snapshot) &&
-                get_network_data(pid, &snapshot)) {
-                
-                // Calcular CPU%, taxas de I/O e taxas de rede
-                if (first_sample) {
-                    snapshot.cpu_usage_percent = 0.0;
-                    snapshot.io_read_rate = 0.0;
-                    snapshot.io_write_rate = 0.0;
-                    first_sample = false;
-                } else {
-                    // Calcular delta de tempo
-                    double time_delta_sec = difftime(snapshot.timestamp, prev_snapshot.timestamp);
-                    if (time_delta_sec <= 0) time_delta_sec = REFRESH_INTERVAL;
-                    
-                    // Calcular CPU%
-                    long total_cpu_time_diff = (snapshot.cpu_user + snapshot.cpu_system) - 
-                                              (prev_snapshot.cpu_user + prev_snapshot.cpu_system);
-                    snapshot.cpu_usage_percent = 100.0 * (total_cpu_time_diff / (double)ticks_per_second) / time_delta_sec;
-                    
-                    // Calcular taxas de I/O
-                    snapshot.io_read_rate = (snapshot.io_read_bytes - prev_snapshot.io_read_bytes) / time_delta_sec;
-                    snapshot.io_write_rate = (snapshot.io_write_bytes - prev_snapshot.io_write_bytes) / time_delta_sec;
-                }
-                
-                // Armazenar dados anteriores para próximo cálculo
-                prev_snapshot = snapshot;
-                
-                // Armazenar no histórico se em modo temporizado
-                if (timed_mode && current_sample < num_samples) {
-                    data_history[current_sample] = snapshot;
-                    current_sample++;
-                }
-                
-                // Desenhar tela
-                draw_overview_screen(main_win, &snapshot, &history);
-                last_refresh = now;
-            } else {
-                // Processo pode ter terminado
-                werase(main_win);
-                draw_window_border(main_win, "Error");
-                
-                wattron(main_win, COLOR_PAIR(COLOR_PAIR_ERROR) | A_BOLD);
-                mvwprintw(main_win, 2, 2, "Failed to read process statistics!");
-                mvwprintw(main_win, 3, 2, "Process PID %d may have terminated.", pid);
-                wattroff(main_win, COLOR_PAIR(COLOR_PAIR_ERROR) | A_BOLD);
-                
-                wattron(main_win, COLOR_PAIR(COLOR_PAIR_WARNING));
-                mvwprintw(main_win, 5, 2, "Press 'q' to quit...");
-                wattroff(main_win, COLOR_PAIR(COLOR_PAIR_WARNING));
-                
-                wrefresh(main_win);
-            }
+        int timeout_ms = -1;
+        if (timed_mode) {
+            timeout_ms = (int)((duration_ns - elapsed_ns) / NSEC_PER_MSEC) + 1;
         }
         
-        // Processar entrada do teclado
-        int ch = wgetch(main_win);
-        switch (ch) {
-            case 'q':
-            case 'Q':
-                running = 0;
-                break;
-            case 'r':
-            case 'R':
-                last_refresh = 0; // Forçar refresh imediato
-                break;
-            case 'h':
-            case 'H':
-                draw_help_screen(main_win);
-                last_refresh = 0; // Forçar refresh após voltar
-                break;
-            case 27: // ESC
-                // Voltar para overview (já é a tela padrão)
-                break;
+        int ready = poll(fds, 2, timeout_ms);
+        if (ready < 0 && errno != EINTR) break;
+        
+        if (ready > 0 && (fds[1].revents & POLLIN)) {
+            eventfd_drain(sampler.notify_fd);
+            draw_latest(&view, &sampler);
         }
         
-        usleep(50000); // 50ms sleep para não consumir CPU
+        // Processar entrada do teclado (consome tudo que o ncurses já tem em
+        // buffer). Lê mesmo sem POLLIN no stdin: o SIGWINCH interrompe o poll
+        // (EINTR) e o KEY_RESIZE só sai do wgetch; em modo nodelay não bloqueia.
+        int ch;
+        while (running && (ch = wgetch(main_win)) != ERR) {
+            switch (ch) {
+                case 'q':
+                case 'Q':
+                    running = 0;
+                    break;
+                case 'r':
+                case 'R':
+                    eventfd_signal(sampler.wake_fd); // Forçar coleta imediata
+                    break;
+                case 'h':
+                case 'H':
+                    // A coleta continua enquanto a ajuda está aberta
+                    draw_help_screen(main_win);
+                    view.full_redraw = true;
+                    draw_latest(&view, &sampler);
+                    break;
+                case 'd':
+                case 'D':
+                    // Overlay com o tempo de renderização por quadro
+                    view.debug = !view.debug;
+                    if (!view.full_redraw) {
+                        view_debug_overlay(&view);
+                        wrefresh(main_win);
+                    }
+                    break;
+                case KEY_RESIZE:
+                    getmaxyx(stdscr, max_y, max_x);
+                    wresize(main_win, max_y, max_x);
+                    view.full_redraw = true;
+                    draw_latest(&view, &sampler);
+                    break;
+                case 27: // ESC
+                    // Voltar para overview (já é a tela padrão)
+                    break;
+            }
+        }
     }
     
     // Cleanup
+    sampler_stop(&sampler);
+    resource_collector_close(&collector);
     delwin(main_win);
     endwin();
     
-    // Exportar dados se em modo temporizado
-    if (timed_mode && data_history != NULL && current_sample > 0) {
-        export_to_json(data_history, current_sample, "output/monitor_output.json");
+    // Fechar a exportação do modo temporizado
+    if (timed_mode) {
+        if (stream_export_close(&exporter)) {
+            printf("Dados de monitoramento exportados para '%s' (%llu amostras).\n",
+                   output_path, (unsigned long long)exporter.written);
+        } else {
+            fprintf(stderr, "Erro ao exportar dados para '%s'\n", output_path);
+        }
+        const char *summary_path = "output/monitor_summary.json";
+        if (sampler.summary.metrics[SUMMARY_CPU_PERCENT].stats.count > 0 &&
+            metrics_summary_export_json(&sampler.summary, pid, summary_path)) {
+            printf("Resumo estatístico exportado para '%s'.\n", summary_path);
+        }
     }
     
     // Liberar memória
-    if (data_history != NULL) {
-        free(data_history);
-    }
+    ring_free(&summaries);
+    ring_free(&history);
     
     return 0;
 }
+
+// ---------- Tela "top": todos os processos ----------
+
+typedef enum {
+    TOP_SORT_CPU = 0,
+    TOP_SORT_RSS,
+    TOP_SORT_IO,
+    TOP_SORT_CTX,
+    TOP_SORT_FAULTS,
+    TOP_SORT_PID,
+    TOP_SORT_NAME
+} TopSort;
+
+#define TOP_SEARCH_MAX 32
+#define TOP_FIRST_ROW 4     // linhas 1-3: resumo, filtro/busca e cabeçalho
+
+typedef struct {
+    WINDOW *win;
+    bool full_redraw;
+    TextWidget summary;
+    TextWidget status;
+    TextWidget header;
+    TextWidget *rows;
+    int nrows;
+    int width;                      // colunas úteis dentro da borda
+    ProcessSlot **view;             // processos visíveis, ordenados
+    size_t view_cap;
+    size_t view_count;
+    TopSort sort;
+    bool ascending;
+    char search[TOP_SEARCH_MAX];
+    bool searching;                 // digitando a busca
+    int scroll;
+    int selected;                   // índice em view da linha selecionada
+    int selected_pid;               // mantém a seleção quando a ordem muda
+    bool selection_moved;           // tecla moveu a seleção: vale o índice, não o PID
+    const char *filter_desc;
+    uint64_t interval_ns;
+    
+    // Detalhamento por thread do processo selecionado
+    bool threads_open;
+    ThreadTable threads;
+    ThreadSlot **thread_view;       // threads ordenadas por CPU%
+    size_t thread_view_cap;
+    int thread_scroll;
+    uint64_t thread_ns;             // tempo da última amostra das threads
+} TopView;
+
+// Critério de ordenação corrente (a TUI é single-thread)
+static TopSort top_sort_key;
+static bool top_sort_ascending;
+
+static double top_sort_value(const ProcessSlot *s) {
+    switch (top_sort_key) {
+        case TOP_SORT_CPU:    return s->cur.cpu_usage_percent;
+        case TOP_SORT_RSS:    return (double)s->cur.mem_rss;
+        case TOP_SORT_IO:     return s->cur.io_read_rate_kbs + s->cur.io_write_rate_kbs;
+        case TOP_SORT_CTX:    return s->ctx_switch_rate;
+        case TOP_SORT_FAULTS: return s->fault_rate;
+        default:              return 0.0;
+    }
+}
+
+static int compare_top(const void *a, const void *b) {
+    const ProcessSlot *sa = *(const ProcessSlot * const *)a;
+    const ProcessSlot *sb = *(const ProcessSlot * const *)b;
+    int cmp = 0;
+    if (top_sort_key == TOP_SORT_NAME) {
+        cmp = strcmp(sa->cur.process_name, sb->cur.process_name);
+    } else if (top_sort_key != TOP_SORT_PID) {
+        double va = top_sort_value(sa), vb = top_sort_value(sb);
+        cmp = (va > vb) - (va < vb);
+    }
+    if (cmp == 0) cmp = (sa->pid > sb->pid) - (sa->pid < sb->pid);
+    return top_sort_ascending ? cmp : -cmp;
+}
+
+// Busca incremental: substring do nome (sem distinguir maiúsculas) ou prefixo do PID
+static bool top_matches(const TopView *v, const ProcessSlot *s) {
+    if (v->search[0] == '\0') return true;
+    if (strcasestr(s->cur.process_name, v->search)) return true;
+    char pid[16];
+    snprintf(pid, sizeof(pid), "%d", s->pid);
+    return strncmp(pid, v->search, strlen(v->search)) == 0;
+}
+
+static bool top_build_view(TopView *v, ProcessTable *t) {
+    if (t->count > v->view_cap) {
+        size_t new_cap = t->count * 2;
+        ProcessSlot **new_view = realloc(v->view, new_cap * sizeof(ProcessSlot *));
+        if (!new_view) return false;
+        v->view = new_view;
+        v->view_cap = new_cap;
+    }
+    v->view_count = 0;
+    for (size_t i = 0; i < t->capacity; i++) {
+        ProcessSlot *s = &t->slots[i];
+        if (s->pid != 0 && !s->excluded && s->has_prev && top_matches(v, s)) {
+            v->view[v->view_count++] = s;
+        }
+    }
+    top_sort_key = v->sort;
+    top_sort_ascending = v->ascending;
+    qsort(v->view, v->view_count, sizeof(ProcessSlot *), compare_top);
+    
+    // A seleção acompanha o PID; se ele saiu da lista, fica na mesma linha
+    for (size_t i = 0; i < v->view_count && !v->selection_moved; i++) {
+        if (v->view[i]->pid == v->selected_pid) {
+            v->selected = (int)i;
+            break;
+        }
+    }
+    v->selection_moved = false;
+    if (v->selected >= (int)v->view_count) v->selected = (int)v->view_count - 1;
+    if (v->selected < 0) v->selected = 0;
+    v->selected_pid = v->view_count ? v->view[v->selected]->pid : 0;
+    return true;
+}
+
+static void top_place(TextWidget *w, int y, int x) {
+    w->y = y;
+    w->x = x;
+    w->len = 0;
+    w->text[0] = '\0';
+}
+
+// Moldura, rodapé e posição das linhas; chamado no primeiro quadro,
+// após a ajuda e ao redimensionar
+static bool top_layout(TopView *v) {
+    int max_y, max_x;
+    getmaxyx(v->win, max_y, max_x);
+    
+    werase(v->win);
+    draw_window_border(v->win, "Resource Monitor - Top");
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    if (v->threads_open) {
+        mvwprintw(v->win, max_y - 2, 2, "[q] Quit  [ESC/t] Back to processes  [Up/Down] Scroll  [h] Help");
+    } else {
+        mvwprintw(v->win, max_y - 2, 2, "[q] Quit  [/] Search  [c/m/i/x/f/p/n] Sort  [o] Order  [Enter/t] Threads  [h] Help");
+    }
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    
+    v->width = max_x - 4;
+    if (v->width >= TEXT_WIDGET_MAX) v->width = TEXT_WIDGET_MAX - 1;
+    if (v->width < 0) v->width = 0;
+    top_place(&v->summary, 1, 2);
+    top_place(&v->status, 2, 2);
+    top_place(&v->header, 3, 2);
+    
+    int nrows = max_y - 3 - TOP_FIRST_ROW;
+    if (nrows < 0) nrows = 0;
+    if (nrows != v->nrows) {
+        TextWidget *rows = realloc(v->rows, (size_t)(nrows ? nrows : 1) * sizeof(TextWidget));
+        if (!rows) return false;
+        v->rows = rows;
+        v->nrows = nrows;
+    }
+    for (int i = 0; i < v->nrows; i++) top_place(&v->rows[i], TOP_FIRST_ROW + i, 2);
+    
+    v->full_redraw = false;
+    return true;
+}
+
+// Texto truncado na largura útil da janela
+static void top_text(TopView *v, TextWidget *w, const char *text) {
+    char buf[TEXT_WIDGET_MAX];
+    snprintf(buf, (size_t)v->width + 1, "%s", text);
+    text_widget_draw(v->win, w, buf);
+}
+
+static int compare_thread_cpu(const void *a, const void *b) {
+    const ThreadSlot *x = *(const ThreadSlot * const *)a;
+    const ThreadSlot *y = *(const ThreadSlot * const *)b;
+    double cx = x->cur.cpu_usage_percent, cy = y->cur.cpu_usage_percent;
+    if (cx != cy) return (cx < cy) - (cx > cy);
+    return (x->cur.tid > y->cur.tid) - (x->cur.tid < y->cur.tid);
+}
+
+// Detalhamento: threads do processo selecionado, da mais ativa para a menos
+static void top_draw_threads(TopView *v) {
+    ThreadTable *t = &v->threads;
+    if (t->count > v->thread_view_cap) {
+        size_t new_cap = t->count * 2;
+        ThreadSlot **new_view = realloc(v->thread_view, new_cap * sizeof(ThreadSlot *));
+        if (!new_view) return;
+        v->thread_view = new_view;
+        v->thread_view_cap = new_cap;
+    }
+    for (size_t i = 0; i < t->count; i++) v->thread_view[i] = &t->threads[i];
+    qsort(v->thread_view, t->count, sizeof(ThreadSlot *), compare_thread_cpu);
+    
+    char line[TEXT_WIDGET_MAX * 2];
+    const ThreadSlot *main_thread = thread_table_find(t, t->pid);
+    snprintf(line, sizeof(line), "PID %d (%s): %zu threads | sample: %.2f ms%s",
+             t->pid, main_thread ? main_thread->cur.name : "?", t->count, v->thread_ns / 1e6,
+             t->relisted ? ", task/ relisted" : "");
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    top_text(v, &v->summary, line);
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    
+    snprintf(line, sizeof(line), "Threads sorted by CPU%%%s", t->unavailable ? " | some threads not read: open file limit" : "");
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    top_text(v, &v->status, line);
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    
+    snprintf(line, sizeof(line), " %7s %-16s %1s %7s %9s %12s %12s %4s",
+             "TID", "NAME", "S", "CPU%", "CTXSW/s", "VOLUNTARY", "INVOLUNTARY", "CPU");
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    top_text(v, &v->header, line);
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    
+    int max_scroll = (int)t->count - v->nrows;
+    if (v->thread_scroll > max_scroll) v->thread_scroll = max_scroll;
+    if (v->thread_scroll < 0) v->thread_scroll = 0;
+    
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    for (int i = 0; i < v->nrows; i++) {
+        size_t idx = (size_t)(v->thread_scroll + i);
+        if (idx >= t->count) {
+            top_text(v, &v->rows[i], "");
+            continue;
+        }
+        const ThreadMetrics *m = &v->thread_view[idx]->cur;
+        snprintf(line, sizeof(line), " %7d %-16.16s %c %7.1f %9.0f %12ld %12ld %4d",
+                 m->tid, m->name, m->state ? m->state : '?', m->cpu_usage_percent,
+                 m->ctx_switch_rate, m->voluntary_ctx_switches, m->nonvoluntary_ctx_switches,
+                 m->processor);
+        top_text(v, &v->rows[i], line);
+    }
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    wrefresh(v->win);
+}
+
+static void top_draw(TopView *v, ProcScanner *sc) {
+    if (v->full_redraw && !top_layout(v)) return;
+    if (v->threads_open) {
+        top_draw_threads(v);
+        return;
+    }
+    if (!top_build_view(v, &sc->table)) return;
+    
+    char line[TEXT_WIDGET_MAX * 2];
+    ProcessTable *t = &sc->table;
+    
+    // Custo da coleta relativo ao intervalo (fração de um núcleo)
+    double core_pct = v->interval_ns ? 100.0 * (double)sc->cpu_ns / (double)v->interval_ns : 0.0;
+    snprintf(line, sizeof(line), "Processes: %zu shown / %zu | scan: %.2f ms CPU (%.2f%% of a core) | "
+             "read %zu, unchanged %zu%s",
+             v->view_count, sc->visible, sc->cpu_ns / 1e6, core_pct,
+             t->full_reads, t->stat_reads, sc->rescanned ? ", /proc reread" : "");
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    top_text(v, &v->summary, line);
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    
+    snprintf(line, sizeof(line), "Filter: %s | Search: %s%s",
+             v->filter_desc ? v->filter_desc : "all processes",
+             v->search, v->searching ? "_  (Enter: keep, ESC: clear)" : "");
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    top_text(v, &v->status, line);
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_WARNING));
+    
+    // Cabeçalho com a coluna de ordenação marcada
+    static const char *labels[] = { "CPU%", "RSS", "IO(KB/s)", "CTXSW/s", "FLT/s", "PID", "NAME" };
+    char marked[7][16];
+    for (int i = 0; i < 7; i++) {
+        snprintf(marked[i], sizeof(marked[i]), "%s%s", labels[i],
+                 (int)v->sort == i ? (v->ascending ? "^" : "v") : "");
+    }
+    snprintf(line, sizeof(line), " %7s %-16s %7s %10s %10s %9s %9s %4s",
+             marked[TOP_SORT_PID], marked[TOP_SORT_NAME], marked[TOP_SORT_CPU], marked[TOP_SORT_RSS],
+             marked[TOP_SORT_IO], marked[TOP_SORT_CTX], marked[TOP_SORT_FAULTS], "THR");
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    top_text(v, &v->header, line);
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_HEADER) | A_BOLD);
+    
+    // Rolagem mínima que mantém a seleção visível
+    if (v->selected < v->scroll) v->scroll = v->selected;
+    if (v->selected >= v->scroll + v->nrows) v->scroll = v->selected - v->nrows + 1;
+    int max_scroll = (int)v->view_count - v->nrows;
+    if (v->scroll > max_scroll) v->scroll = max_scroll;
+    if (v->scroll < 0) v->scroll = 0;
+    
+    wattron(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    for (int i = 0; i < v->nrows; i++) {
+        size_t idx = (size_t)(v->scroll + i);
+        if (idx >= v->view_count) {
+            top_text(v, &v->rows[i], "");
+            continue;
+        }
+        const ProcessSlot *s = v->view[idx];
+        char rss[32];
+        format_bytes(rss, sizeof(rss), (unsigned long long)s->cur.mem_rss);
+        snprintf(line, sizeof(line), "%c%7d %-16.16s %7.1f %10s %10.1f %9.0f %9.0f %4ld",
+                 (int)idx == v->selected ? '>' : ' ', s->pid, s->cur.process_name, s->cur.cpu_usage_percent, rss,
+                 s->cur.io_read_rate_kbs + s->cur.io_write_rate_kbs,
+                 s->ctx_switch_rate, s->fault_rate, s->cur.num_threads);
+        top_text(v, &v->rows[i], line);
+    }
+    wattroff(v->win, COLOR_PAIR(COLOR_PAIR_DATA));
+    wrefresh(v->win);
+}
+
+// Tecla de ordenação: a mesma coluna de novo inverte a ordem. Métricas
+// começam do maior para o menor; PID e nome, em ordem crescente.
+static void top_set_sort(TopView *v, TopSort sort) {
+    if (v->sort == sort) {
+        v->ascending = !v->ascending;
+    } else {
+        v->sort = sort;
+        v->ascending = (sort == TOP_SORT_PID || sort == TOP_SORT_NAME);
+    }
+}
+
+// Amostra as threads do processo detalhado. Retorna false se ele terminou.
+static bool top_sample_threads(TopView *v, ProcScanner *sc) {
+    ProcessSlot *slot = process_table_find(&sc->table, v->threads.pid);
+    if (!slot || slot->excluded) return false;
+    uint64_t t0 = monotonic_ns();
+    bool ok = thread_table_sample(&v->threads, slot->cur.num_threads);
+    v->thread_ns = monotonic_ns() - t0;
+    return ok;
+}
+
+static void top_close_threads(TopView *v) {
+    thread_table_close(&v->threads);
+    v->threads_open = false;
+    v->full_redraw = true;
+}
+
+static void top_open_threads(TopView *v, ProcScanner *sc) {
+    if (v->selected_pid <= 0 || !thread_table_open(&v->threads, v->selected_pid)) {
+        thread_table_close(&v->threads);
+        return;
+    }
+    v->threads_open = true;
+    v->thread_scroll = 0;
+    v->full_redraw = true;
+    // CPU% e taxas aparecem a partir da próxima amostra
+    if (!top_sample_threads(v, sc)) top_close_threads(v);
+}
+
+// Move a seleção da lista de processos
+static void top_move(TopView *v, int delta) {
+    v->selected += delta;
+    if (v->selected < 0) v->selected = 0;
+    v->selection_moved = true;
+}
+
+// Trata uma tecla. Retorna false para sair.
+static bool top_handle_key(TopView *v, ProcScanner *sc, int ch) {
+    if (v->searching) {
+        size_t len = strlen(v->search);
+        if (ch == 27) {                                 // ESC: limpa a busca
+            v->search[0] = '\0';
+            v->searching = false;
+        } else if (ch == '\n' || ch == KEY_ENTER) {     // mantém o filtro
+            v->searching = false;
+        } else if (ch == KEY_BACKSPACE || ch == 127 || ch == 8) {
+            if (len > 0) v->search[len - 1] = '\0';
+        } else if (ch >= 32 && ch < 127 && len + 1 < sizeof(v->search)) {
+            v->search[len] = (char)ch;
+            v->search[len + 1] = '\0';
+        }
+        v->scroll = 0;
+        return true;
+    }
+    
+    switch (ch) {
+        case 'q': case 'Q': return false;
+        case 'h': case 'H':
+            draw_help_screen(v->win);
+            v->full_redraw = true;
+            return true;
+        case KEY_RESIZE: {
+            int max_y, max_x;
+            getmaxyx(stdscr, max_y, max_x);
+            wresize(v->win, max_y, max_x);
+            v->full_redraw = true;
+            return true;
+        }
+    }
+    
+    if (v->threads_open) {
+        switch (ch) {
+            case 27: case 't': case KEY_LEFT: case KEY_BACKSPACE: case 127:
+                top_close_threads(v);
+                break;
+            case KEY_UP:    v->thread_scroll--; break;
+            case KEY_DOWN:  v->thread_scroll++; break;
+            case KEY_PPAGE: v->thread_scroll -= v->nrows; break;
+            case KEY_NPAGE: v->thread_scroll += v->nrows; break;
+            case KEY_HOME:  v->thread_scroll = 0; break;
+        }
+        return true;
+    }
+    
+    switch (ch) {
+        case '/': v->searching = true; break;
+        case 27:  v->search[0] = '\0'; break;
+        case 'c': top_set_sort(v, TOP_SORT_CPU); break;
+        case 'm': top_set_sort(v, TOP_SORT_RSS); break;
+        case 'i': top_set_sort(v, TOP_SORT_IO); break;
+        case 'x': top_set_sort(v, TOP_SORT_CTX); break;
+        case 'f': top_set_sort(v, TOP_SORT_FAULTS); break;
+        case 'p': top_set_sort(v, TOP_SORT_PID); break;
+        case 'n': top_set_sort(v, TOP_SORT_NAME); break;
+        case 'o': v->ascending = !v->ascending; break;
+        case KEY_UP:    top_move(v, -1); break;
+        case KEY_DOWN:  top_move(v, 1); break;
+        case KEY_PPAGE: top_move(v, -v->nrows); break;
+        case KEY_NPAGE: top_move(v, v->nrows); break;
+        case KEY_HOME:  top_move(v, -v->selected); break;
+        case '\n': case KEY_ENTER: case 't':
+            top_open_threads(v, sc);
+            break;
+    }
+    return true;
+}
+
+int run_top_tui(ProcFilterFn filter, void *filter_arg, const char *filter_desc, uint64_t interval_ns) {
+    uint64_t refresh_ns = (interval_ns > 0) ? interval_ns : REFRESH_INTERVAL_NS;
+    
+    ProcScanner scanner;
+    if (!proc_scanner_init(&scanner, filter, filter_arg)) {
+        proc_scanner_free(&scanner);
+        return -1;
+    }
+    SampleTimer timer;
+    if (!sample_timer_start(&timer, refresh_ns)) {
+        proc_scanner_free(&scanner);
+        return -1;
+    }
+    
+    // Primeiro tick: abre os handles; os deltas aparecem a partir do segundo
+    proc_scanner_tick(&scanner);
+    
+    // Inicializar ncurses
+    initscr();
+    cbreak();
+    noecho();
+    curs_set(0);
+    keypad(stdscr, TRUE);
+    set_escdelay(25);
+    
+    if (has_colors()) {
+        init_colors();
+    }
+    
+    int max_y, max_x;
+    getmaxyx(stdscr, max_y, max_x);
+    WINDOW *main_win = newwin(max_y, max_x, 0, 0);
+    keypad(main_win, TRUE);
+    wtimeout(main_win, 0); // poll() decide quando há entrada
+    
+    TopView view = {
+        .win = main_win,
+        .full_redraw = true,
+        .sort = TOP_SORT_CPU,
+        .filter_desc = filter_desc,
+        .interval_ns = refresh_ns,
+    };
+    top_draw(&view, &scanner);
+    
+    // Espera simultânea por teclado e pelo temporizador de coleta
+    struct pollfd fds[2] = {
+        { .fd = STDIN_FILENO, .events = POLLIN },
+        { .fd = timer.fd,     .events = POLLIN },
+    };
+    
+    int result = 0;
+    bool running = true;
+    while (running) {
+        int ready = poll(fds, 2, -1);
+        if (ready < 0 && errno != EINTR) break;
+        
+        bool redraw = false;
+        if (ready > 0 && (fds[1].revents & POLLIN)) {
+            // Já expirou: não bloqueia
+            sample_timer_wait(&timer);
+            if (!proc_scanner_tick(&scanner)) {
+                result = -1;
+                break;
+            }
+            // Processo detalhado terminou: volta à lista
+            if (view.threads_open && !top_sample_threads(&view, &scanner)) {
+                top_close_threads(&view);
+            }
+            redraw = true;
+        }
+        
+        // Sem POLLIN também: após o EINTR do SIGWINCH o KEY_RESIZE só sai do wgetch
+        int ch;
+        while (running && (ch = wgetch(main_win)) != ERR) {
+            running = top_handle_key(&view, &scanner, ch);
+            redraw = true;
+        }
+        
+        if (running && redraw) top_draw(&view, &scanner);
+    }
+    
+    sample_timer_close(&timer);
+    delwin(main_win);
+    endwin();
+    
+    thread_table_close(&view.threads);
+    free(view.rows);
+    free(view.view);
+    free(view.thread_view);
+    proc_scanner_free(&scanner);
+    return result;
+}
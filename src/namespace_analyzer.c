@@ -1,30 +1,47 @@
 #define _GNU_SOURCE
 #include "../include/namespace.h"
+#include "../include/ns_index.h"
+#include "../include/ns_latency.h"
+#include "../include/serializer.h"
+#include "../include/timing.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <errno.h>
 #include <ctype.h>
 #include <sched.h>
 #include <time.h>
+#include <pthread.h>
 #include <sys/wait.h>
 
-// Estruturas para o relatório de namespaces do sistema
-typedef struct PIDNode {
-    int pid;
-    struct PIDNode *next;
-} PIDNode;
+#define NS_REPORT_MIN_PIDS 256     // PIDs por thread abaixo dos quais não vale paralelizar
+
+#define NS_ARENA_BLOCK (256 * 1024)
+#define NS_REPORT_MIN_SLOTS 64
 
-typedef struct NamespaceReportNode {
-    unsigned long inode;
-    char type[20];
-    char path[256];
-    PIDNode *pids;
-    struct NamespaceReportNode *next;
-} NamespaceReportNode;
+// Bloco da arena do relatório; os anteriores ficam encadeados em prev
+struct NsArenaBlock {
+    struct NsArenaBlock *prev;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+// Uma thread da varredura do relatório: faixa contígua da lista de PIDs
+typedef struct {
+    pthread_t thread;
+    bool threaded;                  // false: roda na thread do chamador
+    int proc_fd;
+    const int *pids;
+    int count;
+    int analyzed;
+    bool failed;                    // faltou memória no parcial
+    NsReport report;                // parcial da faixa
+} ReportWorker;
 
 // Função auxiliar para verificar se um diretório existe
 int dir_exists(const char *path) {
@@ -35,23 +52,13 @@ int dir_exists(const char *path) {
     return 0;
 }
 
-int get_process_namespaces(int pid, NamespaceInfo *ns_info, int max_ns) {
-    char ns_path[256];
-    snprintf(ns_path, sizeof(ns_path), "/proc/%d/ns", pid);
-
-    if (!dir_exists(ns_path)) {
-        // Processo não existe - retorna -1 silenciosamente (não imprime erro)
-        // Isso é normal durante varredura do sistema quando processos terminam
-        return -1;
-    }
-
-    DIR *d = opendir(ns_path);
+// Lê os links de um diretório ns já aberto (fecha dir_fd). Cada link é
+// consultado com fstatat/readlinkat relativos ao diretório, sem montar
+// caminhos absolutos nem repetir a resolução de /proc/<pid>/ns.
+static int read_ns_dir(int dir_fd, NamespaceInfo *ns_info, int max_ns) {
+    DIR *d = fdopendir(dir_fd);
     if (d == NULL) {
-        // Apenas imprime erro se for problema de permissão
-        if (errno == EACCES) {
-            fprintf(stderr, "Aviso: Sem permissão para acessar namespaces do PID %d.\n", pid);
-        }
-        // Outros erros são silenciosos (processo pode ter terminado)
+        close(dir_fd);
         return -1;
     }
 
@@ -59,16 +66,15 @@ int get_process_namespaces(int pid, NamespaceInfo *ns_info, int max_ns) {
     int count = 0;
     while ((dir = readdir(d)) != NULL && count < max_ns) {
         if (dir->d_type == DT_LNK) {
-            char link_path[512];
-            char real_path[512] = {0};
             struct stat sb;
-
-            snprintf(link_path, sizeof(link_path), "%s/%s", ns_path, dir->d_name);
-            if (stat(link_path, &sb) == 0) {
-                strcpy(ns_info[count].type, dir->d_name);
+            if (fstatat(dirfd(d), dir->d_name, &sb, 0) == 0) {
+                size_t type_len = strnlen(dir->d_name, sizeof(ns_info[count].type) - 1);
+                memcpy(ns_info[count].type, dir->d_name, type_len);
+                ns_info[count].type[type_len] = '\0';
                 ns_info[count].inode = sb.st_ino;
-                readlink(link_path, real_path, sizeof(real_path) - 1);
-                strncpy(ns_info[count].path, real_path, sizeof(ns_info[count].path) - 1);
+                ssize_t len = readlinkat(dirfd(d), dir->d_name, ns_info[count].path,
+                                         sizeof(ns_info[count].path) - 1);
+                ns_info[count].path[len > 0 ? len : 0] = '\0';
                 count++;
             }
         }
@@ -77,6 +83,31 @@ int get_process_namespaces(int pid, NamespaceInfo *ns_info, int max_ns) {
     return count;
 }
 
+// Processo que não existe mais: -1 silencioso (normal durante a varredura
+// do sistema); sem permissão: aviso
+static int open_ns_failed(int pid) {
+    if (errno == EACCES) {
+        fprintf(stderr, "Aviso: Sem permissão para acessar namespaces do PID %d.\n", pid);
+    }
+    return -1;
+}
+
+int get_process_namespaces_at(int proc_fd, int pid, NamespaceInfo *ns_info, int max_ns) {
+    char ns_path[32];
+    snprintf(ns_path, sizeof(ns_path), "%d/ns", pid);
+    int fd = openat(proc_fd, ns_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return open_ns_failed(pid);
+    return read_ns_dir(fd, ns_info, max_ns);
+}
+
+int get_process_namespaces(int pid, NamespaceInfo *ns_info, int max_ns) {
+    char ns_path[256];
+    snprintf(ns_path, sizeof(ns_path), "/proc/%d/ns", pid);
+    int fd = open(ns_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return open_ns_failed(pid);
+    return read_ns_dir(fd, ns_info, max_ns);
+}
+
 void list_process_namespaces(int pid) {
     NamespaceInfo ns_info[10];
     int ns_count = get_process_namespaces(pid, ns_info, 10);
@@ -95,10 +126,20 @@ void list_process_namespaces(int pid) {
     }
 }
 
+// Namespaces do índice ou, se o PID não está nele, do /proc
+static int lookup_namespaces(const NsIndex *idx, int pid, NamespaceInfo *ns_info, int max_ns) {
+    int count = idx ? ns_index_get(idx, pid, ns_info, max_ns) : -1;
+    return count >= 0 ? count : get_process_namespaces(pid, ns_info, max_ns);
+}
+
 void compare_process_namespaces(int pid1, int pid2) {
+    compare_process_namespaces_indexed(NULL, pid1, pid2);
+}
+
+void compare_process_namespaces_indexed(const NsIndex *idx, int pid1, int pid2) {
     NamespaceInfo ns1[10], ns2[10];
-    int count1 = get_process_namespaces(pid1, ns1, 10);
-    int count2 = get_process_namespaces(pid2, ns2, 10);
+    int count1 = lookup_namespaces(idx, pid1, ns1, 10);
+    int count2 = lookup_namespaces(idx, pid2, ns2, 10);
 
     if (count1 < 0 || count2 < 0) {
         return; // Erro já foi impresso
@@ -160,6 +201,22 @@ void compare_process_namespaces(int pid1, int pid2) {
 }
 
 void find_processes_in_namespace(const char *ns_path) {
+    find_processes_in_namespace_indexed(NULL, ns_path);
+}
+
+typedef struct {
+    int pid;
+    int type;
+} NsMember;
+
+// PID crescente; no mesmo PID, o tipo na ordem do kernel
+static int compare_member(const void *a, const void *b) {
+    const NsMember *x = a, *y = b;
+    if (x->pid != y->pid) return (x->pid > y->pid) - (x->pid < y->pid);
+    return x->type - y->type;
+}
+
+void find_processes_in_namespace_indexed(const NsIndex *idx, const char *ns_path) {
     struct stat ns_stat;
     if (stat(ns_path, &ns_stat) != 0) {
         perror("Erro ao obter informações do arquivo de namespace");
@@ -168,6 +225,33 @@ void find_processes_in_namespace(const char *ns_path) {
 
     printf("Processos no namespace com inode %lu (path: %s):\n", ns_stat.st_ino, ns_path);
 
+    if (idx) {
+        // O tipo não vem do caminho (pode ser um bind mount): junta os
+        // membros de todos os tipos com esse inode. pid e pid_for_children
+        // podem compartilhá-lo: como na varredura, cada processo sai uma
+        // vez, com o primeiro tipo na ordem do kernel.
+        int total = 0;
+        for (int t = 0; t < NS_INDEX_TYPES; t++) {
+            int count;
+            if (ns_index_members(idx, t, ns_stat.st_ino, &count)) total += count;
+        }
+        NsMember *found = malloc((size_t)(total ? total : 1) * sizeof(NsMember));
+        if (!found) return;
+        int n = 0;
+        for (int t = 0; t < NS_INDEX_TYPES; t++) {
+            int count;
+            const int *members = ns_index_members(idx, t, ns_stat.st_ino, &count);
+            for (int i = 0; members && i < count; i++) found[n++] = (NsMember){ members[i], t };
+        }
+        qsort(found, (size_t)n, sizeof(NsMember), compare_member);
+        for (int i = 0; i < n; i++) {
+            if (i > 0 && found[i].pid == found[i - 1].pid) continue;
+            printf("  - PID: %d (Tipo: %s)\n", found[i].pid, ns_index_type_name(found[i].type));
+        }
+        free(found);
+        return;
+    }
+
     DIR *proc_dir = opendir("/proc");
     if (proc_dir == NULL) {
         perror("Não foi possível abrir /proc");
@@ -179,7 +263,7 @@ void find_processes_in_namespace(const char *ns_path) {
         if (entry->d_type == DT_DIR && isdigit(*entry->d_name)) {
             int pid = atoi(entry->d_name);
             NamespaceInfo ns_info[10];
-            int ns_count = get_process_namespaces(pid, ns_info, 10);
+            int ns_count = get_process_namespaces_at(dirfd(proc_dir), pid, ns_info, 10);
             for (int i = 0; i < ns_count; i++) {
                 if (ns_info[i].inode == ns_stat.st_ino) {
                     printf("  - PID: %d (Tipo: %s)\n", pid, ns_info[i].type);
@@ -191,33 +275,256 @@ void find_processes_in_namespace(const char *ns_path) {
     closedir(proc_dir);
 }
 
-NamespaceReportNode* add_ns_report_node(NamespaceReportNode **head, const NamespaceInfo *ns, int pid) {
-    NamespaceReportNode *current = *head;
-    while (current != NULL) {
-        if (current->inode == ns->inode) {
-            PIDNode *pid_node = malloc(sizeof(PIDNode));
-            pid_node->pid = pid;
-            pid_node->next = current->pids;
-            current->pids = pid_node;
-            return current;
+// ---------- Agregação do relatório ----------
+
+static void *arena_alloc(NsReport *r, size_t bytes) {
+    bytes = (bytes + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1);
+    NsArenaBlock *b = r->arena;
+    if (!b || b->size - b->used < bytes) {
+        size_t size = bytes > NS_ARENA_BLOCK ? bytes : NS_ARENA_BLOCK;
+        b = malloc(sizeof(NsArenaBlock) + size);
+        if (!b) return NULL;
+        b->prev = r->arena;
+        b->size = size;
+        b->used = 0;
+        r->arena = b;
+        r->arena_bytes += size;
+    }
+    void *p = (char *)b->data + b->used;
+    b->used += bytes;
+    return p;
+}
+
+// Dobra a lista de PIDs: no lugar se ela é a última alocação do bloco
+// atual e cabe, senão copia para um espaço novo da arena
+static bool grow_pids(NsReport *r, NsReportEntry *e) {
+    int cap = e->pid_cap ? e->pid_cap * 2 : 4;
+    size_t old_bytes = ((size_t)e->pid_cap * sizeof(int) + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1);
+    size_t new_bytes = ((size_t)cap * sizeof(int) + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1);
+    NsArenaBlock *b = r->arena;
+    if (e->pids && b && (char *)e->pids + old_bytes == (char *)b->data + b->used &&
+        b->size - b->used >= new_bytes - old_bytes) {
+        b->used += new_bytes - old_bytes;
+        e->pid_cap = cap;
+        return true;
+    }
+    int *pids = arena_alloc(r, new_bytes);
+    if (!pids) return false;
+    if (e->pid_count) memcpy(pids, e->pids, (size_t)e->pid_count * sizeof(int));
+    e->pids = pids;
+    e->pid_cap = cap;
+    return true;
+}
+
+static uint64_t ns_hash(const char *type, unsigned long inode) {
+    uint64_t h = 14695981039346656037ULL;    // FNV-1a do tipo
+    for (const unsigned char *p = (const unsigned char *)type; *p; p++) h = (h ^ *p) * 1099511628211ULL;
+    h = (h ^ inode) * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 29);
+}
+
+// Slot da chave: ocupado por ela ou o primeiro vazio da sonda linear
+static size_t find_slot(const NsReport *r, const char *type, unsigned long inode) {
+    size_t i = (size_t)ns_hash(type, inode) & r->slot_mask;
+    for (;;) {
+        int32_t idx = r->slots[i];
+        if (idx < 0) return i;
+        const NsReportEntry *e = &r->entries[idx];
+        if (e->inode == inode && strcmp(e->type, type) == 0) return i;
+        i = (i + 1) & r->slot_mask;
+    }
+}
+
+// Fator de carga até 1/2
+static bool grow_slots(NsReport *r) {
+    size_t slots = (r->slot_mask + 1) * 2;
+    int32_t *grown = malloc(slots * sizeof(int32_t));
+    if (!grown) return false;
+    memset(grown, 0xff, slots * sizeof(int32_t));
+    free(r->slots);
+    r->slots = grown;
+    r->slot_mask = slots - 1;
+    for (int k = 0; k < r->count; k++) r->slots[find_slot(r, r->entries[k].type, r->entries[k].inode)] = k;
+    return true;
+}
+
+bool ns_report_init(NsReport *r) {
+    memset(r, 0, sizeof(NsReport));
+    r->slots = malloc(NS_REPORT_MIN_SLOTS * sizeof(int32_t));
+    if (!r->slots) return false;
+    memset(r->slots, 0xff, NS_REPORT_MIN_SLOTS * sizeof(int32_t));
+    r->slot_mask = NS_REPORT_MIN_SLOTS - 1;
+    return true;
+}
+
+// Entrada da chave, criada (com o caminho copiado para a arena) se nova
+static NsReportEntry *ns_report_entry(NsReport *r, const char *type, unsigned long inode, const char *path) {
+    size_t slot = find_slot(r, type, inode);
+    if (r->slots[slot] >= 0) return &r->entries[r->slots[slot]];
+
+    if ((size_t)(r->count + 1) * 2 > r->slot_mask + 1) {
+        if (!grow_slots(r)) return NULL;
+        slot = find_slot(r, type, inode);
+    }
+    if (r->count == r->cap) {
+        int cap = r->cap ? r->cap * 2 : 64;
+        NsReportEntry *grown = realloc(r->entries, (size_t)cap * sizeof(NsReportEntry));
+        if (!grown) return NULL;
+        r->entries = grown;
+        r->cap = cap;
+    }
+    size_t path_len = strlen(path);
+    char *path_copy = arena_alloc(r, path_len + 1);
+    if (!path_copy) return NULL;
+    memcpy(path_copy, path, path_len + 1);
+
+    NsReportEntry *e = &r->entries[r->count];
+    memset(e, 0, sizeof(*e));
+    size_t type_len = strnlen(type, sizeof(e->type) - 1);
+    memcpy(e->type, type, type_len);
+    e->inode = inode;
+    e->path = path_copy;
+    r->slots[slot] = r->count++;
+    return e;
+}
+
+bool ns_report_add(NsReport *r, const NamespaceInfo *ns, int pid) {
+    NsReportEntry *e = ns_report_entry(r, ns->type, ns->inode, ns->path);
+    if (!e || (e->pid_count == e->pid_cap && !grow_pids(r, e))) return false;
+    e->pids[e->pid_count++] = pid;
+    return true;
+}
+
+bool ns_report_merge(NsReport *into, const NsReport *part) {
+    for (int k = 0; k < part->count; k++) {
+        const NsReportEntry *src = &part->entries[k];
+        NsReportEntry *e = ns_report_entry(into, src->type, src->inode, src->path);
+        if (!e) return false;
+        while (e->pid_cap - e->pid_count < src->pid_count) {
+            if (!grow_pids(into, e)) return false;
+        }
+        memcpy(e->pids + e->pid_count, src->pids, (size_t)src->pid_count * sizeof(int));
+        e->pid_count += src->pid_count;
+    }
+    return true;
+}
+
+const NsReportEntry *ns_report_find(const NsReport *r, const char *type, unsigned long inode) {
+    int32_t idx = r->slots[find_slot(r, type, inode)];
+    return idx >= 0 ? &r->entries[idx] : NULL;
+}
+
+bool ns_report_write_json(const NsReport *r, const char *filename) {
+    OutBuf o;
+    if (!out_open(&o, filename)) return false;
+
+    out_lit(&o, "[\n");
+    for (int k = 0; k < r->count; k++) {
+        const NsReportEntry *e = &r->entries[k];
+        out_lit(&o, "  {\n    \"type\": ");
+        out_json_str(&o, e->type);
+        out_lit(&o, ",\n    \"inode\": ");
+        out_u64(&o, e->inode);
+        out_lit(&o, ",\n    \"path\": ");
+        out_json_str(&o, e->path);
+        out_lit(&o, ",\n    \"pids\": [");
+        for (int i = 0; i < e->pid_count; i++) {
+            if (i > 0) out_lit(&o, ", ");
+            out_i64(&o, e->pids[i]);
+        }
+        out_lit(&o, "]\n  }");
+        if (k + 1 < r->count) out_char(&o, ',');
+        out_char(&o, '\n');
+    }
+    out_lit(&o, "]\n");
+    return out_close(&o);
+}
+
+void ns_report_free(NsReport *r) {
+    NsArenaBlock *b = r->arena;
+    while (b) {
+        NsArenaBlock *prev = b->prev;
+        free(b);
+        b = prev;
+    }
+    free(r->entries);
+    free(r->slots);
+    memset(r, 0, sizeof(NsReport));
+}
+
+// ---------- Relatório do sistema ----------
+
+static void *report_worker_main(void *arg) {
+    ReportWorker *w = arg;
+    for (int i = 0; i < w->count; i++) {
+        NamespaceInfo ns_info[10];
+        int ns_count = get_process_namespaces_at(w->proc_fd, w->pids[i], ns_info, 10);
+        if (ns_count > 0) {
+            w->analyzed++;
+            for (int k = 0; k < ns_count && !w->failed; k++) {
+                w->failed = !ns_report_add(&w->report, &ns_info[k], w->pids[i]);
+            }
         }
-        current = current->next;
+        // Processos que retornam -1 são ignorados silenciosamente
     }
+    return NULL;
+}
 
-    NamespaceReportNode *new_node = malloc(sizeof(NamespaceReportNode));
-    strcpy(new_node->type, ns->type);
-    strcpy(new_node->path, ns->path);
-    new_node->inode = ns->inode;
-    new_node->next = *head;
-    new_node->pids = malloc(sizeof(PIDNode));
-    new_node->pids->pid = pid;
-    new_node->pids->next = NULL;
-    *head = new_node;
-    return new_node;
+// PIDs numéricos de /proc, na ordem do readdir
+static int *list_proc_pids(DIR *proc_dir, int *count) {
+    int cap = 1024, n = 0;
+    int *pids = malloc(cap * sizeof(int));
+    struct dirent *entry;
+    while (pids && (entry = readdir(proc_dir)) != NULL) {
+        if (entry->d_type != DT_DIR || !isdigit(*entry->d_name)) continue;
+        if (n == cap) {
+            int *grown = realloc(pids, 2 * cap * sizeof(int));
+            if (!grown) {
+                free(pids);
+                return NULL;
+            }
+            pids = grown;
+            cap *= 2;
+        }
+        pids[n++] = atoi(entry->d_name);
+    }
+    *count = n;
+    return pids;
+}
+
+static int default_report_workers(int pids) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = (cpus > 0) ? (int)cpus : 1;
+    if (workers > pids / NS_REPORT_MIN_PIDS) workers = pids / NS_REPORT_MIN_PIDS;
+    if (workers > NS_REPORT_MAX_WORKERS) workers = NS_REPORT_MAX_WORKERS;
+    return workers > 0 ? workers : 1;
+}
+
+void generate_system_namespace_report_indexed(const NsIndex *idx, const char *filename) {
+    uint64_t start_ns = monotonic_ns();
+    NsReport report;
+    if (!ns_index_report(idx, &report)) {
+        fprintf(stderr, "Erro: Sem memória para o relatório de namespaces\n");
+        return;
+    }
+    printf("Processos no índice: %zu (%.1f ms, última varredura há %.1f s)\n", idx->proc_count,
+           (double)(monotonic_ns() - start_ns) / NSEC_PER_MSEC,
+           (double)(monotonic_ns() - idx->last_scan_ns) / NSEC_PER_SEC);
+    printf("Gerando relatório JSON...\n");
+    if (!ns_report_write_json(&report, filename)) {
+        fprintf(stderr, "Erro ao gravar %s: %s\n", filename, strerror(errno));
+    } else {
+        printf("Namespaces únicos encontrados: %d\n", report.count);
+        printf("\n✓ Relatório salvo em: %s\n", filename);
+    }
+    ns_report_free(&report);
 }
 
 void generate_system_namespace_report(const char *filename) {
-    NamespaceReportNode *report_head = NULL;
+    generate_system_namespace_report_workers(filename, 0);
+}
+
+void generate_system_namespace_report_workers(const char *filename, int workers) {
     DIR *proc_dir = opendir("/proc");
     if (proc_dir == NULL) {
         perror("Não foi possível abrir /proc");
@@ -225,106 +532,69 @@ void generate_system_namespace_report(const char *filename) {
     }
 
     printf("Analisando processos do sistema...\n");
-    
+
     int total_processes = 0;
-    int analyzed_processes = 0;
+    int *pids = list_proc_pids(proc_dir, &total_processes);
+    if (!pids) {
+        fprintf(stderr, "Erro: Sem memória para a lista de PIDs\n");
+        closedir(proc_dir);
+        return;
+    }
 
-    struct dirent *entry;
-    while ((entry = readdir(proc_dir)) != NULL) {
-        if (entry->d_type == DT_DIR && isdigit(*entry->d_name)) {
-            total_processes++;
-            int pid = atoi(entry->d_name);
-            NamespaceInfo ns_info[10];
-            int ns_count = get_process_namespaces(pid, ns_info, 10);
-            
-            if (ns_count > 0) {
-                analyzed_processes++;
-                for (int i = 0; i < ns_count; i++) {
-                    add_ns_report_node(&report_head, &ns_info[i], pid);
-                }
-            }
-            // Processos que retornam -1 são ignorados silenciosamente
-        }
+    // Faixas contíguas da lista, uma por thread; os parciais são juntados
+    // na ordem das faixas, o que mantém a ordem da varredura serial
+    if (workers <= 0) workers = default_report_workers(total_processes);
+    if (workers > NS_REPORT_MAX_WORKERS) workers = NS_REPORT_MAX_WORKERS;
+    ReportWorker pool[NS_REPORT_MAX_WORKERS];
+    uint64_t start_ns = monotonic_ns();
+    for (int k = 0; k < workers; k++) {
+        int first = (int)((long)total_processes * k / workers);
+        int last = (int)((long)total_processes * (k + 1) / workers);
+        pool[k] = (ReportWorker){
+            .proc_fd = dirfd(proc_dir),
+            .pids = pids + first,
+            .count = last - first,
+        };
+        pool[k].failed = !ns_report_init(&pool[k].report);
+        // A primeira faixa roda nesta thread (e as que não ganharem thread)
+        pool[k].threaded = k > 0 && pthread_create(&pool[k].thread, NULL, report_worker_main, &pool[k]) == 0;
+    }
+    int analyzed_processes = 0;
+    for (int k = 0; k < workers; k++) {
+        if (!pool[k].threaded) report_worker_main(&pool[k]);
+    }
+    // O parcial da primeira faixa vira o relatório; os demais são juntados a ele
+    NsReport report = pool[0].report;
+    bool failed = pool[0].failed;
+    analyzed_processes += pool[0].analyzed;
+    for (int k = 1; k < workers; k++) {
+        if (pool[k].threaded) pthread_join(pool[k].thread, NULL);
+        analyzed_processes += pool[k].analyzed;
+        if (!failed && !pool[k].failed) failed = !ns_report_merge(&report, &pool[k].report);
+        else failed = true;
+        ns_report_free(&pool[k].report);
     }
+    uint64_t elapsed_ns = monotonic_ns() - start_ns;
+    free(pids);
     closedir(proc_dir);
 
     printf("Processos encontrados: %d\n", total_processes);
-    printf("Processos analisados: %d\n", analyzed_processes);
+    printf("Processos analisados: %d (%d thread(s), %.1f ms)\n", analyzed_processes, workers,
+           (double)elapsed_ns / NSEC_PER_MSEC);
     printf("Gerando relatório JSON...\n");
 
-    FILE *fp = fopen(filename, "w");
-    if (fp == NULL) {
-        perror("Não foi possível abrir o arquivo para escrita");
-        return;
-    }
-
-    fprintf(fp, "[\n");
-    NamespaceReportNode *current = report_head;
-    int ns_count = 0;
-    while (current != NULL) {
-        ns_count++;
-        fprintf(fp, "  {\n");
-        fprintf(fp, "    \"type\": \"%s\",\n", current->type);
-        fprintf(fp, "    \"inode\": %lu,\n", current->inode);
-        fprintf(fp, "    \"path\": \"%s\",\n", current->path);
-        fprintf(fp, "    \"pids\": [");
-        PIDNode *pid_node = current->pids;
-        while (pid_node != NULL) {
-            fprintf(fp, "%d%s", pid_node->pid, pid_node->next ? ", " : "");
-            pid_node = pid_node->next;
-        }
-        fprintf(fp, "]\n");
-        fprintf(fp, "  }%s\n", current->next ? "," : "");
-        current = current->next;
-    }
-    fprintf(fp, "]\n");
-    fclose(fp);
-
-    printf("Namespaces únicos encontrados: %d\n", ns_count);
-    printf("\n✓ Relatório salvo em: %s\n", filename);
-
-    // Liberar memória
-    current = report_head;
-    while (current != NULL) {
-        PIDNode *pid_node = current->pids;
-        while (pid_node != NULL) {
-            PIDNode *tmp_pid = pid_node;
-            pid_node = pid_node->next;
-            free(tmp_pid);
-        }
-        NamespaceReportNode *tmp_ns = current;
-        current = current->next;
-        free(tmp_ns);
+    if (failed) {
+        fprintf(stderr, "Erro: Sem memória para o relatório de namespaces\n");
+    } else if (!ns_report_write_json(&report, filename)) {
+        fprintf(stderr, "Erro ao gravar %s: %s\n", filename, strerror(errno));
+    } else {
+        printf("Namespaces únicos encontrados: %d\n", report.count);
+        printf("\n✓ Relatório salvo em: %s\n", filename);
     }
+    ns_report_free(&report);
 }
 
 void measure_namespace_creation_overhead() {
-    struct timespec start, end;
-    long overhead_ns;
-    int status;
-
-    clock_gettime(CLOCK_MONOTONIC, &start);
-
-    pid_t pid = fork();
-    if (pid == 0) {
-        // Processo filho: cria um novo namespace de rede
-        if (unshare(CLONE_NEWNET) != 0) {
-            perror("Falha ao criar novo namespace de rede");
-            exit(EXIT_FAILURE);
-        }
-        exit(EXIT_SUCCESS);
-    } else if (pid > 0) {
-        // Processo pai: aguarda o filho terminar
-        waitpid(pid, &status, 0);
-        clock_gettime(CLOCK_MONOTONIC, &end);
-
-        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
-            overhead_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
-            printf("Overhead de criação de namespace de rede: %ld µs\n", overhead_ns / 1000);
-        } else {
-            fprintf(stderr, "Processo filho falhou em criar o namespace.\n");
-        }
-    } else {
-        perror("Falha no fork");
-    }
+    run_namespace_latency_benchmark(NULL, 0, NS_LATENCY_DEFAULT_REPS, NS_LATENCY_DEFAULT_WARMUP,
+                                    "output/namespace_latency.json");
 }
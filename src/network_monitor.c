@@ -3,13 +3,10 @@
 #include <stdlib.h>
 #include <string.h>
 
-// Lê estatísticas de rede do /proc/[pid]/net/dev
-bool get_network_data(int pid, ResourceData *data) {
-    char filepath[256];
-    snprintf(filepath, sizeof(filepath), "/proc/%d/net/dev", pid);
-
-    FILE *fp = fopen(filepath, "r");
-    if (fp == NULL) {
+// Lê estatísticas de rede do /proc/[pid]/net/dev (todo o namespace de rede)
+static bool read_netns_data(ProcHandle *h, ResourceData *data) {
+    const char *buf = proc_handle_read(h, PROC_FILE_NET_DEV, NULL);
+    if (buf == NULL) {
         // Arquivo pode não existir se o processo não usa a rede, não é um erro fatal
         data->net_rx_bytes = 0;
         data->net_tx_bytes = 0;
@@ -18,30 +15,30 @@ bool get_network_data(int pid, ResourceData *data) {
         return true;
     }
 
-    char line[512];
     long long total_rx_bytes = 0, total_tx_bytes = 0;
     long long total_rx_packets = 0, total_tx_packets = 0;
 
     // Pula as duas primeiras linhas (cabeçalho)
-    fgets(line, sizeof(line), fp);
-    fgets(line, sizeof(line), fp);
+    const char *line = strchr(buf, '\n');
+    if (line) line = strchr(line + 1, '\n');
 
-    while (fgets(line, sizeof(line), fp)) {
+    while (line && *++line) {
         char iface[64];
         long long rx_bytes, tx_bytes, rx_packets, tx_packets;
         // Formato do /proc/net/dev:
         // Inter-|   Receive                                                |  Transmit
         //  face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed
-        sscanf(line, "%63s %lld %lld %*d %*d %*d %*d %*d %*d %lld %lld", 
-               iface, &rx_bytes, &rx_packets, &tx_bytes, &tx_packets);
-
-        // Ignora a interface de loopback
-        if (strcmp(iface, "lo:") != 0) {
-            total_rx_bytes += rx_bytes;
-            total_tx_bytes += tx_bytes;
-            total_rx_packets += rx_packets;
-            total_tx_packets += tx_packets;
+        if (sscanf(line, "%63s %lld %lld %*d %*d %*d %*d %*d %*d %lld %lld", 
+                   iface, &rx_bytes, &rx_packets, &tx_bytes, &tx_packets) == 5) {
+            // Ignora a interface de loopback
+            if (strcmp(iface, "lo:") != 0) {
+                total_rx_bytes += rx_bytes;
+                total_tx_bytes += tx_bytes;
+                total_rx_packets += rx_packets;
+                total_tx_packets += tx_packets;
+            }
         }
+        line = strchr(line, '\n');
     }
 
     data->net_rx_bytes = total_rx_bytes;
@@ -49,6 +46,38 @@ bool get_network_data(int pid, ResourceData *data) {
     data->net_rx_packets = total_rx_packets;
     data->net_tx_packets = total_tx_packets;
 
-    fclose(fp);
     return true;
 }
+
+// Rede do próprio processo: bytes e segmentos do TCP_INFO dos seus sockets
+// TCP, filas de TCP e UDP. Sem acesso aos sockets, usa a visão do namespace.
+bool get_network_data_handle(ProcHandle *h, ProcSockets *sockets, ResourceData *data) {
+    NetUsage usage;
+    if (!proc_sockets_collect(sockets, h, &usage)) {
+        data->net_connections = 0;
+        data->net_rx_queue = 0;
+        data->net_tx_queue = 0;
+        return read_netns_data(h, data);
+    }
+
+    data->net_rx_bytes = (long long)usage.bytes_received;
+    data->net_tx_bytes = (long long)usage.bytes_sent;
+    data->net_rx_packets = (long long)usage.segs_in;
+    data->net_tx_packets = (long long)usage.segs_out;
+    data->net_connections = usage.tcp_sockets;
+    data->net_rx_queue = (long long)usage.rx_queue;
+    data->net_tx_queue = (long long)usage.tx_queue;
+    return true;
+}
+
+bool get_network_data(int pid, ResourceData *data) {
+    ProcHandle h = {0};
+    ProcSockets sockets;
+    proc_sockets_init(&sockets);
+    proc_handle_open(&h, pid);
+    // Mesmo com o PID inválido o contrato é devolver contadores zerados
+    bool ok = get_network_data_handle(&h, &sockets, data);
+    proc_sockets_free(&sockets);
+    proc_handle_close(&h);
+    return ok;
+}
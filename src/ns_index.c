@@ -0,0 +1,508 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/connector.h>
+#include <linux/cn_proc.h>
+#include "../include/ns_index.h"
+#include "../include/timing.h"
+
+#define MIN_PROCS     1024
+#define MIN_SLOTS     256
+#define MIN_ENTRIES   128
+#define SOCKET_RCVBUF (4 << 20)     // rajadas de fork/exit entre duas consultas
+
+// Na ordem em que o kernel lista /proc/<pid>/ns
+static const char *type_names[NS_INDEX_TYPES] = {
+    "net", "uts", "ipc", "pid", "pid_for_children", "user", "mnt", "cgroup", "time", "time_for_children"
+};
+
+// Nome no link (readlink): os *_for_children apontam para o tipo base
+static const char *link_names[NS_INDEX_TYPES] = {
+    "net", "uts", "ipc", "pid", "pid", "user", "mnt", "cgroup", "time", "time"
+};
+
+const char *ns_index_type_name(int type) {
+    return (type >= 0 && type < NS_INDEX_TYPES) ? type_names[type] : NULL;
+}
+
+int ns_index_type(const char *name) {
+    for (int t = 0; t < NS_INDEX_TYPES; t++) {
+        if (strcmp(type_names[t], name) == 0) return t;
+    }
+    return -1;
+}
+
+// ---------- PID -> processo ----------
+
+// Mesmo hash de process_table.c
+static inline size_t pid_hash(int pid, size_t mask) {
+    return ((uint32_t)pid * 2654435761u) & mask;
+}
+
+static NsIndexProc *proc_find(const NsIndex *idx, int pid) {
+    if (pid <= 0) return NULL;
+    size_t mask = idx->proc_cap - 1;
+    for (size_t i = pid_hash(pid, mask); ; i = (i + 1) & mask) {
+        if (idx->procs[i].pid == pid) return &idx->procs[i];
+        if (idx->procs[i].pid == 0) return NULL;
+    }
+}
+
+static bool procs_grow(NsIndex *idx) {
+    size_t new_cap = idx->proc_cap * 2;
+    NsIndexProc *grown = calloc(new_cap, sizeof(NsIndexProc));
+    if (!grown) return false;
+    size_t mask = new_cap - 1;
+    for (size_t i = 0; i < idx->proc_cap; i++) {
+        if (idx->procs[i].pid == 0) continue;
+        size_t j = pid_hash(idx->procs[i].pid, mask);
+        while (grown[j].pid != 0) j = (j + 1) & mask;
+        grown[j] = idx->procs[i];
+    }
+    free(idx->procs);
+    idx->procs = grown;
+    idx->proc_cap = new_cap;
+    return true;
+}
+
+// Processo do PID, criado (sem namespaces) se necessário
+static NsIndexProc *proc_insert(NsIndex *idx, int pid) {
+    NsIndexProc *p = proc_find(idx, pid);
+    if (p) return p;
+    if ((idx->proc_count + 1) * 2 > idx->proc_cap && !procs_grow(idx)) return NULL;
+
+    size_t mask = idx->proc_cap - 1;
+    size_t i = pid_hash(pid, mask);
+    while (idx->procs[i].pid != 0) i = (i + 1) & mask;
+    p = &idx->procs[i];
+    p->pid = pid;
+    p->scan = idx->scan;
+    for (int t = 0; t < NS_INDEX_TYPES; t++) {
+        p->entry[t] = -1;
+        p->pos[t] = -1;
+    }
+    idx->proc_count++;
+    return p;
+}
+
+// Remoção por deslocamento reverso (como em process_table.c)
+static void proc_remove_at(NsIndex *idx, size_t i) {
+    size_t mask = idx->proc_cap - 1;
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (idx->procs[j].pid == 0) break;
+        size_t home = pid_hash(idx->procs[j].pid, mask);
+        bool between = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!between) {
+            idx->procs[i] = idx->procs[j];
+            i = j;
+        }
+    }
+    memset(&idx->procs[i], 0, sizeof(NsIndexProc));
+    idx->proc_count--;
+}
+
+// ---------- (tipo, inode) -> entrada ----------
+
+static inline size_t ns_hash(int type, unsigned long inode, size_t mask) {
+    uint64_t h = ((uint64_t)inode ^ ((uint64_t)type << 56)) * 0x9e3779b97f4a7c15ULL;
+    return (size_t)(h >> 32) & mask;
+}
+
+// Slot da chave: ocupado por ela ou o vazio onde ela entraria
+static size_t ns_slot(const NsIndex *idx, int type, unsigned long inode) {
+    for (size_t i = ns_hash(type, inode, idx->slot_mask); ; i = (i + 1) & idx->slot_mask) {
+        int32_t e = idx->slots[i];
+        if (e < 0 || (idx->entries[e].inode == inode && idx->entries[e].type == type)) return i;
+    }
+}
+
+static bool slots_grow(NsIndex *idx) {
+    size_t cap = (idx->slot_mask + 1) * 2;
+    int32_t *grown = malloc(cap * sizeof(int32_t));
+    if (!grown) return false;
+    memset(grown, 0xff, cap * sizeof(int32_t));
+    free(idx->slots);
+    idx->slots = grown;
+    idx->slot_mask = cap - 1;
+    for (int32_t e = 0; e < idx->entry_used; e++) {
+        if (idx->entries[e].count > 0) idx->slots[ns_slot(idx, idx->entries[e].type, idx->entries[e].inode)] = e;
+    }
+    return true;
+}
+
+static void slot_remove_at(NsIndex *idx, size_t i) {
+    size_t mask = idx->slot_mask;
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        int32_t e = idx->slots[j];
+        if (e < 0) break;
+        size_t home = ns_hash(idx->entries[e].type, idx->entries[e].inode, mask);
+        bool between = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!between) {
+            idx->slots[i] = e;
+            i = j;
+        }
+    }
+    idx->slots[i] = -1;
+}
+
+// Entrada da chave, criada vazia se nova; -1 se sem memória
+static int32_t entry_get(NsIndex *idx, int type, unsigned long inode) {
+    size_t slot = ns_slot(idx, type, inode);
+    if (idx->slots[slot] >= 0) return idx->slots[slot];
+
+    if ((idx->ns_count + 1) * 2 > idx->slot_mask + 1) {
+        if (!slots_grow(idx)) return -1;
+        slot = ns_slot(idx, type, inode);
+    }
+    int32_t e = idx->free_entry;
+    if (e >= 0) {
+        idx->free_entry = idx->entries[e].next_free;
+    } else {
+        if (idx->entry_used == idx->entry_cap) {
+            int32_t cap = idx->entry_cap * 2;
+            NsIndexEntry *grown = realloc(idx->entries, (size_t)cap * sizeof(NsIndexEntry));
+            if (!grown) return -1;
+            idx->entries = grown;
+            idx->entry_cap = cap;
+        }
+        e = idx->entry_used++;
+        memset(&idx->entries[e], 0, sizeof(NsIndexEntry));
+    }
+    NsIndexEntry *entry = &idx->entries[e];
+    entry->inode = inode;
+    entry->type = type;
+    entry->count = 0;
+    entry->next_free = -1;
+    idx->slots[slot] = e;
+    idx->ns_count++;
+    return e;
+}
+
+// Tira o processo do namespace do tipo; entradas vazias voltam à lista livre
+static void detach(NsIndex *idx, NsIndexProc *p, int type) {
+    int32_t e = p->entry[type];
+    if (e < 0) return;
+    NsIndexEntry *entry = &idx->entries[e];
+    int32_t pos = p->pos[type];
+    int moved = entry->pids[--entry->count];
+    if (pos < entry->count) {
+        entry->pids[pos] = moved;
+        NsIndexProc *other = proc_find(idx, moved);
+        if (other) other->pos[type] = pos;
+    }
+    p->entry[type] = -1;
+    p->pos[type] = -1;
+
+    if (entry->count == 0) {
+        slot_remove_at(idx, ns_slot(idx, entry->type, entry->inode));
+        entry->next_free = idx->free_entry;
+        idx->free_entry = e;
+        idx->ns_count--;
+    }
+}
+
+static bool attach(NsIndex *idx, NsIndexProc *p, int type, unsigned long inode) {
+    int32_t e = entry_get(idx, type, inode);
+    if (e < 0) return false;
+    NsIndexEntry *entry = &idx->entries[e];
+    if (entry->count == entry->cap) {
+        int cap = entry->cap ? entry->cap * 2 : 4;
+        int *grown = realloc(entry->pids, (size_t)cap * sizeof(int));
+        if (!grown) return false;
+        entry->pids = grown;
+        entry->cap = cap;
+    }
+    p->entry[type] = e;
+    p->pos[type] = entry->count;
+    entry->pids[entry->count++] = p->pid;
+    return true;
+}
+
+static void proc_drop(NsIndex *idx, int pid) {
+    NsIndexProc *p = proc_find(idx, pid);
+    if (!p) return;
+    for (int t = 0; t < NS_INDEX_TYPES; t++) detach(idx, p, t);
+    proc_remove_at(idx, (size_t)(p - idx->procs));
+}
+
+// Relê os namespaces do PID. Retorna 1 se algo mudou, 0 se não, -1 se o
+// processo não existe mais (removido do índice) ou faltou memória.
+static int proc_read(NsIndex *idx, int pid) {
+    NamespaceInfo ns[NS_INDEX_TYPES + 2];
+    int n = get_process_namespaces_at(idx->proc_fd, pid, ns, NS_INDEX_TYPES + 2);
+    if (n < 0) {
+        proc_drop(idx, pid);
+        return -1;
+    }
+    unsigned long inodes[NS_INDEX_TYPES] = { 0 };
+    for (int i = 0; i < n; i++) {
+        int t = ns_index_type(ns[i].type);
+        if (t >= 0) inodes[t] = ns[i].inode;
+    }
+
+    bool known = proc_find(idx, pid) != NULL;
+    NsIndexProc *p = proc_insert(idx, pid);
+    if (!p) return -1;
+    p->scan = idx->scan;
+    int changed = known ? 0 : 1;
+    for (int t = 0; t < NS_INDEX_TYPES; t++) {
+        unsigned long current = p->entry[t] >= 0 ? idx->entries[p->entry[t]].inode : 0;
+        if (current == inodes[t]) continue;
+        changed = 1;
+        detach(idx, p, t);
+        if (inodes[t] != 0 && !attach(idx, p, t, inodes[t])) return -1;
+    }
+    return changed;
+}
+
+// ---------- Varredura ----------
+
+bool ns_index_rescan(NsIndex *idx) {
+    uint64_t start = monotonic_ns();
+    int dir_fd = openat(idx->proc_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR *d = dir_fd >= 0 ? fdopendir(dir_fd) : NULL;
+    if (!d) {
+        perror("Não foi possível abrir /proc");
+        if (dir_fd >= 0) close(dir_fd);
+        return false;
+    }
+
+    idx->scan++;
+    uint64_t fixed = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_type != DT_DIR || !isdigit((unsigned char)entry->d_name[0])) continue;
+        int pid = atoi(entry->d_name);
+        bool known = proc_find(idx, pid) != NULL;
+        if (proc_read(idx, pid) > 0 && known) fixed++;
+    }
+    closedir(d);
+
+    // Processos que sumiram sem EXIT visto
+    int *gone = NULL;
+    size_t gone_count = 0;
+    for (size_t i = 0; i < idx->proc_cap; i++) {
+        if (idx->procs[i].pid == 0 || idx->procs[i].scan == idx->scan) continue;
+        int *grown = realloc(gone, (gone_count + 1) * sizeof(int));
+        if (!grown) break;
+        gone = grown;
+        gone[gone_count++] = idx->procs[i].pid;
+    }
+    for (size_t i = 0; i < gone_count; i++) proc_drop(idx, gone[i]);
+    free(gone);
+
+    if (idx->scans > 0) idx->fixed += fixed + gone_count;
+    idx->scans++;
+    idx->stale = false;
+    idx->last_scan_ns = monotonic_ns();
+    idx->last_scan_cost_ns = idx->last_scan_ns - start;
+    return true;
+}
+
+bool ns_index_init(NsIndex *idx, uint64_t rescan_ns) {
+    memset(idx, 0, sizeof(NsIndex));
+    idx->nl_fd = -1;
+    idx->proc_fd = -1;
+    idx->free_entry = -1;
+    idx->rescan_ns = rescan_ns ? rescan_ns : NS_INDEX_RESCAN_NS;
+    idx->proc_cap = MIN_PROCS;
+    idx->procs = calloc(MIN_PROCS, sizeof(NsIndexProc));
+    idx->entry_cap = MIN_ENTRIES;
+    idx->entries = malloc(MIN_ENTRIES * sizeof(NsIndexEntry));
+    idx->slots = malloc(MIN_SLOTS * sizeof(int32_t));
+    idx->slot_mask = MIN_SLOTS - 1;
+    idx->proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (!idx->procs || !idx->entries || !idx->slots || idx->proc_fd < 0) {
+        fprintf(stderr, "Erro ao criar o índice de namespaces: %s\n", strerror(errno ? errno : ENOMEM));
+        ns_index_close(idx);
+        return false;
+    }
+    memset(idx->slots, 0xff, MIN_SLOTS * sizeof(int32_t));
+    if (!ns_index_rescan(idx)) {
+        ns_index_close(idx);
+        return false;
+    }
+    return true;
+}
+
+void ns_index_close(NsIndex *idx) {
+    if (idx->nl_fd >= 0) close(idx->nl_fd);
+    if (idx->proc_fd >= 0) close(idx->proc_fd);
+    for (int32_t e = 0; idx->entries && e < idx->entry_used; e++) free(idx->entries[e].pids);
+    free(idx->entries);
+    free(idx->slots);
+    free(idx->procs);
+    memset(idx, 0, sizeof(NsIndex));
+    idx->nl_fd = -1;
+    idx->proc_fd = -1;
+}
+
+// ---------- Proc connector ----------
+
+// Mensagem de controle: nlmsghdr + cn_msg + operação
+static bool connector_send(int fd, enum proc_cn_mcast_op op) {
+    char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))] __attribute__((aligned(NLMSG_ALIGNTO)));
+    memset(buf, 0, sizeof(buf));
+    struct nlmsghdr *n = (struct nlmsghdr *)buf;
+    n->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+    n->nlmsg_type = NLMSG_DONE;
+    n->nlmsg_pid = 0;
+    struct cn_msg *msg = NLMSG_DATA(n);
+    msg->id.idx = CN_IDX_PROC;
+    msg->id.val = CN_VAL_PROC;
+    msg->len = sizeof(op);
+    memcpy(msg->data, &op, sizeof(op));
+    return send(fd, buf, n->nlmsg_len, 0) == (ssize_t)n->nlmsg_len;
+}
+
+bool ns_index_listen(NsIndex *idx) {
+    if (idx->nl_fd >= 0) return true;
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd < 0) {
+        fprintf(stderr, "Aviso: Proc connector indisponível (%s); índice atualizado só por varreduras\n",
+                strerror(errno));
+        return false;
+    }
+    int rcvbuf = SOCKET_RCVBUF;
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK, .nl_groups = CN_IDX_PROC };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || !connector_send(fd, PROC_CN_MCAST_LISTEN)) {
+        fprintf(stderr, "Aviso: Proc connector indisponível (%s); índice atualizado só por varreduras\n",
+                strerror(errno));
+        close(fd);
+        return false;
+    }
+    idx->nl_fd = fd;
+    // Processos criados entre a varredura inicial e a inscrição
+    idx->stale = true;
+    return true;
+}
+
+static void handle_event(NsIndex *idx, const struct proc_event *ev) {
+    switch (ev->what) {
+        case PROC_EVENT_FORK:
+            // Threads novas (child_pid != child_tgid) não mudam o índice
+            if (ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid) {
+                idx->forks++;
+                proc_read(idx, ev->event_data.fork.child_tgid);
+            }
+            break;
+        case PROC_EVENT_EXEC:
+            idx->execs++;
+            proc_read(idx, ev->event_data.exec.process_tgid);
+            break;
+        case PROC_EVENT_EXIT:
+            if (ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid) {
+                idx->exits++;
+                proc_drop(idx, ev->event_data.exit.process_tgid);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+int ns_index_dispatch(NsIndex *idx) {
+    if (idx->nl_fd < 0) return 0;
+    char buf[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+    int events = 0;
+    for (;;) {
+        ssize_t len = recv(idx->nl_fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS) {
+                // O kernel descartou eventos: só uma varredura recupera
+                idx->lost++;
+                idx->stale = true;
+                continue;
+            }
+            break;
+        }
+        for (struct nlmsghdr *n = (struct nlmsghdr *)buf; NLMSG_OK(n, (size_t)len); n = NLMSG_NEXT(n, len)) {
+            if (n->nlmsg_type == NLMSG_ERROR || n->nlmsg_type == NLMSG_NOOP) continue;
+            if (n->nlmsg_len < NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(struct proc_event))) continue;
+            const struct cn_msg *msg = NLMSG_DATA(n);
+            if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC) continue;
+            handle_event(idx, (const struct proc_event *)msg->data);
+            events++;
+        }
+    }
+    return events;
+}
+
+bool ns_index_poll(NsIndex *idx) {
+    ns_index_dispatch(idx);
+    if (idx->nl_fd < 0 || idx->stale || monotonic_ns() - idx->last_scan_ns >= idx->rescan_ns) {
+        return ns_index_rescan(idx);
+    }
+    return true;
+}
+
+// ---------- Consultas ----------
+
+int ns_index_get(const NsIndex *idx, int pid, NamespaceInfo *ns_info, int max_ns) {
+    const NsIndexProc *p = proc_find(idx, pid);
+    if (!p) return -1;
+    int count = 0;
+    for (int t = 0; t < NS_INDEX_TYPES && count < max_ns; t++) {
+        if (p->entry[t] < 0) continue;
+        NamespaceInfo *ns = &ns_info[count++];
+        memset(ns, 0, sizeof(*ns));
+        strcpy(ns->type, type_names[t]);
+        ns->inode = idx->entries[p->entry[t]].inode;
+        snprintf(ns->path, sizeof(ns->path), "%s:[%lu]", link_names[t], ns->inode);
+    }
+    return count;
+}
+
+const int *ns_index_members(const NsIndex *idx, int type, unsigned long inode, int *count) {
+    *count = 0;
+    if (type < 0 || type >= NS_INDEX_TYPES) return NULL;
+    int32_t e = idx->slots[ns_slot(idx, type, inode)];
+    if (e < 0) return NULL;
+    *count = idx->entries[e].count;
+    return idx->entries[e].pids;
+}
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+bool ns_index_report(const NsIndex *idx, NsReport *out) {
+    if (!ns_report_init(out)) return false;
+    int *pids = malloc((idx->proc_count + 1) * sizeof(int));
+    if (!pids) {
+        ns_report_free(out);
+        return false;
+    }
+    size_t n = 0;
+    for (size_t i = 0; i < idx->proc_cap; i++) {
+        if (idx->procs[i].pid != 0) pids[n++] = idx->procs[i].pid;
+    }
+    qsort(pids, n, sizeof(int), compare_int);
+
+    bool ok = true;
+    NamespaceInfo ns[NS_INDEX_TYPES];
+    for (size_t i = 0; i < n && ok; i++) {
+        int count = ns_index_get(idx, pids[i], ns, NS_INDEX_TYPES);
+        for (int k = 0; k < count && ok; k++) ok = ns_report_add(out, &ns[k], pids[i]);
+    }
+    free(pids);
+    if (!ok) ns_report_free(out);
+    return ok;
+}
@@ -0,0 +1,518 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/veth.h>
+#include "../include/ns_latency.h"
+#include "../include/serializer.h"
+#include "../include/timing.h"
+
+#ifndef CLONE_NEWTIME
+#define CLONE_NEWTIME 0x00000080
+#endif
+
+#define TEARDOWN_TIMEOUT_MS 10000
+#define NL_BUF_SIZE         8192
+
+// Argumentos do clone3 (linux/sched.h, só os campos usados)
+struct clone3_args {
+    uint64_t flags;
+    uint64_t pidfd;
+    uint64_t child_tid;
+    uint64_t parent_tid;
+    uint64_t exit_signal;
+    uint64_t stack;
+    uint64_t stack_size;
+    uint64_t tls;
+};
+
+static const struct {
+    const char *name;
+    int flag;
+} ns_types[] = {
+    { "pid", CLONE_NEWPID },
+    { "net", CLONE_NEWNET },
+    { "mnt", CLONE_NEWNS },
+    { "uts", CLONE_NEWUTS },
+    { "ipc", CLONE_NEWIPC },
+    { "user", CLONE_NEWUSER },
+    { "cgroup", CLONE_NEWCGROUP },
+    { "time", CLONE_NEWTIME },
+};
+#define NUM_TYPES ((int)(sizeof(ns_types) / sizeof(ns_types[0])))
+
+// Combinações típicas: padrão do Docker, com cgroup, rootless e tudo
+static const char *combo_sets[] = {
+    "pid+net+mnt+uts+ipc",
+    "pid+net+mnt+uts+ipc+cgroup",
+    "user+pid+net+mnt+uts+ipc+cgroup",
+    "all",
+};
+
+bool ns_latency_parse_set(const char *spec, int *flags) {
+    *flags = 0;
+    if (strcmp(spec, "all") == 0) {
+        for (int t = 0; t < NUM_TYPES; t++) *flags |= ns_types[t].flag;
+        return true;
+    }
+    const char *p = spec;
+    while (*p) {
+        size_t len = strcspn(p, "+");
+        int t = 0;
+        while (t < NUM_TYPES && !(strlen(ns_types[t].name) == len && strncmp(ns_types[t].name, p, len) == 0)) t++;
+        if (t == NUM_TYPES) return false;
+        *flags |= ns_types[t].flag;
+        p += len;
+        if (*p == '+') p++;
+    }
+    return *flags != 0;
+}
+
+int ns_latency_default_sets(const char **sets, int max) {
+    int n = 0;
+    for (int t = 0; t < NUM_TYPES && n < max; t++) sets[n++] = ns_types[t].name;
+    for (size_t c = 0; c < sizeof(combo_sets) / sizeof(combo_sets[0]) && n < max; c++) sets[n++] = combo_sets[c];
+    return n;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Quantil pelo posto mais próximo (amostras ordenadas)
+static uint64_t quantile(const uint64_t *sorted, int count, double q) {
+    int rank = (int)(q * count + 0.999999);
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+void ns_latency_hist(NsLatencyHist *h, uint64_t *samples, int count) {
+    memset(h, 0, sizeof(NsLatencyHist));
+    if (count <= 0) return;
+    qsort(samples, (size_t)count, sizeof(uint64_t), compare_u64);
+    h->count = count;
+    h->min_ns = samples[0];
+    h->max_ns = samples[count - 1];
+    h->p50_ns = quantile(samples, count, 0.50);
+    h->p90_ns = quantile(samples, count, 0.90);
+    h->p99_ns = quantile(samples, count, 0.99);
+    double sum = 0;
+    for (int i = 0; i < count; i++) {
+        sum += (double)samples[i];
+        uint64_t us = samples[i] / 1000;
+        int b = 0;
+        while (us >= 2 && b < NS_LATENCY_BUCKETS - 1) {
+            us >>= 1;
+            b++;
+        }
+        h->buckets[b]++;
+    }
+    h->mean_ns = sum / count;
+}
+
+// ---------- Criação ----------
+
+// Um filho por repetição mede só o unshare; o resultado volta por uma
+// página compartilhada (tempo, errno)
+static int measure_unshare(int flags, int reps, int warmup, uint64_t *samples) {
+    uint64_t *shared = mmap(NULL, 2 * sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) return errno;
+    int error = 0;
+    for (int i = -warmup; i < reps && !error; i++) {
+        shared[0] = 0;
+        shared[1] = 0;
+        pid_t pid = fork();
+        if (pid == 0) {
+            uint64_t t0 = monotonic_ns();
+            int rc = unshare(flags);
+            uint64_t t1 = monotonic_ns();
+            shared[0] = t1 - t0;
+            shared[1] = rc == 0 ? 0 : (uint64_t)errno;
+            _exit(0);
+        }
+        if (pid < 0) {
+            error = errno;
+            break;
+        }
+        waitpid(pid, NULL, 0);
+        if (shared[1]) error = (int)shared[1];
+        else if (i >= 0) samples[i] = shared[0];
+    }
+    munmap(shared, 2 * sizeof(uint64_t));
+    return error;
+}
+
+// Ciclo completo clone3 + _exit + waitpid, medido no pai
+static int measure_clone3(int flags, int reps, int warmup, uint64_t *samples) {
+    for (int i = -warmup; i < reps; i++) {
+        struct clone3_args args;
+        memset(&args, 0, sizeof(args));
+        args.flags = (uint64_t)flags;
+        args.exit_signal = SIGCHLD;
+        uint64_t t0 = monotonic_ns();
+        long pid = syscall(SYS_clone3, &args, sizeof(args));
+        if (pid == 0) _exit(0);
+        if (pid < 0) return errno;
+        waitpid((pid_t)pid, NULL, 0);
+        if (i >= 0) samples[i] = monotonic_ns() - t0;
+    }
+    return 0;
+}
+
+// ---------- Destruição do netns ----------
+
+static void nl_attr(struct nlmsghdr *n, unsigned short type, const void *data, size_t len) {
+    struct rtattr *rta = (struct rtattr *)((char *)n + NLMSG_ALIGN(n->nlmsg_len));
+    rta->rta_type = type;
+    rta->rta_len = (unsigned short)RTA_LENGTH(len);
+    if (len) memcpy(RTA_DATA(rta), data, len);
+    n->nlmsg_len = NLMSG_ALIGN(n->nlmsg_len) + RTA_ALIGN(rta->rta_len);
+}
+
+static struct rtattr *nl_nest_begin(struct nlmsghdr *n, unsigned short type) {
+    struct rtattr *nest = (struct rtattr *)((char *)n + NLMSG_ALIGN(n->nlmsg_len));
+    nl_attr(n, type, NULL, 0);
+    return nest;
+}
+
+static void nl_nest_end(struct nlmsghdr *n, struct rtattr *nest) {
+    nest->rta_len = (unsigned short)((char *)n + n->nlmsg_len - (char *)nest);
+}
+
+// Cria o par veth host_name <-> eth0, com a segunda ponta no netns de pid.
+// Retorna 0 ou errno.
+static int create_veth(int nl, const char *host_name, pid_t pid) {
+    char buf[1024] __attribute__((aligned(NLMSG_ALIGNTO)));
+    memset(buf, 0, sizeof(buf));
+    struct nlmsghdr *n = (struct nlmsghdr *)buf;
+    n->nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+    n->nlmsg_type = RTM_NEWLINK;
+    n->nlmsg_flags = NLM_F_REQUEST | NLM_F_CREATE | NLM_F_EXCL | NLM_F_ACK;
+    n->nlmsg_seq = 1;
+
+    nl_attr(n, IFLA_IFNAME, host_name, strlen(host_name) + 1);
+    struct rtattr *linkinfo = nl_nest_begin(n, IFLA_LINKINFO);
+    nl_attr(n, IFLA_INFO_KIND, "veth", 5);
+    struct rtattr *data = nl_nest_begin(n, IFLA_INFO_DATA);
+    struct rtattr *peer = nl_nest_begin(n, VETH_INFO_PEER);
+    n->nlmsg_len += NLMSG_ALIGN(sizeof(struct ifinfomsg));     // ifinfomsg do par (zerado)
+    nl_attr(n, IFLA_IFNAME, "eth0", 5);
+    uint32_t ns_pid = (uint32_t)pid;
+    nl_attr(n, IFLA_NET_NS_PID, &ns_pid, sizeof(ns_pid));
+    nl_nest_end(n, peer);
+    nl_nest_end(n, data);
+    nl_nest_end(n, linkinfo);
+
+    if (send(nl, n, n->nlmsg_len, 0) < 0) return errno;
+    ssize_t len = recv(nl, buf, sizeof(buf), 0);
+    if (len < 0) return errno;
+    struct nlmsghdr *h = (struct nlmsghdr *)buf;
+    if (!NLMSG_OK(h, (size_t)len) || h->nlmsg_type != NLMSG_ERROR) return EPROTO;
+    const struct nlmsgerr *err = NLMSG_DATA(h);
+    return -err->error;
+}
+
+// Espera o RTM_DELLINK da interface. Retorna false no timeout.
+static bool wait_dellink(int mon, int ifindex) {
+    char buf[NL_BUF_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+    uint64_t deadline = monotonic_ns() + (uint64_t)TEARDOWN_TIMEOUT_MS * NSEC_PER_MSEC;
+    for (;;) {
+        uint64_t now = monotonic_ns();
+        if (now >= deadline) return false;
+        struct pollfd pfd = { .fd = mon, .events = POLLIN };
+        if (poll(&pfd, 1, (int)((deadline - now) / NSEC_PER_MSEC) + 1) <= 0) continue;
+        ssize_t len = recv(mon, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR || errno == ENOBUFS) continue;
+            return false;
+        }
+        for (struct nlmsghdr *h = (struct nlmsghdr *)buf; NLMSG_OK(h, (size_t)len); h = NLMSG_NEXT(h, len)) {
+            if (h->nlmsg_type != RTM_DELLINK) continue;
+            const struct ifinfomsg *ifi = NLMSG_DATA(h);
+            if (ifi->ifi_index == ifindex) return true;
+        }
+    }
+}
+
+static void drain(int fd) {
+    char buf[NL_BUF_SIZE];
+    while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {}
+}
+
+// Filho com netns próprio e uma ponta de veth nele; ao sair (último
+// processo do netns) o kernel destrói o netns em segundo plano e, com ele,
+// o veth: o RTM_DELLINK da ponta no host marca o fim da destruição
+static int measure_netns_teardown(int reps, int warmup, uint64_t *samples) {
+    int nl = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    int mon = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK, .nl_groups = RTMGRP_LINK };
+    int error = 0;
+    if (nl < 0 || mon < 0 || bind(mon, (struct sockaddr *)&addr, sizeof(addr)) < 0) error = errno;
+
+    char host_name[IFNAMSIZ];
+    snprintf(host_name, sizeof(host_name), "rmlat%d", (int)(getpid() % 100000));
+    for (int i = -warmup; i < reps && !error; i++) {
+        int ready[2], go[2];
+        if (pipe(ready) != 0) {
+            error = errno;
+            break;
+        }
+        if (pipe(go) != 0) {
+            error = errno;
+            close(ready[0]);
+            close(ready[1]);
+            break;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(ready[0]);
+            close(go[1]);
+            char c = unshare(CLONE_NEWNET) == 0 ? 'y' : 'n';
+            if (write(ready[1], &c, 1) != 1) _exit(1);
+            if (read(go[0], &c, 1) < 0) _exit(1);      // EOF: pai mandou sair
+            _exit(0);
+        }
+        close(ready[1]);
+        close(go[0]);
+        char c = 'n';
+        if (pid < 0 || read(ready[0], &c, 1) != 1 || c != 'y') error = pid < 0 ? errno : EPERM;
+        close(ready[0]);
+
+        int ifindex = 0;
+        if (!error) {
+            error = create_veth(nl, host_name, pid);
+            ifindex = error ? 0 : (int)if_nametoindex(host_name);
+            if (!error && ifindex == 0) error = ENODEV;
+        }
+        drain(mon);
+        close(go[1]);
+        if (pid > 0) waitpid(pid, NULL, 0);
+        uint64_t t0 = monotonic_ns();
+        if (error) break;
+        if (!wait_dellink(mon, ifindex)) {
+            error = ETIMEDOUT;
+            break;
+        }
+        if (i >= 0) samples[i] = monotonic_ns() - t0;
+    }
+    if (nl >= 0) close(nl);
+    if (mon >= 0) close(mon);
+    return error;
+}
+
+// ---------- Execução ----------
+
+bool ns_latency_run(NsLatencyReport *r, const char **sets, int nsets, int repetitions, int warmup) {
+    memset(r, 0, sizeof(NsLatencyReport));
+    r->repetitions = repetitions > 0 ? repetitions : NS_LATENCY_DEFAULT_REPS;
+    r->warmup = warmup >= 0 ? warmup : NS_LATENCY_DEFAULT_WARMUP;
+
+    const char *defaults[NS_LATENCY_MAX_SETS];
+    if (!sets || nsets <= 0) {
+        sets = defaults;
+        nsets = ns_latency_default_sets(defaults, NS_LATENCY_MAX_SETS);
+    }
+    if (nsets > NS_LATENCY_MAX_SETS) nsets = NS_LATENCY_MAX_SETS;
+
+    uint64_t *samples = malloc((size_t)r->repetitions * sizeof(uint64_t));
+    if (!samples) {
+        fprintf(stderr, "Erro: Sem memória para %d repetições\n", r->repetitions);
+        return false;
+    }
+
+    // Custo do fork: o mesmo ciclo do clone3 sem namespaces
+    int error = measure_clone3(0, r->repetitions, r->warmup, samples);
+    if (error) {
+        fprintf(stderr, "Erro no clone3: %s\n", strerror(error));
+        free(samples);
+        return false;
+    }
+    ns_latency_hist(&r->fork_baseline, samples, r->repetitions);
+    uint64_t baseline = r->fork_baseline.p50_ns;
+
+    for (int s = 0; s < nsets; s++) {
+        NsLatencyResult *res = &r->results[r->count];
+        memset(res, 0, sizeof(*res));
+        if (!ns_latency_parse_set(sets[s], &res->flags)) {
+            fprintf(stderr, "Aviso: Conjunto de namespaces inválido: %s\n", sets[s]);
+            continue;
+        }
+        snprintf(res->name, sizeof(res->name), "%s", sets[s]);
+        r->count++;
+        printf("  %-34s", res->name);
+        fflush(stdout);
+
+        res->error = measure_unshare(res->flags, r->repetitions, r->warmup, samples);
+        if (!res->error) {
+            ns_latency_hist(&res->unshare, samples, r->repetitions);
+            res->error = measure_clone3(res->flags, r->repetitions, r->warmup, samples);
+        }
+        if (!res->error) {
+            for (int i = 0; i < r->repetitions; i++) samples[i] = samples[i] > baseline ? samples[i] - baseline : 0;
+            ns_latency_hist(&res->clone3, samples, r->repetitions);
+        }
+        printf("%s\n", res->error ? strerror(res->error) : "ok");
+    }
+
+    printf("  %-34s", "netns (destruicao)");
+    fflush(stdout);
+    r->teardown_error = measure_netns_teardown(r->repetitions, r->warmup, samples);
+    if (!r->teardown_error) ns_latency_hist(&r->netns_teardown, samples, r->repetitions);
+    printf("%s\n", r->teardown_error ? strerror(r->teardown_error) : "ok");
+
+    free(samples);
+    return true;
+}
+
+// ---------- Saída ----------
+
+static void print_row(const char *name, const char *mode, const NsLatencyHist *h) {
+    printf("%-34s | %-7s | %9.1f | %9.1f | %9.1f | %9.1f | %9.1f\n", name, mode, h->min_ns / 1e3, h->p50_ns / 1e3,
+           h->p90_ns / 1e3, h->p99_ns / 1e3, h->max_ns / 1e3);
+}
+
+// Barras do histograma log2 (só baldes ocupados)
+static void print_hist(const NsLatencyHist *h) {
+    uint32_t peak = 0;
+    for (int b = 0; b < NS_LATENCY_BUCKETS; b++) {
+        if (h->buckets[b] > peak) peak = h->buckets[b];
+    }
+    for (int b = 0; b < NS_LATENCY_BUCKETS && peak; b++) {
+        if (!h->buckets[b]) continue;
+        char label[32];
+        if (b == 0) snprintf(label, sizeof(label), "< 2 us");
+        else snprintf(label, sizeof(label), "%u-%u us", 1u << b, 1u << (b + 1));
+        int width = (int)(40.0 * h->buckets[b] / peak + 0.5);
+        printf("  %16s | %-40.*s %u\n", label, width, "########################################", h->buckets[b]);
+    }
+}
+
+void ns_latency_print(const NsLatencyReport *r) {
+    printf("\nLatência de criação de namespaces (us), %d repetições, %d de aquecimento\n", r->repetitions, r->warmup);
+    printf("unshare: só a chamada, medida no filho | clone3: ciclo completo menos o fork (p50 %.1f us)\n\n",
+           r->fork_baseline.p50_ns / 1e3);
+    printf("%-34s | %-7s | %9s | %9s | %9s | %9s | %9s\n", "Conjunto", "Modo", "min", "p50", "p90", "p99", "max");
+    printf("-----------------------------------|---------|-----------|-----------|-----------|-----------|----------\n");
+    print_row("(fork, sem namespaces)", "clone3", &r->fork_baseline);
+    for (int i = 0; i < r->count; i++) {
+        const NsLatencyResult *res = &r->results[i];
+        if (res->error) {
+            printf("%-34s | %-7s | %s\n", res->name, "-", strerror(res->error));
+            continue;
+        }
+        print_row(res->name, "unshare", &res->unshare);
+        print_row(res->name, "clone3", &res->clone3);
+    }
+
+    printf("\nDestruição do netns (término do processo -> RTM_DELLINK do veth):\n");
+    if (r->teardown_error) {
+        printf("  não medida: %s\n", strerror(r->teardown_error));
+        return;
+    }
+    print_row("netns", "cleanup", &r->netns_teardown);
+    print_hist(&r->netns_teardown);
+    if (r->netns_teardown.p50_ns > 0) {
+        // Limite inferior: destruições simultâneas são agrupadas pelo kernel
+        printf("\nDestruição sequencial (1 / p50): ~%.0f netns/s\n", 1e9 / r->netns_teardown.p50_ns);
+    }
+}
+
+static void json_hist(OutBuf *o, const char *key, const NsLatencyHist *h, bool last) {
+    out_lit(o, "      \"");
+    out_write(o, key, strlen(key));
+    out_lit(o, "\": {\"count\": ");
+    out_i64(o, h->count);
+    out_lit(o, ", \"min_ns\": ");
+    out_u64(o, h->min_ns);
+    out_lit(o, ", \"p50_ns\": ");
+    out_u64(o, h->p50_ns);
+    out_lit(o, ", \"p90_ns\": ");
+    out_u64(o, h->p90_ns);
+    out_lit(o, ", \"p99_ns\": ");
+    out_u64(o, h->p99_ns);
+    out_lit(o, ", \"max_ns\": ");
+    out_u64(o, h->max_ns);
+    out_lit(o, ", \"mean_ns\": ");
+    out_fixed(o, h->mean_ns, 1);
+    out_lit(o, ", \"log2_us_buckets\": [");
+    int last_bucket = NS_LATENCY_BUCKETS - 1;
+    while (last_bucket > 0 && h->buckets[last_bucket] == 0) last_bucket--;
+    for (int b = 0; b <= last_bucket; b++) {
+        if (b > 0) out_lit(o, ", ");
+        out_u64(o, h->buckets[b]);
+    }
+    if (last) out_lit(o, "]}\n");
+    else out_lit(o, "]},\n");
+}
+
+bool ns_latency_write_json(const NsLatencyReport *r, const char *filename) {
+    OutBuf o;
+    if (!out_open(&o, filename)) return false;
+    out_lit(&o, "{\n  \"repetitions\": ");
+    out_i64(&o, r->repetitions);
+    out_lit(&o, ",\n  \"warmup\": ");
+    out_i64(&o, r->warmup);
+    out_lit(&o, ",\n  \"baseline\": {\n");
+    json_hist(&o, "fork_clone3", &r->fork_baseline, true);
+    out_lit(&o, "  },\n  \"sets\": [\n");
+    for (int i = 0; i < r->count; i++) {
+        const NsLatencyResult *res = &r->results[i];
+        out_lit(&o, "    {\n      \"name\": ");
+        out_json_str(&o, res->name);
+        out_lit(&o, ",\n      \"flags\": ");
+        out_i64(&o, res->flags);
+        if (res->error) {
+            out_lit(&o, ",\n      \"error\": ");
+            out_json_str(&o, strerror(res->error));
+            out_char(&o, '\n');
+        } else {
+            out_lit(&o, ",\n");
+            json_hist(&o, "unshare", &res->unshare, false);
+            json_hist(&o, "clone3_minus_fork", &res->clone3, true);
+        }
+        if (i + 1 < r->count) out_lit(&o, "    },\n");
+        else out_lit(&o, "    }\n");
+    }
+    out_lit(&o, "  ],\n  \"netns_teardown\": {\n");
+    if (r->teardown_error) {
+        out_lit(&o, "      \"error\": ");
+        out_json_str(&o, strerror(r->teardown_error));
+        out_char(&o, '\n');
+    } else {
+        json_hist(&o, "cleanup", &r->netns_teardown, true);
+    }
+    out_lit(&o, "  }\n}\n");
+    return out_close(&o);
+}
+
+bool run_namespace_latency_benchmark(const char **sets, int nsets, int repetitions, int warmup,
+                                     const char *output_file) {
+    if (geteuid() != 0) {
+        printf("Aviso: Sem root só alguns tipos podem ser criados (user, e os demais dentro dele)\n");
+    }
+    NsLatencyReport *r = malloc(sizeof(NsLatencyReport));
+    if (!r) return false;
+    printf("Medindo latência de namespaces...\n");
+    bool ok = ns_latency_run(r, sets, nsets, repetitions, warmup);
+    if (ok) {
+        ns_latency_print(r);
+        ok = ns_latency_write_json(r, output_file);
+        if (ok) printf("\n✓ Resultados salvos em: %s\n", output_file);
+        else fprintf(stderr, "Erro ao gravar %s: %s\n", output_file, strerror(errno));
+    }
+    free(r);
+    return ok;
+}
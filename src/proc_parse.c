@@ -0,0 +1,177 @@
+#define _GNU_SOURCE
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "../include/proc_parse.h"
+
+// Converte dígitos decimais a partir de p. O laço depende apenas da
+// comparação (c - '0') < 10, sem chamadas à libc nem tratamento de locale.
+static inline const char *parse_u64(const char *p, const char *end, unsigned long long *out) {
+    unsigned long long v = 0;
+    unsigned d;
+    while (p < end && (d = (unsigned)(unsigned char)*p - '0') < 10) {
+        v = v * 10 + d;
+        p++;
+    }
+    *out = v;
+    return p;
+}
+
+static inline const char *parse_i64(const char *p, const char *end, long long *out) {
+    int neg = (p < end && *p == '-');
+    unsigned long long v;
+    p = parse_u64(p + neg, end, &v);
+    *out = neg ? -(long long)v : (long long)v;
+    return p;
+}
+
+// Avança para o início do próximo campo separado por espaço
+static inline const char *next_field(const char *p, const char *end) {
+    const char *sp = memchr(p, ' ', end - p);
+    return sp ? sp + 1 : end;
+}
+
+bool proc_parse_stat(const char *buf, size_t len, ProcStat *out) {
+    const char *end = buf + len;
+    memset(out, 0, sizeof(ProcStat));
+
+    // comm fica entre o primeiro '(' e o ÚLTIMO ')', pois o nome do
+    // processo pode conter espaços e parênteses.
+    const char *open = memchr(buf, '(', len);
+    const char *close = memrchr(buf, ')', len);
+    if (!open || !close || close < open || close + 2 >= end) return false;
+
+    long long v;
+    parse_i64(buf, open, &v);
+    out->pid = (int)v;
+
+    size_t comm_len = close - open - 1;
+    if (comm_len >= sizeof(out->comm)) comm_len = sizeof(out->comm) - 1;
+    memcpy(out->comm, open + 1, comm_len);
+    out->comm[comm_len] = '\0';
+
+    const char *p = close + 2;   // ") S ..."
+    out->state = *p;
+    p = next_field(p, end);
+
+    unsigned long long u;
+    int field = 4;
+    for (; p < end && field <= 39; field++) {
+        switch (field) {
+            case 4:  p = parse_i64(p, end, &v); out->ppid = (int)v; break;
+            case 10: p = parse_u64(p, end, &u); out->minflt = u; break;
+            case 12: p = parse_u64(p, end, &u); out->majflt = u; break;
+            case 14: p = parse_u64(p, end, &u); out->utime = u; break;
+            case 15: p = parse_u64(p, end, &u); out->stime = u; break;
+            case 18: p = parse_i64(p, end, &v); out->priority = v; break;
+            case 19: p = parse_i64(p, end, &v); out->nice = v; break;
+            case 20: p = parse_i64(p, end, &v); out->num_threads = v; break;
+            case 22: p = parse_u64(p, end, &out->starttime); break;
+            case 23: p = parse_u64(p, end, &u); out->vsize = u; break;
+            case 24: p = parse_i64(p, end, &v); out->rss = v; break;
+            case 39: p = parse_i64(p, end, &v); out->processor = (int)v; break;
+            default: break;
+        }
+        p = next_field(p, end);
+    }
+
+    // Até rss (campo 24) é obrigatório
+    return field > 24;
+}
+
+bool proc_parse_statm(const char *buf, size_t len, ProcStatm *out) {
+    const char *p = buf;
+    const char *end = buf + len;
+    unsigned long long v[7] = {0};
+    int n = 0;
+
+    while (n < 7 && p < end) {
+        p = parse_u64(p, end, &v[n++]);
+        if (p < end && *p == ' ') p++;
+        else break;
+    }
+
+    out->size = v[0];
+    out->resident = v[1];
+    out->shared = v[2];
+    out->text = v[3];
+    out->lib = v[4];
+    out->data = v[5];
+    out->dt = v[6];
+    return n >= 2;
+}
+
+// Tabela de chaves "Nome:" -> deslocamento do campo na estrutura de destino.
+// O índice é dado por key_hash(); as duas tabelas abaixo são livres de
+// colisão para as chaves listadas (hash perfeito verificado na construção).
+typedef struct {
+    const char *name;
+    unsigned char len;
+    unsigned short offset;
+} ProcKey;
+
+#define KEY_TABLE_SIZE 16
+#define KEY(str, type, field) { str, sizeof(str) - 1, offsetof(type, field) }
+
+static inline unsigned key_hash(const char *k, size_t len) {
+    return ((unsigned char)k[0] * 2u + (unsigned char)k[len - 1] * 7u + (unsigned)len) & (KEY_TABLE_SIZE - 1);
+}
+
+static const ProcKey status_keys[KEY_TABLE_SIZE] = {
+    [2]  = KEY("VmSwap", ProcStatus, vm_swap_kb),
+    [4]  = KEY("Threads", ProcStatus, threads),
+    [5]  = KEY("VmSize", ProcStatus, vm_size_kb),
+    [6]  = KEY("VmRSS", ProcStatus, vm_rss_kb),
+    [7]  = KEY("RssShmem", ProcStatus, rss_shmem_kb),
+    [8]  = KEY("voluntary_ctxt_switches", ProcStatus, voluntary_ctxt_switches),
+    [11] = KEY("nonvoluntary_ctxt_switches", ProcStatus, nonvoluntary_ctxt_switches),
+    [12] = KEY("VmHWM", ProcStatus, vm_hwm_kb),
+    [13] = KEY("RssAnon", ProcStatus, rss_anon_kb),
+    [14] = KEY("RssFile", ProcStatus, rss_file_kb),
+    [15] = KEY("VmPeak", ProcStatus, vm_peak_kb),
+};
+
+static const ProcKey io_keys[KEY_TABLE_SIZE] = {
+    [0]  = KEY("cancelled_write_bytes", ProcIo, cancelled_write_bytes),
+    [1]  = KEY("wchar", ProcIo, wchar),
+    [3]  = KEY("read_bytes", ProcIo, read_bytes),
+    [7]  = KEY("rchar", ProcIo, rchar),
+    [9]  = KEY("syscr", ProcIo, syscr),
+    [12] = KEY("syscw", ProcIo, syscw),
+    [14] = KEY("write_bytes", ProcIo, write_bytes),
+};
+
+// Percorre linhas "Chave:<espaços>valor" e grava os valores das chaves conhecidas
+static void parse_keyed_lines(const char *buf, size_t len, const ProcKey *table, void *out) {
+    const char *p = buf;
+    const char *end = buf + len;
+
+    while (p < end) {
+        const char *eol = memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+
+        const char *colon = memchr(p, ':', eol - p);
+        if (colon && colon > p) {
+            size_t klen = colon - p;
+            const ProcKey *k = &table[key_hash(p, klen)];
+            if (k->len == klen && memcmp(k->name, p, klen) == 0) {
+                const char *v = colon + 1;
+                while (v < eol && (*v == ' ' || *v == '\t')) v++;
+                parse_u64(v, eol, (unsigned long long *)((char *)out + k->offset));
+            }
+        }
+        p = eol + 1;
+    }
+}
+
+bool proc_parse_status(const char *buf, size_t len, ProcStatus *out) {
+    memset(out, 0, sizeof(ProcStatus));
+    parse_keyed_lines(buf, len, status_keys, out);
+    return len > 0;
+}
+
+bool proc_parse_io(const char *buf, size_t len, ProcIo *out) {
+    memset(out, 0, sizeof(ProcIo));
+    parse_keyed_lines(buf, len, io_keys, out);
+    return len > 0;
+}
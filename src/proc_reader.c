@@ -0,0 +1,178 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "../include/proc_reader.h"
+
+#define FD_CLOSED      -1
+#define FD_UNAVAILABLE -2
+
+// Caminhos relativos a /proc/<pid>, tamanho inicial de cada buffer e se o
+// arquivo é gerado de uma vez (um registro) ou em páginas (uma linha por
+// interface/socket: cada read devolve no máximo ~uma página)
+static const struct {
+    const char *path;
+    size_t initial_cap;
+    bool single_record;
+} proc_files[PROC_FILE_COUNT] = {
+    [PROC_FILE_STAT]     = { "stat",     1024, true  },
+    [PROC_FILE_STATM]    = { "statm",     128, true  },
+    [PROC_FILE_STATUS]   = { "status",   2048, true  },
+    [PROC_FILE_IO]       = { "io",        256, true  },
+    [PROC_FILE_NET_DEV]  = { "net/dev",  2048, false },
+    [PROC_FILE_NET_TCP]  = { "net/tcp",  4096, false },
+    [PROC_FILE_NET_TCP6] = { "net/tcp6", 4096, false },
+};
+
+// Abre um arquivo do handle. Falhas permanentes (ENOENT, EACCES) ficam
+// registradas para não repetir o open() a cada amostra.
+static bool open_proc_file(ProcHandle *h, ProcFileId id) {
+    ProcFile *f = &h->files[id];
+    if (f->fd >= 0) return true;
+    if (f->fd == FD_UNAVAILABLE) return false;
+
+    f->fd = openat(h->dir_fd, proc_files[id].path, O_RDONLY | O_CLOEXEC);
+    if (f->fd < 0) {
+        if (errno == ESRCH) {
+            f->fd = FD_CLOSED;
+            proc_handle_invalidate(h);
+            return false;
+        }
+        // Falta de descritores é transitória: tenta de novo na próxima leitura
+        f->fd = (errno == EMFILE || errno == ENFILE) ? FD_CLOSED : FD_UNAVAILABLE;
+        return false;
+    }
+    return true;
+}
+
+bool proc_handle_open(ProcHandle *h, int pid) {
+    // Buffers de um uso anterior do mesmo handle são reaproveitados
+    proc_handle_invalidate(h);
+    h->pid = pid;
+    h->valid = false;
+    h->generation = 1;
+    for (int i = 0; i < PROC_FILE_COUNT; i++) {
+        h->files[i].fd = FD_CLOSED;
+        h->files[i].len = 0;
+        h->files[i].generation = 0;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d", pid);
+    h->dir_fd = open(path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (h->dir_fd < 0) {
+        return false;
+    }
+
+    h->valid = true;
+    if (!open_proc_file(h, PROC_FILE_STAT)) {
+        proc_handle_invalidate(h);
+        return false;
+    }
+    return true;
+}
+
+void proc_handle_invalidate(ProcHandle *h) {
+    // Handle inválido (ou recém-zerado) não possui descritores abertos
+    if (!h || !h->valid) return;
+    for (int i = 0; i < PROC_FILE_COUNT; i++) {
+        if (h->files[i].fd >= 0) {
+            close(h->files[i].fd);
+        }
+        h->files[i].fd = FD_CLOSED;
+        h->files[i].len = 0;
+    }
+    if (h->dir_fd >= 0) {
+        close(h->dir_fd);
+    }
+    h->dir_fd = -1;
+    h->valid = false;
+}
+
+void proc_handle_trim(ProcHandle *h) {
+    if (!proc_handle_valid(h)) return;
+    for (int i = 0; i < PROC_FILE_COUNT; i++) {
+        if (i == PROC_FILE_STAT || h->files[i].fd < 0) continue;
+        close(h->files[i].fd);
+        h->files[i].fd = FD_CLOSED;
+    }
+}
+
+void proc_handle_close(ProcHandle *h) {
+    if (!h) return;
+    proc_handle_invalidate(h);
+    for (int i = 0; i < PROC_FILE_COUNT; i++) {
+        free(h->files[i].buf);
+        h->files[i].buf = NULL;
+        h->files[i].cap = 0;
+    }
+    h->pid = 0;
+}
+
+void proc_handle_begin_sample(ProcHandle *h) {
+    if (h) h->generation++;
+}
+
+const char *proc_handle_read(ProcHandle *h, ProcFileId id, size_t *len) {
+    if (!h || !h->valid || id >= PROC_FILE_COUNT) return NULL;
+
+    ProcFile *f = &h->files[id];
+    if (f->generation == h->generation && f->buf) {
+        if (len) *len = f->len;
+        return f->buf;
+    }
+
+    if (!open_proc_file(h, id)) return NULL;
+
+    if (!f->buf) {
+        f->cap = proc_files[id].initial_cap;
+        f->buf = malloc(f->cap);
+        if (!f->buf) {
+            f->cap = 0;
+            return NULL;
+        }
+    }
+
+    // Arquivos de um registro: um único pread basta enquanto o conteúdo
+    // couber no buffer. Nos demais uma leitura curta não é o fim: continua
+    // no deslocamento corrente até o pread devolver 0. Buffer cheio dobra
+    // a capacidade e segue do mesmo ponto.
+    size_t total = 0;
+    ssize_t n = 0;
+    for (;;) {
+        if (total == f->cap - 1) {
+            size_t new_cap = f->cap * 2;
+            char *new_buf = realloc(f->buf, new_cap);
+            if (!new_buf) break;
+            f->buf = new_buf;
+            f->cap = new_cap;
+        }
+        n = pread(f->fd, f->buf + total, f->cap - 1 - total, (off_t)total);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        total += (size_t)n;
+        if (n == 0 || (proc_files[id].single_record && total < f->cap - 1)) break;
+    }
+
+    if (n < 0 || (total == 0 && id == PROC_FILE_STAT)) {
+        // ESRCH (ou stat vazio) significa que a tarefa já terminou
+        if (n == 0 || errno == ESRCH || id == PROC_FILE_STAT) {
+            proc_handle_invalidate(h);
+        } else {
+            close(f->fd);
+            f->fd = FD_UNAVAILABLE;
+        }
+        return NULL;
+    }
+
+    f->buf[total] = '\0';
+    f->len = total;
+    f->generation = h->generation;
+    if (len) *len = f->len;
+    return f->buf;
+}
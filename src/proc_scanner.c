@@ -0,0 +1,186 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "../include/proc_scanner.h"
+#include "../include/timing.h"
+
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+bool proc_scanner_init(ProcScanner *s, ProcFilterFn filter, void *filter_arg) {
+    memset(s, 0, sizeof(ProcScanner));
+    s->loadavg_fd = -1;
+    s->filter = filter;
+    s->filter_arg = filter_arg;
+
+    // Cada processo mantém alguns descritores de /proc abertos
+    raise_fd_limit();
+
+    s->proc_dir = opendir("/proc");
+    if (!s->proc_dir) {
+        fprintf(stderr, "Erro ao abrir /proc: %s\n", strerror(errno));
+        return false;
+    }
+    if (!process_table_init(&s->table, 1024)) {
+        fprintf(stderr, "Erro ao alocar tabela de processos\n");
+        closedir(s->proc_dir);
+        s->proc_dir = NULL;
+        return false;
+    }
+    // Sem loadavg, /proc é relido a cada tick
+    s->loadavg_fd = open("/proc/loadavg", O_RDONLY | O_CLOEXEC);
+    return true;
+}
+
+void proc_scanner_free(ProcScanner *s) {
+    if (s->proc_dir) closedir(s->proc_dir);
+    if (s->loadavg_fd >= 0) close(s->loadavg_fd);
+    process_table_free(&s->table);
+    free(s->pids);
+    memset(s, 0, sizeof(ProcScanner));
+    s->loadavg_fd = -1;
+}
+
+void proc_scanner_invalidate(ProcScanner *s) {
+    s->last_pid = 0;
+    s->nr_threads = 0;
+}
+
+// Verdadeiro se processos/threads podem ter sido criados ou encerrados
+// desde a última chamada: "0.00 0.01 0.05 1/734 12345" -> total 734, último PID 12345
+static bool process_set_changed(ProcScanner *s) {
+    if (s->loadavg_fd < 0) return true;
+
+    char buf[128];
+    ssize_t n = pread(s->loadavg_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return true;
+    buf[n] = '\0';
+
+    unsigned long nr_threads = 0, last_pid = 0;
+    const char *slash = strchr(buf, '/');
+    if (!slash || sscanf(slash + 1, "%lu %lu", &nr_threads, &last_pid) != 2) return true;
+
+    bool changed = (nr_threads != s->nr_threads || last_pid != s->last_pid);
+    s->nr_threads = nr_threads;
+    s->last_pid = last_pid;
+    return changed;
+}
+
+static bool read_pid_list(ProcScanner *s) {
+    s->npids = 0;
+    rewinddir(s->proc_dir);
+    struct dirent *entry;
+    while ((entry = readdir(s->proc_dir)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') continue;
+        if (s->npids == s->pids_cap) {
+            size_t new_cap = s->pids_cap ? s->pids_cap * 2 : 1024;
+            int *new_pids = realloc(s->pids, new_cap * sizeof(int));
+            if (!new_pids) return false;
+            s->pids = new_pids;
+            s->pids_cap = new_cap;
+        }
+        s->pids[s->npids++] = atoi(entry->d_name);
+    }
+    return true;
+}
+
+bool proc_scanner_tick(ProcScanner *s) {
+    uint64_t cpu_start = thread_cpu_ns();
+    ProcessTable *t = &s->table;
+
+    process_table_begin_tick(t);
+    s->rescanned = process_set_changed(s);
+    if (s->rescanned && !read_pid_list(s)) {
+        fprintf(stderr, "Erro ao ler a lista de processos\n");
+        return false;
+    }
+
+    s->visible = 0;
+    for (size_t i = 0; i < s->npids; i++) {
+        int pid = s->pids[i];
+        if (s->filter && !process_table_find(t, pid)) {
+            // PID novo: o filtro é avaliado uma única vez
+            if (!s->filter(pid, s->filter_arg)) {
+                ProcessSlot *slot = process_table_insert(t, pid);
+                if (slot) {
+                    slot->excluded = true;
+                    slot->seen_tick = t->tick;
+                }
+                continue;
+            }
+        }
+        ProcessSlot *slot = process_table_refresh(t, pid);
+        if (slot && !slot->excluded) s->visible++;
+    }
+
+    // Sem releitura de /proc todos os PIDs da lista foram vistos; os que
+    // terminaram foram removidos por process_table_refresh
+    s->exited = process_table_sweep(t);
+    s->cpu_ns = thread_cpu_ns() - cpu_start;
+    return true;
+}
+
+bool proc_filter_cgroup(int pid, void *arg) {
+    const char *want = arg;
+    size_t root_len = strlen(CGROUP_ROOT);
+    if (strncmp(want, CGROUP_ROOT, root_len) == 0) want += root_len;
+    while (*want == '/') want++;
+    size_t want_len = strlen(want);
+    while (want_len > 0 && want[want_len - 1] == '/') want_len--;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/cgroup", pid);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return false;
+
+    // Hierarquia unificada (v2): linha "0::/caminho"
+    char line[1024];
+    bool match = false;
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "0::/", 4) != 0) continue;
+        const char *cg = line + 4;
+        line[strcspn(line, "\n")] = '\0';
+        match = want_len == 0 ||
+                (strncmp(cg, want, want_len) == 0 && (cg[want_len] == '\0' || cg[want_len] == '/'));
+        break;
+    }
+    fclose(fp);
+    return match;
+}
+
+bool proc_filter_namespace(int pid, void *arg) {
+    const ProcNamespaceFilter *f = arg;
+    char path[64];
+    struct stat st;
+    snprintf(path, sizeof(path), "/proc/%d/ns/%s", pid, f->type);
+    return stat(path, &st) == 0 && st.st_ino == f->inode;
+}
+
+bool proc_namespace_filter_init(ProcNamespaceFilter *f, const char *type, int pid) {
+    static const char *types[] = { "net", "pid", "mnt", "uts", "ipc", "user", "cgroup" };
+    bool valid = false;
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (strcmp(type, types[i]) == 0) valid = true;
+    }
+    if (!valid) return false;
+
+    memset(f, 0, sizeof(ProcNamespaceFilter));
+    snprintf(f->type, sizeof(f->type), "%s", type);
+    char path[64];
+    struct stat st;
+    snprintf(path, sizeof(path), "/proc/%d/ns/%s", pid, type);
+    if (stat(path, &st) != 0) return false;
+    f->inode = st.st_ino;
+    return true;
+}
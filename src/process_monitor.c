@@ -6,9 +6,16 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <sys/resource.h>
 #include "../include/process_monitor.h"
+#include "../include/process_table.h"
+#include "../include/proc_parse.h"
+#include "../include/timing.h"
+#include "../include/tsdb.h"
+#include "../include/stream_export.h"
 
 #define PROC_PATH_MAX 512
+#define TOP_ROWS 20
 
 // Variável global para clock ticks por segundo
 static long clock_ticks = 0;
@@ -44,166 +51,111 @@ bool get_process_name(int pid, char *name, size_t size) {
     return true;
 }
 
+// Conta as linhas de conexões de /proc/pid/net/tcp{,6} (ignora o cabeçalho)
+static int count_socket_lines(const char *buf) {
+    int lines = 0;
+    const char *p = strchr(buf, '\n');
+    while (p && *++p) {
+        lines++;
+        p = strchr(p, '\n');
+    }
+    return lines;
+}
+
 // Coleta métricas de CPU
-bool collect_cpu_metrics(int pid, ProcessMetrics *metrics) {
+static bool read_cpu_metrics(ProcHandle *h, ProcessMetrics *metrics) {
     init_clock_ticks();
     
-    char path[PROC_PATH_MAX];
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
-    
-    FILE *fp = fopen(path, "r");
-    if (!fp) return false;
-    
-    // Lê dados do /proc/pid/stat
-    unsigned long utime, stime;
-    int num_threads;
-    
-    // Formato simplificado - ignoramos campos desnecessários
-    char comm[256];
-    char state;
-    int ppid, pgrp, session, tty_nr, tpgid;
-    unsigned long flags, minflt, cminflt, majflt, cmajflt;
-    unsigned long cutime, cstime;
-    long priority, nice, zero;
-    unsigned long itrealvalue, starttime;
-    unsigned long vsize;
-    long rss;
-    
-    int ret = fscanf(fp, "%d %s %c %d %d %d %d %d %lu %lu %lu %lu %lu %lu %lu %lu %lu %ld %ld %ld %d %ld %lu %lu %ld",
-                     &metrics->pid, comm, &state, &ppid, &pgrp, &session, &tty_nr, &tpgid,
-                     &flags, &minflt, &cminflt, &majflt, &cmajflt,
-                     &utime, &stime, &cutime, &cstime,
-                     &priority, &nice, &zero, &num_threads, &itrealvalue,
-                     &starttime, &vsize, &rss);
-    
-    fclose(fp);
-    
-    if (ret < 24) return false;
-    
-    metrics->cpu_user_time = utime;
-    metrics->cpu_system_time = stime;
-    metrics->cpu_total_time = utime + stime;
-    metrics->num_threads = num_threads;
-    metrics->page_faults_minor = minflt;
-    metrics->page_faults_major = majflt;
-    metrics->mem_vsize = vsize;
-    metrics->mem_rss = rss * sysconf(_SC_PAGESIZE);
+    // Lê dados do /proc/pid/stat (comm pode conter espaços e parênteses)
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_STAT, &len);
+    ProcStat st;
+    if (!buf || !proc_parse_stat(buf, len, &st)) return false;
+    
+    metrics->pid = st.pid;
+    memcpy(metrics->process_name, st.comm, sizeof(st.comm));
+    metrics->cpu_user_time = st.utime;
+    metrics->cpu_system_time = st.stime;
+    metrics->cpu_total_time = st.utime + st.stime;
+    metrics->num_threads = st.num_threads;
+    metrics->page_faults_minor = st.minflt;
+    metrics->page_faults_major = st.majflt;
+    metrics->mem_vsize = st.vsize;
+    metrics->mem_rss = st.rss * sysconf(_SC_PAGESIZE);
     
     // Lê context switches de /proc/pid/status
-    snprintf(path, sizeof(path), "/proc/%d/status", pid);
-    fp = fopen(path, "r");
-    if (fp) {
-        char line[256];
-        while (fgets(line, sizeof(line), fp)) {
-            if (sscanf(line, "voluntary_ctxt_switches: %ld", &metrics->voluntary_ctx_switches) == 1) continue;
-            if (sscanf(line, "nonvoluntary_ctxt_switches: %ld", &metrics->nonvoluntary_ctx_switches) == 1) continue;
-            if (strncmp(line, "VmSwap:", 7) == 0) {
-                sscanf(line, "VmSwap: %ld", &metrics->mem_swap);
-            }
-        }
-        fclose(fp);
+    buf = proc_handle_read(h, PROC_FILE_STATUS, &len);
+    ProcStatus status;
+    if (buf && proc_parse_status(buf, len, &status)) {
+        metrics->voluntary_ctx_switches = status.voluntary_ctxt_switches;
+        metrics->nonvoluntary_ctx_switches = status.nonvoluntary_ctxt_switches;
+        metrics->mem_swap = status.vm_swap_kb;
     }
     
     return true;
 }
 
 // Coleta métricas de memória
-bool collect_memory_metrics(int pid, ProcessMetrics *metrics) {
-    char path[PROC_PATH_MAX];
-    snprintf(path, sizeof(path), "/proc/%d/statm", pid);
-    
-    FILE *fp = fopen(path, "r");
-    if (!fp) return false;
-    
-    unsigned long size, resident, shared, text, lib, data, dt;
-    if (fscanf(fp, "%lu %lu %lu %lu %lu %lu %lu", 
-               &size, &resident, &shared, &text, &lib, &data, &dt) != 7) {
-        fclose(fp);
-        return false;
-    }
-    
-    fclose(fp);
+static bool read_memory_metrics(ProcHandle *h, ProcessMetrics *metrics) {
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_STATM, &len);
+    ProcStatm st;
+    if (!buf || !proc_parse_statm(buf, len, &st)) return false;
     
     long page_size = sysconf(_SC_PAGESIZE);
-    metrics->mem_vsize = size * page_size;
-    metrics->mem_rss = resident * page_size;
-    metrics->mem_shared = shared * page_size;
+    metrics->mem_vsize = st.size * page_size;
+    metrics->mem_rss = st.resident * page_size;
+    metrics->mem_shared = st.shared * page_size;
     
     return true;
 }
 
 // Coleta métricas de I/O
-bool collect_io_metrics(int pid, ProcessMetrics *metrics) {
-    char path[PROC_PATH_MAX];
-    snprintf(path, sizeof(path), "/proc/%d/io", pid);
-    
-    FILE *fp = fopen(path, "r");
-    if (!fp) return false;
+static bool read_io_metrics(ProcHandle *h, ProcessMetrics *metrics) {
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_IO, &len);
+    ProcIo io;
+    if (!buf || !proc_parse_io(buf, len, &io)) return false;
+    
+    metrics->io_read_bytes = io.read_bytes;
+    metrics->io_write_bytes = io.write_bytes;
+    metrics->io_cancelled_write_bytes = io.cancelled_write_bytes;
+    metrics->io_read_syscalls = io.syscr;
+    metrics->io_write_syscalls = io.syscw;
     
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        if (sscanf(line, "rchar: %llu", &metrics->io_read_syscalls) == 1) continue;
-        if (sscanf(line, "wchar: %llu", &metrics->io_write_syscalls) == 1) continue;
-        if (sscanf(line, "read_bytes: %llu", &metrics->io_read_bytes) == 1) continue;
-        if (sscanf(line, "write_bytes: %llu", &metrics->io_write_bytes) == 1) continue;
-        if (sscanf(line, "cancelled_write_bytes: %llu", &metrics->io_cancelled_write_bytes) == 1) continue;
-    }
-    
-    fclose(fp);
     return true;
 }
 
-// Coleta métricas de rede
-bool collect_network_metrics(int pid, ProcessMetrics *metrics) {
-    // Conta conexões ativas
-    char path[PROC_PATH_MAX];
-    snprintf(path, sizeof(path), "/proc/%d/net/tcp", pid);
-    
-    FILE *fp = fopen(path, "r");
+// Visão do namespace de rede do processo (/proc/pid/net): usada quando os
+// sockets do processo não podem ser atribuídos a ele
+static bool read_netns_metrics(ProcHandle *h, ProcessMetrics *metrics) {
+    // Conta conexões ativas (TCP e TCP6)
     int connections = 0;
-    
-    if (fp) {
-        char line[512];
-        fgets(line, sizeof(line), fp); // Skip header
-        while (fgets(line, sizeof(line), fp)) {
-            connections++;
-        }
-        fclose(fp);
-    }
-    
-    // TCP6
-    snprintf(path, sizeof(path), "/proc/%d/net/tcp6", pid);
-    fp = fopen(path, "r");
-    if (fp) {
-        char line[512];
-        fgets(line, sizeof(line), fp); // Skip header
-        while (fgets(line, sizeof(line), fp)) {
-            connections++;
-        }
-        fclose(fp);
-    }
+    const char *buf = proc_handle_read(h, PROC_FILE_NET_TCP, NULL);
+    if (buf) connections += count_socket_lines(buf);
+    buf = proc_handle_read(h, PROC_FILE_NET_TCP6, NULL);
+    if (buf) connections += count_socket_lines(buf);
     
     metrics->net_connections = connections;
     
     // Para métricas de bytes RX/TX, precisaríamos de netlink ou parsing de /proc/net/dev
-    // Por simplicidade, vamos coletar do /proc/net/dev global
-    fp = fopen("/proc/net/dev", "r");
-    if (fp) {
-        char line[512];
+    // Por simplicidade, usamos o /proc/pid/net/dev (visão do namespace de rede do processo)
+    buf = proc_handle_read(h, PROC_FILE_NET_DEV, NULL);
+    if (buf) {
         // Skip headers
-        fgets(line, sizeof(line), fp);
-        fgets(line, sizeof(line), fp);
+        const char *line = strchr(buf, '\n');
+        if (line) line = strchr(line + 1, '\n');
         
         unsigned long long rx_bytes = 0, tx_bytes = 0, rx_packets = 0, tx_packets = 0;
         
-        while (fgets(line, sizeof(line), fp)) {
+        while (line && *++line) {
             char iface[32];
             unsigned long long r_bytes, r_packets, r_errs, r_drop, r_fifo, r_frame, r_compressed, r_multicast;
-            unsigned long long t_bytes, t_packets, t_errs, t_drop, t_fifo, t_colls, t_carrier, t_compressed;
+            unsigned long long t_bytes, t_packets;
             
-            if (sscanf(line, "%s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+            if (sscanf(line, "%31s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
                       iface, &r_bytes, &r_packets, &r_errs, &r_drop, &r_fifo, &r_frame, &r_compressed, &r_multicast,
-                      &t_bytes, &t_packets, &t_errs, &t_drop, &t_fifo, &t_colls, &t_carrier, &t_compressed) >= 10) {
+                      &t_bytes, &t_packets) >= 10) {
                 
                 // Ignora loopback
                 if (strstr(iface, "lo:") == NULL) {
@@ -213,37 +165,122 @@ bool collect_network_metrics(int pid, ProcessMetrics *metrics) {
                     tx_packets += t_packets;
                 }
             }
+            line = strchr(line, '\n');
         }
         
         metrics->net_rx_bytes = rx_bytes;
         metrics->net_tx_bytes = tx_bytes;
         metrics->net_rx_packets = rx_packets;
         metrics->net_tx_packets = tx_packets;
-        
-        fclose(fp);
     }
     
     return true;
 }
 
-// Coleta todas as métricas de uma vez
-bool collect_process_metrics(int pid, ProcessMetrics *metrics) {
+// Coleta métricas de rede do próprio processo (sockets de /proc/pid/fd
+// casados com inet_diag). ps guarda a lista de sockets entre amostras;
+// NULL faz uma coleta avulsa.
+static bool read_network_sockets(ProcHandle *h, ProcSockets *ps, ProcessMetrics *metrics) {
+    ProcSockets temp;
+    if (ps == NULL) proc_sockets_init(ps = &temp);
+    
+    NetUsage usage;
+    bool ok = proc_sockets_collect(ps, h, &usage);
+    if (ps == &temp) proc_sockets_free(&temp);
+    if (!ok) return read_netns_metrics(h, metrics);
+    
+    metrics->net_rx_bytes = usage.bytes_received;
+    metrics->net_tx_bytes = usage.bytes_sent;
+    metrics->net_rx_packets = usage.segs_in;
+    metrics->net_tx_packets = usage.segs_out;
+    metrics->net_connections = usage.tcp_sockets;
+    metrics->net_rx_queue = usage.rx_queue;
+    metrics->net_tx_queue = usage.tx_queue;
+    return true;
+}
+
+static bool read_network_metrics(ProcHandle *h, ProcessMetrics *metrics) {
+    return read_network_sockets(h, NULL, metrics);
+}
+
+// Executa um coletor com um handle temporário (API por PID)
+static bool collect_with_temp_handle(int pid, ProcessMetrics *metrics,
+                                     bool (*reader)(ProcHandle *, ProcessMetrics *)) {
+    ProcHandle h = {0};
+    bool ok = proc_handle_open(&h, pid) && reader(&h, metrics);
+    proc_handle_close(&h);
+    return ok;
+}
+
+bool collect_cpu_metrics(int pid, ProcessMetrics *metrics) {
+    return collect_with_temp_handle(pid, metrics, read_cpu_metrics);
+}
+
+bool collect_memory_metrics(int pid, ProcessMetrics *metrics) {
+    return collect_with_temp_handle(pid, metrics, read_memory_metrics);
+}
+
+bool collect_io_metrics(int pid, ProcessMetrics *metrics) {
+    return collect_with_temp_handle(pid, metrics, read_io_metrics);
+}
+
+bool collect_network_metrics(int pid, ProcessMetrics *metrics) {
+    return collect_with_temp_handle(pid, metrics, read_network_metrics);
+}
+
+// Coleta todas as métricas de uma vez reutilizando os descritores do handle
+bool collect_process_metrics_handle(ProcHandle *h, ProcSockets *sockets, ProcessMetrics *metrics) {
     memset(metrics, 0, sizeof(ProcessMetrics));
     
-    metrics->timestamp = time(NULL);
-    metrics->pid = pid;
+    TIMING_STAMP(metrics);
+    metrics->pid = h->pid;
+    
+    proc_handle_begin_sample(h);
     
-    if (!get_process_name(pid, metrics->process_name, sizeof(metrics->process_name))) {
+    // O nome do processo vem do campo comm de /proc/pid/stat
+    if (!read_cpu_metrics(h, metrics)) {
         return false;
     }
     
     bool success = true;
-    success &= collect_cpu_metrics(pid, metrics);
-    success &= collect_memory_metrics(pid, metrics);
-    success &= collect_io_metrics(pid, metrics);
-    success &= collect_network_metrics(pid, metrics);
+    success &= read_memory_metrics(h, metrics);
+    success &= read_io_metrics(h, metrics);
+    success &= read_network_sockets(h, sockets, metrics);
     
-    return success;
+    return success && proc_handle_valid(h);
+}
+
+// Coleta somente os grupos pedidos; falhas fora de stat não são fatais
+bool collect_process_metrics_groups(ProcHandle *h, ProcessMetrics *metrics, unsigned groups) {
+    proc_handle_begin_sample(h);
+    return collect_process_metrics_sampled(h, metrics, groups);
+}
+
+// Igual a collect_process_metrics_groups sem iniciar nova amostra: arquivos
+// já lidos pelo chamador nesta amostra (ex.: stat) não são relidos
+bool collect_process_metrics_sampled(ProcHandle *h, ProcessMetrics *metrics, unsigned groups) {
+    memset(metrics, 0, sizeof(ProcessMetrics));
+    
+    TIMING_STAMP(metrics);
+    metrics->pid = h->pid;
+    
+    if (!read_cpu_metrics(h, metrics)) {
+        return false;
+    }
+    
+    if (groups & PROC_METRICS_MEMORY) read_memory_metrics(h, metrics);
+    if (groups & PROC_METRICS_IO) read_io_metrics(h, metrics);
+    if (groups & PROC_METRICS_NETWORK) read_network_metrics(h, metrics);
+    
+    return proc_handle_valid(h);
+}
+
+// Coleta todas as métricas de uma vez
+bool collect_process_metrics(int pid, ProcessMetrics *metrics) {
+    ProcHandle h = {0};
+    bool ok = proc_handle_open(&h, pid) && collect_process_metrics_handle(&h, NULL, metrics);
+    proc_handle_close(&h);
+    return ok;
 }
 
 // Calcula CPU% entre duas amostras
@@ -253,9 +290,9 @@ void calculate_cpu_percent(ProcessMetrics *current, ProcessMetrics *previous) {
     init_clock_ticks();
     
     unsigned long delta_time = current->cpu_total_time - previous->cpu_total_time;
-    time_t delta_sec = current->timestamp - previous->timestamp;
+    double delta_sec = (double)(current->mono_ns - previous->mono_ns) / NSEC_PER_SEC;
     
-    if (delta_sec > 0) {
+    if (current->mono_ns > previous->mono_ns) {
         // CPU% = (delta_jiffies / ticks_per_sec) / delta_seconds * 100
         current->cpu_usage_percent = (delta_time * 100.0) / (clock_ticks * delta_sec);
     } else {
@@ -267,9 +304,9 @@ void calculate_cpu_percent(ProcessMetrics *current, ProcessMetrics *previous) {
 void calculate_io_rates(ProcessMetrics *current, ProcessMetrics *previous) {
     if (!current || !previous) return;
     
-    time_t delta_sec = current->timestamp - previous->timestamp;
+    double delta_sec = (double)(current->mono_ns - previous->mono_ns) / NSEC_PER_SEC;
     
-    if (delta_sec > 0) {
+    if (current->mono_ns > previous->mono_ns) {
         unsigned long long delta_read = current->io_read_bytes - previous->io_read_bytes;
         unsigned long long delta_write = current->io_write_bytes - previous->io_write_bytes;
         
@@ -282,19 +319,21 @@ void calculate_io_rates(ProcessMetrics *current, ProcessMetrics *previous) {
 }
 
 // Gerenciamento de histórico
-MetricsHistory* create_metrics_history(int initial_capacity) {
+MetricsHistory* create_metrics_history(size_t retention) {
     MetricsHistory *history = malloc(sizeof(MetricsHistory));
     if (!history) return NULL;
     
-    history->samples = malloc(sizeof(ProcessMetrics) * initial_capacity);
-    if (!history->samples) {
+    if (retention == 0) retention = DEFAULT_HISTORY_RETENTION;
+    if (!metrics_store_init(&history->store, retention)) {
         free(history);
         return NULL;
     }
     
-    history->count = 0;
-    history->capacity = initial_capacity;
+    history->has_last = false;
     history->start_time = time(NULL);
+    history->threads = NULL;
+    history->stalls = NULL;
+    metrics_summary_init(&history->summary);
     
     return history;
 }
@@ -302,144 +341,684 @@ MetricsHistory* create_metrics_history(int initial_capacity) {
 void add_metrics_sample(MetricsHistory *history, ProcessMetrics *metrics) {
     if (!history || !metrics) return;
     
-    // Expandir se necessário
-    if (history->count >= history->capacity) {
-        int new_capacity = history->capacity * 2;
-        ProcessMetrics *new_samples = realloc(history->samples, sizeof(ProcessMetrics) * new_capacity);
-        if (!new_samples) return;
-        
-        history->samples = new_samples;
-        history->capacity = new_capacity;
+    // Calcular taxas se houver amostra anterior (cópia privada do produtor:
+    // não depende do slot no ring, que pode já ter sido sobrescrito)
+    if (history->has_last) {
+        calculate_cpu_percent(metrics, &history->last);
+        calculate_io_rates(metrics, &history->last);
+        metrics_summary_add(&history->summary, metrics->cpu_usage_percent, (double)metrics->mem_rss,
+                            metrics->io_read_rate_kbs * 1024.0, metrics->io_write_rate_kbs * 1024.0,
+                            metrics->mono_ns - history->last.mono_ns);
     }
     
-    // Calcular taxas se houver amostra anterior
-    if (history->count > 0) {
-        ProcessMetrics *prev = &history->samples[history->count - 1];
-        calculate_cpu_percent(metrics, prev);
-        calculate_io_rates(metrics, prev);
-    }
-    
-    history->samples[history->count++] = *metrics;
+    MetricsStore *s = &history->store;
+    uint32_t entity = entity_intern(&s->entities, metrics->pid, metrics->process_name);
+    
+    // Espalha a amostra pelas colunas do slot
+    size_t i = ring_write_begin(&s->seq);
+    s->mono_ns[i] = metrics->mono_ns;
+    s->real_ns[i] = metrics->real_ns;
+    s->interval_ns[i] = metrics->interval_ns;
+    s->entity[i] = entity;
+    
+    s->cpu_user[i] = metrics->cpu_user_time;
+    s->cpu_system[i] = metrics->cpu_system_time;
+    s->cpu_percent[i] = (float)metrics->cpu_usage_percent;
+    s->threads[i] = (uint32_t)metrics->num_threads;
+    s->ctx_voluntary[i] = (uint64_t)metrics->voluntary_ctx_switches;
+    s->ctx_nonvoluntary[i] = (uint64_t)metrics->nonvoluntary_ctx_switches;
+    
+    s->mem_vsize[i] = (uint64_t)metrics->mem_vsize;
+    s->mem_rss[i] = (uint64_t)metrics->mem_rss;
+    s->mem_shared[i] = (uint64_t)metrics->mem_shared;
+    s->faults_minor[i] = (uint64_t)metrics->page_faults_minor;
+    s->faults_major[i] = (uint64_t)metrics->page_faults_major;
+    s->mem_swap_kb[i] = (uint64_t)metrics->mem_swap;
+    
+    s->io_read_bytes[i] = metrics->io_read_bytes;
+    s->io_write_bytes[i] = metrics->io_write_bytes;
+    s->io_cancelled_bytes[i] = metrics->io_cancelled_write_bytes;
+    s->io_read_syscalls[i] = metrics->io_read_syscalls;
+    s->io_write_syscalls[i] = metrics->io_write_syscalls;
+    s->io_read_kbs[i] = (float)metrics->io_read_rate_kbs;
+    s->io_write_kbs[i] = (float)metrics->io_write_rate_kbs;
+    
+    s->net_rx_bytes[i] = metrics->net_rx_bytes;
+    s->net_tx_bytes[i] = metrics->net_tx_bytes;
+    s->net_rx_packets[i] = metrics->net_rx_packets;
+    s->net_tx_packets[i] = metrics->net_tx_packets;
+    s->net_rx_queue[i] = metrics->net_rx_queue;
+    s->net_tx_queue[i] = metrics->net_tx_queue;
+    s->net_connections[i] = (uint32_t)metrics->net_connections;
+    ring_write_end(&s->seq);
+    
+    history->last = *metrics;
+    history->has_last = true;
 }
 
 void free_metrics_history(MetricsHistory *history) {
     if (!history) return;
-    free(history->samples);
+    metrics_store_free(&history->store);
+    if (history->threads) {
+        thread_store_free(history->threads);
+        free(history->threads);
+    }
+    if (history->stalls) {
+        ring_free(history->stalls);
+        free(history->stalls);
+    }
     free(history);
 }
 
+uint64_t metrics_history_head(const MetricsHistory *history) {
+    return ring_head(&history->store.seq);
+}
+
+uint64_t metrics_history_oldest(const MetricsHistory *history) {
+    return ring_oldest(&history->store.seq);
+}
+
+bool metrics_history_read(const MetricsHistory *history, uint64_t pos, ProcessMetrics *out) {
+    const MetricsStore *s = &history->store;
+    size_t i;
+    if (!ring_read_begin(&s->seq, pos, &i)) return false;
+    
+    // Remonta a linha a partir das colunas
+    memset(out, 0, sizeof(ProcessMetrics));
+    out->mono_ns = s->mono_ns[i];
+    out->real_ns = s->real_ns[i];
+    out->interval_ns = s->interval_ns[i];
+    out->timestamp = (time_t)(out->real_ns / NSEC_PER_SEC);
+    uint32_t entity = s->entity[i];
+    
+    out->cpu_user_time = s->cpu_user[i];
+    out->cpu_system_time = s->cpu_system[i];
+    out->cpu_total_time = out->cpu_user_time + out->cpu_system_time;
+    out->cpu_usage_percent = s->cpu_percent[i];
+    out->num_threads = s->threads[i];
+    out->voluntary_ctx_switches = (long)s->ctx_voluntary[i];
+    out->nonvoluntary_ctx_switches = (long)s->ctx_nonvoluntary[i];
+    
+    out->mem_vsize = (long)s->mem_vsize[i];
+    out->mem_rss = (long)s->mem_rss[i];
+    out->mem_shared = (long)s->mem_shared[i];
+    out->page_faults_minor = (long)s->faults_minor[i];
+    out->page_faults_major = (long)s->faults_major[i];
+    out->mem_swap = (long)s->mem_swap_kb[i];
+    
+    out->io_read_bytes = s->io_read_bytes[i];
+    out->io_write_bytes = s->io_write_bytes[i];
+    out->io_cancelled_write_bytes = s->io_cancelled_bytes[i];
+    out->io_read_syscalls = s->io_read_syscalls[i];
+    out->io_write_syscalls = s->io_write_syscalls[i];
+    out->io_read_rate_kbs = s->io_read_kbs[i];
+    out->io_write_rate_kbs = s->io_write_kbs[i];
+    
+    out->net_rx_bytes = s->net_rx_bytes[i];
+    out->net_tx_bytes = s->net_tx_bytes[i];
+    out->net_rx_packets = s->net_rx_packets[i];
+    out->net_tx_packets = s->net_tx_packets[i];
+    out->net_rx_queue = s->net_rx_queue[i];
+    out->net_tx_queue = s->net_tx_queue[i];
+    out->net_connections = (int)s->net_connections[i];
+    
+    if (!ring_read_validate(&s->seq, pos, i)) return false;
+    
+    // Entradas do dicionário são imutáveis depois de publicadas
+    const EntityName *e = entity_get(&s->entities, entity);
+    if (e) {
+        out->pid = e->pid;
+        memcpy(out->process_name, e->name, sizeof(out->process_name));
+    }
+    return true;
+}
+
+bool metrics_history_stats(const MetricsHistory *history, MetricId metric, MetricStats *out) {
+    if (!history) return false;
+    return metrics_store_stats(&history->store, metric, out);
+}
+
+bool metrics_history_enable_threads(MetricsHistory *history, size_t retention) {
+    if (!history) return false;
+    if (history->threads) return true;
+    if (retention == 0) retention = DEFAULT_THREAD_HISTORY_RETENTION;
+    
+    ThreadStore *store = malloc(sizeof(ThreadStore));
+    if (!store) return false;
+    if (!thread_store_init(store, retention)) {
+        free(store);
+        return false;
+    }
+    history->threads = store;
+    return true;
+}
+
+void add_thread_samples(MetricsHistory *history, const ThreadTable *threads) {
+    if (!history || !history->threads || !threads) return;
+    ThreadStore *s = history->threads;
+    
+    for (size_t t = 0; t < threads->count; t++) {
+        const ThreadSlot *slot = &threads->threads[t];
+        // Sem descritor nesta amostra: não há leitura nova
+        if (!slot->has_prev || slot->cur.mono_ns != threads->mono_ns) continue;
+        const ThreadMetrics *m = &slot->cur;
+        uint32_t entity = entity_intern(&s->entities, m->tid, m->name);
+        
+        size_t i = ring_write_begin(&s->seq);
+        s->mono_ns[i] = m->mono_ns;
+        s->entity[i] = entity;
+        s->pid[i] = (uint32_t)m->pid;
+        s->cpu_user[i] = m->cpu_user_time;
+        s->cpu_system[i] = m->cpu_system_time;
+        s->cpu_percent[i] = (float)m->cpu_usage_percent;
+        s->ctx_voluntary[i] = (uint64_t)m->voluntary_ctx_switches;
+        s->ctx_nonvoluntary[i] = (uint64_t)m->nonvoluntary_ctx_switches;
+        s->ctx_rate[i] = (float)m->ctx_switch_rate;
+        s->processor[i] = m->processor;
+        s->state[i] = (uint8_t)m->state;
+        ring_write_end(&s->seq);
+    }
+}
+
+uint64_t metrics_history_thread_head(const MetricsHistory *history) {
+    return history->threads ? ring_head(&history->threads->seq) : 0;
+}
+
+uint64_t metrics_history_thread_oldest(const MetricsHistory *history) {
+    return history->threads ? ring_oldest(&history->threads->seq) : 0;
+}
+
+bool metrics_history_read_thread(const MetricsHistory *history, uint64_t pos, ThreadMetrics *out) {
+    const ThreadStore *s = history->threads;
+    size_t i;
+    if (!s || !ring_read_begin(&s->seq, pos, &i)) return false;
+    
+    memset(out, 0, sizeof(ThreadMetrics));
+    out->mono_ns = s->mono_ns[i];
+    uint32_t entity = s->entity[i];
+    out->pid = (int)s->pid[i];
+    out->cpu_user_time = s->cpu_user[i];
+    out->cpu_system_time = s->cpu_system[i];
+    out->cpu_usage_percent = s->cpu_percent[i];
+    out->voluntary_ctx_switches = (long)s->ctx_voluntary[i];
+    out->nonvoluntary_ctx_switches = (long)s->ctx_nonvoluntary[i];
+    out->ctx_switch_rate = s->ctx_rate[i];
+    out->processor = s->processor[i];
+    out->state = (char)s->state[i];
+    
+    if (!ring_read_validate(&s->seq, pos, i)) return false;
+    
+    const EntityName *e = entity_get(&s->entities, entity);
+    if (e) {
+        out->tid = e->pid;
+        memcpy(out->name, e->name, sizeof(out->name));
+    }
+    return true;
+}
+
+bool metrics_history_enable_stalls(MetricsHistory *history, size_t retention) {
+    if (!history) return false;
+    if (history->stalls) return true;
+    if (retention == 0) retention = DEFAULT_STALL_HISTORY_RETENTION;
+    
+    RingBuffer *ring = malloc(sizeof(RingBuffer));
+    if (!ring) return false;
+    if (!ring_init(ring, retention, sizeof(PsiEvent))) {
+        free(ring);
+        return false;
+    }
+    history->stalls = ring;
+    return true;
+}
+
+void add_stall_event(const PsiEvent *ev, void *history) {
+    MetricsHistory *h = history;
+    if (!h || !h->stalls || !ev) return;
+    ring_push(h->stalls, ev);
+}
+
+uint64_t metrics_history_stall_head(const MetricsHistory *history) {
+    return history->stalls ? ring_head(history->stalls) : 0;
+}
+
+uint64_t metrics_history_stall_oldest(const MetricsHistory *history) {
+    return history->stalls ? ring_oldest(history->stalls) : 0;
+}
+
+bool metrics_history_read_stall(const MetricsHistory *history, uint64_t pos, PsiEvent *out) {
+    return history->stalls && ring_read(history->stalls, pos, out);
+}
+
+// Objeto JSON de uma amostra (sem vírgula final). with_process inclui PID
+// e nome, para saídas com vários processos.
+void write_metrics_json_sample(OutBuf *o, const ProcessMetrics *m, bool with_process) {
+    out_lit(o, "    {\n");
+    if (with_process) {
+        out_lit(o, "      \"pid\": ");
+        out_i64(o, m->pid);
+        out_lit(o, ",\n      \"process_name\": ");
+        out_json_str(o, m->process_name);
+        out_lit(o, ",\n");
+    }
+    out_lit(o, "      \"timestamp\": ");
+    out_i64(o, m->timestamp);
+    out_lit(o, ",\n      \"timestamp_ns\": ");
+    out_u64(o, m->real_ns);
+    out_lit(o, ",\n      \"interval_ns\": ");
+    out_u64(o, m->interval_ns);
+    out_lit(o, ",\n      \"cpu\": {\n        \"user_time\": ");
+    out_u64(o, m->cpu_user_time);
+    out_lit(o, ",\n        \"system_time\": ");
+    out_u64(o, m->cpu_system_time);
+    out_lit(o, ",\n        \"usage_percent\": ");
+    out_fixed(o, m->cpu_usage_percent, 2);
+    out_lit(o, ",\n        \"threads\": ");
+    out_i64(o, m->num_threads);
+    out_lit(o, ",\n        \"voluntary_ctx_switches\": ");
+    out_i64(o, m->voluntary_ctx_switches);
+    out_lit(o, ",\n        \"nonvoluntary_ctx_switches\": ");
+    out_i64(o, m->nonvoluntary_ctx_switches);
+    out_lit(o, "\n      },\n      \"memory\": {\n        \"vsize_bytes\": ");
+    out_i64(o, m->mem_vsize);
+    out_lit(o, ",\n        \"rss_bytes\": ");
+    out_i64(o, m->mem_rss);
+    out_lit(o, ",\n        \"shared_bytes\": ");
+    out_i64(o, m->mem_shared);
+    out_lit(o, ",\n        \"page_faults_minor\": ");
+    out_i64(o, m->page_faults_minor);
+    out_lit(o, ",\n        \"page_faults_major\": ");
+    out_i64(o, m->page_faults_major);
+    out_lit(o, ",\n        \"swap_kb\": ");
+    out_i64(o, m->mem_swap);
+    out_lit(o, "\n      },\n      \"io\": {\n        \"read_bytes\": ");
+    out_u64(o, m->io_read_bytes);
+    out_lit(o, ",\n        \"write_bytes\": ");
+    out_u64(o, m->io_write_bytes);
+    out_lit(o, ",\n        \"read_rate_kbs\": ");
+    out_fixed(o, m->io_read_rate_kbs, 2);
+    out_lit(o, ",\n        \"write_rate_kbs\": ");
+    out_fixed(o, m->io_write_rate_kbs, 2);
+    out_lit(o, ",\n        \"read_syscalls\": ");
+    out_u64(o, m->io_read_syscalls);
+    out_lit(o, ",\n        \"write_syscalls\": ");
+    out_u64(o, m->io_write_syscalls);
+    out_lit(o, "\n      },\n      \"network\": {\n        \"rx_bytes\": ");
+    out_u64(o, m->net_rx_bytes);
+    out_lit(o, ",\n        \"tx_bytes\": ");
+    out_u64(o, m->net_tx_bytes);
+    out_lit(o, ",\n        \"rx_packets\": ");
+    out_u64(o, m->net_rx_packets);
+    out_lit(o, ",\n        \"tx_packets\": ");
+    out_u64(o, m->net_tx_packets);
+    out_lit(o, ",\n        \"connections\": ");
+    out_i64(o, m->net_connections);
+    out_lit(o, ",\n        \"rx_queue\": ");
+    out_u64(o, m->net_rx_queue);
+    out_lit(o, ",\n        \"tx_queue\": ");
+    out_u64(o, m->net_tx_queue);
+    out_lit(o, "\n      }\n    }");
+}
+
 // Exporta para JSON
 bool export_metrics_json(const char *filename, MetricsHistory *history) {
-    if (!history || history->count == 0) return false;
-    
-    FILE *fp = fopen(filename, "w");
-    if (!fp) {
+    if (!history) return false;
+    
+    // Janela retida no momento da exportação; amostras sobrescritas durante
+    // a escrita (produtor concorrente) são omitidas
+    uint64_t head = metrics_history_head(history);
+    uint64_t oldest = metrics_history_oldest(history);
+    ProcessMetrics first;
+    while (oldest < head && !metrics_history_read(history, oldest, &first)) oldest++;
+    if (oldest >= head) return false;
+    
+    OutBuf o;
+    if (!out_open(&o, filename)) {
         fprintf(stderr, "Erro ao criar arquivo JSON: %s\n", strerror(errno));
         return false;
     }
     
-    fprintf(fp, "{\n");
-    fprintf(fp, "  \"monitoring_session\": {\n");
-    fprintf(fp, "    \"pid\": %d,\n", history->samples[0].pid);
-    fprintf(fp, "    \"process_name\": \"%s\",\n", history->samples[0].process_name);
-    fprintf(fp, "    \"start_time\": %ld,\n", history->start_time);
-    fprintf(fp, "    \"sample_count\": %d\n", history->count);
-    fprintf(fp, "  },\n");
-    fprintf(fp, "  \"samples\": [\n");
+    out_lit(&o, "{\n  \"monitoring_session\": {\n    \"pid\": ");
+    out_i64(&o, first.pid);
+    out_lit(&o, ",\n    \"process_name\": ");
+    out_json_str(&o, first.process_name);
+    out_lit(&o, ",\n    \"start_time\": ");
+    out_i64(&o, history->start_time);
+    out_lit(&o, ",\n    \"sample_count\": ");
+    out_u64(&o, head - oldest);
+    out_lit(&o, ",\n    \"dropped_samples\": ");
+    out_u64(&o, oldest);
+    out_lit(&o, "\n  },\n  \"samples\": [\n");
+    
+    ProcessMetrics sample;
+    bool first_sample = true;
+    for (uint64_t pos = oldest; pos < head; pos++) {
+        if (!metrics_history_read(history, pos, &sample)) continue;
+        if (!first_sample) out_lit(&o, ",\n");
+        write_metrics_json_sample(&o, &sample, false);
+        first_sample = false;
+    }
     
-    for (int i = 0; i < history->count; i++) {
-        ProcessMetrics *m = &history->samples[i];
-        
-        fprintf(fp, "    {\n");
-        fprintf(fp, "      \"timestamp\": %ld,\n", m->timestamp);
-        fprintf(fp, "      \"cpu\": {\n");
-        fprintf(fp, "        \"user_time\": %lu,\n", m->cpu_user_time);
-        fprintf(fp, "        \"system_time\": %lu,\n", m->cpu_system_time);
-        fprintf(fp, "        \"usage_percent\": %.2f,\n", m->cpu_usage_percent);
-        fprintf(fp, "        \"threads\": %ld,\n", m->num_threads);
-        fprintf(fp, "        \"voluntary_ctx_switches\": %ld,\n", m->voluntary_ctx_switches);
-        fprintf(fp, "        \"nonvoluntary_ctx_switches\": %ld\n", m->nonvoluntary_ctx_switches);
-        fprintf(fp, "      },\n");
-        fprintf(fp, "      \"memory\": {\n");
-        fprintf(fp, "        \"vsize_bytes\": %ld,\n", m->mem_vsize);
-        fprintf(fp, "        \"rss_bytes\": %ld,\n", m->mem_rss);
-        fprintf(fp, "        \"shared_bytes\": %ld,\n", m->mem_shared);
-        fprintf(fp, "        \"page_faults_minor\": %ld,\n", m->page_faults_minor);
-        fprintf(fp, "        \"page_faults_major\": %ld,\n", m->page_faults_major);
-        fprintf(fp, "        \"swap_kb\": %ld\n", m->mem_swap);
-        fprintf(fp, "      },\n");
-        fprintf(fp, "      \"io\": {\n");
-        fprintf(fp, "        \"read_bytes\": %llu,\n", m->io_read_bytes);
-        fprintf(fp, "        \"write_bytes\": %llu,\n", m->io_write_bytes);
-        fprintf(fp, "        \"read_rate_kbs\": %.2f,\n", m->io_read_rate_kbs);
-        fprintf(fp, "        \"write_rate_kbs\": %.2f,\n", m->io_write_rate_kbs);
-        fprintf(fp, "        \"read_syscalls\": %llu,\n", m->io_read_syscalls);
-        fprintf(fp, "        \"write_syscalls\": %llu\n", m->io_write_syscalls);
-        fprintf(fp, "      },\n");
-        fprintf(fp, "      \"network\": {\n");
-        fprintf(fp, "        \"rx_bytes\": %llu,\n", m->net_rx_bytes);
-        fprintf(fp, "        \"tx_bytes\": %llu,\n", m->net_tx_bytes);
-        fprintf(fp, "        \"rx_packets\": %llu,\n", m->net_rx_packets);
-        fprintf(fp, "        \"tx_packets\": %llu,\n", m->net_tx_packets);
-        fprintf(fp, "        \"connections\": %d\n", m->net_connections);
-        fprintf(fp, "      }\n");
-        fprintf(fp, "    }%s\n", (i < history->count - 1) ? "," : "");
-    }
-    
-    fprintf(fp, "  ]\n");
-    fprintf(fp, "}\n");
+    out_lit(&o, "\n  ]\n}\n");
     
-    fclose(fp);
+    if (!out_close(&o)) {
+        fprintf(stderr, "Erro ao gravar arquivo JSON %s\n", filename);
+        return false;
+    }
     return true;
 }
 
+// Cabeçalho e linha de CSV (compartilhados com o modo multi-processo)
+void write_metrics_csv_header(OutBuf *o) {
+    out_lit(o, "timestamp,timestamp_ns,pid,process_name,"
+               "cpu_user_time,cpu_system_time,cpu_percent,threads,vol_ctx_switches,nonvol_ctx_switches,"
+               "mem_vsize,mem_rss,mem_shared,page_faults_minor,page_faults_major,mem_swap_kb,"
+               "io_read_bytes,io_write_bytes,io_read_kbs,io_write_kbs,io_read_syscalls,io_write_syscalls,"
+               "net_rx_bytes,net_tx_bytes,net_rx_packets,net_tx_packets,net_connections,net_rx_queue,net_tx_queue,interval_ns\n");
+}
+
+void write_metrics_csv_row(OutBuf *o, const ProcessMetrics *m) {
+    out_i64(o, m->timestamp);
+    out_char(o, ',');
+    out_u64(o, m->real_ns);
+    out_char(o, ',');
+    out_i64(o, m->pid);
+    out_char(o, ',');
+    out_write(o, m->process_name, strlen(m->process_name));
+    out_char(o, ',');
+    out_u64(o, m->cpu_user_time);
+    out_char(o, ',');
+    out_u64(o, m->cpu_system_time);
+    out_char(o, ',');
+    out_fixed(o, m->cpu_usage_percent, 2);
+    out_char(o, ',');
+    out_i64(o, m->num_threads);
+    out_char(o, ',');
+    out_i64(o, m->voluntary_ctx_switches);
+    out_char(o, ',');
+    out_i64(o, m->nonvoluntary_ctx_switches);
+    out_char(o, ',');
+    out_i64(o, m->mem_vsize);
+    out_char(o, ',');
+    out_i64(o, m->mem_rss);
+    out_char(o, ',');
+    out_i64(o, m->mem_shared);
+    out_char(o, ',');
+    out_i64(o, m->page_faults_minor);
+    out_char(o, ',');
+    out_i64(o, m->page_faults_major);
+    out_char(o, ',');
+    out_i64(o, m->mem_swap);
+    out_char(o, ',');
+    out_u64(o, m->io_read_bytes);
+    out_char(o, ',');
+    out_u64(o, m->io_write_bytes);
+    out_char(o, ',');
+    out_fixed(o, m->io_read_rate_kbs, 2);
+    out_char(o, ',');
+    out_fixed(o, m->io_write_rate_kbs, 2);
+    out_char(o, ',');
+    out_u64(o, m->io_read_syscalls);
+    out_char(o, ',');
+    out_u64(o, m->io_write_syscalls);
+    out_char(o, ',');
+    out_u64(o, m->net_rx_bytes);
+    out_char(o, ',');
+    out_u64(o, m->net_tx_bytes);
+    out_char(o, ',');
+    out_u64(o, m->net_rx_packets);
+    out_char(o, ',');
+    out_u64(o, m->net_tx_packets);
+    out_char(o, ',');
+    out_i64(o, m->net_connections);
+    out_char(o, ',');
+    out_u64(o, m->net_rx_queue);
+    out_char(o, ',');
+    out_u64(o, m->net_tx_queue);
+    out_char(o, ',');
+    out_u64(o, m->interval_ns);
+    out_char(o, '\n');
+}
+
+// Uma amostra por linha (NDJSON), com as mesmas colunas do CSV
+void write_metrics_ndjson_row(OutBuf *o, const ProcessMetrics *m) {
+    out_lit(o, "{\"timestamp\":");
+    out_i64(o, m->timestamp);
+    out_lit(o, ",\"timestamp_ns\":");
+    out_u64(o, m->real_ns);
+    out_lit(o, ",\"interval_ns\":");
+    out_u64(o, m->interval_ns);
+    out_lit(o, ",\"pid\":");
+    out_i64(o, m->pid);
+    out_lit(o, ",\"process_name\":");
+    out_json_str(o, m->process_name);
+    out_lit(o, ",\"cpu_user_time\":");
+    out_u64(o, m->cpu_user_time);
+    out_lit(o, ",\"cpu_system_time\":");
+    out_u64(o, m->cpu_system_time);
+    out_lit(o, ",\"cpu_percent\":");
+    out_fixed(o, m->cpu_usage_percent, 2);
+    out_lit(o, ",\"threads\":");
+    out_i64(o, m->num_threads);
+    out_lit(o, ",\"vol_ctx_switches\":");
+    out_i64(o, m->voluntary_ctx_switches);
+    out_lit(o, ",\"nonvol_ctx_switches\":");
+    out_i64(o, m->nonvoluntary_ctx_switches);
+    out_lit(o, ",\"mem_vsize\":");
+    out_i64(o, m->mem_vsize);
+    out_lit(o, ",\"mem_rss\":");
+    out_i64(o, m->mem_rss);
+    out_lit(o, ",\"mem_shared\":");
+    out_i64(o, m->mem_shared);
+    out_lit(o, ",\"page_faults_minor\":");
+    out_i64(o, m->page_faults_minor);
+    out_lit(o, ",\"page_faults_major\":");
+    out_i64(o, m->page_faults_major);
+    out_lit(o, ",\"mem_swap_kb\":");
+    out_i64(o, m->mem_swap);
+    out_lit(o, ",\"io_read_bytes\":");
+    out_u64(o, m->io_read_bytes);
+    out_lit(o, ",\"io_write_bytes\":");
+    out_u64(o, m->io_write_bytes);
+    out_lit(o, ",\"io_read_kbs\":");
+    out_fixed(o, m->io_read_rate_kbs, 2);
+    out_lit(o, ",\"io_write_kbs\":");
+    out_fixed(o, m->io_write_rate_kbs, 2);
+    out_lit(o, ",\"io_read_syscalls\":");
+    out_u64(o, m->io_read_syscalls);
+    out_lit(o, ",\"io_write_syscalls\":");
+    out_u64(o, m->io_write_syscalls);
+    out_lit(o, ",\"net_rx_bytes\":");
+    out_u64(o, m->net_rx_bytes);
+    out_lit(o, ",\"net_tx_bytes\":");
+    out_u64(o, m->net_tx_bytes);
+    out_lit(o, ",\"net_rx_packets\":");
+    out_u64(o, m->net_rx_packets);
+    out_lit(o, ",\"net_tx_packets\":");
+    out_u64(o, m->net_tx_packets);
+    out_lit(o, ",\"net_connections\":");
+    out_i64(o, m->net_connections);
+    out_lit(o, ",\"net_rx_queue\":");
+    out_u64(o, m->net_rx_queue);
+    out_lit(o, ",\"net_tx_queue\":");
+    out_u64(o, m->net_tx_queue);
+    out_lit(o, "}\n");
+}
+
 // Exporta para CSV
 bool export_metrics_csv(const char *filename, MetricsHistory *history) {
-    if (!history || history->count == 0) return false;
+    if (!history) return false;
     
-    FILE *fp = fopen(filename, "w");
-    if (!fp) {
+    uint64_t head = metrics_history_head(history);
+    uint64_t oldest = metrics_history_oldest(history);
+    if (oldest >= head) return false;
+    
+    OutBuf o;
+    if (!out_open(&o, filename)) {
         fprintf(stderr, "Erro ao criar arquivo CSV: %s\n", strerror(errno));
         return false;
     }
     
-    // Header
-    fprintf(fp, "timestamp,pid,process_name,");
-    fprintf(fp, "cpu_user_time,cpu_system_time,cpu_percent,threads,vol_ctx_switches,nonvol_ctx_switches,");
-    fprintf(fp, "mem_vsize,mem_rss,mem_shared,page_faults_minor,page_faults_major,mem_swap_kb,");
-    fprintf(fp, "io_read_bytes,io_write_bytes,io_read_kbs,io_write_kbs,io_read_syscalls,io_write_syscalls,");
-    fprintf(fp, "net_rx_bytes,net_tx_bytes,net_rx_packets,net_tx_packets,net_connections\n");
+    write_metrics_csv_header(&o);
+    ProcessMetrics sample;
+    for (uint64_t pos = oldest; pos < head; pos++) {
+        if (metrics_history_read(history, pos, &sample)) {
+            write_metrics_csv_row(&o, &sample);
+        }
+    }
     
-    // Data
-    for (int i = 0; i < history->count; i++) {
-        ProcessMetrics *m = &history->samples[i];
-        
-        fprintf(fp, "%ld,%d,%s,", m->timestamp, m->pid, m->process_name);
-        fprintf(fp, "%lu,%lu,%.2f,%ld,%ld,%ld,", 
-                m->cpu_user_time, m->cpu_system_time, m->cpu_usage_percent,
-                m->num_threads, m->voluntary_ctx_switches, m->nonvoluntary_ctx_switches);
-        fprintf(fp, "%ld,%ld,%ld,%ld,%ld,%ld,",
-                m->mem_vsize, m->mem_rss, m->mem_shared,
-                m->page_faults_minor, m->page_faults_major, m->mem_swap);
-        fprintf(fp, "%llu,%llu,%.2f,%.2f,%llu,%llu,",
-                m->io_read_bytes, m->io_write_bytes,
-                m->io_read_rate_kbs, m->io_write_rate_kbs,
-                m->io_read_syscalls, m->io_write_syscalls);
-        fprintf(fp, "%llu,%llu,%llu,%llu,%d\n",
-                m->net_rx_bytes, m->net_tx_bytes,
-                m->net_rx_packets, m->net_tx_packets, m->net_connections);
+    if (!out_close(&o)) {
+        fprintf(stderr, "Erro ao gravar arquivo CSV %s\n", filename);
+        return false;
+    }
+    return true;
+}
+
+// Resumo por thread a partir do histórico (dimensão por TID): médias de
+// CPU% e de trocas de contexto por segundo das threads mais ativas
+#define THREAD_SUMMARY_ROWS 10
+
+typedef struct {
+    uint32_t entity;
+    size_t samples;
+    double cpu_sum;
+    double cpu_max;
+    double ctx_sum;
+    int processor;      // última CPU na amostra mais recente
+} ThreadSummary;
+
+static int compare_thread_summary(const void *a, const void *b) {
+    const ThreadSummary *x = a, *y = b;
+    double ax = x->samples ? x->cpu_sum / x->samples : 0.0;
+    double ay = y->samples ? y->cpu_sum / y->samples : 0.0;
+    if (ax != ay) return (ax < ay) - (ax > ay);
+    return (x->entity > y->entity) - (x->entity < y->entity);
+}
+
+static void print_thread_summary(MetricsHistory *history) {
+    ThreadStore *s = history->threads;
+    if (!s) return;
+    
+    // Ids de entidade são densos: agregação direta por índice
+    uint32_t entities = atomic_load_explicit(&s->entities.count, memory_order_acquire);
+    if (entities == 0) return;
+    ThreadSummary *sum = calloc(entities, sizeof(ThreadSummary));
+    if (!sum) return;
+    for (uint32_t e = 0; e < entities; e++) sum[e].entity = e;
+    
+    uint64_t head = ring_head(&s->seq);
+    for (uint64_t pos = ring_oldest(&s->seq); pos < head; pos++) {
+        size_t i = ring_slot(&s->seq, pos);
+        uint32_t e = s->entity[i];
+        if (e >= entities) continue;
+        sum[e].samples++;
+        sum[e].cpu_sum += s->cpu_percent[i];
+        if (s->cpu_percent[i] > sum[e].cpu_max) sum[e].cpu_max = s->cpu_percent[i];
+        sum[e].ctx_sum += s->ctx_rate[i];
+        sum[e].processor = s->processor[i];
+    }
+    qsort(sum, entities, sizeof(ThreadSummary), compare_thread_summary);
+    
+    printf("\n=== Threads: %u no histórico (até %d com maior CPU%% media) ===\n",
+           entities, THREAD_SUMMARY_ROWS);
+    printf("%-8s | %-16s | %10s | %10s | %10s | %8s\n",
+           "TID", "Nome", "CPU% med", "CPU% max", "Trocas/s", "Ult. CPU");
+    printf("---------|------------------|------------|------------|------------|---------\n");
+    for (uint32_t r = 0; r < entities && r < THREAD_SUMMARY_ROWS; r++) {
+        const ThreadSummary *t = &sum[r];
+        const EntityName *name = entity_get(&s->entities, t->entity);
+        if (!name || t->samples == 0) continue;
+        printf("%-8d | %-16.16s | %10.2f | %10.2f | %10.1f | %8d\n",
+               name->pid, name->name, t->cpu_sum / t->samples, t->cpu_max,
+               t->ctx_sum / t->samples, t->processor);
+    }
+    free(sum);
+}
+
+// Eventos de pressão retidos no histórico, por recurso
+static void print_stall_summary(const MetricsHistory *history) {
+    if (!history->stalls) return;
+    uint64_t head = metrics_history_stall_head(history);
+    uint64_t oldest = metrics_history_stall_oldest(history);
+    uint64_t count[PSI_RESOURCES] = {0}, stall_us[PSI_RESOURCES] = {0};
+    for (uint64_t pos = oldest; pos < head; pos++) {
+        PsiEvent ev;
+        if (!metrics_history_read_stall(history, pos, &ev) || ev.resource >= PSI_RESOURCES) continue;
+        count[ev.resource]++;
+        stall_us[ev.resource] += ev.stall_us;
     }
     
-    fclose(fp);
+    printf("\n=== Pressão (PSI): %llu evento(s) de espera ===\n", (unsigned long long)(head - oldest));
+    if (head == oldest) return;
+    printf("%-8s | %8s | %12s\n", "Recurso", "Eventos", "Parado (ms)");
+    printf("---------|----------|-------------\n");
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        if (count[r] == 0) continue;
+        printf("%-8s | %8llu | %12.1f\n", psi_resource_name(r), (unsigned long long)count[r],
+               stall_us[r] / 1000.0);
+    }
+}
+
+// Gatilho PSI disparado durante a coleta: vai para o histórico e para a tela
+static void on_stall_event(const PsiEvent *ev, void *history) {
+    add_stall_event(ev, history);
+    printf("  ! pressão %s %s (%s): %.1f ms parado desde o último aviso, avg10 %.2f%%\n",
+           psi_resource_name(ev->resource), ev->full ? "full" : "some", ev->source,
+           ev->stall_us / 1000.0, ev->avg10);
+}
+
+// Gatilhos PSI do host (cpu, memória, I/O) com PSI_DEFAULT_TRIGGER. false
+// sem PSI ou sem permissão de escrita nos arquivos de pressão.
+static bool open_host_stall_triggers(PsiMonitor *psi, MetricsHistory *history) {
+    if (access("/proc/pressure/cpu", W_OK) != 0) return false;
+    if (!metrics_history_enable_stalls(history, 0) || !psi_monitor_init(psi, on_stall_event, history)) {
+        return false;
+    }
+    for (int r = 0; r < PSI_RESOURCES; r++) {
+        psi_monitor_add(psi, NULL, (PsiResource)r, PSI_DEFAULT_TRIGGER);
+    }
+    if (psi->count == 0) {
+        psi_monitor_close(psi);
+        return false;
+    }
     return true;
 }
 
+// Espera a próxima amostra entregando os eventos PSI que chegarem antes.
+// A espera fica no epoll do monitor PSI até o prazo do temporizador: um
+// poll externo sobre ele consumiria o evento do gatilho (ver psi.h).
+static uint64_t wait_sample_or_stall(SampleTimer *timer, PsiMonitor *psi) {
+    if (psi) {
+        uint64_t now;
+        while ((now = monotonic_ns()) < timer->deadline_ns) {
+            int timeout_ms = (int)((timer->deadline_ns - now + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC);
+            if (psi_monitor_wait(psi, timeout_ms) < 0) break;
+        }
+    }
+    return sample_timer_wait(timer);
+}
+
 // Monitoramento contínuo
-void monitor_process_continuous(int pid, int interval_sec, int duration_sec, const char *export_format) {
+void monitor_process_continuous(int pid, uint64_t interval_ns, uint64_t duration_ns,
+                                const char *export_format, size_t retention, uint64_t adaptive_max_ns) {
+    char interval_str[32], duration_str[32];
+    format_duration_ns(interval_ns, interval_str, sizeof(interval_str));
+    format_duration_ns(duration_ns, duration_str, sizeof(duration_str));
+    
     printf("\n=== Monitoramento de Processo ===\n");
+    // Modo adaptativo: o intervalo pedido é o mínimo
+    AdaptiveInterval adaptive;
+    bool adaptive_mode = adaptive_max_ns > interval_ns;
+    if (adaptive_mode) adaptive_interval_init(&adaptive, interval_ns, adaptive_max_ns);
+    
     printf("PID: %d\n", pid);
-    printf("Intervalo: %d segundos\n", interval_sec);
-    printf("Duração: %d segundos\n", duration_sec);
+    if (adaptive_mode) {
+        char ceiling_str[32];
+        format_duration_ns(adaptive.max_ns, ceiling_str, sizeof(ceiling_str));
+        printf("Intervalo: %s a %s (adaptativo)\n", interval_str, ceiling_str);
+    } else {
+        printf("Intervalo: %s\n", interval_str);
+    }
+    printf("Duração: %s\n", duration_str);
     printf("Formato de exportação: %s\n\n", export_format);
     
     // Verifica se processo existe
@@ -451,14 +1030,74 @@ void monitor_process_continuous(int pid, int interval_sec, int duration_sec, con
     
     printf("Processo: %s\n\n", comm);
     
-    int max_samples = (duration_sec / interval_sec) + 1;
-    MetricsHistory *history = create_metrics_history(max_samples);
+    ExportFormat format;
+    if (!export_format_parse(export_format, &format)) {
+        fprintf(stderr, "Formato desconhecido: %s\n", export_format);
+        return;
+    }
+    
+    // Memória limitada pela retenção, não pela duração da coleta
+    uint64_t expected = duration_ns / interval_ns + 1;
+    if (retention == 0) retention = DEFAULT_HISTORY_RETENTION;
+    if (expected < retention) retention = (size_t)expected;
+    MetricsHistory *history = create_metrics_history(retention);
     if (!history) {
         fprintf(stderr, "Erro ao alocar histórico de métricas\n");
         return;
     }
     
-    time_t start = time(NULL);
+    ProcHandle handle = {0};
+    if (!proc_handle_open(&handle, pid)) {
+        fprintf(stderr, "Erro: Processo com PID %d não encontrado\n", pid);
+        free_metrics_history(history);
+        return;
+    }
+    
+    // Threads do processo: descritores por TID mantidos abertos e listagem
+    // de task/ refeita só quando o total de threads muda
+    ThreadTable threads;
+    bool with_threads = thread_table_open(&threads, pid) &&
+                        metrics_history_enable_threads(history, 0);
+    
+    // Sockets do processo: lista de /proc/pid/fd refeita só quando o
+    // número de fds muda
+    ProcSockets sockets;
+    proc_sockets_init(&sockets);
+    
+    // As amostras vão para o disco durante a coleta; o histórico em memória
+    // serve apenas para o resumo
+    char filename[512];
+    snprintf(filename, sizeof(filename), "output/process_%d_metrics%s",
+             pid, export_format_extension(format));
+    StreamExporter exporter;
+    if (!stream_export_open(&exporter, filename, STREAM_PROCESS_METRICS, format)) {
+        thread_table_close(&threads);
+        proc_handle_close(&handle);
+        free_metrics_history(history);
+        return;
+    }
+    
+    SampleTimer timer;
+    if (!sample_timer_start(&timer, interval_ns)) {
+        stream_export_close(&exporter);
+        thread_table_close(&threads);
+        proc_handle_close(&handle);
+        free_metrics_history(history);
+        return;
+    }
+    
+    // Esperas de CPU, memória e I/O do host chegam do kernel entre as
+    // amostras, sem ler /proc/pressure a cada ciclo
+    PsiMonitor psi;
+    bool with_psi = open_host_stall_triggers(&psi, history);
+    if (with_psi) {
+        printf("Gatilhos PSI: %d (some %.0f ms em %.0f ms)\n\n", psi.count,
+               psi.triggers[0].threshold_us / 1000.0, psi.triggers[0].window_us / 1000.0);
+    }
+    
+    uint64_t start = monotonic_ns();
+    uint64_t missed = 0;
+    uint64_t scheduled_ns = 0;      // intervalo que levou à amostra atual
     int sample_num = 0;
     
     printf("%-6s | %-8s | %-10s | %-10s | %-10s | %-10s\n",
@@ -468,12 +1107,17 @@ void monitor_process_continuous(int pid, int interval_sec, int duration_sec, con
     while (1) {
         ProcessMetrics metrics;
         
-        if (!collect_process_metrics(pid, &metrics)) {
+        if (!collect_process_metrics_handle(&handle, &sockets, &metrics)) {
             fprintf(stderr, "\nProcesso %d terminou ou não pode ser acessado\n", pid);
             break;
         }
         
+        metrics.interval_ns = scheduled_ns;
         add_metrics_sample(history, &metrics);
+        if (with_threads && thread_table_sample(&threads, metrics.num_threads)) {
+            add_thread_samples(history, &threads);
+        }
+        stream_export_append(&exporter, &metrics);
         sample_num++;
         
         printf("%-6d | %7.2f%% | %10.2f | %10.2f | %10.2f | %10ld\n",
@@ -484,37 +1128,241 @@ void monitor_process_continuous(int pid, int interval_sec, int duration_sec, con
                metrics.io_write_rate_kbs,
                metrics.num_threads);
         
-        time_t elapsed = time(NULL) - start;
-        if (elapsed >= duration_sec) break;
+        if (monotonic_ns() - start >= duration_ns) break;
         
-        sleep(interval_sec);
+        scheduled_ns = interval_ns;
+        if (adaptive_mode) {
+            scheduled_ns = adaptive_interval_update(&adaptive, metrics.cpu_usage_percent, (double)metrics.mem_rss,
+                                                    (metrics.io_read_rate_kbs + metrics.io_write_rate_kbs) * 1024.0);
+            if (!sample_timer_set_interval(&timer, scheduled_ns)) break;
+        }
+        
+        uint64_t ticks = wait_sample_or_stall(&timer, with_psi ? &psi : NULL);
+        if (ticks == 0) break;
+        missed += ticks - 1;
     }
     
-    printf("\n=== Exportando dados ===\n");
+    if (with_psi) psi_monitor_close(&psi);
+    sample_timer_close(&timer);
+    thread_table_close(&threads);
+    proc_sockets_free(&sockets);
+    proc_handle_close(&handle);
+    bool success = stream_export_close(&exporter);
     
-    char filename[512];
-    bool success = false;
-    
-    if (strcmp(export_format, "json") == 0) {
-        snprintf(filename, sizeof(filename), "output/process_%d_metrics.json", pid);
-        success = export_metrics_json(filename, history);
-    } else if (strcmp(export_format, "csv") == 0) {
-        snprintf(filename, sizeof(filename), "output/process_%d_metrics.csv", pid);
-        success = export_metrics_csv(filename, history);
-    } else {
-        fprintf(stderr, "Formato desconhecido: %s\n", export_format);
+    if (missed > 0) {
+        printf("\nAviso: %llu amostra(s) atrasada(s) (coleta mais lenta que o intervalo)\n",
+               (unsigned long long)missed);
     }
-    
+    uint64_t dropped = history->store.entities.dropped + (history->threads ? history->threads->entities.dropped : 0);
+    if (dropped > 0) {
+        printf("\nAviso: %llu linha(s) gravada(s) sem PID/nome (dicionário de entidades sem memória)\n",
+               (unsigned long long)dropped);
+    }
+
+    // Resumo incremental: cobre a captura inteira, não só a janela retida
+    metrics_summary_print(&history->summary);
+    char summary_path[512];
+    snprintf(summary_path, sizeof(summary_path), "output/process_%d_summary.json", pid);
+    bool summary_ok = history->summary.metrics[SUMMARY_CPU_PERCENT].stats.count > 0 &&
+                      metrics_summary_export_json(&history->summary, pid, summary_path);
+    print_thread_summary(history);
+    print_stall_summary(history);
+
+    printf("\n=== Exportação ===\n");
     if (success) {
         printf("✓ Dados exportados para: %s\n", filename);
-        printf("✓ Total de amostras: %d\n", history->count);
+        printf("✓ Total de amostras: %llu\n", (unsigned long long)exporter.written);
+        if (summary_ok) printf("✓ Resumo estatístico: %s\n", summary_path);
     } else {
-        fprintf(stderr, "✗ Erro ao exportar dados\n");
+        fprintf(stderr, "✗ Erro ao exportar dados (%llu amostras gravadas em %s)\n",
+                (unsigned long long)exporter.written, filename);
+    }
+    if (exporter.dropped > 0) {
+        printf("  (%llu amostras descartadas: gravação mais lenta que a coleta)\n",
+               (unsigned long long)exporter.dropped);
     }
     
     free_metrics_history(history);
 }
 
+// Ordena por CPU% decrescente (empate: menor PID primeiro)
+static int compare_slots_cpu(const void *a, const void *b) {
+    const ProcessSlot *sa = *(const ProcessSlot * const *)a;
+    const ProcessSlot *sb = *(const ProcessSlot * const *)b;
+    if (sa->cur.cpu_usage_percent != sb->cur.cpu_usage_percent) {
+        return (sa->cur.cpu_usage_percent < sb->cur.cpu_usage_percent) ? 1 : -1;
+    }
+    return sa->pid - sb->pid;
+}
+
+// Cada processo mantém até 5 descritores abertos (diretório, stat, statm,
+// status e io); eleva o limite flexível de arquivos até o limite rígido.
+void raise_fd_limit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+// Monitoramento multi-processo ("top")
+void monitor_processes_continuous(const int *pids, int npids, uint64_t interval_ns, uint64_t duration_ns) {
+    char interval_str[32], duration_str[32];
+    format_duration_ns(interval_ns, interval_str, sizeof(interval_str));
+    format_duration_ns(duration_ns, duration_str, sizeof(duration_str));
+    
+    printf("\n=== Monitoramento Multi-Processo ===\n");
+    if (pids) {
+        printf("PIDs: %d processo(s) selecionado(s)\n", npids);
+    } else {
+        printf("PIDs: todos os processos de /proc\n");
+    }
+    printf("Intervalo: %s\n", interval_str);
+    printf("Duração: %s\n\n", duration_str);
+    
+    raise_fd_limit();
+    
+    ProcessTable table;
+    if (!process_table_init(&table, pids ? (size_t)npids * 2 : 1024)) {
+        fprintf(stderr, "Erro ao alocar tabela de processos\n");
+        return;
+    }
+    
+    DIR *proc_dir = NULL;
+    if (!pids) {
+        proc_dir = opendir("/proc");
+        if (!proc_dir) {
+            fprintf(stderr, "Erro ao abrir /proc: %s\n", strerror(errno));
+            process_table_free(&table);
+            return;
+        }
+    }
+    
+    const char *csv_path = "output/monitor_all.csv";
+    OutBuf csv;
+    bool csv_ok = out_open(&csv, csv_path);
+    if (csv_ok) {
+        write_metrics_csv_header(&csv);
+    } else {
+        fprintf(stderr, "Aviso: não foi possível criar %s: %s\n", csv_path, strerror(errno));
+    }
+    
+    // Captura binária compacta, gravada em blocos durante a execução
+    const char *tsdb_path = "output/monitor_all" TSDB_EXTENSION;
+    TsdbWriter tsdb;
+    bool tsdb_ok = tsdb_writer_open(&tsdb, tsdb_path);
+    
+    SampleTimer timer;
+    if (!sample_timer_start(&timer, interval_ns)) {
+        if (tsdb_ok) tsdb_writer_close(&tsdb);
+        if (csv_ok) out_close(&csv);
+        if (proc_dir) closedir(proc_dir);
+        process_table_free(&table);
+        return;
+    }
+    
+    ProcessSlot **view = NULL;
+    size_t view_cap = 0;
+    uint64_t start = monotonic_ns();
+    
+    while (1) {
+        process_table_begin_tick(&table);
+        
+        if (proc_dir) {
+            // rewinddir relê o diretório: novos processos aparecem a cada tick
+            rewinddir(proc_dir);
+            struct dirent *entry;
+            while ((entry = readdir(proc_dir)) != NULL) {
+                if (entry->d_name[0] < '1' || entry->d_name[0] > '9') continue;
+                process_table_sample(&table, atoi(entry->d_name));
+            }
+        } else {
+            for (int i = 0; i < npids; i++) {
+                process_table_sample(&table, pids[i]);
+            }
+        }
+        size_t exited = process_table_sweep(&table);
+        
+        // Visão ordenada do tick (ponteiros válidos até o próximo tick)
+        if (table.count > view_cap) {
+            size_t new_cap = table.count * 2;
+            ProcessSlot **new_view = realloc(view, new_cap * sizeof(ProcessSlot *));
+            if (!new_view) {
+                fprintf(stderr, "Erro ao alocar visão de processos\n");
+                break;
+            }
+            view = new_view;
+            view_cap = new_cap;
+        }
+        size_t n = 0;
+        for (size_t i = 0; i < table.capacity; i++) {
+            if (table.slots[i].pid != 0) view[n++] = &table.slots[i];
+        }
+        qsort(view, n, sizeof(ProcessSlot *), compare_slots_cpu);
+        
+        printf("\n=== Tick %lu | %zu processos | %zu encerrados ===\n", table.tick, n, exited);
+        printf("%-7s | %-16s | %-8s | %-10s | %-11s | %-11s | %-7s\n",
+               "PID", "Nome", "CPU%", "Mem(MB)", "I/O R(KB/s)", "I/O W(KB/s)", "Threads");
+        printf("--------|------------------|----------|------------|-------------|-------------|--------\n");
+        
+        size_t rows = (pids || n < TOP_ROWS) ? n : TOP_ROWS;
+        for (size_t i = 0; i < rows; i++) {
+            ProcessMetrics *m = &view[i]->cur;
+            printf("%-7d | %-16.16s | %7.2f%% | %10.2f | %11.2f | %11.2f | %7ld\n",
+                   m->pid, m->process_name, m->cpu_usage_percent,
+                   m->mem_rss / (1024.0 * 1024.0),
+                   m->io_read_rate_kbs, m->io_write_rate_kbs, m->num_threads);
+        }
+        if (rows < n) {
+            printf("... %zu processos omitidos\n", n - rows);
+        }
+        
+        if (csv_ok) {
+            for (size_t i = 0; i < n; i++) {
+                write_metrics_csv_row(&csv, &view[i]->cur);
+            }
+            // Um write por tick: o CSV acompanha a coleta
+            out_flush(&csv);
+        }
+        if (tsdb_ok) {
+            for (size_t i = 0; i < n && tsdb_ok; i++) {
+                tsdb_ok = tsdb_writer_append(&tsdb, &view[i]->cur);
+            }
+            // Processos encerrados liberam seus blocos abertos
+            tsdb_ok = tsdb_ok && tsdb_writer_end_tick(&tsdb);
+            if (!tsdb_ok) tsdb_writer_close(&tsdb);
+        }
+        
+        if (pids && n == 0) {
+            fprintf(stderr, "\nTodos os processos selecionados terminaram\n");
+            break;
+        }
+        
+        if (monotonic_ns() - start >= duration_ns) break;
+        
+        if (sample_timer_wait(&timer) == 0) break;
+    }
+    
+    sample_timer_close(&timer);
+    
+    if (csv_ok) {
+        if (out_close(&csv)) {
+            printf("\n✓ Dados exportados para: %s\n", csv_path);
+        } else {
+            fprintf(stderr, "\nErro ao gravar %s\n", csv_path);
+        }
+    }
+    if (tsdb_ok && tsdb_writer_close(&tsdb)) {
+        printf("✓ Captura binária: %s (%llu amostras, %.1f bytes/amostra)\n", tsdb_path,
+               (unsigned long long)tsdb.samples,
+               tsdb.samples ? (double)tsdb.offset / (double)tsdb.samples : 0.0);
+    }
+    
+    free(view);
+    if (proc_dir) closedir(proc_dir);
+    process_table_free(&table);
+}
+
 // Interface interativa
 void monitor_process_interactive(void) {
     int pid, interval, duration;
@@ -543,7 +1391,7 @@ void monitor_process_interactive(void) {
         return;
     }
     
-    printf("Formato de exportação (json/csv): ");
+    printf("Formato de exportação (json/ndjson/csv/bin): ");
     if (scanf("%s", format) != 1) {
         printf("Formato inválido\n");
         while (getchar() != '\n');
@@ -552,7 +1400,8 @@ void monitor_process_interactive(void) {
     
     while (getchar() != '\n');
     
-    monitor_process_continuous(pid, interval, duration, format);
+    monitor_process_continuous(pid, (uint64_t)interval * NSEC_PER_SEC,
+                               (uint64_t)duration * NSEC_PER_SEC, format, 0, 0);
     
     printf("\nPressione ENTER para continuar...");
     getchar();
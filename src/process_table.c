@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/process_table.h"
+#include "../include/timing.h"
+
+#define MIN_CAPACITY 64
+
+// Hash multiplicativo de Fibonacci: PIDs consecutivos se espalham pela tabela
+static inline size_t pid_hash(int pid, size_t mask) {
+    return ((uint32_t)pid * 2654435761u) & mask;
+}
+
+static size_t round_pow2(size_t n) {
+    size_t cap = MIN_CAPACITY;
+    while (cap < n) cap <<= 1;
+    return cap;
+}
+
+bool process_table_init(ProcessTable *t, size_t initial_capacity) {
+    memset(t, 0, sizeof(ProcessTable));
+    t->capacity = round_pow2(initial_capacity);
+    t->slots = calloc(t->capacity, sizeof(ProcessSlot));
+    if (!t->slots) {
+        t->capacity = 0;
+        return false;
+    }
+    return true;
+}
+
+void process_table_free(ProcessTable *t) {
+    if (!t || !t->slots) return;
+    for (size_t i = 0; i < t->capacity; i++) {
+        if (t->slots[i].pid != 0) {
+            proc_handle_close(&t->slots[i].handle);
+        }
+    }
+    free(t->slots);
+    memset(t, 0, sizeof(ProcessTable));
+}
+
+ProcessSlot *process_table_find(ProcessTable *t, int pid) {
+    if (pid <= 0 || t->capacity == 0) return NULL;
+    size_t mask = t->capacity - 1;
+    for (size_t i = pid_hash(pid, mask); ; i = (i + 1) & mask) {
+        if (t->slots[i].pid == pid) return &t->slots[i];
+        if (t->slots[i].pid == 0) return NULL;
+    }
+}
+
+// Dobra a capacidade e reinsere todos os slots. Os handles são movidos
+// por cópia simples: descritores e buffers continuam pertencendo a eles.
+static bool grow(ProcessTable *t) {
+    size_t new_cap = t->capacity * 2;
+    ProcessSlot *new_slots = calloc(new_cap, sizeof(ProcessSlot));
+    if (!new_slots) return false;
+
+    size_t mask = new_cap - 1;
+    for (size_t i = 0; i < t->capacity; i++) {
+        if (t->slots[i].pid == 0) continue;
+        size_t j = pid_hash(t->slots[i].pid, mask);
+        while (new_slots[j].pid != 0) j = (j + 1) & mask;
+        new_slots[j] = t->slots[i];
+    }
+
+    free(t->slots);
+    t->slots = new_slots;
+    t->capacity = new_cap;
+    return true;
+}
+
+ProcessSlot *process_table_insert(ProcessTable *t, int pid) {
+    if (pid <= 0) return NULL;
+
+    ProcessSlot *slot = process_table_find(t, pid);
+    if (slot) return slot;
+
+    if ((t->count + 1) * 2 > t->capacity && !grow(t)) return NULL;
+
+    size_t mask = t->capacity - 1;
+    size_t i = pid_hash(pid, mask);
+    while (t->slots[i].pid != 0) i = (i + 1) & mask;
+
+    slot = &t->slots[i];
+    memset(slot, 0, sizeof(ProcessSlot));
+    slot->pid = pid;
+    t->count++;
+    return slot;
+}
+
+// Remove o slot i e desloca para trás os elementos da mesma sequência de
+// sondagem que ficariam inalcançáveis com o buraco.
+static void remove_at(ProcessTable *t, size_t i) {
+    size_t mask = t->capacity - 1;
+    proc_handle_close(&t->slots[i].handle);
+
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (t->slots[j].pid == 0) break;
+        size_t home = pid_hash(t->slots[j].pid, mask);
+        // O elemento em j pode ocupar o buraco em i se sua posição ideal
+        // não estiver no intervalo cíclico (i, j]
+        bool between = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!between) {
+            t->slots[i] = t->slots[j];
+            i = j;
+        }
+    }
+    memset(&t->slots[i], 0, sizeof(ProcessSlot));
+    t->count--;
+}
+
+void process_table_remove(ProcessTable *t, int pid) {
+    ProcessSlot *slot = process_table_find(t, pid);
+    if (slot) remove_at(t, (size_t)(slot - t->slots));
+}
+
+void process_table_begin_tick(ProcessTable *t) {
+    t->tick++;
+    t->full_reads = 0;
+    t->stat_reads = 0;
+}
+
+// FNV-1a de 64 bits: detecta mudança no conteúdo de stat sem guardar cópia
+static uint64_t content_hash(const char *buf, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)buf[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Coleta uma amostra no handle do slot, reabrindo-o se necessário
+static bool sample_slot(ProcessSlot *slot) {
+    if (proc_handle_valid(&slot->handle) &&
+        collect_process_metrics_groups(&slot->handle, &slot->cur, PROC_METRICS_LOCAL)) {
+        return true;
+    }
+
+    // Handle nunca aberto ou processo terminou: se o PID ainda existe,
+    // pertence a um novo processo e os deltas recomeçam do zero
+    slot->has_prev = false;
+    return proc_handle_open(&slot->handle, slot->pid) &&
+           collect_process_metrics_groups(&slot->handle, &slot->cur, PROC_METRICS_LOCAL);
+}
+
+// Deltas contra a amostra anterior do slot; cur passa a ser a anterior
+static void update_deltas(ProcessSlot *slot) {
+    slot->ctx_switch_rate = 0.0;
+    slot->fault_rate = 0.0;
+    if (slot->has_prev) {
+        calculate_cpu_percent(&slot->cur, &slot->prev);
+        calculate_io_rates(&slot->cur, &slot->prev);
+        
+        ProcessMetrics *cur = &slot->cur, *prev = &slot->prev;
+        if (cur->mono_ns > prev->mono_ns) {
+            double dt = (double)(cur->mono_ns - prev->mono_ns) / NSEC_PER_SEC;
+            long ctx = (cur->voluntary_ctx_switches + cur->nonvoluntary_ctx_switches) -
+                       (prev->voluntary_ctx_switches + prev->nonvoluntary_ctx_switches);
+            long faults = (cur->page_faults_minor + cur->page_faults_major) -
+                          (prev->page_faults_minor + prev->page_faults_major);
+            if (ctx > 0) slot->ctx_switch_rate = ctx / dt;
+            if (faults > 0) slot->fault_rate = faults / dt;
+        }
+    }
+    slot->prev = slot->cur;
+    slot->has_prev = true;
+}
+
+ProcessSlot *process_table_sample(ProcessTable *t, int pid) {
+    ProcessSlot *slot = process_table_insert(t, pid);
+    if (!slot) return NULL;
+
+    if (!sample_slot(slot)) {
+        remove_at(t, (size_t)(slot - t->slots));
+        return NULL;
+    }
+
+    slot->seen_tick = t->tick;
+    update_deltas(slot);
+    return slot;
+}
+
+ProcessSlot *process_table_refresh(ProcessTable *t, int pid) {
+    ProcessSlot *slot = process_table_insert(t, pid);
+    if (!slot) return NULL;
+    slot->seen_tick = t->tick;
+    
+    if (slot->excluded) return slot;
+    
+    // stat é relido a cada tick; o restante só se ele mudou
+    size_t len = 0;
+    const char *buf = NULL;
+    if (proc_handle_valid(&slot->handle)) {
+        proc_handle_begin_sample(&slot->handle);
+        buf = proc_handle_read(&slot->handle, PROC_FILE_STAT, &len);
+    }
+    uint64_t hash = buf ? content_hash(buf, len) : 0;
+    
+    if (buf && slot->has_prev && hash == slot->stat_hash) {
+        // Nada mudou: mesmas métricas, taxas zeradas
+        TIMING_STAMP(&slot->cur);
+        slot->cur.cpu_usage_percent = 0.0;
+        slot->cur.io_read_rate_kbs = 0.0;
+        slot->cur.io_write_rate_kbs = 0.0;
+        slot->prev = slot->cur;
+        slot->ctx_switch_rate = 0.0;
+        slot->fault_rate = 0.0;
+        
+        // Processo ocioso: só stat continua aberto (status/statm/io são
+        // reabertos quando ele voltar a mudar)
+        if (slot->idle_streak == 0) proc_handle_trim(&slot->handle);
+        slot->idle_streak++;
+        t->stat_reads++;
+        return slot;
+    }
+    
+    bool ok;
+    if (buf) {
+        ok = collect_process_metrics_sampled(&slot->handle, &slot->cur, PROC_METRICS_LOCAL);
+    } else {
+        // Handle nunca aberto ou PID reutilizado: recomeça (ver sample_slot)
+        ok = sample_slot(slot);
+        if (ok) {
+            buf = proc_handle_read(&slot->handle, PROC_FILE_STAT, &len);
+            hash = buf ? content_hash(buf, len) : 0;
+        }
+    }
+    if (!ok) {
+        remove_at(t, (size_t)(slot - t->slots));
+        return NULL;
+    }
+    
+    // Primeira leitura: com milhares de processos, manter status/statm/io
+    // abertos para todos esgotaria os descritores; ficam abertos apenas
+    // para os que continuarem mudando
+    if (!slot->has_prev) proc_handle_trim(&slot->handle);
+    
+    slot->stat_hash = hash;
+    slot->idle_streak = 0;
+    t->full_reads++;
+    update_deltas(slot);
+    return slot;
+}
+
+size_t process_table_sweep(ProcessTable *t) {
+    size_t removed = 0;
+    size_t i = 0;
+    while (i < t->capacity) {
+        ProcessSlot *slot = &t->slots[i];
+        if (slot->pid != 0 && slot->seen_tick != t->tick) {
+            // Não avança: o deslocamento reverso pode ter trazido outro slot para i
+            remove_at(t, i);
+            removed++;
+        } else {
+            i++;
+        }
+    }
+    return removed;
+}
@@ -0,0 +1,239 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include "../include/psi.h"
+#include "../include/cgroup_stats.h"
+#include "../include/timing.h"
+
+#define PSI_BUF      256
+#define EPOLL_BATCH  32
+
+static const char *const resource_names[PSI_RESOURCES] = { "cpu", "memory", "io" };
+
+const char *psi_resource_name(PsiResource r) {
+    return r >= 0 && r < PSI_RESOURCES ? resource_names[r] : "?";
+}
+
+bool psi_resource_parse(const char *name, PsiResource *r) {
+    for (int i = 0; i < PSI_RESOURCES; i++) {
+        if (strcmp(name, resource_names[i]) == 0) {
+            *r = (PsiResource)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool psi_parse(const char *text, PsiStat *out) {
+    memset(out, 0, sizeof(*out));
+    bool has_some = false;
+    for (const char *line = text; line && *line;) {
+        char kind[5];
+        PsiLine l;
+        unsigned long long total;
+        if (sscanf(line, "%4s avg10=%lf avg60=%lf avg300=%lf total=%llu", kind, &l.avg10, &l.avg60, &l.avg300,
+                   &total) == 5) {
+            l.total_us = total;
+            if (strcmp(kind, "some") == 0) {
+                out->some = l;
+                has_some = true;
+            } else if (strcmp(kind, "full") == 0) {
+                out->full = l;
+                out->has_full = true;
+            }
+        }
+        line = strchr(line, '\n');
+        if (line) line++;
+    }
+    return has_some;
+}
+
+bool psi_read_host(PsiResource r, PsiStat *out) {
+    char path[64], buf[PSI_BUF];
+    snprintf(path, sizeof(path), "/proc/pressure/%s", psi_resource_name(r));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return false;
+    buf[n] = '\0';
+    return psi_parse(buf, out);
+}
+
+bool psi_read_cgroup(const char *cgroup, PsiResource r, PsiStat *out) {
+    char file[32], buf[PSI_BUF];
+    snprintf(file, sizeof(file), "%s.pressure", psi_resource_name(r));
+    if (read_cgroup_file(cgroup, file, buf, sizeof(buf)) != 0) return false;
+    return psi_parse(buf, out);
+}
+
+bool psi_parse_trigger(const char *spec, bool *full, uint64_t *threshold_us, uint64_t *window_us) {
+    char kind[8], extra;
+    unsigned long long threshold, window;
+    if (sscanf(spec, "%7s %llu %llu %c", kind, &threshold, &window, &extra) != 3) return false;
+    if (strcmp(kind, "some") == 0) {
+        *full = false;
+    } else if (strcmp(kind, "full") == 0) {
+        *full = true;
+    } else {
+        return false;
+    }
+    if (window < PSI_MIN_WINDOW_US || window > PSI_MAX_WINDOW_US || threshold == 0 || threshold > window) {
+        return false;
+    }
+    *threshold_us = threshold;
+    *window_us = window;
+    return true;
+}
+
+static bool write_trigger(int fd, bool full, uint64_t threshold_us, uint64_t window_us) {
+    char spec[64];
+    int len = snprintf(spec, sizeof(spec), "%s %llu %llu", full ? "full" : "some",
+                       (unsigned long long)threshold_us, (unsigned long long)window_us);
+    return write(fd, spec, (size_t)len + 1) == len + 1;
+}
+
+// Total acumulado da linha do gatilho (pread no próprio descritor)
+static bool read_trigger(const PsiTrigger *t, PsiLine *line) {
+    char buf[PSI_BUF];
+    ssize_t n = pread(t->fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return false;
+    buf[n] = '\0';
+    PsiStat st;
+    if (!psi_parse(buf, &st) || (t->full && !st.has_full)) return false;
+    *line = t->full ? st.full : st.some;
+    return true;
+}
+
+bool psi_monitor_init(PsiMonitor *m, PsiEventFn fn, void *ctx) {
+    memset(m, 0, sizeof(*m));
+    m->fn = fn;
+    m->ctx = ctx;
+    m->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m->epoll_fd < 0) {
+        fprintf(stderr, "Erro ao criar epoll dos gatilhos PSI: %s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+int psi_monitor_add(PsiMonitor *m, const char *cgroup, PsiResource r, const char *spec) {
+    bool full;
+    uint64_t threshold, window;
+    if (!psi_parse_trigger(spec, &full, &threshold, &window)) {
+        fprintf(stderr, "Gatilho PSI inválido: '%s' (esperado \"some|full <limiar_us> <janela_us>\", "
+                "janela de 500 ms a 10 s)\n", spec);
+        return -1;
+    }
+    if (m->count == m->capacity) {
+        int capacity = m->capacity ? m->capacity * 2 : 8;
+        PsiTrigger *grown = realloc(m->triggers, (size_t)capacity * sizeof(PsiTrigger));
+        if (!grown) {
+            fprintf(stderr, "Erro: memória insuficiente para o gatilho PSI\n");
+            return -1;
+        }
+        m->triggers = grown;
+        m->capacity = capacity;
+    }
+
+    char path[512];
+    if (cgroup) {
+        snprintf(path, sizeof(path), "%s/%s/%s.pressure", CGROUP_ROOT, cgroup, psi_resource_name(r));
+    } else {
+        snprintf(path, sizeof(path), "/proc/pressure/%s", psi_resource_name(r));
+    }
+    int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Erro ao abrir %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    bool ok = write_trigger(fd, full, threshold, window);
+    if (!ok && errno == EINVAL && window % PSI_UNPRIV_WINDOW_US != 0) {
+        // Sem CAP_SYS_RESOURCE: janela múltipla de 2 s, mesma proporção
+        uint64_t rounded = (window + PSI_UNPRIV_WINDOW_US - 1) / PSI_UNPRIV_WINDOW_US * PSI_UNPRIV_WINDOW_US;
+        threshold = threshold * rounded / window;
+        window = rounded;
+        ok = write_trigger(fd, full, threshold, window);
+    }
+    if (!ok) {
+        fprintf(stderr, "Erro ao registrar o gatilho '%s' em %s: %s\n", spec, path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    int index = m->count;
+    PsiTrigger *t = &m->triggers[index];
+    memset(t, 0, sizeof(*t));
+    snprintf(t->source, sizeof(t->source), "%s", cgroup ? cgroup : "host");
+    t->resource = r;
+    t->full = full;
+    t->threshold_us = threshold;
+    t->window_us = window;
+    t->fd = fd;
+
+    PsiLine line;
+    struct epoll_event ev = { .events = EPOLLPRI, .data.u32 = (uint32_t)index };
+    if (!read_trigger(t, &line) || epoll_ctl(m->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        fprintf(stderr, "Erro ao observar %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    t->last_total_us = line.total_us;
+    m->count++;
+    return index;
+}
+
+int psi_monitor_wait(PsiMonitor *m, int timeout_ms) {
+    struct epoll_event ready[EPOLL_BATCH];
+    int n = epoll_wait(m->epoll_fd, ready, EPOLL_BATCH, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+    if (n == 0) return 0;
+    m->wakeups++;
+
+    PsiEvent ev = { .mono_ns = monotonic_ns(), .real_ns = realtime_ns() };
+    int emitted = 0;
+    for (int i = 0; i < n; i++) {
+        PsiTrigger *t = &m->triggers[ready[i].data.u32];
+        if (t->fd < 0) continue;
+
+        PsiLine line;
+        if (!read_trigger(t, &line)) {
+            // cgroup removido: o gatilho morre com o arquivo
+            epoll_ctl(m->epoll_fd, EPOLL_CTL_DEL, t->fd, NULL);
+            close(t->fd);
+            t->fd = -1;
+            continue;
+        }
+        ev.trigger = (int)ready[i].data.u32;
+        ev.resource = t->resource;
+        ev.full = t->full;
+        ev.threshold_us = t->threshold_us;
+        ev.window_us = t->window_us;
+        ev.stall_us = line.total_us - t->last_total_us;
+        ev.avg10 = line.avg10;
+        memcpy(ev.source, t->source, sizeof(ev.source));
+        t->last_total_us = line.total_us;
+        t->events++;
+        m->events++;
+        emitted++;
+        if (m->fn) m->fn(&ev, m->ctx);
+    }
+    return emitted;
+}
+
+void psi_monitor_close(PsiMonitor *m) {
+    for (int i = 0; i < m->count; i++) {
+        if (m->triggers[i].fd >= 0) close(m->triggers[i].fd);
+    }
+    free(m->triggers);
+    m->triggers = NULL;
+    m->count = m->capacity = 0;
+    if (m->epoll_fd >= 0) close(m->epoll_fd);
+    m->epoll_fd = -1;
+}
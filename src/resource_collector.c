@@ -0,0 +1,163 @@
+#include "../include/resource_collector.h"
+#include "../include/network.h"
+#include "../include/proc_parse.h"
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+static CollectBackend current_backend = COLLECT_BACKEND_PROC;
+
+void collect_backend_set(CollectBackend backend) {
+    current_backend = backend;
+}
+
+CollectBackend collect_backend_get(void) {
+    return current_backend;
+}
+
+bool collect_backend_parse(const char *name, CollectBackend *out) {
+    if (strcasecmp(name, "proc") == 0) {
+        *out = COLLECT_BACKEND_PROC;
+    } else if (strcasecmp(name, "taskstats") == 0) {
+        *out = COLLECT_BACKEND_TASKSTATS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *collect_backend_name(CollectBackend backend) {
+    return (backend == COLLECT_BACKEND_TASKSTATS) ? "taskstats" : "proc";
+}
+
+bool resource_collector_open(ResourceCollector *rc, int pid, CollectBackend backend) {
+    memset(rc, 0, sizeof(ResourceCollector));
+    rc->client.fd = -1;
+    rc->exits.fd = -1;
+    rc->backend = COLLECT_BACKEND_PROC;
+    rc->ticks_per_second = sysconf(_SC_CLK_TCK);
+    proc_sockets_init(&rc->sockets);
+
+    // Memória e rede vêm de /proc e sock_diag em qualquer backend
+    if (!proc_handle_open(&rc->handle, pid)) {
+        proc_handle_close(&rc->handle);
+        return false;
+    }
+
+    if (backend == COLLECT_BACKEND_TASKSTATS) {
+        if (taskstats_open(&rc->client)) {
+            rc->backend = COLLECT_BACKEND_TASKSTATS;
+            // Inscrição antes da primeira amostra: o término não passa despercebido
+            rc->exits_open = taskstats_open(&rc->exits) && taskstats_subscribe_exits(&rc->exits);
+            static bool warned = false;
+            if (!warned && !taskstats_delayacct_enabled()) {
+                warned = true;
+                fprintf(stderr, "Aviso: kernel.task_delayacct = 0; delays de I/O de bloco, swap-in e "
+                                "reclaim ficarão zerados (ative com: sysctl kernel.task_delayacct=1)\n");
+            }
+        } else {
+            fprintf(stderr, "Aviso: usando o backend /proc\n");
+        }
+    }
+    return true;
+}
+
+void resource_collector_close(ResourceCollector *rc) {
+    if (rc->exits.fd >= 0) taskstats_close(&rc->exits);
+    if (rc->client.fd >= 0) taskstats_close(&rc->client);
+    proc_sockets_free(&rc->sockets);
+    proc_handle_close(&rc->handle);
+    rc->exits_open = false;
+}
+
+// Consome as notificações de término pendentes, guardando a do processo.
+// O socket recebe os términos de todo o sistema: drenar a cada amostra
+// evita que o buffer encha e a notificação do processo se perca.
+static void drain_exits(ResourceCollector *rc) {
+    if (!rc->exits_open) return;
+    TaskStats s;
+    while (taskstats_read_exit(&rc->exits, &s) == 1) {
+        if (s.pid != rc->handle.pid) continue;
+        // O total do processo (tgid_scope) prevalece sobre o da thread líder
+        if (!rc->exited || s.tgid_scope || !rc->final.tgid_scope) {
+            rc->final = s;
+            rc->exited = true;
+        }
+    }
+}
+
+// Faltas de página somadas de todas as threads, de /proc/<pid>/stat
+static void read_proc_faults(ProcHandle *h, ResourceData *data) {
+    size_t len;
+    const char *buf = proc_handle_read(h, PROC_FILE_STAT, &len);
+    ProcStat st;
+    if (buf != NULL && proc_parse_stat(buf, len, &st)) {
+        data->page_faults_minor = st.minflt;
+        data->page_faults_major = st.majflt;
+    }
+}
+
+static bool sample_taskstats(ResourceCollector *rc, ResourceData *data) {
+    // Processo (TGID) e thread líder (PID) num único lote
+    TaskstatsQuery q[2] = {
+        { .pid = rc->handle.pid, .tgid = true },
+        { .pid = rc->handle.pid, .tgid = false },
+    };
+    if (taskstats_query_batch(&rc->client, q, 2) < 0 || !q[0].ok) {
+        return false;
+    }
+    const TaskStats *proc = &q[0].stats;
+    const TaskStats *leader = &q[1].stats;
+
+    // Memória, número de threads e rede
+    if (!get_memory_data_handle(&rc->handle, data)) {
+        return false;
+    }
+    get_network_data_handle(&rc->handle, &rc->sockets, data);
+
+    // Microssegundos -> jiffies, mesma unidade do backend /proc
+    data->cpu_user = (long)(proc->cpu_user_us * rc->ticks_per_second / 1000000);
+    data->cpu_system = (long)(proc->cpu_system_us * rc->ticks_per_second / 1000000);
+    data->voluntary_context_switches = (long)proc->voluntary_ctx_switches;
+    data->nonvoluntary_context_switches = (long)proc->nonvoluntary_ctx_switches;
+
+    data->cpu_delay_ns = (long long)proc->cpu_delay_ns;
+    data->blkio_delay_ns = (long long)proc->blkio_delay_ns;
+    data->swapin_delay_ns = (long long)proc->swapin_delay_ns;
+    data->freepages_delay_ns = (long long)proc->freepages_delay_ns;
+
+    if (data->num_threads <= 1 && q[1].ok) {
+        data->page_faults_minor = (long)leader->minor_faults;
+        data->page_faults_major = (long)leader->major_faults;
+        data->io_read_bytes = (long long)leader->read_bytes;
+        data->io_write_bytes = (long long)leader->write_bytes;
+        data->io_read_syscalls = (long long)leader->read_syscalls;
+        data->io_write_syscalls = (long long)leader->write_syscalls;
+    } else {
+        // Várias threads: a consulta por PID só cobre a líder
+        read_proc_faults(&rc->handle, data);
+        get_io_data_handle(&rc->handle, data);
+    }
+    return true;
+}
+
+bool resource_collector_sample(ResourceCollector *rc, ResourceData *data) {
+    memset(data, 0, sizeof(ResourceData));
+    proc_handle_begin_sample(&rc->handle);
+
+    if (rc->backend == COLLECT_BACKEND_TASKSTATS) {
+        drain_exits(rc);
+        return sample_taskstats(rc, data);
+    }
+    return get_cpu_data_handle(&rc->handle, data) && get_memory_data_handle(&rc->handle, data) &&
+           get_io_data_handle(&rc->handle, data) &&
+           get_network_data_handle(&rc->handle, &rc->sockets, data);
+}
+
+bool resource_collector_final(ResourceCollector *rc, TaskStats *out) {
+    drain_exits(rc);
+    if (!rc->exited) return false;
+    *out = rc->final;
+    return true;
+}
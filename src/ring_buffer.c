@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/ring_buffer.h"
+
+// Valor do seqlock do slot: ímpar enquanto a posição pos está sendo
+// escrita, par (e único por posição) depois de publicada.
+#define SEQ_WRITING(pos)   (2 * (pos) + 1)
+#define SEQ_PUBLISHED(pos) (2 * (pos) + 2)
+
+bool ring_init(RingBuffer *r, size_t retention, size_t elem_size) {
+    size_t cap = 1;
+    while (cap < retention) cap <<= 1;
+
+    memset(r, 0, sizeof(RingBuffer));
+    r->seqs = calloc(cap, sizeof(*r->seqs));
+    if (elem_size > 0) {
+        r->data = malloc(cap * elem_size);
+    }
+    if (!r->seqs || (elem_size > 0 && !r->data)) {
+        ring_free(r);
+        return false;
+    }
+
+    r->capacity = cap;
+    r->elem_size = elem_size;
+    atomic_init(&r->head, 0);
+    for (size_t i = 0; i < cap; i++) {
+        atomic_init(&r->seqs[i], 0);
+    }
+    return true;
+}
+
+void ring_free(RingBuffer *r) {
+    if (!r) return;
+    free((void *)r->seqs);
+    free(r->data);
+    r->seqs = NULL;
+    r->data = NULL;
+    r->capacity = 0;
+}
+
+size_t ring_write_begin(RingBuffer *r) {
+    uint64_t pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t slot = ring_slot(r, pos);
+
+    // Marca o slot como em escrita antes de tocar nos dados
+    atomic_store_explicit(&r->seqs[slot], SEQ_WRITING(pos), memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    return slot;
+}
+
+void ring_write_end(RingBuffer *r) {
+    uint64_t pos = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t slot = ring_slot(r, pos);
+
+    atomic_store_explicit(&r->seqs[slot], SEQ_PUBLISHED(pos), memory_order_release);
+    atomic_store_explicit(&r->head, pos + 1, memory_order_release);
+}
+
+void ring_push(RingBuffer *r, const void *elem) {
+    size_t slot = ring_write_begin(r);
+    memcpy(r->data + slot * r->elem_size, elem, r->elem_size);
+    ring_write_end(r);
+}
+
+uint64_t ring_head(const RingBuffer *r) {
+    return atomic_load_explicit(&((RingBuffer *)r)->head, memory_order_acquire);
+}
+
+uint64_t ring_oldest(const RingBuffer *r) {
+    uint64_t head = ring_head(r);
+    return (head > r->capacity) ? head - r->capacity : 0;
+}
+
+bool ring_read_begin(const RingBuffer *r, uint64_t pos, size_t *slot) {
+    if (pos >= ring_head(r)) return false;
+
+    *slot = ring_slot(r, pos);
+    uint64_t seq = atomic_load_explicit(&r->seqs[*slot], memory_order_acquire);
+    return seq == SEQ_PUBLISHED(pos);
+}
+
+bool ring_read_validate(const RingBuffer *r, uint64_t pos, size_t slot) {
+    // Se o produtor reutilizou o slot durante a cópia, o seqlock mudou
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t seq = atomic_load_explicit(&r->seqs[slot], memory_order_relaxed);
+    return seq == SEQ_PUBLISHED(pos);
+}
+
+bool ring_read(const RingBuffer *r, uint64_t pos, void *out) {
+    size_t slot;
+    if (!ring_read_begin(r, pos, &slot)) return false;
+    memcpy(out, r->data + slot * r->elem_size, r->elem_size);
+    return ring_read_validate(r, pos, slot);
+}
+
+bool ring_read_latest(const RingBuffer *r, void *out) {
+    uint64_t head = ring_head(r);
+    return head > 0 && ring_read(r, head - 1, out);
+}
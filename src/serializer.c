@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "../include/serializer.h"
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t pow10_u64[10] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+    1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+};
+
+bool out_init(OutBuf *o, int fd, char *buf, size_t cap) {
+    memset(o, 0, sizeof(OutBuf));
+    o->fd = fd;
+    o->cap = cap ? cap : OUT_BUF_SIZE;
+    o->data = buf;
+    if (!o->data) {
+        o->data = malloc(o->cap);
+        if (!o->data) return false;
+        o->owns_data = true;
+    }
+    return true;
+}
+
+bool out_open(OutBuf *o, const char *path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        memset(o, 0, sizeof(OutBuf));
+        o->fd = -1;
+        return false;
+    }
+    if (!out_init(o, fd, NULL, OUT_BUF_SIZE)) {
+        close(fd);
+        o->fd = -1;
+        return false;
+    }
+    o->owns_fd = true;
+    return true;
+}
+
+// Escreve todos os segmentos, tratando escritas parciais e EINTR
+static void write_iov(OutBuf *o, struct iovec *iov, int count) {
+    while (count > 0 && !o->failed) {
+        ssize_t n = writev(o->fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            o->failed = true;
+            break;
+        }
+        o->written += (uint64_t)n;
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+}
+
+bool out_flush(OutBuf *o) {
+    if (o->len > 0) {
+        struct iovec iov = { .iov_base = o->data, .iov_len = o->len };
+        write_iov(o, &iov, 1);
+        o->len = 0;     // em caso de erro o conteúdo é descartado
+    }
+    return !o->failed;
+}
+
+bool out_close(OutBuf *o) {
+    bool ok = out_flush(o);
+    if (o->owns_fd && o->fd >= 0 && close(o->fd) != 0) ok = false;
+    if (o->owns_data) free(o->data);
+    o->data = NULL;
+    o->fd = -1;
+    o->len = o->cap = 0;
+    return ok;
+}
+
+void out_write_slow(OutBuf *o, const void *p, size_t n) {
+    if (n < o->cap / 2) {
+        out_flush(o);
+        memcpy(o->data, p, n);
+        o->len = n;
+        return;
+    }
+
+    // Bloco grande: buffer pendente e bloco numa única chamada
+    struct iovec iov[2] = {
+        { .iov_base = o->data, .iov_len = o->len },
+        { .iov_base = (void *)p, .iov_len = n },
+    };
+    write_iov(o, iov, 2);
+    o->len = 0;
+}
+
+// Dígitos de v, do fim para o início de end; retorna o primeiro dígito
+static char *format_u64(char *end, uint64_t v) {
+    char *p = end;
+    while (v >= 100) {
+        unsigned idx = (unsigned)(v % 100) * 2;
+        v /= 100;
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
+    }
+    if (v >= 10) {
+        unsigned idx = (unsigned)v * 2;
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    return p;
+}
+
+void out_u64(OutBuf *o, uint64_t v) {
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    char *p = format_u64(end, v);
+    out_write(o, p, (size_t)(end - p));
+}
+
+void out_i64(OutBuf *o, int64_t v) {
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    uint64_t mag = (v < 0) ? (uint64_t)0 - (uint64_t)v : (uint64_t)v;
+    char *p = format_u64(end, mag);
+    if (v < 0) *--p = '-';
+    out_write(o, p, (size_t)(end - p));
+}
+
+void out_fixed(OutBuf *o, double v, int decimals) {
+    if (decimals < 0) decimals = 0;
+    if (decimals > 9) decimals = 9;
+
+    double scaled = fabs(v) * (double)pow10_u64[decimals];
+    double whole = floor(scaled);
+    double frac = scaled - whole;
+
+    // NaN/infinito, valores enormes ou quase empate em x.5 (onde o erro da
+    // multiplicação poderia mudar o arredondamento): printf decide
+    if (!(scaled < 1e15) || fabs(frac - 0.5) <= scaled * 0x1p-50 + 1e-9) {
+        char tmp[64];
+        int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);
+        if (n > 0) out_write(o, tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+        return;
+    }
+
+    uint64_t q = (uint64_t)whole + (frac > 0.5 ? 1 : 0);
+    char tmp[48];
+    char *end = tmp + sizeof(tmp);
+    char *p = end;
+    if (decimals > 0) {
+        uint64_t f = q % pow10_u64[decimals];
+        for (int i = 0; i < decimals; i++) {
+            *--p = (char)('0' + f % 10);
+            f /= 10;
+        }
+        *--p = '.';
+    }
+    p = format_u64(p, q / pow10_u64[decimals]);
+    if (signbit(v)) *--p = '-';
+    out_write(o, p, (size_t)(end - p));
+}
+
+void out_json_str(OutBuf *o, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    out_char(o, '"');
+    const char *run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out_write(o, run, (size_t)(s - run));
+        if (c == '"' || c == '\\') {
+            char esc[2] = { '\\', (char)c };
+            out_write(o, esc, 2);
+        } else {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+            out_write(o, esc, 6);
+        }
+        run = s + 1;
+    }
+    out_write(o, run, (size_t)(s - run));
+    out_char(o, '"');
+}
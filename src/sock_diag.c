@@ -0,0 +1,300 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <dirent.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+#include <linux/tcp.h>
+#include "../include/sock_diag.h"
+
+#define DIAG_BUF_SIZE (64 * 1024)   // mensagens de dump chegam em lotes
+#define TCP_STATE_LISTEN 10         // filas de LISTEN são backlog, não dados
+
+void proc_sockets_init(ProcSockets *ps) {
+    memset(ps, 0, sizeof(ProcSockets));
+    ps->fd_count = -1;
+    ps->count_supported = true;
+    ps->diag_fd = -1;
+}
+
+void proc_sockets_free(ProcSockets *ps) {
+    if (ps->diag_fd >= 0) close(ps->diag_fd);
+    free(ps->entries);
+    free(ps->buf);
+    proc_sockets_init(ps);
+}
+
+// Socket que sumiu: os últimos contadores vistos passam ao total aposentado
+static void retire(ProcSockets *ps, ProcSocketEntry *e) {
+    ps->retired.bytes_received += e->bytes_received;
+    ps->retired.bytes_sent += e->bytes_sent;
+    ps->retired.segs_in += e->segs_in;
+    ps->retired.segs_out += e->segs_out;
+    e->bytes_received = e->bytes_sent = e->segs_in = e->segs_out = 0;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static ProcSocketEntry *find_entry(ProcSockets *ps, uint32_t inode) {
+    size_t lo = 0, hi = ps->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (ps->entries[mid].inode < inode) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < ps->count && ps->entries[lo].inode == inode) ? &ps->entries[lo] : NULL;
+}
+
+// Relê /proc/<pid>/fd. Os inodes são intercalados com a lista anterior
+// (ambas ordenadas) para manter a classificação dos sockets inet que
+// continuam. Os classificados como OTHER voltam a UNKNOWN: um socket UDP
+// ainda sem porta não aparece nos dumps até o bind/connect.
+static bool relist(ProcSockets *ps, ProcHandle *h, long fd_count) {
+    int fd = openat(h->dir_fd, "fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    DIR *dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        return false;
+    }
+
+    size_t cap = ps->count + 16, n = 0;
+    uint32_t *inodes = malloc(cap * sizeof(uint32_t));
+    long fds = 0;
+    struct dirent *entry;
+    while (inodes && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') continue;
+        fds++;
+        char link[64];
+        ssize_t len = readlinkat(dirfd(dir), entry->d_name, link, sizeof(link) - 1);
+        if (len <= 8 || strncmp(link, "socket:[", 8) != 0) continue;
+        link[len] = '\0';
+        if (n == cap) {
+            cap *= 2;
+            uint32_t *grown = realloc(inodes, cap * sizeof(uint32_t));
+            if (!grown) break;
+            inodes = grown;
+        }
+        inodes[n++] = (uint32_t)strtoul(link + 8, NULL, 10);
+    }
+    closedir(dir);
+    if (!inodes) return false;
+    qsort(inodes, n, sizeof(uint32_t), compare_u32);
+
+    ProcSocketEntry *entries = malloc((n ? n : 1) * sizeof(ProcSocketEntry));
+    if (!entries) {
+        free(inodes);
+        return false;
+    }
+    size_t old = 0;
+    for (size_t i = 0; i < n; i++) {
+        while (old < ps->count && ps->entries[old].inode < inodes[i]) retire(ps, &ps->entries[old++]);
+        bool same = old < ps->count && ps->entries[old].inode == inodes[i];
+        if (same) {
+            entries[i] = ps->entries[old++];
+            entries[i].seen = false;
+            if (entries[i].kind == SOCK_KIND_OTHER) entries[i].kind = SOCK_KIND_UNKNOWN;
+        } else {
+            entries[i] = (ProcSocketEntry){ .inode = inodes[i], .kind = SOCK_KIND_UNKNOWN };
+        }
+    }
+    while (old < ps->count) retire(ps, &ps->entries[old++]);
+    free(inodes);
+    free(ps->entries);
+    ps->entries = entries;
+    ps->count = n;
+    ps->cap = n;
+
+    // st_size == 0 com fds abertos: kernel sem contagem (< 6.2)
+    ps->count_supported = !(fd_count == 0 && fds > 0);
+    ps->fd_count = fd_count;
+    ps->stale = false;
+    ps->relisted = true;
+    return true;
+}
+
+// Abre o socket sock_diag no namespace de rede do processo. Se não for o
+// desta thread, entra nele (setns, requer CAP_SYS_ADMIN) só para criar o
+// socket e volta: o socket continua preso ao namespace em que foi criado.
+static int open_diag_socket(ProcHandle *h, uint64_t *netns) {
+    struct stat target_st, self_st;
+    if (fstatat(h->dir_fd, "ns/net", &target_st, 0) < 0 ||
+        stat("/proc/thread-self/ns/net", &self_st) < 0) {
+        return -1;
+    }
+    *netns = target_st.st_ino;
+    if (target_st.st_ino == self_st.st_ino) {
+        return socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    }
+
+    int self_ns = open("/proc/thread-self/ns/net", O_RDONLY | O_CLOEXEC);
+    int target_ns = openat(h->dir_fd, "ns/net", O_RDONLY | O_CLOEXEC);
+    int fd = -1;
+    if (self_ns >= 0 && target_ns >= 0 && setns(target_ns, CLONE_NEWNET) == 0) {
+        fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+        if (setns(self_ns, CLONE_NEWNET) != 0) {
+            fprintf(stderr, "Erro ao voltar ao namespace de rede original: %s\n", strerror(errno));
+        }
+    }
+    if (self_ns >= 0) close(self_ns);
+    if (target_ns >= 0) close(target_ns);
+    return fd;
+}
+
+// Soma um socket do processo encontrado no dump. Os contadores do TCP_INFO
+// ficam na entrada; o total sai em proc_sockets_collect.
+static void account(ProcSocketEntry *e, SockKind kind, const struct nlmsghdr *nlh, NetUsage *out) {
+    const struct inet_diag_msg *msg = NLMSG_DATA(nlh);
+    if (e->kind == SOCK_KIND_UNKNOWN) e->kind = (uint8_t)kind;
+    e->seen = true;
+
+    bool tcp = (kind == SOCK_KIND_TCP4 || kind == SOCK_KIND_TCP6);
+    if (tcp) out->tcp_sockets++;
+    else out->udp_sockets++;
+    if (!tcp || msg->idiag_state != TCP_STATE_LISTEN) {
+        out->rx_queue += msg->idiag_rqueue;
+        out->tx_queue += msg->idiag_wqueue;
+    }
+    if (!tcp) return;
+
+    int len = (int)nlh->nlmsg_len - (int)NLMSG_LENGTH(sizeof(*msg));
+    for (const struct rtattr *attr = (const struct rtattr *)(msg + 1); RTA_OK(attr, len);
+         attr = RTA_NEXT(attr, len)) {
+        if (attr->rta_type != INET_DIAG_INFO) continue;
+        // struct tcp_info cresce a cada versão do kernel: copia o trecho comum
+        struct tcp_info ti;
+        size_t size = RTA_PAYLOAD(attr);
+        memset(&ti, 0, sizeof(ti));
+        memcpy(&ti, RTA_DATA(attr), size < sizeof(ti) ? size : sizeof(ti));
+        e->bytes_received = ti.tcpi_bytes_received;
+        e->bytes_sent = (size >= offsetof(struct tcp_info, tcpi_bytes_sent) + sizeof(ti.tcpi_bytes_sent))
+                        ? ti.tcpi_bytes_sent : ti.tcpi_bytes_acked;
+        e->segs_in = ti.tcpi_segs_in;
+        e->segs_out = ti.tcpi_segs_out;
+    }
+}
+
+// Um dump de inet_diag (uma família e um protocolo), casando cada socket
+// com a lista do processo
+static bool dump(ProcSockets *ps, SockKind kind, NetUsage *out) {
+    struct {
+        struct nlmsghdr nlh;
+        struct inet_diag_req_v2 req;
+    } request;
+    memset(&request, 0, sizeof(request));
+    bool tcp = (kind == SOCK_KIND_TCP4 || kind == SOCK_KIND_TCP6);
+    request.nlh.nlmsg_len = sizeof(request);
+    request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.nlh.nlmsg_seq = ++ps->seq;
+    request.req.sdiag_family = (kind == SOCK_KIND_TCP4 || kind == SOCK_KIND_UDP4) ? AF_INET : AF_INET6;
+    request.req.sdiag_protocol = tcp ? IPPROTO_TCP : IPPROTO_UDP;
+    request.req.idiag_states = ~0U;
+    request.req.idiag_ext = tcp ? (1 << (INET_DIAG_INFO - 1)) : 0;
+
+    if (send(ps->diag_fd, &request, sizeof(request), 0) < 0) return false;
+    ps->dumps++;
+
+    for (;;) {
+        ssize_t n = recv(ps->diag_fd, ps->buf, DIAG_BUF_SIZE, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false;
+        int len = (int)n;
+        for (const struct nlmsghdr *nlh = (const struct nlmsghdr *)ps->buf; NLMSG_OK(nlh, len);
+             nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_seq != ps->seq) continue;
+            if (nlh->nlmsg_type == NLMSG_DONE) return true;
+            if (nlh->nlmsg_type == NLMSG_ERROR) {
+                // Protocolo sem suporte a diag (ex.: módulo udp_diag ausente)
+                const struct nlmsgerr *err = NLMSG_DATA(nlh);
+                return err->error == -ENOENT;
+            }
+            if (nlh->nlmsg_type != SOCK_DIAG_BY_FAMILY) continue;
+            const struct inet_diag_msg *msg = NLMSG_DATA(nlh);
+            if (msg->idiag_inode == 0) continue;    // TIME_WAIT / SYN_RECV
+            ProcSocketEntry *e = find_entry(ps, msg->idiag_inode);
+            if (e) account(e, kind, nlh, out);
+        }
+    }
+}
+
+bool proc_sockets_collect(ProcSockets *ps, ProcHandle *h, NetUsage *out) {
+    memset(out, 0, sizeof(NetUsage));
+    ps->relisted = false;
+    ps->dumps = 0;
+    if (!proc_handle_valid(h)) return false;
+
+    // Sem permissão sobre o processo (ptrace) fd/ não pode ser lido
+    struct stat st;
+    if (fstatat(h->dir_fd, "fd", &st, 0) < 0) return false;
+
+    // O processo trocou de namespace de rede (setns/unshare): o socket de
+    // diag continua preso ao antigo. Reabre no novo e relista os sockets.
+    struct stat ns_st;
+    if (ps->diag_fd >= 0 && fstatat(h->dir_fd, "ns/net", &ns_st, 0) == 0 && ns_st.st_ino != ps->netns) {
+        close(ps->diag_fd);
+        ps->diag_fd = -1;
+        ps->stale = true;
+    }
+    if (ps->stale || ps->fd_count < 0 || !ps->count_supported || (long)st.st_size != ps->fd_count) {
+        if (!relist(ps, h, (long)st.st_size)) return false;
+    }
+    if (ps->count == 0) return true;
+
+    if (ps->diag_fd < 0) {
+        ps->diag_fd = open_diag_socket(h, &ps->netns);
+        if (ps->diag_fd < 0) return false;
+    }
+    if (!ps->buf && !(ps->buf = malloc(DIAG_BUF_SIZE))) return false;
+
+    // Sockets não classificados exigem todos os dumps; depois, só os tipos presentes
+    bool wanted[SOCK_KIND_COUNT] = { false };
+    bool all = false;
+    for (size_t i = 0; i < ps->count; i++) {
+        ps->entries[i].seen = false;
+        if (ps->entries[i].kind == SOCK_KIND_UNKNOWN) all = true;
+        wanted[ps->entries[i].kind] = true;
+    }
+    for (int k = SOCK_KIND_TCP4; k < SOCK_KIND_COUNT; k++) {
+        if ((all || wanted[k]) && !dump(ps, (SockKind)k, out)) return false;
+    }
+
+    out->bytes_received = ps->retired.bytes_received;
+    out->bytes_sent = ps->retired.bytes_sent;
+    out->segs_in = ps->retired.segs_in;
+    out->segs_out = ps->retired.segs_out;
+    for (size_t i = 0; i < ps->count; i++) {
+        ProcSocketEntry *e = &ps->entries[i];
+        if (!e->seen) {
+            retire(ps, e);
+            if (e->kind == SOCK_KIND_UNKNOWN) {
+                e->kind = SOCK_KIND_OTHER;
+            } else if (e->kind != SOCK_KIND_OTHER) {
+                // Socket inet fechado: outro fd pode ter ocupado o lugar
+                ps->stale = true;
+            }
+        }
+        out->bytes_received += e->bytes_received;
+        out->bytes_sent += e->bytes_sent;
+        out->segs_in += e->segs_in;
+        out->segs_out += e->segs_out;
+    }
+    return true;
+}
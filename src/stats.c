@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "../include/stats.h"
+#include "../include/serializer.h"
+
+// ---------- Welford ----------
+
+void running_stats_init(RunningStats *s) {
+    memset(s, 0, sizeof(RunningStats));
+}
+
+void running_stats_add(RunningStats *s, double x) {
+    s->count++;
+    if (s->count == 1) {
+        s->min = s->max = x;
+    } else {
+        if (x < s->min) s->min = x;
+        if (x > s->max) s->max = x;
+    }
+    double delta = x - s->mean;
+    s->mean += delta / (double)s->count;
+    s->m2 += delta * (x - s->mean);
+}
+
+// Combinação de Chan et al.: mesma média/variância de somar as amostras
+void running_stats_merge(RunningStats *dst, const RunningStats *src) {
+    if (src->count == 0) return;
+    if (dst->count == 0) {
+        *dst = *src;
+        return;
+    }
+    double n_a = (double)dst->count, n_b = (double)src->count, n = n_a + n_b;
+    double delta = src->mean - dst->mean;
+    dst->mean += delta * n_b / n;
+    dst->m2 += src->m2 + delta * delta * n_a * n_b / n;
+    dst->count += src->count;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+}
+
+double running_stats_variance(const RunningStats *s) {
+    return (s->count > 1) ? s->m2 / (double)(s->count - 1) : 0.0;
+}
+
+double running_stats_stddev(const RunningStats *s) {
+    return sqrt(running_stats_variance(s));
+}
+
+// ---------- Média exponencial ----------
+
+void ewma_init(Ewma *e, uint64_t half_life_ns) {
+    e->value = 0.0;
+    e->half_life_ns = half_life_ns;
+    e->primed = false;
+}
+
+void ewma_add(Ewma *e, double x, uint64_t dt_ns) {
+    if (!e->primed) {
+        e->value = x;
+        e->primed = true;
+        return;
+    }
+    // Peso da nova amostra: 1 - 2^(-dt / meia-vida)
+    double alpha = 1.0 - exp2(-(double)dt_ns / (double)e->half_life_ns);
+    e->value += alpha * (x - e->value);
+}
+
+// ---------- Máximo em janela deslizante ----------
+
+void window_max_init(WindowMax *w, int width) {
+    memset(w, 0, sizeof(WindowMax));
+    w->width = (width > WINDOW_MAX_LEN) ? WINDOW_MAX_LEN : width;
+}
+
+void window_max_add(WindowMax *w, double x) {
+    if (w->width <= 0) return;
+    uint64_t pos = w->pushed++;
+
+    // Primeiro o que sai da janela: com a janela cheia de candidatos
+    // (sequência decrescente) o novo valor ocuparia o lugar do head
+    while (w->count > 0 && w->pos[w->head] + (uint64_t)w->width <= pos) {
+        w->head = (w->head + 1) % WINDOW_MAX_LEN;
+        w->count--;
+    }
+    // Candidatos menores ou iguais nunca mais serão máximo
+    while (w->count > 0 && w->val[(w->head + w->count - 1) % WINDOW_MAX_LEN] <= x) w->count--;
+
+    int tail = (w->head + w->count) % WINDOW_MAX_LEN;
+    w->pos[tail] = pos;
+    w->val[tail] = x;
+    w->count++;
+}
+
+double window_max_get(const WindowMax *w) {
+    return (w->count > 0) ? w->val[w->head] : 0.0;
+}
+
+// ---------- DDSketch ----------
+
+#define DDSKETCH_GAMMA      ((1.0 + DDSKETCH_ALPHA) / (1.0 - DDSKETCH_ALPHA))
+#define DDSKETCH_LOG_GAMMA  log(DDSKETCH_GAMMA)
+
+// Índice logarítmico do menor valor representável (balde 0)
+static int ddsketch_min_index(void) {
+    return (int)ceil(log(DDSKETCH_MIN_VALUE) / DDSKETCH_LOG_GAMMA);
+}
+
+void ddsketch_init(DDSketch *d) {
+    memset(d, 0, sizeof(DDSketch));
+}
+
+void ddsketch_add(DDSketch *d, double x) {
+    d->count++;
+    if (!(x >= DDSKETCH_MIN_VALUE)) {     // inclui NaN
+        d->zero_count++;
+        return;
+    }
+    int bin = (int)ceil(log(x) / DDSKETCH_LOG_GAMMA) - ddsketch_min_index();
+    if (bin < 0) bin = 0;
+    if (bin >= DDSKETCH_BINS) bin = DDSKETCH_BINS - 1;
+    d->bins[bin]++;
+}
+
+void ddsketch_merge(DDSketch *dst, const DDSketch *src) {
+    dst->count += src->count;
+    dst->zero_count += src->zero_count;
+    for (int i = 0; i < DDSKETCH_BINS; i++) dst->bins[i] += src->bins[i];
+}
+
+double ddsketch_quantile(const DDSketch *d, double q) {
+    if (d->count == 0) return 0.0;
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+
+    // Posição (base 0) da amostra procurada entre as ordenadas
+    uint64_t rank = (uint64_t)(q * (double)(d->count - 1));
+    if (rank < d->zero_count) return 0.0;
+    uint64_t seen = d->zero_count;
+    for (int i = 0; i < DDSKETCH_BINS; i++) {
+        seen += d->bins[i];
+        if (seen > rank) {
+            // Ponto do balde (gamma^(k-1), gamma^k] com erro relativo <= alpha
+            double upper = pow(DDSKETCH_GAMMA, (double)(i + ddsketch_min_index()));
+            return 2.0 * upper / (DDSKETCH_GAMMA + 1.0);
+        }
+    }
+    return 0.0;
+}
+
+// ---------- Resumo por métrica ----------
+
+void metric_summary_init(MetricSummary *m, uint64_t half_life_ns) {
+    running_stats_init(&m->stats);
+    ewma_init(&m->ewma, half_life_ns);
+    ddsketch_init(&m->sketch);
+}
+
+void metric_summary_add(MetricSummary *m, double x, uint64_t dt_ns) {
+    running_stats_add(&m->stats, x);
+    ewma_add(&m->ewma, x, dt_ns);
+    ddsketch_add(&m->sketch, x);
+}
+
+// A média exponencial não se combina: fica a do destino (a mais recente)
+void metric_summary_merge(MetricSummary *dst, const MetricSummary *src) {
+    running_stats_merge(&dst->stats, &src->stats);
+    ddsketch_merge(&dst->sketch, &src->sketch);
+    if (!dst->ewma.primed) dst->ewma = src->ewma;
+}
+
+void metric_summary_get(const MetricSummary *m, SummaryStats *out) {
+    out->count = m->stats.count;
+    out->min = m->stats.min;
+    out->max = m->stats.max;
+    out->mean = m->stats.mean;
+    out->stddev = running_stats_stddev(&m->stats);
+    out->ewma = m->ewma.value;
+    // Os quantis aproximados ficam dentro de [min, max] exatos
+    double q[3] = {
+        ddsketch_quantile(&m->sketch, 0.50),
+        ddsketch_quantile(&m->sketch, 0.95),
+        ddsketch_quantile(&m->sketch, 0.99),
+    };
+    for (int i = 0; i < 3; i++) {
+        if (q[i] < out->min) q[i] = out->min;
+        if (q[i] > out->max) q[i] = out->max;
+    }
+    out->p50 = q[0];
+    out->p95 = q[1];
+    out->p99 = q[2];
+}
+
+// ---------- Conjunto do coletor ----------
+
+void metrics_summary_init(MetricsSummary *s) {
+    for (int i = 0; i < SUMMARY_COUNT; i++) {
+        metric_summary_init(&s->metrics[i], SUMMARY_EWMA_HALF_LIFE_NS);
+    }
+}
+
+void metrics_summary_add(MetricsSummary *s, double cpu_percent, double rss_bytes,
+                         double io_read_bps, double io_write_bps, uint64_t dt_ns) {
+    metric_summary_add(&s->metrics[SUMMARY_CPU_PERCENT], cpu_percent, dt_ns);
+    metric_summary_add(&s->metrics[SUMMARY_RSS_BYTES], rss_bytes, dt_ns);
+    metric_summary_add(&s->metrics[SUMMARY_IO_READ_BPS], io_read_bps, dt_ns);
+    metric_summary_add(&s->metrics[SUMMARY_IO_WRITE_BPS], io_write_bps, dt_ns);
+}
+
+const char *summary_metric_name(SummaryMetric id) {
+    switch (id) {
+        case SUMMARY_CPU_PERCENT:  return "cpu_percent";
+        case SUMMARY_RSS_BYTES:    return "memory_rss_bytes";
+        case SUMMARY_IO_READ_BPS:  return "io_read_bps";
+        case SUMMARY_IO_WRITE_BPS: return "io_write_bps";
+        default:                   return "?";
+    }
+}
+
+void summary_stats_print(const SummaryStats *stats) {
+    static const struct { const char *label; double scale; } rows[SUMMARY_COUNT] = {
+        [SUMMARY_CPU_PERCENT]  = { "CPU%", 1.0 },
+        [SUMMARY_RSS_BYTES]    = { "Mem(MB)", 1024.0 * 1024.0 },
+        [SUMMARY_IO_READ_BPS]  = { "IO R(KB/s)", 1024.0 },
+        [SUMMARY_IO_WRITE_BPS] = { "IO W(KB/s)", 1024.0 },
+    };
+    if (stats[SUMMARY_CPU_PERCENT].count == 0) return;
+
+    printf("\n=== Resumo (%llu amostras, quantis com erro <= %.0f%%) ===\n",
+           (unsigned long long)stats[SUMMARY_CPU_PERCENT].count, DDSKETCH_ALPHA * 100);
+    printf("%-10s | %10s | %10s | %10s | %10s | %10s | %10s | %10s | %10s\n",
+           "", "Min", "Media", "DesvPad", "EWMA", "p50", "p95", "p99", "Max");
+    for (int i = 0; i < SUMMARY_COUNT; i++) {
+        const SummaryStats *st = &stats[i];
+        double k = rows[i].scale;
+        printf("%-10s | %10.2f | %10.2f | %10.2f | %10.2f | %10.2f | %10.2f | %10.2f | %10.2f\n",
+               rows[i].label, st->min / k, st->mean / k, st->stddev / k, st->ewma / k,
+               st->p50 / k, st->p95 / k, st->p99 / k, st->max / k);
+    }
+}
+
+void metrics_summary_print(const MetricsSummary *s) {
+    SummaryStats stats[SUMMARY_COUNT];
+    for (int i = 0; i < SUMMARY_COUNT; i++) metric_summary_get(&s->metrics[i], &stats[i]);
+    summary_stats_print(stats);
+}
+
+bool metrics_summary_export_json(const MetricsSummary *s, int pid, const char *path) {
+    OutBuf o;
+    if (!out_open(&o, path)) {
+        fprintf(stderr, "Erro ao criar '%s'\n", path);
+        return false;
+    }
+    out_lit(&o, "{\n  \"pid\": ");
+    out_i64(&o, pid);
+    out_lit(&o, ",\n  \"ewma_half_life_ns\": ");
+    out_u64(&o, SUMMARY_EWMA_HALF_LIFE_NS);
+    out_lit(&o, ",\n  \"quantile_relative_error\": ");
+    out_fixed(&o, DDSKETCH_ALPHA, 3);
+    out_lit(&o, ",\n  \"metrics\": {");
+    for (int i = 0; i < SUMMARY_COUNT; i++) {
+        SummaryStats st;
+        metric_summary_get(&s->metrics[i], &st);
+        if (i > 0) out_char(&o, ',');
+        out_lit(&o, "\n    ");
+        out_json_str(&o, summary_metric_name((SummaryMetric)i));
+        out_lit(&o, ": {\"count\": ");
+        out_u64(&o, st.count);
+        static const char *keys[] = { "min", "max", "mean", "stddev", "ewma", "p50", "p95", "p99" };
+        double values[] = { st.min, st.max, st.mean, st.stddev, st.ewma, st.p50, st.p95, st.p99 };
+        for (int k = 0; k < 8; k++) {
+            out_lit(&o, ", \"");
+            out_write(&o, keys[k], strlen(keys[k]));
+            out_lit(&o, "\": ");
+            out_fixed(&o, values[k], 2);
+        }
+        out_char(&o, '}');
+    }
+    out_lit(&o, "\n  }\n}\n");
+    return out_close(&o);
+}
@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "../include/stream_export.h"
+#include "../include/process_monitor.h"
+#include "../include/monitor.h"
+#include "../include/utils.h"
+#include "../include/timing.h"
+
+bool export_format_parse(const char *name, ExportFormat *format) {
+    if (strcmp(name, "json") == 0) {
+        *format = EXPORT_JSON;
+    } else if (strcmp(name, "ndjson") == 0) {
+        *format = EXPORT_NDJSON;
+    } else if (strcmp(name, "csv") == 0) {
+        *format = EXPORT_CSV;
+    } else if (strcmp(name, "bin") == 0) {
+        *format = EXPORT_BIN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *export_format_extension(ExportFormat format) {
+    switch (format) {
+        case EXPORT_JSON:   return ".json";
+        case EXPORT_NDJSON: return ".ndjson";
+        case EXPORT_CSV:    return ".csv";
+        case EXPORT_BIN:    return TSDB_EXTENSION;
+    }
+    return "";
+}
+
+// ---------- Formatos (executados na thread escritora) ----------
+
+// Cabeçalho do documento JSON de ProcessMetrics: depende da primeira amostra
+static void write_process_json_header(OutBuf *o, const ProcessMetrics *first) {
+    out_lit(o, "{\n  \"monitoring_session\": {\n    \"pid\": ");
+    out_i64(o, first ? first->pid : 0);
+    out_lit(o, ",\n    \"process_name\": ");
+    out_json_str(o, first ? first->process_name : "");
+    out_lit(o, ",\n    \"start_time\": ");
+    out_i64(o, first ? first->timestamp : (long)time(NULL));
+    out_lit(o, "\n  },\n  \"samples\": [\n");
+}
+
+static bool write_header(StreamExporter *e) {
+    if (e->format == EXPORT_BIN) return true;
+
+    if (e->format == EXPORT_CSV) {
+        if (e->record == STREAM_PROCESS_METRICS) {
+            write_metrics_csv_header(&e->out);
+        } else {
+            write_resource_csv_header(&e->out);
+        }
+    } else if (e->format == EXPORT_JSON && e->record == STREAM_RESOURCE_DATA) {
+        out_lit(&e->out, "[\n");
+    }
+    return out_flush(&e->out);
+}
+
+static bool write_records(StreamExporter *e, const unsigned char *records, size_t n) {
+    if (e->format == EXPORT_BIN) {
+        for (size_t i = 0; i < n; i++) {
+            if (!tsdb_writer_append(&e->tsdb, (const ProcessMetrics *)(records + i * e->elem_size))) {
+                return false;
+            }
+        }
+        return fflush(e->tsdb.fp) == 0;
+    }
+
+    OutBuf *o = &e->out;
+    for (size_t i = 0; i < n; i++) {
+        const void *rec = records + i * e->elem_size;
+        bool first = (e->written + i == 0);
+
+        if (e->record == STREAM_PROCESS_METRICS) {
+            const ProcessMetrics *m = rec;
+            switch (e->format) {
+                case EXPORT_JSON:
+                    if (first) write_process_json_header(o, m);
+                    if (!first) out_lit(o, ",\n");
+                    write_metrics_json_sample(o, m, false);
+                    break;
+                case EXPORT_NDJSON:
+                    write_metrics_ndjson_row(o, m);
+                    break;
+                default:
+                    write_metrics_csv_row(o, m);
+                    break;
+            }
+        } else {
+            const ResourceData *d = rec;
+            switch (e->format) {
+                case EXPORT_JSON:
+                    if (!first) out_lit(o, ",\n");
+                    write_resource_json(o, d, false);
+                    break;
+                case EXPORT_NDJSON:
+                    write_resource_json(o, d, true);
+                    out_char(o, '\n');
+                    break;
+                default:
+                    write_resource_csv_row(o, d);
+                    break;
+            }
+        }
+    }
+
+    // Lote inteiro entregue ao kernel (um write): sobrevive a um SIGKILL do monitor
+    return out_flush(o);
+}
+
+static bool write_trailer(StreamExporter *e) {
+    if (e->format == EXPORT_BIN) return true;
+
+    if (e->format == EXPORT_JSON) {
+        if (e->record == STREAM_PROCESS_METRICS) {
+            if (e->written == 0) write_process_json_header(&e->out, NULL);
+            out_lit(&e->out, "\n  ],\n  \"sample_count\": ");
+            out_u64(&e->out, e->written);
+            out_lit(&e->out, "\n}\n");
+        } else {
+            out_lit(&e->out, "\n]\n");
+        }
+    }
+    return out_flush(&e->out);
+}
+
+// ---------- Thread escritora ----------
+
+static void deadline_after(struct timespec *ts, uint64_t ns) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    uint64_t t = (uint64_t)ts->tv_nsec + ns;
+    ts->tv_sec += (time_t)(t / NSEC_PER_SEC);
+    ts->tv_nsec = (long)(t % NSEC_PER_SEC);
+}
+
+static void *writer_main(void *arg) {
+    StreamExporter *e = arg;
+
+    pthread_mutex_lock(&e->lock);
+    for (;;) {
+        struct timespec deadline;
+        deadline_after(&deadline, STREAM_FLUSH_NS);
+        while (!e->stop && e->front_count < STREAM_BATCH_SAMPLES) {
+            if (pthread_cond_timedwait(&e->wake, &e->lock, &deadline) == ETIMEDOUT) break;
+        }
+
+        // Troca os buffers: o produtor continua enchendo o outro
+        unsigned char *batch = e->front;
+        size_t batch_cap = e->front_cap;
+        size_t n = e->front_count;
+        e->front = e->back;
+        e->front_cap = e->back_cap;
+        e->front_count = 0;
+        e->back = batch;
+        e->back_cap = batch_cap;
+        bool stop = e->stop;
+        pthread_mutex_unlock(&e->lock);
+
+        size_t lost = 0;
+        if (n > 0 && !e->failed) {
+            if (write_records(e, batch, n)) {
+                e->written += n;
+                e->batches++;
+            } else {
+                fprintf(stderr, "Erro ao gravar exportação: %s\n", strerror(errno));
+                e->failed = true;
+            }
+        }
+        if (e->failed) lost = n;
+
+        if (e->format == EXPORT_BIN && !e->failed) {
+            uint64_t now = monotonic_ns();
+            if (now - e->last_block_flush_ns >= STREAM_BLOCK_FLUSH_NS) {
+                e->failed = !tsdb_writer_flush(&e->tsdb);
+                e->last_block_flush_ns = now;
+            }
+        }
+
+        pthread_mutex_lock(&e->lock);
+        e->dropped += lost;
+        if (stop && e->front_count == 0) break;
+    }
+    pthread_mutex_unlock(&e->lock);
+    return NULL;
+}
+
+// ---------- API ----------
+
+bool stream_export_open(StreamExporter *e, const char *path, StreamRecord record, ExportFormat format) {
+    memset(e, 0, sizeof(StreamExporter));
+    e->record = record;
+    e->format = format;
+    e->elem_size = (record == STREAM_PROCESS_METRICS) ? sizeof(ProcessMetrics) : sizeof(ResourceData);
+
+    if (format == EXPORT_BIN) {
+        if (record != STREAM_PROCESS_METRICS) {
+            fprintf(stderr, "Formato binário disponível apenas para métricas de processo\n");
+            return false;
+        }
+        if (!tsdb_writer_open(&e->tsdb, path)) return false;
+    } else {
+        if (!out_open(&e->out, path)) {
+            fprintf(stderr, "Erro ao criar arquivo de exportação %s: %s\n", path, strerror(errno));
+            return false;
+        }
+    }
+
+    e->front_cap = e->back_cap = STREAM_BATCH_SAMPLES * 2;
+    e->front = malloc(e->front_cap * e->elem_size);
+    e->back = malloc(e->back_cap * e->elem_size);
+    e->last_block_flush_ns = monotonic_ns();
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    bool ok = e->front && e->back && write_header(e) &&
+              pthread_mutex_init(&e->lock, NULL) == 0;
+    if (ok && pthread_cond_init(&e->wake, &attr) != 0) {
+        pthread_mutex_destroy(&e->lock);
+        ok = false;
+    }
+    pthread_condattr_destroy(&attr);
+
+    if (ok && pthread_create(&e->thread, NULL, writer_main, e) != 0) {
+        fprintf(stderr, "Erro ao criar thread de exportação\n");
+        pthread_cond_destroy(&e->wake);
+        pthread_mutex_destroy(&e->lock);
+        ok = false;
+    }
+
+    if (!ok) {
+        if (format == EXPORT_BIN) {
+            tsdb_writer_close(&e->tsdb);
+        } else {
+            out_close(&e->out);
+        }
+        free(e->front);
+        free(e->back);
+        memset(e, 0, sizeof(StreamExporter));
+        return false;
+    }
+    return true;
+}
+
+bool stream_export_append(StreamExporter *e, const void *sample) {
+    pthread_mutex_lock(&e->lock);
+
+    if (e->front_count == e->front_cap) {
+        // Escritora atrasada: cresce o buffer em vez de esperar pelo disco
+        size_t cap = e->front_cap * 2;
+        unsigned char *front = (cap <= STREAM_MAX_PENDING) ? realloc(e->front, cap * e->elem_size) : NULL;
+        if (!front) {
+            e->dropped++;
+            pthread_mutex_unlock(&e->lock);
+            return false;
+        }
+        e->front = front;
+        e->front_cap = cap;
+    }
+
+    memcpy(e->front + e->front_count * e->elem_size, sample, e->elem_size);
+    e->front_count++;
+    e->appended++;
+    if (e->front_count == STREAM_BATCH_SAMPLES) {
+        pthread_cond_signal(&e->wake);
+    }
+
+    pthread_mutex_unlock(&e->lock);
+    return true;
+}
+
+bool stream_export_close(StreamExporter *e) {
+    pthread_mutex_lock(&e->lock);
+    e->stop = true;
+    pthread_cond_signal(&e->wake);
+    pthread_mutex_unlock(&e->lock);
+    pthread_join(e->thread, NULL);
+
+    bool ok = !e->failed;
+    if (e->format == EXPORT_BIN) {
+        ok &= tsdb_writer_close(&e->tsdb);
+    } else {
+        ok &= write_trailer(e);
+        ok &= out_close(&e->out);
+    }
+
+    pthread_cond_destroy(&e->wake);
+    pthread_mutex_destroy(&e->lock);
+    free(e->front);
+    free(e->back);
+    e->front = e->back = NULL;
+    return ok;
+}
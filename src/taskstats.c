@@ -0,0 +1,337 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/taskstats.h>
+#include "../include/taskstats.h"
+
+#define TASKSTATS_WINDOW 64         // requisições em voo por janela do lote
+#define RECV_SLOT_SIZE 2048         // uma mensagem (término traz tarefa e processo)
+#define SOCKET_RCVBUF (1 << 20)
+#define REQUEST_MAX 64              // cabeçalhos + um atributo pequeno
+
+// Monta uma requisição genetlink com um único atributo em dst e retorna
+// o tamanho alinhado (requisições podem ser concatenadas num só send)
+static size_t genl_build(void *dst, uint16_t type, uint16_t flags, uint8_t cmd, uint32_t seq,
+                         uint16_t attr, const void *data, size_t len) {
+    size_t total = NLMSG_LENGTH(GENL_HDRLEN) + NLA_ALIGN(NLA_HDRLEN + len);
+    memset(dst, 0, total);
+
+    struct nlmsghdr *n = dst;
+    n->nlmsg_len = (uint32_t)total;
+    n->nlmsg_type = type;
+    n->nlmsg_flags = NLM_F_REQUEST | flags;
+    n->nlmsg_seq = seq;
+
+    struct genlmsghdr *g = NLMSG_DATA(n);
+    g->cmd = cmd;
+    g->version = 1;             // controlador e TASKSTATS_GENL_VERSION
+
+    struct nlattr *na = (struct nlattr *)((char *)g + GENL_HDRLEN);
+    na->nla_type = attr;
+    na->nla_len = (uint16_t)(NLA_HDRLEN + len);
+    memcpy((char *)na + NLA_HDRLEN, data, len);
+    return NLMSG_ALIGN(total);
+}
+
+// Iteração sobre atributos (len é o restante do bloco, em bytes)
+static bool attr_ok(const struct nlattr *na, int len) {
+    return len >= NLA_HDRLEN && na->nla_len >= NLA_HDRLEN && na->nla_len <= len;
+}
+
+static const struct nlattr *attr_next(const struct nlattr *na, int *len) {
+    *len -= NLA_ALIGN(na->nla_len);
+    return (const struct nlattr *)((const char *)na + NLA_ALIGN(na->nla_len));
+}
+
+static const void *attr_data(const struct nlattr *na) {
+    return (const char *)na + NLA_HDRLEN;
+}
+
+static const struct nlattr *genl_attrs(const struct nlmsghdr *h, int *len) {
+    *len = (int)h->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN);
+    return (const struct nlattr *)((const char *)NLMSG_DATA(h) + GENL_HDRLEN);
+}
+
+// Converte a struct taskstats do kernel. A versão do kernel pode ser mais
+// nova ou mais antiga que a dos headers: copia só o trecho em comum.
+static void copy_stats(TaskStats *out, const void *data, size_t len) {
+    struct taskstats ts;
+    memset(&ts, 0, sizeof(ts));
+    memcpy(&ts, data, len < sizeof(ts) ? len : sizeof(ts));
+
+    memcpy(out->comm, ts.ac_comm, sizeof(out->comm));
+    out->comm[sizeof(out->comm) - 1] = '\0';
+    out->exitcode = ts.ac_exitcode;
+
+    out->cpu_user_us = ts.ac_utime;
+    out->cpu_system_us = ts.ac_stime;
+    out->cpu_run_real_ns = ts.cpu_run_real_total;
+    out->voluntary_ctx_switches = ts.nvcsw;
+    out->nonvoluntary_ctx_switches = ts.nivcsw;
+
+    out->minor_faults = ts.ac_minflt;
+    out->major_faults = ts.ac_majflt;
+    out->hiwater_rss_kb = ts.hiwater_rss;
+
+    out->read_chars = ts.read_char;
+    out->write_chars = ts.write_char;
+    out->read_syscalls = ts.read_syscalls;
+    out->write_syscalls = ts.write_syscalls;
+    out->read_bytes = ts.read_bytes;
+    out->write_bytes = ts.write_bytes;
+    out->cancelled_write_bytes = ts.cancelled_write_bytes;
+
+    out->cpu_delay_count = ts.cpu_count;
+    out->cpu_delay_ns = ts.cpu_delay_total;
+    out->blkio_delay_count = ts.blkio_count;
+    out->blkio_delay_ns = ts.blkio_delay_total;
+    out->swapin_delay_count = ts.swapin_count;
+    out->swapin_delay_ns = ts.swapin_delay_total;
+    out->freepages_delay_count = ts.freepages_count;
+    out->freepages_delay_ns = ts.freepages_delay_total;
+    out->thrashing_delay_count = ts.thrashing_count;
+    out->thrashing_delay_ns = ts.thrashing_delay_total;
+}
+
+// Extrai as estatísticas de uma resposta ou notificação TASKSTATS_CMD_NEW.
+// Notificações da última thread de um processo trazem a tarefa e o total
+// do processo: o total tem precedência.
+static bool parse_reply(const struct nlmsghdr *h, TaskStats *out) {
+    int len;
+    bool found = false;
+    for (const struct nlattr *na = genl_attrs(h, &len); attr_ok(na, len); na = attr_next(na, &len)) {
+        bool tgid = (na->nla_type == TASKSTATS_TYPE_AGGR_TGID);
+        if (!tgid && na->nla_type != TASKSTATS_TYPE_AGGR_PID) continue;
+        if (found && !tgid) continue;
+
+        int nlen = na->nla_len - NLA_HDRLEN;
+        int id = 0;
+        bool has_stats = false;
+        TaskStats parsed;
+        memset(&parsed, 0, sizeof(parsed));
+        for (const struct nlattr *nested = attr_data(na); attr_ok(nested, nlen); nested = attr_next(nested, &nlen)) {
+            if (nested->nla_type == TASKSTATS_TYPE_PID || nested->nla_type == TASKSTATS_TYPE_TGID) {
+                if (nested->nla_len >= NLA_HDRLEN + sizeof(uint32_t)) {
+                    id = (int)*(const uint32_t *)attr_data(nested);
+                }
+            } else if (nested->nla_type == TASKSTATS_TYPE_STATS) {
+                copy_stats(&parsed, attr_data(nested), nested->nla_len - NLA_HDRLEN);
+                has_stats = true;
+            }
+        }
+        if (!has_stats) continue;
+        parsed.pid = id;
+        parsed.tgid_scope = tgid;
+        *out = parsed;
+        found = true;
+    }
+    return found;
+}
+
+// Recebe a resposta de uma requisição de controle (resolução de família,
+// inscrição). Retorna 0 ou -errno.
+static int recv_reply(TaskstatsClient *c, uint32_t seq, struct nlmsghdr **reply) {
+    for (;;) {
+        ssize_t n = recv(c->fd, c->buf, RECV_SLOT_SIZE, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        struct nlmsghdr *h = (struct nlmsghdr *)c->buf;
+        if (!NLMSG_OK(h, (size_t)n) || h->nlmsg_seq != seq) continue;
+        if (h->nlmsg_type == NLMSG_ERROR) {
+            const struct nlmsgerr *err = NLMSG_DATA(h);
+            if (err->error != 0) return err->error;
+        }
+        if (reply) *reply = h;
+        return 0;
+    }
+}
+
+static bool resolve_family(TaskstatsClient *c) {
+    char req[REQUEST_MAX];
+    uint32_t seq = ++c->seq;
+    size_t len = genl_build(req, GENL_ID_CTRL, 0, CTRL_CMD_GETFAMILY, seq, CTRL_ATTR_FAMILY_NAME,
+                            TASKSTATS_GENL_NAME, sizeof(TASKSTATS_GENL_NAME));
+    if (send(c->fd, req, len, 0) < 0) return false;
+
+    struct nlmsghdr *h = NULL;
+    if (recv_reply(c, seq, &h) != 0 || h->nlmsg_type != GENL_ID_CTRL) return false;
+
+    int alen;
+    for (const struct nlattr *na = genl_attrs(h, &alen); attr_ok(na, alen); na = attr_next(na, &alen)) {
+        if (na->nla_type == CTRL_ATTR_FAMILY_ID) {
+            c->family_id = *(const uint16_t *)attr_data(na);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool taskstats_open(TaskstatsClient *c) {
+    memset(c, 0, sizeof(TaskstatsClient));
+    c->fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (c->fd < 0) {
+        fprintf(stderr, "Erro ao criar socket netlink: %s\n", strerror(errno));
+        return false;
+    }
+    c->buf = malloc((size_t)TASKSTATS_WINDOW * RECV_SLOT_SIZE);
+    if (!c->buf) {
+        taskstats_close(c);
+        return false;
+    }
+
+    // Um lote inteiro de respostas precisa caber no buffer do socket;
+    // o timeout evita esperar para sempre por uma resposta perdida
+    int rcvbuf = SOCKET_RCVBUF;
+    setsockopt(c->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    setsockopt(c->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+    if (bind(c->fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "Erro ao associar socket netlink: %s\n", strerror(errno));
+        taskstats_close(c);
+        return false;
+    }
+    if (!resolve_family(c)) {
+        fprintf(stderr, "Interface TASKSTATS indisponível (kernel sem CONFIG_TASKSTATS "
+                        "ou fora do namespace de rede inicial)\n");
+        taskstats_close(c);
+        return false;
+    }
+    return true;
+}
+
+static void send_cpumask(TaskstatsClient *c, uint16_t attr, uint16_t flags, uint32_t seq) {
+    char req[REQUEST_MAX];
+    size_t len = genl_build(req, c->family_id, flags, TASKSTATS_CMD_GET, seq, attr,
+                            c->cpumask, strlen(c->cpumask) + 1);
+    if (send(c->fd, req, len, 0) < 0) {
+        fprintf(stderr, "Erro ao enviar máscara de CPUs ao TASKSTATS: %s\n", strerror(errno));
+    }
+}
+
+void taskstats_close(TaskstatsClient *c) {
+    if (c->fd >= 0 && c->listening) {
+        send_cpumask(c, TASKSTATS_CMD_ATTR_DEREGISTER_CPUMASK, 0, ++c->seq);
+    }
+    if (c->fd >= 0) close(c->fd);
+    free(c->buf);
+    memset(c, 0, sizeof(TaskstatsClient));
+    c->fd = -1;
+}
+
+int taskstats_query_batch(TaskstatsClient *c, TaskstatsQuery *q, size_t n) {
+    char req[TASKSTATS_WINDOW * REQUEST_MAX];
+    struct mmsghdr msgs[TASKSTATS_WINDOW];
+    struct iovec iov[TASKSTATS_WINDOW];
+    int answered = 0;
+
+    for (size_t base = 0; base < n; base += TASKSTATS_WINDOW) {
+        size_t count = n - base;
+        if (count > TASKSTATS_WINDOW) count = TASKSTATS_WINDOW;
+
+        // Todas as requisições da janela num único send
+        uint32_t first_seq = c->seq + 1;
+        size_t len = 0;
+        for (size_t i = 0; i < count; i++) {
+            TaskstatsQuery *e = &q[base + i];
+            uint32_t pid = (uint32_t)e->pid;
+            e->ok = false;
+            len += genl_build(req + len, c->family_id, 0, TASKSTATS_CMD_GET, ++c->seq,
+                              e->tgid ? TASKSTATS_CMD_ATTR_TGID : TASKSTATS_CMD_ATTR_PID,
+                              &pid, sizeof(pid));
+        }
+        if (send(c->fd, req, len, 0) < 0) return -1;
+
+        // Cada requisição gera exatamente uma mensagem: a resposta ou um
+        // erro (ESRCH para processos que não existem mais)
+        size_t pending = count;
+        while (pending > 0) {
+            for (size_t k = 0; k < pending; k++) {
+                iov[k].iov_base = c->buf + k * RECV_SLOT_SIZE;
+                iov[k].iov_len = RECV_SLOT_SIZE;
+                memset(&msgs[k], 0, sizeof(msgs[k]));
+                msgs[k].msg_hdr.msg_iov = &iov[k];
+                msgs[k].msg_hdr.msg_iovlen = 1;
+            }
+            int got = recvmmsg(c->fd, msgs, (unsigned)pending, MSG_WAITFORONE, NULL);
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            for (int k = 0; k < got; k++) {
+                const struct nlmsghdr *h = (const struct nlmsghdr *)(c->buf + (size_t)k * RECV_SLOT_SIZE);
+                if (!NLMSG_OK(h, msgs[k].msg_len)) continue;
+                uint32_t idx = h->nlmsg_seq - first_seq;
+                if (idx >= count) continue;     // resposta atrasada de outro lote
+                pending--;
+                TaskstatsQuery *e = &q[base + idx];
+                if (h->nlmsg_type == c->family_id && parse_reply(h, &e->stats)) {
+                    e->ok = true;
+                    answered++;
+                }
+            }
+        }
+    }
+    return answered;
+}
+
+bool taskstats_query(TaskstatsClient *c, int pid, bool tgid, TaskStats *out) {
+    TaskstatsQuery q = { .pid = pid, .tgid = tgid };
+    if (taskstats_query_batch(c, &q, 1) != 1) return false;
+    *out = q.stats;
+    return true;
+}
+
+bool taskstats_subscribe_exits(TaskstatsClient *c) {
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (cpus < 1) cpus = 1;
+    snprintf(c->cpumask, sizeof(c->cpumask), "0-%ld", cpus - 1);
+
+    uint32_t seq = ++c->seq;
+    send_cpumask(c, TASKSTATS_CMD_ATTR_REGISTER_CPUMASK, NLM_F_ACK, seq);
+    int err = recv_reply(c, seq, NULL);
+    if (err != 0) {
+        fprintf(stderr, "Erro ao inscrever notificações de término: %s\n", strerror(-err));
+        return false;
+    }
+    c->listening = true;
+    return true;
+}
+
+int taskstats_read_exit(TaskstatsClient *c, TaskStats *out) {
+    for (;;) {
+        ssize_t n = recv(c->fd, c->buf, RECV_SLOT_SIZE, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            if (errno == EINTR) continue;
+            if (errno == ENOBUFS) {
+                // Mais términos do que o buffer comporta: alguns se perderam
+                c->dropped++;
+                continue;
+            }
+            return -1;
+        }
+        const struct nlmsghdr *h = (const struct nlmsghdr *)c->buf;
+        if (!NLMSG_OK(h, (size_t)n) || h->nlmsg_type != c->family_id) continue;
+        if (parse_reply(h, out)) return 1;
+    }
+}
+
+bool taskstats_delayacct_enabled(void) {
+    FILE *fp = fopen("/proc/sys/kernel/task_delayacct", "r");
+    if (!fp) return false;
+    int value = 0;
+    bool ok = fscanf(fp, "%d", &value) == 1;
+    fclose(fp);
+    return ok && value != 0;
+}
@@ -0,0 +1,206 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "../include/thread_table.h"
+#include "../include/proc_parse.h"
+#include "../include/timing.h"
+
+// status de uma thread passa de 1 KB; as linhas de troca de contexto
+// ficam no final, então o buffer precisa comportar o arquivo inteiro
+#define THREAD_BUF_SIZE 8192
+
+static void slot_close(ThreadSlot *s) {
+    if (s->stat_fd >= 0) close(s->stat_fd);
+    if (s->status_fd >= 0) close(s->status_fd);
+    s->stat_fd = -1;
+    s->status_fd = -1;
+}
+
+bool thread_table_open(ThreadTable *t, int pid) {
+    memset(t, 0, sizeof(ThreadTable));
+    t->pid = pid;
+    t->ticks_per_second = sysconf(_SC_CLK_TCK);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    t->task_dir = opendir(path);
+    return t->task_dir != NULL;
+}
+
+void thread_table_close(ThreadTable *t) {
+    for (size_t i = 0; i < t->count; i++) slot_close(&t->threads[i]);
+    free(t->threads);
+    if (t->task_dir) closedir(t->task_dir);
+    memset(t, 0, sizeof(ThreadTable));
+}
+
+static int compare_tid(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Relê task/ e reconcilia com a tabela (ambas ordenadas por TID): threads
+// que continuam mantêm descritores e leitura anterior, as que sumiram são
+// fechadas e as novas entram sem descritores (abertos na primeira leitura)
+static bool relist(ThreadTable *t) {
+    size_t cap = t->count + 16, n = 0;
+    int *tids = malloc(cap * sizeof(int));
+    if (!tids) return false;
+
+    rewinddir(t->task_dir);
+    struct dirent *entry;
+    while ((entry = readdir(t->task_dir)) != NULL) {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9') continue;
+        if (n == cap) {
+            int *new_tids = realloc(tids, cap * 2 * sizeof(int));
+            if (!new_tids) {
+                free(tids);
+                return false;
+            }
+            tids = new_tids;
+            cap *= 2;
+        }
+        tids[n++] = atoi(entry->d_name);
+    }
+    qsort(tids, n, sizeof(int), compare_tid);
+
+    ThreadSlot *slots = malloc((n ? n : 1) * sizeof(ThreadSlot));
+    if (!slots) {
+        free(tids);
+        return false;
+    }
+
+    size_t old = 0;
+    for (size_t i = 0; i < n; i++) {
+        while (old < t->count && t->threads[old].cur.tid < tids[i]) {
+            slot_close(&t->threads[old++]);
+        }
+        if (old < t->count && t->threads[old].cur.tid == tids[i]) {
+            slots[i] = t->threads[old++];
+        } else {
+            memset(&slots[i], 0, sizeof(ThreadSlot));
+            slots[i].stat_fd = -1;
+            slots[i].status_fd = -1;
+            slots[i].cur.pid = t->pid;
+            slots[i].cur.tid = tids[i];
+        }
+    }
+    while (old < t->count) slot_close(&t->threads[old++]);
+
+    free(t->threads);
+    free(tids);
+    t->threads = slots;
+    t->count = n;
+    t->listed_threads = (long)n;
+    t->stale = false;
+    t->relisted = true;
+    return true;
+}
+
+static bool open_thread(ThreadTable *t, ThreadSlot *s) {
+    int dir_fd = dirfd(t->task_dir);
+    char path[32];
+    snprintf(path, sizeof(path), "%d/stat", s->cur.tid);
+    s->stat_fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+    snprintf(path, sizeof(path), "%d/status", s->cur.tid);
+    s->status_fd = openat(dir_fd, path, O_RDONLY | O_CLOEXEC);
+    if (s->stat_fd < 0 || s->status_fd < 0) {
+        int err = errno;
+        slot_close(s);
+        errno = err;
+        return false;
+    }
+    return true;
+}
+
+// Lê stat e status da thread e calcula as taxas contra a leitura anterior.
+// Retorna 1 se lida, 0 se ficou sem descritor (tenta de novo na próxima
+// amostra) e -1 se a thread terminou.
+static int read_thread(ThreadTable *t, ThreadSlot *s, uint64_t now) {
+    if (s->stat_fd < 0 && !open_thread(t, s)) {
+        return (errno == EMFILE || errno == ENFILE) ? 0 : -1;
+    }
+
+    char buf[THREAD_BUF_SIZE];
+    ProcStat st;
+    ssize_t n = pread(s->stat_fd, buf, sizeof(buf), 0);
+    if (n <= 0 || !proc_parse_stat(buf, (size_t)n, &st)) return -1;
+
+    ProcStatus status;
+    n = pread(s->status_fd, buf, sizeof(buf), 0);
+    if (n <= 0 || !proc_parse_status(buf, (size_t)n, &status)) return -1;
+
+    ThreadMetrics *m = &s->cur;
+    unsigned long prev_cpu = m->cpu_user_time + m->cpu_system_time;
+    long prev_ctx = m->voluntary_ctx_switches + m->nonvoluntary_ctx_switches;
+    uint64_t prev_ns = m->mono_ns;
+
+    m->mono_ns = now;
+    memcpy(m->name, st.comm, sizeof(m->name));
+    m->state = st.state;
+    m->processor = st.processor;
+    m->cpu_user_time = st.utime;
+    m->cpu_system_time = st.stime;
+    m->voluntary_ctx_switches = (long)status.voluntary_ctxt_switches;
+    m->nonvoluntary_ctx_switches = (long)status.nonvoluntary_ctxt_switches;
+
+    if (!s->has_prev) {
+        m->cpu_usage_percent = 0.0;
+        m->ctx_switch_rate = 0.0;
+    } else if (now > prev_ns) {
+        // Duas leituras no mesmo instante mantêm as taxas anteriores
+        double delta_sec = (double)(now - prev_ns) / NSEC_PER_SEC;
+        unsigned long cpu = m->cpu_user_time + m->cpu_system_time;
+        long ctx = m->voluntary_ctx_switches + m->nonvoluntary_ctx_switches;
+        m->cpu_usage_percent = (cpu >= prev_cpu)
+            ? 100.0 * ((double)(cpu - prev_cpu) / t->ticks_per_second) / delta_sec : 0.0;
+        m->ctx_switch_rate = (ctx >= prev_ctx) ? (double)(ctx - prev_ctx) / delta_sec : 0.0;
+    }
+    s->has_prev = true;
+    return 1;
+}
+
+bool thread_table_sample(ThreadTable *t, long num_threads) {
+    if (!t->task_dir) return false;
+    t->relisted = false;
+    t->unavailable = 0;
+
+    // A listagem anterior continua válida enquanto o total de threads não
+    // muda e nenhuma thread listada terminou
+    if (t->stale || t->count == 0 || num_threads <= 0 || num_threads != t->listed_threads) {
+        if (!relist(t)) return false;
+    }
+
+    uint64_t now = monotonic_ns();
+    t->mono_ns = now;
+    size_t kept = 0;
+    for (size_t i = 0; i < t->count; i++) {
+        ThreadSlot *s = &t->threads[i];
+        int r = read_thread(t, s, now);
+        if (r < 0) {
+            // Terminou: uma thread nova pode ter ocupado o lugar sem mudar o total
+            slot_close(s);
+            t->stale = true;
+            continue;
+        }
+        if (r == 0) t->unavailable++;
+        t->threads[kept++] = *s;
+    }
+    t->count = kept;
+    return t->count > 0;
+}
+
+ThreadSlot *thread_table_find(ThreadTable *t, int tid) {
+    size_t lo = 0, hi = t->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cur = t->threads[mid].cur.tid;
+        if (cur == tid) return &t->threads[mid];
+        if (cur < tid) lo = mid + 1; else hi = mid;
+    }
+    return NULL;
+}
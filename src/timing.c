@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <math.h>
+#include <sys/timerfd.h>
+#include "../include/timing.h"
+
+bool parse_duration_ns(const char *str, uint64_t *out_ns) {
+    if (!str || !*str) return false;
+
+    char *end;
+    double value = strtod(str, &end);
+    if (end == str || value < 0) return false;
+
+    double scale;
+    if (*end == '\0' || strcmp(end, "s") == 0) {
+        scale = NSEC_PER_SEC;
+    } else if (strcmp(end, "ms") == 0) {
+        scale = NSEC_PER_MSEC;
+    } else if (strcmp(end, "us") == 0) {
+        scale = NSEC_PER_USEC;
+    } else if (strcmp(end, "ns") == 0) {
+        scale = 1;
+    } else {
+        return false;
+    }
+
+    double ns = value * scale + 0.5;
+    if (ns < 1 || ns > (double)UINT64_MAX / 2) return false;
+    *out_ns = (uint64_t)ns;
+    return true;
+}
+
+void format_duration_ns(uint64_t ns, char *buf, size_t size) {
+    if (ns % NSEC_PER_SEC == 0) {
+        snprintf(buf, size, "%llus", (unsigned long long)(ns / NSEC_PER_SEC));
+    } else if (ns % NSEC_PER_MSEC == 0) {
+        snprintf(buf, size, "%llums", (unsigned long long)(ns / NSEC_PER_MSEC));
+    } else if (ns % NSEC_PER_USEC == 0) {
+        snprintf(buf, size, "%lluus", (unsigned long long)(ns / NSEC_PER_USEC));
+    } else {
+        snprintf(buf, size, "%lluns", (unsigned long long)ns);
+    }
+}
+
+bool sample_timer_start(SampleTimer *t, uint64_t interval_ns) {
+    t->interval_ns = interval_ns;
+    t->fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (t->fd < 0) {
+        fprintf(stderr, "Erro ao criar timerfd: %s\n", strerror(errno));
+        return false;
+    }
+
+    // Primeiro prazo absoluto; os seguintes são first + k * interval
+    uint64_t first = monotonic_ns() + interval_ns;
+    t->deadline_ns = first;
+    struct itimerspec spec = {
+        .it_value    = { (time_t)(first / NSEC_PER_SEC), (long)(first % NSEC_PER_SEC) },
+        .it_interval = { (time_t)(interval_ns / NSEC_PER_SEC), (long)(interval_ns % NSEC_PER_SEC) },
+    };
+    if (timerfd_settime(t->fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+        fprintf(stderr, "Erro ao armar timerfd: %s\n", strerror(errno));
+        close(t->fd);
+        t->fd = -1;
+        return false;
+    }
+    return true;
+}
+
+uint64_t sample_timer_wait(SampleTimer *t) {
+    uint64_t expirations;
+    for (;;) {
+        ssize_t n = read(t->fd, &expirations, sizeof(expirations));
+        if (n == sizeof(expirations)) {
+            t->deadline_ns += expirations * t->interval_ns;
+            return expirations;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return 0;
+    }
+}
+
+bool sample_timer_set_interval(SampleTimer *t, uint64_t interval_ns) {
+    if (interval_ns == t->interval_ns) return true;
+
+    // A fase continua presa à última expiração, não ao fim da coleta
+    uint64_t first = t->deadline_ns - t->interval_ns + interval_ns;
+    uint64_t now = monotonic_ns();
+    if (first <= now) first = now + interval_ns;
+    struct itimerspec spec = {
+        .it_value    = { (time_t)(first / NSEC_PER_SEC), (long)(first % NSEC_PER_SEC) },
+        .it_interval = { (time_t)(interval_ns / NSEC_PER_SEC), (long)(interval_ns % NSEC_PER_SEC) },
+    };
+    if (timerfd_settime(t->fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+        fprintf(stderr, "Erro ao rearmar timerfd: %s\n", strerror(errno));
+        return false;
+    }
+    t->interval_ns = interval_ns;
+    t->deadline_ns = first;
+    return true;
+}
+
+void sample_timer_close(SampleTimer *t) {
+    if (t->fd >= 0) {
+        close(t->fd);
+    }
+    t->fd = -1;
+}
+
+// ---------- Intervalo adaptativo ----------
+
+// Mudanças que mantêm o intervalo mínimo: CPU em pontos percentuais; RSS e
+// I/O relativas ao valor anterior, com piso absoluto para ignorar ruído
+#define ADAPTIVE_CPU_DELTA      2.0
+#define ADAPTIVE_RSS_RELATIVE   0.01
+#define ADAPTIVE_RSS_FLOOR      (256.0 * 1024)
+#define ADAPTIVE_IO_RELATIVE    0.10
+#define ADAPTIVE_IO_FLOOR       (64.0 * 1024)
+
+void adaptive_interval_init(AdaptiveInterval *a, uint64_t min_ns, uint64_t max_ns) {
+    memset(a, 0, sizeof(AdaptiveInterval));
+    a->min_ns = min_ns;
+    a->max_ns = (max_ns > min_ns) ? max_ns : min_ns;
+    a->interval_ns = min_ns;
+}
+
+static bool signal_changed(double prev, double cur, double relative, double floor) {
+    double limit = fabs(prev) * relative;
+    return fabs(cur - prev) > (limit > floor ? limit : floor);
+}
+
+uint64_t adaptive_interval_update(AdaptiveInterval *a, double cpu_percent, double rss_bytes,
+                                  double io_rate) {
+    bool changed = !a->primed ||
+                   fabs(cpu_percent - a->cpu_percent) > ADAPTIVE_CPU_DELTA ||
+                   signal_changed(a->rss_bytes, rss_bytes, ADAPTIVE_RSS_RELATIVE, ADAPTIVE_RSS_FLOOR) ||
+                   signal_changed(a->io_rate, io_rate, ADAPTIVE_IO_RELATIVE, ADAPTIVE_IO_FLOOR);
+    a->primed = true;
+    a->cpu_percent = cpu_percent;
+    a->rss_bytes = rss_bytes;
+    a->io_rate = io_rate;
+
+    if (changed) {
+        a->interval_ns = a->min_ns;
+    } else if (a->interval_ns < a->max_ns) {
+        // Recuo exponencial enquanto as métricas ficam estáveis
+        a->interval_ns = (a->interval_ns > a->max_ns / 2) ? a->max_ns : a->interval_ns * 2;
+    }
+    return a->interval_ns;
+}
@@ -0,0 +1,908 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "../include/tsdb.h"
+#include "../include/timing.h"
+
+#define TSDB_MAGIC          0x53544d52u     // "RMTS"
+#define TSDB_BLOCK_MAGIC    0x31424d52u     // "RMB1"
+#define TSDB_INDEX_MAGIC    0x58494d52u     // "RMIX"
+#define TSDB_VERSION        1
+
+#define FILE_HEADER_SIZE    24
+#define BLOCK_HEADER_SIZE   40
+#define INDEX_ENTRY_SIZE    32
+#define FOOTER_SIZE         16
+
+#define LEAD_NONE           0xff            // sem janela XOR anterior
+
+// ---------- Campos codificados ----------
+
+typedef enum {
+    FIELD_DOD,                  // contador monotônico: delta-of-delta
+    FIELD_DELTA,                // gauge inteiro: delta
+    FIELD_XOR                   // gauge double: XOR com o anterior
+} FieldKind;
+
+// A ordem dos campos faz parte do formato (ver metrics_to_fields)
+static const FieldKind field_kinds[] = {
+    FIELD_DOD, FIELD_DOD,                               // mono_ns, real_ns
+    FIELD_DOD, FIELD_DOD, FIELD_DOD, FIELD_DOD,         // CPU user/system, ctx switches
+    FIELD_DOD, FIELD_DOD,                               // page faults
+    FIELD_DOD, FIELD_DOD, FIELD_DOD, FIELD_DOD, FIELD_DOD,  // I/O
+    FIELD_DOD, FIELD_DOD, FIELD_DOD, FIELD_DOD,         // rede
+    FIELD_DELTA, FIELD_DELTA, FIELD_DELTA,              // threads, vsize, rss
+    FIELD_DELTA, FIELD_DELTA, FIELD_DELTA,              // shared, swap, conexões
+    FIELD_XOR, FIELD_XOR, FIELD_XOR                     // CPU%, I/O KB/s
+};
+
+#define NUM_FIELDS (sizeof(field_kinds) / sizeof(field_kinds[0]))
+
+static uint64_t double_bits(double d) {
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    return v;
+}
+
+static double bits_double(uint64_t v) {
+    double d;
+    memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+static void metrics_to_fields(const ProcessMetrics *m, uint64_t v[NUM_FIELDS]) {
+    v[0] = m->mono_ns;
+    v[1] = m->real_ns;
+    v[2] = m->cpu_user_time;
+    v[3] = m->cpu_system_time;
+    v[4] = (uint64_t)m->voluntary_ctx_switches;
+    v[5] = (uint64_t)m->nonvoluntary_ctx_switches;
+    v[6] = (uint64_t)m->page_faults_minor;
+    v[7] = (uint64_t)m->page_faults_major;
+    v[8] = m->io_read_bytes;
+    v[9] = m->io_write_bytes;
+    v[10] = m->io_cancelled_write_bytes;
+    v[11] = m->io_read_syscalls;
+    v[12] = m->io_write_syscalls;
+    v[13] = m->net_rx_bytes;
+    v[14] = m->net_tx_bytes;
+    v[15] = m->net_rx_packets;
+    v[16] = m->net_tx_packets;
+    v[17] = (uint64_t)m->num_threads;
+    v[18] = (uint64_t)m->mem_vsize;
+    v[19] = (uint64_t)m->mem_rss;
+    v[20] = (uint64_t)m->mem_shared;
+    v[21] = (uint64_t)m->mem_swap;
+    v[22] = (uint64_t)(int64_t)m->net_connections;
+    v[23] = double_bits(m->cpu_usage_percent);
+    v[24] = double_bits(m->io_read_rate_kbs);
+    v[25] = double_bits(m->io_write_rate_kbs);
+}
+
+static void fields_to_metrics(const uint64_t v[NUM_FIELDS], ProcessMetrics *m) {
+    m->mono_ns = v[0];
+    m->real_ns = v[1];
+    m->timestamp = (time_t)(v[1] / NSEC_PER_SEC);
+    m->cpu_user_time = v[2];
+    m->cpu_system_time = v[3];
+    m->cpu_total_time = m->cpu_user_time + m->cpu_system_time;
+    m->voluntary_ctx_switches = (long)v[4];
+    m->nonvoluntary_ctx_switches = (long)v[5];
+    m->page_faults_minor = (long)v[6];
+    m->page_faults_major = (long)v[7];
+    m->io_read_bytes = v[8];
+    m->io_write_bytes = v[9];
+    m->io_cancelled_write_bytes = v[10];
+    m->io_read_syscalls = v[11];
+    m->io_write_syscalls = v[12];
+    m->net_rx_bytes = v[13];
+    m->net_tx_bytes = v[14];
+    m->net_rx_packets = v[15];
+    m->net_tx_packets = v[16];
+    m->num_threads = (long)v[17];
+    m->mem_vsize = (long)v[18];
+    m->mem_rss = (long)v[19];
+    m->mem_shared = (long)v[20];
+    m->mem_swap = (long)v[21];
+    m->net_connections = (int)(int64_t)v[22];
+    m->cpu_usage_percent = bits_double(v[23]);
+    m->io_read_rate_kbs = bits_double(v[24]);
+    m->io_write_rate_kbs = bits_double(v[25]);
+}
+
+// ---------- Bytes little-endian ----------
+
+static void put_u16(unsigned char *p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void put_u64(unsigned char *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint16_t get_u16(const unsigned char *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const unsigned char *p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const unsigned char *p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint32_t fnv1a(const unsigned char *p, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// ---------- Fluxo de bits (MSB primeiro) ----------
+
+typedef struct {
+    unsigned char *buf;
+    size_t bits;                // bits escritos
+    size_t cap;                 // bytes alocados (sempre zerados além de bits)
+} BitWriter;
+
+static bool bits_reserve(BitWriter *b, unsigned n) {
+    size_t need = (b->bits + n + 7) / 8;
+    if (need <= b->cap) return true;
+
+    size_t cap = b->cap ? b->cap * 2 : 1024;
+    while (cap < need) cap *= 2;
+    unsigned char *buf = realloc(b->buf, cap);
+    if (!buf) return false;
+    memset(buf + b->cap, 0, cap - b->cap);
+    b->buf = buf;
+    b->cap = cap;
+    return true;
+}
+
+// Escreve os n bits menos significativos de value (n <= 64)
+static void bits_put(BitWriter *b, uint64_t value, unsigned n) {
+    while (n > 0) {
+        unsigned off = b->bits & 7;
+        unsigned room = 8 - off;
+        unsigned take = (n < room) ? n : room;
+        unsigned chunk = (unsigned)(value >> (n - take)) & ((1u << take) - 1);
+        b->buf[b->bits >> 3] |= (unsigned char)(chunk << (room - take));
+        b->bits += take;
+        n -= take;
+    }
+}
+
+typedef struct {
+    const unsigned char *buf;
+    size_t bits;                // tamanho total em bits
+    size_t pos;
+} BitReader;
+
+static bool bits_get(BitReader *r, unsigned n, uint64_t *out) {
+    if (r->pos + n > r->bits) return false;
+    uint64_t v = 0;
+    while (n > 0) {
+        unsigned off = r->pos & 7;
+        unsigned room = 8 - off;
+        unsigned take = (n < room) ? n : room;
+        unsigned byte = r->buf[r->pos >> 3];
+        unsigned chunk = (byte >> (room - take)) & ((1u << take) - 1);
+        v = (v << take) | chunk;
+        r->pos += take;
+        n -= take;
+    }
+    *out = v;
+    return true;
+}
+
+// Inteiro com sinal em faixas de tamanho crescente (zigzag):
+//   0 -> '0' | '10' + 7 bits | '110' + 14 bits | '1110' + 32 bits | '1111' + 64 bits
+static void put_signed(BitWriter *b, int64_t d) {
+    uint64_t z = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+    if (z == 0) {
+        bits_put(b, 0, 1);
+    } else if (z < (1ULL << 7)) {
+        bits_put(b, 0x2, 2);
+        bits_put(b, z, 7);
+    } else if (z < (1ULL << 14)) {
+        bits_put(b, 0x6, 3);
+        bits_put(b, z, 14);
+    } else if (z < (1ULL << 32)) {
+        bits_put(b, 0xe, 4);
+        bits_put(b, z, 32);
+    } else {
+        bits_put(b, 0xf, 4);
+        bits_put(b, z, 64);
+    }
+}
+
+static bool get_signed(BitReader *r, int64_t *d) {
+    static const unsigned widths[] = { 7, 14, 32, 64 };
+    uint64_t bit, z = 0;
+    unsigned ones = 0;
+
+    // Conta os '1' do prefixo (no máximo 4)
+    while (ones < 4) {
+        if (!bits_get(r, 1, &bit)) return false;
+        if (bit == 0) break;
+        ones++;
+    }
+    if (ones > 0 && !bits_get(r, widths[ones - 1], &z)) return false;
+
+    *d = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+    return true;
+}
+
+// ---------- Codificação de amostras ----------
+
+typedef struct {
+    uint64_t prev;              // valor anterior (bits do double para XOR)
+    uint64_t delta;             // delta anterior (delta-of-delta)
+    uint8_t lead;               // janela XOR anterior
+    uint8_t trail;
+} FieldState;
+
+struct TsdbSeries {
+    int32_t pid;
+    char name[sizeof(((ProcessMetrics *)0)->process_name)];
+    unsigned long tick;         // última geração com amostra
+    uint16_t count;
+    uint64_t first_mono_ns;
+    uint64_t last_mono_ns;
+    FieldState fields[NUM_FIELDS];
+    BitWriter bits;
+};
+
+static void encode_sample(TsdbSeries *s, const uint64_t v[NUM_FIELDS]) {
+    BitWriter *b = &s->bits;
+
+    if (s->count == 0) {
+        for (size_t f = 0; f < NUM_FIELDS; f++) {
+            bits_put(b, v[f], 64);
+            s->fields[f].prev = v[f];
+            s->fields[f].delta = 0;
+            s->fields[f].lead = LEAD_NONE;
+        }
+        return;
+    }
+
+    for (size_t f = 0; f < NUM_FIELDS; f++) {
+        FieldState *st = &s->fields[f];
+        switch (field_kinds[f]) {
+            case FIELD_DOD: {
+                uint64_t delta = v[f] - st->prev;
+                put_signed(b, (int64_t)(delta - st->delta));
+                st->delta = delta;
+                break;
+            }
+            case FIELD_DELTA:
+                put_signed(b, (int64_t)(v[f] - st->prev));
+                break;
+            case FIELD_XOR: {
+                uint64_t x = v[f] ^ st->prev;
+                if (x == 0) {
+                    bits_put(b, 0, 1);
+                    break;
+                }
+                unsigned lead = (unsigned)__builtin_clzll(x);
+                unsigned trail = (unsigned)__builtin_ctzll(x);
+                if (st->lead != LEAD_NONE && lead >= st->lead && trail >= st->trail) {
+                    // Cabe na janela anterior: só os bits significativos
+                    bits_put(b, 0x2, 2);
+                    bits_put(b, x >> st->trail, 64 - st->lead - st->trail);
+                } else {
+                    unsigned len = 64 - lead - trail;
+                    bits_put(b, 0x3, 2);
+                    bits_put(b, lead, 6);
+                    bits_put(b, len - 1, 6);
+                    bits_put(b, x >> trail, len);
+                    st->lead = (uint8_t)lead;
+                    st->trail = (uint8_t)trail;
+                }
+                break;
+            }
+        }
+        st->prev = v[f];
+    }
+}
+
+static bool decode_sample(BitReader *r, FieldState *fields, bool first, uint64_t v[NUM_FIELDS]) {
+    if (first) {
+        for (size_t f = 0; f < NUM_FIELDS; f++) {
+            if (!bits_get(r, 64, &v[f])) return false;
+            fields[f].prev = v[f];
+            fields[f].delta = 0;
+            fields[f].lead = LEAD_NONE;
+        }
+        return true;
+    }
+
+    for (size_t f = 0; f < NUM_FIELDS; f++) {
+        FieldState *st = &fields[f];
+        int64_t d;
+        uint64_t bit, x;
+        switch (field_kinds[f]) {
+            case FIELD_DOD:
+                if (!get_signed(r, &d)) return false;
+                st->delta += (uint64_t)d;
+                v[f] = st->prev + st->delta;
+                break;
+            case FIELD_DELTA:
+                if (!get_signed(r, &d)) return false;
+                v[f] = st->prev + (uint64_t)d;
+                break;
+            case FIELD_XOR:
+                if (!bits_get(r, 1, &bit)) return false;
+                if (bit == 0) {
+                    v[f] = st->prev;
+                    break;
+                }
+                if (!bits_get(r, 1, &bit)) return false;
+                if (bit == 0) {
+                    if (st->lead == LEAD_NONE) return false;
+                    if (!bits_get(r, 64 - st->lead - st->trail, &x)) return false;
+                    v[f] = st->prev ^ (x << st->trail);
+                } else {
+                    uint64_t lead, len;
+                    if (!bits_get(r, 6, &lead) || !bits_get(r, 6, &len)) return false;
+                    len += 1;
+                    if (lead + len > 64) return false;
+                    if (!bits_get(r, (unsigned)len, &x)) return false;
+                    st->lead = (uint8_t)lead;
+                    st->trail = (uint8_t)(64 - lead - len);
+                    v[f] = st->prev ^ (x << st->trail);
+                }
+                break;
+        }
+        st->prev = v[f];
+    }
+    return true;
+}
+
+// ---------- Escrita ----------
+
+static bool write_bytes(TsdbWriter *w, const void *p, size_t len) {
+    if (len > 0 && fwrite(p, 1, len, w->fp) != len) {
+        fprintf(stderr, "Erro ao gravar arquivo de métricas: %s\n", strerror(errno));
+        return false;
+    }
+    w->offset += len;
+    return true;
+}
+
+// Grava o bloco aberto da série e o reinicia
+static bool flush_series(TsdbWriter *w, TsdbSeries *s) {
+    if (s->count == 0) return true;
+
+    if (w->index_count == w->index_cap) {
+        size_t cap = w->index_cap ? w->index_cap * 2 : 256;
+        TsdbIndexEntry *index = realloc(w->index, cap * sizeof(TsdbIndexEntry));
+        if (!index) return false;
+        w->index = index;
+        w->index_cap = cap;
+    }
+
+    size_t payload = (s->bits.bits + 7) / 8;
+    size_t name_len = strnlen(s->name, sizeof(s->name));
+    unsigned char hdr[BLOCK_HEADER_SIZE] = {0};
+    put_u32(hdr, TSDB_BLOCK_MAGIC);
+    put_u32(hdr + 4, (uint32_t)payload);
+    put_u32(hdr + 8, (uint32_t)s->pid);
+    put_u16(hdr + 12, s->count);
+    hdr[14] = (unsigned char)name_len;
+    put_u64(hdr + 16, s->first_mono_ns);
+    put_u64(hdr + 24, s->last_mono_ns);
+    put_u32(hdr + 32, fnv1a(s->bits.buf, payload));
+
+    TsdbIndexEntry *e = &w->index[w->index_count];
+    e->offset = w->offset;
+    e->pid = s->pid;
+    e->count = s->count;
+    e->first_mono_ns = s->first_mono_ns;
+    e->last_mono_ns = s->last_mono_ns;
+
+    if (!write_bytes(w, hdr, sizeof(hdr)) ||
+        !write_bytes(w, s->name, name_len) ||
+        !write_bytes(w, s->bits.buf, payload)) {
+        return false;
+    }
+    w->index_count++;
+
+    memset(s->bits.buf, 0, payload);
+    s->bits.bits = 0;
+    s->count = 0;
+    return true;
+}
+
+static size_t lookup_hash(int32_t pid, size_t cap) {
+    return ((uint32_t)pid * 2654435761u) & (cap - 1);
+}
+
+static bool rebuild_lookup(TsdbWriter *w, size_t cap) {
+    int32_t *lookup = malloc(cap * sizeof(int32_t));
+    if (!lookup) return false;
+    for (size_t i = 0; i < cap; i++) lookup[i] = -1;
+
+    for (size_t s = 0; s < w->series_count; s++) {
+        size_t i = lookup_hash(w->series[s]->pid, cap);
+        while (lookup[i] != -1) i = (i + 1) & (cap - 1);
+        lookup[i] = (int32_t)s;
+    }
+
+    free(w->lookup);
+    w->lookup = lookup;
+    w->lookup_cap = cap;
+    return true;
+}
+
+static TsdbSeries *find_series(TsdbWriter *w, int32_t pid) {
+    size_t i = lookup_hash(pid, w->lookup_cap);
+    while (w->lookup[i] != -1) {
+        TsdbSeries *s = w->series[w->lookup[i]];
+        if (s->pid == pid) return s;
+        i = (i + 1) & (w->lookup_cap - 1);
+    }
+    return NULL;
+}
+
+static TsdbSeries *add_series(TsdbWriter *w, int32_t pid) {
+    if (w->series_count == w->series_cap) {
+        size_t cap = w->series_cap ? w->series_cap * 2 : 64;
+        TsdbSeries **series = realloc(w->series, cap * sizeof(TsdbSeries *));
+        if (!series) return NULL;
+        w->series = series;
+        w->series_cap = cap;
+    }
+
+    TsdbSeries *s = calloc(1, sizeof(TsdbSeries));
+    if (!s) return NULL;
+    s->pid = pid;
+    w->series[w->series_count++] = s;
+
+    // Mantém o índice PID -> série abaixo de 50% de ocupação
+    if (w->series_count * 2 > w->lookup_cap) {
+        if (!rebuild_lookup(w, w->lookup_cap * 2)) {
+            w->series_count--;
+            free(s);
+            return NULL;
+        }
+    } else {
+        size_t i = lookup_hash(pid, w->lookup_cap);
+        while (w->lookup[i] != -1) i = (i + 1) & (w->lookup_cap - 1);
+        w->lookup[i] = (int32_t)(w->series_count - 1);
+    }
+    return s;
+}
+
+static void free_series(TsdbSeries *s) {
+    free(s->bits.buf);
+    free(s);
+}
+
+bool tsdb_writer_open(TsdbWriter *w, const char *path) {
+    memset(w, 0, sizeof(TsdbWriter));
+    w->fp = fopen(path, "wb");
+    if (!w->fp) {
+        fprintf(stderr, "Erro ao criar arquivo de métricas %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (!rebuild_lookup(w, 64)) {
+        fclose(w->fp);
+        w->fp = NULL;
+        return false;
+    }
+
+    unsigned char hdr[FILE_HEADER_SIZE] = {0};
+    put_u32(hdr, TSDB_MAGIC);
+    put_u16(hdr + 4, TSDB_VERSION);
+    put_u16(hdr + 6, (uint16_t)NUM_FIELDS);
+    put_u32(hdr + 8, TSDB_BLOCK_SAMPLES);
+    put_u64(hdr + 16, realtime_ns());
+    if (!write_bytes(w, hdr, sizeof(hdr))) {
+        tsdb_writer_close(w);
+        return false;
+    }
+    return true;
+}
+
+bool tsdb_writer_append(TsdbWriter *w, const ProcessMetrics *m) {
+    TsdbSeries *s = find_series(w, m->pid);
+    if (!s) {
+        s = add_series(w, m->pid);
+        if (!s) return false;
+    }
+
+    // Um bloco tem um único nome: PID reutilizado ou exec() fecha o bloco
+    if (strncmp(s->name, m->process_name, sizeof(s->name)) != 0) {
+        if (!flush_series(w, s)) return false;
+        memcpy(s->name, m->process_name, sizeof(s->name));
+        s->name[sizeof(s->name) - 1] = '\0';
+    }
+
+    // Pior caso: prefixo de 4 bits + 64 bits por campo
+    if (!bits_reserve(&s->bits, NUM_FIELDS * 68)) return false;
+
+    uint64_t v[NUM_FIELDS];
+    metrics_to_fields(m, v);
+    encode_sample(s, v);
+
+    if (s->count == 0) s->first_mono_ns = m->mono_ns;
+    s->last_mono_ns = m->mono_ns;
+    s->count++;
+    s->tick = w->tick;
+    w->samples++;
+
+    if (s->count == TSDB_BLOCK_SAMPLES) return flush_series(w, s);
+    return true;
+}
+
+bool tsdb_writer_end_tick(TsdbWriter *w) {
+    bool ok = true;
+    size_t kept = 0;
+    for (size_t i = 0; i < w->series_count; i++) {
+        TsdbSeries *s = w->series[i];
+        if (s->tick == w->tick) {
+            w->series[kept++] = s;
+        } else {
+            ok &= flush_series(w, s);
+            free_series(s);
+        }
+    }
+
+    if (kept != w->series_count) {
+        w->series_count = kept;
+        ok &= rebuild_lookup(w, w->lookup_cap);
+    }
+    w->tick++;
+    return ok;
+}
+
+bool tsdb_writer_flush(TsdbWriter *w) {
+    bool ok = true;
+    for (size_t i = 0; i < w->series_count; i++) {
+        ok &= flush_series(w, w->series[i]);
+    }
+    return ok && fflush(w->fp) == 0;
+}
+
+bool tsdb_writer_close(TsdbWriter *w) {
+    if (!w->fp) return false;
+
+    bool ok = true;
+    for (size_t i = 0; i < w->series_count; i++) {
+        ok &= flush_series(w, w->series[i]);
+        free_series(w->series[i]);
+    }
+
+    // Índice + rodapé
+    uint64_t index_offset = w->offset;
+    for (size_t i = 0; ok && i < w->index_count; i++) {
+        const TsdbIndexEntry *e = &w->index[i];
+        unsigned char buf[INDEX_ENTRY_SIZE] = {0};
+        put_u64(buf, e->offset);
+        put_u32(buf + 8, (uint32_t)e->pid);
+        put_u16(buf + 12, e->count);
+        put_u64(buf + 16, e->first_mono_ns);
+        put_u64(buf + 24, e->last_mono_ns);
+        ok &= write_bytes(w, buf, sizeof(buf));
+    }
+    if (ok) {
+        unsigned char footer[FOOTER_SIZE];
+        put_u64(footer, index_offset);
+        put_u32(footer + 8, (uint32_t)w->index_count);
+        put_u32(footer + 12, TSDB_INDEX_MAGIC);
+        ok &= write_bytes(w, footer, sizeof(footer));
+    }
+
+    if (fclose(w->fp) != 0) ok = false;
+    free(w->series);
+    free(w->lookup);
+    free(w->index);
+
+    // offset e samples continuam válidos para estatísticas da captura
+    w->fp = NULL;
+    w->series = NULL;
+    w->series_count = w->series_cap = 0;
+    w->lookup = NULL;
+    w->lookup_cap = 0;
+    w->index = NULL;
+    w->index_count = w->index_cap = 0;
+    return ok;
+}
+
+// ---------- Leitura ----------
+
+// Valida o bloco em offset; retorna o tamanho total ou 0 se inválido
+static size_t check_block(const TsdbReader *r, size_t offset, TsdbIndexEntry *e) {
+    if (offset > r->size || r->size - offset < BLOCK_HEADER_SIZE) return 0;
+
+    const unsigned char *p = r->data + offset;
+    if (get_u32(p) != TSDB_BLOCK_MAGIC) return 0;
+
+    size_t payload = get_u32(p + 4);
+    size_t name_len = p[14];
+    size_t total = BLOCK_HEADER_SIZE + name_len + payload;
+    uint16_t count = get_u16(p + 12);
+    if (r->size - offset < total || count == 0 || count > TSDB_BLOCK_SAMPLES) return 0;
+    if (fnv1a(p + BLOCK_HEADER_SIZE + name_len, payload) != get_u32(p + 32)) return 0;
+
+    if (e) {
+        e->offset = offset;
+        e->pid = (int32_t)get_u32(p + 8);
+        e->count = count;
+        e->first_mono_ns = get_u64(p + 16);
+        e->last_mono_ns = get_u64(p + 24);
+    }
+    return total;
+}
+
+static bool read_footer_index(TsdbReader *r) {
+    if (r->size < FILE_HEADER_SIZE + FOOTER_SIZE) return false;
+
+    const unsigned char *footer = r->data + r->size - FOOTER_SIZE;
+    if (get_u32(footer + 12) != TSDB_INDEX_MAGIC) return false;
+
+    uint64_t index_offset = get_u64(footer);
+    size_t count = get_u32(footer + 8);
+    if (index_offset < FILE_HEADER_SIZE ||
+        index_offset + (uint64_t)count * INDEX_ENTRY_SIZE + FOOTER_SIZE != r->size) {
+        return false;
+    }
+
+    r->index = calloc(count ? count : 1, sizeof(TsdbIndexEntry));
+    if (!r->index) return false;
+
+    for (size_t i = 0; i < count; i++) {
+        const unsigned char *p = r->data + index_offset + i * INDEX_ENTRY_SIZE;
+        TsdbIndexEntry *e = &r->index[i];
+        e->offset = get_u64(p);
+        e->pid = (int32_t)get_u32(p + 8);
+        e->count = get_u16(p + 12);
+        e->first_mono_ns = get_u64(p + 16);
+        e->last_mono_ns = get_u64(p + 24);
+    }
+    r->block_count = count;
+    return true;
+}
+
+// Captura interrompida: reconstrói o índice percorrendo os blocos
+static bool scan_blocks(TsdbReader *r) {
+    size_t cap = 256;
+    r->index = malloc(cap * sizeof(TsdbIndexEntry));
+    if (!r->index) return false;
+
+    size_t offset = FILE_HEADER_SIZE;
+    TsdbIndexEntry e;
+    size_t len;
+    while ((len = check_block(r, offset, &e)) > 0) {
+        if (r->block_count == cap) {
+            cap *= 2;
+            TsdbIndexEntry *index = realloc(r->index, cap * sizeof(TsdbIndexEntry));
+            if (!index) return false;
+            r->index = index;
+        }
+        r->index[r->block_count++] = e;
+        offset += len;
+    }
+    r->recovered = true;
+    return true;
+}
+
+bool tsdb_reader_open(TsdbReader *r, const char *path) {
+    memset(r, 0, sizeof(TsdbReader));
+
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Erro ao abrir %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0) size = ftell(fp);
+    if (size < FILE_HEADER_SIZE || fseek(fp, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "Arquivo de métricas inválido: %s\n", path);
+        fclose(fp);
+        return false;
+    }
+
+    r->size = (size_t)size;
+    r->data = malloc(r->size);
+    bool ok = r->data && fread(r->data, 1, r->size, fp) == r->size;
+    fclose(fp);
+    if (!ok) {
+        fprintf(stderr, "Erro ao ler %s\n", path);
+        tsdb_reader_close(r);
+        return false;
+    }
+
+    if (get_u32(r->data) != TSDB_MAGIC || get_u16(r->data + 4) != TSDB_VERSION ||
+        get_u16(r->data + 6) != NUM_FIELDS) {
+        fprintf(stderr, "Formato não reconhecido: %s\n", path);
+        tsdb_reader_close(r);
+        return false;
+    }
+
+    if (!read_footer_index(r)) {
+        free(r->index);
+        r->index = NULL;
+        r->block_count = 0;
+        if (!scan_blocks(r)) {
+            tsdb_reader_close(r);
+            return false;
+        }
+    }
+    return true;
+}
+
+void tsdb_reader_close(TsdbReader *r) {
+    free(r->data);
+    free(r->index);
+    memset(r, 0, sizeof(TsdbReader));
+}
+
+int tsdb_reader_block(const TsdbReader *r, size_t i, ProcessMetrics *out) {
+    if (i >= r->block_count) return -1;
+
+    size_t offset = r->index[i].offset;
+    if (check_block(r, offset, NULL) == 0) return -1;
+
+    const unsigned char *p = r->data + offset;
+    int32_t pid = (int32_t)get_u32(p + 8);
+    int count = get_u16(p + 12);
+    size_t name_len = p[14];
+    const char *name = (const char *)p + BLOCK_HEADER_SIZE;
+
+    BitReader br = {
+        .buf = p + BLOCK_HEADER_SIZE + name_len,
+        .bits = (size_t)get_u32(p + 4) * 8,
+        .pos = 0,
+    };
+    FieldState fields[NUM_FIELDS];
+    uint64_t v[NUM_FIELDS];
+
+    for (int n = 0; n < count; n++) {
+        if (!decode_sample(&br, fields, n == 0, v)) return -1;
+
+        ProcessMetrics *m = &out[n];
+        memset(m, 0, sizeof(ProcessMetrics));
+        m->pid = pid;
+        size_t len = (name_len < sizeof(m->process_name)) ? name_len : sizeof(m->process_name) - 1;
+        memcpy(m->process_name, name, len);
+        fields_to_metrics(v, m);
+    }
+    return count;
+}
+
+// ---------- Conversão ----------
+
+static const TsdbIndexEntry *sort_base;
+
+static int compare_blocks(const void *a, const void *b) {
+    const TsdbIndexEntry *ea = &sort_base[*(const size_t *)a];
+    const TsdbIndexEntry *eb = &sort_base[*(const size_t *)b];
+    if (ea->pid != eb->pid) return (ea->pid < eb->pid) ? -1 : 1;
+    if (ea->first_mono_ns != eb->first_mono_ns) return (ea->first_mono_ns < eb->first_mono_ns) ? -1 : 1;
+    return 0;
+}
+
+bool tsdb_dump(const char *path, const char *format, const char *out_path) {
+    bool json = strcmp(format, "json") == 0;
+    if (!json && strcmp(format, "csv") != 0) {
+        fprintf(stderr, "Formato desconhecido: %s\n", format);
+        return false;
+    }
+
+    TsdbReader r;
+    if (!tsdb_reader_open(&r, path)) return false;
+    if (r.recovered) {
+        fprintf(stderr, "Aviso: índice ausente (captura interrompida?); %zu blocos recuperados\n",
+                r.block_count);
+    }
+
+    size_t *order = malloc((r.block_count ? r.block_count : 1) * sizeof(size_t));
+    ProcessMetrics *samples = malloc(TSDB_BLOCK_SAMPLES * sizeof(ProcessMetrics));
+    if (!order || !samples) {
+        free(order);
+        free(samples);
+        tsdb_reader_close(&r);
+        return false;
+    }
+    for (size_t i = 0; i < r.block_count; i++) order[i] = i;
+    sort_base = r.index;
+    qsort(order, r.block_count, sizeof(size_t), compare_blocks);
+
+    bool to_stdout = !out_path || strcmp(out_path, "-") == 0;
+    OutBuf o;
+    bool opened;
+    if (to_stdout) {
+        fflush(stdout);
+        opened = out_init(&o, STDOUT_FILENO, NULL, OUT_BUF_SIZE);
+    } else {
+        opened = out_open(&o, out_path);
+    }
+    if (!opened) {
+        fprintf(stderr, "Erro ao criar %s: %s\n", out_path, strerror(errno));
+        free(order);
+        free(samples);
+        tsdb_reader_close(&r);
+        return false;
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < r.block_count; i++) total += r.index[i].count;
+
+    if (json) {
+        out_lit(&o, "{\n  \"source\": ");
+        out_json_str(&o, path);
+        out_lit(&o, ",\n  \"block_count\": ");
+        out_u64(&o, r.block_count);
+        out_lit(&o, ",\n  \"sample_count\": ");
+        out_u64(&o, total);
+        out_lit(&o, ",\n  \"samples\": [\n");
+    } else {
+        write_metrics_csv_header(&o);
+    }
+
+    bool ok = true, first = true;
+    for (size_t i = 0; i < r.block_count; i++) {
+        int n = tsdb_reader_block(&r, order[i], samples);
+        if (n < 0) {
+            fprintf(stderr, "Aviso: bloco %zu corrompido ignorado\n", order[i]);
+            ok = false;
+            continue;
+        }
+        for (int k = 0; k < n; k++) {
+            if (json) {
+                if (!first) out_lit(&o, ",\n");
+                write_metrics_json_sample(&o, &samples[k], true);
+            } else {
+                write_metrics_csv_row(&o, &samples[k]);
+            }
+            first = false;
+        }
+    }
+
+    if (json) {
+        out_lit(&o, "\n  ]\n}\n");
+    }
+
+    if (!out_close(&o)) {
+        fprintf(stderr, "Erro ao gravar a saída do dump\n");
+        ok = false;
+    }
+    free(order);
+    free(samples);
+    tsdb_reader_close(&r);
+    return ok;
+}
+
+bool export_metrics_tsdb(const char *filename, MetricsHistory *history) {
+    if (!history) return false;
+
+    uint64_t head = metrics_history_head(history);
+    uint64_t oldest = metrics_history_oldest(history);
+    if (oldest >= head) return false;
+
+    TsdbWriter w;
+    if (!tsdb_writer_open(&w, filename)) return false;
+
+    bool ok = true;
+    ProcessMetrics sample;
+    for (uint64_t pos = oldest; ok && pos < head; pos++) {
+        if (metrics_history_read(history, pos, &sample)) {
+            ok = tsdb_writer_append(&w, &sample);
+        }
+    }
+    return tsdb_writer_close(&w) && ok;
+}
@@ -1,85 +1,193 @@
 #include "../include/utils.h"
 #include <stdio.h>
 
+// Um objeto do array JSON. compact = true grava tudo numa linha (NDJSON).
+void write_resource_json(OutBuf *o, const ResourceData *d, bool compact) {
+    // Separadores de cada modo (o literal inclui a chave seguinte)
+#define FIELD(pretty, flat) do { \
+        if (compact) out_lit(o, flat); else out_lit(o, pretty); \
+    } while (0)
+
+    FIELD("  {\n    \"timestamp\": ", "{\"timestamp\": ");
+    out_i64(o, d->timestamp);
+    FIELD(",\n    \"timestamp_ns\": ", ",\"timestamp_ns\": ");
+    out_u64(o, d->real_ns);
+    FIELD(",\n    \"interval_ns\": ", ",\"interval_ns\": ");
+    out_u64(o, d->interval_ns);
+    FIELD(",\n    \"pid\": ", ",\"pid\": ");
+    out_i64(o, d->pid);
+    FIELD(",\n    \"cpu_usage_percent\": ", ",\"cpu_usage_percent\": ");
+    out_fixed(o, d->cpu_usage_percent, 2);
+    FIELD(",\n    \"cpu_user\": ", ",\"cpu_user\": ");
+    out_i64(o, d->cpu_user);
+    FIELD(",\n    \"cpu_system\": ", ",\"cpu_system\": ");
+    out_i64(o, d->cpu_system);
+    FIELD(",\n    \"num_threads\": ", ",\"num_threads\": ");
+    out_i64(o, d->num_threads);
+    FIELD(",\n    \"voluntary_context_switches\": ", ",\"voluntary_context_switches\": ");
+    out_i64(o, d->voluntary_context_switches);
+    FIELD(",\n    \"nonvoluntary_context_switches\": ", ",\"nonvoluntary_context_switches\": ");
+    out_i64(o, d->nonvoluntary_context_switches);
+    FIELD(",\n    \"memory_vsz_kb\": ", ",\"memory_vsz_kb\": ");
+    out_i64(o, d->memory_vsz);
+    FIELD(",\n    \"memory_rss_pages\": ", ",\"memory_rss_pages\": ");
+    out_i64(o, d->memory_rss);
+    FIELD(",\n    \"page_faults_minor\": ", ",\"page_faults_minor\": ");
+    out_i64(o, d->page_faults_minor);
+    FIELD(",\n    \"page_faults_major\": ", ",\"page_faults_major\": ");
+    out_i64(o, d->page_faults_major);
+    FIELD(",\n    \"memory_swap_kb\": ", ",\"memory_swap_kb\": ");
+    out_i64(o, d->memory_swap);
+    FIELD(",\n    \"io_read_bytes\": ", ",\"io_read_bytes\": ");
+    out_i64(o, d->io_read_bytes);
+    FIELD(",\n    \"io_write_bytes\": ", ",\"io_write_bytes\": ");
+    out_i64(o, d->io_write_bytes);
+    FIELD(",\n    \"io_read_rate_bps\": ", ",\"io_read_rate_bps\": ");
+    out_fixed(o, d->io_read_rate, 2);
+    FIELD(",\n    \"io_write_rate_bps\": ", ",\"io_write_rate_bps\": ");
+    out_fixed(o, d->io_write_rate, 2);
+    FIELD(",\n    \"io_read_syscalls\": ", ",\"io_read_syscalls\": ");
+    out_i64(o, d->io_read_syscalls);
+    FIELD(",\n    \"io_write_syscalls\": ", ",\"io_write_syscalls\": ");
+    out_i64(o, d->io_write_syscalls);
+    FIELD(",\n    \"net_rx_bytes\": ", ",\"net_rx_bytes\": ");
+    out_i64(o, d->net_rx_bytes);
+    FIELD(",\n    \"net_tx_bytes\": ", ",\"net_tx_bytes\": ");
+    out_i64(o, d->net_tx_bytes);
+    FIELD(",\n    \"net_rx_packets\": ", ",\"net_rx_packets\": ");
+    out_i64(o, d->net_rx_packets);
+    FIELD(",\n    \"net_tx_packets\": ", ",\"net_tx_packets\": ");
+    out_i64(o, d->net_tx_packets);
+    FIELD(",\n    \"net_connections\": ", ",\"net_connections\": ");
+    out_i64(o, d->net_connections);
+    FIELD(",\n    \"net_rx_queue\": ", ",\"net_rx_queue\": ");
+    out_i64(o, d->net_rx_queue);
+    FIELD(",\n    \"net_tx_queue\": ", ",\"net_tx_queue\": ");
+    out_i64(o, d->net_tx_queue);
+    FIELD(",\n    \"cpu_delay_ns\": ", ",\"cpu_delay_ns\": ");
+    out_i64(o, d->cpu_delay_ns);
+    FIELD(",\n    \"blkio_delay_ns\": ", ",\"blkio_delay_ns\": ");
+    out_i64(o, d->blkio_delay_ns);
+    FIELD(",\n    \"swapin_delay_ns\": ", ",\"swapin_delay_ns\": ");
+    out_i64(o, d->swapin_delay_ns);
+    FIELD(",\n    \"freepages_delay_ns\": ", ",\"freepages_delay_ns\": ");
+    out_i64(o, d->freepages_delay_ns);
+    FIELD("\n  }", "}");
+
+#undef FIELD
+}
+
+void write_resource_csv_header(OutBuf *o) {
+    out_lit(o, "timestamp,timestamp_ns,pid,cpu_usage_percent,cpu_user,cpu_system,num_threads,voluntary_context_switches,nonvoluntary_context_switches,memory_vsz_kb,memory_rss_pages,page_faults_minor,page_faults_major,memory_swap_kb,io_read_bytes,io_write_bytes,io_read_rate_bps,io_write_rate_bps,io_read_syscalls,io_write_syscalls,net_rx_bytes,net_tx_bytes,net_rx_packets,net_tx_packets,net_connections,net_rx_queue,net_tx_queue,cpu_delay_ns,blkio_delay_ns,swapin_delay_ns,freepages_delay_ns,interval_ns\n");
+}
+
+void write_resource_csv_row(OutBuf *o, const ResourceData *d) {
+    out_i64(o, d->timestamp);
+    out_char(o, ',');
+    out_u64(o, d->real_ns);
+    out_char(o, ',');
+    out_i64(o, d->pid);
+    out_char(o, ',');
+    out_fixed(o, d->cpu_usage_percent, 2);
+    out_char(o, ',');
+    out_i64(o, d->cpu_user);
+    out_char(o, ',');
+    out_i64(o, d->cpu_system);
+    out_char(o, ',');
+    out_i64(o, d->num_threads);
+    out_char(o, ',');
+    out_i64(o, d->voluntary_context_switches);
+    out_char(o, ',');
+    out_i64(o, d->nonvoluntary_context_switches);
+    out_char(o, ',');
+    out_i64(o, d->memory_vsz);
+    out_char(o, ',');
+    out_i64(o, d->memory_rss);
+    out_char(o, ',');
+    out_i64(o, d->page_faults_minor);
+    out_char(o, ',');
+    out_i64(o, d->page_faults_major);
+    out_char(o, ',');
+    out_i64(o, d->memory_swap);
+    out_char(o, ',');
+    out_i64(o, d->io_read_bytes);
+    out_char(o, ',');
+    out_i64(o, d->io_write_bytes);
+    out_char(o, ',');
+    out_fixed(o, d->io_read_rate, 2);
+    out_char(o, ',');
+    out_fixed(o, d->io_write_rate, 2);
+    out_char(o, ',');
+    out_i64(o, d->io_read_syscalls);
+    out_char(o, ',');
+    out_i64(o, d->io_write_syscalls);
+    out_char(o, ',');
+    out_i64(o, d->net_rx_bytes);
+    out_char(o, ',');
+    out_i64(o, d->net_tx_bytes);
+    out_char(o, ',');
+    out_i64(o, d->net_rx_packets);
+    out_char(o, ',');
+    out_i64(o, d->net_tx_packets);
+    out_char(o, ',');
+    out_i64(o, d->net_connections);
+    out_char(o, ',');
+    out_i64(o, d->net_rx_queue);
+    out_char(o, ',');
+    out_i64(o, d->net_tx_queue);
+    out_char(o, ',');
+    out_i64(o, d->cpu_delay_ns);
+    out_char(o, ',');
+    out_i64(o, d->blkio_delay_ns);
+    out_char(o, ',');
+    out_i64(o, d->swapin_delay_ns);
+    out_char(o, ',');
+    out_i64(o, d->freepages_delay_ns);
+    out_char(o, ',');
+    out_u64(o, d->interval_ns);
+    out_char(o, '\n');
+}
+
 void export_to_json(const ResourceData *data, int count, const char *filename) {
-    FILE *fp = fopen(filename, "w");
-    if (fp == NULL) {
+    OutBuf o;
+    if (!out_open(&o, filename)) {
         perror("Não foi possível abrir o arquivo para escrita JSON");
         return;
     }
 
-    fprintf(fp, "[\n");
+    out_lit(&o, "[\n");
     for (int i = 0; i < count; i++) {
-        fprintf(fp, "  {\n");
-        fprintf(fp, "    \"timestamp\": %ld,\n", data[i].timestamp);
-        fprintf(fp, "    \"pid\": %d,\n", data[i].pid);
-        fprintf(fp, "    \"cpu_usage_percent\": %.2f,\n", data[i].cpu_usage_percent);
-        fprintf(fp, "    \"cpu_user\": %ld,\n", data[i].cpu_user);
-        fprintf(fp, "    \"cpu_system\": %ld,\n", data[i].cpu_system);
-        fprintf(fp, "    \"num_threads\": %ld,\n", data[i].num_threads);
-        fprintf(fp, "    \"voluntary_context_switches\": %ld,\n", data[i].voluntary_context_switches);
-        fprintf(fp, "    \"nonvoluntary_context_switches\": %ld,\n", data[i].nonvoluntary_context_switches);
-        fprintf(fp, "    \"memory_vsz_kb\": %ld,\n", data[i].memory_vsz);
-        fprintf(fp, "    \"memory_rss_pages\": %ld,\n", data[i].memory_rss);
-        fprintf(fp, "    \"page_faults_minor\": %ld,\n", data[i].page_faults_minor);
-        fprintf(fp, "    \"page_faults_major\": %ld,\n", data[i].page_faults_major);
-        fprintf(fp, "    \"memory_swap_kb\": %ld,\n", data[i].memory_swap);
-        fprintf(fp, "    \"io_read_bytes\": %lld,\n", data[i].io_read_bytes);
-        fprintf(fp, "    \"io_write_bytes\": %lld,\n", data[i].io_write_bytes);
-        fprintf(fp, "    \"io_read_rate_bps\": %.2f,\n", data[i].io_read_rate);
-        fprintf(fp, "    \"io_write_rate_bps\": %.2f,\n", data[i].io_write_rate);
-        fprintf(fp, "    \"io_read_syscalls\": %lld,\n", data[i].io_read_syscalls);
-        fprintf(fp, "    \"io_write_syscalls\": %lld,\n", data[i].io_write_syscalls);
-        fprintf(fp, "    \"net_rx_bytes\": %lld,\n", data[i].net_rx_bytes);
-        fprintf(fp, "    \"net_tx_bytes\": %lld,\n", data[i].net_tx_bytes);
-        fprintf(fp, "    \"net_rx_packets\": %lld,\n", data[i].net_rx_packets);
-        fprintf(fp, "    \"net_tx_packets\": %lld\n", data[i].net_tx_packets);
-        fprintf(fp, "  }%s\n", (i == count - 1) ? "" : ",");
+        write_resource_json(&o, &data[i], false);
+        if (i == count - 1) {
+            out_char(&o, '\n');
+        } else {
+            out_lit(&o, ",\n");
+        }
     }
-    fprintf(fp, "]\n");
+    out_lit(&o, "]\n");
 
-    fclose(fp);
+    if (!out_close(&o)) {
+        fprintf(stderr, "Erro ao gravar '%s'.\n", filename);
+        return;
+    }
     printf("Dados de monitoramento exportados para '%s'.\n", filename);
 }
 
 void export_to_csv(const ResourceData *data, int count, const char *filename) {
-    FILE *fp = fopen(filename, "w");
-    if (fp == NULL) {
+    OutBuf o;
+    if (!out_open(&o, filename)) {
         perror("Não foi possível abrir o arquivo para escrita CSV");
         return;
     }
 
-    // Header
-    fprintf(fp, "timestamp,pid,cpu_usage_percent,cpu_user,cpu_system,num_threads,voluntary_context_switches,nonvoluntary_context_switches,memory_vsz_kb,memory_rss_pages,page_faults_minor,page_faults_major,memory_swap_kb,io_read_bytes,io_write_bytes,io_read_rate_bps,io_write_rate_bps,io_read_syscalls,io_write_syscalls,net_rx_bytes,net_tx_bytes,net_rx_packets,net_tx_packets\n");
-
-    // Data
+    write_resource_csv_header(&o);
     for (int i = 0; i < count; i++) {
-        fprintf(fp, "%ld,%d,%.2f,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%lld,%lld,%.2f,%.2f,%lld,%lld,%lld,%lld,%lld,%lld\n",
-                data[i].timestamp,
-                data[i].pid,
-                data[i].cpu_usage_percent,
-                data[i].cpu_user,
-                data[i].cpu_system,
-                data[i].num_threads,
-                data[i].voluntary_context_switches,
-                data[i].nonvoluntary_context_switches,
-                data[i].memory_vsz,
-                data[i].memory_rss,
-                data[i].page_faults_minor,
-                data[i].page_faults_major,
-                data[i].memory_swap,
-                data[i].io_read_bytes,
-                data[i].io_write_bytes,
-                data[i].io_read_rate,
-                data[i].io_write_rate,
-                data[i].io_read_syscalls,
-                data[i].io_write_syscalls,
-                data[i].net_rx_bytes,
-                data[i].net_tx_bytes,
-                data[i].net_rx_packets,
-                data[i].net_tx_packets);
+        write_resource_csv_row(&o, &data[i]);
     }
 
-    fclose(fp);
+    if (!out_close(&o)) {
+        fprintf(stderr, "Erro ao gravar '%s'.\n", filename);
+        return;
+    }
     printf("Dados de monitoramento exportados para '%s'.\n", filename);
 }
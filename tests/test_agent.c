@@ -0,0 +1,418 @@
+/**
+ * test_agent.c - Teste unitário para o agente residente (daemon)
+ *
+ * Testa:
+ * - WATCH/LIST/QUERY/SUMMARY pelo socket Unix
+ * - Janela e limite de amostras nas consultas, retenção do histórico
+ * - Assinatura ao vivo e aviso de término do processo
+ * - Erros (processo inexistente ou não observado) e quadros inválidos
+ * - Requisição atendida mesmo com o cliente já desconectado (EPOLLHUP)
+ * - Eventos de cgroup: WATCH_CGROUP, assinatura, histórico e rmdir (root)
+ * - SHUTDOWN encerra o agente e remove o socket
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include "../include/agent.h"
+#include "../include/cgroup_stats.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define RETENTION 64
+#define INTERVAL_NS (10 * NSEC_PER_MSEC)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+static char socket_path[64];
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+// Agente num processo filho, com a saída descartada
+static pid_t start_agent(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        AgentConfig cfg = { .socket_path = socket_path, .retention = RETENTION };
+        _exit(agent_run(&cfg) ? 0 : 1);
+    }
+    return pid;
+}
+
+// Conecta assim que o agente estiver escutando
+static bool connect_agent(AgentClient *c) {
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);      // tentativas antes do bind
+    bool ok = false;
+    for (int i = 0; i < 200 && !ok; i++) {
+        ok = agent_client_connect(c, socket_path);
+        if (!ok) usleep(5000);
+    }
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    close(null);
+    return ok;
+}
+
+static pid_t spawn_busy(void) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        volatile unsigned long x = 0;
+        for (;;) x++;
+    }
+    return pid;
+}
+
+void test_watch_and_query(AgentClient *c, pid_t busy) {
+    printf("\n%s Testando WATCH, LIST e QUERY...\n", TEST_INFO);
+
+    assert_test("WATCH de um processo existente", agent_client_watch(c, busy, INTERVAL_NS));
+    usleep(300000);
+
+    const AgentTargetInfo *targets;
+    uint32_t count;
+    bool ok = agent_client_list(c, &targets, &count);
+    assert_test("LIST mostra o processo ativo com amostras",
+                ok && count == 1 && targets[0].pid == busy && !targets[0].ended && targets[0].samples >= 10);
+    assert_test("LIST: intervalo pedido", ok && count == 1 && targets[0].interval_ns == INTERVAL_NS);
+
+    const AgentSample *samples;
+    ok = agent_client_query(c, busy, 0, 0, &samples, &count);
+    bool ordered = ok && count > 1;
+    for (uint32_t i = 1; ordered && i < count; i++) ordered = samples[i].mono_ns > samples[i - 1].mono_ns;
+    assert_test("QUERY: histórico em ordem temporal", ordered);
+    // O tempo de CPU do /proc anda em jiffies: uma amostra de 10ms isolada
+    // pode dar 0% mesmo com o processo ocupado. Vale a média ponderada.
+    double cpu_ns = 0, total_ns = 0;
+    for (uint32_t i = 0; ok && i < count; i++) {
+        cpu_ns += samples[i].cpu_percent / 100.0 * (double)samples[i].interval_ns;
+        total_ns += (double)samples[i].interval_ns;
+    }
+    double cpu_avg = total_ns > 0 ? 100.0 * cpu_ns / total_ns : 0.0;
+    assert_test("QUERY: amostras com taxas (CPU do processo ocupado)",
+                ok && count > 2 && samples[count - 1].pid == busy && cpu_avg > 50.0 &&
+                samples[count - 1].rss_bytes > 0 && samples[count - 1].interval_ns > 0);
+    printf("  %u amostras | CPU média %.1f%% | última: CPU %.1f%%, RSS %llu KB\n", count, cpu_avg,
+           ok ? samples[count - 1].cpu_percent : 0.0, ok ? (unsigned long long)samples[count - 1].rss_bytes / 1024 : 0ULL);
+
+    ok = agent_client_query(c, busy, 0, 3, &samples, &count);
+    assert_test("QUERY com limite: as 3 mais recentes", ok && count == 3);
+
+    uint64_t window = 50 * NSEC_PER_MSEC;
+    ok = agent_client_query(c, busy, window, 0, &samples, &count);
+    assert_test("QUERY com janela de 50ms", ok && count >= 2 && count <= 8 &&
+                samples[count - 1].mono_ns - samples[0].mono_ns <= window);
+
+    AgentSummary summary;
+    ok = agent_client_summary(c, busy, &summary);
+    assert_test("SUMMARY com as amostras coletadas", ok && summary.pid == busy &&
+                summary.metrics[SUMMARY_CPU_PERCENT].count >= 10 &&
+                summary.metrics[SUMMARY_CPU_PERCENT].p50 > 50.0);
+
+    // Mais amostras que a retenção: só as últimas RETENTION ficam
+    usleep((RETENTION + 10) * (INTERVAL_NS / 1000));
+    ok = agent_client_list(c, &targets, &count);
+    assert_test("Retenção: histórico limitado", ok && count == 1 && targets[0].samples > RETENTION &&
+                targets[0].retained == RETENTION);
+}
+
+void test_errors(AgentClient *c) {
+    printf("\n%s Testando erros...\n", TEST_INFO);
+
+    // Os erros esperados vão ao stderr: descartados para a saída do teste
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+
+    errno = 0;
+    bool ok = agent_client_watch(c, 0x3ffffff0, INTERVAL_NS);
+    assert_test("WATCH de PID inexistente: ESRCH", !ok && errno == ESRCH);
+    const AgentSample *samples;
+    uint32_t count;
+    errno = 0;
+    ok = agent_client_query(c, 0x3ffffff0, 0, 0, &samples, &count);
+    assert_test("QUERY de processo não observado: ENOENT", !ok && errno == ENOENT);
+    AgentHeader resp;
+    const void *payload;
+    ok = agent_client_call(c, (AgentMsgType)200, NULL, 0, &resp, &payload);
+    assert_test("Tipo desconhecido: resposta de erro", ok && resp.type == AGENT_RESP_ERROR);
+    ok = agent_client_call(c, AGENT_REQ_QUERY, "x", 1, &resp, &payload);
+    assert_test("Requisição truncada: resposta de erro", ok && resp.type == AGENT_RESP_ERROR);
+
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    close(null);
+
+    // Quadro com magic errado: o agente fecha só esta conexão
+    AgentClient bad;
+    if (connect_agent(&bad)) {
+        AgentHeader h = { .magic = 0xdeadbeef, .version = AGENT_VERSION, .type = AGENT_REQ_LIST };
+        char byte;
+        bool sent = send(bad.fd, &h, sizeof(h), 0) == sizeof(h);
+        assert_test("Quadro inválido: conexão fechada", sent && recv(bad.fd, &byte, 1, 0) == 0);
+        agent_client_close(&bad);
+    }
+}
+
+void test_hangup(AgentClient *c, pid_t agent) {
+    printf("\n%s Testando requisição seguida de desconexão...\n", TEST_INFO);
+
+    // Cliente que envia e fecha: com o agente parado o epoll entrega dados e
+    // EPOLLHUP juntos, e a requisição ainda tem que ser atendida
+    pid_t sleeper = fork();
+    if (sleeper == 0) {
+        pause();
+        _exit(0);
+    }
+    AgentClient oneshot;
+    bool ok = connect_agent(&oneshot);
+    if (ok) {
+        struct {
+            AgentHeader h;
+            AgentWatchRequest req;
+        } msg = {
+            .h = { .magic = AGENT_MAGIC, .version = AGENT_VERSION, .type = AGENT_REQ_WATCH, .seq = 1,
+                   .length = sizeof(AgentWatchRequest) },
+            .req = { .pid = sleeper, .interval_ns = INTERVAL_NS },
+        };
+        kill(agent, SIGSTOP);
+        ok = send(oneshot.fd, &msg, sizeof(msg), 0) == sizeof(msg);
+        agent_client_close(&oneshot);
+        kill(agent, SIGCONT);
+    }
+
+    bool watched = false;
+    const AgentTargetInfo *targets;
+    uint32_t count;
+    uint64_t deadline = monotonic_ns() + 2 * NSEC_PER_SEC;
+    while (ok && !watched && monotonic_ns() < deadline) {
+        if (!agent_client_list(c, &targets, &count)) break;
+        for (uint32_t i = 0; i < count; i++) watched |= targets[i].pid == sleeper;
+        if (!watched) usleep(10000);
+    }
+    assert_test("WATCH enviado antes do fechamento atendido", watched);
+    assert_test("Agente segue atendendo", agent_client_unwatch(c, sleeper));
+
+    kill(sleeper, SIGKILL);
+    waitpid(sleeper, NULL, 0);
+}
+
+void test_subscribe(AgentClient *c, pid_t busy) {
+    printf("\n%s Testando assinatura ao vivo...\n", TEST_INFO);
+
+    AgentClient sub;
+    if (!connect_agent(&sub)) {
+        assert_test("Segunda conexão", false);
+        return;
+    }
+    assert_test("SUBSCRIBE", agent_client_subscribe(&sub, busy));
+
+    AgentSample s[3];
+    bool ok = true;
+    for (int i = 0; i < 3 && ok; i++) ok = agent_client_next_sample(&sub, &s[i]);
+    assert_test("Três amostras ao vivo, consecutivas",
+                ok && s[0].pid == busy && s[1].mono_ns > s[0].mono_ns && s[2].mono_ns > s[1].mono_ns);
+
+    // Outra conexão continua atendida enquanto a assinatura corre
+    const AgentTargetInfo *targets;
+    uint32_t count;
+    ok = agent_client_list(c, &targets, &count);
+    assert_test("LIST conta o assinante", ok && count == 1 && targets[0].subscribers == 1);
+
+    kill(busy, SIGKILL);
+    waitpid(busy, NULL, 0);
+    AgentSample last;
+    int extra = 0;
+    while (agent_client_next_sample(&sub, &last)) extra++;
+    assert_test("Término do processo encerra a assinatura", extra < 100);
+
+    ok = agent_client_list(c, &targets, &count);
+    assert_test("Processo terminado continua consultável", ok && count == 1 && targets[0].ended &&
+                targets[0].subscribers == 0);
+    const AgentSample *samples;
+    ok = agent_client_query(c, busy, 0, 0, &samples, &count);
+    assert_test("Histórico do processo terminado", ok && count == RETENTION);
+    agent_client_close(&sub);
+
+    assert_test("UNWATCH", agent_client_unwatch(c, busy));
+    ok = agent_client_list(c, &targets, &count);
+    assert_test("LIST vazio após UNWATCH", ok && count == 0);
+}
+
+// Diretório pai com cgroup v2 (relativo a CGROUP_ROOT): a raiz ou a
+// hierarquia "unified" dos sistemas híbridos
+static const char *find_v2_base(void) {
+    static const char *const bases[] = { "", "unified" };
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s/cgroup.controllers", CGROUP_ROOT, bases[i]);
+        if (access(path, R_OK) == 0) return bases[i];
+    }
+    return NULL;
+}
+
+static bool write_cgroup(const char *cgroup, const char *file, const char *value) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s/%s", CGROUP_ROOT, cgroup, file);
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    bool ok = fputs(value, f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+// Próximo evento da assinatura com a chave pedida (até 2 s sem mensagens)
+static bool next_event_with_key(AgentClient *c, const char *key, AgentCgroupEvent *out) {
+    while (agent_client_next_cgroup_event(c, out)) {
+        if (strcmp(out->key, key) == 0) return true;
+    }
+    return false;
+}
+
+void test_cgroups(AgentClient *c) {
+    printf("\n%s Testando eventos de cgroup...\n", TEST_INFO);
+
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    errno = 0;
+    bool ok = agent_client_watch_cgroup(c, "../etc");
+    assert_test("WATCH_CGROUP com \"..\": EINVAL", !ok && errno == EINVAL);
+    errno = 0;
+    ok = agent_client_watch_cgroup(c, "nao_existe_agent");
+    assert_test("WATCH_CGROUP de cgroup inexistente: ENOENT", !ok && errno == ENOENT);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    close(null);
+
+    const char *base = find_v2_base();
+    char cgroup[128], dir[512];
+    if (base) {
+        snprintf(cgroup, sizeof(cgroup), "%s%stest_agent_%d", base, *base ? "/" : "", getpid());
+        snprintf(dir, sizeof(dir), "%s/%s", CGROUP_ROOT, cgroup);
+    }
+    if (!base || (mkdir(dir, 0755) != 0 && errno != EEXIST)) {
+        printf("%s Sem cgroup v2 gravável: eventos de cgroup pulados\n", TEST_INFO);
+        return;
+    }
+
+    assert_test("WATCH_CGROUP", agent_client_watch_cgroup(c, cgroup));
+    assert_test("WATCH_CGROUP repetido é aceito", agent_client_watch_cgroup(c, cgroup));
+    AgentClient sub;
+    if (!connect_agent(&sub)) {
+        assert_test("Segunda conexão", false);
+        rmdir(dir);
+        return;
+    }
+    struct timeval tv = { .tv_sec = 2 };
+    setsockopt(sub.fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    assert_test("SUBSCRIBE_CGROUP", agent_client_subscribe_cgroup(&sub, cgroup));
+
+    // Processo movido para o cgroup: populated 0 -> 1
+    pid_t child = fork();
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    char pid_str[16];
+    snprintf(pid_str, sizeof(pid_str), "%d\n", child);
+    AgentCgroupEvent ev;
+    ok = write_cgroup(cgroup, "cgroup.procs", pid_str) && next_event_with_key(&sub, "populated", &ev);
+    assert_test("Evento ao vivo: populated = 1", ok && ev.value == 1 && ev.delta == 1 &&
+                ev.file == CG_EVENTS_CGROUP && strcmp(ev.path, cgroup) == 0);
+
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    ok = next_event_with_key(&sub, "populated", &ev);
+    assert_test("Término do processo: populated = 0", ok && ev.value == 0 && ev.delta == -1);
+
+    const AgentCgroupInfo *infos;
+    uint32_t count;
+    ok = agent_client_list_cgroups(c, &infos, &count);
+    assert_test("LIST_CGROUPS mostra o cgroup com assinante", ok && count == 1 && !infos[0].removed &&
+                strcmp(infos[0].path, cgroup) == 0 && infos[0].events >= 2 && infos[0].subscribers == 1);
+    const AgentCgroupEvent *events;
+    ok = agent_client_query_cgroup(c, cgroup, &events, &count);
+    assert_test("QUERY_CGROUP: histórico em ordem", ok && count >= 2 &&
+                events[count - 1].mono_ns >= events[0].mono_ns && events[count - 1].value == 0);
+
+    // rmdir: último evento da assinatura
+    ok = rmdir(dir) == 0 && next_event_with_key(&sub, "removed", &ev);
+    assert_test("rmdir entregue como \"removed\"", ok);
+    agent_client_close(&sub);
+    ok = agent_client_list_cgroups(c, &infos, &count);
+    assert_test("Cgroup removido continua consultável", ok && count == 1 && infos[0].removed &&
+                infos[0].subscribers == 0);
+
+    assert_test("UNWATCH_CGROUP", agent_client_unwatch_cgroup(c, cgroup));
+    ok = agent_client_list_cgroups(c, &infos, &count);
+    assert_test("LIST_CGROUPS vazio após UNWATCH_CGROUP", ok && count == 0);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - AGENTE RESIDENTE (SOCKET UNIX)\n");
+    printf("===============================================================\n");
+
+    snprintf(socket_path, sizeof(socket_path), "/tmp/test_agent_%d.sock", getpid());
+    pid_t agent = start_agent();
+    AgentClient client;
+    if (agent < 0 || !connect_agent(&client)) {
+        printf("%s Agente não iniciou\n", TEST_FAILED);
+        if (agent > 0) kill(agent, SIGKILL);
+        return 1;
+    }
+
+    // Executar testes
+    pid_t busy = spawn_busy();
+    test_watch_and_query(&client, busy);
+    test_errors(&client);
+    test_hangup(&client, agent);
+    test_subscribe(&client, busy);
+    test_cgroups(&client);
+
+    printf("\n%s Testando SHUTDOWN...\n", TEST_INFO);
+    assert_test("SHUTDOWN aceito", agent_client_shutdown(&client));
+    agent_client_close(&client);
+    int status = -1;
+    waitpid(agent, &status, 0);
+    assert_test("Agente terminou com sucesso", WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert_test("Socket removido", access(socket_path, F_OK) != 0);
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
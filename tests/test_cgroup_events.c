@@ -0,0 +1,295 @@
+/**
+ * test_cgroup_events.c - Teste unitário para o observador de eventos de cgroups
+ *
+ * Testa:
+ * - Registro: base sem eventos, arquivos ausentes ignorados, cgroup inexistente
+ * - populated 0 -> 1 -> 0 ao mover um processo e terminá-lo (root)
+ * - Ociosidade: nenhuma releitura sem notificação
+ * - Vários cgroups no mesmo epoll, eventos atribuídos ao cgroup certo
+ * - memory.events (oom_kill) e pids.events (max) quando os controladores existem
+ * - rmdir entregue como "removed"
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "../include/cgroup_events.h"
+#include "../include/cgroup_stats.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+#define MAX_SEEN 64
+
+typedef struct {
+    CgroupEvent ev[MAX_SEEN];
+    char keys[MAX_SEEN][CG_EVENTS_KEY_LEN];
+    int count;
+} Seen;
+
+static void record(const CgroupEvent *ev, void *ctx) {
+    Seen *s = ctx;
+    if (s->count == MAX_SEEN) return;
+    s->ev[s->count] = *ev;
+    snprintf(s->keys[s->count], CG_EVENTS_KEY_LEN, "%s", ev->key);
+    s->ev[s->count].key = s->keys[s->count];
+    s->count++;
+}
+
+// Espera (até 2 s) um evento da chave no cgroup a partir de seen->ev[from];
+// retorna o índice em seen
+static int wait_event(CgroupWatcher *w, Seen *seen, int from, int cgroup, const char *key) {
+    uint64_t deadline = monotonic_ns() + 2 * NSEC_PER_SEC;
+    while (monotonic_ns() < deadline) {
+        for (int i = from; i < seen->count; i++) {
+            if (seen->ev[i].cgroup == cgroup && strcmp(seen->ev[i].key, key) == 0) return i;
+        }
+        from = seen->count;
+        cgroup_watcher_wait(w, 100);
+    }
+    return -1;
+}
+
+// Diretório pai com cgroup v2 (relativo a CGROUP_ROOT): a raiz ou a
+// hierarquia "unified" dos sistemas híbridos
+static const char *find_v2_base(void) {
+    static const char *const bases[] = { "", "unified" };
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]); i++) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s/cgroup.controllers", CGROUP_ROOT, bases[i]);
+        if (access(path, R_OK) == 0) return bases[i];
+    }
+    return NULL;
+}
+
+static bool write_cgroup(const char *cgroup, const char *file, const char *value) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s/%s", CGROUP_ROOT, cgroup, file);
+    FILE *f = fopen(path, "w");
+    if (!f) return false;
+    bool ok = fputs(value, f) >= 0;
+    return fclose(f) == 0 && ok;
+}
+
+static bool make_cgroup(char *out, size_t size, const char *base, const char *name) {
+    snprintf(out, size, "%s%s%s_%d", base, *base ? "/" : "", name, getpid());
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", CGROUP_ROOT, out);
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+static void remove_cgroup(const char *cgroup) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", CGROUP_ROOT, cgroup);
+    rmdir(path);
+}
+
+// Filho parado dentro do cgroup; t0 recebe o fim da escrita em cgroup.procs
+// (a migração em si leva milissegundos: synchronize_rcu do cgroup)
+static pid_t spawn_in(const char *cgroup, uint64_t *t0) {
+    pid_t child = fork();
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    char pid[16];
+    snprintf(pid, sizeof(pid), "%d\n", child);
+    if (!write_cgroup(cgroup, "cgroup.procs", pid)) {
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+        return -1;
+    }
+    *t0 = monotonic_ns();
+    return child;
+}
+
+void test_register(void) {
+    printf("\n=== Teste 1: Registro ===\n");
+
+    assert_test("Nomes dos arquivos", strcmp(cgroup_event_file_name(CG_EVENTS_MEMORY), "memory.events") == 0 &&
+                strcmp(cgroup_event_file_name(CG_EVENTS_PIDS), "pids.events") == 0);
+
+    CgroupWatcher w;
+    assert_test("cgroup_watcher_init", cgroup_watcher_init(&w, NULL, NULL));
+    // Mensagem de erro esperada descartada
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    int bad = cgroup_watcher_add(&w, "nao_existe_cgroup_events");
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    close(null);
+    assert_test("Cgroup inexistente: -1", bad == -1 && w.count == 0);
+    assert_test("Sem cgroups: espera não bloqueante vazia", cgroup_watcher_dispatch(&w) == 0 && w.wakeups == 0);
+    cgroup_watcher_close(&w);
+}
+
+void test_populated(const char *base) {
+    printf("\n=== Teste 2: populated e ociosidade ===\n");
+
+    char a[128], b[128];
+    if (!make_cgroup(a, sizeof(a), base, "test_cg_events_a") || !make_cgroup(b, sizeof(b), base, "test_cg_events_b")) {
+        printf("%s Não foi possível criar cgroups em %s/%s: %s\n", TEST_INFO, CGROUP_ROOT, base, strerror(errno));
+        remove_cgroup(a);
+        return;
+    }
+
+    Seen seen = { .count = 0 };
+    CgroupWatcher w;
+    cgroup_watcher_init(&w, record, &seen);
+    int ia = cgroup_watcher_add(&w, a);
+    int ib = cgroup_watcher_add(&w, b);
+    uint64_t populated = 1;
+    assert_test("Dois cgroups registrados; base populated 0",
+                ia == 0 && ib == 1 && cgroup_watcher_value(&w, ia, CG_EVENTS_CGROUP, "populated", &populated) &&
+                populated == 0);
+    uint64_t unused;
+    assert_test("Chave inexistente: false", !cgroup_watcher_value(&w, ia, CG_EVENTS_CGROUP, "nada", &unused));
+    assert_test("Base não gera eventos", cgroup_watcher_dispatch(&w) == 0 && seen.count == 0);
+
+    uint64_t t0;
+    pid_t child = spawn_in(b, &t0);
+    int i = child > 0 ? wait_event(&w, &seen, 0, ib, "populated") : -1;
+    assert_test("populated 0 -> 1 no cgroup certo", i >= 0 && seen.ev[i].value == 1 && seen.ev[i].delta == 1 &&
+                seen.ev[i].file == CG_EVENTS_CGROUP && strcmp(seen.ev[i].path, b) == 0);
+    if (i >= 0) {
+        printf("%s Latência da notificação (fim da escrita em cgroup.procs -> evento): %.1f us\n", TEST_INFO,
+               (double)(seen.ev[i].mono_ns - t0) / NSEC_PER_USEC);
+    }
+    bool only_b = true;
+    for (int k = 0; k < seen.count; k++) only_b = only_b && seen.ev[k].cgroup == ib;
+    assert_test("Nenhum evento no outro cgroup", only_b);
+
+    // Ociosidade: sem notificações, nenhum arquivo é relido
+    uint64_t reads = w.reads;
+    assert_test("Ocioso: espera sem eventos nem releituras", cgroup_watcher_wait(&w, 50) == 0 && w.reads == reads);
+
+    int before = seen.count;
+    if (child > 0) {
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+    }
+    i = wait_event(&w, &seen, before, ib, "populated");
+    assert_test("populated 1 -> 0 ao terminar (delta -1)", i >= before && seen.ev[i].value == 0 &&
+                seen.ev[i].delta == -1 && cgroup_watcher_value(&w, ib, CG_EVENTS_CGROUP, "populated", &populated) &&
+                populated == 0);
+
+    remove_cgroup(b);
+    i = wait_event(&w, &seen, 0, ib, "removed");
+    assert_test("rmdir entregue como \"removed\"", i >= 0 && !w.cgroups[ib].active && w.cgroups[ia].active);
+
+    cgroup_watcher_close(&w);
+    remove_cgroup(a);
+}
+
+void test_memory_pids(const char *base) {
+    printf("\n=== Teste 3: memory.events e pids.events ===\n");
+
+    char cg[128];
+    if (!make_cgroup(cg, sizeof(cg), base, "test_cg_events_m")) {
+        printf("%s Não foi possível criar o cgroup: %s\n", TEST_INFO, strerror(errno));
+        return;
+    }
+    Seen seen = { .count = 0 };
+    CgroupWatcher w;
+    cgroup_watcher_init(&w, record, &seen);
+    int id = cgroup_watcher_add(&w, cg);
+    bool memory = id >= 0 && w.cgroups[id].files[CG_EVENTS_MEMORY].fd >= 0;
+    bool pids = id >= 0 && w.cgroups[id].files[CG_EVENTS_PIDS].fd >= 0;
+
+    if (!memory) {
+        printf("%s memory.events ausente (controlador memory fora do cgroup v2): teste pulado\n", TEST_INFO);
+    } else if (write_cgroup(cg, "memory.max", "8388608\n")) {
+        write_cgroup(cg, "memory.swap.max", "0\n");
+        pid_t child = fork();
+        if (child == 0) {
+            char pid[16];
+            snprintf(pid, sizeof(pid), "%d\n", getpid());
+            if (!write_cgroup(cg, "cgroup.procs", pid)) _exit(1);
+            size_t size = 64UL << 20;
+            char *mem = malloc(size);
+            for (size_t j = 0; mem && j < size; j += 4096) mem[j] = 1;
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        int i = wait_event(&w, &seen, 0, id, "oom_kill");
+        assert_test("oom_kill ao estourar memory.max", i >= 0 && seen.ev[i].delta >= 1 &&
+                    seen.ev[i].file == CG_EVENTS_MEMORY);
+        assert_test("max registrado antes do OOM", wait_event(&w, &seen, 0, id, "max") >= 0);
+    }
+
+    if (!pids) {
+        printf("%s pids.events ausente (controlador pids fora do cgroup v2): teste pulado\n", TEST_INFO);
+    } else if (write_cgroup(cg, "pids.max", "1\n")) {
+        pid_t child = fork();
+        if (child == 0) {
+            char pid[16];
+            snprintf(pid, sizeof(pid), "%d\n", getpid());
+            if (!write_cgroup(cg, "cgroup.procs", pid)) _exit(1);
+            pid_t grandchild = fork();      // negado pelo pids.max
+            if (grandchild == 0) _exit(0);
+            _exit(grandchild < 0 ? 0 : 1);
+        }
+        waitpid(child, NULL, 0);
+        int i = wait_event(&w, &seen, 0, id, "max");
+        assert_test("pids max ao negar o fork", i >= 0 && seen.ev[i].file == CG_EVENTS_PIDS && seen.ev[i].delta == 1);
+    }
+
+    cgroup_watcher_close(&w);
+    remove_cgroup(cg);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - EVENTOS DE CGROUPS\n");
+    printf("===============================================================\n");
+
+    test_register();
+
+    const char *base = find_v2_base();
+    if (geteuid() != 0 || !base) {
+        printf("%s Sem root ou sem cgroup v2: testes de eventos pulados\n", TEST_INFO);
+    } else {
+        printf("%s cgroup v2 em %s/%s\n", TEST_INFO, CGROUP_ROOT, base);
+        test_populated(base);
+        test_memory_pids(base);
+    }
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,449 @@
+/**
+ * test_http_exporter.c - Teste unitário para o endpoint Prometheus
+ *
+ * Testa:
+ * - GET/HEAD /metrics, 503 antes da primeira renderização, 404 e 405
+ * - Keep-alive, pipelining e HTTP/1.0 (fecha a conexão)
+ * - Vários clientes simultâneos recebendo o mesmo corpo
+ * - Resposta em andamento mantém o corpo antigo após um novo commit
+ * - Socket Unix, escape de rótulos e formatação dos valores
+ * - Agente com --http servindo as amostras de um processo observado
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <math.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../include/http_exporter.h"
+#include "../include/agent.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define CLIENTS   32
+#define BIG_BODY  (4 * 1024 * 1024)
+#define RESP_MAX  (BIG_BODY + 4096)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+static char *resp;              // resposta da última busca (RESP_MAX bytes)
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+static int connect_tcp(int port) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port) };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int connect_unix(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Espera até timeout_ms por trabalho no exportador e o atende
+static void pump(HttpExporter *h, int timeout_ms) {
+    struct pollfd p = { .fd = http_exporter_fd(h), .events = POLLIN };
+    if (poll(&p, 1, timeout_ms) > 0) http_exporter_dispatch(h);
+}
+
+// Tamanho total da resposta em buf (cabeçalho + Content-Length), 0 se
+// o cabeçalho ainda não chegou
+static size_t response_size(const char *buf, size_t len, bool head_only) {
+    const char *end = memmem(buf, len, "\r\n\r\n", 4);
+    if (!end) return 0;
+    size_t head = (size_t)(end - buf) + 4;
+    const char *cl = strcasestr(buf, "Content-Length:");
+    return head + ((cl && cl < end && !head_only) ? strtoul(cl + 15, NULL, 10) : 0);
+}
+
+// count respostas completas em buf?
+static bool responses_complete(const char *buf, size_t len, int count, bool head_only) {
+    size_t off = 0;
+    for (int i = 0; i < count; i++) {
+        size_t size = response_size(buf + off, len - off, head_only);
+        if (size == 0 || off + size > len) return false;
+        off += size;
+    }
+    return true;
+}
+
+// Lê count respostas completas (ou até o EOF), atendendo o exportador no
+// meio. h NULL: o servidor é outro processo.
+static size_t read_responses(HttpExporter *h, int fd, bool head_only, int count, bool *eof) {
+    size_t len = 0;
+    bool done = false;
+    *eof = false;
+    uint64_t deadline = monotonic_ns() + 5 * NSEC_PER_SEC;
+    while (!done && monotonic_ns() < deadline) {
+        if (h) pump(h, 1);
+        ssize_t n = recv(fd, resp + len, RESP_MAX - 1 - len, h ? MSG_DONTWAIT : 0);
+        if (n == 0) {
+            *eof = true;
+            break;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EINTR) continue;
+            break;
+        }
+        len += (size_t)n;
+        resp[len] = '\0';
+        done = responses_complete(resp, len, count, head_only);
+    }
+    resp[len] = '\0';
+    return len;
+}
+
+static size_t read_response(HttpExporter *h, int fd, bool head_only, bool *eof) {
+    return read_responses(h, fd, head_only, 1, eof);
+}
+
+static size_t fetch(HttpExporter *h, int fd, const char *request, bool *eof) {
+    send(fd, request, strlen(request), MSG_NOSIGNAL);
+    return read_response(h, fd, strncmp(request, "HEAD", 4) == 0, eof);
+}
+
+// Conexão fechada pelo servidor (sem dados extras) dentro de 1s?
+static bool wait_eof(HttpExporter *h, int fd) {
+    char byte;
+    uint64_t deadline = monotonic_ns() + NSEC_PER_SEC;
+    while (monotonic_ns() < deadline) {
+        pump(h, 1);
+        ssize_t n = recv(fd, &byte, 1, MSG_DONTWAIT);
+        if (n == 0) return true;
+        if (n > 0 || (errno != EAGAIN && errno != EINTR)) return false;
+    }
+    return false;
+}
+
+static const char *body_of(const char *r) {
+    const char *end = strstr(r, "\r\n\r\n");
+    return end ? end + 4 : "";
+}
+
+static void publish(HttpExporter *h, const char *text) {
+    OutBuf *o = http_exporter_begin(h);
+    if (o) out_write(o, text, strlen(text));
+    http_exporter_commit(h);
+}
+
+void test_basic(HttpExporter *h, int port) {
+    printf("\n%s Testando respostas básicas...\n", TEST_INFO);
+    bool eof;
+
+    int fd = connect_tcp(port);
+    fetch(h, fd, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n", &eof);
+    assert_test("503 antes da primeira renderização", strncmp(resp, "HTTP/1.1 503", 12) == 0);
+
+    publish(h, "# TYPE a gauge\na 1\n");
+    fetch(h, fd, "GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n", &eof);
+    assert_test("GET /metrics: 200 com o corpo publicado",
+                strncmp(resp, "HTTP/1.1 200", 12) == 0 && strcmp(body_of(resp), "# TYPE a gauge\na 1\n") == 0);
+    assert_test("Content-Type do formato de exposição", strstr(resp, "Content-Type: " HTTP_CONTENT_TYPE) != NULL);
+    assert_test("Keep-alive: conexão reaproveitada", !eof && strstr(resp, "Connection: keep-alive") != NULL);
+
+    fetch(h, fd, "GET /metrics?x=1 HTTP/1.1\r\n\r\n", &eof);
+    assert_test("Query string ignorada", strcmp(body_of(resp), "# TYPE a gauge\na 1\n") == 0);
+
+    fetch(h, fd, "HEAD /metrics HTTP/1.1\r\n\r\n", &eof);
+    assert_test("HEAD: cabeçalhos sem corpo", strstr(resp, "Content-Length: 19\r\n") != NULL && *body_of(resp) == '\0');
+
+    fetch(h, fd, "GET /nada HTTP/1.1\r\n\r\n", &eof);
+    assert_test("Caminho desconhecido: 404", strncmp(resp, "HTTP/1.1 404", 12) == 0 && !eof);
+
+    // Duas requisições num único envio
+    send(fd, "GET / HTTP/1.1\r\n\r\nGET /metrics HTTP/1.1\r\n\r\n", 43, MSG_NOSIGNAL);
+    size_t len = read_responses(h, fd, false, 2, &eof);
+    size_t first = response_size(resp, len, false);
+    assert_test("Pipelining: duas respostas em ordem",
+                first > 0 && first < len && strstr(resp, "métricas em /metrics") != NULL &&
+                strcmp(body_of(resp + first), "# TYPE a gauge\na 1\n") == 0);
+
+    fetch(h, fd, "POST /metrics HTTP/1.1\r\nContent-Length: 0\r\n\r\n", &eof);
+    assert_test("POST: 405 e conexão fechada", strncmp(resp, "HTTP/1.1 405", 12) == 0 && (eof || wait_eof(h, fd)));
+    close(fd);
+
+    fd = connect_tcp(port);
+    fetch(h, fd, "GET /metrics HTTP/1.0\r\n\r\n", &eof);
+    assert_test("HTTP/1.0: Connection: close",
+                strstr(resp, "Connection: close") != NULL && (eof || wait_eof(h, fd)));
+    close(fd);
+
+    fd = connect_tcp(port);
+    fetch(h, fd, "lixo\r\n\r\n", &eof);
+    assert_test("Requisição malformada: 400", strncmp(resp, "HTTP/1.1 400", 12) == 0);
+    close(fd);
+}
+
+void test_concurrent(HttpExporter *h, int port) {
+    printf("\n%s Testando %d clientes simultâneos...\n", TEST_INFO, CLIENTS);
+
+    char body[8192];
+    size_t len = 0;
+    for (int i = 0; len < sizeof(body) - 64; i++) {
+        len += (size_t)snprintf(body + len, sizeof(body) - len, "serie{i=\"%d\"} %d\n", i, i * 7);
+    }
+    publish(h, body);
+    uint64_t scrapes = h->scrapes;
+    uint64_t renders = h->renders;
+
+    int fds[CLIENTS];
+    for (int i = 0; i < CLIENTS; i++) {
+        fds[i] = connect_tcp(port);
+        send(fds[i], "GET /metrics HTTP/1.1\r\n\r\n", 25, MSG_NOSIGNAL);
+    }
+    int ok = 0;
+    bool eof;
+    for (int i = 0; i < CLIENTS; i++) {
+        read_response(h, fds[i], false, &eof);
+        if (strcmp(body_of(resp), body) == 0) ok++;
+        close(fds[i]);
+    }
+    assert_test("Todos recebem o corpo inteiro", ok == CLIENTS);
+    assert_test("Contador de raspagens", h->scrapes - scrapes == CLIENTS);
+    assert_test("Nenhuma renderização extra por raspagem", h->renders == renders);
+}
+
+void test_inflight(HttpExporter *h, int port) {
+    printf("\n%s Testando troca de corpo com resposta em andamento...\n", TEST_INFO);
+
+    char *big = malloc(BIG_BODY + 1);
+    memset(big, 'A', BIG_BODY);
+    big[BIG_BODY] = '\0';
+    publish(h, big);
+
+    // O cliente não lê: a resposta para com o buffer do socket cheio
+    int fd = connect_tcp(port);
+    send(fd, "GET /metrics HTTP/1.1\r\n\r\n", 25, MSG_NOSIGNAL);
+    for (int i = 0; i < 20; i++) pump(h, 5);
+
+    memset(big, 'B', BIG_BODY);
+    publish(h, big);
+
+    bool eof;
+    size_t len = read_response(h, fd, false, &eof);
+    const char *b = body_of(resp);
+    size_t body_len = len - (size_t)(b - resp);
+    bool all_a = body_len == BIG_BODY;
+    for (size_t i = 0; all_a && i < body_len; i++) all_a = b[i] == 'A';
+    assert_test("Resposta em andamento termina com o corpo antigo", all_a);
+
+    fetch(h, fd, "GET /metrics HTTP/1.1\r\n\r\n", &eof);
+    b = body_of(resp);
+    assert_test("Requisição seguinte recebe o corpo novo", b[0] == 'B' && b[BIG_BODY - 1] == 'B');
+    close(fd);
+    free(big);
+}
+
+void test_unix_socket(void) {
+    printf("\n%s Testando socket Unix...\n", TEST_INFO);
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_http_%d.sock", getpid());
+    HttpExporter h;
+    if (!http_exporter_open(&h, path)) {
+        assert_test("Escuta em socket Unix", false);
+        return;
+    }
+    publish(&h, "u 1\n");
+    int fd = connect_unix(path);
+    bool eof;
+    fetch(&h, fd, "GET /metrics HTTP/1.1\r\n\r\n", &eof);
+    assert_test("GET /metrics pelo socket Unix", strcmp(body_of(resp), "u 1\n") == 0);
+    close(fd);
+
+    HttpExporter other;
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    bool second = http_exporter_open(&other, path);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    close(null);
+    assert_test("Segundo exportador no mesmo caminho é recusado", !second);
+
+    http_exporter_close(&h);
+    assert_test("Socket removido no close", access(path, F_OK) != 0);
+}
+
+void test_format(void) {
+    printf("\n%s Testando o formato de exposição...\n", TEST_INFO);
+
+    char labels[64] = "";
+    bool ok = expo_label(labels, sizeof(labels), "pid", "42") &&
+              expo_label(labels, sizeof(labels), "comm", "a\"b\\c\nd");
+    assert_test("Rótulos escapados", ok && strcmp(labels, "pid=\"42\",comm=\"a\\\"b\\\\c\\nd\"") == 0);
+
+    char small[16] = "";
+    ok = expo_label(small, sizeof(small), "comm", "nome-muito-comprido");
+    assert_test("Rótulo que não cabe é recusado", !ok && small[0] == '\0');
+
+    char text[512];
+    int fd = memfd_create("expo", 0);
+    OutBuf o;
+    out_init(&o, fd, NULL, 4096);
+    expo_family(&o, "m", "gauge", "Ajuda.");
+    expo_value(&o, "m", labels, "mode=\"user\"", 1.5, 2);
+    expo_value(&o, "m", NULL, NULL, INFINITY, 0);
+    expo_value_u64(&o, "m", "", "k=\"v\"", 18446744073709551615ULL);
+    out_close(&o);
+    ssize_t n = pread(fd, text, sizeof(text) - 1, 0);
+    text[n > 0 ? n : 0] = '\0';
+    close(fd);
+    assert_test("Família, séries e +Inf",
+                strcmp(text, "# HELP m Ajuda.\n# TYPE m gauge\n"
+                             "m{pid=\"42\",comm=\"a\\\"b\\\\c\\nd\",mode=\"user\"} 1.50\n"
+                             "m +Inf\n"
+                             "m{k=\"v\"} 18446744073709551615\n") == 0);
+}
+
+void test_agent_endpoint(void) {
+    printf("\n%s Testando o agente com --http...\n", TEST_INFO);
+
+    char sock[64], http[64];
+    snprintf(sock, sizeof(sock), "/tmp/test_http_agent_%d.sock", getpid());
+    snprintf(http, sizeof(http), "/tmp/test_http_agent_%d.http", getpid());
+
+    pid_t busy = fork();
+    if (busy == 0) {
+        volatile unsigned long x = 0;
+        for (;;) x++;
+    }
+    pid_t agent = fork();
+    if (agent == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        AgentConfig cfg = {
+            .socket_path = sock,
+            .retention = 16,
+            .http_address = http,
+            .refresh_ns = 20 * NSEC_PER_MSEC,
+            .cgroups = { "nao-existe" },
+            .num_cgroups = 1,
+        };
+        _exit(agent_run(&cfg) ? 0 : 1);
+    }
+
+    AgentClient c;
+    bool connected = false;
+    int saved = dup(STDERR_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    for (int i = 0; i < 200 && !connected; i++) {
+        connected = agent_client_connect(&c, sock);
+        if (!connected) usleep(5000);
+    }
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+    close(null);
+
+    bool watched = connected && agent_client_watch(&c, busy, 10 * NSEC_PER_MSEC);
+    assert_test("Agente com endpoint HTTP aceita WATCH", watched);
+    usleep(300000);
+
+    char series[128];
+    snprintf(series, sizeof(series), "resmon_process_cpu_percent{pid=\"%d\",comm=\"", busy);
+    int fd = connect_unix(http);
+    bool eof;
+    fetch(NULL, fd, "GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n", &eof);
+    close(fd);
+    const char *line = strstr(resp, series);
+    const char *value = line ? strstr(line, "} ") : NULL;
+    assert_test("Série de CPU do processo observado", value && strtod(value + 2, NULL) > 50.0);
+    snprintf(series, sizeof(series), "resmon_process_up{pid=\"%d\",comm=\"", busy);
+    line = strstr(resp, series);
+    assert_test("resmon_process_up do processo", line && strncmp(strstr(line, "} "), "} 1\n", 4) == 0);
+    assert_test("cgroup inexistente: resmon_cgroup_up 0",
+                strstr(resp, "resmon_cgroup_up{cgroup=\"nao-existe\"} 0\n") != NULL &&
+                strstr(resp, "resmon_cgroup_memory_current_bytes{") == NULL);
+    const char *renders = strstr(resp, "\nresmon_exporter_renders_total ");
+    assert_test("Corpo renderizado pelo temporizador", renders && strtoul(renders + 31, NULL, 10) >= 5);
+
+    kill(busy, SIGKILL);
+    waitpid(busy, NULL, 0);
+    if (connected) {
+        agent_client_shutdown(&c);
+        agent_client_close(&c);
+    }
+    int status = -1;
+    waitpid(agent, &status, 0);
+    assert_test("Agente encerra e remove o socket HTTP",
+                WIFEXITED(status) && WEXITSTATUS(status) == 0 && access(http, F_OK) != 0);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - ENDPOINT PROMETHEUS (HTTP)\n");
+    printf("===============================================================\n");
+
+    resp = malloc(RESP_MAX);
+    HttpExporter h;
+    if (!resp || !http_exporter_open(&h, "127.0.0.1:0")) {
+        printf("%s Exportador não abriu\n", TEST_FAILED);
+        return 1;
+    }
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    getsockname(h.listen_fd, (struct sockaddr *)&addr, &addr_len);
+    int port = ntohs(addr.sin_port);
+    printf("%s Escutando em 127.0.0.1:%d\n", TEST_INFO, port);
+
+    // Executar testes
+    test_basic(&h, port);
+    test_concurrent(&h, port);
+    test_inflight(&h, port);
+    http_exporter_close(&h);
+    test_unix_socket();
+    test_format();
+    test_agent_endpoint();
+    free(resp);
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
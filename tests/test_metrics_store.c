@@ -0,0 +1,271 @@
+/**
+ * test_metrics_store.c - Teste unitário para o histórico colunar de métricas
+ *
+ * Testa:
+ * - Ida e volta de uma amostra pelas colunas (nenhum campo perdido)
+ * - Internação de nomes de processo (um id por PID + nome)
+ * - Agregados: mín, máx, média e percentis
+ * - Memória por amostra menor que a linha ProcessMetrics
+ * - Agregados com produtor concorrente (sem valores rasgados)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "../include/metrics_store.h"
+#include "../include/process_monitor.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+void test_round_trip() {
+    printf("\n=== Teste 1: Amostra remontada das colunas ===\n");
+
+    MetricsHistory *h = create_metrics_history(8);
+    assert_test("Histórico criado", h != NULL);
+    if (!h) return;
+
+    ProcessMetrics in;
+    memset(&in, 0, sizeof(in));
+    in.pid = 4242;
+    strcpy(in.process_name, "postgres");
+    in.mono_ns = 123456789ULL;
+    in.real_ns = 1700000000ULL * 1000000000ULL + 5;
+    in.timestamp = 1700000000;
+    in.cpu_user_time = 300;
+    in.cpu_system_time = 45;
+    in.cpu_total_time = 345;
+    in.num_threads = 17;
+    in.voluntary_ctx_switches = 1000;
+    in.nonvoluntary_ctx_switches = 20;
+    in.mem_vsize = 1L << 33;
+    in.mem_rss = 123 * 4096L;
+    in.mem_shared = 7 * 4096L;
+    in.page_faults_minor = 555;
+    in.page_faults_major = 3;
+    in.mem_swap = 64;
+    in.io_read_bytes = 1ULL << 40;
+    in.io_write_bytes = 99999;
+    in.io_cancelled_write_bytes = 12;
+    in.io_read_syscalls = 77;
+    in.io_write_syscalls = 88;
+    in.net_rx_bytes = 1000;
+    in.net_tx_bytes = 2000;
+    in.net_rx_packets = 10;
+    in.net_tx_packets = 20;
+    in.net_connections = 5;
+    add_metrics_sample(h, &in);
+
+    ProcessMetrics out;
+    assert_test("Leitura da amostra", metrics_history_read(h, 0, &out));
+    assert_test("PID e nome recuperados do dicionário",
+                out.pid == 4242 && strcmp(out.process_name, "postgres") == 0);
+    assert_test("Relógios preservados",
+                out.mono_ns == in.mono_ns && out.real_ns == in.real_ns && out.timestamp == in.timestamp);
+    assert_test("CPU preservada (total = user + system)",
+                out.cpu_user_time == 300 && out.cpu_system_time == 45 && out.cpu_total_time == 345 &&
+                out.num_threads == 17 && out.voluntary_ctx_switches == 1000 &&
+                out.nonvoluntary_ctx_switches == 20);
+    assert_test("Memória preservada",
+                out.mem_vsize == in.mem_vsize && out.mem_rss == in.mem_rss &&
+                out.mem_shared == in.mem_shared && out.page_faults_minor == 555 &&
+                out.page_faults_major == 3 && out.mem_swap == 64);
+    assert_test("I/O preservado",
+                out.io_read_bytes == in.io_read_bytes && out.io_write_bytes == 99999 &&
+                out.io_cancelled_write_bytes == 12 && out.io_read_syscalls == 77 &&
+                out.io_write_syscalls == 88);
+    assert_test("Rede preservada",
+                out.net_rx_bytes == 1000 && out.net_tx_bytes == 2000 && out.net_rx_packets == 10 &&
+                out.net_tx_packets == 20 && out.net_connections == 5);
+
+    free_metrics_history(h);
+}
+
+void test_entity_interning() {
+    printf("\n=== Teste 2: Internação de nomes ===\n");
+
+    MetricsStore s;
+    assert_test("Store criado", metrics_store_init(&s, 4));
+
+    uint32_t a = entity_intern(&s.entities, 1, "init");
+    uint32_t b = entity_intern(&s.entities, 2, "bash");
+    uint32_t a2 = entity_intern(&s.entities, 1, "init");
+    uint32_t c = entity_intern(&s.entities, 1, "exec-novo");
+    assert_test("Mesmo PID + nome reutiliza o id", a == a2);
+    assert_test("PIDs ou nomes diferentes geram ids distintos", a != b && a != c && b != c);
+
+    // Força crescimento do índice e vários blocos do dicionário
+    bool ok = true;
+    char name[32];
+    for (int pid = 100; pid < 100 + 3 * ENTITY_CHUNK_SIZE; pid++) {
+        snprintf(name, sizeof(name), "worker-%d", pid);
+        uint32_t id = entity_intern(&s.entities, pid, name);
+        const EntityName *e = entity_get(&s.entities, id);
+        if (!e || e->pid != pid || strcmp(e->name, name) != 0) ok = false;
+    }
+    assert_test("Entradas estáveis através de vários blocos", ok);
+    assert_test("Ids antigos continuam válidos",
+                strcmp(entity_get(&s.entities, b)->name, "bash") == 0 &&
+                entity_intern(&s.entities, 2, "bash") == b);
+    assert_test("Id inexistente rejeitado", entity_get(&s.entities, 1u << 20) == NULL);
+
+    // Churn de threads: mais entradas que os 65536 do antigo limite fixo
+    ok = true;
+    for (int tid = 10000; tid < 10000 + 70000; tid++) {
+        uint32_t id = entity_intern(&s.entities, tid, "thread");
+        const EntityName *e = entity_get(&s.entities, id);
+        if (id == ENTITY_INVALID || !e || e->pid != tid) ok = false;
+    }
+    assert_test("Mais de 65536 entidades sem descartes", ok && s.entities.dropped == 0 &&
+                atomic_load(&s.entities.count) > 70000);
+    assert_test("Primeiras entradas intactas após o crescimento",
+                strcmp(entity_get(&s.entities, a)->name, "init") == 0 &&
+                entity_intern(&s.entities, 150, "worker-150") != ENTITY_INVALID &&
+                entity_get(&s.entities, entity_intern(&s.entities, 150, "worker-150"))->pid == 150);
+
+    metrics_store_free(&s);
+}
+
+void test_stats() {
+    printf("\n=== Teste 3: Agregados ===\n");
+
+    MetricsHistory *h = create_metrics_history(128);
+    if (!h) {
+        assert_test("Histórico criado", 0);
+        return;
+    }
+
+    MetricStats st;
+    assert_test("Histórico vazio sem agregados", !metrics_history_stats(h, METRIC_MEM_RSS, &st));
+
+    // Valores 1..100 fora de ordem
+    for (int i = 0; i < 100; i++) {
+        ProcessMetrics m;
+        memset(&m, 0, sizeof(m));
+        m.pid = 1;
+        m.mem_rss = ((i * 37) % 100) + 1;
+        m.num_threads = 4;
+        add_metrics_sample(h, &m);
+    }
+
+    assert_test("Contagem", metrics_history_stats(h, METRIC_MEM_RSS, &st) && st.count == 100);
+    assert_test("Mínimo e máximo", st.min == 1.0 && st.max == 100.0);
+    assert_test("Média", fabs(st.avg - 50.5) < 1e-9);
+    assert_test("p50 / p95 / p99", st.p50 == 50.0 && st.p95 == 95.0 && st.p99 == 99.0);
+    assert_test("Série constante",
+                metrics_history_stats(h, METRIC_THREADS, &st) && st.min == 4.0 && st.max == 4.0);
+
+    // Depois de dar a volta, só a janela retida entra nos agregados
+    for (int i = 0; i < 128; i++) {
+        ProcessMetrics m;
+        memset(&m, 0, sizeof(m));
+        m.mem_rss = 1000 + i;
+        add_metrics_sample(h, &m);
+    }
+    assert_test("Somente a janela retida",
+                metrics_history_stats(h, METRIC_MEM_RSS, &st) && st.count == 128 &&
+                st.min == 1000.0 && st.max == 1127.0);
+
+    free_metrics_history(h);
+}
+
+void test_memory_per_sample() {
+    printf("\n=== Teste 4: Memória por amostra ===\n");
+
+    size_t row = metrics_store_row_bytes();
+    size_t old_row = sizeof(ProcessMetrics) + sizeof(uint64_t);
+    printf("%s colunar: %zu bytes/amostra, linha ProcessMetrics + seqlock: %zu bytes (%.1fx)\n",
+           TEST_INFO, row, old_row, (double)old_row / (double)row);
+    assert_test("Layout colunar menor que a linha completa", row < old_row);
+}
+
+// Produtor escreve rss sempre em [1, 1000]: um agregado calculado sobre
+// linhas lidas fora da janela ou em escrita sairia da faixa
+#define STRESS_SAMPLES 1000000
+
+static MetricsHistory *stress_history;
+static atomic_int producer_done = 0;
+
+static void *producer(void *arg) {
+    (void)arg;
+    for (int i = 0; i < STRESS_SAMPLES; i++) {
+        ProcessMetrics m;
+        memset(&m, 0, sizeof(m));
+        m.pid = 7;
+        strcpy(m.process_name, "stress");
+        m.mem_rss = (long)(i % 1000) + 1;
+        add_metrics_sample(stress_history, &m);
+    }
+    atomic_store(&producer_done, 1);
+    return NULL;
+}
+
+void test_concurrent_stats() {
+    printf("\n=== Teste 5: Agregados com produtor concorrente ===\n");
+
+    stress_history = create_metrics_history(256);
+    pthread_t prod;
+    pthread_create(&prod, NULL, producer, NULL);
+
+    unsigned long passes = 0, bad = 0;
+    while (!atomic_load(&producer_done)) {
+        MetricStats st;
+        if (!metrics_history_stats(stress_history, METRIC_MEM_RSS, &st)) continue;
+        passes++;
+        if (st.count > 256 || st.min < 1.0 || st.max > 1000.0 ||
+            st.p50 < st.min || st.p99 > st.max) {
+            bad++;
+        }
+    }
+    pthread_join(prod, NULL);
+
+    printf("%s %lu agregados calculados durante a escrita\n", TEST_INFO, passes);
+    assert_test("Nenhum agregado inconsistente", bad == 0);
+    assert_test("Produtor publicou tudo", metrics_history_head(stress_history) == STRESS_SAMPLES);
+
+    free_metrics_history(stress_history);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - HISTÓRICO COLUNAR DE MÉTRICAS\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_round_trip();
+    test_entity_interning();
+    test_stats();
+    test_memory_per_sample();
+    test_concurrent_stats();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
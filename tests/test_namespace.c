@@ -5,6 +5,9 @@
  * - Listagem de namespaces de um processo
  * - Comparação de namespaces entre processos
  * - Leitura de inode de namespaces
+ * - get_process_namespaces relativo a /proc aberto (fstatat/readlinkat)
+ * - Relatório do sistema: resultado igual com 1 e com várias threads
+ * - NsReport: chave (tipo, inode), ordem dos PIDs, crescimento, junção e JSON
  */
 
 #include <stdio.h>
@@ -14,6 +17,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
 #include "../include/namespace.h"
 
 #define TEST_PASSED "\033[0;32m[PASS]\033[0m"
@@ -166,6 +172,193 @@ void test_namespace_stat_inode() {
     }
 }
 
+void test_get_process_namespaces() {
+    printf("\n=== Teste 6: get_process_namespaces (absoluto e relativo a /proc) ===\n");
+
+    NamespaceInfo ns[10], ns_at[10];
+    int count = get_process_namespaces(getpid(), ns, 10);
+    int proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    int count_at = get_process_namespaces_at(proc_fd, getpid(), ns_at, 10);
+    printf("%s %d namespaces no PID %d\n", TEST_INFO, count, getpid());
+    assert_test("Namespaces do próprio processo (>= 7)", count >= 7);
+
+    struct stat st;
+    int net_ok = 0;
+    stat("/proc/self/ns/net", &st);
+    for (int i = 0; i < count; i++) {
+        char expected[64];
+        snprintf(expected, sizeof(expected), "net:[%lu]", (unsigned long)st.st_ino);
+        if (strcmp(ns[i].type, "net") == 0) net_ok = ns[i].inode == st.st_ino && strcmp(ns[i].path, expected) == 0;
+    }
+    assert_test("Inode e link do namespace net conferem com stat/readlink", net_ok);
+
+    int same = count == count_at;
+    for (int i = 0; same && i < count; i++) {
+        same = strcmp(ns[i].type, ns_at[i].type) == 0 && ns[i].inode == ns_at[i].inode &&
+               strcmp(ns[i].path, ns_at[i].path) == 0;
+    }
+    assert_test("Versão relativa a /proc aberto dá o mesmo resultado", same);
+    assert_test("PID inexistente: -1", get_process_namespaces_at(proc_fd, 0x3ffffff0, ns, 10) == -1);
+    close(proc_fd);
+}
+
+static char *read_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+    char *buf = malloc(size + 1);
+    size_t n = buf ? fread(buf, 1, size, f) : 0;
+    if (buf) buf[n] = '\0';
+    fclose(f);
+    return buf;
+}
+
+// Relatório com a saída do stdout descartada
+static char *report_with_workers(const char *path, int workers) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    generate_system_namespace_report_workers(path, workers);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(null);
+    return read_file(path);
+}
+
+void test_parallel_report() {
+    printf("\n=== Teste 7: Relatório do sistema com várias threads ===\n");
+
+    // Filhos parados garantem PIDs conhecidos em todas as faixas
+    enum { CHILDREN = 64 };
+    pid_t children[CHILDREN];
+    for (int i = 0; i < CHILDREN; i++) {
+        children[i] = fork();
+        if (children[i] == 0) {
+            pause();
+            _exit(0);
+        }
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_ns_report_%d.json", getpid());
+    char *serial = NULL, *parallel = NULL;
+    int same = 0;
+    // Outros processos do sistema podem nascer/morrer entre as varreduras
+    for (int attempt = 0; attempt < 3 && !same; attempt++) {
+        free(serial);
+        free(parallel);
+        serial = report_with_workers(path, 1);
+        parallel = report_with_workers(path, 8);
+        same = serial && parallel && strcmp(serial, parallel) == 0;
+    }
+    assert_test("Relatório com 8 threads igual ao de 1 thread", same);
+
+    char needle[32];
+    int found = 0;
+    for (int i = 0; parallel && i < CHILDREN; i++) {
+        snprintf(needle, sizeof(needle), " %d,", children[i]);
+        char needle_end[32];
+        snprintf(needle_end, sizeof(needle_end), " %d]", children[i]);
+        if (strstr(parallel, needle) || strstr(parallel, needle_end)) found++;
+    }
+    printf("%s %d de %d filhos no relatório paralelo\n", TEST_INFO, found, CHILDREN);
+    assert_test("Todos os filhos aparecem no relatório paralelo", found == CHILDREN);
+
+    free(serial);
+    free(parallel);
+    unlink(path);
+    for (int i = 0; i < CHILDREN; i++) {
+        kill(children[i], SIGKILL);
+        waitpid(children[i], NULL, 0);
+    }
+}
+
+static NamespaceInfo make_ns(const char *type, unsigned long inode) {
+    NamespaceInfo ns;
+    memset(&ns, 0, sizeof(ns));
+    strcpy(ns.type, type);
+    ns.inode = inode;
+    snprintf(ns.path, sizeof(ns.path), "%s:[%lu]", type, inode);
+    return ns;
+}
+
+void test_ns_report() {
+    printf("\n=== Teste 8: Agregação do relatório (NsReport) ===\n");
+
+    NsReport r;
+    assert_test("ns_report_init", ns_report_init(&r));
+    NamespaceInfo net = make_ns("net", 4026531840UL);
+    NamespaceInfo pid = make_ns("pid", 4026531836UL);
+    NamespaceInfo pid_children = make_ns("pid_for_children", 4026531836UL);
+
+    bool ok = true;
+    for (int p = 1; p <= 5; p++) ok = ok && ns_report_add(&r, &net, p);
+    ok = ok && ns_report_add(&r, &pid, 7) && ns_report_add(&r, &pid_children, 7);
+    const NsReportEntry *e = ns_report_find(&r, "net", 4026531840UL);
+    assert_test("Adição e busca", ok && e && e->pid_count == 5 && strcmp(e->path, "net:[4026531840]") == 0);
+    assert_test("PIDs na ordem de inserção", e && e->pids[0] == 1 && e->pids[4] == 5);
+
+    const NsReportEntry *a = ns_report_find(&r, "pid", 4026531836UL);
+    const NsReportEntry *b = ns_report_find(&r, "pid_for_children", 4026531836UL);
+    assert_test("Mesmo inode com tipos diferentes: entradas separadas",
+                r.count == 3 && a && b && a != b && a->pid_count == 1 && b->pid_count == 1);
+    assert_test("Namespace ausente: NULL", ns_report_find(&r, "net", 1) == NULL &&
+                ns_report_find(&r, "uts", 4026531840UL) == NULL);
+
+    // Muitos PIDs num namespace (lista cresce no lugar ou é copiada)
+    for (int p = 6; p <= 50000 && ok; p++) ok = ns_report_add(&r, &net, p);
+    e = ns_report_find(&r, "net", 4026531840UL);
+    bool ordered = ok && e && e->pid_count == 50000;
+    for (int i = 0; ordered && i < e->pid_count; i++) ordered = e->pids[i] == i + 1;
+    assert_test("Crescimento da lista de PIDs (50000)", ordered);
+
+    // Muitos namespaces: a tabela é redimensionada e as entradas seguem achadas
+    for (unsigned long i = 0; i < 5000 && ok; i++) {
+        NamespaceInfo ns = make_ns("mnt", 1000 + i);
+        ok = ns_report_add(&r, &ns, (int)i) && ns_report_add(&r, &ns, (int)i + 1);
+    }
+    bool found_all = ok && r.count == 5003;
+    for (unsigned long i = 0; found_all && i < 5000; i++) {
+        const NsReportEntry *m = ns_report_find(&r, "mnt", 1000 + i);
+        found_all = m && m->pid_count == 2 && m->pids[0] == (int)i && m->pids[1] == (int)i + 1;
+    }
+    assert_test("Redimensionamento com 5000 namespaces", found_all && r.slot_mask + 1 >= 2 * (size_t)r.count);
+
+    // Junção: PIDs da parte vão para o fim; namespaces novos no fim
+    NsReport part;
+    NamespaceInfo uts = make_ns("uts", 4026531838UL);
+    ok = ns_report_init(&part) && ns_report_add(&part, &net, 90001) && ns_report_add(&part, &uts, 90002);
+    ok = ok && ns_report_merge(&r, &part);
+    ns_report_free(&part);
+    e = ns_report_find(&r, "net", 4026531840UL);
+    const NsReportEntry *u = ns_report_find(&r, "uts", 4026531838UL);
+    assert_test("Junção de relatórios parciais", ok && e && e->pid_count == 50001 && e->pids[50000] == 90001 &&
+                u && u == &r.entries[r.count - 1] && u->pids[0] == 90002);
+    ns_report_free(&r);
+
+    // JSON
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_ns_report_json_%d.json", getpid());
+    ok = ns_report_init(&r) && ns_report_add(&r, &net, 1) && ns_report_add(&r, &net, 2) &&
+         ns_report_add(&r, &uts, 3) && ns_report_write_json(&r, path);
+    ns_report_free(&r);
+    char *json = read_file(path);
+    const char *expected =
+        "[\n"
+        "  {\n    \"type\": \"net\",\n    \"inode\": 4026531840,\n    \"path\": \"net:[4026531840]\",\n"
+        "    \"pids\": [1, 2]\n  },\n"
+        "  {\n    \"type\": \"uts\",\n    \"inode\": 4026531838,\n    \"path\": \"uts:[4026531838]\",\n"
+        "    \"pids\": [3]\n  }\n"
+        "]\n";
+    assert_test("JSON do relatório", ok && json && strcmp(json, expected) == 0);
+    free(json);
+    unlink(path);
+}
+
 int main() {
     printf("\n");
     printf("===============================================================\n");
@@ -181,6 +374,9 @@ int main() {
     test_namespace_comparison();
     test_namespace_init_vs_self();
     test_namespace_stat_inode();
+    test_get_process_namespaces();
+    test_parallel_report();
+    test_ns_report();
     
     // Resumo
     printf("\n");
@@ -0,0 +1,312 @@
+/**
+ * test_ns_index.c - Teste unitário para o índice persistente de namespaces
+ *
+ * Testa:
+ * - Varredura inicial: namespaces iguais aos lidos do /proc
+ * - Membros de um namespace e consulta por tipo
+ * - Eventos do proc connector: FORK, EXEC após unshare e EXIT (root)
+ * - Reconciliação: unshare sem exec só aparece após a varredura
+ * - Relatório do índice igual ao da varredura do /proc
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "../include/ns_index.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define EVENT_TIMEOUT_NS (5 * NSEC_PER_SEC)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+static unsigned long ns_inode(int pid, const char *type) {
+    char path[64];
+    struct stat sb;
+    snprintf(path, sizeof(path), "/proc/%d/ns/%s", pid, type);
+    return stat(path, &sb) == 0 ? sb.st_ino : 0;
+}
+
+static unsigned long indexed_inode(const NsIndex *idx, int pid, const char *type) {
+    NamespaceInfo ns[NS_INDEX_TYPES];
+    int count = ns_index_get(idx, pid, ns, NS_INDEX_TYPES);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(ns[i].type, type) == 0) return ns[i].inode;
+    }
+    return 0;
+}
+
+static bool is_member(const NsIndex *idx, const char *type, unsigned long inode, int pid) {
+    int count;
+    const int *pids = ns_index_members(idx, ns_index_type(type), inode, &count);
+    for (int i = 0; pids && i < count; i++) {
+        if (pids[i] == pid) return true;
+    }
+    return false;
+}
+
+// Aplica eventos até o PID ter o inode esperado no tipo (0 = fora do
+// índice). Como no caminho de produção, ns_index_poll reconcilia pela
+// varredura se o kernel descartou eventos (ENOBUFS).
+static bool wait_indexed(NsIndex *idx, int pid, const char *type, unsigned long expected) {
+    uint64_t deadline = monotonic_ns() + EVENT_TIMEOUT_NS;
+    for (;;) {
+        ns_index_poll(idx);
+        if (indexed_inode(idx, pid, type) == expected) return true;
+        if (monotonic_ns() >= deadline) return false;
+        struct pollfd pfd = { .fd = ns_index_fd(idx), .events = POLLIN };
+        poll(&pfd, 1, 10);
+    }
+}
+
+// Evento que não chegou no prazo: reindexa pelo /proc antes de conferir
+static bool wait_or_rescan(NsIndex *idx, int pid, const char *type, unsigned long expected, const char *event) {
+    if (wait_indexed(idx, pid, type, expected)) return true;
+    printf("%s Evento %s não aplicado em %llu s: reconciliando pela varredura\n", TEST_INFO, event,
+           (unsigned long long)(EVENT_TIMEOUT_NS / NSEC_PER_SEC));
+    ns_index_rescan(idx);
+    return indexed_inode(idx, pid, type) == expected;
+}
+
+void test_initial_scan(NsIndex *idx) {
+    printf("\n=== Teste 1: Varredura inicial ===\n");
+
+    assert_test("ns_index_init", ns_index_init(idx, 3600ULL * NSEC_PER_SEC));
+    printf("%s %zu processos, %zu namespaces (%.1f ms)\n", TEST_INFO, idx->proc_count, idx->ns_count,
+           (double)idx->last_scan_cost_ns / NSEC_PER_MSEC);
+
+    NamespaceInfo from_proc[NS_INDEX_TYPES], from_index[NS_INDEX_TYPES];
+    int n1 = get_process_namespaces(getpid(), from_proc, NS_INDEX_TYPES);
+    int n2 = ns_index_get(idx, getpid(), from_index, NS_INDEX_TYPES);
+    bool same = n1 > 0 && n1 == n2;
+    for (int i = 0; same && i < n1; i++) {
+        same = strcmp(from_proc[i].type, from_index[i].type) == 0 && from_proc[i].inode == from_index[i].inode &&
+               strcmp(from_proc[i].path, from_index[i].path) == 0;
+    }
+    assert_test("Namespaces do próprio processo iguais aos do /proc (tipo, inode e link)", same);
+
+    assert_test("Próprio processo entre os membros do seu netns",
+                is_member(idx, "net", ns_inode(getpid(), "net"), getpid()));
+    assert_test("Tipo pid_for_children separado de pid",
+                is_member(idx, "pid_for_children", ns_inode(getpid(), "pid_for_children"), getpid()) &&
+                ns_index_type("pid") != ns_index_type("pid_for_children"));
+    int count;
+    assert_test("Namespace inexistente: NULL", ns_index_members(idx, ns_index_type("net"), 1, &count) == NULL &&
+                count == 0);
+    assert_test("PID fora do índice: -1", ns_index_get(idx, 0x3ffffff0, from_index, NS_INDEX_TYPES) == -1);
+}
+
+void test_events(NsIndex *idx) {
+    printf("\n=== Teste 2: Eventos do proc connector ===\n");
+
+    if (geteuid() != 0 || !ns_index_listen(idx)) {
+        printf("%s Sem root ou sem proc connector: testes de eventos pulados\n", TEST_INFO);
+        return;
+    }
+    ns_index_poll(idx);     // varredura pendente da inscrição
+    uint64_t scans = idx->scans;
+    uint64_t lost = idx->lost;
+
+    // FORK: o filho entra com os namespaces do pai
+    pid_t child = fork();
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    unsigned long net = ns_inode(getpid(), "net");
+    assert_test("FORK: filho indexado", wait_or_rescan(idx, child, "net", net, "FORK") &&
+                (idx->forks > 0 || idx->lost > lost));
+
+    // unshare + exec: o EXEC relê os namespaces. O pipe com CLOEXEC fecha
+    // no exec: depois do EOF o novo utsns já está no /proc
+    int execed[2];
+    if (pipe2(execed, O_CLOEXEC) != 0) return;
+    pid_t execd = fork();
+    if (execd == 0) {
+        close(execed[0]);
+        if (unshare(CLONE_NEWUTS) != 0) _exit(1);
+        execl("/bin/sleep", "sleep", "30", (char *)NULL);
+        _exit(1);
+    }
+    close(execed[1]);
+    char c;
+    while (read(execed[0], &c, 1) > 0) {}
+    close(execed[0]);
+    unsigned long parent_uts = ns_inode(getpid(), "uts");
+    unsigned long new_uts = ns_inode(execd, "uts");
+    bool moved = new_uts != 0 && new_uts != parent_uts && wait_or_rescan(idx, execd, "uts", new_uts, "EXEC");
+    assert_test("EXEC após unshare(CLONE_NEWUTS): novo utsns no índice",
+                moved && (idx->execs > 0 || idx->lost > lost));
+    assert_test("Novo utsns só com o processo", is_member(idx, "uts", new_uts, execd) &&
+                !is_member(idx, "uts", parent_uts, execd));
+
+    // EXIT: sai do índice; o namespace vazio some
+    kill(execd, SIGKILL);
+    waitpid(execd, NULL, 0);
+    bool gone = wait_or_rescan(idx, execd, "uts", 0, "EXIT") && ns_index_get(idx, execd, NULL, 0) == -1;
+    int count;
+    assert_test("EXIT: processo removido", gone && (idx->exits > 0 || idx->lost > lost));
+    assert_test("Namespace sem processos removido", ns_index_members(idx, ns_index_type("uts"), new_uts, &count) == NULL);
+
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    if (idx->lost > lost) {
+        printf("%s %llu perdas de eventos (ENOBUFS): varreduras de reconciliação esperadas\n", TEST_INFO,
+               (unsigned long long)(idx->lost - lost));
+    } else {
+        assert_test("Nenhuma varredura durante os eventos", idx->scans == scans);
+    }
+}
+
+void test_reconcile(NsIndex *idx) {
+    printf("\n=== Teste 3: Reconciliação ===\n");
+
+    if (geteuid() != 0) {
+        printf("%s Sem root: unshare indisponível, teste pulado\n", TEST_INFO);
+        return;
+    }
+    // unshare sem exec não gera evento
+    int ready[2];
+    if (pipe(ready) != 0) return;
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        char ok = unshare(CLONE_NEWUTS) == 0 ? 'y' : 'n';
+        if (write(ready[1], &ok, 1) != 1) _exit(1);
+        pause();
+        _exit(0);
+    }
+    close(ready[1]);
+    char ok = 'n';
+    if (read(ready[0], &ok, 1) != 1) ok = 'n';
+    close(ready[0]);
+
+    unsigned long uts = ns_inode(child, "uts");
+    // O FORK indexa o filho com o utsns lido no evento (antigo ou novo)
+    uint64_t deadline = monotonic_ns() + EVENT_TIMEOUT_NS;
+    while (idx->nl_fd >= 0 && ns_index_get(idx, child, NULL, 0) == -1 && monotonic_ns() < deadline) {
+        ns_index_dispatch(idx);
+        usleep(5000);
+    }
+    uint64_t fixed = idx->fixed;
+    bool stale = indexed_inode(idx, child, "uts") != uts;
+    ns_index_rescan(idx);
+    assert_test("unshare sem exec corrigido pela varredura",
+                ok == 'y' && indexed_inode(idx, child, "uts") == uts && (!stale || idx->fixed > fixed));
+
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    ns_index_rescan(idx);
+    assert_test("Processo terminado removido pela varredura", ns_index_get(idx, child, NULL, 0) == -1);
+}
+
+static char *read_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+    char *buf = malloc(size + 1);
+    size_t n = buf ? fread(buf, 1, size, f) : 0;
+    if (buf) buf[n] = '\0';
+    fclose(f);
+    return buf;
+}
+
+// Relatório com a saída do stdout descartada
+static char *quiet_report(NsIndex *idx, const char *path) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    if (idx) {
+        generate_system_namespace_report_indexed(idx, path);
+    } else {
+        generate_system_namespace_report_workers(path, 1);
+    }
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(null);
+    return read_file(path);
+}
+
+void test_report(NsIndex *idx) {
+    printf("\n=== Teste 4: Relatório a partir do índice ===\n");
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_ns_index_%d.json", getpid());
+    int same = 0;
+    // Outros processos do sistema podem nascer/morrer entre as leituras
+    for (int attempt = 0; attempt < 3 && !same; attempt++) {
+        ns_index_rescan(idx);
+        char *indexed = quiet_report(idx, path);
+        char *scanned = quiet_report(NULL, path);
+        same = indexed && scanned && strcmp(indexed, scanned) == 0;
+        free(indexed);
+        free(scanned);
+    }
+    assert_test("Relatório do índice igual ao da varredura", same);
+    unlink(path);
+
+    unsigned long net = ns_inode(getpid(), "net");
+    int type = ns_index_type("net");
+    uint64_t start = monotonic_ns();
+    int count = 0;
+    for (int i = 0; i < 1000; i++) {
+        ns_index_members(idx, type, net, &count);
+    }
+    printf("%s 1000 consultas de membros: %.3f us cada (varredura: %.1f ms)\n", TEST_INFO,
+           (double)(monotonic_ns() - start) / 1000 / 1000.0, (double)idx->last_scan_cost_ns / NSEC_PER_MSEC);
+    assert_test("Consulta de membros", count > 0);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - ÍNDICE DE NAMESPACES\n");
+    printf("===============================================================\n");
+
+    NsIndex idx;
+    test_initial_scan(&idx);
+    test_events(&idx);
+    test_reconcile(&idx);
+    test_report(&idx);
+    ns_index_close(&idx);
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * test_ns_latency.c - Teste unitário para o benchmark de latência de namespaces
+ *
+ * Testa:
+ * - Conjuntos de tipos ("pid+net", "all") e nomes inválidos
+ * - Quantis e baldes log2 do histograma
+ * - Medição curta (uts, net): unshare, clone3 sem o fork, erros por conjunto
+ * - Destruição do netns pelo RTM_DELLINK do veth (root)
+ * - JSON dos resultados
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <fcntl.h>
+#include "../include/ns_latency.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+void test_parse_set() {
+    printf("\n=== Teste 1: Conjuntos de namespaces ===\n");
+
+    int flags;
+    assert_test("\"net\"", ns_latency_parse_set("net", &flags) && flags == CLONE_NEWNET);
+    assert_test("\"pid+net+mnt\"", ns_latency_parse_set("pid+net+mnt", &flags) &&
+                flags == (CLONE_NEWPID | CLONE_NEWNET | CLONE_NEWNS));
+    int all;
+    assert_test("\"all\" tem os oito tipos", ns_latency_parse_set("all", &all) &&
+                (all & CLONE_NEWUSER) && (all & CLONE_NEWCGROUP) && __builtin_popcount((unsigned)all) == 8);
+    assert_test("Tipo desconhecido rejeitado", !ns_latency_parse_set("net+foo", &flags) &&
+                !ns_latency_parse_set("", &flags) && !ns_latency_parse_set("network", &flags));
+
+    const char *sets[NS_LATENCY_MAX_SETS];
+    int n = ns_latency_default_sets(sets, NS_LATENCY_MAX_SETS);
+    bool valid = n >= 9;
+    for (int i = 0; valid && i < n; i++) valid = ns_latency_parse_set(sets[i], &flags);
+    assert_test("Conjuntos padrão: os 8 tipos e as combinações, todos válidos", valid);
+}
+
+void test_hist() {
+    printf("\n=== Teste 2: Histograma ===\n");
+
+    // 1..100 us, embaralhado
+    uint64_t samples[100];
+    for (int i = 0; i < 100; i++) samples[i] = (uint64_t)((i * 37) % 100 + 1) * 1000;
+    NsLatencyHist h;
+    ns_latency_hist(&h, samples, 100);
+    assert_test("min/max", h.count == 100 && h.min_ns == 1000 && h.max_ns == 100000);
+    assert_test("p50/p90/p99 pelo posto mais próximo", h.p50_ns == 50000 && h.p90_ns == 90000 && h.p99_ns == 99000);
+    assert_test("Média", h.mean_ns > 50499.0 && h.mean_ns < 50501.0);
+    uint32_t total = 0;
+    for (int b = 0; b < NS_LATENCY_BUCKETS; b++) total += h.buckets[b];
+    // < 2us: 1; 2-4us: 2, 3; 64-128us: 64..100
+    assert_test("Baldes log2 de microssegundos", total == 100 && h.buckets[0] == 1 && h.buckets[1] == 2 &&
+                h.buckets[6] == 37);
+
+    uint64_t one = 5000000000ULL;   // 5 s: penúltimo balde (4-8 s)
+    ns_latency_hist(&h, &one, 1);
+    assert_test("Amostra única", h.p50_ns == one && h.p99_ns == one && h.buckets[22] == 1);
+}
+
+// Execução com a saída de progresso descartada
+static bool quiet_run(NsLatencyReport *r, const char **sets, int nsets, int reps, int warmup) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    bool ok = ns_latency_run(r, sets, nsets, reps, warmup);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    close(null);
+    return ok;
+}
+
+void test_run(NsLatencyReport *r) {
+    printf("\n=== Teste 3: Medição curta ===\n");
+
+    const char *sets[] = { "uts", "net", "bogus" };
+    bool ok = quiet_run(r, sets, 3, 20, 2);
+    assert_test("ns_latency_run", ok && r->repetitions == 20 && r->warmup == 2);
+    assert_test("Conjunto inválido ignorado", ok && r->count == 2);
+    assert_test("Baseline do fork", ok && r->fork_baseline.count == 20 && r->fork_baseline.p50_ns > 0);
+
+    if (geteuid() != 0) {
+        printf("%s Sem root: criação de uts/net não permitida, só o erro é conferido\n", TEST_INFO);
+        assert_test("Erro registrado por conjunto", ok && r->results[0].error != 0);
+        return;
+    }
+    const NsLatencyResult *uts = &r->results[0], *net = &r->results[1];
+    assert_test("uts medido", ok && uts->error == 0 && uts->unshare.count == 20 &&
+                uts->unshare.min_ns > 0 && uts->unshare.min_ns <= uts->unshare.p50_ns &&
+                uts->unshare.p50_ns <= uts->unshare.p99_ns && uts->unshare.p99_ns <= uts->unshare.max_ns);
+    assert_test("clone3 sem o custo do fork (abaixo do ciclo completo)", ok && uts->clone3.count == 20 &&
+                uts->clone3.p50_ns < r->fork_baseline.p50_ns + uts->unshare.max_ns);
+    printf("%s unshare p50: uts %.1f us, net %.1f us | fork %.1f us\n", TEST_INFO, uts->unshare.p50_ns / 1e3,
+           net->unshare.p50_ns / 1e3, r->fork_baseline.p50_ns / 1e3);
+    assert_test("netns mais caro que utsns", ok && net->error == 0 && net->unshare.p50_ns > uts->unshare.p50_ns);
+
+    if (r->teardown_error) {
+        printf("%s Destruição do netns não medida: %s\n", TEST_INFO, strerror(r->teardown_error));
+    } else {
+        printf("%s Destruição do netns p50: %.1f ms\n", TEST_INFO, r->netns_teardown.p50_ns / 1e6);
+        assert_test("Destruição do netns medida (assíncrona, acima da criação)",
+                    r->netns_teardown.count == 20 && r->netns_teardown.p50_ns > net->unshare.p50_ns);
+    }
+}
+
+void test_json(const NsLatencyReport *r) {
+    printf("\n=== Teste 4: JSON ===\n");
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_ns_latency_%d.json", getpid());
+    assert_test("ns_latency_write_json", ns_latency_write_json(r, path));
+    FILE *f = fopen(path, "r");
+    char buf[16384] = "";
+    size_t n = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+    buf[n] = '\0';
+    if (f) fclose(f);
+    assert_test("Campos do relatório", strstr(buf, "\"repetitions\": 20") && strstr(buf, "\"fork_clone3\"") &&
+                strstr(buf, "\"name\": \"uts\"") && strstr(buf, "\"netns_teardown\"") &&
+                strstr(buf, "\"log2_us_buckets\": ["));
+    unlink(path);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - LATÊNCIA DE NAMESPACES\n");
+    printf("===============================================================\n");
+
+    test_parse_set();
+    test_hist();
+    NsLatencyReport *r = calloc(1, sizeof(NsLatencyReport));
+    if (r) {
+        test_run(r);
+        test_json(r);
+        free(r);
+    }
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
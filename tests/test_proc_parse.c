@@ -0,0 +1,240 @@
+/**
+ * test_proc_parse.c - Teste unitário para o tokenizador de /proc
+ *
+ * Testa:
+ * - /proc/<pid>/stat com comm contendo espaços e parênteses
+ * - /proc/<pid>/statm
+ * - /proc/<pid>/status (chaves resolvidas por hash perfeito)
+ * - /proc/<pid>/io
+ * - Consistência com os arquivos reais do próprio processo
+ * - Arquivos de net/ maiores que uma página (vários pread)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../include/proc_parse.h"
+#include "../include/proc_reader.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+void test_stat_comm_with_spaces() {
+    printf("\n=== Teste 1: stat com comm contendo espaços e parênteses ===\n");
+
+    const char *line = "4242 (my (weird) proc) S 1 4242 4242 0 -1 4194560 "
+                       "123 0 7 0 50 25 0 0 20 -5 3 0 98765 1048576 256 "
+                       "18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 5 0 0 0 0 0\n";
+    ProcStat st;
+    int ok = proc_parse_stat(line, strlen(line), &st);
+
+    assert_test("Parser aceita a linha", ok);
+    assert_test("PID lido corretamente", st.pid == 4242);
+    assert_test("comm preserva espaços e parênteses", strcmp(st.comm, "my (weird) proc") == 0);
+    assert_test("Estado após o último ')'", st.state == 'S');
+    assert_test("PPID (campo 4)", st.ppid == 1);
+    assert_test("minflt/majflt (campos 10/12)", st.minflt == 123 && st.majflt == 7);
+    assert_test("utime/stime (campos 14/15)", st.utime == 50 && st.stime == 25);
+    assert_test("nice negativo (campo 19)", st.nice == -5);
+    assert_test("num_threads (campo 20)", st.num_threads == 3);
+    assert_test("vsize/rss (campos 23/24)", st.vsize == 1048576 && st.rss == 256);
+    assert_test("processor (campo 39)", st.processor == 5);
+}
+
+void test_stat_malformed() {
+    printf("\n=== Teste 2: stat malformado ===\n");
+
+    ProcStat st;
+    const char *truncated = "1 (init) S 0 1 1";
+    assert_test("Linha truncada é rejeitada", !proc_parse_stat(truncated, strlen(truncated), &st));
+
+    const char *no_paren = "1 init S 0 1 1 0 -1 0 0 0 0 0 0 0 0 0 20 0 1 0 1 1 1";
+    assert_test("Linha sem parênteses é rejeitada", !proc_parse_stat(no_paren, strlen(no_paren), &st));
+}
+
+void test_statm() {
+    printf("\n=== Teste 3: statm ===\n");
+
+    const char *line = "2500 1444 1300 200 0 180 0\n";
+    ProcStatm st;
+    int ok = proc_parse_statm(line, strlen(line), &st);
+    assert_test("statm com 7 campos", ok && st.size == 2500 && st.resident == 1444 &&
+                st.shared == 1300 && st.data == 180);
+}
+
+void test_status_keys() {
+    printf("\n=== Teste 4: status (hash perfeito) ===\n");
+
+    const char *text =
+        "Name:\tbash\n"
+        "Threads:\t4\n"
+        "VmPeak:\t   10000 kB\n"
+        "VmSize:\t    9000 kB\n"
+        "VmHWM:\t    3000 kB\n"
+        "VmRSS:\t    2900 kB\n"
+        "RssAnon:\t    1000 kB\n"
+        "RssFile:\t    1800 kB\n"
+        "RssShmem:\t     100 kB\n"
+        "VmSwap:\t      64 kB\n"
+        "VmData:\t     777 kB\n"
+        "SigQ:\t0/63432\n"
+        "voluntary_ctxt_switches:\t11\n"
+        "nonvoluntary_ctxt_switches:\t22\n";
+    ProcStatus st;
+    proc_parse_status(text, strlen(text), &st);
+
+    assert_test("Threads", st.threads == 4);
+    assert_test("VmPeak/VmSize", st.vm_peak_kb == 10000 && st.vm_size_kb == 9000);
+    assert_test("VmHWM/VmRSS", st.vm_hwm_kb == 3000 && st.vm_rss_kb == 2900);
+    assert_test("RssAnon/RssFile/RssShmem", st.rss_anon_kb == 1000 && st.rss_file_kb == 1800 &&
+                st.rss_shmem_kb == 100);
+    assert_test("VmSwap", st.vm_swap_kb == 64);
+    assert_test("Context switches", st.voluntary_ctxt_switches == 11 &&
+                st.nonvoluntary_ctxt_switches == 22);
+}
+
+void test_io_keys() {
+    printf("\n=== Teste 5: io ===\n");
+
+    const char *text =
+        "rchar: 1\nwchar: 2\nsyscr: 3\nsyscw: 4\n"
+        "read_bytes: 5\nwrite_bytes: 6\ncancelled_write_bytes: 7\n";
+    ProcIo io;
+    proc_parse_io(text, strlen(text), &io);
+
+    assert_test("Todas as chaves de io", io.rchar == 1 && io.wchar == 2 && io.syscr == 3 &&
+                io.syscw == 4 && io.read_bytes == 5 && io.write_bytes == 6 &&
+                io.cancelled_write_bytes == 7);
+}
+
+void test_self_files() {
+    printf("\n=== Teste 6: Arquivos reais do próprio processo ===\n");
+
+    ProcHandle h = {0};
+    if (!proc_handle_open(&h, getpid())) {
+        assert_test("Abrir /proc/self", 0);
+        return;
+    }
+    proc_handle_begin_sample(&h);
+
+    size_t len;
+    const char *buf = proc_handle_read(&h, PROC_FILE_STAT, &len);
+    ProcStat st;
+    assert_test("stat do próprio processo", buf && proc_parse_stat(buf, len, &st) && st.pid == getpid());
+    printf("%s comm=%s threads=%ld processor=%d\n", TEST_INFO, st.comm, st.num_threads, st.processor);
+
+    buf = proc_handle_read(&h, PROC_FILE_STATUS, &len);
+    ProcStatus status;
+    assert_test("status do próprio processo", buf && proc_parse_status(buf, len, &status) &&
+                status.threads == (unsigned long long)st.num_threads && status.vm_rss_kb > 0);
+
+    proc_handle_close(&h);
+}
+
+static int count_lines(const char *buf) {
+    int lines = 0;
+    for (const char *p = buf; (p = strchr(p, '\n')); p++) lines++;
+    return lines;
+}
+
+void test_multi_page() {
+    printf("\n=== Teste 7: net/tcp maior que uma página ===\n");
+
+    // Cada socket em escuta é uma linha de ~150 bytes em /proc/<pid>/net/tcp
+    enum { NSOCKS = 64 };
+    int socks[NSOCKS];
+    int opened = 0;
+    for (int i = 0; i < NSOCKS; i++) {
+        socks[i] = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+        if (socks[i] < 0 || bind(socks[i], (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(socks[i], 1) != 0) {
+            if (socks[i] >= 0) close(socks[i]);
+            socks[i] = -1;
+            continue;
+        }
+        opened++;
+    }
+
+    ProcHandle h = {0};
+    if (!proc_handle_open(&h, getpid())) {
+        assert_test("Abrir /proc/self", 0);
+        return;
+    }
+    proc_handle_begin_sample(&h);
+    size_t len = 0;
+    const char *buf = proc_handle_read(&h, PROC_FILE_NET_TCP, &len);
+
+    // Referência: stdio lê até o EOF
+    char ref[1 << 16];
+    size_t ref_len = 0;
+    FILE *fp = fopen("/proc/self/net/tcp", "r");
+    if (fp) {
+        ref_len = fread(ref, 1, sizeof(ref) - 1, fp);
+        fclose(fp);
+    }
+    ref[ref_len] = '\0';
+
+    printf("%s %d sockets em escuta: net/tcp com %zu bytes (referência %zu)\n", TEST_INFO, opened, len,
+           ref_len);
+    assert_test("Conteúdo maior que uma página", buf && len > 4096 && strlen(buf) == len);
+    assert_test("Todas as linhas lidas (cabeçalho + sockets)",
+                buf && count_lines(buf) >= opened + 1 && count_lines(buf) == count_lines(ref));
+
+    // Segunda amostra: o buffer já cresceu, o conteúdo continua completo
+    proc_handle_begin_sample(&h);
+    buf = proc_handle_read(&h, PROC_FILE_NET_TCP, &len);
+    assert_test("Releitura completa", buf && count_lines(buf) >= opened + 1);
+
+    proc_handle_close(&h);
+    for (int i = 0; i < NSOCKS; i++) {
+        if (socks[i] >= 0) close(socks[i]);
+    }
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - TOKENIZADOR /proc\n");
+    printf("===============================================================\n");
+    
+    // Executar testes
+    test_stat_comm_with_spaces();
+    test_stat_malformed();
+    test_statm();
+    test_status_keys();
+    test_io_keys();
+    test_self_files();
+    test_multi_page();
+    
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+    
+    return (tests_failed > 0) ? 1 : 0;
+}
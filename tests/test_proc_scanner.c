@@ -0,0 +1,247 @@
+/**
+ * test_proc_scanner.c - Teste unitário para a varredura incremental de /proc
+ *
+ * Testa:
+ * - Descoberta de processos novos e remoção dos encerrados
+ * - Processos ociosos: só stat relido a cada tick
+ * - Processo ativo relido a cada tick, com CPU% e taxas
+ * - Ocioso que volta a rodar aparece com CPU% já no tick seguinte
+ * - Filtros por cgroup e por namespace
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../include/proc_scanner.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define CHILDREN 8
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+// Filhos ociosos (pause) ou ocupados (laço infinito)
+static pid_t spawn_child(bool busy) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (busy) {
+            volatile unsigned long spin = 0;
+            for (;;) spin++;
+        }
+        for (;;) pause();
+    }
+    return pid;
+}
+
+static void reap_child(pid_t pid) {
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+static bool visible(ProcScanner *s, int pid) {
+    ProcessSlot *slot = process_table_find(&s->table, pid);
+    return slot && !slot->excluded;
+}
+
+void test_discovery(void) {
+    printf("\n%s Testando descoberta e remoção...\n", TEST_INFO);
+
+    pid_t children[CHILDREN];
+    for (int i = 0; i < CHILDREN; i++) children[i] = spawn_child(false);
+    usleep(20000);  // filhos chegam ao pause()
+
+    ProcScanner s;
+    assert_test("Inicialização", proc_scanner_init(&s, NULL, NULL));
+    assert_test("Primeiro tick relê /proc", proc_scanner_tick(&s) && s.rescanned);
+
+    bool all = visible(&s, getpid());
+    for (int i = 0; i < CHILDREN; i++) all = all && visible(&s, children[i]);
+    assert_test("Processo atual e filhos encontrados", all);
+    assert_test("Contagem de visíveis", s.visible == s.table.count && s.visible >= CHILDREN + 1);
+
+    // Filhos em pause(): stat não muda e status/statm/io não são relidos
+    usleep(20000);
+    proc_scanner_tick(&s);
+    ProcessSlot *slot = process_table_find(&s.table, children[0]);
+    assert_test("Filho ocioso: stat inalterado", slot && slot->idle_streak == 1);
+    proc_scanner_tick(&s);
+    slot = process_table_find(&s.table, children[0]);
+    printf("  tick %lu: %zu relidos, %zu inalterados\n", s.table.tick, s.table.full_reads, s.table.stat_reads);
+    assert_test("Ociosos verificados pelo stat no tick seguinte",
+                slot && slot->idle_streak == 2 && s.table.stat_reads >= CHILDREN);
+
+    // Encerrar um filho altera /proc/loadavg: a lista é relida
+    reap_child(children[0]);
+    proc_scanner_tick(&s);
+    assert_test("Processo encerrado removido", s.rescanned &&
+                                               process_table_find(&s.table, children[0]) == NULL);
+
+    pid_t late = spawn_child(false);
+    proc_scanner_tick(&s);
+    assert_test("Processo novo descoberto", visible(&s, late));
+    reap_child(late);
+
+    for (int i = 1; i < CHILDREN; i++) reap_child(children[i]);
+    proc_scanner_free(&s);
+}
+
+void test_busy(void) {
+    printf("\n%s Testando processo ativo...\n", TEST_INFO);
+
+    pid_t busy = spawn_child(true);
+    ProcScanner s;
+    proc_scanner_init(&s, NULL, NULL);
+    proc_scanner_tick(&s);
+
+    // Ticks espaçados para o tempo de CPU avançar alguns jiffies
+    bool reread = true;
+    double cpu = 0.0;
+    for (int i = 0; i < 3; i++) {
+        usleep(200000);
+        proc_scanner_tick(&s);
+        ProcessSlot *slot = process_table_find(&s.table, busy);
+        if (!slot || slot->idle_streak != 0) reread = false;
+        if (slot) cpu = slot->cur.cpu_usage_percent;
+    }
+    printf("  CPU%% do filho ocupado: %.1f\n", cpu);
+    assert_test("Processo ativo relido a cada tick", reread);
+    assert_test("CPU% calculado", cpu > 50.0);
+    printf("  CPU da varredura: %.3f ms\n", s.cpu_ns / 1e6);
+
+    reap_child(busy);
+    proc_scanner_free(&s);
+}
+
+void test_wakeup(void) {
+    printf("\n%s Testando ocioso que volta a rodar...\n", TEST_INFO);
+
+    // Filho bloqueado no pipe até o pai liberar, depois em laço
+    int go[2];
+    if (pipe(go) != 0) return;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(go[1]);
+        char c;
+        if (read(go[0], &c, 1) != 1) _exit(1);
+        volatile unsigned long spin = 0;
+        for (;;) spin++;
+    }
+    close(go[0]);
+
+    ProcScanner s;
+    proc_scanner_init(&s, NULL, NULL);
+    for (int i = 0; i < 6; i++) {
+        usleep(20000);
+        proc_scanner_tick(&s);
+    }
+    ProcessSlot *slot = process_table_find(&s.table, pid);
+    assert_test("Filho bloqueado visto como ocioso", slot && slot->idle_streak >= 4);
+
+    // Ticks espaçados para o tempo de CPU avançar alguns jiffies
+    if (write(go[1], "", 1) != 1) return;
+    usleep(200000);
+    proc_scanner_tick(&s);
+    slot = process_table_find(&s.table, pid);
+    double cpu = slot ? slot->cur.cpu_usage_percent : 0.0;
+    printf("  CPU%% no primeiro tick após acordar: %.1f\n", cpu);
+    assert_test("Atividade detectada no primeiro tick", slot && slot->idle_streak == 0 && cpu > 50.0);
+
+    close(go[1]);
+    reap_child(pid);
+    proc_scanner_free(&s);
+}
+
+void test_filters(void) {
+    printf("\n%s Testando filtros...\n", TEST_INFO);
+
+    pid_t child = spawn_child(false);
+
+    // Namespace de rede do próprio processo: inclui o filho
+    ProcNamespaceFilter nsf;
+    assert_test("Tipo de namespace inválido", !proc_namespace_filter_init(&nsf, "bogus", getpid()));
+    assert_test("Filtro de namespace", proc_namespace_filter_init(&nsf, "net", getpid()));
+
+    ProcScanner s;
+    proc_scanner_init(&s, proc_filter_namespace, &nsf);
+    proc_scanner_tick(&s);
+    assert_test("Mesmo netns: visível", visible(&s, getpid()) && visible(&s, child));
+    proc_scanner_free(&s);
+
+    nsf.inode = 1;  // nenhum namespace tem este inode
+    proc_scanner_init(&s, proc_filter_namespace, &nsf);
+    proc_scanner_tick(&s);
+    assert_test("Namespace inexistente: nada visível", s.visible == 0 && s.table.count > 0);
+    proc_scanner_free(&s);
+
+    // Cgroup do próprio processo (hierarquia v2)
+    char cgroup[512] = "";
+    FILE *fp = fopen("/proc/self/cgroup", "r");
+    char line[512];
+    while (fp && fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, "0::", 3) == 0) {
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(cgroup, sizeof(cgroup), "%s", line + 3);
+        }
+    }
+    if (fp) fclose(fp);
+
+    if (cgroup[0]) {
+        proc_scanner_init(&s, proc_filter_cgroup, cgroup);
+        proc_scanner_tick(&s);
+        assert_test("Mesmo cgroup: visível", visible(&s, getpid()) && visible(&s, child));
+        proc_scanner_free(&s);
+
+        char other[] = "/cgroup-inexistente-do-teste";
+        proc_scanner_init(&s, proc_filter_cgroup, other);
+        proc_scanner_tick(&s);
+        assert_test("Cgroup inexistente: nada visível", s.visible == 0);
+        proc_scanner_free(&s);
+    } else {
+        printf("%s Sem hierarquia cgroup v2: filtro de cgroup não testado\n", TEST_INFO);
+    }
+
+    reap_child(child);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - VARREDURA INCREMENTAL DE /proc\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_discovery();
+    test_busy();
+    test_wakeup();
+    test_filters();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * test_process_table.c - Teste unitário para a tabela PID -> slot
+ *
+ * Testa:
+ * - Inserção e busca com crescimento da tabela
+ * - Remoção por deslocamento reverso (sem perder chaves da mesma sequência)
+ * - Remoção de processos não vistos no tick (sweep)
+ * - Amostragem do próprio processo com cálculo de deltas
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/process_table.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+void test_insert_find_grow() {
+    printf("\n=== Teste 1: Inserção, busca e crescimento ===\n");
+
+    ProcessTable t;
+    assert_test("Inicialização", process_table_init(&t, 8));
+    size_t initial = t.capacity;
+
+    bool inserted = true;
+    for (int pid = 1; pid <= 1000; pid++) {
+        if (!process_table_insert(&t, pid)) inserted = false;
+    }
+    assert_test("1000 inserções", inserted && t.count == 1000);
+    assert_test("Tabela cresceu e manteve ocupação <= 50%",
+                t.capacity > initial && t.count * 2 <= t.capacity);
+
+    bool found = true;
+    for (int pid = 1; pid <= 1000; pid++) {
+        ProcessSlot *s = process_table_find(&t, pid);
+        if (!s || s->pid != pid) found = false;
+    }
+    assert_test("Todos os PIDs encontrados após crescimento", found);
+    assert_test("PID ausente não é encontrado", process_table_find(&t, 5000) == NULL);
+    assert_test("Inserção repetida devolve o mesmo slot",
+                process_table_insert(&t, 42) == process_table_find(&t, 42) && t.count == 1000);
+
+    process_table_free(&t);
+}
+
+void test_remove() {
+    printf("\n=== Teste 2: Remoção por deslocamento reverso ===\n");
+
+    ProcessTable t;
+    process_table_init(&t, 64);
+
+    // Ocupação alta o bastante para formar sequências de sondagem longas
+    for (int pid = 100; pid < 130; pid++) process_table_insert(&t, pid);
+    for (int pid = 100; pid < 130; pid += 2) process_table_remove(&t, pid);
+
+    bool ok = true;
+    for (int pid = 100; pid < 130; pid++) {
+        bool present = process_table_find(&t, pid) != NULL;
+        if (present != (pid % 2 == 1)) ok = false;
+    }
+    assert_test("Pares removidos, ímpares preservados", ok);
+    assert_test("Contagem após remoção", t.count == 15);
+
+    process_table_free(&t);
+}
+
+void test_sweep() {
+    printf("\n=== Teste 3: Sweep de processos não vistos ===\n");
+
+    ProcessTable t;
+    process_table_init(&t, 64);
+
+    process_table_begin_tick(&t);
+    for (int pid = 1; pid <= 40; pid++) {
+        process_table_insert(&t, pid)->seen_tick = t.tick;
+    }
+
+    process_table_begin_tick(&t);
+    for (int pid = 1; pid <= 40; pid += 4) {
+        process_table_find(&t, pid)->seen_tick = t.tick;
+    }
+    size_t removed = process_table_sweep(&t);
+
+    assert_test("Sweep remove os não vistos", removed == 30 && t.count == 10);
+    bool ok = true;
+    for (int pid = 1; pid <= 40; pid++) {
+        bool present = process_table_find(&t, pid) != NULL;
+        if (present != (pid % 4 == 1)) ok = false;
+    }
+    assert_test("Somente os vistos permanecem", ok);
+
+    process_table_free(&t);
+}
+
+void test_sample_self() {
+    printf("\n=== Teste 4: Amostragem do próprio processo ===\n");
+
+    ProcessTable t;
+    process_table_init(&t, 64);
+
+    process_table_begin_tick(&t);
+    ProcessSlot *s = process_table_sample(&t, getpid());
+    assert_test("Primeira amostra", s != NULL && s->cur.pid == getpid() && s->cur.mem_rss > 0);
+
+    // Consome CPU até o relógio avançar 1s para que o delta seja mensurável
+    time_t t0 = time(NULL);
+    volatile unsigned long spin = 0;
+    while (time(NULL) - t0 < 1) spin++;
+
+    process_table_begin_tick(&t);
+    s = process_table_sample(&t, getpid());
+    assert_test("Segunda amostra com delta de CPU", s != NULL && s->cur.cpu_usage_percent > 0.0);
+    if (s) printf("%s CPU%% = %.2f\n", TEST_INFO, s->cur.cpu_usage_percent);
+
+    assert_test("PID inexistente é descartado", process_table_sample(&t, 4194304) == NULL &&
+                process_table_find(&t, 4194304) == NULL);
+
+    process_table_free(&t);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - TABELA DE PROCESSOS\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_insert_find_grow();
+    test_remove();
+    test_sweep();
+    test_sample_self();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
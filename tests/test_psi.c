@@ -0,0 +1,200 @@
+/**
+ * test_psi.c - Teste unitário para a leitura e os gatilhos de PSI
+ *
+ * Testa:
+ * - Parser de some/full avg10/avg60/avg300/total e da especificação do gatilho
+ * - Leitura do host (/proc/pressure) e de um cgroup v2 (*.pressure)
+ * - Gatilho de CPU disparado por contenção (processos ocupados), com a
+ *   latência desde o início da contenção
+ * - Eventos gravados no histórico de métricas
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../include/psi.h"
+#include "../include/cgroup_stats.h"
+#include "../include/process_monitor.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+void test_parse() {
+    printf("\n=== Teste 1: Parser ===\n");
+
+    PsiStat st;
+    const char *text = "some avg10=1.05 avg60=2.43 avg300=2.15 total=128514614\n"
+                       "full avg10=0.50 avg60=0.00 avg300=0.01 total=42\n";
+    assert_test("some e full", psi_parse(text, &st) && st.has_full && st.some.avg10 == 1.05 &&
+                st.some.avg60 == 2.43 && st.some.avg300 == 2.15 && st.some.total_us == 128514614ULL &&
+                st.full.avg10 == 0.50 && st.full.total_us == 42);
+    assert_test("Só some (cpu do host em kernels antigos)",
+                psi_parse("some avg10=0.00 avg60=0.00 avg300=0.00 total=7\n", &st) && !st.has_full &&
+                st.some.total_us == 7);
+    assert_test("Texto inválido", !psi_parse("", &st) && !psi_parse("full avg10=1 avg60=1 avg300=1 total=1", &st));
+
+    bool full;
+    uint64_t threshold, window;
+    assert_test("Gatilho \"some 150000 1000000\"", psi_parse_trigger("some 150000 1000000", &full, &threshold, &window) &&
+                !full && threshold == 150000 && window == 1000000);
+    assert_test("Gatilho full", psi_parse_trigger("full 50000 2000000", &full, &threshold, &window) && full);
+    assert_test("Gatilhos fora dos limites do kernel rejeitados",
+                !psi_parse_trigger("some 150000 100000", &full, &threshold, &window) &&     // janela < 500 ms
+                !psi_parse_trigger("some 150000 20000000", &full, &threshold, &window) &&   // janela > 10 s
+                !psi_parse_trigger("some 2000000 1000000", &full, &threshold, &window) &&   // limiar > janela
+                !psi_parse_trigger("some 0 1000000", &full, &threshold, &window) &&
+                !psi_parse_trigger("any 1 1000000", &full, &threshold, &window) &&
+                !psi_parse_trigger("some 1 1000000 x", &full, &threshold, &window));
+
+    PsiResource r;
+    assert_test("Nomes dos recursos", psi_resource_parse("memory", &r) && r == PSI_MEMORY &&
+                strcmp(psi_resource_name(PSI_IO), "io") == 0 && !psi_resource_parse("net", &r));
+}
+
+void test_read() {
+    printf("\n=== Teste 2: Leitura ===\n");
+
+    PsiStat a, b;
+    bool ok = true;
+    for (int r = 0; r < PSI_RESOURCES; r++) ok = ok && psi_read_host((PsiResource)r, &a);
+    assert_test("/proc/pressure/{cpu,memory,io}", ok);
+
+    // Totais acumulados nunca diminuem
+    psi_read_host(PSI_CPU, &a);
+    usleep(20000);
+    psi_read_host(PSI_CPU, &b);
+    assert_test("Total monotônico", b.some.total_us >= a.some.total_us && a.some.avg10 >= 0.0 &&
+                a.some.avg10 <= 100.0);
+
+    // cgroup v2: a raiz ou a hierarquia "unified" dos sistemas híbridos
+    const char *base = NULL;
+    static const char *const bases[] = { "", "unified" };
+    for (size_t i = 0; i < sizeof(bases) / sizeof(bases[0]) && !base; i++) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s/cpu.pressure", CGROUP_ROOT, bases[i]);
+        if (access(path, R_OK) == 0) base = bases[i];
+    }
+    if (!base) {
+        printf("%s Sem *.pressure em cgroup v2: leitura de cgroup pulada\n", TEST_INFO);
+    } else {
+        assert_test("<cgroup>/memory.pressure", psi_read_cgroup(base, PSI_MEMORY, &a) && a.has_full);
+    }
+    assert_test("Cgroup inexistente: false", !psi_read_cgroup("nao_existe_psi", PSI_CPU, &a));
+}
+
+static void record_event(const PsiEvent *ev, void *ctx) {
+    add_stall_event(ev, ctx);
+}
+
+void test_trigger() {
+    printf("\n=== Teste 3: Gatilho de CPU ===\n");
+
+    if (access("/proc/pressure/cpu", W_OK) != 0) {
+        printf("%s Sem permissão de escrita em /proc/pressure/cpu: gatilhos pulados\n", TEST_INFO);
+        return;
+    }
+    MetricsHistory *history = create_metrics_history(16);
+    assert_test("Histórico de eventos de pressão", history && metrics_history_enable_stalls(history, 8));
+    if (!history) return;
+
+    PsiMonitor m;
+    psi_monitor_init(&m, record_event, history);
+    int id = psi_monitor_add(&m, NULL, PSI_CPU, "some 50000 1000000");
+    assert_test("Gatilho registrado (janela ajustada sem CAP_SYS_RESOURCE)",
+                id == 0 && m.triggers[0].window_us % 1000000 == 0 &&
+                m.triggers[0].threshold_us * 20 == m.triggers[0].window_us);
+    printf("%s Gatilho efetivo: some %llu us em %llu us\n", TEST_INFO,
+           (unsigned long long)m.triggers[0].threshold_us, (unsigned long long)m.triggers[0].window_us);
+    assert_test("Gatilho inválido: -1", psi_monitor_add(&m, NULL, PSI_IO, "some 1 100") == -1 && m.count == 1);
+
+    // Eventos da atividade anterior ao teste descartados
+    while (psi_monitor_wait(&m, (int)(m.triggers[0].window_us / 1000)) > 0) {}
+    uint64_t before = metrics_history_stall_head(history);
+
+    // Contenção: dois processos ocupados por CPU disponível
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    int nbusy = (int)(cpus * 2 > 64 ? 64 : cpus * 2);
+    pid_t busy[64];
+    uint64_t start = monotonic_ns();
+    for (int i = 0; i < nbusy; i++) {
+        busy[i] = fork();
+        if (busy[i] == 0) {
+            for (;;) {}
+        }
+    }
+    uint64_t deadline = start + 2 * m.triggers[0].window_us * NSEC_PER_USEC;
+    while (metrics_history_stall_head(history) == before && monotonic_ns() < deadline) {
+        psi_monitor_wait(&m, 100);
+    }
+    for (int i = 0; i < nbusy; i++) {
+        if (busy[i] > 0) kill(busy[i], SIGKILL);
+    }
+    for (int i = 0; i < nbusy; i++) {
+        if (busy[i] > 0) waitpid(busy[i], NULL, 0);
+    }
+
+    PsiEvent ev;
+    bool got = metrics_history_stall_head(history) > before && metrics_history_read_stall(history, before, &ev);
+    assert_test("Evento de CPU no histórico", got && ev.resource == PSI_CPU && !ev.full && ev.trigger == 0 &&
+                strcmp(ev.source, "host") == 0);
+    if (got) {
+        printf("%s Contenção -> evento: %.1f ms (%.1f ms parados, avg10 %.2f%%)\n", TEST_INFO,
+               (double)(ev.mono_ns - start) / NSEC_PER_MSEC, ev.stall_us / 1000.0, ev.avg10);
+        // O kernel soma à janela atual a fração restante da anterior: o
+        // aumento desde a última leitura pode ficar abaixo do limiar
+        assert_test("Espera acumulada desde a leitura anterior", ev.stall_us > 0);
+    }
+    assert_test("Leitura fora da retenção: false", !metrics_history_read_stall(history, 1000, &ev));
+
+    psi_monitor_close(&m);
+    free_metrics_history(history);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - PSI (PRESSURE STALL INFORMATION)\n");
+    printf("===============================================================\n");
+
+    test_parse();
+    if (access("/proc/pressure/cpu", R_OK) != 0) {
+        printf("%s Kernel sem PSI: leitura e gatilhos pulados\n", TEST_INFO);
+    } else {
+        test_read();
+        test_trigger();
+    }
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
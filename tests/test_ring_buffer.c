@@ -0,0 +1,182 @@
+/**
+ * test_ring_buffer.c - Teste unitário para o ring buffer SPMC
+ *
+ * Testa:
+ * - Retenção fixa (sobrescreve as amostras mais antigas)
+ * - Leitura de posições não publicadas ou já sobrescritas
+ * - Histórico de métricas sobre o ring (memória limitada)
+ * - Produtor e leitores concorrentes sem locks (nenhuma leitura rasgada)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/ring_buffer.h"
+#include "../include/process_monitor.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+void test_retention() {
+    printf("\n=== Teste 1: Retenção fixa ===\n");
+
+    RingBuffer r;
+    assert_test("Inicialização (retenção 5 -> capacidade 8)", ring_init(&r, 5, sizeof(int)) && r.capacity == 8);
+
+    int out = -1;
+    assert_test("Ring vazio", ring_head(&r) == 0 && !ring_read_latest(&r, &out));
+
+    for (int i = 0; i < 20; i++) ring_push(&r, &i);
+
+    assert_test("head conta todas as publicações", ring_head(&r) == 20);
+    assert_test("oldest = head - capacidade", ring_oldest(&r) == 12);
+    assert_test("Posição retida legível", ring_read(&r, 12, &out) && out == 12);
+    assert_test("Mais recente", ring_read_latest(&r, &out) && out == 19);
+    assert_test("Posição sobrescrita rejeitada", !ring_read(&r, 11, &out));
+    assert_test("Posição futura rejeitada", !ring_read(&r, 20, &out));
+
+    ring_free(&r);
+}
+
+void test_metrics_history() {
+    printf("\n=== Teste 2: Histórico de métricas limitado ===\n");
+
+    MetricsHistory *h = create_metrics_history(16);
+    assert_test("Histórico criado", h != NULL);
+    if (!h) return;
+
+    for (int i = 0; i < 100; i++) {
+        ProcessMetrics m = {0};
+        m.pid = 1;
+        m.mono_ns = (uint64_t)(i + 1) * 1000000000ULL;
+        m.cpu_total_time = (unsigned long)i * 10;
+        add_metrics_sample(h, &m);
+    }
+
+    ProcessMetrics m;
+    uint64_t head = metrics_history_head(h);
+    uint64_t oldest = metrics_history_oldest(h);
+    assert_test("Somente as 16 últimas amostras retidas", head == 100 && head - oldest == 16);
+    assert_test("Amostra retida com CPU% calculado",
+                metrics_history_read(h, head - 1, &m) && m.cpu_usage_percent > 0.0);
+
+    free_metrics_history(h);
+}
+
+// Cada elemento carrega o mesmo valor em todas as palavras: uma leitura
+// rasgada (metade antiga, metade nova) é detectável
+typedef struct {
+    uint64_t words[16];
+} Pattern;
+
+#define STRESS_ITEMS 2000000
+
+static RingBuffer stress_ring;
+static atomic_int producer_done = 0;
+
+static void *producer(void *arg) {
+    (void)arg;
+    Pattern p;
+    for (uint64_t i = 0; i < STRESS_ITEMS; i++) {
+        for (int w = 0; w < 16; w++) p.words[w] = i;
+        ring_push(&stress_ring, &p);
+    }
+    atomic_store(&producer_done, 1);
+    return NULL;
+}
+
+typedef struct {
+    unsigned long reads;
+    unsigned long torn;
+    unsigned long wrong_pos;
+} ReaderStats;
+
+static void *reader(void *arg) {
+    ReaderStats *st = arg;
+    Pattern p;
+    while (!atomic_load(&producer_done)) {
+        uint64_t head = ring_head(&stress_ring);
+        for (uint64_t pos = ring_oldest(&stress_ring); pos < head; pos++) {
+            if (!ring_read(&stress_ring, pos, &p)) continue;
+            st->reads++;
+            for (int w = 1; w < 16; w++) {
+                if (p.words[w] != p.words[0]) {
+                    st->torn++;
+                    break;
+                }
+            }
+            if (p.words[0] != pos) st->wrong_pos++;
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_readers() {
+    printf("\n=== Teste 3: Produtor e leitores concorrentes ===\n");
+
+    ring_init(&stress_ring, 64, sizeof(Pattern));
+
+    pthread_t prod, readers[3];
+    ReaderStats stats[3];
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < 3; i++) pthread_create(&readers[i], NULL, reader, &stats[i]);
+    pthread_create(&prod, NULL, producer, NULL);
+
+    pthread_join(prod, NULL);
+    unsigned long reads = 0, torn = 0, wrong = 0;
+    for (int i = 0; i < 3; i++) {
+        pthread_join(readers[i], NULL);
+        reads += stats[i].reads;
+        torn += stats[i].torn;
+        wrong += stats[i].wrong_pos;
+    }
+
+    printf("%s %lu leituras concorrentes validadas\n", TEST_INFO, reads);
+    assert_test("Produtor publicou tudo", ring_head(&stress_ring) == STRESS_ITEMS);
+    assert_test("Nenhuma leitura rasgada", torn == 0);
+    assert_test("Cada posição devolve o próprio elemento", wrong == 0);
+
+    ring_free(&stress_ring);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - RING BUFFER SPMC\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_retention();
+    test_metrics_history();
+    test_concurrent_readers();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
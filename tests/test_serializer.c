@@ -0,0 +1,227 @@
+/**
+ * test_serializer.c - Teste unitário para o serializador sem printf
+ *
+ * Testa:
+ * - Inteiros com e sem sinal (incluindo extremos)
+ * - Números com casas fixas idênticos a printf("%.Nf"), inclusive empates
+ * - Escape de strings JSON
+ * - Blocos maiores que o buffer (writev) e buffer do chamador
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../include/serializer.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define TEST_FILE "/tmp/test_serializer.out"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+// Buffer em memória ligado a um arquivo temporário; out_text devolve o que
+// foi escrito desde out_reset
+static OutBuf out;
+static char text[1 << 16];
+
+static void out_reset(void) {
+    out.len = 0;
+}
+
+static const char *out_text(void) {
+    memcpy(text, out.data, out.len);
+    text[out.len] = '\0';
+    return text;
+}
+
+// xorshift64: sequência determinística
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+static uint64_t next_rand(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+void test_integers(void) {
+    printf("\n%s Testando inteiros...\n", TEST_INFO);
+
+    const int64_t values[] = { 0, 1, -1, 9, 10, 99, 100, -100, 12345, -987654321,
+                               INT64_MAX, INT64_MIN, 1700000000LL };
+    char expected[32];
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        out_reset();
+        out_i64(&out, values[i]);
+        snprintf(expected, sizeof(expected), "%lld", (long long)values[i]);
+        if (strcmp(out_text(), expected) != 0) ok = false;
+    }
+    assert_test("Inteiros com sinal (extremos)", ok);
+
+    ok = true;
+    out_reset();
+    out_u64(&out, UINT64_MAX);
+    ok = strcmp(out_text(), "18446744073709551615") == 0;
+    for (int i = 0; i < 100000 && ok; i++) {
+        uint64_t v = next_rand() >> (next_rand() % 64);
+        out_reset();
+        out_u64(&out, v);
+        snprintf(expected, sizeof(expected), "%llu", (unsigned long long)v);
+        ok = strcmp(out_text(), expected) == 0;
+    }
+    assert_test("Inteiros sem sinal (100000 aleatórios)", ok);
+}
+
+void test_fixed(void) {
+    printf("\n%s Testando casas decimais fixas...\n", TEST_INFO);
+
+    // Empates exatos e quase empates, onde o arredondamento é delicado
+    const double values[] = { 0.0, -0.0, 0.125, 0.375, 2.675, 1.005, 0.005, 99.995,
+                              -0.001, -1.5, 123456.789, 1e14, 1e20, 3.14159265 };
+    char expected[64];
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        for (int d = 0; d <= 4; d++) {
+            out_reset();
+            out_fixed(&out, values[i], d);
+            snprintf(expected, sizeof(expected), "%.*f", d, values[i]);
+            if (strcmp(out_text(), expected) != 0) {
+                printf("  %.*f: '%s' != '%s'\n", d, values[i], out_text(), expected);
+                ok = false;
+            }
+        }
+    }
+    assert_test("Casos de arredondamento iguais a printf", ok);
+
+    ok = true;
+    for (int i = 0; i < 200000 && ok; i++) {
+        // Percentuais, taxas e valores com poucas casas (muitos empates)
+        double v;
+        switch (i % 3) {
+            case 0: v = (double)(next_rand() % 100000) / 1000.0; break;
+            case 1: v = (double)(int64_t)(next_rand() % 2000001 - 1000000) / 8.0; break;
+            default: v = (double)(next_rand() >> 11) / (double)(1ULL << 30); break;
+        }
+        out_reset();
+        out_fixed(&out, v, 2);
+        snprintf(expected, sizeof(expected), "%.2f", v);
+        ok = strcmp(out_text(), expected) == 0;
+        if (!ok) printf("  %.17g: '%s' != '%s'\n", v, out_text(), expected);
+    }
+    assert_test("200000 valores aleatórios iguais a %.2f", ok);
+
+    out_reset();
+    out_fixed(&out, NAN, 2);
+    snprintf(expected, sizeof(expected), "%.2f", NAN);
+    ok = strcmp(out_text(), expected) == 0;
+    out_reset();
+    out_fixed(&out, -INFINITY, 2);
+    snprintf(expected, sizeof(expected), "%.2f", -INFINITY);
+    assert_test("NaN e infinito como printf", ok && strcmp(out_text(), expected) == 0);
+}
+
+void test_json_string(void) {
+    printf("\n%s Testando strings JSON...\n", TEST_INFO);
+
+    out_reset();
+    out_json_str(&out, "bash");
+    assert_test("String simples", strcmp(out_text(), "\"bash\"") == 0);
+
+    out_reset();
+    out_json_str(&out, "a\"b\\c\nd\x01");
+    assert_test("Escape de aspas, barra e controle",
+                strcmp(out_text(), "\"a\\\"b\\\\c\\u000ad\\u0001\"") == 0);
+
+    out_reset();
+    out_json_str(&out, "café");
+    assert_test("UTF-8 preservado", strcmp(out_text(), "\"café\"") == 0);
+}
+
+void test_flush(void) {
+    printf("\n%s Testando escrita em arquivo...\n", TEST_INFO);
+
+    // Buffer pequeno do chamador: força flushes e o caminho de writev
+    char small[64];
+    OutBuf o;
+    int fd = open(TEST_FILE, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert_test("Buffer do chamador", fd >= 0 && out_init(&o, fd, small, sizeof(small)));
+
+    char big[1000];
+    memset(big, 'x', sizeof(big));
+    size_t expected = 0;
+    for (int i = 0; i < 100; i++) {
+        out_u64(&o, (uint64_t)i);
+        expected += (i < 10) ? 1 : 2;
+        out_lit(&o, ",");
+        expected++;
+        if (i % 10 == 0) {
+            out_write(&o, big, sizeof(big));
+            expected += sizeof(big);
+        }
+    }
+    assert_test("Fechar", out_close(&o));
+    close(fd);
+
+    FILE *fp = fopen(TEST_FILE, "r");
+    size_t size = 0;
+    bool order_ok = false;
+    if (fp) {
+        char head[8] = {0};
+        order_ok = fread(head, 1, 2, fp) == 2 && strcmp(head, "0,") == 0;
+        fseek(fp, 0, SEEK_END);
+        size = (size_t)ftell(fp);
+        fclose(fp);
+    }
+    assert_test("Tamanho e ordem preservados", size == expected && o.written == expected && order_ok);
+    unlink(TEST_FILE);
+
+    assert_test("Erro ao abrir diretório inexistente", !out_open(&o, "/nonexistent/dir/file"));
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - SERIALIZADOR\n");
+    printf("===============================================================\n");
+
+    out_init(&out, -1, NULL, sizeof(text) - 1);
+
+    // Executar testes
+    test_integers();
+    test_fixed();
+    test_json_string();
+    test_flush();
+
+    free(out.data);
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,324 @@
+/**
+ * test_sock_diag.c - Teste unitário para a rede por processo (sock_diag)
+ *
+ * Testa:
+ * - Atribuição dos sockets TCP/UDP ao processo dono
+ * - Filas de recepção e bytes do TCP_INFO
+ * - Bytes de sockets fechados mantidos no total acumulado
+ * - Cache da lista de sockets (relista só quando os fds mudam)
+ * - Sockets de outro processo não são contados
+ * - Processo que troca de namespace de rede (unshare) continua medido
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sched.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../include/sock_diag.h"
+#include "../include/process_monitor.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define PAYLOAD 5000
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+// Conexão TCP em loopback: servidor em escuta, cliente e lado aceito
+typedef struct {
+    int listener;
+    int client;
+    int server;
+} TcpPair;
+
+static bool tcp_pair_open(TcpPair *p) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof(addr);
+    p->listener = socket(AF_INET, SOCK_STREAM, 0);
+    p->client = socket(AF_INET, SOCK_STREAM, 0);
+    if (p->listener < 0 || p->client < 0 ||
+        bind(p->listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(p->listener, 1) < 0 ||
+        getsockname(p->listener, (struct sockaddr *)&addr, &len) < 0 ||
+        connect(p->client, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        return false;
+    }
+    p->server = accept(p->listener, NULL, NULL);
+    return p->server >= 0;
+}
+
+static void tcp_pair_close(TcpPair *p) {
+    close(p->server);
+    close(p->client);
+    close(p->listener);
+}
+
+// Socket UDP com porta: sem bind o kernel não o lista no inet_diag
+static int udp_socket(int family) {
+    int fd = socket(family, SOCK_DGRAM, 0);
+    if (family == AF_INET) {
+        struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+        bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    } else {
+        struct sockaddr_in6 addr = { .sin6_family = AF_INET6, .sin6_addr = IN6ADDR_LOOPBACK_INIT };
+        bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    }
+    return fd;
+}
+
+// Envia e espera os bytes chegarem à fila do outro lado
+static bool send_payload(TcpPair *p) {
+    char buf[PAYLOAD];
+    memset(buf, 'x', sizeof(buf));
+    if (send(p->client, buf, sizeof(buf), 0) != PAYLOAD) return false;
+    char peek[PAYLOAD];
+    for (int i = 0; i < 100; i++) {
+        if (recv(p->server, peek, sizeof(peek), MSG_PEEK | MSG_DONTWAIT) == PAYLOAD) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+void test_own_sockets(ProcHandle *h) {
+    printf("\n%s Testando sockets do próprio processo...\n", TEST_INFO);
+
+    ProcSockets ps;
+    proc_sockets_init(&ps);
+    NetUsage before, queued, drained;
+    assert_test("Coleta sem sockets inet", proc_sockets_collect(&ps, h, &before) &&
+                before.tcp_sockets == 0 && before.udp_sockets == 0);
+
+    TcpPair p;
+    if (!tcp_pair_open(&p)) {
+        assert_test("Conexão TCP em loopback", false);
+        proc_sockets_free(&ps);
+        return;
+    }
+    bool sent = send_payload(&p);
+    assert_test("Dados enviados e não lidos", sent);
+
+    bool ok = proc_sockets_collect(&ps, h, &queued);
+    assert_test("Três sockets TCP atribuídos (escuta, cliente, aceito)", ok && queued.tcp_sockets == 3);
+    assert_test("Fila de recepção com os dados não lidos", ok && queued.rx_queue >= PAYLOAD);
+    assert_test("Bytes enviados (TCP_INFO)", ok && queued.bytes_sent >= PAYLOAD && queued.segs_out > 0);
+    printf("  rx_queue %llu | enviados %llu | recebidos %llu | segmentos %llu/%llu\n",
+           (unsigned long long)queued.rx_queue, (unsigned long long)queued.bytes_sent,
+           (unsigned long long)queued.bytes_received, (unsigned long long)queued.segs_in,
+           (unsigned long long)queued.segs_out);
+
+    char buf[PAYLOAD];
+    ssize_t got = recv(p.server, buf, sizeof(buf), MSG_WAITALL);
+    ok = proc_sockets_collect(&ps, h, &drained);
+    assert_test("Fila vazia depois da leitura", ok && got == PAYLOAD && drained.rx_queue == 0);
+    assert_test("Bytes recebidos (TCP_INFO)", ok && drained.bytes_received >= PAYLOAD);
+
+    ProcessMetrics m;
+    ok = collect_process_metrics(getpid(), &m);
+    assert_test("ProcessMetrics com os sockets do processo",
+                ok && m.net_connections == 3 && m.net_rx_bytes >= PAYLOAD && m.net_tx_bytes >= PAYLOAD);
+
+    // Os bytes dos sockets fechados continuam no total
+    NetUsage closed;
+    tcp_pair_close(&p);
+    ok = proc_sockets_collect(&ps, h, &closed);
+    assert_test("Sockets fechados saem da contagem", ok && closed.tcp_sockets == 0);
+    assert_test("Bytes de sockets fechados mantidos no total",
+                ok && closed.bytes_received >= drained.bytes_received && closed.bytes_sent >= drained.bytes_sent &&
+                closed.segs_out >= drained.segs_out);
+    proc_sockets_free(&ps);
+}
+
+void test_cache(ProcHandle *h) {
+    printf("\n%s Testando cache da lista de sockets...\n", TEST_INFO);
+
+    ProcSockets ps;
+    proc_sockets_init(&ps);
+    NetUsage u;
+    TcpPair p;
+    if (!tcp_pair_open(&p)) {
+        assert_test("Conexão TCP em loopback", false);
+        return;
+    }
+
+    bool ok = proc_sockets_collect(&ps, h, &u);
+    assert_test("Primeira coleta lista os fds e consulta todos os tipos",
+                ok && ps.relisted && ps.dumps == SOCK_KIND_COUNT - SOCK_KIND_TCP4);
+
+    // O socket netlink do próprio coletor muda a contagem de fds uma vez
+    ok = proc_sockets_collect(&ps, h, &u) && proc_sockets_collect(&ps, h, &u);
+    if (!ps.count_supported) {
+        printf("  %s Kernel sem contagem de fds (< 6.2): relista a cada amostra\n", TEST_INFO);
+    } else {
+        assert_test("Mesmos fds: sem relistar e só o dump de TCP4", ok && !ps.relisted && ps.dumps == 1);
+    }
+
+    int udp = udp_socket(AF_INET);
+    ok = proc_sockets_collect(&ps, h, &u);
+    assert_test("Novo socket: relista e classifica o UDP", ok && ps.relisted && u.udp_sockets == 1 &&
+                u.tcp_sockets == 3);
+
+    // Troca um socket TCP por um arquivo: o número de fds não muda
+    int file = open("/dev/null", O_RDONLY);
+    dup2(file, p.client);
+    close(file);
+    close(udp);
+    udp = udp_socket(AF_INET);
+    ok = proc_sockets_collect(&ps, h, &u);
+    bool stale = ps.stale;
+    ok = ok && proc_sockets_collect(&ps, h, &u);
+    assert_test("Socket substituído: marcado para relistar", stale && ps.relisted);
+    assert_test("Contagem atualizada após a troca", ok && u.tcp_sockets == 2 && u.udp_sockets == 1);
+
+    close(udp);
+    tcp_pair_close(&p);
+    proc_sockets_free(&ps);
+}
+
+void test_other_process(ProcHandle *self) {
+    printf("\n%s Testando sockets de outro processo...\n", TEST_INFO);
+
+    int ready[2];
+    if (pipe(ready) < 0) return;
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        int s1 = udp_socket(AF_INET);
+        int s2 = udp_socket(AF_INET6);
+        (void)s1;
+        (void)s2;
+        if (write(ready[1], "", 1) < 0) _exit(1);
+        pause();
+        _exit(0);
+    }
+    close(ready[1]);
+    char c;
+    bool started = read(ready[0], &c, 1) == 1;
+    close(ready[0]);
+
+    ProcHandle h = {0};
+    ProcSockets ps, own;
+    proc_sockets_init(&ps);
+    proc_sockets_init(&own);
+    NetUsage u, mine;
+    bool ok = started && proc_handle_open(&h, child) && proc_sockets_collect(&ps, &h, &u);
+    assert_test("Sockets UDP do filho atribuídos a ele", ok && u.udp_sockets == 2 && u.tcp_sockets == 0);
+    ok = proc_sockets_collect(&own, self, &mine);
+    assert_test("Sockets do filho fora da conta do pai", ok && mine.udp_sockets == 0);
+
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    proc_sockets_free(&ps);
+    assert_test("Processo terminado rejeitado", !proc_sockets_collect(&ps, &h, &u));
+    proc_sockets_free(&ps);
+    proc_sockets_free(&own);
+    proc_handle_close(&h);
+}
+
+void test_netns_change() {
+    printf("\n%s Testando troca de namespace de rede...\n", TEST_INFO);
+
+    // O filho abre um socket UDP, espera o pai medir, troca de namespace
+    // (unshare) e recria o socket lá dentro
+    int ready[2], go[2];
+    if (pipe(ready) < 0 || pipe(go) < 0) return;
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        close(go[1]);
+        int s = udp_socket(AF_INET);
+        char c = 1;
+        if (write(ready[1], &c, 1) < 0 || read(go[0], &c, 1) != 1) _exit(1);
+        close(s);
+        c = 0;
+        if (unshare(CLONE_NEWNET) == 0) {
+            // lo vem desligado no namespace novo: sem bind em loopback
+            s = socket(AF_INET, SOCK_DGRAM, 0);
+            struct sockaddr_in addr = { .sin_family = AF_INET };
+            c = (s >= 0 && bind(s, (struct sockaddr *)&addr, sizeof(addr)) == 0) ? 1 : 0;
+        }
+        if (write(ready[1], &c, 1) < 0) _exit(1);
+        pause();
+        _exit(0);
+    }
+    close(ready[1]);
+    close(go[0]);
+
+    ProcHandle h = {0};
+    ProcSockets ps;
+    proc_sockets_init(&ps);
+    NetUsage u;
+    char c = 0;
+    bool ok = read(ready[0], &c, 1) == 1 && proc_handle_open(&h, child) && proc_sockets_collect(&ps, &h, &u);
+    assert_test("Socket no namespace original", ok && u.udp_sockets == 1);
+    uint64_t before = ps.netns;
+
+    c = 1;
+    bool moved = write(go[1], &c, 1) == 1 && read(ready[0], &c, 1) == 1 && c == 1;
+    if (!moved) {
+        printf("%s Sem permissão para unshare(CLONE_NEWNET): troca de namespace pulada\n", TEST_INFO);
+    } else {
+        ok = proc_sockets_collect(&ps, &h, &u);
+        assert_test("Socket no namespace novo após o unshare", ok && u.udp_sockets == 1 && ps.netns != before);
+    }
+
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    close(ready[0]);
+    close(go[1]);
+    proc_sockets_free(&ps);
+    proc_handle_close(&h);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - REDE POR PROCESSO (SOCK_DIAG)\n");
+    printf("===============================================================\n");
+
+    ProcHandle self = {0};
+    if (!proc_handle_open(&self, getpid())) {
+        printf("%s Não foi possível abrir /proc/self\n", TEST_FAILED);
+        return 1;
+    }
+
+    // Executar testes
+    test_own_sockets(&self);
+    test_cache(&self);
+    test_other_process(&self);
+    test_netns_change();
+    proc_handle_close(&self);
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,329 @@
+/**
+ * test_stats.c - Teste unitário para as estatísticas incrementais
+ *
+ * Testa:
+ * - Média e variância de Welford contra o cálculo exato
+ * - Combinação (merge) equivalente a somar todas as amostras
+ * - Média exponencial com meia-vida no tempo
+ * - Máximo em janela deslizante contra a força bruta
+ * - Quantis do DDSketch dentro do erro relativo garantido
+ * - Exportação do resumo em JSON
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/stats.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define SAMPLES 20000
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+// Gerador determinístico (xorshift) para não depender de rand()
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static double uniform(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (double)(rng_state >> 11) / (double)(1ULL << 53);
+}
+
+// Log-normal: cauda longa, como latências e taxas de I/O
+static double lognormal(double mu, double sigma) {
+    double u1 = uniform(), u2 = uniform();
+    if (u1 < 1e-300) u1 = 1e-300;
+    double z = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    return exp(mu + sigma * z);
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Quantil exato com a mesma convenção de posição do sketch
+static double exact_quantile(const double *sorted, size_t n, double q) {
+    return sorted[(size_t)(q * (double)(n - 1))];
+}
+
+static bool within(double approx, double exact, double rel) {
+    return fabs(approx - exact) <= rel * fabs(exact) + 1e-12;
+}
+
+void test_running_stats(void) {
+    printf("\n%s Testando média e variância (Welford)...\n", TEST_INFO);
+
+    static double values[SAMPLES];
+    RunningStats s;
+    running_stats_init(&s);
+    double sum = 0.0;
+    for (int i = 0; i < SAMPLES; i++) {
+        // Deslocamento grande: o cálculo ingênuo (soma dos quadrados) perde precisão
+        values[i] = 1e9 + uniform() * 100.0;
+        running_stats_add(&s, values[i]);
+        sum += values[i] - 1e9;
+    }
+    double mean = 1e9 + sum / SAMPLES;
+    double m2 = 0.0;
+    for (int i = 0; i < SAMPLES; i++) m2 += (values[i] - mean) * (values[i] - mean);
+    double variance = m2 / (SAMPLES - 1);
+
+    assert_test("Contagem de amostras", s.count == SAMPLES);
+    assert_test("Média igual à exata", within(s.mean, mean, 1e-12));
+    assert_test("Variância igual à exata (valores deslocados)", within(running_stats_variance(&s), variance, 1e-6));
+    printf("  média %.6f | desvio padrão %.6f (exato %.6f)\n", s.mean - 1e9,
+           running_stats_stddev(&s), sqrt(variance));
+
+    // Dividido em duas partes e combinado
+    RunningStats a, b;
+    running_stats_init(&a);
+    running_stats_init(&b);
+    for (int i = 0; i < SAMPLES; i++) running_stats_add(i < SAMPLES / 3 ? &a : &b, values[i]);
+    running_stats_merge(&a, &b);
+    assert_test("Merge: mesma contagem, mínimo e máximo",
+                a.count == s.count && a.min == s.min && a.max == s.max);
+    assert_test("Merge: mesma média e variância",
+                within(a.mean, s.mean, 1e-12) &&
+                within(running_stats_variance(&a), running_stats_variance(&s), 1e-6));
+
+    RunningStats empty, one;
+    running_stats_init(&empty);
+    running_stats_init(&one);
+    running_stats_add(&one, 42.0);
+    running_stats_merge(&empty, &one);
+    assert_test("Uma amostra: variância zero", running_stats_variance(&one) == 0.0 &&
+                empty.count == 1 && empty.mean == 42.0);
+}
+
+void test_ewma(void) {
+    printf("\n%s Testando média exponencial...\n", TEST_INFO);
+
+    const uint64_t half_life = 10ULL * 1000000000ULL;
+    Ewma e;
+    ewma_init(&e, half_life);
+    ewma_add(&e, 100.0, 0);
+    assert_test("Primeira amostra define o valor", e.primed && e.value == 100.0);
+
+    // Degrau para zero: após uma meia-vida o desvio cai à metade
+    ewma_add(&e, 0.0, half_life);
+    assert_test("Uma meia-vida: metade do caminho", fabs(e.value - 50.0) < 1e-9);
+
+    // Mesma duração em passos menores dá o mesmo resultado
+    Ewma fine;
+    ewma_init(&fine, half_life);
+    ewma_add(&fine, 100.0, 0);
+    for (int i = 0; i < 10; i++) ewma_add(&fine, 0.0, half_life / 10);
+    assert_test("Independente do intervalo de coleta", fabs(fine.value - 50.0) < 1e-9);
+
+    ewma_add(&e, 0.0, 0);
+    assert_test("Intervalo zero não altera o valor", fabs(e.value - 50.0) < 1e-9);
+}
+
+// Máximo das últimas width amostras por força bruta
+static double brute_max(const double *v, int n, int width) {
+    double m = v[n - 1];
+    for (int i = n - width < 0 ? 0 : n - width; i < n; i++) {
+        if (v[i] > m) m = v[i];
+    }
+    return m;
+}
+
+void test_window_max(void) {
+    printf("\n%s Testando máximo em janela deslizante...\n", TEST_INFO);
+
+    enum { N = 4 * WINDOW_MAX_LEN };
+    static double v[N];
+    WindowMax w;
+
+    // Janela com a largura máxima e sequência estritamente decrescente: a
+    // deque fica cheia de candidatos a cada amostra
+    window_max_init(&w, WINDOW_MAX_LEN);
+    bool ok = true;
+    for (int i = 0; i < N; i++) {
+        v[i] = 1000.0 - i;
+        window_max_add(&w, v[i]);
+        if (window_max_get(&w) != brute_max(v, i + 1, WINDOW_MAX_LEN) || w.count > WINDOW_MAX_LEN) ok = false;
+    }
+    assert_test("Decrescente na largura máxima: máximo exato", ok);
+
+    // Valores pseudoaleatórios em várias larguras
+    ok = true;
+    static const int widths[] = { 1, 2, 7, 60, WINDOW_MAX_LEN };
+    for (size_t k = 0; k < sizeof(widths) / sizeof(widths[0]); k++) {
+        window_max_init(&w, widths[k]);
+        uint32_t seed = 12345;
+        for (int i = 0; i < N; i++) {
+            seed = seed * 1103515245u + 12345u;
+            v[i] = (double)((seed >> 16) % 1000);
+            window_max_add(&w, v[i]);
+            if (window_max_get(&w) != brute_max(v, i + 1, widths[k])) ok = false;
+        }
+    }
+    assert_test("Valores aleatórios: igual à força bruta", ok);
+
+    window_max_init(&w, 4);
+    assert_test("Sem amostras: zero", window_max_get(&w) == 0.0);
+}
+
+void test_ddsketch(void) {
+    printf("\n%s Testando quantis do DDSketch...\n", TEST_INFO);
+
+    static double values[SAMPLES];
+    static const double qs[] = { 0.01, 0.25, 0.50, 0.75, 0.90, 0.95, 0.99, 0.999 };
+    const size_t nq = sizeof(qs) / sizeof(qs[0]);
+
+    // Uniforme (CPU%) e log-normal (I/O) cobrindo várias ordens de grandeza
+    for (int dist = 0; dist < 2; dist++) {
+        DDSketch d;
+        ddsketch_init(&d);
+        for (int i = 0; i < SAMPLES; i++) {
+            values[i] = dist == 0 ? 0.01 + uniform() * 400.0 : lognormal(10.0, 3.0);
+            ddsketch_add(&d, values[i]);
+        }
+        qsort(values, SAMPLES, sizeof(double), compare_double);
+
+        double worst = 0.0;
+        bool ok = true;
+        for (size_t i = 0; i < nq; i++) {
+            double exact = exact_quantile(values, SAMPLES, qs[i]);
+            double approx = ddsketch_quantile(&d, qs[i]);
+            double err = fabs(approx - exact) / exact;
+            if (err > worst) worst = err;
+            if (!within(approx, exact, DDSKETCH_ALPHA)) ok = false;
+        }
+        printf("  %s: maior erro relativo %.4f%%\n", dist == 0 ? "uniforme" : "log-normal", worst * 100);
+        assert_test(dist == 0 ? "Uniforme: erro relativo <= alpha" : "Log-normal: erro relativo <= alpha", ok);
+    }
+
+    // Merge de dois sketches é idêntico ao sketch de todas as amostras
+    DDSketch all, a, b;
+    ddsketch_init(&all);
+    ddsketch_init(&a);
+    ddsketch_init(&b);
+    for (int i = 0; i < SAMPLES; i++) {
+        double x = lognormal(5.0, 1.0);
+        ddsketch_add(&all, x);
+        ddsketch_add(i % 2 ? &a : &b, x);
+    }
+    ddsketch_merge(&a, &b);
+    bool same = a.count == all.count && a.zero_count == all.zero_count;
+    for (size_t i = 0; i < nq; i++) same = same && ddsketch_quantile(&a, qs[i]) == ddsketch_quantile(&all, qs[i]);
+    assert_test("Merge: mesmos quantis do sketch completo", same);
+
+    // Zeros (processo ocioso) ficam no balde zero
+    DDSketch idle;
+    ddsketch_init(&idle);
+    for (int i = 0; i < 90; i++) ddsketch_add(&idle, 0.0);
+    for (int i = 0; i < 10; i++) ddsketch_add(&idle, 50.0);
+    assert_test("Balde zero: p50 de um processo ocioso é 0",
+                idle.zero_count == 90 && ddsketch_quantile(&idle, 0.50) == 0.0);
+    assert_test("Balde zero: p95 nos valores positivos", within(ddsketch_quantile(&idle, 0.95), 50.0, DDSKETCH_ALPHA));
+
+    DDSketch empty;
+    ddsketch_init(&empty);
+    assert_test("Sketch vazio retorna 0", ddsketch_quantile(&empty, 0.99) == 0.0);
+
+    // Memória constante: a estrutura não cresce com as amostras
+    assert_test("Memória constante (tamanho fixo da estrutura)",
+                sizeof(DDSketch) == 2 * sizeof(uint64_t) + DDSKETCH_BINS * sizeof(uint32_t));
+    printf("  %zu bytes por sketch, %zu por resumo de coletor\n", sizeof(DDSketch), sizeof(MetricsSummary));
+}
+
+void test_metric_summary(void) {
+    printf("\n%s Testando resumo por métrica...\n", TEST_INFO);
+
+    MetricSummary m;
+    metric_summary_init(&m, SUMMARY_EWMA_HALF_LIFE_NS);
+    for (int i = 1; i <= 100; i++) metric_summary_add(&m, (double)i, 1000000000ULL);
+
+    SummaryStats st;
+    metric_summary_get(&m, &st);
+    assert_test("Contagem, mínimo e máximo exatos", st.count == 100 && st.min == 1.0 && st.max == 100.0);
+    assert_test("Média exata", fabs(st.mean - 50.5) < 1e-9);
+    assert_test("Quantis dentro do erro", within(st.p50, 50.0, DDSKETCH_ALPHA) &&
+                within(st.p95, 95.0, DDSKETCH_ALPHA) && within(st.p99, 99.0, DDSKETCH_ALPHA));
+    assert_test("Quantis limitados a [min, max]", st.p50 >= st.min && st.p99 <= st.max);
+    assert_test("EWMA entre a média e o último valor", st.ewma > st.mean && st.ewma < st.max);
+
+    // Valor constante: o ponto do balde é limitado ao valor exato
+    MetricSummary flat;
+    metric_summary_init(&flat, SUMMARY_EWMA_HALF_LIFE_NS);
+    for (int i = 0; i < 50; i++) metric_summary_add(&flat, 12.5, 1000000000ULL);
+    metric_summary_get(&flat, &st);
+    assert_test("Série constante: quantis exatos e desvio zero",
+                st.p50 == 12.5 && st.p99 == 12.5 && st.stddev == 0.0);
+}
+
+void test_export_json(void) {
+    printf("\n%s Testando exportação do resumo...\n", TEST_INFO);
+
+    MetricsSummary s;
+    metrics_summary_init(&s);
+    for (int i = 1; i <= 10; i++) {
+        metrics_summary_add(&s, i * 10.0, 1024.0 * 1024.0 * i, 4096.0, 0.0, 1000000000ULL);
+    }
+
+    const char *path = "/tmp/test_stats_summary.json";
+    bool ok = metrics_summary_export_json(&s, 1234, path);
+    assert_test("Arquivo gravado", ok);
+
+    char buf[4096] = {0};
+    FILE *f = fopen(path, "r");
+    size_t len = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+    if (f) fclose(f);
+    remove(path);
+
+    assert_test("PID e parâmetros do resumo", len > 0 && strstr(buf, "\"pid\": 1234") &&
+                strstr(buf, "\"quantile_relative_error\": 0.010"));
+    assert_test("Uma entrada por métrica", strstr(buf, "\"cpu_percent\": {\"count\": 10") &&
+                strstr(buf, "\"memory_rss_bytes\"") && strstr(buf, "\"io_read_bps\"") &&
+                strstr(buf, "\"io_write_bps\""));
+    assert_test("Valores exatos de mínimo e máximo", strstr(buf, "\"min\": 10.00, \"max\": 100.00") != NULL);
+    assert_test("Chaves entre aspas e objeto fechado", strstr(buf, "\"p99\": ") && buf[len - 2] == '}');
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - ESTATÍSTICAS INCREMENTAIS\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_running_stats();
+    test_ewma();
+    test_window_max();
+    test_ddsketch();
+    test_metric_summary();
+    test_export_json();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,279 @@
+/**
+ * test_stream_export.c - Teste unitário para a exportação incremental
+ *
+ * Testa:
+ * - Arquivo legível durante a captura (antes de stream_export_close)
+ * - NDJSON, CSV e JSON completos após o fechamento
+ * - Formato binário (.rmts) com leitura dos blocos gravados
+ * - Produtor sem espera por I/O e contadores consistentes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/stream_export.h"
+#include "../include/monitor.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define TEST_FILE "/tmp/test_stream_export.out"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+static void make_metrics(ProcessMetrics *m, int i) {
+    memset(m, 0, sizeof(ProcessMetrics));
+    m->pid = 4242;
+    snprintf(m->process_name, sizeof(m->process_name), "stream-test");
+    m->mono_ns = (uint64_t)(i + 1) * NSEC_PER_SEC;
+    m->real_ns = 1700000000ULL * NSEC_PER_SEC + m->mono_ns;
+    m->timestamp = (time_t)(m->real_ns / NSEC_PER_SEC);
+    m->cpu_user_time = 100 + (unsigned long)i;
+    m->cpu_usage_percent = (double)(i % 100);
+    m->num_threads = 4;
+    m->mem_rss = 1L << 20;
+}
+
+static void make_resource(ResourceData *d, int i) {
+    memset(d, 0, sizeof(ResourceData));
+    d->pid = 4242;
+    d->timestamp = 1700000000 + i;
+    d->real_ns = (uint64_t)d->timestamp * NSEC_PER_SEC;
+    d->cpu_usage_percent = 1.5;
+    d->memory_rss = 100 + i;
+}
+
+// Conta linhas e uma substring no arquivo
+static size_t count_in_file(const char *path, const char *needle, size_t *lines) {
+    FILE *fp = fopen(path, "r");
+    size_t matches = 0;
+    if (lines) *lines = 0;
+    if (!fp) return 0;
+
+    char line[4096];
+    while (fgets(line, sizeof(line), fp)) {
+        if (lines) (*lines)++;
+        for (const char *p = line; (p = strstr(p, needle)) != NULL; p++) matches++;
+    }
+    fclose(fp);
+    return matches;
+}
+
+// Espera (até 5s) a thread escritora gravar pelo menos `lines` linhas
+static size_t wait_for_lines(const char *path, size_t lines) {
+    size_t n = 0;
+    for (int i = 0; i < 500; i++) {
+        count_in_file(path, "\n", &n);
+        if (n >= lines) break;
+        usleep(10000);
+    }
+    return n;
+}
+
+void test_ndjson(void) {
+    printf("\n%s Testando NDJSON...\n", TEST_INFO);
+
+    StreamExporter e;
+    assert_test("Abrir exportador NDJSON", stream_export_open(&e, TEST_FILE, STREAM_PROCESS_METRICS, EXPORT_NDJSON));
+
+    ProcessMetrics m;
+    for (int i = 0; i < 10; i++) {
+        make_metrics(&m, i);
+        stream_export_append(&e, &m);
+    }
+
+    // Lote menor que STREAM_BATCH_SAMPLES: gravado pelo temporizador de flush
+    assert_test("Amostras no disco antes do fechamento", wait_for_lines(TEST_FILE, 10) == 10);
+
+    assert_test("Fechar exportador", stream_export_close(&e));
+    size_t lines = 0;
+    size_t objects = count_in_file(TEST_FILE, "\"process_name\":\"stream-test\"", &lines);
+    assert_test("Uma linha por amostra", lines == 10 && objects == 10);
+    assert_test("Contadores", e.appended == 10 && e.written == 10 && e.dropped == 0);
+    unlink(TEST_FILE);
+}
+
+void test_csv(void) {
+    printf("\n%s Testando CSV...\n", TEST_INFO);
+
+    StreamExporter e;
+    assert_test("Abrir exportador CSV", stream_export_open(&e, TEST_FILE, STREAM_RESOURCE_DATA, EXPORT_CSV));
+
+    // Cabeçalho gravado na abertura
+    assert_test("Cabeçalho imediato", count_in_file(TEST_FILE, "timestamp,timestamp_ns,pid", NULL) == 1);
+
+    ResourceData d;
+    for (int i = 0; i < STREAM_BATCH_SAMPLES; i++) {
+        make_resource(&d, i);
+        stream_export_append(&e, &d);
+    }
+    // Lote completo acorda a escritora sem esperar o flush periódico
+    assert_test("Lote completo gravado", wait_for_lines(TEST_FILE, STREAM_BATCH_SAMPLES + 1) == STREAM_BATCH_SAMPLES + 1);
+
+    stream_export_close(&e);
+    size_t lines = 0;
+    count_in_file(TEST_FILE, ",", &lines);
+    assert_test("Cabeçalho + linhas", lines == STREAM_BATCH_SAMPLES + 1);
+    unlink(TEST_FILE);
+}
+
+void test_json(void) {
+    printf("\n%s Testando JSON...\n", TEST_INFO);
+
+    StreamExporter e;
+    stream_export_open(&e, TEST_FILE, STREAM_PROCESS_METRICS, EXPORT_JSON);
+    ProcessMetrics m;
+    for (int i = 0; i < 100; i++) {
+        make_metrics(&m, i);
+        stream_export_append(&e, &m);
+    }
+    assert_test("Fechar documento de processo", stream_export_close(&e));
+    assert_test("Cabeçalho da sessão", count_in_file(TEST_FILE, "\"monitoring_session\"", NULL) == 1);
+    assert_test("Todas as amostras", count_in_file(TEST_FILE, "\"usage_percent\"", NULL) == 100);
+    assert_test("Contagem no rodapé", count_in_file(TEST_FILE, "\"sample_count\": 100", NULL) == 1);
+    unlink(TEST_FILE);
+
+    stream_export_open(&e, TEST_FILE, STREAM_RESOURCE_DATA, EXPORT_JSON);
+    ResourceData d;
+    for (int i = 0; i < 5; i++) {
+        make_resource(&d, i);
+        stream_export_append(&e, &d);
+    }
+    stream_export_close(&e);
+    assert_test("Array de ResourceData", count_in_file(TEST_FILE, "\"memory_rss_pages\"", NULL) == 5 &&
+                                         count_in_file(TEST_FILE, "},", NULL) == 4 &&
+                                         count_in_file(TEST_FILE, "]", NULL) == 1);
+    unlink(TEST_FILE);
+
+    // Sem amostras: documento vazio, mas válido
+    stream_export_open(&e, TEST_FILE, STREAM_RESOURCE_DATA, EXPORT_JSON);
+    stream_export_close(&e);
+    size_t lines = 0;
+    count_in_file(TEST_FILE, "[", &lines);
+    assert_test("Array vazio", lines == 3 && e.written == 0);
+    unlink(TEST_FILE);
+}
+
+void test_binary(void) {
+    printf("\n%s Testando formato binário...\n", TEST_INFO);
+
+    StreamExporter e;
+    assert_test("BIN recusa ResourceData", !stream_export_open(&e, TEST_FILE, STREAM_RESOURCE_DATA, EXPORT_BIN));
+
+    stream_export_open(&e, TEST_FILE, STREAM_PROCESS_METRICS, EXPORT_BIN);
+    ProcessMetrics m;
+    for (int i = 0; i < TSDB_BLOCK_SAMPLES; i++) {
+        make_metrics(&m, i);
+        stream_export_append(&e, &m);
+    }
+
+    // Bloco cheio vai para o disco sem fechar o arquivo
+    TsdbReader r;
+    bool seen = false;
+    for (int i = 0; i < 500 && !seen; i++) {
+        if (tsdb_reader_open(&r, TEST_FILE)) {
+            seen = (r.block_count == 1);
+            tsdb_reader_close(&r);
+        }
+        if (!seen) usleep(10000);
+    }
+    assert_test("Bloco legível durante a captura", seen);
+
+    for (int i = TSDB_BLOCK_SAMPLES; i < TSDB_BLOCK_SAMPLES + 10; i++) {
+        make_metrics(&m, i);
+        stream_export_append(&e, &m);
+    }
+    assert_test("Fechar arquivo binário", stream_export_close(&e));
+
+    size_t total = 0;
+    ProcessMetrics *out = malloc(TSDB_BLOCK_SAMPLES * sizeof(ProcessMetrics));
+    if (tsdb_reader_open(&r, TEST_FILE)) {
+        assert_test("Índice presente após fechar", !r.recovered && r.block_count == 2);
+        for (size_t b = 0; b < r.block_count; b++) {
+            int n = tsdb_reader_block(&r, b, out);
+            if (n > 0) total += (size_t)n;
+        }
+        tsdb_reader_close(&r);
+    }
+    free(out);
+    assert_test("Todas as amostras no .rmts", total == TSDB_BLOCK_SAMPLES + 10);
+    unlink(TEST_FILE);
+}
+
+void test_producer(void) {
+    printf("\n%s Testando produtor sem espera...\n", TEST_INFO);
+
+    const int samples = 200000;
+    StreamExporter e;
+    stream_export_open(&e, TEST_FILE, STREAM_PROCESS_METRICS, EXPORT_NDJSON);
+
+    ProcessMetrics m;
+    make_metrics(&m, 0);
+    uint64_t worst = 0;
+    uint64_t start = monotonic_ns();
+    for (int i = 0; i < samples; i++) {
+        m.mono_ns += NSEC_PER_MSEC;
+        uint64_t t0 = monotonic_ns();
+        stream_export_append(&e, &m);
+        uint64_t dt = monotonic_ns() - t0;
+        if (dt > worst) worst = dt;
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+
+    printf("  %d amostras enfileiradas em %.2f ms (pior caso %.1f us)\n",
+           samples, elapsed / 1e6, worst / 1e3);
+    // Enfileirar é memcpy sob um mutex: muito mais rápido que formatar e gravar
+    assert_test("Enfileiramento rápido", elapsed < NSEC_PER_SEC);
+
+    assert_test("Fechar exportador", stream_export_close(&e));
+    assert_test("Nada descartado", e.appended == (uint64_t)samples && e.dropped == 0);
+    assert_test("Tudo gravado", e.written == e.appended);
+    assert_test("Gravação em lotes", e.batches > 0 && e.batches < (uint64_t)samples);
+
+    size_t lines = 0;
+    count_in_file(TEST_FILE, "\n", &lines);
+    assert_test("Linhas no arquivo", lines == (size_t)samples);
+    unlink(TEST_FILE);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - EXPORTAÇÃO INCREMENTAL\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_ndjson();
+    test_csv();
+    test_json();
+    test_binary();
+    test_producer();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,233 @@
+/**
+ * test_taskstats.c - Teste unitário para o backend netlink TASKSTATS
+ *
+ * Testa:
+ * - Consulta por PID e por TGID do próprio processo
+ * - Consulta em lote (várias janelas, PID inexistente)
+ * - Notificação de término com as estatísticas finais
+ * - ResourceCollector nos dois backends
+ *
+ * Requer root (CAP_NET_ADMIN); sem a interface os testes são pulados.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "../include/taskstats.h"
+#include "../include/resource_collector.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define BATCH_SIZE 150      // mais de uma janela de requisições
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+static uint64_t cpu_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+// Consome ms milissegundos de CPU (não de relógio: numa máquina carregada
+// o processo pode passar boa parte do tempo fora do processador)
+static void spin_ms(int ms) {
+    uint64_t end = cpu_time_ns() + (uint64_t)ms * NSEC_PER_MSEC;
+    volatile unsigned long spin = 0;
+    while (cpu_time_ns() < end) spin++;
+}
+
+// O kernel arredonda os contadores de I/O do taskstats para múltiplos de
+// 1024: leituras suficientes para passar de um degrau
+static void read_some_file(void) {
+    char buf[1024];
+    int fd = open("/dev/zero", O_RDONLY);
+    if (fd < 0) return;
+    for (int i = 0; i < 1100; i++) {
+        if (read(fd, buf, sizeof(buf)) <= 0) break;
+    }
+    close(fd);
+}
+
+void test_query(TaskstatsClient *c) {
+    printf("\n%s Testando consultas...\n", TEST_INFO);
+
+    spin_ms(50);
+    read_some_file();
+
+    TaskStats proc, task;
+    assert_test("Consulta por TGID do próprio processo", taskstats_query(c, getpid(), true, &proc));
+    assert_test("TGID e escopo corretos", proc.pid == getpid() && proc.tgid_scope);
+    assert_test("Tempo de CPU acumulado", proc.cpu_user_us + proc.cpu_system_us >= 40000);
+
+    assert_test("Consulta por PID do próprio processo", taskstats_query(c, getpid(), false, &task));
+    assert_test("Nome do comando", strcmp(task.comm, "test_taskstats") == 0 && !task.tgid_scope);
+    assert_test("I/O da tarefa (leituras)", task.read_chars > 0 && task.read_syscalls > 0);
+    assert_test("Faltas de página e RSS máximo", task.minor_faults > 0 && task.hiwater_rss_kb > 0);
+    printf("  CPU: %llu us user, %llu us sys | delay de CPU: %.3f ms (%llu esperas)\n",
+           (unsigned long long)proc.cpu_user_us, (unsigned long long)proc.cpu_system_us,
+           proc.cpu_delay_ns / 1e6, (unsigned long long)proc.cpu_delay_count);
+
+    TaskStats none;
+    assert_test("PID inexistente rejeitado", !taskstats_query(c, 999999999, false, &none));
+}
+
+void test_batch(TaskstatsClient *c) {
+    printf("\n%s Testando consultas em lote...\n", TEST_INFO);
+
+    TaskstatsQuery q[4] = {
+        { .pid = getpid(), .tgid = true },
+        { .pid = 999999999, .tgid = false },
+        { .pid = getpid(), .tgid = false },
+        { .pid = getppid(), .tgid = true },
+    };
+    int answered = taskstats_query_batch(c, q, 4);
+    assert_test("Lote com PID inexistente: 3 respostas", answered == 3);
+    assert_test("Respostas casadas com as consultas",
+                q[0].ok && q[0].stats.pid == getpid() && q[0].stats.tgid_scope &&
+                !q[1].ok && q[2].ok && !q[2].stats.tgid_scope &&
+                q[3].ok && q[3].stats.pid == getppid());
+
+    TaskstatsQuery *many = calloc(BATCH_SIZE, sizeof(TaskstatsQuery));
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        many[i].pid = (i % 3 == 2) ? 999999999 : getpid();
+        many[i].tgid = (i % 2 == 0);
+    }
+    uint64_t t0 = monotonic_ns();
+    answered = taskstats_query_batch(c, many, BATCH_SIZE);
+    uint64_t elapsed = monotonic_ns() - t0;
+    bool matched = true;
+    for (int i = 0; i < BATCH_SIZE; i++) {
+        bool expect = (i % 3 != 2);
+        if (many[i].ok != expect || (expect && many[i].stats.tgid_scope != (i % 2 == 0))) matched = false;
+    }
+    assert_test("Lote em várias janelas", answered == BATCH_SIZE - BATCH_SIZE / 3 && matched);
+    printf("  %d consultas em %.1f us\n", BATCH_SIZE, elapsed / 1e3);
+    free(many);
+}
+
+void test_exit_notification(void) {
+    printf("\n%s Testando notificação de término...\n", TEST_INFO);
+
+    TaskstatsClient exits;
+    if (!taskstats_open(&exits)) {
+        assert_test("Cliente de notificações aberto", false);
+        return;
+    }
+    assert_test("Inscrição nas notificações", taskstats_subscribe_exits(&exits));
+
+    pid_t child = fork();
+    if (child == 0) {
+        spin_ms(50);
+        _exit(3);
+    }
+    int status;
+    waitpid(child, &status, 0);
+
+    // A notificação é enviada antes de o pai ser avisado do término
+    TaskStats s;
+    bool found = false;
+    uint64_t deadline = monotonic_ns() + NSEC_PER_SEC;
+    while (!found && monotonic_ns() < deadline) {
+        int r = taskstats_read_exit(&exits, &s);
+        if (r == 1 && s.pid == child) {
+            found = true;
+        } else if (r == 0) {
+            struct pollfd pfd = { .fd = exits.fd, .events = POLLIN };
+            poll(&pfd, 1, 100);
+        } else if (r < 0) {
+            break;
+        }
+    }
+    assert_test("Notificação do filho recebida", found);
+    assert_test("Estatísticas finais do filho",
+                found && s.cpu_user_us + s.cpu_system_us >= 40000 && WEXITSTATUS(s.exitcode) == 3);
+    taskstats_close(&exits);
+}
+
+void test_collector(void) {
+    printf("\n%s Testando ResourceCollector...\n", TEST_INFO);
+
+    CollectBackend backend;
+    assert_test("Nomes de backend", collect_backend_parse("taskstats", &backend) &&
+                backend == COLLECT_BACKEND_TASKSTATS && collect_backend_parse("proc", &backend) &&
+                backend == COLLECT_BACKEND_PROC && !collect_backend_parse("ebpf", &backend));
+
+    ResourceCollector proc, ts;
+    assert_test("PID inexistente rejeitado", !resource_collector_open(&proc, 999999999, COLLECT_BACKEND_TASKSTATS));
+    assert_test("Coletor /proc aberto", resource_collector_open(&proc, getpid(), COLLECT_BACKEND_PROC));
+    assert_test("Coletor taskstats aberto",
+                resource_collector_open(&ts, getpid(), COLLECT_BACKEND_TASKSTATS) &&
+                ts.backend == COLLECT_BACKEND_TASKSTATS);
+
+    spin_ms(100);
+    ResourceData a, b;
+    bool ok = resource_collector_sample(&proc, &a) && resource_collector_sample(&ts, &b);
+    assert_test("Amostras nos dois backends", ok);
+    long cpu_a = a.cpu_user + a.cpu_system, cpu_b = b.cpu_user + b.cpu_system;
+    printf("  CPU: /proc %ld jiffies, taskstats %ld jiffies | RSS %ld/%ld páginas\n",
+           cpu_a, cpu_b, a.memory_rss, b.memory_rss);
+    assert_test("CPU equivalente (diferença < 5 jiffies)", ok && cpu_b > 0 && labs(cpu_a - cpu_b) < 5);
+    assert_test("Memória, threads e I/O preenchidos", ok && b.memory_rss > 0 && b.num_threads == 1 &&
+                b.io_read_syscalls > 0 && b.pid == getpid());
+    assert_test("Sem delays no backend /proc", ok && a.cpu_delay_ns == 0 && a.blkio_delay_ns == 0);
+
+    resource_collector_close(&ts);
+    resource_collector_close(&proc);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - BACKEND TASKSTATS\n");
+    printf("===============================================================\n");
+
+    TaskstatsClient c;
+    if (!taskstats_open(&c)) {
+        printf("\n%s Interface TASKSTATS indisponível: testes pulados\n", TEST_INFO);
+        return 0;
+    }
+    if (!taskstats_delayacct_enabled()) {
+        printf("\n%s kernel.task_delayacct = 0: só o delay de CPU é medido\n", TEST_INFO);
+    }
+
+    // Executar testes
+    test_query(&c);
+    test_batch(&c);
+    test_exit_notification();
+    test_collector();
+    taskstats_close(&c);
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * test_thread_table.c - Teste unitário para a coleta por thread
+ *
+ * Testa:
+ * - Listagem de /proc/<pid>/task e cache da listagem
+ * - Threads novas e encerradas
+ * - CPU%, trocas de contexto e última CPU por thread
+ * - Histórico por TID (MetricsHistory)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include "../include/thread_table.h"
+#include "../include/process_monitor.h"
+#include "../include/proc_parse.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define SLEEPERS 4
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static atomic_bool stop_threads;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+typedef struct {
+    pthread_t thread;
+    _Atomic int tid;
+} Worker;
+
+static void *busy_main(void *arg) {
+    Worker *w = arg;
+    atomic_store(&w->tid, (int)syscall(SYS_gettid));
+    volatile unsigned long spin = 0;
+    while (!atomic_load(&stop_threads)) spin++;
+    return NULL;
+}
+
+// Acorda a cada 1 ms: trocas de contexto voluntárias
+static void *sleeper_main(void *arg) {
+    Worker *w = arg;
+    atomic_store(&w->tid, (int)syscall(SYS_gettid));
+    while (!atomic_load(&stop_threads)) usleep(1000);
+    return NULL;
+}
+
+static void start_worker(Worker *w, void *(*fn)(void *)) {
+    atomic_store(&w->tid, 0);
+    pthread_create(&w->thread, NULL, fn, w);
+    while (atomic_load(&w->tid) == 0) usleep(100);
+}
+
+// Campo 20 de /proc/self/stat, como o coletor de processos o vê
+static long current_threads(void) {
+    char buf[1024];
+    int fd = open("/proc/self/stat", O_RDONLY);
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, buf, sizeof(buf));
+    close(fd);
+    ProcStat st;
+    if (n <= 0 || !proc_parse_stat(buf, (size_t)n, &st)) return 0;
+    return st.num_threads;
+}
+
+void test_listing(void) {
+    printf("\n%s Testando listagem de threads...\n", TEST_INFO);
+
+    ThreadTable t;
+    assert_test("PID inexistente rejeitado", !thread_table_open(&t, 999999999));
+    thread_table_close(&t);
+
+    atomic_store(&stop_threads, false);
+    Worker sleepers[SLEEPERS];
+    for (int i = 0; i < SLEEPERS; i++) start_worker(&sleepers[i], sleeper_main);
+
+    assert_test("Abertura do próprio processo", thread_table_open(&t, getpid()));
+    long threads = current_threads();
+    assert_test("Primeira amostra lista task/", thread_table_sample(&t, threads) && t.relisted);
+    assert_test("Todas as threads encontradas", (long)t.count == threads && t.count == SLEEPERS + 1);
+
+    bool all = thread_table_find(&t, getpid()) != NULL;
+    for (int i = 0; i < SLEEPERS; i++) all = all && thread_table_find(&t, sleepers[i].tid);
+    assert_test("TIDs das threads presentes", all);
+
+    assert_test("Total inalterado: listagem reaproveitada",
+                thread_table_sample(&t, current_threads()) && !t.relisted);
+
+    // Thread nova: num_threads muda e task/ é relido
+    Worker late;
+    start_worker(&late, sleeper_main);
+    assert_test("Thread nova: task/ relido",
+                thread_table_sample(&t, current_threads()) && t.relisted &&
+                thread_table_find(&t, late.tid) != NULL);
+
+    // Uma thread termina e o total informado não muda (outra ocupou o lugar)
+    int gone = sleepers[0].tid;
+    pthread_t gone_thread = sleepers[0].thread;
+    atomic_store(&stop_threads, true);
+    pthread_join(gone_thread, NULL);
+    thread_table_sample(&t, t.listed_threads);
+    assert_test("Thread encerrada removida", thread_table_find(&t, gone) == NULL);
+    assert_test("Listagem marcada para releitura", t.stale);
+
+    for (int i = 1; i < SLEEPERS; i++) pthread_join(sleepers[i].thread, NULL);
+    pthread_join(late.thread, NULL);
+    usleep(10000);
+    thread_table_sample(&t, current_threads());
+    assert_test("Releitura após o encerramento", t.relisted && t.count == 1 && !t.stale);
+
+    thread_table_close(&t);
+}
+
+void test_metrics(void) {
+    printf("\n%s Testando métricas por thread...\n", TEST_INFO);
+
+    atomic_store(&stop_threads, false);
+    Worker busy, sleeper;
+    start_worker(&busy, busy_main);
+    start_worker(&sleeper, sleeper_main);
+
+    ThreadTable t;
+    thread_table_open(&t, getpid());
+    thread_table_sample(&t, current_threads());
+    usleep(300000);
+    thread_table_sample(&t, current_threads());
+
+    ThreadSlot *b = thread_table_find(&t, busy.tid);
+    ThreadSlot *s = thread_table_find(&t, sleeper.tid);
+    ThreadSlot *m = thread_table_find(&t, getpid());
+    if (b && s && m) {
+        printf("  ocupada: %.1f%% CPU, CPU %d | dormindo: %.1f%% CPU, %.0f trocas/s | principal: %.1f%% CPU\n",
+               b->cur.cpu_usage_percent, b->cur.processor, s->cur.cpu_usage_percent,
+               s->cur.ctx_switch_rate, m->cur.cpu_usage_percent);
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    assert_test("Thread ocupada: CPU% alto", b && b->cur.cpu_usage_percent > 50.0);
+    assert_test("Thread ocupada: estado R", b && b->cur.state == 'R');
+    assert_test("Última CPU válida", b && b->cur.processor >= 0 && b->cur.processor < cpus);
+    assert_test("Thread dormindo: trocas voluntárias", s && s->cur.ctx_switch_rate > 100.0 &&
+                                                     s->cur.voluntary_ctx_switches > 0);
+    assert_test("Thread principal: CPU% baixo", m && m->cur.cpu_usage_percent < 20.0);
+
+    // Histórico com a dimensão por TID
+    MetricsHistory *history = create_metrics_history(16);
+    assert_test("Histórico por thread ativado", history && metrics_history_enable_threads(history, 64));
+    add_thread_samples(history, &t);
+    uint64_t head = metrics_history_thread_head(history);
+    assert_test("Uma linha por thread", head == t.count);
+
+    bool found = false, consistent = true;
+    for (uint64_t pos = metrics_history_thread_oldest(history); pos < head; pos++) {
+        ThreadMetrics row;
+        if (!metrics_history_read_thread(history, pos, &row)) {
+            consistent = false;
+            continue;
+        }
+        ThreadSlot *slot = thread_table_find(&t, row.tid);
+        if (!slot || row.pid != getpid() || strcmp(row.name, slot->cur.name) != 0 ||
+            row.processor != slot->cur.processor ||
+            row.voluntary_ctx_switches != slot->cur.voluntary_ctx_switches) {
+            consistent = false;
+        }
+        if (row.tid == busy.tid && row.cpu_usage_percent > 50.0f) found = true;
+    }
+    assert_test("Linhas lidas de volta com TID e métricas", consistent);
+    assert_test("Thread ocupada no histórico", found);
+    free_metrics_history(history);
+
+    atomic_store(&stop_threads, true);
+    pthread_join(busy.thread, NULL);
+    pthread_join(sleeper.thread, NULL);
+    thread_table_close(&t);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - COLETA POR THREAD\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_listing();
+    test_metrics();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * test_timing.c - Teste unitário para relógios e temporizador de amostragem
+ *
+ * Testa:
+ * - Conversão de intervalos com sufixo (s, ms, us, ns)
+ * - Formatação de durações
+ * - Temporizador timerfd com prazos absolutos (sem deriva acumulada)
+ * - CPU% calculado com intervalos menores que 1 segundo
+ * - Intervalo adaptativo (recuo exponencial e retorno ao mínimo)
+ * - Troca de período do temporizador
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/timing.h"
+#include "../include/process_monitor.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+void test_parse_duration() {
+    printf("\n=== Teste 1: Conversão de intervalos ===\n");
+
+    uint64_t ns = 0;
+    assert_test("\"2\" = 2s", parse_duration_ns("2", &ns) && ns == 2 * NSEC_PER_SEC);
+    assert_test("\"2s\"", parse_duration_ns("2s", &ns) && ns == 2 * NSEC_PER_SEC);
+    assert_test("\"1.5s\"", parse_duration_ns("1.5s", &ns) && ns == 1500 * NSEC_PER_MSEC);
+    assert_test("\"100ms\"", parse_duration_ns("100ms", &ns) && ns == 100 * NSEC_PER_MSEC);
+    assert_test("\"500us\"", parse_duration_ns("500us", &ns) && ns == 500 * NSEC_PER_USEC);
+    assert_test("\"250ns\"", parse_duration_ns("250ns", &ns) && ns == 250);
+    assert_test("Sufixo desconhecido rejeitado", !parse_duration_ns("10x", &ns));
+    assert_test("Zero rejeitado", !parse_duration_ns("0ms", &ns));
+    assert_test("Negativo rejeitado", !parse_duration_ns("-1s", &ns));
+    assert_test("Vazio rejeitado", !parse_duration_ns("", &ns));
+}
+
+void test_format_duration() {
+    printf("\n=== Teste 2: Formatação de durações ===\n");
+
+    char buf[32];
+    format_duration_ns(2 * NSEC_PER_SEC, buf, sizeof(buf));
+    assert_test("2s", strcmp(buf, "2s") == 0);
+    format_duration_ns(1500 * NSEC_PER_MSEC, buf, sizeof(buf));
+    assert_test("1500ms", strcmp(buf, "1500ms") == 0);
+    format_duration_ns(500 * NSEC_PER_USEC, buf, sizeof(buf));
+    assert_test("500us", strcmp(buf, "500us") == 0);
+}
+
+void test_timer_no_drift() {
+    printf("\n=== Teste 3: Temporizador sem deriva ===\n");
+
+    const uint64_t interval = 10 * NSEC_PER_MSEC;
+    const int ticks = 20;
+    SampleTimer timer;
+    uint64_t start = monotonic_ns();
+    assert_test("timerfd armado", sample_timer_start(&timer, interval));
+
+    // Trabalho de 3ms por período não deve empurrar os prazos seguintes
+    uint64_t total = 0;
+    while (total < (uint64_t)ticks) {
+        usleep(3000);
+        uint64_t n = sample_timer_wait(&timer);
+        if (n == 0) break;
+        total += n;
+    }
+    uint64_t elapsed = monotonic_ns() - start;
+    sample_timer_close(&timer);
+
+    double error_ms = ((double)elapsed - (double)(ticks * interval)) / NSEC_PER_MSEC;
+    printf("%s %d períodos de 10ms em %.3f ms (erro %.3f ms)\n", TEST_INFO, ticks,
+           (double)elapsed / NSEC_PER_MSEC, error_ms);
+    assert_test("Todos os períodos contados", total == (uint64_t)ticks);
+    assert_test("Erro acumulado < 1 período", error_ms > -1.0 && error_ms < 10.0);
+}
+
+void test_subsecond_cpu_percent() {
+    printf("\n=== Teste 4: CPU%% com intervalo de 200ms ===\n");
+
+    ProcessMetrics prev, cur;
+    assert_test("Primeira coleta", collect_process_metrics(getpid(), &prev));
+
+    // Consome CPU por ~200ms: ambas as amostras caem no mesmo segundo com frequência
+    uint64_t t0 = monotonic_ns();
+    volatile unsigned long spin = 0;
+    while (monotonic_ns() - t0 < 200 * NSEC_PER_MSEC) spin++;
+
+    assert_test("Segunda coleta", collect_process_metrics(getpid(), &cur));
+    calculate_cpu_percent(&cur, &prev);
+    printf("%s delta = %.1f ms, CPU%% = %.2f\n", TEST_INFO,
+           (double)(cur.mono_ns - prev.mono_ns) / NSEC_PER_MSEC, cur.cpu_usage_percent);
+    assert_test("CPU% calculado sem depender de segundos inteiros", cur.cpu_usage_percent > 0.0);
+}
+
+void test_adaptive_interval() {
+    printf("\n=== Teste 5: Intervalo adaptativo ===\n");
+
+    const uint64_t min = 50 * NSEC_PER_MSEC, max = 1 * NSEC_PER_SEC;
+    const double rss = 100.0 * 1024 * 1024;
+    AdaptiveInterval a;
+    adaptive_interval_init(&a, min, max);
+
+    assert_test("Primeira amostra no mínimo", adaptive_interval_update(&a, 10.0, rss, 0) == min);
+    uint64_t i1 = adaptive_interval_update(&a, 10.5, rss, 0);
+    uint64_t i2 = adaptive_interval_update(&a, 11.0, rss + 4096, 1000);
+    assert_test("Métricas estáveis: intervalo dobra", i1 == 2 * min && i2 == 4 * min);
+
+    uint64_t last = 0;
+    for (int i = 0; i < 10; i++) last = adaptive_interval_update(&a, 11.0, rss, 0);
+    assert_test("Recuo limitado ao teto", last == max);
+
+    assert_test("Pico de CPU volta ao mínimo", adaptive_interval_update(&a, 60.0, rss, 0) == min);
+    adaptive_interval_update(&a, 60.0, rss, 0);
+    assert_test("RSS crescendo volta ao mínimo", adaptive_interval_update(&a, 60.0, rss * 1.05, 0) == min);
+    adaptive_interval_update(&a, 60.0, rss * 1.05, 0);
+    assert_test("Rajada de I/O volta ao mínimo",
+                adaptive_interval_update(&a, 60.0, rss * 1.05, 8.0 * 1024 * 1024) == min);
+}
+
+void test_timer_set_interval() {
+    printf("\n=== Teste 6: Troca de período do temporizador ===\n");
+
+    SampleTimer timer;
+    assert_test("timerfd armado", sample_timer_start(&timer, 10 * NSEC_PER_MSEC));
+    sample_timer_wait(&timer);
+
+    uint64_t t0 = monotonic_ns();
+    bool ok = sample_timer_set_interval(&timer, 40 * NSEC_PER_MSEC);
+    uint64_t n = sample_timer_wait(&timer);
+    double first_ms = (double)(monotonic_ns() - t0) / NSEC_PER_MSEC;
+    t0 = monotonic_ns();
+    n += sample_timer_wait(&timer);
+    double second_ms = (double)(monotonic_ns() - t0) / NSEC_PER_MSEC;
+    sample_timer_close(&timer);
+
+    printf("%s períodos após a troca: %.3f ms e %.3f ms\n", TEST_INFO, first_ms, second_ms);
+    assert_test("Novo período aplicado", ok && n == 2 && first_ms > 35.0 && second_ms > 35.0 &&
+                second_ms < 50.0);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - RELÓGIOS E TEMPORIZADOR\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_parse_duration();
+    test_format_duration();
+    test_timer_no_drift();
+    test_subsecond_cpu_percent();
+    test_adaptive_interval();
+    test_timer_set_interval();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}
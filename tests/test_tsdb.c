@@ -0,0 +1,313 @@
+/**
+ * test_tsdb.c - Teste unitário para o formato binário compacto (.rmts)
+ *
+ * Testa:
+ * - Ida e volta sem perdas (contadores, gauges inteiros e doubles)
+ * - Várias séries intercaladas e troca de nome no mesmo PID
+ * - Taxa de compressão de uma captura regular
+ * - Recuperação de captura interrompida (sem índice/rodapé)
+ * - Detecção de bloco corrompido
+ * - Liberação das séries de processos encerrados
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/tsdb.h"
+#include "../include/timing.h"
+
+#define TEST_PASSED "\033[0;32m[PASS]\033[0m"
+#define TEST_FAILED "\033[0;31m[FAIL]\033[0m"
+#define TEST_INFO   "\033[0;34m[INFO]\033[0m"
+
+#define TEST_FILE "/tmp/test_tsdb.rmts"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+void assert_test(const char *test_name, int condition) {
+    if (condition) {
+        printf("%s %s\n", TEST_PASSED, test_name);
+        tests_passed++;
+    } else {
+        printf("%s %s\n", TEST_FAILED, test_name);
+        tests_failed++;
+    }
+}
+
+// Amostra sintética do PID no instante i (intervalo de 1s com jitter)
+static void make_sample(ProcessMetrics *m, int pid, int i) {
+    memset(m, 0, sizeof(ProcessMetrics));
+    m->pid = pid;
+    snprintf(m->process_name, sizeof(m->process_name), "proc-%d", pid);
+    m->mono_ns = 5 * NSEC_PER_SEC + (uint64_t)i * NSEC_PER_SEC + (uint64_t)(i % 7) * 1000;
+    m->real_ns = 1700000000ULL * NSEC_PER_SEC + m->mono_ns;
+    m->timestamp = (time_t)(m->real_ns / NSEC_PER_SEC);
+    m->cpu_user_time = 1000 + (unsigned long)i * 3 + (unsigned long)pid;
+    m->cpu_system_time = 200 + (unsigned long)i;
+    m->cpu_total_time = m->cpu_user_time + m->cpu_system_time;
+    m->cpu_usage_percent = (i % 10 == 0) ? 4.0 : 3.0;
+    m->num_threads = 8 + (i / 100);
+    m->voluntary_ctx_switches = 50L * i;
+    m->nonvoluntary_ctx_switches = i / 3;
+    m->mem_vsize = 1L << 32;
+    m->mem_rss = (200L << 20) + ((i % 5 == 0) ? -4096L * i : 4096L * i);
+    m->mem_shared = 12L << 20;
+    m->page_faults_minor = 10000 + 17L * i;
+    m->page_faults_major = 2;
+    m->io_read_bytes = 4096ULL * (unsigned long long)i;
+    m->io_write_bytes = 1ULL << 40;
+    m->io_read_rate_kbs = (i % 2) ? 4.0 : 0.0;
+    m->io_read_syscalls = (unsigned long long)i;
+    m->net_connections = (i % 50 == 0) ? -1 : 3;
+}
+
+static bool same_sample(const ProcessMetrics *a, const ProcessMetrics *b) {
+    return a->pid == b->pid && strcmp(a->process_name, b->process_name) == 0 &&
+           a->mono_ns == b->mono_ns && a->real_ns == b->real_ns && a->timestamp == b->timestamp &&
+           a->cpu_user_time == b->cpu_user_time && a->cpu_system_time == b->cpu_system_time &&
+           a->cpu_total_time == b->cpu_total_time && a->cpu_usage_percent == b->cpu_usage_percent &&
+           a->num_threads == b->num_threads &&
+           a->voluntary_ctx_switches == b->voluntary_ctx_switches &&
+           a->nonvoluntary_ctx_switches == b->nonvoluntary_ctx_switches &&
+           a->mem_vsize == b->mem_vsize && a->mem_rss == b->mem_rss &&
+           a->mem_shared == b->mem_shared && a->page_faults_minor == b->page_faults_minor &&
+           a->page_faults_major == b->page_faults_major && a->mem_swap == b->mem_swap &&
+           a->io_read_bytes == b->io_read_bytes && a->io_write_bytes == b->io_write_bytes &&
+           a->io_cancelled_write_bytes == b->io_cancelled_write_bytes &&
+           a->io_read_rate_kbs == b->io_read_rate_kbs && a->io_write_rate_kbs == b->io_write_rate_kbs &&
+           a->io_read_syscalls == b->io_read_syscalls && a->io_write_syscalls == b->io_write_syscalls &&
+           a->net_rx_bytes == b->net_rx_bytes && a->net_tx_bytes == b->net_tx_bytes &&
+           a->net_rx_packets == b->net_rx_packets && a->net_tx_packets == b->net_tx_packets &&
+           a->net_connections == b->net_connections;
+}
+
+// Confere todas as amostras do arquivo contra make_sample(pid, i)
+static bool verify_file(const char *path, int npids, int samples, size_t *checked) {
+    TsdbReader r;
+    if (!tsdb_reader_open(&r, path)) return false;
+
+    ProcessMetrics *out = malloc(TSDB_BLOCK_SAMPLES * sizeof(ProcessMetrics));
+    int *next = calloc((size_t)npids + 1, sizeof(int));
+    bool ok = out && next;
+    *checked = 0;
+
+    // Blocos de um mesmo PID aparecem em ordem de tempo
+    for (size_t b = 0; ok && b < r.block_count; b++) {
+        int n = tsdb_reader_block(&r, b, out);
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        for (int k = 0; k < n; k++) {
+            int pid = out[k].pid;
+            if (pid < 1 || pid > npids || next[pid] >= samples) {
+                ok = false;
+                break;
+            }
+            ProcessMetrics expected;
+            make_sample(&expected, pid, next[pid]++);
+            if (!same_sample(&expected, &out[k])) ok = false;
+            (*checked)++;
+        }
+    }
+
+    free(out);
+    free(next);
+    tsdb_reader_close(&r);
+    return ok;
+}
+
+static long file_size(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return -1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+void test_round_trip() {
+    printf("\n=== Teste 1: Ida e volta sem perdas ===\n");
+
+    TsdbWriter w;
+    assert_test("Arquivo criado", tsdb_writer_open(&w, TEST_FILE));
+
+    // 3 séries intercaladas, várias vezes o tamanho de um bloco
+    bool ok = true;
+    for (int i = 0; i < 1000; i++) {
+        for (int pid = 1; pid <= 3; pid++) {
+            ProcessMetrics m;
+            make_sample(&m, pid, i);
+            ok &= tsdb_writer_append(&w, &m);
+        }
+    }
+    assert_test("3000 amostras aceitas", ok && w.samples == 3000);
+    assert_test("Arquivo fechado com índice", tsdb_writer_close(&w));
+
+    size_t checked = 0;
+    assert_test("Todas as amostras idênticas às originais",
+                verify_file(TEST_FILE, 3, 1000, &checked) && checked == 3000);
+
+    TsdbReader r;
+    if (tsdb_reader_open(&r, TEST_FILE)) {
+        assert_test("Índice lido do rodapé", !r.recovered && r.block_count >= 3 * (1000 / TSDB_BLOCK_SAMPLES));
+        tsdb_reader_close(&r);
+    }
+}
+
+void test_compression() {
+    printf("\n=== Teste 2: Compressão ===\n");
+
+    TsdbWriter w;
+    tsdb_writer_open(&w, TEST_FILE);
+    const int samples = 10000;
+    for (int i = 0; i < samples; i++) {
+        ProcessMetrics m;
+        make_sample(&m, 1, i);
+        tsdb_writer_append(&w, &m);
+    }
+    tsdb_writer_close(&w);
+
+    long size = file_size(TEST_FILE);
+    double per_sample = (double)size / samples;
+    printf("%s %d amostras em %ld bytes (%.1f bytes/amostra; linha em memória: %zu bytes)\n",
+           TEST_INFO, samples, size, per_sample, sizeof(ProcessMetrics));
+    assert_test("Menos de 32 bytes por amostra", size > 0 && per_sample < 32.0);
+
+    // Mesma captura em CSV, para comparação
+    OutBuf o;
+    if (out_open(&o, "/tmp/test_tsdb.csv")) {
+        write_metrics_csv_header(&o);
+        for (int i = 0; i < samples; i++) {
+            ProcessMetrics m;
+            make_sample(&m, 1, i);
+            write_metrics_csv_row(&o, &m);
+        }
+        out_close(&o);
+        long csv = file_size("/tmp/test_tsdb.csv");
+        printf("%s CSV equivalente: %ld bytes (%.1fx maior)\n", TEST_INFO, csv, (double)csv / size);
+        assert_test("Menor que o CSV", size < csv);
+        unlink("/tmp/test_tsdb.csv");
+    }
+}
+
+void test_recovery() {
+    printf("\n=== Teste 3: Captura interrompida ===\n");
+
+    TsdbWriter w;
+    tsdb_writer_open(&w, TEST_FILE);
+    for (int i = 0; i < 2 * TSDB_BLOCK_SAMPLES; i++) {
+        for (int pid = 1; pid <= 2; pid++) {
+            ProcessMetrics m;
+            make_sample(&m, pid, i);
+            tsdb_writer_append(&w, &m);
+        }
+    }
+    // Simula uma queda: os blocos completos já estão no disco, mas o
+    // índice e o rodapé nunca são escritos
+    fflush(w.fp);
+    long blocks_end = (long)w.offset;
+    tsdb_writer_close(&w);
+    assert_test("Truncando índice e rodapé", truncate(TEST_FILE, blocks_end) == 0);
+
+    TsdbReader r;
+    bool opened = tsdb_reader_open(&r, TEST_FILE);
+    assert_test("Arquivo sem rodapé aberto", opened);
+    if (opened) {
+        assert_test("Índice reconstruído por varredura", r.recovered && r.block_count == 4);
+        tsdb_reader_close(&r);
+    }
+
+    size_t checked = 0;
+    assert_test("Blocos recuperados íntegros",
+                verify_file(TEST_FILE, 2, 2 * TSDB_BLOCK_SAMPLES, &checked) &&
+                checked == 4 * TSDB_BLOCK_SAMPLES);
+}
+
+void test_corruption() {
+    printf("\n=== Teste 4: Bloco corrompido ===\n");
+
+    TsdbWriter w;
+    tsdb_writer_open(&w, TEST_FILE);
+    for (int i = 0; i < 100; i++) {
+        ProcessMetrics m;
+        make_sample(&m, 1, i);
+        tsdb_writer_append(&w, &m);
+    }
+    tsdb_writer_close(&w);
+
+    // Inverte um byte no meio do payload do único bloco
+    FILE *fp = fopen(TEST_FILE, "r+b");
+    if (fp) {
+        fseek(fp, 200, SEEK_SET);
+        int c = fgetc(fp);
+        fseek(fp, 200, SEEK_SET);
+        fputc(c ^ 0xff, fp);
+        fclose(fp);
+    }
+
+    TsdbReader r;
+    ProcessMetrics *out = malloc(TSDB_BLOCK_SAMPLES * sizeof(ProcessMetrics));
+    if (out && tsdb_reader_open(&r, TEST_FILE)) {
+        assert_test("Checksum rejeita o bloco", tsdb_reader_block(&r, 0, out) == -1);
+        tsdb_reader_close(&r);
+    } else {
+        assert_test("Checksum rejeita o bloco", 0);
+    }
+    free(out);
+}
+
+void test_end_tick() {
+    printf("\n=== Teste 5: Processos encerrados ===\n");
+
+    TsdbWriter w;
+    tsdb_writer_open(&w, TEST_FILE);
+    for (int tick = 0; tick < 10; tick++) {
+        // PIDs 1..100 vivem nos 5 primeiros ticks; só o PID 1 continua
+        int npids = (tick < 5) ? 100 : 1;
+        for (int pid = 1; pid <= npids; pid++) {
+            ProcessMetrics m;
+            make_sample(&m, pid, tick);
+            tsdb_writer_append(&w, &m);
+        }
+        tsdb_writer_end_tick(&w);
+    }
+    assert_test("Séries encerradas liberadas", w.series_count == 1);
+    assert_test("Blocos das séries encerradas já gravados", w.index_count == 99);
+    tsdb_writer_close(&w);
+
+    size_t checked = 0;
+    verify_file(TEST_FILE, 100, 10, &checked);
+    assert_test("Nenhuma amostra perdida", checked == 99 * 5 + 10);
+    unlink(TEST_FILE);
+}
+
+int main() {
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  TESTES UNITÁRIOS - FORMATO BINÁRIO DE MÉTRICAS\n");
+    printf("===============================================================\n");
+
+    // Executar testes
+    test_round_trip();
+    test_compression();
+    test_recovery();
+    test_corruption();
+    test_end_tick();
+
+    // Resumo
+    printf("\n");
+    printf("===============================================================\n");
+    printf("  RESUMO DOS TESTES\n");
+    printf("===============================================================\n");
+    printf("%s Testes passados: %d\n", TEST_PASSED, tests_passed);
+    if (tests_failed > 0) {
+        printf("%s Testes falhados: %d\n", TEST_FAILED, tests_failed);
+    }
+    printf("Total: %d testes\n", tests_passed + tests_failed);
+    printf("===============================================================\n\n");
+
+    return (tests_failed > 0) ? 1 : 0;
+}